@@ -0,0 +1,203 @@
+#include "pch.h"
+
+using namespace std;
+
+namespace Library
+{
+	namespace
+	{
+		const double DegreesPerTurn = 360.0;
+		const float SingleDegreesPerTurn = 360.0f;
+		const float SingleTurnsPerDegree = 1.0f / 360.0f;
+
+		/**
+		* 2^12 + 1. Multiplying by it splits a float into two halves of twelve bits whose products are exact.
+		*/
+		const float SplitFactor = 4097.0f;
+
+		void Split(float value, float& high, float& low)
+		{
+			float scaled = SplitFactor * value;
+			high = scaled - (scaled - value);
+			low = value - high;
+		}
+
+		double Wrap(double degrees)
+		{
+			double wrapped = fmod(degrees, DegreesPerTurn);
+			return (wrapped < 0.0 ? wrapped + DegreesPerTurn : wrapped);
+		}
+	}
+
+	AngleAccumulator::AngleAccumulator(AnglePrecision precision, uint32_t count) :
+		mPrecision(precision), mCount(count)
+	{
+		if (precision == AnglePrecision::Double)
+		{
+			mDoubleValues.assign(count, 0.0);
+			mDoubleRates.assign(count, 0.0);
+		}
+		else
+		{
+			mValues.assign(count, 0.0f);
+			mRates.assign(count, 0.0f);
+			if (precision == AnglePrecision::CompensatedSingle)
+			{
+				mErrors.assign(count, 0.0f);
+				mRateHighHalves.assign(count, 0.0f);
+				mRateLowHalves.assign(count, 0.0f);
+				mRateLows.assign(count, 0.0f);
+			}
+		}
+	}
+
+	AnglePrecision AngleAccumulator::Precision() const
+	{
+		return mPrecision;
+	}
+
+	uint32_t AngleAccumulator::Count() const
+	{
+		return mCount;
+	}
+
+	void AngleAccumulator::SetRates(const double* degreesPerDay)
+	{
+		for (uint32_t i = 0; i < mCount; ++i)
+		{
+			double rate = degreesPerDay[i];
+			switch (mPrecision)
+			{
+			case AnglePrecision::Single:
+				mRates[i] = static_cast<float>(rate);
+				break;
+
+			case AnglePrecision::CompensatedSingle:
+				mRates[i] = static_cast<float>(rate);
+				mRateLows[i] = static_cast<float>(rate - mRates[i]);
+				Split(mRates[i], mRateHighHalves[i], mRateLowHalves[i]);
+				break;
+
+			default:
+				mDoubleRates[i] = rate;
+				break;
+			}
+		}
+	}
+
+	void AngleAccumulator::SetAngle(uint32_t index, double degrees)
+	{
+		assert(index < mCount);
+
+		double wrapped = Wrap(degrees);
+		switch (mPrecision)
+		{
+		case AnglePrecision::Single:
+			mValues[index] = static_cast<float>(wrapped);
+			break;
+
+		case AnglePrecision::CompensatedSingle:
+			mValues[index] = static_cast<float>(wrapped);
+			mErrors[index] = static_cast<float>(wrapped - mValues[index]);
+			break;
+
+		default:
+			mDoubleValues[index] = wrapped;
+			break;
+		}
+	}
+
+	double AngleAccumulator::Angle(uint32_t index) const
+	{
+		assert(index < mCount);
+
+		switch (mPrecision)
+		{
+		case AnglePrecision::Single:
+			return mValues[index];
+
+		case AnglePrecision::CompensatedSingle:
+			return static_cast<double>(mValues[index]) + mErrors[index];
+
+		default:
+			return mDoubleValues[index];
+		}
+	}
+
+	void AngleAccumulator::Advance(double days)
+	{
+		switch (mPrecision)
+		{
+		case AnglePrecision::Single:
+			AdvanceSingle(static_cast<float>(days));
+			break;
+
+		case AnglePrecision::CompensatedSingle:
+			AdvanceCompensatedSingle(days);
+			break;
+
+		default:
+			AdvanceDouble(days);
+			break;
+		}
+	}
+
+	void AngleAccumulator::AdvanceSingle(float days)
+	{
+		float* values = mValues.data();
+		const float* rates = mRates.data();
+		for (uint32_t i = 0; i < mCount; ++i)
+		{
+			float value = values[i] + rates[i] * days;
+			values[i] = value - SingleDegreesPerTurn * LaneMath::RoundToNearest(value * SingleTurnsPerDegree - 0.5f);
+		}
+	}
+
+	void AngleAccumulator::AdvanceCompensatedSingle(double days)
+	{
+		float dayHigh = static_cast<float>(days);
+		float dayLow = static_cast<float>(days - dayHigh);
+		float dayHighHalf;
+		float dayLowHalf;
+		Split(dayHigh, dayHighHalf, dayLowHalf);
+
+		float* values = mValues.data();
+		float* errors = mErrors.data();
+		const float* rates = mRates.data();
+		const float* rateHighHalves = mRateHighHalves.data();
+		const float* rateLowHalves = mRateLowHalves.data();
+		const float* rateLows = mRateLows.data();
+		for (uint32_t i = 0; i < mCount; ++i)
+		{
+			// The step as a product and its exact rounding error, plus the cross terms of the low parts
+			float product = rates[i] * dayHigh;
+			float productError = ((rateHighHalves[i] * dayHighHalf - product) + rateHighHalves[i] * dayLowHalf + rateLowHalves[i] * dayHighHalf) + rateLowHalves[i] * dayLowHalf;
+			productError += rates[i] * dayLow + rateLows[i] * dayHigh;
+
+			// Add the step to the value, keeping the rounding error of the sum
+			float value = values[i];
+			float sum = value + product;
+			float sumPart = sum - value;
+			float error = ((value - (sum - sumPart)) + (product - sumPart)) + (productError + errors[i]);
+
+			// Fold the error back in so that it stays below half a unit in the last place of the value
+			float high = sum + error;
+			float low = error - (high - sum);
+
+			// Whole turns are removed from the high part only; the subtraction is exact, so the low part still applies
+			values[i] = high - SingleDegreesPerTurn * LaneMath::RoundToNearest(high * SingleTurnsPerDegree - 0.5f);
+			errors[i] = low;
+		}
+	}
+
+	void AngleAccumulator::AdvanceDouble(double days)
+	{
+		double* values = mDoubleValues.data();
+		const double* rates = mDoubleRates.data();
+		for (uint32_t i = 0; i < mCount; ++i)
+		{
+			double value = values[i] + rates[i] * days;
+			values[i] = value - DegreesPerTurn * LaneMath::RoundToNearest(value * (1.0 / DegreesPerTurn) - 0.5);
+		}
+	}
+}
\ No newline at end of file
@@ -0,0 +1,78 @@
+#pragma once
+
+#include <vector>
+#include <cstdint>
+
+namespace Library
+{
+	/**
+	* The arithmetic an AngleAccumulator keeps its angles in.
+	*/
+	enum class AnglePrecision
+	{
+		Single,					// Plain float; rounding error builds up with every step
+		CompensatedSingle,		// Pairs of floats whose sum carries about twice the precision of one float
+		Double
+	};
+
+	/**
+	* Advances an array of angles, in degrees, by per-angle rates over steps of time, keeping each angle within a turn.
+	* The angles are stored as structures of arrays and every step is a single loop across them with no branches or
+	* library calls, so the compiler can vectorize it in any of the precisions.
+	*
+	* In compensated single precision each angle is the unevaluated sum of a value and an error term, and each rate and
+	* step is likewise split into a high and a low float. The product of rate and step is formed exactly with Dekker's
+	* splitting and added with Knuth's two-sum, so the rounding error of every step is carried forward instead of lost.
+	* This relies on the compiler neither reassociating nor contracting the float arithmetic, as under /fp:precise
+	* without FMA code generation.
+	*/
+	class AngleAccumulator final
+	{
+	public:
+		AngleAccumulator(AnglePrecision precision, std::uint32_t count);
+		AngleAccumulator(const AngleAccumulator&) = delete;
+		AngleAccumulator& operator=(const AngleAccumulator&) = delete;
+		AngleAccumulator(AngleAccumulator&&) = default;
+		AngleAccumulator& operator=(AngleAccumulator&&) = default;
+		~AngleAccumulator() = default;
+
+		AnglePrecision Precision() const;
+		std::uint32_t Count() const;
+
+		/**
+		* Set the rate of every angle.
+		* @param degreesPerDay An array of Count() rates.
+		*/
+		void SetRates(const double* degreesPerDay);
+		void SetAngle(std::uint32_t index, double degrees);
+		/**
+		* Get an angle in [0, 360), to within rounding at the ends of the range.
+		*/
+		double Angle(std::uint32_t index) const;
+
+		/**
+		* Advance every angle by its rate over a step of time.
+		*/
+		void Advance(double days);
+
+	private:
+		void AdvanceSingle(float days);
+		void AdvanceCompensatedSingle(double days);
+		void AdvanceDouble(double days);
+
+		AnglePrecision mPrecision;
+		std::uint32_t mCount;
+
+		// Single precision: the values and rates. Compensated single precision adds the error terms of the values, and
+		// splits each rate into a low part and a high part that is itself split into halves of twelve bits.
+		std::vector<float> mValues;
+		std::vector<float> mErrors;
+		std::vector<float> mRates;
+		std::vector<float> mRateHighHalves;
+		std::vector<float> mRateLowHalves;
+		std::vector<float> mRateLows;
+
+		std::vector<double> mDoubleValues;
+		std::vector<double> mDoubleRates;
+	};
+}
\ No newline at end of file
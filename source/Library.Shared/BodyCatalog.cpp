@@ -0,0 +1,292 @@
+#include "pch.h"
+
+using namespace std;
+
+namespace Library
+{
+	const uint32_t BodyCatalog::Magic = 0x54414342; // "BCAT"
+	const uint32_t BodyCatalog::Version = 4;
+
+	namespace
+	{
+		const char* const SourceColumns[] = { "Name", "Parent", "Flags", "AmbientIntensity", "AxialTilt", "RotationDays", "RevolutionDays", "OrbitalDistance", "TrueDistance", "Inclination", "AscendingNode", "NodalPeriodDays", "Scale", "Mass", "Radius", "Texture" };
+		const size_t SourceColumnCount = sizeof(SourceColumns) / sizeof(SourceColumns[0]);
+
+		[[noreturn]] void ThrowSourceError(uint32_t lineNumber, const string& message)
+		{
+			string error = "Body catalog source line " + to_string(lineNumber) + ": " + message;
+			throw GameException(error.c_str());
+		}
+	}
+
+	BodyCatalog::BodyCatalog(const wstring& filename) :
+		mFile(filename), mHeader(nullptr), mRecords(nullptr), mStrings(nullptr)
+	{
+		const uint8_t* data = mFile.Data();
+		size_t size = mFile.Size();
+		if (size < sizeof(BodyCatalogHeader))
+		{
+			throw GameException("Body catalog is truncated.");
+		}
+
+		mHeader = reinterpret_cast<const BodyCatalogHeader*>(data);
+		if (mHeader->Magic != Magic)
+		{
+			throw GameException("Body catalog has an invalid signature.");
+		}
+
+		if (mHeader->Version != Version || mHeader->RecordSize != sizeof(BodyCatalogRecord))
+		{
+			throw GameException("Body catalog version is not supported.");
+		}
+
+		uint64_t recordsEnd = static_cast<uint64_t>(mHeader->RecordsOffset) + static_cast<uint64_t>(mHeader->RecordCount) * mHeader->RecordSize;
+		uint64_t stringsEnd = static_cast<uint64_t>(mHeader->StringTableOffset) + mHeader->StringTableSize;
+		if (recordsEnd > size || stringsEnd > size || mHeader->StringTableSize == 0 || (mHeader->RecordsOffset % alignof(BodyCatalogRecord)) != 0)
+		{
+			throw GameException("Body catalog is corrupt.");
+		}
+
+		mRecords = reinterpret_cast<const BodyCatalogRecord*>(data + mHeader->RecordsOffset);
+		mStrings = reinterpret_cast<const char*>(data + mHeader->StringTableOffset);
+		if (mStrings[mHeader->StringTableSize - 1] != '\0')
+		{
+			throw GameException("Body catalog string table is not terminated.");
+		}
+
+		// Every body is checked once here so that the names, textures and parents can be used without bounds checks; the
+		// simulation and the game walk the records in order and rely on each parent preceding its children
+		for (uint32_t i = 0; i < mHeader->RecordCount; ++i)
+		{
+			const BodyCatalogRecord& record = mRecords[i];
+			if (record.NameOffset >= mHeader->StringTableSize || record.TextureNameOffset >= mHeader->StringTableSize)
+			{
+				string error = "Body catalog record " + to_string(i) + " has a string outside the string table.";
+				throw GameException(error.c_str());
+			}
+
+			if (record.ParentIndex < -1 || record.ParentIndex >= static_cast<int32_t>(i))
+			{
+				string error = "Body catalog record " + to_string(i) + " has a parent that is not listed before it.";
+				throw GameException(error.c_str());
+			}
+		}
+	}
+
+	uint32_t BodyCatalog::Count() const
+	{
+		return mHeader->RecordCount;
+	}
+
+	const BodyCatalogRecord* BodyCatalog::Records() const
+	{
+		return mRecords;
+	}
+
+	const BodyCatalogRecord& BodyCatalog::Record(uint32_t index) const
+	{
+		assert(index < mHeader->RecordCount);
+		return mRecords[index];
+	}
+
+	const char* BodyCatalog::Name(uint32_t index) const
+	{
+		return mStrings + Record(index).NameOffset;
+	}
+
+	wstring BodyCatalog::TextureName(uint32_t index) const
+	{
+		return Utility::ToWideString(mStrings + Record(index).TextureNameOffset);
+	}
+
+	int32_t BodyCatalog::IndexOf(const string& name) const
+	{
+		for (uint32_t i = 0; i < mHeader->RecordCount; ++i)
+		{
+			if (name == Name(i))
+			{
+				return static_cast<int32_t>(i);
+			}
+		}
+
+		return -1;
+	}
+
+	void BodyCatalog::Compile(istream& source, ostream& destination)
+	{
+		vector<BodyCatalogRecord> records;
+		vector<string> names;
+		string strings;
+		map<string, uint32_t> stringOffsets;
+
+		auto addString = [&](const string& value) -> uint32_t
+		{
+			auto it = stringOffsets.find(value);
+			if (it != stringOffsets.end())
+			{
+				return it->second;
+			}
+
+			uint32_t offset = static_cast<uint32_t>(strings.size());
+			strings.append(value);
+			strings.push_back('\0');
+			stringOffsets.emplace(value, offset);
+			return offset;
+		};
+
+		auto trim = [](const string& value) -> string
+		{
+			const char* whitespace = " \t\r";
+			size_t first = value.find_first_not_of(whitespace);
+			if (first == string::npos)
+			{
+				return string();
+			}
+
+			size_t last = value.find_last_not_of(whitespace);
+			return value.substr(first, last - first + 1);
+		};
+
+		addString(string());
+
+		auto split = [&trim](const string& line) -> vector<string>
+		{
+			vector<string> fields;
+			stringstream lineStream(line);
+			string field;
+			while (getline(lineStream, field, ','))
+			{
+				fields.push_back(trim(field));
+			}
+
+			return fields;
+		};
+
+		// A number must take up its whole field; stof alone would accept a valid prefix and throw its own exceptions otherwise
+		uint32_t lineNumber = 0;
+		auto parseFloat = [&lineNumber](const vector<string>& fields, size_t column) -> float
+		{
+			const string& field = fields[column];
+			size_t parsed = 0;
+			float value = 0.0f;
+			try
+			{
+				value = stof(field, &parsed);
+			}
+			catch (const logic_error&)
+			{
+				parsed = 0;
+			}
+
+			if (parsed == 0 || parsed != field.size())
+			{
+				ThrowSourceError(lineNumber, string(SourceColumns[column]) + " is not a number: \"" + field + "\".");
+			}
+
+			return value;
+		};
+
+		string line;
+		bool headerRead = false;
+		while (getline(source, line))
+		{
+			++lineNumber;
+			line = trim(line);
+			if (line.empty() || line[0] == '#')
+			{
+				continue;
+			}
+
+			vector<string> fields = split(line);
+
+			// The first line that is not a comment names the columns, which must be those the compiler reads
+			if (!headerRead)
+			{
+				bool columnsMatch = (fields.size() == SourceColumnCount);
+				for (size_t column = 0; columnsMatch && column < SourceColumnCount; ++column)
+				{
+					columnsMatch = (fields[column] == SourceColumns[column]);
+				}
+
+				if (!columnsMatch)
+				{
+					ThrowSourceError(lineNumber, "The header must name the columns Name, Parent, Flags, AmbientIntensity, AxialTilt, RotationDays, RevolutionDays, OrbitalDistance, TrueDistance, Inclination, AscendingNode, NodalPeriodDays, Scale, Mass, Radius, Texture.");
+				}
+
+				headerRead = true;
+				continue;
+			}
+
+			if (fields.size() != SourceColumnCount)
+			{
+				ThrowSourceError(lineNumber, "Expected " + to_string(SourceColumnCount) + " columns but found " + to_string(fields.size()) + ".");
+			}
+
+			if (fields[0].empty())
+			{
+				ThrowSourceError(lineNumber, "A body must have a name.");
+			}
+
+			BodyCatalogRecord record = { 0 };
+			record.NameOffset = addString(fields[0]);
+			record.ParentIndex = -1;
+			if (!fields[1].empty())
+			{
+				auto parent = find(names.begin(), names.end(), fields[1]);
+				if (parent == names.end())
+				{
+					ThrowSourceError(lineNumber, "The parent \"" + fields[1] + "\" must be listed before its children.");
+				}
+
+				record.ParentIndex = static_cast<int32_t>(parent - names.begin());
+			}
+
+			if (fields[2] == "LightSource")
+			{
+				record.Flags |= static_cast<uint32_t>(BodyFlags::LightSource);
+			}
+			else if (!fields[2].empty())
+			{
+				ThrowSourceError(lineNumber, "Unknown flag \"" + fields[2] + "\".");
+			}
+
+			record.AmbientIntensity = parseFloat(fields, 3);
+			record.AxialTilt = parseFloat(fields, 4);
+			record.RotationDays = parseFloat(fields, 5);
+			record.RevolutionDays = parseFloat(fields, 6);
+			record.OrbitalDistance = parseFloat(fields, 7);
+			record.TrueDistance = parseFloat(fields, 8);
+			record.Inclination = parseFloat(fields, 9);
+			record.AscendingNode = parseFloat(fields, 10);
+			record.NodalPeriodDays = parseFloat(fields, 11);
+			record.Scale = parseFloat(fields, 12);
+			record.Mass = parseFloat(fields, 13);
+			record.Radius = parseFloat(fields, 14);
+			record.TextureNameOffset = addString(fields[15]);
+
+			names.push_back(fields[0]);
+			records.push_back(record);
+		}
+
+		if (!headerRead)
+		{
+			throw GameException("Body catalog source has no header.");
+		}
+
+		BodyCatalogHeader header = { 0 };
+		header.Magic = Magic;
+		header.Version = Version;
+		header.RecordCount = static_cast<uint32_t>(records.size());
+		header.RecordSize = sizeof(BodyCatalogRecord);
+		header.RecordsOffset = sizeof(BodyCatalogHeader);
+		header.StringTableOffset = header.RecordsOffset + header.RecordCount * header.RecordSize;
+		header.StringTableSize = static_cast<uint32_t>(strings.size());
+
+		destination.write(reinterpret_cast<const char*>(&header), sizeof(header));
+		if (records.size() > 0)
+		{
+			destination.write(reinterpret_cast<const char*>(&records[0]), records.size() * sizeof(BodyCatalogRecord));
+		}
+		destination.write(strings.data(), strings.size());
+	}
+}
\ No newline at end of file
@@ -0,0 +1,108 @@
+#pragma once
+
+#include "MemoryMappedFile.h"
+#include <cstdint>
+#include <string>
+#include <iostream>
+
+namespace Library
+{
+	/**
+	* Flags describing the role of a body within the catalog.
+	*/
+	enum class BodyFlags : std::uint32_t
+	{
+		None = 0x0,
+		LightSource = 0x1
+	};
+
+	/**
+	* The header at the start of a compiled body catalog file.
+	*/
+	struct BodyCatalogHeader
+	{
+		std::uint32_t Magic;
+		std::uint32_t Version;
+		std::uint32_t RecordCount;
+		std::uint32_t RecordSize;
+		std::uint32_t RecordsOffset;
+		std::uint32_t StringTableOffset;
+		std::uint32_t StringTableSize;
+		std::uint32_t Reserved;
+	};
+
+	/**
+	* A fixed-size record for a single body. Strings are offsets into the string table of the catalog.
+	*/
+	struct BodyCatalogRecord
+	{
+		std::uint32_t NameOffset;
+		std::uint32_t TextureNameOffset;
+		std::int32_t ParentIndex;
+		std::uint32_t Flags;
+		float AmbientIntensity;
+		float AxialTilt;
+		float RotationDays;
+		float RevolutionDays;
+		float OrbitalDistance;	// Astronomical units, as drawn; a moon is moved out from its planet to be seen apart
+		float Inclination;		// Degrees from the ecliptic
+		float AscendingNode;	// Longitude of the ascending node at the start of the simulation, in degrees
+		float NodalPeriodDays;	// Period of the node about the ecliptic pole, negative when it regresses, or 0 for a fixed node
+		float Scale;
+		float Mass;				// Earth masses
+		float Radius;			// Kilometres
+		float TrueDistance;		// Astronomical units, the mean distance from the parent in space
+
+		bool HasFlag(BodyFlags flag) const
+		{
+			return (Flags & static_cast<std::uint32_t>(flag)) != 0;
+		}
+	};
+
+	static_assert(sizeof(BodyCatalogHeader) == 32, "BodyCatalogHeader must match the file layout.");
+	static_assert(sizeof(BodyCatalogRecord) == 64, "BodyCatalogRecord must match the file layout.");
+
+	/**
+	* A read-only catalog of bodies backed by a memory-mapped binary file compiled offline from a CSV source.
+	* Records are used in place; loading does not allocate per body. Loading checks every record, so the names, textures
+	* and parents of a loaded catalog are in bounds and every parent precedes its children.
+	*/
+	class BodyCatalog final
+	{
+	public:
+		BodyCatalog(const std::wstring& filename);
+		BodyCatalog(const BodyCatalog&) = delete;
+		BodyCatalog& operator=(const BodyCatalog&) = delete;
+		BodyCatalog(BodyCatalog&&) = default;
+		BodyCatalog& operator=(BodyCatalog&&) = default;
+		~BodyCatalog() = default;
+
+		std::uint32_t Count() const;
+		const BodyCatalogRecord* Records() const;
+		const BodyCatalogRecord& Record(std::uint32_t index) const;
+		const char* Name(std::uint32_t index) const;
+		std::wstring TextureName(std::uint32_t index) const;
+		/**
+		* Find a body by name with a linear search.
+		* @return The index of the body, or -1 if absent.
+		*/
+		std::int32_t IndexOf(const std::string& name) const;
+
+		/**
+		* Compile a CSV body list into the binary catalog format.
+		* Columns: Name, Parent, Flags, AmbientIntensity, AxialTilt, RotationDays, RevolutionDays, OrbitalDistance, TrueDistance,
+		* Inclination, AscendingNode, NodalPeriodDays, Scale, Mass, Radius, Texture.
+		* Lines starting with '#' are ignored. Parents must be listed before their children.
+		*/
+		static void Compile(std::istream& source, std::ostream& destination);
+
+		static const std::uint32_t Magic;
+		static const std::uint32_t Version;
+
+	private:
+		MemoryMappedFile mFile;
+		const BodyCatalogHeader* mHeader;
+		const BodyCatalogRecord* mRecords;
+		const char* mStrings;
+	};
+}
\ No newline at end of file
@@ -0,0 +1,316 @@
+#include "pch.h"
+
+using namespace std;
+using namespace Microsoft::WRL;
+
+namespace Library
+{
+	RTTI_DEFINITIONS(D3D11RenderDevice)
+
+	D3D11RenderDevice::D3D11RenderDevice(Game& game) :
+		mGame(&game), mConstantBufferOffsets(false)
+	{
+		// Offsets and mapping without overwriting are optional for constant buffers, even on the 11.1 runtime
+		D3D11_FEATURE_DATA_D3D11_OPTIONS options;
+		ThrowIfFailed(mGame->Direct3DDevice()->CheckFeatureSupport(D3D11_FEATURE_D3D11_OPTIONS, &options, sizeof(options)), "ID3D11Device::CheckFeatureSupport() failed.");
+		mConstantBufferOffsets = (options.ConstantBufferOffsetting != FALSE && options.MapNoOverwriteOnDynamicConstantBuffer != FALSE);
+
+		// The first handle of every kind is RenderDevice::NullHandle, which binds nothing
+		mBuffers.push_back({ nullptr, nullptr });
+		mTextures.push_back(nullptr);
+		mShaders.push_back({ nullptr, nullptr, nullptr });
+		mStates.push_back({ nullptr, nullptr, nullptr });
+	}
+
+	uint32_t D3D11RenderDevice::CreateBuffer(const BufferDescription& description, const void* data)
+	{
+		static const UINT bindFlags[] = { D3D11_BIND_VERTEX_BUFFER, D3D11_BIND_INDEX_BUFFER, D3D11_BIND_CONSTANT_BUFFER, D3D11_BIND_SHADER_RESOURCE };
+
+		D3D11_BUFFER_DESC bufferDesc = { 0 };
+		bufferDesc.ByteWidth = description.Size;
+		bufferDesc.Usage = (description.Dynamic ? D3D11_USAGE_DYNAMIC : D3D11_USAGE_DEFAULT);
+		bufferDesc.BindFlags = bindFlags[static_cast<uint32_t>(description.Type)];
+		bufferDesc.CPUAccessFlags = (description.Dynamic ? D3D11_CPU_ACCESS_WRITE : 0);
+		if (description.Type == BufferType::Structured)
+		{
+			bufferDesc.MiscFlags = D3D11_RESOURCE_MISC_BUFFER_STRUCTURED;
+			bufferDesc.StructureByteStride = description.Stride;
+		}
+
+		D3D11_SUBRESOURCE_DATA subresource = { 0 };
+		subresource.pSysMem = data;
+
+		BufferEntry entry;
+		ThrowIfFailed(mGame->Direct3DDevice()->CreateBuffer(&bufferDesc, (data != nullptr ? &subresource : nullptr), entry.Buffer.GetAddressOf()), "ID3D11Device::CreateBuffer() failed.");
+
+		if (description.Type == BufferType::Structured)
+		{
+			D3D11_SHADER_RESOURCE_VIEW_DESC viewDesc;
+			ZeroMemory(&viewDesc, sizeof(viewDesc));
+			viewDesc.Format = DXGI_FORMAT_UNKNOWN;
+			viewDesc.ViewDimension = D3D11_SRV_DIMENSION_BUFFER;
+			viewDesc.Buffer.NumElements = description.Size / description.Stride;
+			ThrowIfFailed(mGame->Direct3DDevice()->CreateShaderResourceView(entry.Buffer.Get(), &viewDesc, entry.View.GetAddressOf()), "ID3D11Device::CreateShaderResourceView() failed.");
+		}
+
+		mBuffers.push_back(entry);
+		return static_cast<uint32_t>(mBuffers.size() - 1);
+	}
+
+	uint32_t D3D11RenderDevice::CreateTexture(const TextureDescription& description, const SubresourceData* subresources)
+	{
+		vector<D3D11_SUBRESOURCE_DATA> subresourceData(description.ArraySize * description.MipLevels);
+		for (size_t i = 0; i < subresourceData.size(); ++i)
+		{
+			subresourceData[i].pSysMem = subresources[i].Data;
+			subresourceData[i].SysMemPitch = subresources[i].RowPitch;
+		}
+
+		D3D11_TEXTURE2D_DESC textureDesc = { 0 };
+		textureDesc.Width = description.Width;
+		textureDesc.Height = description.Height;
+		textureDesc.MipLevels = description.MipLevels;
+		textureDesc.ArraySize = description.ArraySize;
+		textureDesc.Format = DXGI_FORMAT_R8G8B8A8_UNORM;
+		textureDesc.SampleDesc.Count = 1;
+		textureDesc.Usage = D3D11_USAGE_IMMUTABLE;
+		textureDesc.BindFlags = D3D11_BIND_SHADER_RESOURCE;
+
+		ComPtr<ID3D11Texture2D> texture;
+		ComPtr<ID3D11ShaderResourceView> view;
+		ThrowIfFailed(mGame->Direct3DDevice()->CreateTexture2D(&textureDesc, subresourceData.data(), texture.GetAddressOf()), "ID3D11Device::CreateTexture2D() failed.");
+		ThrowIfFailed(mGame->Direct3DDevice()->CreateShaderResourceView(texture.Get(), nullptr, view.GetAddressOf()), "ID3D11Device::CreateShaderResourceView() failed.");
+
+		mTextures.push_back(view);
+		return static_cast<uint32_t>(mTextures.size() - 1);
+	}
+
+	uint32_t D3D11RenderDevice::CreateShader(const void* vertexShader, size_t vertexShaderSize, const void* pixelShader, size_t pixelShaderSize,
+		const VertexElement* vertexElements, uint32_t vertexElementCount)
+	{
+		static const DXGI_FORMAT formats[] = { DXGI_FORMAT_R32G32_FLOAT, DXGI_FORMAT_R32G32B32_FLOAT, DXGI_FORMAT_R32G32B32A32_FLOAT };
+
+		ShaderEntry entry;
+		ThrowIfFailed(mGame->Direct3DDevice()->CreateVertexShader(vertexShader, vertexShaderSize, nullptr, entry.VertexShader.GetAddressOf()), "ID3D11Device::CreatedVertexShader() failed.");
+		ThrowIfFailed(mGame->Direct3DDevice()->CreatePixelShader(pixelShader, pixelShaderSize, nullptr, entry.PixelShader.GetAddressOf()), "ID3D11Device::CreatedPixelShader() failed.");
+
+		vector<D3D11_INPUT_ELEMENT_DESC> inputElementDescriptions(vertexElementCount);
+		for (uint32_t i = 0; i < vertexElementCount; ++i)
+		{
+			D3D11_INPUT_ELEMENT_DESC& inputElement = inputElementDescriptions[i];
+			inputElement.SemanticName = vertexElements[i].SemanticName;
+			inputElement.SemanticIndex = vertexElements[i].SemanticIndex;
+			inputElement.Format = formats[static_cast<uint32_t>(vertexElements[i].Format)];
+			inputElement.InputSlot = 0;
+			inputElement.AlignedByteOffset = D3D11_APPEND_ALIGNED_ELEMENT;
+			inputElement.InputSlotClass = D3D11_INPUT_PER_VERTEX_DATA;
+			inputElement.InstanceDataStepRate = 0;
+		}
+
+		ThrowIfFailed(mGame->Direct3DDevice()->CreateInputLayout(inputElementDescriptions.data(), vertexElementCount, vertexShader, vertexShaderSize, entry.InputLayout.GetAddressOf()), "ID3D11Device::CreateInputLayout() failed.");
+
+		mShaders.push_back(entry);
+		return static_cast<uint32_t>(mShaders.size() - 1);
+	}
+
+	uint32_t D3D11RenderDevice::CreateState(const StateDescription& description)
+	{
+		// A null state is the default of the device: opaque, depth tested and written, and back faces culled
+		StateEntry entry;
+		switch (description.Blend)
+		{
+		case BlendMode::AlphaBlending:
+			entry.BlendState = BlendStates::AlphaBlending;
+			break;
+
+		case BlendMode::MultiplicativeBlending:
+			entry.BlendState = BlendStates::MultiplicativeBlending;
+			break;
+
+		default:
+			break;
+		}
+
+		if (description.Depth != DepthMode::ReadWrite)
+		{
+			D3D11_DEPTH_STENCIL_DESC depthStencilDesc = { 0 };
+			depthStencilDesc.DepthEnable = (description.Depth == DepthMode::ReadOnly);
+			depthStencilDesc.DepthWriteMask = D3D11_DEPTH_WRITE_MASK_ZERO;
+			depthStencilDesc.DepthFunc = D3D11_COMPARISON_LESS;
+			ThrowIfFailed(mGame->Direct3DDevice()->CreateDepthStencilState(&depthStencilDesc, entry.DepthStencilState.GetAddressOf()), "ID3D11Device::CreateDepthStencilState() failed.");
+		}
+
+		switch (description.Cull)
+		{
+		case CullMode::Front:
+			entry.RasterizerState = RasterizerStates::FrontCulling;
+			break;
+
+		case CullMode::None:
+			entry.RasterizerState = RasterizerStates::DisabledCulling;
+			break;
+
+		default:
+			break;
+		}
+
+		mStates.push_back(entry);
+		return static_cast<uint32_t>(mStates.size() - 1);
+	}
+
+	void D3D11RenderDevice::ReleaseBuffer(uint32_t buffer)
+	{
+		assert(buffer != NullHandle);
+
+		BufferEntry& entry = mBuffers.at(buffer);
+		entry.View = nullptr;
+		entry.Buffer = nullptr;
+	}
+
+	bool D3D11RenderDevice::SupportsConstantBufferOffsets() const
+	{
+		return mConstantBufferOffsets;
+	}
+
+	uint32_t D3D11RenderDevice::AddBuffer(ID3D11Buffer* buffer)
+	{
+		mBuffers.push_back({ buffer, nullptr });
+		return static_cast<uint32_t>(mBuffers.size() - 1);
+	}
+
+	uint32_t D3D11RenderDevice::AddTexture(ID3D11ShaderResourceView* texture)
+	{
+		mTextures.push_back(texture);
+		return static_cast<uint32_t>(mTextures.size() - 1);
+	}
+
+	void* D3D11RenderDevice::Map(uint32_t buffer, bool discard)
+	{
+		D3D11_MAPPED_SUBRESOURCE mappedResource;
+		ThrowIfFailed(mGame->Direct3DDeviceContext()->Map(mBuffers.at(buffer).Buffer.Get(), 0, (discard ? D3D11_MAP_WRITE_DISCARD : D3D11_MAP_WRITE_NO_OVERWRITE), 0, &mappedResource), "ID3D11DeviceContext::Map() failed.");
+
+		return mappedResource.pData;
+	}
+
+	void D3D11RenderDevice::Unmap(uint32_t buffer, uint32_t writtenSize)
+	{
+		UNREFERENCED_PARAMETER(writtenSize);
+
+		mGame->Direct3DDeviceContext()->Unmap(mBuffers.at(buffer).Buffer.Get(), 0);
+	}
+
+	void D3D11RenderDevice::UpdateBuffer(uint32_t buffer, const void* data, uint32_t size)
+	{
+		UNREFERENCED_PARAMETER(size);
+
+		mGame->Direct3DDeviceContext()->UpdateSubresource(mBuffers.at(buffer).Buffer.Get(), 0, nullptr, data, 0, 0);
+	}
+
+	void D3D11RenderDevice::SetState(uint32_t state)
+	{
+		const StateEntry& entry = mStates.at(state);
+		ID3D11DeviceContext* direct3DDeviceContext = mGame->Direct3DDeviceContext();
+		direct3DDeviceContext->OMSetBlendState(entry.BlendState.Get(), nullptr, 0xFFFFFFFF);
+		direct3DDeviceContext->OMSetDepthStencilState(entry.DepthStencilState.Get(), 0);
+		direct3DDeviceContext->RSSetState(entry.RasterizerState.Get());
+	}
+
+	void D3D11RenderDevice::SetShader(uint32_t shader)
+	{
+		const ShaderEntry& entry = mShaders.at(shader);
+		ID3D11DeviceContext* direct3DDeviceContext = mGame->Direct3DDeviceContext();
+		direct3DDeviceContext->IASetInputLayout(entry.InputLayout.Get());
+		direct3DDeviceContext->VSSetShader(entry.VertexShader.Get(), nullptr, 0);
+		direct3DDeviceContext->PSSetShader(entry.PixelShader.Get(), nullptr, 0);
+	}
+
+	void D3D11RenderDevice::SetPrimitiveTopology(PrimitiveTopology topology)
+	{
+		static const D3D11_PRIMITIVE_TOPOLOGY topologies[] = { D3D11_PRIMITIVE_TOPOLOGY_POINTLIST, D3D11_PRIMITIVE_TOPOLOGY_LINELIST, D3D11_PRIMITIVE_TOPOLOGY_TRIANGLELIST };
+		mGame->Direct3DDeviceContext()->IASetPrimitiveTopology(topologies[static_cast<uint32_t>(topology)]);
+	}
+
+	void D3D11RenderDevice::SetVertexBuffer(uint32_t buffer, uint32_t stride)
+	{
+		UINT offset = 0;
+		mGame->Direct3DDeviceContext()->IASetVertexBuffers(0, 1, mBuffers.at(buffer).Buffer.GetAddressOf(), &stride, &offset);
+	}
+
+	void D3D11RenderDevice::SetIndexBuffer(uint32_t buffer)
+	{
+		mGame->Direct3DDeviceContext()->IASetIndexBuffer(mBuffers.at(buffer).Buffer.Get(), DXGI_FORMAT_R32_UINT, 0);
+	}
+
+	void D3D11RenderDevice::SetConstantBuffer(ShaderStage stage, uint32_t slot, uint32_t buffer, uint32_t firstConstant, uint32_t constantCount)
+	{
+		ID3D11Buffer* const* constantBuffer = mBuffers.at(buffer).Buffer.GetAddressOf();
+		if (stage == ShaderStage::Vertex)
+		{
+			mGame->Direct3DDeviceContext()->VSSetConstantBuffers1(slot, 1, constantBuffer, &firstConstant, &constantCount);
+		}
+		else
+		{
+			mGame->Direct3DDeviceContext()->PSSetConstantBuffers1(slot, 1, constantBuffer, &firstConstant, &constantCount);
+		}
+	}
+
+	void D3D11RenderDevice::SetTexture(ShaderStage stage, uint32_t slot, uint32_t texture)
+	{
+		SetShaderResource(stage, slot, mTextures.at(texture).Get());
+	}
+
+	void D3D11RenderDevice::SetStructuredBuffer(ShaderStage stage, uint32_t slot, uint32_t buffer)
+	{
+		SetShaderResource(stage, slot, mBuffers.at(buffer).View.Get());
+	}
+
+	void D3D11RenderDevice::SetSampler(ShaderStage stage, uint32_t slot, SamplerType sampler)
+	{
+		ID3D11SamplerState* samplerState = nullptr;
+		switch (sampler)
+		{
+		case SamplerType::TrilinearClamp:
+			samplerState = SamplerStates::TrilinearClamp.Get();
+			break;
+
+		case SamplerType::PointClamp:
+			samplerState = SamplerStates::PointClamp.Get();
+			break;
+
+		default:
+			samplerState = SamplerStates::TrilinearWrap.Get();
+			break;
+		}
+
+		if (stage == ShaderStage::Vertex)
+		{
+			mGame->Direct3DDeviceContext()->VSSetSamplers(slot, 1, &samplerState);
+		}
+		else
+		{
+			mGame->Direct3DDeviceContext()->PSSetSamplers(slot, 1, &samplerState);
+		}
+	}
+
+	void D3D11RenderDevice::Draw(uint32_t vertexCount, uint32_t startVertex)
+	{
+		mGame->Direct3DDeviceContext()->Draw(vertexCount, startVertex);
+	}
+
+	void D3D11RenderDevice::DrawIndexedInstanced(uint32_t indexCount, uint32_t instanceCount, uint32_t startIndex, int32_t baseVertex, uint32_t startInstance)
+	{
+		mGame->Direct3DDeviceContext()->DrawIndexedInstanced(indexCount, instanceCount, startIndex, baseVertex, startInstance);
+	}
+
+	void D3D11RenderDevice::SetShaderResource(ShaderStage stage, uint32_t slot, ID3D11ShaderResourceView* view)
+	{
+		if (stage == ShaderStage::Vertex)
+		{
+			mGame->Direct3DDeviceContext()->VSSetShaderResources(slot, 1, &view);
+		}
+		else
+		{
+			mGame->Direct3DDeviceContext()->PSSetShaderResources(slot, 1, &view);
+		}
+	}
+}
\ No newline at end of file
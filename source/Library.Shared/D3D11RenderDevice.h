@@ -0,0 +1,96 @@
+#pragma once
+
+#include "RTTI.h"
+#include "RenderDevice.h"
+#include <vector>
+#include <cstdint>
+#include <d3d11_2.h>
+#include <wrl.h>
+
+namespace Library
+{
+	class Game;
+
+	/**
+	* The render device on the Direct3D 11 device and immediate context of the game. Buffers and textures created
+	* elsewhere, such as the mesh buffers of the model cache, can be added to it to be bound by handle like its own.
+	*
+	* The device is registered as a service of the game.
+	*/
+	class D3D11RenderDevice final : public RTTI, public RenderDevice
+	{
+		RTTI_DECLARATIONS(D3D11RenderDevice, RTTI)
+
+	public:
+		D3D11RenderDevice(Game& game);
+		D3D11RenderDevice(const D3D11RenderDevice&) = delete;
+		D3D11RenderDevice& operator=(const D3D11RenderDevice&) = delete;
+		D3D11RenderDevice(D3D11RenderDevice&&) = delete;
+		D3D11RenderDevice& operator=(D3D11RenderDevice&&) = delete;
+		~D3D11RenderDevice() = default;
+
+		virtual std::uint32_t CreateBuffer(const BufferDescription& description, const void* data) override;
+		virtual std::uint32_t CreateTexture(const TextureDescription& description, const SubresourceData* subresources) override;
+		virtual std::uint32_t CreateShader(const void* vertexShader, std::size_t vertexShaderSize, const void* pixelShader, std::size_t pixelShaderSize,
+			const VertexElement* vertexElements, std::uint32_t vertexElementCount) override;
+		virtual std::uint32_t CreateState(const StateDescription& description) override;
+		virtual void ReleaseBuffer(std::uint32_t buffer) override;
+		virtual bool SupportsConstantBufferOffsets() const override;
+
+		/**
+		* Give a handle to a buffer created on the device elsewhere.
+		*/
+		std::uint32_t AddBuffer(ID3D11Buffer* buffer);
+		/**
+		* Give a handle to a texture created on the device elsewhere.
+		*/
+		std::uint32_t AddTexture(ID3D11ShaderResourceView* texture);
+
+		virtual void* Map(std::uint32_t buffer, bool discard) override;
+		virtual void Unmap(std::uint32_t buffer, std::uint32_t writtenSize) override;
+		virtual void UpdateBuffer(std::uint32_t buffer, const void* data, std::uint32_t size) override;
+
+		virtual void SetState(std::uint32_t state) override;
+		virtual void SetShader(std::uint32_t shader) override;
+		virtual void SetPrimitiveTopology(PrimitiveTopology topology) override;
+		virtual void SetVertexBuffer(std::uint32_t buffer, std::uint32_t stride) override;
+		virtual void SetIndexBuffer(std::uint32_t buffer) override;
+		virtual void SetConstantBuffer(ShaderStage stage, std::uint32_t slot, std::uint32_t buffer, std::uint32_t firstConstant, std::uint32_t constantCount) override;
+		virtual void SetTexture(ShaderStage stage, std::uint32_t slot, std::uint32_t texture) override;
+		virtual void SetStructuredBuffer(ShaderStage stage, std::uint32_t slot, std::uint32_t buffer) override;
+		virtual void SetSampler(ShaderStage stage, std::uint32_t slot, SamplerType sampler) override;
+
+		virtual void Draw(std::uint32_t vertexCount, std::uint32_t startVertex) override;
+		virtual void DrawIndexedInstanced(std::uint32_t indexCount, std::uint32_t instanceCount, std::uint32_t startIndex, std::int32_t baseVertex, std::uint32_t startInstance) override;
+
+	private:
+		struct BufferEntry
+		{
+			Microsoft::WRL::ComPtr<ID3D11Buffer> Buffer;
+			Microsoft::WRL::ComPtr<ID3D11ShaderResourceView> View;		// Only for structured buffers
+		};
+
+		struct ShaderEntry
+		{
+			Microsoft::WRL::ComPtr<ID3D11VertexShader> VertexShader;
+			Microsoft::WRL::ComPtr<ID3D11PixelShader> PixelShader;
+			Microsoft::WRL::ComPtr<ID3D11InputLayout> InputLayout;
+		};
+
+		struct StateEntry
+		{
+			Microsoft::WRL::ComPtr<ID3D11BlendState> BlendState;
+			Microsoft::WRL::ComPtr<ID3D11DepthStencilState> DepthStencilState;
+			Microsoft::WRL::ComPtr<ID3D11RasterizerState> RasterizerState;
+		};
+
+		void SetShaderResource(ShaderStage stage, std::uint32_t slot, ID3D11ShaderResourceView* view);
+
+		Game* mGame;
+		bool mConstantBufferOffsets;
+		std::vector<BufferEntry> mBuffers;
+		std::vector<Microsoft::WRL::ComPtr<ID3D11ShaderResourceView>> mTextures;
+		std::vector<ShaderEntry> mShaders;
+		std::vector<StateEntry> mStates;
+	};
+}
\ No newline at end of file
@@ -0,0 +1,44 @@
+#include "pch.h"
+
+using namespace std;
+
+namespace Library
+{
+	RTTI_DEFINITIONS(DeviceConstantBufferStorage)
+
+	DeviceConstantBufferStorage::DeviceConstantBufferStorage(RenderDevice& device, uint32_t size) :
+		mDevice(&device), mSize(size), mBuffer(RenderDevice::NullHandle)
+	{
+		if (mDevice->SupportsConstantBufferOffsets() == false)
+		{
+			throw GameException("The device cannot bind constant buffers at an offset.");
+		}
+
+		mBuffer = mDevice->CreateBuffer({ RenderDevice::BufferType::Constant, true, size, 0 }, nullptr);
+	}
+
+	uint32_t DeviceConstantBufferStorage::Size() const
+	{
+		return mSize;
+	}
+
+	void* DeviceConstantBufferStorage::Map(bool discard)
+	{
+		return mDevice->Map(mBuffer, discard);
+	}
+
+	void DeviceConstantBufferStorage::Unmap(uint32_t writtenSize)
+	{
+		mDevice->Unmap(mBuffer, writtenSize);
+	}
+
+	uint32_t DeviceConstantBufferStorage::Buffer() const
+	{
+		return mBuffer;
+	}
+
+	void DeviceConstantBufferStorage::SetConstantBuffer(RenderDevice::ShaderStage stage, uint32_t slot, const FrameConstantAllocator::Allocation& allocation) const
+	{
+		mDevice->SetConstantBuffer(stage, slot, mBuffer, allocation.FirstConstant, allocation.ConstantCount);
+	}
+}
\ No newline at end of file
@@ -0,0 +1,47 @@
+#pragma once
+
+#include "RTTI.h"
+#include "FrameConstantAllocator.h"
+#include "RenderDevice.h"
+#include <cstdint>
+
+namespace Library
+{
+	/**
+	* A dynamic constant buffer on a render device, for the frame constant allocator. Shaders are given their blocks of
+	* it by binding the buffer at an offset, which the constructor checks the device supports.
+	*
+	* The storage is registered as a service of the game, so components can bind the buffer their blocks are in.
+	*/
+	class DeviceConstantBufferStorage final : public RTTI, public ConstantBufferStorage
+	{
+		RTTI_DECLARATIONS(DeviceConstantBufferStorage, RTTI)
+
+	public:
+		DeviceConstantBufferStorage(RenderDevice& device, std::uint32_t size);
+		DeviceConstantBufferStorage(const DeviceConstantBufferStorage&) = delete;
+		DeviceConstantBufferStorage& operator=(const DeviceConstantBufferStorage&) = delete;
+		DeviceConstantBufferStorage(DeviceConstantBufferStorage&&) = delete;
+		DeviceConstantBufferStorage& operator=(DeviceConstantBufferStorage&&) = delete;
+		~DeviceConstantBufferStorage() = default;
+
+		virtual std::uint32_t Size() const override;
+		virtual void* Map(bool discard) override;
+		virtual void Unmap(std::uint32_t writtenSize) override;
+
+		/**
+		* Get the handle of the buffer on the device.
+		*/
+		std::uint32_t Buffer() const;
+
+		/**
+		* Bind a block of the buffer to a shader stage.
+		*/
+		void SetConstantBuffer(RenderDevice::ShaderStage stage, std::uint32_t slot, const FrameConstantAllocator::Allocation& allocation) const;
+
+	private:
+		RenderDevice* mDevice;
+		std::uint32_t mSize;
+		std::uint32_t mBuffer;
+	};
+}
\ No newline at end of file
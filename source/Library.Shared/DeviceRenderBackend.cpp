@@ -0,0 +1,76 @@
+#include "pch.h"
+
+using namespace std;
+
+namespace Library
+{
+	RTTI_DEFINITIONS(DeviceRenderBackend)
+
+	DeviceRenderBackend::DeviceRenderBackend(RenderDevice& device) :
+		mDevice(&device)
+	{
+		AddPass(mDevice->CreateState({ RenderDevice::BlendMode::Opaque, RenderDevice::DepthMode::ReadWrite, RenderDevice::CullMode::Back }));
+
+		// The first texture is RenderQueue::NoTexture, which is never bound
+		mTextures.push_back({ RenderDevice::NullHandle, 0 });
+	}
+
+	uint32_t DeviceRenderBackend::AddPass(uint32_t state)
+	{
+		if (mPasses.size() >= (1U << RenderQueue::PassBits))
+		{
+			throw GameException("There are more passes than render queue keys can hold.");
+		}
+
+		mPasses.push_back(state);
+		return static_cast<uint32_t>(mPasses.size() - 1);
+	}
+
+	uint32_t DeviceRenderBackend::AddShader(uint32_t shader)
+	{
+		if (mShaders.size() >= (1U << RenderQueue::ShaderBits))
+		{
+			throw GameException("There are more shaders than render queue keys can hold.");
+		}
+
+		mShaders.push_back(shader);
+		return static_cast<uint32_t>(mShaders.size() - 1);
+	}
+
+	uint32_t DeviceRenderBackend::AddTexture(uint32_t texture, uint32_t slot)
+	{
+		if (mTextures.size() >= (1U << RenderQueue::TextureBits))
+		{
+			throw GameException("There are more textures than render queue keys can hold.");
+		}
+
+		mTextures.push_back({ texture, slot });
+		return static_cast<uint32_t>(mTextures.size() - 1);
+	}
+
+	RenderDevice& DeviceRenderBackend::Device() const
+	{
+		return *mDevice;
+	}
+
+	void DeviceRenderBackend::BindPass(uint32_t pass)
+	{
+		mDevice->SetState(mPasses.at(pass));
+	}
+
+	void DeviceRenderBackend::BindShader(uint32_t shader)
+	{
+		mDevice->SetShader(mShaders.at(shader));
+	}
+
+	void DeviceRenderBackend::BindTexture(uint32_t texture)
+	{
+		const TextureState& state = mTextures.at(texture);
+		mDevice->SetTexture(RenderDevice::ShaderStage::Pixel, state.Slot, state.Texture);
+	}
+
+	void DeviceRenderBackend::Draw(const DrawPacket& packet)
+	{
+		packet.Client->ExecuteDraw(packet.Command);
+	}
+}
\ No newline at end of file
@@ -0,0 +1,72 @@
+#pragma once
+
+#include "RTTI.h"
+#include "RenderQueue.h"
+#include <vector>
+#include <cstdint>
+
+namespace Library
+{
+	class RenderDevice;
+
+	/**
+	* Executes the render queue on a render device. Components register the passes, shaders and textures their draws
+	* use, created on the device, and put the identifiers returned into the keys of their packets; the backend binds
+	* them as the keys change, and the client of each packet binds the rest of its state and draws.
+	*
+	* The backend is registered as a service of the game.
+	*/
+	class DeviceRenderBackend final : public RTTI, public RenderBackend
+	{
+		RTTI_DECLARATIONS(DeviceRenderBackend, RTTI)
+
+	public:
+		/**
+		* The pass registered by the backend itself, drawing opaque, depth tested and back faces culled.
+		*/
+		static const std::uint32_t DefaultPass = 0;
+
+		DeviceRenderBackend(RenderDevice& device);
+		DeviceRenderBackend(const DeviceRenderBackend&) = delete;
+		DeviceRenderBackend& operator=(const DeviceRenderBackend&) = delete;
+		DeviceRenderBackend(DeviceRenderBackend&&) = delete;
+		DeviceRenderBackend& operator=(DeviceRenderBackend&&) = delete;
+		~DeviceRenderBackend() = default;
+
+		/**
+		* Register the state of a pass.
+		* @return The pass to put into keys.
+		*/
+		std::uint32_t AddPass(std::uint32_t state);
+		/**
+		* Register a shader of the device.
+		* @return The shader to put into keys.
+		*/
+		std::uint32_t AddShader(std::uint32_t shader);
+		/**
+		* Register a texture read by pixel shaders.
+		* @param slot The shader resource slot the texture is bound to.
+		* @return The texture to put into keys, never RenderQueue::NoTexture.
+		*/
+		std::uint32_t AddTexture(std::uint32_t texture, std::uint32_t slot);
+
+		RenderDevice& Device() const;
+
+		virtual void BindPass(std::uint32_t pass) override;
+		virtual void BindShader(std::uint32_t shader) override;
+		virtual void BindTexture(std::uint32_t texture) override;
+		virtual void Draw(const DrawPacket& packet) override;
+
+	private:
+		struct TextureState
+		{
+			std::uint32_t Texture;
+			std::uint32_t Slot;
+		};
+
+		RenderDevice* mDevice;
+		std::vector<std::uint32_t> mPasses;
+		std::vector<std::uint32_t> mShaders;
+		std::vector<TextureState> mTextures;
+	};
+}
\ No newline at end of file
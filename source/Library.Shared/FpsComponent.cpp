@@ -7,15 +7,15 @@ namespace Library
 {
 	RTTI_DEFINITIONS(FpsComponent)
 
-	FpsComponent::FpsComponent(Game& game) :
-		DrawableGameComponent(game),
-		mTextPosition(0.0f, 20.0f), mFrameCount(0), mFrameRate(0)
+	FpsComponent::FpsComponent(Game& game, TextOverlay& textOverlay) :
+		GameComponent(game),
+		mTextOverlay(&textOverlay), mText(textOverlay.AddText(XMFLOAT2(0.0f, 20.0f), L"FPS: 0")), mFrameCount(0), mFrameRate(0)
 	{
 	}
 
-	XMFLOAT2& FpsComponent::TextPosition()
+	void FpsComponent::SetTextPosition(const XMFLOAT2& position)
 	{
-		return mTextPosition;
+		mTextOverlay->SetPosition(mText, position);
 	}
 
 	int FpsComponent::FrameRate() const
@@ -23,12 +23,6 @@ namespace Library
 		return mFrameCount;
 	}
 
-	void FpsComponent::Initialize()
-	{
-		mSpriteBatch = make_unique<SpriteBatch>(mGame->Direct3DDeviceContext());
-		mSpriteFont = make_unique<SpriteFont>(mGame->Direct3DDevice(), L"Content\\Fonts\\Arial_14_Regular.spritefont");
-	}
-
 	void FpsComponent::Update(const GameTime& gameTime)
 	{
 		if ((gameTime.TotalGameTime() - mLastTotalGameTime).count() >= 1000)
@@ -36,21 +30,11 @@ namespace Library
 			mLastTotalGameTime = gameTime.TotalGameTime();
 			mFrameRate = mFrameCount;
 			mFrameCount = 0;
+
+			// The overlay lays the text out again only when the rate has changed
+			mTextOverlay->SetText(mText, L"FPS: " + to_wstring(mFrameRate));
 		}
 
 		++mFrameCount;
 	}
-
-	void FpsComponent::Draw(const GameTime& gameTime)
-	{
-		mSpriteBatch->Begin();
-
-		wostringstream fpsLabel;
-		fpsLabel << setprecision(4) << L"FPS: " << mFrameRate;
-		mSpriteFont->DrawString(mSpriteBatch.get(), fpsLabel.str().c_str(), mTextPosition);
-		
-		fpsLabel << "    Elapsed Time: " << gameTime.TotalGameTimeSeconds().count();
-
-		mSpriteBatch->End();
-	}
 }
\ No newline at end of file
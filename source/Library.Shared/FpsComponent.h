@@ -1,40 +1,36 @@
 #pragma once
 
-#include "DrawableGameComponent.h"
+#include "GameComponent.h"
 #include <DirectXMath.h>
 #include <chrono>
-#include <memory>
-
-namespace DirectX
-{
-	class SpriteBatch;
-	class SpriteFont;
-}
+#include <cstdint>
 
 namespace Library
 {
-	class FpsComponent final : public DrawableGameComponent
+	class TextOverlay;
+
+	/**
+	* Counts the frames drawn each second and shows the rate in a text overlay, updating the text once a second.
+	*/
+	class FpsComponent final : public GameComponent
 	{
-		RTTI_DECLARATIONS(FpsComponent, DrawableGameComponent)
+		RTTI_DECLARATIONS(FpsComponent, GameComponent)
 
 	public:
-		FpsComponent(Game& game);
+		FpsComponent(Game& game, TextOverlay& textOverlay);
 
 		FpsComponent() = delete;
 		FpsComponent(const FpsComponent&) = delete;
 		FpsComponent& operator=(const FpsComponent&) = delete;
 
-		DirectX::XMFLOAT2& TextPosition();
+		void SetTextPosition(const DirectX::XMFLOAT2& position);
 		int FrameRate() const;
 
-		virtual void Initialize() override;
 		virtual void Update(const GameTime& gameTime) override;
-		virtual void Draw(const GameTime& gameTime) override;
 
 	private:
-		std::unique_ptr<DirectX::SpriteBatch> mSpriteBatch;
-		std::unique_ptr<DirectX::SpriteFont> mSpriteFont;
-		DirectX::XMFLOAT2 mTextPosition;
+		TextOverlay* mTextOverlay;
+		std::uint32_t mText;
 
 		int mFrameCount;
 		int mFrameRate;
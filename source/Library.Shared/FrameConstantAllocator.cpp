@@ -0,0 +1,69 @@
+#include "pch.h"
+
+using namespace std;
+
+namespace Library
+{
+	RTTI_DEFINITIONS(FrameConstantAllocator)
+
+	FrameConstantAllocator::FrameConstantAllocator(unique_ptr<ConstantBufferStorage>&& storage) :
+		mStorage(move(storage)), mMappedData(nullptr), mMappedCursor(0), mCursor(0), mDiscardNext(true)
+	{
+		assert(mStorage != nullptr);
+	}
+
+	FrameConstantAllocator::~FrameConstantAllocator()
+	{
+		Flush();
+	}
+
+	void FrameConstantAllocator::BeginFrame()
+	{
+		Flush();
+		mCursor = 0;
+		mDiscardNext = true;
+	}
+
+	void FrameConstantAllocator::Flush()
+	{
+		if (mMappedData != nullptr)
+		{
+			mStorage->Unmap(mCursor - mMappedCursor);
+			mMappedData = nullptr;
+		}
+	}
+
+	FrameConstantAllocator::Allocation FrameConstantAllocator::Allocate(uint32_t size)
+	{
+		assert(size > 0);
+
+		// The blocks of a frame are read once the frame is drawn, so the buffer cannot wrap around within it
+		uint32_t alignedSize = (size + Alignment - 1) & ~(Alignment - 1);
+		if (alignedSize > mStorage->Size() - mCursor)
+		{
+			throw GameException("The constants of the frame do not fit in the buffer of the allocator.");
+		}
+
+		if (mMappedData == nullptr)
+		{
+			mMappedData = static_cast<uint8_t*>(mStorage->Map(mDiscardNext));
+			mMappedCursor = mCursor;
+			mDiscardNext = false;
+		}
+
+		Allocation allocation = { mMappedData + mCursor, mCursor, mCursor / ConstantSize, alignedSize / ConstantSize };
+		mCursor += alignedSize;
+
+		return allocation;
+	}
+
+	ConstantBufferStorage& FrameConstantAllocator::Storage() const
+	{
+		return *mStorage;
+	}
+
+	uint32_t FrameConstantAllocator::UsedSize() const
+	{
+		return mCursor;
+	}
+}
\ No newline at end of file
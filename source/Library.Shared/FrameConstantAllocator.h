@@ -0,0 +1,104 @@
+#pragma once
+
+#include "RTTI.h"
+#include <memory>
+#include <cstdint>
+#include <cstring>
+
+namespace Library
+{
+	/**
+	* The buffer a frame constant allocator writes into, for a device or for measurement.
+	*/
+	class ConstantBufferStorage
+	{
+	public:
+		virtual ~ConstantBufferStorage() = default;
+
+		virtual std::uint32_t Size() const = 0;
+		/**
+		* Map the buffer for writing.
+		* @param discard True to give up the previous contents, false to promise not to overwrite any range already in use.
+		*/
+		virtual void* Map(bool discard) = 0;
+		/**
+		* @param writtenSize The number of bytes written while the buffer was mapped, for measurement.
+		*/
+		virtual void Unmap(std::uint32_t writtenSize) = 0;
+	};
+
+	/**
+	* Hands out the constants of a frame from one large buffer, so each object writes its constants once and the
+	* shaders are given a window of the buffer instead of a buffer of their own. Allocations are aligned to 256 bytes,
+	* as binding a constant buffer at an offset requires, and the buffer stays mapped while the components submit their
+	* draws: the first map of a frame discards the buffer and any later one maps without overwriting, so a frame that
+	* writes all its constants before drawing maps the buffer once.
+	*
+	* The allocator is registered as a service of the game. It has no device dependencies beyond its storage.
+	*/
+	class FrameConstantAllocator final : public RTTI
+	{
+		RTTI_DECLARATIONS(FrameConstantAllocator, RTTI)
+
+	public:
+		static const std::uint32_t Alignment = 256;
+		static const std::uint32_t ConstantSize = 16;
+
+		/**
+		* A block of the buffer, with its place given as shader constants for binding at an offset.
+		*/
+		struct Allocation
+		{
+			void* Data;
+			std::uint32_t Offset;
+			std::uint32_t FirstConstant;
+			std::uint32_t ConstantCount;		// Always a multiple of 16
+		};
+
+		FrameConstantAllocator(std::unique_ptr<ConstantBufferStorage>&& storage);
+		FrameConstantAllocator(const FrameConstantAllocator&) = delete;
+		FrameConstantAllocator& operator=(const FrameConstantAllocator&) = delete;
+		FrameConstantAllocator(FrameConstantAllocator&&) = delete;
+		FrameConstantAllocator& operator=(FrameConstantAllocator&&) = delete;
+		~FrameConstantAllocator();
+
+		/**
+		* Start a frame, releasing every block of the previous one.
+		*/
+		void BeginFrame();
+		/**
+		* Unmap the buffer so the device can read the blocks written so far. Blocks may still be allocated afterwards.
+		*/
+		void Flush();
+
+		/**
+		* Allocate a block for the current frame.
+		* @param size The size of the block in bytes, rounded up to the alignment.
+		*/
+		Allocation Allocate(std::uint32_t size);
+
+		/**
+		* Allocate a block and copy a constant buffer structure into it.
+		*/
+		template <typename T>
+		Allocation Upload(const T& data)
+		{
+			Allocation allocation = Allocate(sizeof(T));
+			memcpy(allocation.Data, &data, sizeof(T));
+			return allocation;
+		}
+
+		ConstantBufferStorage& Storage() const;
+		/**
+		* Get the number of bytes allocated in the current frame, including alignment.
+		*/
+		std::uint32_t UsedSize() const;
+
+	private:
+		std::unique_ptr<ConstantBufferStorage> mStorage;
+		std::uint8_t* mMappedData;
+		std::uint32_t mMappedCursor;
+		std::uint32_t mCursor;
+		bool mDiscardNext;
+	};
+}
\ No newline at end of file
@@ -3,7 +3,7 @@
 namespace Library
 {
 	GameException::GameException(const char* const& message, HRESULT hr) :
-		exception(message), mHR(hr)
+		runtime_error(message), mHR(hr)
 	{
 	}
 
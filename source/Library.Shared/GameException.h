@@ -1,12 +1,12 @@
 #pragma once
 
-#include <windows.h>
-#include <exception>
+#include "Platform.h"
+#include <stdexcept>
 #include <string>
 
 namespace Library
 {
-	class GameException : public std::exception
+	class GameException : public std::runtime_error
 	{
 	public:
 		GameException(const char* const& message, HRESULT hr = S_OK);
@@ -0,0 +1,79 @@
+#pragma once
+
+namespace Library
+{
+	/**
+	* Math written with plain arithmetic only, without branches or library calls, so that a loop
+	* across the lanes of a block calling it can be vectorized under the precise floating point model.
+	*/
+	class LaneMath final
+	{
+	public:
+		/**
+		* Round to the nearest integer, ties to even. Adding and subtracting 1.5 * 2^52 rounds any double of magnitude
+		* below 2^51, where floor() would not vectorize.
+		*/
+		static double RoundToNearest(double value)
+		{
+			return (value + 6755399441055744.0) - 6755399441055744.0;
+		}
+
+		/**
+		* Round a float of magnitude below 2^22 to the nearest integer, ties to even, adding and subtracting 1.5 * 2^23.
+		*/
+		static float RoundToNearest(float value)
+		{
+			return (value + 12582912.0f) - 12582912.0f;
+		}
+
+		/**
+		* Reduce an angle in radians to [-pi, pi].
+		*/
+		static double WrapTwoPi(double angle)
+		{
+			return angle - 6.28318530717958647693 * RoundToNearest(angle * (1.0 / 6.28318530717958647693));
+		}
+
+		/**
+		* Sine and cosine of an angle in radians. The angle is reduced to within a quarter turn of zero and evaluated
+		* with the minimax polynomials of the Cephes library, to within a unit or two in the last place for angles up to
+		* about a million radians.
+		*/
+		static void SinCos(double angle, double& sine, double& cosine)
+		{
+			// The quarter turn is split into parts whose products with small integers are exact
+			double quadrant = RoundToNearest(angle * 0.63661977236758134308);
+			double r = ((angle - quadrant * 1.57079632673412561417e+00) - quadrant * 6.07710050630396597660e-11) - quadrant * 2.02226624879595063154e-21;
+			double z = r * r;
+
+			double s = r + r * z * (((((1.58962301576546568060e-10 * z - 2.50507477628578072866e-8) * z + 2.75573136213857245213e-6) * z
+				- 1.98412698295895385996e-4) * z + 8.33333333332211858878e-3) * z - 1.66666666666666307295e-1);
+			double c = 1.0 - 0.5 * z + z * z * (((((-1.13585365213876817300e-11 * z + 2.08757008419747316778e-9) * z - 2.75573141792967388112e-7) * z
+				+ 2.48015872888517045348e-5) * z - 1.38888888888730564116e-3) * z + 4.16666666666665929218e-2);
+
+			// Rotate by the quadrant: odd quadrants swap sine and cosine, and the signs follow the quadrant
+			// For whole numbers, floor(n / 4) is n / 4 rounded after an offset that keeps it clear of a tie
+			double q = quadrant - 4.0 * RoundToNearest((quadrant - 1.5) * 0.25);
+			double half = RoundToNearest((q - 0.5) * 0.5);
+			double odd = q - 2.0 * half;
+			double oddOrHalf = odd + half - 2.0 * odd * half;
+			sine = (1.0 - 2.0 * half) * (s + odd * (c - s));
+			cosine = (1.0 - 2.0 * oddOrHalf) * (c + odd * (s - c));
+		}
+
+		/**
+		* Cosine of an angle in radians, as computed by SinCos().
+		*/
+		static double Cos(double angle)
+		{
+			double sine;
+			double cosine;
+			SinCos(angle, sine, cosine);
+			return cosine;
+		}
+
+		LaneMath() = delete;
+		LaneMath(const LaneMath&) = delete;
+		LaneMath& operator=(const LaneMath&) = delete;
+	};
+}
\ No newline at end of file
@@ -0,0 +1,74 @@
+#include "pch.h"
+
+using namespace std;
+
+namespace Library
+{
+	MemoryConstantBufferStorage::MemoryConstantBufferStorage(uint32_t size) :
+		mData(size), mDiscardCount(0), mNoOverwriteCount(0), mWrittenSize(0), mMapped(false)
+	{
+	}
+
+	uint32_t MemoryConstantBufferStorage::Size() const
+	{
+		return static_cast<uint32_t>(mData.size());
+	}
+
+	void* MemoryConstantBufferStorage::Map(bool discard)
+	{
+		if (mMapped)
+		{
+			throw GameException("The constant buffer is already mapped.");
+		}
+
+		// A discarded buffer holds nothing worth reading, which a fill makes visible to whoever checks
+		if (discard)
+		{
+			fill(mData.begin(), mData.end(), static_cast<uint8_t>(0xCD));
+			++mDiscardCount;
+		}
+		else
+		{
+			++mNoOverwriteCount;
+		}
+
+		mMapped = true;
+		return mData.data();
+	}
+
+	void MemoryConstantBufferStorage::Unmap(uint32_t writtenSize)
+	{
+		if (mMapped == false)
+		{
+			throw GameException("The constant buffer is not mapped.");
+		}
+
+		mWrittenSize += writtenSize;
+		mMapped = false;
+	}
+
+	const uint8_t* MemoryConstantBufferStorage::Data() const
+	{
+		return mData.data();
+	}
+
+	uint32_t MemoryConstantBufferStorage::DiscardCount() const
+	{
+		return mDiscardCount;
+	}
+
+	uint32_t MemoryConstantBufferStorage::NoOverwriteCount() const
+	{
+		return mNoOverwriteCount;
+	}
+
+	uint64_t MemoryConstantBufferStorage::WrittenSize() const
+	{
+		return mWrittenSize;
+	}
+
+	bool MemoryConstantBufferStorage::Mapped() const
+	{
+		return mMapped;
+	}
+}
\ No newline at end of file
@@ -0,0 +1,43 @@
+#pragma once
+
+#include "FrameConstantAllocator.h"
+#include <vector>
+#include <cstdint>
+
+namespace Library
+{
+	/**
+	* Constant buffer storage in system memory, counting how it is mapped, so the frame constant allocator can be run
+	* and checked without a device.
+	*/
+	class MemoryConstantBufferStorage final : public ConstantBufferStorage
+	{
+	public:
+		MemoryConstantBufferStorage(std::uint32_t size);
+		MemoryConstantBufferStorage(const MemoryConstantBufferStorage&) = delete;
+		MemoryConstantBufferStorage& operator=(const MemoryConstantBufferStorage&) = delete;
+		MemoryConstantBufferStorage(MemoryConstantBufferStorage&&) = delete;
+		MemoryConstantBufferStorage& operator=(MemoryConstantBufferStorage&&) = delete;
+		~MemoryConstantBufferStorage() = default;
+
+		virtual std::uint32_t Size() const override;
+		virtual void* Map(bool discard) override;
+		virtual void Unmap(std::uint32_t writtenSize) override;
+
+		const std::uint8_t* Data() const;
+		std::uint32_t DiscardCount() const;
+		std::uint32_t NoOverwriteCount() const;
+		/**
+		* Get the number of bytes written across every map.
+		*/
+		std::uint64_t WrittenSize() const;
+		bool Mapped() const;
+
+	private:
+		std::vector<std::uint8_t> mData;
+		std::uint32_t mDiscardCount;
+		std::uint32_t mNoOverwriteCount;
+		std::uint64_t mWrittenSize;
+		bool mMapped;
+	};
+}
\ No newline at end of file
@@ -0,0 +1,183 @@
+#include "pch.h"
+
+using namespace std;
+
+namespace Library
+{
+#if defined(_WIN32)
+	MemoryMappedFile::MemoryMappedFile(const wstring& filename) :
+		mFile(INVALID_HANDLE_VALUE), mMapping(nullptr), mData(nullptr), mSize(0)
+	{
+		mFile = CreateFile(filename.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+		if (mFile == INVALID_HANDLE_VALUE)
+		{
+			throw GameException("Could not open file.", HRESULT_FROM_WIN32(GetLastError()));
+		}
+
+		LARGE_INTEGER size;
+		if (GetFileSizeEx(mFile, &size) == FALSE)
+		{
+			HRESULT hr = HRESULT_FROM_WIN32(GetLastError());
+			Close();
+			throw GameException("GetFileSizeEx() failed.", hr);
+		}
+
+		mSize = static_cast<size_t>(size.QuadPart);
+		if (mSize == 0)
+		{
+			// Empty files cannot be mapped; leave the view empty
+			return;
+		}
+
+		mMapping = CreateFileMapping(mFile, nullptr, PAGE_READONLY, 0, 0, nullptr);
+		if (mMapping == nullptr)
+		{
+			HRESULT hr = HRESULT_FROM_WIN32(GetLastError());
+			Close();
+			throw GameException("CreateFileMapping() failed.", hr);
+		}
+
+		mData = reinterpret_cast<const uint8_t*>(MapViewOfFile(mMapping, FILE_MAP_READ, 0, 0, 0));
+		if (mData == nullptr)
+		{
+			HRESULT hr = HRESULT_FROM_WIN32(GetLastError());
+			Close();
+			throw GameException("MapViewOfFile() failed.", hr);
+		}
+	}
+#else
+	MemoryMappedFile::MemoryMappedFile(const wstring& filename) :
+		mFile(-1), mData(nullptr), mSize(0)
+	{
+		mFile = open(Utility::ToPortablePath(filename).c_str(), O_RDONLY);
+		if (mFile == -1)
+		{
+			throw GameException("Could not open file.");
+		}
+
+		struct stat status;
+		if (fstat(mFile, &status) == -1)
+		{
+			Close();
+			throw GameException("fstat() failed.");
+		}
+
+		mSize = static_cast<size_t>(status.st_size);
+		if (mSize == 0)
+		{
+			// Empty files cannot be mapped; leave the view empty
+			return;
+		}
+
+		void* data = mmap(nullptr, mSize, PROT_READ, MAP_PRIVATE, mFile, 0);
+		if (data == MAP_FAILED)
+		{
+			Close();
+			throw GameException("mmap() failed.");
+		}
+
+		mData = reinterpret_cast<const uint8_t*>(data);
+	}
+#endif
+
+	MemoryMappedFile::MemoryMappedFile(MemoryMappedFile&& rhs) :
+#if defined(_WIN32)
+		mFile(rhs.mFile), mMapping(rhs.mMapping), mData(rhs.mData), mSize(rhs.mSize)
+	{
+		rhs.mFile = INVALID_HANDLE_VALUE;
+		rhs.mMapping = nullptr;
+		rhs.mData = nullptr;
+		rhs.mSize = 0;
+	}
+#else
+		mFile(rhs.mFile), mData(rhs.mData), mSize(rhs.mSize)
+	{
+		rhs.mFile = -1;
+		rhs.mData = nullptr;
+		rhs.mSize = 0;
+	}
+#endif
+
+	MemoryMappedFile& MemoryMappedFile::operator=(MemoryMappedFile&& rhs)
+	{
+		if (this != &rhs)
+		{
+			Close();
+
+			mFile = rhs.mFile;
+#if defined(_WIN32)
+			mMapping = rhs.mMapping;
+#endif
+			mData = rhs.mData;
+			mSize = rhs.mSize;
+
+#if defined(_WIN32)
+			rhs.mFile = INVALID_HANDLE_VALUE;
+			rhs.mMapping = nullptr;
+#else
+			rhs.mFile = -1;
+#endif
+			rhs.mData = nullptr;
+			rhs.mSize = 0;
+		}
+
+		return *this;
+	}
+
+	MemoryMappedFile::~MemoryMappedFile()
+	{
+		Close();
+	}
+
+	const uint8_t* MemoryMappedFile::Data() const
+	{
+		return mData;
+	}
+
+	size_t MemoryMappedFile::Size() const
+	{
+		return mSize;
+	}
+
+#if defined(_WIN32)
+	void MemoryMappedFile::Close()
+	{
+		if (mData != nullptr)
+		{
+			UnmapViewOfFile(mData);
+			mData = nullptr;
+		}
+
+		if (mMapping != nullptr)
+		{
+			CloseHandle(mMapping);
+			mMapping = nullptr;
+		}
+
+		if (mFile != INVALID_HANDLE_VALUE)
+		{
+			CloseHandle(mFile);
+			mFile = INVALID_HANDLE_VALUE;
+		}
+
+		mSize = 0;
+	}
+#else
+	void MemoryMappedFile::Close()
+	{
+		if (mData != nullptr)
+		{
+			munmap(const_cast<uint8_t*>(mData), mSize);
+			mData = nullptr;
+		}
+
+		if (mFile != -1)
+		{
+			close(mFile);
+			mFile = -1;
+		}
+
+		mSize = 0;
+	}
+#endif
+}
\ No newline at end of file
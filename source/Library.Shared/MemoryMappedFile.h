@@ -0,0 +1,37 @@
+#pragma once
+
+#include "Platform.h"
+#include <string>
+#include <cstdint>
+
+namespace Library
+{
+	/**
+	* A read-only view of an entire file mapped into the address space of the process.
+	*/
+	class MemoryMappedFile final
+	{
+	public:
+		MemoryMappedFile(const std::wstring& filename);
+		MemoryMappedFile(const MemoryMappedFile&) = delete;
+		MemoryMappedFile& operator=(const MemoryMappedFile&) = delete;
+		MemoryMappedFile(MemoryMappedFile&& rhs);
+		MemoryMappedFile& operator=(MemoryMappedFile&& rhs);
+		~MemoryMappedFile();
+
+		const std::uint8_t* Data() const;
+		std::size_t Size() const;
+
+	private:
+		void Close();
+
+#if defined(_WIN32)
+		HANDLE mFile;
+		HANDLE mMapping;
+#else
+		int mFile;
+#endif
+		const std::uint8_t* mData;
+		std::size_t mSize;
+	};
+}
\ No newline at end of file
@@ -146,6 +146,7 @@ const vector<uint32_t>& Mesh::Indices() const
 	return mData.Indices;
 }
 
+#if !defined(LIBRARY_PORTABLE)
 void Mesh::CreateIndexBuffer(ID3D11Device& device, ID3D11Buffer** indexBuffer)
 {
 	assert(indexBuffer != nullptr);
@@ -160,6 +161,7 @@ void Mesh::CreateIndexBuffer(ID3D11Device& device, ID3D11Buffer** indexBuffer)
 
 	ThrowIfFailed(device.CreateBuffer(&indexBufferDesc, &indexSubResourceData, indexBuffer), "ID3D11Device::CreateBuffer() failed.");
 }
+#endif
 
 void Mesh::Save(OutputStreamHelper& streamHelper) const
 {
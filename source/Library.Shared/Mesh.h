@@ -4,7 +4,9 @@
 #include <vector>
 #include <cstdint>
 #include <DirectXMath.h>
+#if !defined(LIBRARY_PORTABLE)
 #include <d3d11_2.h>
+#endif
 
 namespace Library
 {
@@ -61,7 +63,9 @@ namespace Library
 		std::uint32_t FaceCount() const;
 		const std::vector<std::uint32_t>& Indices() const;
 
+#if !defined(LIBRARY_PORTABLE)
         void CreateIndexBuffer(ID3D11Device& device, ID3D11Buffer** indexBuffer);
+#endif
 		void Save(OutputStreamHelper& streamHelper) const;
 
     private:
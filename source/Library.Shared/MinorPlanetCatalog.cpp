@@ -0,0 +1,555 @@
+#include "pch.h"
+
+using namespace std;
+
+namespace Library
+{
+	namespace
+	{
+		const size_t HashChunkSize = 4 * 1024 * 1024;
+		const uint64_t FnvOffsetBasis = 14695981039346656037ULL;
+		const uint64_t FnvPrime = 1099511628211ULL;
+
+		const size_t HeaderSearchLength = 64 * 1024;
+		const size_t MinimumParseChunkSize = 64 * 1024;
+		const uint32_t ChunksPerThread = 4;
+		const size_t MinimumRecordLength = 103;
+
+		/**
+		* A fixed-width decimal field of an MPCORB record, with a zero-based column offset.
+		*/
+		struct FixedField
+		{
+			uint32_t Offset;
+			uint32_t Width;
+			uint32_t Decimals;
+		};
+
+		const FixedField AbsoluteMagnitudeField = { 8, 5, 2 };
+		const FixedField SlopeParameterField = { 14, 5, 2 };
+		const uint32_t EpochOffset = 20;
+		const FixedField MeanAnomalyField = { 26, 9, 5 };
+		const FixedField ArgumentOfPerihelionField = { 37, 9, 5 };
+		const FixedField AscendingNodeField = { 48, 9, 5 };
+		const FixedField InclinationField = { 59, 9, 5 };
+		const FixedField EccentricityField = { 70, 9, 7 };
+		const FixedField MeanMotionField = { 80, 11, 8 };
+		const FixedField SemiMajorAxisField = { 92, 11, 7 };
+
+		const double PowersOfTen[] = { 1.0, 1.0e1, 1.0e2, 1.0e3, 1.0e4, 1.0e5, 1.0e6, 1.0e7, 1.0e8, 1.0e9, 1.0e10, 1.0e11, 1.0e12, 1.0e13, 1.0e14, 1.0e15 };
+
+		/**
+		* Whether all eight bytes of a word are ASCII digits. A byte below '0' borrows into its high bit and a byte above
+		* '9' carries into it.
+		*/
+		inline bool AllDigits(uint64_t word)
+		{
+			return (((word + 0x4646464646464646ULL) | (word - 0x3030303030303030ULL)) & 0x8080808080808080ULL) == 0;
+		}
+
+		/**
+		* The high bit of every byte of a word that is an ASCII space, and of no other byte.
+		*/
+		inline uint64_t SpaceBytes(uint64_t word)
+		{
+			uint64_t difference = word ^ 0x2020202020202020ULL;
+			return ~(((difference & 0x7F7F7F7F7F7F7F7FULL) + 0x7F7F7F7F7F7F7F7FULL) | difference) & 0x8080808080808080ULL;
+		}
+
+		/**
+		* Whether the bytes flagged by SpaceBytes() come before every other byte of the word in memory.
+		*/
+		inline bool AreLeading(uint64_t spaces)
+		{
+			uint64_t bytes = (spaces >> 7) * 0xFF;
+			return (bytes & (bytes + 1)) == 0;
+		}
+
+		/**
+		* Convert eight ASCII digits, most significant first in memory, by combining adjacent pairs, then quads, then halves.
+		*/
+		inline uint32_t ParseEightDigits(uint64_t word)
+		{
+			const uint64_t mask = 0x000000FF000000FFULL;
+			const uint64_t pairMultipliers = 100ULL + (1000000ULL << 32);
+			const uint64_t quadMultipliers = 1ULL + (10000ULL << 32);
+
+			word -= 0x3030303030303030ULL;
+			word = (word * 10) + (word >> 8);
+			word = (((word & mask) * pairMultipliers) + (((word >> 16) & mask) * quadMultipliers)) >> 32;
+
+			return static_cast<uint32_t>(word);
+		}
+
+		/**
+		* Parse an unsigned fixed-point field without looking at its characters one at a time. The digits either side of
+		* the decimal point are right-aligned into sixteen bytes of spaces, which must all lead the digits and are then
+		* turned into zeros.
+		* @return False if the field is not in that form, such as when it is blank, signed or has a space between digits.
+		*/
+		bool ParseFixedField(const char* record, const FixedField& field, double& value)
+		{
+			const char* text = record + field.Offset;
+			uint32_t integerDigits = field.Width - field.Decimals - 1;
+			if (text[integerDigits] != '.')
+			{
+				return false;
+			}
+
+			char digits[16];
+			memset(digits, ' ', sizeof(digits));
+			memcpy(digits + sizeof(digits) - field.Decimals, text + integerDigits + 1, field.Decimals);
+			memcpy(digits + sizeof(digits) - field.Decimals - integerDigits, text, integerDigits);
+
+			uint64_t high;
+			uint64_t low;
+			memcpy(&high, digits, sizeof(high));
+			memcpy(&low, digits + sizeof(high), sizeof(low));
+
+			// Spaces may only lead the integer digits, so the first decimal and every byte after it must not be one
+			uint64_t highSpaces = SpaceBytes(high);
+			uint64_t lowSpaces = SpaceBytes(low);
+			if (digits[sizeof(digits) - field.Decimals] == ' ' || AreLeading(highSpaces) == false || AreLeading(lowSpaces) == false ||
+				(lowSpaces != 0 && highSpaces != 0x8080808080808080ULL))
+			{
+				return false;
+			}
+
+			// Adding 0x10 to a space makes it '0', and every other byte must then be a digit
+			high += highSpaces >> 3;
+			low += lowSpaces >> 3;
+			if (AllDigits(high) == false || AllDigits(low) == false)
+			{
+				return false;
+			}
+
+			value = (ParseEightDigits(high) * 1.0e8 + ParseEightDigits(low)) / PowersOfTen[field.Decimals];
+			return true;
+		}
+
+		/**
+		* Parse a field the slow way, allowing a sign and free placement of the decimal point.
+		* @return False if the field holds anything other than a number; a blank field gives NaN.
+		*/
+		bool ParseFreeField(const char* record, const FixedField& field, double& value)
+		{
+			char buffer[32];
+			memcpy(buffer, record + field.Offset, field.Width);
+			buffer[field.Width] = '\0';
+
+			char* first = buffer;
+			while (*first == ' ')
+			{
+				++first;
+			}
+
+			if (*first == '\0')
+			{
+				value = numeric_limits<double>::quiet_NaN();
+				return true;
+			}
+
+			char* last;
+			value = strtod(first, &last);
+			while (*last == ' ')
+			{
+				++last;
+			}
+
+			return (last != first && *last == '\0');
+		}
+
+		/**
+		* @param optional Whether the field may be blank, which gives NaN.
+		*/
+		double ParseField(const char* record, const FixedField& field, bool optional = false)
+		{
+			double value;
+			if (ParseFixedField(record, field, value) == false)
+			{
+				if (ParseFreeField(record, field, value) == false || (optional == false && value != value))
+				{
+					throw GameException("Minor planet catalog has a malformed numeric field.");
+				}
+			}
+
+			return value;
+		}
+
+		/**
+		* Decode one character of a packed date: digits, then upper case letters from 10.
+		*/
+		int32_t UnpackDigit(char character)
+		{
+			if (character >= '0' && character <= '9')
+			{
+				return character - '0';
+			}
+
+			if (character >= 'A' && character <= 'Z')
+			{
+				return character - 'A' + 10;
+			}
+
+			return -1;
+		}
+
+		/**
+		* Decode a packed epoch such as K24AH (2024 October 17) to the Julian date at 0h TT.
+		*/
+		double UnpackEpoch(const char* packed)
+		{
+			int32_t century = UnpackDigit(packed[0]);
+			int32_t decade = UnpackDigit(packed[1]);
+			int32_t year = UnpackDigit(packed[2]);
+			int32_t month = UnpackDigit(packed[3]);
+			int32_t day = UnpackDigit(packed[4]);
+			if (century < 10 || decade < 0 || decade > 9 || year < 0 || year > 9 || month < 1 || month > 12 || day < 1 || day > 31)
+			{
+				throw GameException("Minor planet catalog has a malformed epoch.");
+			}
+
+			year += century * 100 + decade * 10;
+
+			// The Julian day number at noon of a Gregorian date
+			int32_t a = (14 - month) / 12;
+			int32_t y = year + 4800 - a;
+			int32_t m = month + 12 * a - 3;
+			int32_t julianDayNumber = day + (153 * m + 2) / 5 + 365 * y + y / 4 - y / 100 + y / 400 - 32045;
+
+			return julianDayNumber - 0.5;
+		}
+
+		/**
+		* Call a visitor with each line of a range and its length without the line terminator.
+		*/
+		template <typename Visitor>
+		void ForEachLine(const char* begin, const char* end, const Visitor& visit)
+		{
+			while (begin < end)
+			{
+				const char* newline = static_cast<const char*>(memchr(begin, '\n', end - begin));
+				const char* lineEnd = (newline != nullptr ? newline : end);
+				size_t length = lineEnd - begin;
+				if (length > 0 && begin[length - 1] == '\r')
+				{
+					--length;
+				}
+
+				visit(begin, length);
+				begin = (newline != nullptr ? newline + 1 : end);
+			}
+		}
+
+		/**
+		* Call a visitor with each column of the elements and the number of entries it holds per record, in file order.
+		*/
+		template <typename Visitor>
+		void VisitColumns(MinorPlanetElements& elements, const Visitor& visit)
+		{
+			visit(elements.Designations, MinorPlanetCatalog::DesignationStride);
+			visit(elements.AbsoluteMagnitudes, 1U);
+			visit(elements.SlopeParameters, 1U);
+			visit(elements.Epochs, 1U);
+			visit(elements.MeanAnomalies, 1U);
+			visit(elements.ArgumentsOfPerihelion, 1U);
+			visit(elements.AscendingNodes, 1U);
+			visit(elements.Inclinations, 1U);
+			visit(elements.Eccentricities, 1U);
+			visit(elements.MeanMotions, 1U);
+			visit(elements.SemiMajorAxes, 1U);
+		}
+
+		/**
+		* FNV-1a over 64-bit words instead of bytes, in four interleaved lanes so the multiplications do not wait on
+		* each other. The lanes and any trailing bytes are folded together at the end.
+		*/
+		uint64_t HashRange(const uint8_t* first, const uint8_t* last)
+		{
+			uint64_t lanes[4] = { FnvOffsetBasis, FnvOffsetBasis ^ 1, FnvOffsetBasis ^ 2, FnvOffsetBasis ^ 3 };
+			for (; last - first >= 32; first += 32)
+			{
+				for (uint32_t lane = 0; lane < 4; ++lane)
+				{
+					uint64_t word;
+					memcpy(&word, first + lane * sizeof(word), sizeof(word));
+					lanes[lane] = (lanes[lane] ^ word) * FnvPrime;
+				}
+			}
+
+			uint64_t hash = FnvOffsetBasis;
+			for (uint64_t lane : lanes)
+			{
+				hash = (hash ^ lane) * FnvPrime;
+			}
+
+			for (; first < last; ++first)
+			{
+				hash = (hash ^ *first) * FnvPrime;
+			}
+
+			return hash;
+		}
+
+		size_t PaddedSize(size_t size)
+		{
+			return (size + 7) & ~static_cast<size_t>(7);
+		}
+	}
+
+	const uint32_t MinorPlanetCatalog::DesignationLength = 7;
+	const uint32_t MinorPlanetCatalog::DesignationStride = 8;
+	const uint32_t MinorPlanetCatalog::CacheMagic = 0x4343504D; // "MPCC"
+	const uint32_t MinorPlanetCatalog::CacheVersion = 1;
+
+	MinorPlanetCatalog::MinorPlanetCatalog(const wstring& textFilename, const wstring& cacheFilename, ThreadPool& threadPool) :
+		mElements(), mLoadedFromCache(false)
+	{
+		MemoryMappedFile text(textFilename);
+		uint64_t sourceHash = Hash(text, threadPool);
+		uint64_t sourceSize = text.Size();
+
+		if (TryLoadCache(cacheFilename, sourceHash, sourceSize))
+		{
+			mLoadedFromCache = true;
+			return;
+		}
+
+		Parse(text, threadPool);
+		WriteCache(cacheFilename, sourceHash, sourceSize);
+	}
+
+	uint32_t MinorPlanetCatalog::Count() const
+	{
+		return mElements.Count;
+	}
+
+	const MinorPlanetElements& MinorPlanetCatalog::Elements() const
+	{
+		return mElements;
+	}
+
+	string MinorPlanetCatalog::Designation(uint32_t index) const
+	{
+		assert(index < mElements.Count);
+
+		string designation(&mElements.Designations[static_cast<size_t>(index) * DesignationStride]);
+		designation.erase(designation.find_last_not_of(' ') + 1);
+
+		return designation;
+	}
+
+	bool MinorPlanetCatalog::LoadedFromCache() const
+	{
+		return mLoadedFromCache;
+	}
+
+	uint64_t MinorPlanetCatalog::Hash(const MemoryMappedFile& file, ThreadPool& threadPool)
+	{
+		const uint8_t* data = file.Data();
+		size_t size = file.Size();
+		uint32_t chunkCount = static_cast<uint32_t>((size + HashChunkSize - 1) / HashChunkSize);
+
+		vector<uint64_t> chunkHashes(chunkCount);
+		threadPool.ParallelFor(chunkCount, 1, [&](uint32_t begin, uint32_t end)
+		{
+			for (uint32_t chunk = begin; chunk < end; ++chunk)
+			{
+				const uint8_t* first = data + static_cast<size_t>(chunk) * HashChunkSize;
+				const uint8_t* last = data + min(static_cast<size_t>(chunk + 1) * HashChunkSize, size);
+
+				chunkHashes[chunk] = HashRange(first, last);
+			}
+		});
+
+		// Fold the chunk hashes and the size into one hash so that moving bytes between chunks changes it
+		uint64_t hash = FnvOffsetBasis;
+		auto fold = [&](uint64_t value)
+		{
+			for (uint32_t i = 0; i < sizeof(value); ++i)
+			{
+				hash ^= (value >> (i * 8)) & 0xFF;
+				hash *= FnvPrime;
+			}
+		};
+
+		for (uint64_t chunkHash : chunkHashes)
+		{
+			fold(chunkHash);
+		}
+		fold(size);
+
+		return hash;
+	}
+
+	bool MinorPlanetCatalog::TryLoadCache(const wstring& cacheFilename, uint64_t sourceHash, uint64_t sourceSize)
+	{
+#if defined(_WIN32)
+		if (GetFileAttributes(cacheFilename.c_str()) == INVALID_FILE_ATTRIBUTES)
+#else
+		if (access(Utility::ToPortablePath(cacheFilename).c_str(), F_OK) != 0)
+#endif
+		{
+			return false;
+		}
+
+		MemoryMappedFile cache(cacheFilename);
+		if (cache.Size() < sizeof(MinorPlanetCacheHeader))
+		{
+			return false;
+		}
+
+		const MinorPlanetCacheHeader* header = reinterpret_cast<const MinorPlanetCacheHeader*>(cache.Data());
+		if (header->Magic != CacheMagic || header->Version != CacheVersion || header->SourceHash != sourceHash || header->SourceSize != sourceSize)
+		{
+			return false;
+		}
+
+		// A cache cut short by an interrupted write is rebuilt rather than trusted
+		mElements.Count = header->RecordCount;
+		size_t expectedSize = sizeof(MinorPlanetCacheHeader);
+		VisitColumns(mElements, [&](auto& column, uint32_t perRecord)
+		{
+			column.resize(static_cast<size_t>(mElements.Count) * perRecord);
+			expectedSize += PaddedSize(column.size() * sizeof(column[0]));
+		});
+
+		if (cache.Size() != expectedSize)
+		{
+			mElements = MinorPlanetElements();
+			return false;
+		}
+
+		const uint8_t* source = cache.Data() + sizeof(MinorPlanetCacheHeader);
+		VisitColumns(mElements, [&](auto& column, uint32_t)
+		{
+			size_t size = column.size() * sizeof(column[0]);
+			if (size > 0)
+			{
+				memcpy(column.data(), source, size);
+			}
+			source += PaddedSize(size);
+		});
+
+		return true;
+	}
+
+	void MinorPlanetCatalog::WriteCache(const wstring& cacheFilename, uint64_t sourceHash, uint64_t sourceSize)
+	{
+		// The cache only saves time, so an unwritable location leaves the import as it is
+#if defined(_WIN32)
+		ofstream stream(cacheFilename, ios::binary);
+#else
+		ofstream stream(Utility::ToPortablePath(cacheFilename), ios::binary);
+#endif
+		if (stream.is_open() == false)
+		{
+			return;
+		}
+
+		MinorPlanetCacheHeader header = { 0 };
+		header.Magic = CacheMagic;
+		header.Version = CacheVersion;
+		header.RecordCount = mElements.Count;
+		header.SourceHash = sourceHash;
+		header.SourceSize = sourceSize;
+		stream.write(reinterpret_cast<const char*>(&header), sizeof(header));
+
+		const char padding[8] = { 0 };
+		VisitColumns(mElements, [&](auto& column, uint32_t)
+		{
+			size_t size = column.size() * sizeof(column[0]);
+			stream.write(reinterpret_cast<const char*>(column.data()), size);
+			stream.write(padding, PaddedSize(size) - size);
+		});
+	}
+
+	void MinorPlanetCatalog::Parse(const MemoryMappedFile& text, ThreadPool& threadPool)
+	{
+		const char* begin = reinterpret_cast<const char*>(text.Data());
+		const char* end = begin + text.Size();
+
+		// Skip the header of a file downloaded from the Minor Planet Center, which ends with a line of dashes
+		ForEachLine(begin, begin + min(text.Size(), HeaderSearchLength), [&](const char* line, size_t length)
+		{
+			if (length >= 5 && memcmp(line, "-----", 5) == 0)
+			{
+				const char* newline = static_cast<const char*>(memchr(line, '\n', end - line));
+				begin = (newline != nullptr ? newline + 1 : end);
+			}
+		});
+
+		// Split the records into chunks of whole lines
+		size_t size = end - begin;
+		uint32_t chunkCount = static_cast<uint32_t>(max(min(static_cast<size_t>(threadPool.ThreadCount() * ChunksPerThread), size / MinimumParseChunkSize), static_cast<size_t>(1)));
+		vector<const char*> boundaries(chunkCount + 1);
+		boundaries[0] = begin;
+		boundaries[chunkCount] = end;
+		for (uint32_t chunk = 1; chunk < chunkCount; ++chunk)
+		{
+			const char* boundary = begin + size / chunkCount * chunk;
+			const char* newline = static_cast<const char*>(memchr(boundary, '\n', end - boundary));
+			boundaries[chunk] = max(boundaries[chunk - 1], (newline != nullptr ? newline + 1 : end));
+		}
+
+		// Count the records of every chunk, then parse each chunk straight into its place in the columns
+		vector<uint32_t> firstRecords(chunkCount + 1, 0);
+		threadPool.ParallelFor(chunkCount, 1, [&](uint32_t first, uint32_t last)
+		{
+			for (uint32_t chunk = first; chunk < last; ++chunk)
+			{
+				uint32_t count = 0;
+				ForEachLine(boundaries[chunk], boundaries[chunk + 1], [&](const char*, size_t length)
+				{
+					count += (length >= MinimumRecordLength ? 1 : 0);
+				});
+
+				firstRecords[chunk + 1] = count;
+			}
+		});
+
+		for (uint32_t chunk = 0; chunk < chunkCount; ++chunk)
+		{
+			firstRecords[chunk + 1] += firstRecords[chunk];
+		}
+
+		mElements.Count = firstRecords[chunkCount];
+		VisitColumns(mElements, [&](auto& column, uint32_t perRecord)
+		{
+			column.resize(static_cast<size_t>(mElements.Count) * perRecord);
+		});
+
+		threadPool.ParallelFor(chunkCount, 1, [&](uint32_t first, uint32_t last)
+		{
+			for (uint32_t chunk = first; chunk < last; ++chunk)
+			{
+				uint32_t index = firstRecords[chunk];
+				ForEachLine(boundaries[chunk], boundaries[chunk + 1], [&](const char* line, size_t length)
+				{
+					if (length >= MinimumRecordLength)
+					{
+						ParseRecord(line, index++);
+					}
+				});
+			}
+		});
+	}
+
+	void MinorPlanetCatalog::ParseRecord(const char* line, uint32_t index)
+	{
+		char* designation = &mElements.Designations[static_cast<size_t>(index) * DesignationStride];
+		memcpy(designation, line, DesignationLength);
+		memset(designation + DesignationLength, '\0', DesignationStride - DesignationLength);
+
+		mElements.AbsoluteMagnitudes[index] = static_cast<float>(ParseField(line, AbsoluteMagnitudeField, true));
+		mElements.SlopeParameters[index] = static_cast<float>(ParseField(line, SlopeParameterField, true));
+		mElements.Epochs[index] = UnpackEpoch(line + EpochOffset);
+		mElements.MeanAnomalies[index] = ParseField(line, MeanAnomalyField);
+		mElements.ArgumentsOfPerihelion[index] = ParseField(line, ArgumentOfPerihelionField);
+		mElements.AscendingNodes[index] = ParseField(line, AscendingNodeField);
+		mElements.Inclinations[index] = ParseField(line, InclinationField);
+		mElements.Eccentricities[index] = ParseField(line, EccentricityField);
+		mElements.MeanMotions[index] = ParseField(line, MeanMotionField);
+		mElements.SemiMajorAxes[index] = ParseField(line, SemiMajorAxisField);
+	}
+}
\ No newline at end of file
@@ -0,0 +1,97 @@
+#pragma once
+
+#include <vector>
+#include <string>
+#include <cstdint>
+
+namespace Library
+{
+	class MemoryMappedFile;
+	class ThreadPool;
+
+	/**
+	* Osculating orbital elements of minor planets in structure-of-arrays form, one entry per record in every array.
+	* Angles are in degrees, referred to the ecliptic and equinox of J2000.
+	*/
+	struct MinorPlanetElements
+	{
+		std::uint32_t Count;
+		std::vector<char> Designations;					// MinorPlanetCatalog::DesignationStride bytes per record, packed form
+		std::vector<float> AbsoluteMagnitudes;			// H, or NaN if absent
+		std::vector<float> SlopeParameters;				// G, or NaN if absent
+		std::vector<double> Epochs;						// Julian date (TT)
+		std::vector<double> MeanAnomalies;
+		std::vector<double> ArgumentsOfPerihelion;
+		std::vector<double> AscendingNodes;
+		std::vector<double> Inclinations;
+		std::vector<double> Eccentricities;
+		std::vector<double> MeanMotions;				// Degrees per day
+		std::vector<double> SemiMajorAxes;				// Astronomical units
+	};
+
+	/**
+	* The header of the binary cache written beside an imported catalog. The columns of MinorPlanetElements follow in
+	* declaration order, each padded to eight bytes.
+	*/
+	struct MinorPlanetCacheHeader
+	{
+		std::uint32_t Magic;
+		std::uint32_t Version;
+		std::uint32_t RecordCount;
+		std::uint32_t Reserved;
+		std::uint64_t SourceHash;
+		std::uint64_t SourceSize;
+	};
+
+	static_assert(sizeof(MinorPlanetCacheHeader) == 32, "MinorPlanetCacheHeader must match the file layout.");
+
+	/**
+	* Imports the minor planet orbit catalog in the fixed-width MPCORB format of the Minor Planet Center.
+	* The text is memory-mapped and parsed in parallel chunks of whole lines. Numeric fields are converted eight digits at
+	* a time within a 64-bit word rather than one character at a time. The elements are then cached in a binary file
+	* keyed by a hash of the text, so later imports of the same text only hash it and copy the columns back in.
+	*/
+	class MinorPlanetCatalog final
+	{
+	public:
+		/**
+		* Import a catalog, reusing the cache if it was written from identical text and rewriting it otherwise.
+		* @param textFilename The MPCORB text file. Lines before a line of dashes are treated as a header when one is present.
+		* @param cacheFilename The binary cache file.
+		* @param threadPool The pool used to hash and parse the text.
+		*/
+		MinorPlanetCatalog(const std::wstring& textFilename, const std::wstring& cacheFilename, ThreadPool& threadPool);
+		MinorPlanetCatalog(const MinorPlanetCatalog&) = delete;
+		MinorPlanetCatalog& operator=(const MinorPlanetCatalog&) = delete;
+		MinorPlanetCatalog(MinorPlanetCatalog&&) = default;
+		MinorPlanetCatalog& operator=(MinorPlanetCatalog&&) = default;
+		~MinorPlanetCatalog() = default;
+
+		std::uint32_t Count() const;
+		const MinorPlanetElements& Elements() const;
+		std::string Designation(std::uint32_t index) const;
+		/**
+		* Whether the elements were read from the cache rather than parsed from the text.
+		*/
+		bool LoadedFromCache() const;
+
+		/**
+		* A 64-bit hash in the style of FNV-1a, taken over 64-bit words of fixed-size chunks of the file in parallel and combined in order.
+		*/
+		static std::uint64_t Hash(const MemoryMappedFile& file, ThreadPool& threadPool);
+
+		static const std::uint32_t DesignationLength;
+		static const std::uint32_t DesignationStride;
+		static const std::uint32_t CacheMagic;
+		static const std::uint32_t CacheVersion;
+
+	private:
+		bool TryLoadCache(const std::wstring& cacheFilename, std::uint64_t sourceHash, std::uint64_t sourceSize);
+		void WriteCache(const std::wstring& cacheFilename, std::uint64_t sourceHash, std::uint64_t sourceSize);
+		void Parse(const MemoryMappedFile& text, ThreadPool& threadPool);
+		void ParseRecord(const char* line, std::uint32_t index);
+
+		MinorPlanetElements mElements;
+		bool mLoadedFromCache;
+	};
+}
\ No newline at end of file
@@ -30,9 +30,9 @@ namespace Library
 		Load(filename);
 	}
 
-	Model::Model(ifstream& file)
+	Model::Model(istream& stream)
 	{
-		Load(file);
+		Load(stream);
 	}
 
 	Model::Model(ModelData&& modelData) :
@@ -82,10 +82,14 @@ namespace Library
 
 	void Model::Save(const string& filename) const
 	{
+#if defined(_WIN32)
 		ofstream file(filename.c_str(), ios::binary);
+#else
+		ofstream file(Utility::ToPortablePath(filename), ios::binary);
+#endif
 		if (!file.good())
 		{
-			throw exception("Could not open file.");
+			throw GameException("Could not open file.");
 		}
 
 		Save(file);
@@ -112,7 +116,11 @@ namespace Library
 
 	void Model::Load(const string& filename)
 	{
+#if defined(_WIN32)
 		ifstream file(filename.c_str(), ios::binary);
+#else
+		ifstream file(Utility::ToPortablePath(filename), ios::binary);
+#endif
 		if (!file.good())
 		{
 			throw GameException("Could not open file.");
@@ -121,9 +129,9 @@ namespace Library
 		Load(file);
 	}
 
-	void Model::Load(ifstream& file)
+	void Model::Load(istream& stream)
 	{
-		InputStreamHelper streamHelper(file);
+		InputStreamHelper streamHelper(stream);
 
 		// Desrialize materials
 		uint32_t materialCount;
@@ -31,7 +31,7 @@ namespace Library
     public:
 		Model() = default;
 		Model(const std::string& filename);
-		Model(std::ifstream& file);
+		Model(std::istream& stream);
 		Model(ModelData&& modelData);
 		Model(Model&& rhs);
 		Model& operator=(Model&& rhs);
@@ -49,7 +49,7 @@ namespace Library
 
     private:
 		void Load(const std::string& filename);
-		void Load(std::ifstream& file);
+		void Load(std::istream& stream);
 
 		ModelData mData;
     };
@@ -0,0 +1,207 @@
+#include "pch.h"
+
+using namespace std;
+
+namespace Library
+{
+	RTTI_DEFINITIONS(ModelCache)
+
+	namespace
+	{
+		/**
+		* Reads a block of memory as a stream, so a mapped file deserializes without being copied.
+		*/
+		class MemoryStreamBuffer final : public streambuf
+		{
+		public:
+			MemoryStreamBuffer(const uint8_t* data, size_t size)
+			{
+				char* begin = const_cast<char*>(reinterpret_cast<const char*>(data));
+				setg(begin, begin, begin + size);
+			}
+		};
+	}
+
+	shared_ptr<const Model> ModelCache::Load(const string& filename)
+	{
+		wstring path = NormalizePath(filename);
+
+		promise<shared_ptr<const Model>> loaded;
+		shared_future<shared_ptr<const Model>> pending;
+		{
+			lock_guard<mutex> lock(mMutex);
+			PathEntry& entry = mPaths[path];
+			if (entry.Pending.valid())
+			{
+				pending = entry.Pending;
+			}
+			else
+			{
+				if (entry.HasHash)
+				{
+					auto model = mModels.find(entry.Hash);
+					if (model != mModels.end())
+					{
+						shared_ptr<const Model> held = model->second.lock();
+						if (held != nullptr)
+						{
+							return held;
+						}
+					}
+				}
+
+				entry.Pending = loaded.get_future().share();
+			}
+		}
+
+		// Another thread is reading the file; wait for its model rather than reading the file again
+		if (pending.valid())
+		{
+			return pending.get();
+		}
+
+		try
+		{
+			uint64_t hash;
+			shared_ptr<const Model> model = Read(path, hash);
+			{
+				lock_guard<mutex> lock(mMutex);
+				PathEntry& entry = mPaths[path];
+				entry.HasHash = true;
+				entry.Hash = hash;
+				entry.Pending = shared_future<shared_ptr<const Model>>();
+			}
+
+			loaded.set_value(model);
+			return model;
+		}
+		catch (...)
+		{
+			{
+				lock_guard<mutex> lock(mMutex);
+				mPaths[path].Pending = shared_future<shared_ptr<const Model>>();
+			}
+
+			loaded.set_exception(current_exception());
+			throw;
+		}
+	}
+
+	uint32_t ModelCache::ModelCount() const
+	{
+		lock_guard<mutex> lock(mMutex);
+
+		uint32_t count = 0;
+		for (const auto& model : mModels)
+		{
+			if (model.second.expired() == false)
+			{
+				++count;
+			}
+		}
+
+		return count;
+	}
+
+	wstring ModelCache::NormalizePath(const string& filename)
+	{
+		wstring path = Utility::ToWideString(filename);
+
+		DWORD length = GetFullPathName(path.c_str(), 0, nullptr, nullptr);
+		if (length > 0)
+		{
+			wstring fullPath(length, L'\0');
+			length = GetFullPathName(path.c_str(), length, &fullPath[0], nullptr);
+			fullPath.resize(length);
+			path = fullPath;
+		}
+
+		for (wchar_t& character : path)
+		{
+			character = (character == L'/' ? L'\\' : towlower(character));
+		}
+
+		return path;
+	}
+
+	shared_ptr<const MeshBuffers> ModelCache::LoadBuffers(ID3D11Device* device, const string& filename, uint32_t meshIndex, type_index vertexType, const VertexBufferFactory& createVertexBuffer)
+	{
+		shared_ptr<const Model> model = Load(filename);
+		Mesh* mesh = model->Meshes().at(meshIndex).get();
+
+		// Creating buffers is quick next to reading a model, so first requests for them simply take turns
+		lock_guard<mutex> lock(mBufferMutex);
+
+		weak_ptr<const MeshBuffers>& cached = mBuffers[BufferKey(mesh, vertexType)];
+		shared_ptr<const MeshBuffers> held = cached.lock();
+		if (held != nullptr)
+		{
+			return held;
+		}
+
+		auto buffers = make_shared<MeshBuffers>();
+		buffers->SourceModel = model;
+		buffers->SourceMesh = mesh;
+		buffers->IndexCount = static_cast<uint32_t>(mesh->Indices().size());
+		createVertexBuffer(device, *mesh, buffers->VertexBuffer.GetAddressOf());
+
+		// Any other vertex format of the mesh already drawn lends its index buffer
+		for (const auto& other : mBuffers)
+		{
+			shared_ptr<const MeshBuffers> otherBuffers = other.second.lock();
+			if (other.first.first == mesh && otherBuffers != nullptr)
+			{
+				buffers->IndexBuffer = otherBuffers->IndexBuffer;
+				break;
+			}
+		}
+
+		if (buffers->IndexBuffer == nullptr)
+		{
+			mesh->CreateIndexBuffer(*device, buffers->IndexBuffer.GetAddressOf());
+		}
+
+		cached = buffers;
+		return buffers;
+	}
+
+	shared_ptr<const Model> ModelCache::Read(const wstring& path, uint64_t& hash)
+	{
+		MemoryMappedFile file(path);
+		if (file.Size() == 0)
+		{
+			throw GameException("The model file is empty.");
+		}
+
+		hash = Utility::HashBytes(file.Data(), file.Size());
+		{
+			// A copy of a file already read under another name
+			lock_guard<mutex> lock(mMutex);
+			auto model = mModels.find(hash);
+			if (model != mModels.end())
+			{
+				shared_ptr<const Model> held = model->second.lock();
+				if (held != nullptr)
+				{
+					return held;
+				}
+			}
+		}
+
+		MemoryStreamBuffer buffer(file.Data(), file.Size());
+		istream stream(&buffer);
+		shared_ptr<const Model> model = make_shared<Model>(stream);
+
+		// Another name for the same contents may have finished reading meanwhile; keep whichever model came first
+		lock_guard<mutex> lock(mMutex);
+		weak_ptr<const Model>& cached = mModels[hash];
+		shared_ptr<const Model> held = cached.lock();
+		if (held != nullptr)
+		{
+			return held;
+		}
+
+		cached = model;
+		return model;
+	}
+}
\ No newline at end of file
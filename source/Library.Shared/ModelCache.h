@@ -0,0 +1,105 @@
+#pragma once
+
+#include "RTTI.h"
+#include <string>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <future>
+#include <functional>
+#include <typeindex>
+#include <cstdint>
+#include <d3d11_2.h>
+#include <wrl.h>
+
+namespace Library
+{
+	class Model;
+	class Mesh;
+
+	/**
+	* The device buffers drawing one mesh of a cached model in one vertex format.
+	*/
+	struct MeshBuffers final
+	{
+		std::shared_ptr<const Model> SourceModel;		// Keeps the mesh alive for as long as its buffers
+		const Mesh* SourceMesh;
+		Microsoft::WRL::ComPtr<ID3D11Buffer> VertexBuffer;
+		Microsoft::WRL::ComPtr<ID3D11Buffer> IndexBuffer;		// Shared by every vertex format of the mesh
+		std::uint32_t IndexCount;
+	};
+
+	/**
+	* Shares models, and the device buffers built from their meshes, between every component drawing them, so each
+	* file is read and deserialized once however many components name it. Models are found by their normalized path and
+	* then by a hash of their contents, so copies of a file under different names share one model too.
+	*
+	* The cache holds weak references: a model and its buffers are released once the last component holding them lets
+	* go, and read again if asked for later. Loading is thread-safe, and threads asking for a file already being read
+	* wait for that read instead of starting another. The buffers are created on the device of the first request; the
+	* cache is registered as a service of the game, whose device every component shares.
+	*/
+	class ModelCache final : public RTTI
+	{
+		RTTI_DECLARATIONS(ModelCache, RTTI)
+
+	public:
+		/**
+		* Creates the vertex buffer of a mesh in the vertex format of its caller.
+		*/
+		typedef std::function<void(ID3D11Device* device, const Mesh& mesh, ID3D11Buffer** vertexBuffer)> VertexBufferFactory;
+
+		ModelCache() = default;
+		ModelCache(const ModelCache&) = delete;
+		ModelCache& operator=(const ModelCache&) = delete;
+		ModelCache(ModelCache&&) = delete;
+		ModelCache& operator=(ModelCache&&) = delete;
+		~ModelCache() = default;
+
+		/**
+		* Get the model in a file, reading it only if no one holds it already.
+		*/
+		std::shared_ptr<const Model> Load(const std::string& filename);
+
+		/**
+		* Get the buffers drawing a mesh of the model in a file, creating them only if no one holds them already.
+		* @param meshIndex The mesh of the model to draw.
+		* @param createVertexBuffer Creates the vertex buffer of the mesh as vertices of type TVertex.
+		*/
+		template <typename TVertex>
+		std::shared_ptr<const MeshBuffers> LoadBuffers(ID3D11Device* device, const std::string& filename, std::uint32_t meshIndex, const VertexBufferFactory& createVertexBuffer)
+		{
+			return LoadBuffers(device, filename, meshIndex, std::type_index(typeid(TVertex)), createVertexBuffer);
+		}
+
+		/**
+		* Get the number of distinct models held by anyone.
+		*/
+		std::uint32_t ModelCount() const;
+
+		/**
+		* Get the absolute, lowercase, backslash-separated form of a path, the same for every spelling of a file.
+		*/
+		static std::wstring NormalizePath(const std::string& filename);
+
+	private:
+		struct PathEntry
+		{
+			bool HasHash = false;
+			std::uint64_t Hash = 0;
+			std::shared_future<std::shared_ptr<const Model>> Pending;		// Valid while a thread reads the file
+		};
+
+		typedef std::pair<const Mesh*, std::type_index> BufferKey;
+
+		std::shared_ptr<const MeshBuffers> LoadBuffers(ID3D11Device* device, const std::string& filename, std::uint32_t meshIndex, std::type_index vertexType, const VertexBufferFactory& createVertexBuffer);
+		std::shared_ptr<const Model> Read(const std::wstring& path, std::uint64_t& hash);
+
+		mutable std::mutex mMutex;
+		std::map<std::wstring, PathEntry> mPaths;
+		std::map<std::uint64_t, std::weak_ptr<const Model>> mModels;
+
+		std::mutex mBufferMutex;
+		std::map<BufferKey, std::weak_ptr<const MeshBuffers>> mBuffers;
+	};
+}
\ No newline at end of file
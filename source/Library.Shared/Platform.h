@@ -0,0 +1,48 @@
+#pragma once
+
+#if defined(_WIN32)
+
+#include <windows.h>
+
+// DirectXMath ships with the Windows SDK
+#if !defined(LIBRARY_HAS_DIRECTXMATH)
+#define LIBRARY_HAS_DIRECTXMATH
+#endif
+
+// The game decodes images with Windows Imaging Component
+#if !defined(LIBRARY_PORTABLE) && !defined(LIBRARY_HAS_IMAGE_DECODER)
+#define LIBRARY_HAS_IMAGE_DECODER
+#endif
+
+#else
+
+#include <cstdint>
+#include <cstring>
+#include <cstddef>
+#include <cerrno>
+#include <fcntl.h>
+#include <unistd.h>
+#include <signal.h>
+#include <sched.h>
+#include <poll.h>
+#include <sys/mman.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <sys/wait.h>
+
+// The few Windows definitions used by the parts of the library without a window or a graphics device, so that those
+// parts build on other platforms too.
+typedef std::int32_t HRESULT;
+
+#define S_OK static_cast<HRESULT>(0)
+#define E_FAIL static_cast<HRESULT>(0x80004005UL)
+#define SUCCEEDED(hr) (static_cast<HRESULT>(hr) >= 0)
+#define FAILED(hr) (static_cast<HRESULT>(hr) < 0)
+
+#define UNREFERENCED_PARAMETER(parameter) static_cast<void>(parameter)
+#define ZeroMemory(destination, length) std::memset((destination), 0, (length))
+#define _countof(array) (sizeof(array) / sizeof((array)[0]))
+#define ARRAYSIZE(array) _countof(array)
+
+#endif
\ No newline at end of file
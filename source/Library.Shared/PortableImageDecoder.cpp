@@ -0,0 +1,144 @@
+#include "pch.h"
+
+// Only built where libjpeg and libpng are found, so kept out of the precompiled header
+#include <cstdio>
+#include <csetjmp>
+#include <jpeglib.h>
+#include <png.h>
+
+using namespace std;
+
+namespace Library
+{
+	namespace
+	{
+		const uint8_t JpegSignature[] = { 0xFF, 0xD8, 0xFF };
+		const uint8_t PngSignature[] = { 0x89, 'P', 'N', 'G' };
+
+		bool HasSignature(const vector<uint8_t>& contents, const uint8_t* signature, size_t size)
+		{
+			return (contents.size() >= size && memcmp(contents.data(), signature, size) == 0);
+		}
+
+		/**
+		* The error manager of a decompression, returning to the point set before it instead of exiting the process.
+		*/
+		struct JpegErrorManager
+		{
+			jpeg_error_mgr Manager;
+			jmp_buf Return;
+			char Message[JMSG_LENGTH_MAX];
+		};
+
+		void ExitJpegError(j_common_ptr info)
+		{
+			JpegErrorManager* errorManager = reinterpret_cast<JpegErrorManager*>(info->err);
+			(*info->err->format_message)(info, errorManager->Message);
+			longjmp(errorManager->Return, 1);
+		}
+
+		/**
+		* Decode a JPEG image to RGB rows, which are expanded to RGBA in place by the caller. Holds no object with a
+		* destructor, which the jump out of a failed decompression would skip.
+		* @return Whether the image was decoded; otherwise the message of the error is left in the error manager.
+		*/
+		bool DecodeJpegRgb(const vector<uint8_t>& contents, DecodedImage& image, JpegErrorManager& errorManager)
+		{
+			jpeg_decompress_struct info;
+			info.err = jpeg_std_error(&errorManager.Manager);
+			errorManager.Manager.error_exit = ExitJpegError;
+			if (setjmp(errorManager.Return) != 0)
+			{
+				jpeg_destroy_decompress(&info);
+				return false;
+			}
+
+			jpeg_create_decompress(&info);
+			jpeg_mem_src(&info, const_cast<unsigned char*>(contents.data()), static_cast<unsigned long>(contents.size()));
+			jpeg_read_header(&info, TRUE);
+			info.out_color_space = JCS_RGB;
+			jpeg_start_decompress(&info);
+
+			image.Width = info.output_width;
+			image.Height = info.output_height;
+			image.Pixels.resize(static_cast<size_t>(image.Width) * image.Height * 4);
+
+			while (info.output_scanline < info.output_height)
+			{
+				JSAMPROW row = image.Pixels.data() + static_cast<size_t>(info.output_scanline) * image.Width * 4;
+				jpeg_read_scanlines(&info, &row, 1);
+			}
+
+			jpeg_finish_decompress(&info);
+			jpeg_destroy_decompress(&info);
+
+			return true;
+		}
+
+		DecodedImage DecodeJpeg(const vector<uint8_t>& contents)
+		{
+			DecodedImage image;
+			JpegErrorManager errorManager;
+			if (DecodeJpegRgb(contents, image, errorManager) == false)
+			{
+				throw GameException((string("libjpeg failed: ") + errorManager.Message).c_str());
+			}
+
+			// Each row was read to the front of its space; spread it out from the back so no pixel is overwritten before it is read
+			for (uint32_t y = 0; y < image.Height; ++y)
+			{
+				uint8_t* row = image.Pixels.data() + static_cast<size_t>(y) * image.Width * 4;
+				for (uint32_t x = image.Width; x-- > 0;)
+				{
+					row[x * 4 + 3] = 0xFF;
+					row[x * 4 + 2] = row[x * 3 + 2];
+					row[x * 4 + 1] = row[x * 3 + 1];
+					row[x * 4] = row[x * 3];
+				}
+			}
+
+			return image;
+		}
+
+		DecodedImage DecodePng(const vector<uint8_t>& contents)
+		{
+			png_image png;
+			memset(&png, 0, sizeof(png));
+			png.version = PNG_IMAGE_VERSION;
+			if (png_image_begin_read_from_memory(&png, contents.data(), contents.size()) == 0)
+			{
+				throw GameException((string("libpng failed: ") + png.message).c_str());
+			}
+
+			png.format = PNG_FORMAT_RGBA;
+
+			DecodedImage image;
+			image.Width = png.width;
+			image.Height = png.height;
+			image.Pixels.resize(PNG_IMAGE_SIZE(png));
+			if (png_image_finish_read(&png, nullptr, image.Pixels.data(), 0, nullptr) == 0)
+			{
+				string message(png.message);
+				png_image_free(&png);
+				throw GameException(("libpng failed: " + message).c_str());
+			}
+
+			return image;
+		}
+	}
+
+	DecodedImage PortableImageDecoder::Decode(const vector<uint8_t>& contents)
+	{
+		if (HasSignature(contents, JpegSignature, sizeof(JpegSignature)))
+		{
+			return DecodeJpeg(contents);
+		}
+
+		if (HasSignature(contents, PngSignature, sizeof(PngSignature)))
+		{
+			return DecodePng(contents);
+		}
+
+		throw GameException("The image is neither a JPEG nor a PNG.");
+	}
+}
\ No newline at end of file
@@ -0,0 +1,25 @@
+#pragma once
+
+#include "TextureCache.h"
+#include <vector>
+#include <cstdint>
+
+namespace Library
+{
+	/**
+	* Decodes JPEG images with libjpeg and PNG images with libpng, for the texture cache on platforms without Windows
+	* Imaging Component. Safe to call from any thread.
+	*/
+	class PortableImageDecoder final
+	{
+	public:
+		static DecodedImage Decode(const std::vector<std::uint8_t>& contents);
+
+		PortableImageDecoder() = delete;
+		PortableImageDecoder(const PortableImageDecoder&) = delete;
+		PortableImageDecoder& operator=(const PortableImageDecoder&) = delete;
+		PortableImageDecoder(PortableImageDecoder&&) = delete;
+		PortableImageDecoder& operator=(PortableImageDecoder&&) = delete;
+		~PortableImageDecoder() = default;
+	};
+}
\ No newline at end of file
@@ -9,7 +9,7 @@ namespace Library
 
 	ProxyModel::ProxyModel(Game& game, const shared_ptr<Camera>& camera, const std::string& modelFileName, float scale) :
 		DrawableGameComponent(game, camera),
-		mModelFileName(modelFileName), mIndexCount(0),
+		mModelFileName(modelFileName),
 		mWorldMatrix(MatrixHelper::Identity), mScaleMatrix(MatrixHelper::Identity), mDisplayWireframe(true),
 		mPosition(Vector3Helper::Zero), mDirection(Vector3Helper::Forward), mUp(Vector3Helper::Up), mRight(Vector3Helper::Right)
 	{
@@ -129,14 +129,11 @@ namespace Library
 		constantBufferDesc.BindFlags = D3D11_BIND_CONSTANT_BUFFER;
 		ThrowIfFailed(mGame->Direct3DDevice()->CreateBuffer(&constantBufferDesc, nullptr, mVertexCBufferPerObject.ReleaseAndGetAddressOf()), "ID3D11Device::CreateBuffer() failed.");
 
-		// Load a model
-		Model model = Library::Model(mModelFileName);
-
-		// Create vertex and index buffers for the model
-		Mesh* mesh = model.Meshes().at(0).get();
-		CreateVertexBuffer(mGame->Direct3DDevice(), *mesh, mVertexBuffer.GetAddressOf());
-		mesh->CreateIndexBuffer(*mGame->Direct3DDevice(), mIndexBuffer.ReleaseAndGetAddressOf());
-		mIndexCount = static_cast<UINT>(mesh->Indices().size());
+		// Get the vertex and index buffers of the model, shared with every other proxy of it
+		ModelCache* modelCache = (ModelCache*)mGame->Services().GetService(ModelCache::TypeIdClass());
+		assert(modelCache != nullptr);
+		auto createVertexBuffer = [this](ID3D11Device* device, const Mesh& mesh, ID3D11Buffer** vertexBuffer) { CreateVertexBuffer(device, mesh, vertexBuffer); };
+		mMeshBuffers = modelCache->LoadBuffers<VertexPositionColor>(mGame->Direct3DDevice(), mModelFileName, 0, createVertexBuffer);
 	}
 
 	void ProxyModel::Update(const GameTime& gameTime)
@@ -162,8 +159,8 @@ namespace Library
 
 		UINT stride = sizeof(VertexPositionColor);
 		UINT offset = 0;
-		direct3DDeviceContext->IASetVertexBuffers(0, 1, mVertexBuffer.GetAddressOf(), &stride, &offset);
-		direct3DDeviceContext->IASetIndexBuffer(mIndexBuffer.Get(), DXGI_FORMAT_R32_UINT, 0);
+		direct3DDeviceContext->IASetVertexBuffers(0, 1, mMeshBuffers->VertexBuffer.GetAddressOf(), &stride, &offset);
+		direct3DDeviceContext->IASetIndexBuffer(mMeshBuffers->IndexBuffer.Get(), DXGI_FORMAT_R32_UINT, 0);
 
 		direct3DDeviceContext->VSSetShader(mVertexShader.Get(), nullptr, 0);
 		direct3DDeviceContext->PSSetShader(mPixelShader.Get(), nullptr, 0);
@@ -178,12 +175,12 @@ namespace Library
 		if (mDisplayWireframe)
 		{
 			mGame->Direct3DDeviceContext()->RSSetState(RasterizerStates::Wireframe.Get());
-			direct3DDeviceContext->DrawIndexed(mIndexCount, 0, 0);
+			direct3DDeviceContext->DrawIndexed(mMeshBuffers->IndexCount, 0, 0);
 			mGame->Direct3DDeviceContext()->RSSetState(nullptr);
 		}
 		else
 		{
-			direct3DDeviceContext->DrawIndexed(mIndexCount, 0, 0);
+			direct3DDeviceContext->DrawIndexed(mMeshBuffers->IndexCount, 0, 0);
 		}
 	}
 
@@ -8,6 +8,7 @@
 namespace Library
 {
 	class Mesh;
+	struct MeshBuffers;
 
 	class ProxyModel : public DrawableGameComponent
 	{
@@ -66,11 +67,9 @@ namespace Library
 		Microsoft::WRL::ComPtr<ID3D11VertexShader> mVertexShader;
 		Microsoft::WRL::ComPtr<ID3D11PixelShader> mPixelShader;
 		Microsoft::WRL::ComPtr<ID3D11InputLayout> mInputLayout;
-		Microsoft::WRL::ComPtr<ID3D11Buffer> mVertexBuffer;
-		Microsoft::WRL::ComPtr<ID3D11Buffer> mIndexBuffer;		
 		Microsoft::WRL::ComPtr<ID3D11Buffer> mVertexCBufferPerObject;
 		VertexCBufferPerObject mVertexCBufferPerObjectData;
-		UINT mIndexCount;
+		std::shared_ptr<const MeshBuffers> mMeshBuffers;
 		bool mDisplayWireframe;
 	};
 }
\ No newline at end of file
@@ -0,0 +1,133 @@
+#include "pch.h"
+
+using namespace std;
+
+namespace Library
+{
+	namespace
+	{
+		const uint8_t OpIndex = 0x00;
+		const uint8_t OpDiff = 0x40;
+		const uint8_t OpLuma = 0x80;
+		const uint8_t OpRun = 0xC0;
+		const uint8_t OpRgb = 0xFE;
+		const uint8_t OpRgba = 0xFF;
+		const uint32_t MaxRun = 62;
+		const uint32_t IndexSize = 64;
+		const uint32_t HeaderSize = 14;
+		const uint8_t EndMarker[] = { 0, 0, 0, 0, 0, 0, 0, 1 };
+
+		struct Pixel
+		{
+			uint8_t R;
+			uint8_t G;
+			uint8_t B;
+			uint8_t A;
+
+			bool operator==(const Pixel& other) const
+			{
+				return R == other.R && G == other.G && B == other.B && A == other.A;
+			}
+		};
+
+		uint32_t IndexOf(const Pixel& pixel)
+		{
+			return static_cast<uint32_t>(pixel.R * 3 + pixel.G * 5 + pixel.B * 7 + pixel.A * 11) % IndexSize;
+		}
+
+		void WriteBigEndian(vector<uint8_t>& destination, uint32_t value)
+		{
+			destination.push_back(static_cast<uint8_t>(value >> 24));
+			destination.push_back(static_cast<uint8_t>(value >> 16));
+			destination.push_back(static_cast<uint8_t>(value >> 8));
+			destination.push_back(static_cast<uint8_t>(value));
+		}
+	}
+
+	vector<uint8_t> QoiImageEncoder::Encode(const DecodedImage& image)
+	{
+		uint32_t pixelCount = image.Width * image.Height;
+		if (pixelCount == 0 || image.Pixels.size() != pixelCount * 4)
+		{
+			throw GameException("An image to encode must have 8 bit RGBA pixels.");
+		}
+
+		// No pixel takes more than its tag and four channels
+		vector<uint8_t> encoded;
+		encoded.reserve(HeaderSize + pixelCount * 5 + sizeof(EndMarker));
+		encoded.insert(encoded.end(), { 'q', 'o', 'i', 'f' });
+		WriteBigEndian(encoded, image.Width);
+		WriteBigEndian(encoded, image.Height);
+		encoded.push_back(4);		// Channels
+		encoded.push_back(0);		// sRGB with linear alpha
+
+		Pixel index[IndexSize] = { };
+		Pixel previous = { 0, 0, 0, 255 };
+		uint32_t run = 0;
+		const Pixel* pixels = reinterpret_cast<const Pixel*>(image.Pixels.data());
+		for (uint32_t i = 0; i < pixelCount; ++i)
+		{
+			const Pixel& pixel = pixels[i];
+			if (pixel == previous)
+			{
+				if (++run == MaxRun || i == pixelCount - 1)
+				{
+					encoded.push_back(static_cast<uint8_t>(OpRun | (run - 1)));
+					run = 0;
+				}
+
+				continue;
+			}
+
+			if (run > 0)
+			{
+				encoded.push_back(static_cast<uint8_t>(OpRun | (run - 1)));
+				run = 0;
+			}
+
+			uint32_t slot = IndexOf(pixel);
+			if (index[slot] == pixel)
+			{
+				encoded.push_back(static_cast<uint8_t>(OpIndex | slot));
+			}
+			else
+			{
+				index[slot] = pixel;
+
+				if (pixel.A == previous.A)
+				{
+					// Differences wrap around, as the decoder adds them modulo 256
+					int32_t red = static_cast<int8_t>(pixel.R - previous.R);
+					int32_t green = static_cast<int8_t>(pixel.G - previous.G);
+					int32_t blue = static_cast<int8_t>(pixel.B - previous.B);
+					int32_t redFromGreen = red - green;
+					int32_t blueFromGreen = blue - green;
+
+					if (red >= -2 && red <= 1 && green >= -2 && green <= 1 && blue >= -2 && blue <= 1)
+					{
+						encoded.push_back(static_cast<uint8_t>(OpDiff | ((red + 2) << 4) | ((green + 2) << 2) | (blue + 2)));
+					}
+					else if (green >= -32 && green <= 31 && redFromGreen >= -8 && redFromGreen <= 7 && blueFromGreen >= -8 && blueFromGreen <= 7)
+					{
+						encoded.push_back(static_cast<uint8_t>(OpLuma | (green + 32)));
+						encoded.push_back(static_cast<uint8_t>(((redFromGreen + 8) << 4) | (blueFromGreen + 8)));
+					}
+					else
+					{
+						encoded.insert(encoded.end(), { OpRgb, pixel.R, pixel.G, pixel.B });
+					}
+				}
+				else
+				{
+					encoded.insert(encoded.end(), { OpRgba, pixel.R, pixel.G, pixel.B, pixel.A });
+				}
+			}
+
+			previous = pixel;
+		}
+
+		encoded.insert(encoded.end(), begin(EndMarker), end(EndMarker));
+
+		return encoded;
+	}
+}
\ No newline at end of file
@@ -0,0 +1,30 @@
+#pragma once
+
+#include "TextureCache.h"
+#include <vector>
+#include <cstdint>
+
+namespace Library
+{
+	/**
+	* Encodes images in the Quite OK Image format: lossless, about as small as a PNG, and many times faster to write
+	* since each pixel is coded from the one before it and a small table of recent colors, with no entropy coder.
+	* Safe to call from any thread.
+	*/
+	class QoiImageEncoder final
+	{
+	public:
+		/**
+		* Encode an image of 8 bit RGBA pixels, as decoded images hold them.
+		* @return The contents of a .qoi file.
+		*/
+		static std::vector<std::uint8_t> Encode(const DecodedImage& image);
+
+		QoiImageEncoder() = delete;
+		QoiImageEncoder(const QoiImageEncoder&) = delete;
+		QoiImageEncoder& operator=(const QoiImageEncoder&) = delete;
+		QoiImageEncoder(QoiImageEncoder&&) = delete;
+		QoiImageEncoder& operator=(QoiImageEncoder&&) = delete;
+		~QoiImageEncoder() = default;
+	};
+}
\ No newline at end of file
@@ -1,6 +1,6 @@
 #pragma once
 
-#include <windows.h>
+#include "Platform.h"
 #include <string>
 #include <cstdint>
 
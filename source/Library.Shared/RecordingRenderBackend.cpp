@@ -0,0 +1,42 @@
+#include "pch.h"
+
+using namespace std;
+
+namespace Library
+{
+	void RecordingRenderBackend::BindPass(uint32_t pass)
+	{
+		mCommands.push_back({ CommandType::BindPass, pass });
+	}
+
+	void RecordingRenderBackend::BindShader(uint32_t shader)
+	{
+		mCommands.push_back({ CommandType::BindShader, shader });
+	}
+
+	void RecordingRenderBackend::BindTexture(uint32_t texture)
+	{
+		mCommands.push_back({ CommandType::BindTexture, texture });
+	}
+
+	void RecordingRenderBackend::Draw(const DrawPacket& packet)
+	{
+		mCommands.push_back({ CommandType::Draw, packet.Command });
+		packet.Client->ExecuteDraw(packet.Command);
+	}
+
+	void RecordingRenderBackend::Clear()
+	{
+		mCommands.clear();
+	}
+
+	const vector<RecordingRenderBackend::Command>& RecordingRenderBackend::Commands() const
+	{
+		return mCommands;
+	}
+
+	uint32_t RecordingRenderBackend::CommandCount(CommandType type) const
+	{
+		return static_cast<uint32_t>(count_if(mCommands.begin(), mCommands.end(), [type](const Command& command) { return command.Type == type; }));
+	}
+}
\ No newline at end of file
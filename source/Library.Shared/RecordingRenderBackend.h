@@ -0,0 +1,55 @@
+#pragma once
+
+#include "RenderQueue.h"
+#include <vector>
+#include <cstdint>
+
+namespace Library
+{
+	/**
+	* A render backend that records the commands it is given instead of issuing them, so the cost of sorting and
+	* submitting the render queue, and the state changes it makes, can be measured without a device.
+	*/
+	class RecordingRenderBackend final : public RenderBackend
+	{
+	public:
+		enum class CommandType : std::uint8_t
+		{
+			BindPass,
+			BindShader,
+			BindTexture,
+			Draw
+		};
+
+		struct Command
+		{
+			CommandType Type;
+			std::uint32_t Value;		// The field bound, or the command of the packet drawn
+		};
+
+		RecordingRenderBackend() = default;
+		RecordingRenderBackend(const RecordingRenderBackend&) = delete;
+		RecordingRenderBackend& operator=(const RecordingRenderBackend&) = delete;
+		RecordingRenderBackend(RecordingRenderBackend&&) = delete;
+		RecordingRenderBackend& operator=(RecordingRenderBackend&&) = delete;
+		~RecordingRenderBackend() = default;
+
+		virtual void BindPass(std::uint32_t pass) override;
+		virtual void BindShader(std::uint32_t shader) override;
+		virtual void BindTexture(std::uint32_t texture) override;
+		/**
+		* Record the draw and pass it on to the client of the packet, which for measurement need not touch a device.
+		*/
+		virtual void Draw(const DrawPacket& packet) override;
+
+		/**
+		* Drop the recorded commands.
+		*/
+		void Clear();
+		const std::vector<Command>& Commands() const;
+		std::uint32_t CommandCount(CommandType type) const;
+
+	private:
+		std::vector<Command> mCommands;
+	};
+}
\ No newline at end of file
@@ -0,0 +1,340 @@
+#include "pch.h"
+
+using namespace std;
+
+namespace Library
+{
+	namespace
+	{
+		const uint32_t Unbound = 0xFFFFFFFF;
+		const uint32_t StructuredBufferBit = 0x80000000;
+
+		const char* const CommandNames[] =
+		{
+			"CreateBuffer", "CreateTexture", "CreateShader", "CreateState", "ReleaseBuffer", "Map", "Unmap", "UpdateBuffer", "SetState", "SetShader", "SetPrimitiveTopology",
+			"SetVertexBuffer", "SetIndexBuffer", "SetConstantBuffer", "SetTexture", "SetStructuredBuffer", "SetSampler", "Draw", "DrawIndexedInstanced"
+		};
+
+		// The handle created is recorded as the last argument of each creation
+		const uint32_t CommandArgumentCounts[] = { 5, 5, 2, 4, 1, 2, 2, 2, 1, 1, 1, 2, 1, 5, 3, 3, 3, 2, 5 };
+	}
+
+	// RenderDevice has no source of its own to define its constants in
+	const uint32_t RenderDevice::NullHandle;
+
+	RecordingRenderDevice::RecordingRenderDevice(bool recordCommands) :
+		mRecordCommands(recordCommands), mStatistics(), mTextureCount(0), mShaderCount(0), mStateCount(0),
+		mBoundState(Unbound), mBoundShader(Unbound), mBoundTopology(Unbound), mBoundVertexBuffer(NullHandle), mBoundVertexStride(0), mBoundIndexBuffer(NullHandle)
+	{
+		// The first buffer is RenderDevice::NullHandle, which binds nothing
+		mBuffers.push_back({ { BufferType::Vertex, false, 0, 0 }, {}, false });
+
+		for (uint32_t stage = 0; stage < ShaderStageCount; ++stage)
+		{
+			fill(begin(mBoundConstantBuffers[stage]), end(mBoundConstantBuffers[stage]), ConstantBufferBinding{ NullHandle, 0, 0 });
+			fill(begin(mBoundResources[stage]), end(mBoundResources[stage]), NullHandle);
+			fill(begin(mBoundSamplers[stage]), end(mBoundSamplers[stage]), 0U);
+		}
+	}
+
+	uint32_t RecordingRenderDevice::CreateBuffer(const BufferDescription& description, const void* data)
+	{
+		BufferEntry entry = { description, {}, false };
+		if (description.Dynamic)
+		{
+			entry.Contents.resize(description.Size);
+		}
+
+		mBuffers.push_back(move(entry));
+		uint32_t buffer = static_cast<uint32_t>(mBuffers.size() - 1);
+
+		if (data != nullptr)
+		{
+			mStatistics.BytesUploaded += description.Size;
+		}
+
+		Record(CommandType::CreateBuffer, static_cast<uint32_t>(description.Type), (description.Dynamic ? 1 : 0), description.Size, description.Stride, buffer);
+		return buffer;
+	}
+
+	uint32_t RecordingRenderDevice::CreateTexture(const TextureDescription& description, const SubresourceData* subresources)
+	{
+		if (subresources != nullptr)
+		{
+			for (uint32_t slice = 0; slice < description.ArraySize; ++slice)
+			{
+				for (uint32_t mipLevel = 0; mipLevel < description.MipLevels; ++mipLevel)
+				{
+					uint32_t rows = max(description.Height >> mipLevel, 1U);
+					mStatistics.BytesUploaded += static_cast<uint64_t>(subresources[slice * description.MipLevels + mipLevel].RowPitch) * rows;
+				}
+			}
+		}
+
+		uint32_t texture = ++mTextureCount;
+		Record(CommandType::CreateTexture, description.Width, description.Height, description.MipLevels, description.ArraySize, texture);
+		return texture;
+	}
+
+	uint32_t RecordingRenderDevice::CreateShader(const void* vertexShader, size_t vertexShaderSize, const void* pixelShader, size_t pixelShaderSize,
+		const VertexElement* vertexElements, uint32_t vertexElementCount)
+	{
+		UNREFERENCED_PARAMETER(vertexShader);
+		UNREFERENCED_PARAMETER(pixelShader);
+		UNREFERENCED_PARAMETER(vertexElements);
+
+		mStatistics.BytesUploaded += vertexShaderSize + pixelShaderSize;
+
+		uint32_t shader = ++mShaderCount;
+		Record(CommandType::CreateShader, vertexElementCount, shader);
+		return shader;
+	}
+
+	uint32_t RecordingRenderDevice::CreateState(const StateDescription& description)
+	{
+		uint32_t state = ++mStateCount;
+		Record(CommandType::CreateState, static_cast<uint32_t>(description.Blend), static_cast<uint32_t>(description.Depth), static_cast<uint32_t>(description.Cull), state);
+		return state;
+	}
+
+	void RecordingRenderDevice::ReleaseBuffer(uint32_t buffer)
+	{
+		assert(buffer != NullHandle);
+
+		BufferEntry& entry = Buffer(buffer);
+		entry.Contents.clear();
+		entry.Contents.shrink_to_fit();
+		Record(CommandType::ReleaseBuffer, buffer);
+	}
+
+	bool RecordingRenderDevice::SupportsConstantBufferOffsets() const
+	{
+		return true;
+	}
+
+	void* RecordingRenderDevice::Map(uint32_t buffer, bool discard)
+	{
+		BufferEntry& entry = Buffer(buffer);
+		if (entry.Description.Dynamic == false)
+		{
+			throw GameException("Only a dynamic buffer can be mapped.");
+		}
+
+		if (entry.Mapped)
+		{
+			throw GameException("The buffer is already mapped.");
+		}
+
+		entry.Mapped = true;
+		Record(CommandType::Map, buffer, (discard ? 1 : 0));
+		return entry.Contents.data();
+	}
+
+	void RecordingRenderDevice::Unmap(uint32_t buffer, uint32_t writtenSize)
+	{
+		BufferEntry& entry = Buffer(buffer);
+		if (entry.Mapped == false)
+		{
+			throw GameException("The buffer is not mapped.");
+		}
+
+		entry.Mapped = false;
+		mStatistics.BytesUploaded += writtenSize;
+		Record(CommandType::Unmap, buffer, writtenSize);
+	}
+
+	void RecordingRenderDevice::UpdateBuffer(uint32_t buffer, const void* data, uint32_t size)
+	{
+		UNREFERENCED_PARAMETER(data);
+
+		if (Buffer(buffer).Description.Dynamic)
+		{
+			throw GameException("A dynamic buffer must be written through Map().");
+		}
+
+		mStatistics.BytesUploaded += size;
+		Record(CommandType::UpdateBuffer, buffer, size);
+	}
+
+	void RecordingRenderDevice::SetState(uint32_t state)
+	{
+		Bind(mBoundState, state);
+		Record(CommandType::SetState, state);
+	}
+
+	void RecordingRenderDevice::SetShader(uint32_t shader)
+	{
+		Bind(mBoundShader, shader);
+		Record(CommandType::SetShader, shader);
+	}
+
+	void RecordingRenderDevice::SetPrimitiveTopology(PrimitiveTopology topology)
+	{
+		Bind(mBoundTopology, static_cast<uint32_t>(topology));
+		Record(CommandType::SetPrimitiveTopology, static_cast<uint32_t>(topology));
+	}
+
+	void RecordingRenderDevice::SetVertexBuffer(uint32_t buffer, uint32_t stride)
+	{
+		assert(buffer < mBuffers.size());
+		if (buffer == mBoundVertexBuffer && stride == mBoundVertexStride)
+		{
+			++mStatistics.RedundantStateChanges;
+		}
+		else
+		{
+			mBoundVertexBuffer = buffer;
+			mBoundVertexStride = stride;
+			++mStatistics.StateChanges;
+		}
+
+		Record(CommandType::SetVertexBuffer, buffer, stride);
+	}
+
+	void RecordingRenderDevice::SetIndexBuffer(uint32_t buffer)
+	{
+		assert(buffer < mBuffers.size());
+		Bind(mBoundIndexBuffer, buffer);
+		Record(CommandType::SetIndexBuffer, buffer);
+	}
+
+	void RecordingRenderDevice::SetConstantBuffer(ShaderStage stage, uint32_t slot, uint32_t buffer, uint32_t firstConstant, uint32_t constantCount)
+	{
+		assert(slot < ConstantBufferSlots);
+		assert(buffer < mBuffers.size());
+
+		ConstantBufferBinding& bound = mBoundConstantBuffers[static_cast<uint32_t>(stage)][slot];
+		if (bound.Buffer == buffer && bound.FirstConstant == firstConstant && bound.ConstantCount == constantCount)
+		{
+			++mStatistics.RedundantStateChanges;
+		}
+		else
+		{
+			bound = { buffer, firstConstant, constantCount };
+			++mStatistics.StateChanges;
+		}
+
+		Record(CommandType::SetConstantBuffer, static_cast<uint32_t>(stage), slot, buffer, firstConstant, constantCount);
+	}
+
+	void RecordingRenderDevice::SetTexture(ShaderStage stage, uint32_t slot, uint32_t texture)
+	{
+		assert(slot < ResourceSlots);
+		assert(texture <= mTextureCount);
+
+		Bind(mBoundResources[static_cast<uint32_t>(stage)][slot], texture);
+		Record(CommandType::SetTexture, static_cast<uint32_t>(stage), slot, texture);
+	}
+
+	void RecordingRenderDevice::SetStructuredBuffer(ShaderStage stage, uint32_t slot, uint32_t buffer)
+	{
+		assert(slot < ResourceSlots);
+		assert(buffer < mBuffers.size());
+
+		// A buffer and a texture share the shader resource slots, so the bound value tells them apart
+		Bind(mBoundResources[static_cast<uint32_t>(stage)][slot], (buffer == NullHandle ? NullHandle : (buffer | StructuredBufferBit)));
+		Record(CommandType::SetStructuredBuffer, static_cast<uint32_t>(stage), slot, buffer);
+	}
+
+	void RecordingRenderDevice::SetSampler(ShaderStage stage, uint32_t slot, SamplerType sampler)
+	{
+		assert(slot < SamplerSlots);
+
+		Bind(mBoundSamplers[static_cast<uint32_t>(stage)][slot], static_cast<uint32_t>(sampler) + 1);
+		Record(CommandType::SetSampler, static_cast<uint32_t>(stage), slot, static_cast<uint32_t>(sampler));
+	}
+
+	void RecordingRenderDevice::Draw(uint32_t vertexCount, uint32_t startVertex)
+	{
+		++mStatistics.Draws;
+		Record(CommandType::Draw, vertexCount, startVertex);
+	}
+
+	void RecordingRenderDevice::DrawIndexedInstanced(uint32_t indexCount, uint32_t instanceCount, uint32_t startIndex, int32_t baseVertex, uint32_t startInstance)
+	{
+		++mStatistics.Draws;
+		Record(CommandType::DrawIndexedInstanced, indexCount, instanceCount, startIndex, static_cast<uint32_t>(baseVertex), startInstance);
+	}
+
+	void RecordingRenderDevice::Clear()
+	{
+		mCommands.clear();
+		mStatistics = Statistics();
+	}
+
+	const vector<RecordingRenderDevice::Command>& RecordingRenderDevice::Commands() const
+	{
+		return mCommands;
+	}
+
+	const RecordingRenderDevice::Statistics& RecordingRenderDevice::RecordedStatistics() const
+	{
+		return mStatistics;
+	}
+
+	void RecordingRenderDevice::Serialize(ostream& stream) const
+	{
+		for (const Command& command : mCommands)
+		{
+			stream << CommandName(command.Type);
+
+			uint32_t argumentCount = CommandArgumentCount(command.Type);
+			for (uint32_t i = 0; i < argumentCount; ++i)
+			{
+				// The base vertex is the only signed argument
+				if (command.Type == CommandType::DrawIndexedInstanced && i == 3)
+				{
+					stream << ' ' << static_cast<int32_t>(command.Arguments[i]);
+				}
+				else
+				{
+					stream << ' ' << command.Arguments[i];
+				}
+			}
+
+			stream << '\n';
+		}
+	}
+
+	const char* RecordingRenderDevice::CommandName(CommandType type)
+	{
+		return CommandNames[static_cast<uint32_t>(type)];
+	}
+
+	uint32_t RecordingRenderDevice::CommandArgumentCount(CommandType type)
+	{
+		return CommandArgumentCounts[static_cast<uint32_t>(type)];
+	}
+
+	void RecordingRenderDevice::Record(CommandType type, uint32_t argument0, uint32_t argument1, uint32_t argument2, uint32_t argument3, uint32_t argument4)
+	{
+		++mStatistics.Calls;
+		if (mRecordCommands)
+		{
+			mCommands.push_back({ type, { argument0, argument1, argument2, argument3, argument4 } });
+		}
+	}
+
+	void RecordingRenderDevice::Bind(uint32_t& bound, uint32_t value)
+	{
+		if (bound == value)
+		{
+			++mStatistics.RedundantStateChanges;
+		}
+		else
+		{
+			bound = value;
+			++mStatistics.StateChanges;
+		}
+	}
+
+	RecordingRenderDevice::BufferEntry& RecordingRenderDevice::Buffer(uint32_t buffer)
+	{
+		if (buffer >= mBuffers.size())
+		{
+			throw GameException("The buffer handle was not created by the device.");
+		}
+
+		return mBuffers[buffer];
+	}
+}
\ No newline at end of file
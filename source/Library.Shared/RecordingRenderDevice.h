@@ -0,0 +1,152 @@
+#pragma once
+
+#include "RenderDevice.h"
+#include <vector>
+#include <ostream>
+#include <cstdint>
+
+namespace Library
+{
+	/**
+	* A render device that issues nothing, so the CPU cost of the render path can be measured without a graphics
+	* device. It counts the calls made to it, the bytes uploaded and the state changes, telling the binds that change
+	* what is bound from the redundant ones, and may record each call as a command to be written out as text.
+	*
+	* Dynamic buffers are backed by system memory, so clients can write into them through Map() as they would on a device.
+	*/
+	class RecordingRenderDevice final : public RenderDevice
+	{
+	public:
+		enum class CommandType : std::uint8_t
+		{
+			CreateBuffer,
+			CreateTexture,
+			CreateShader,
+			CreateState,
+			ReleaseBuffer,
+			Map,
+			Unmap,
+			UpdateBuffer,
+			SetState,
+			SetShader,
+			SetPrimitiveTopology,
+			SetVertexBuffer,
+			SetIndexBuffer,
+			SetConstantBuffer,
+			SetTexture,
+			SetStructuredBuffer,
+			SetSampler,
+			Draw,
+			DrawIndexedInstanced
+		};
+
+		static const std::uint32_t MaxCommandArguments = 5;
+
+		struct Command
+		{
+			CommandType Type;
+			std::uint32_t Arguments[MaxCommandArguments];		// The arguments of the call in order, with enumerations as their values
+		};
+
+		/**
+		* The work recorded since the last call to Clear().
+		*/
+		struct Statistics
+		{
+			std::uint32_t Calls;
+			std::uint32_t Draws;
+			std::uint32_t StateChanges;				// Binds that changed what was bound
+			std::uint32_t RedundantStateChanges;	// Binds of what was already bound
+			std::uint64_t BytesUploaded;
+		};
+
+		/**
+		* @param recordCommands False to only count the calls, for measuring the render path with the least overhead.
+		*/
+		RecordingRenderDevice(bool recordCommands = true);
+		RecordingRenderDevice(const RecordingRenderDevice&) = delete;
+		RecordingRenderDevice& operator=(const RecordingRenderDevice&) = delete;
+		RecordingRenderDevice(RecordingRenderDevice&&) = delete;
+		RecordingRenderDevice& operator=(RecordingRenderDevice&&) = delete;
+		~RecordingRenderDevice() = default;
+
+		virtual std::uint32_t CreateBuffer(const BufferDescription& description, const void* data) override;
+		virtual std::uint32_t CreateTexture(const TextureDescription& description, const SubresourceData* subresources) override;
+		virtual std::uint32_t CreateShader(const void* vertexShader, std::size_t vertexShaderSize, const void* pixelShader, std::size_t pixelShaderSize,
+			const VertexElement* vertexElements, std::uint32_t vertexElementCount) override;
+		virtual std::uint32_t CreateState(const StateDescription& description) override;
+		virtual void ReleaseBuffer(std::uint32_t buffer) override;
+		virtual bool SupportsConstantBufferOffsets() const override;
+
+		virtual void* Map(std::uint32_t buffer, bool discard) override;
+		virtual void Unmap(std::uint32_t buffer, std::uint32_t writtenSize) override;
+		virtual void UpdateBuffer(std::uint32_t buffer, const void* data, std::uint32_t size) override;
+
+		virtual void SetState(std::uint32_t state) override;
+		virtual void SetShader(std::uint32_t shader) override;
+		virtual void SetPrimitiveTopology(PrimitiveTopology topology) override;
+		virtual void SetVertexBuffer(std::uint32_t buffer, std::uint32_t stride) override;
+		virtual void SetIndexBuffer(std::uint32_t buffer) override;
+		virtual void SetConstantBuffer(ShaderStage stage, std::uint32_t slot, std::uint32_t buffer, std::uint32_t firstConstant, std::uint32_t constantCount) override;
+		virtual void SetTexture(ShaderStage stage, std::uint32_t slot, std::uint32_t texture) override;
+		virtual void SetStructuredBuffer(ShaderStage stage, std::uint32_t slot, std::uint32_t buffer) override;
+		virtual void SetSampler(ShaderStage stage, std::uint32_t slot, SamplerType sampler) override;
+
+		virtual void Draw(std::uint32_t vertexCount, std::uint32_t startVertex) override;
+		virtual void DrawIndexedInstanced(std::uint32_t indexCount, std::uint32_t instanceCount, std::uint32_t startIndex, std::int32_t baseVertex, std::uint32_t startInstance) override;
+
+		/**
+		* Drop the recorded commands and statistics. The resources and what is bound are kept, as on a device.
+		*/
+		void Clear();
+		const std::vector<Command>& Commands() const;
+		const Statistics& RecordedStatistics() const;
+
+		/**
+		* Write the recorded commands as text, one per line: the name of the call followed by its arguments.
+		*/
+		void Serialize(std::ostream& stream) const;
+		static const char* CommandName(CommandType type);
+		static std::uint32_t CommandArgumentCount(CommandType type);
+
+	private:
+		struct BufferEntry
+		{
+			BufferDescription Description;
+			std::vector<std::uint8_t> Contents;		// Only for dynamic buffers
+			bool Mapped;
+		};
+
+		struct ConstantBufferBinding
+		{
+			std::uint32_t Buffer;
+			std::uint32_t FirstConstant;
+			std::uint32_t ConstantCount;
+		};
+
+		static const std::uint32_t ShaderStageCount = 2;
+
+		void Record(CommandType type, std::uint32_t argument0 = 0, std::uint32_t argument1 = 0, std::uint32_t argument2 = 0, std::uint32_t argument3 = 0, std::uint32_t argument4 = 0);
+		void Bind(std::uint32_t& bound, std::uint32_t value);
+		BufferEntry& Buffer(std::uint32_t buffer);
+
+		bool mRecordCommands;
+		std::vector<Command> mCommands;
+		Statistics mStatistics;
+
+		std::vector<BufferEntry> mBuffers;
+		std::uint32_t mTextureCount;
+		std::uint32_t mShaderCount;
+		std::uint32_t mStateCount;
+
+		std::uint32_t mBoundState;
+		std::uint32_t mBoundShader;
+		std::uint32_t mBoundTopology;
+		std::uint32_t mBoundVertexBuffer;
+		std::uint32_t mBoundVertexStride;
+		std::uint32_t mBoundIndexBuffer;
+		ConstantBufferBinding mBoundConstantBuffers[ShaderStageCount][ConstantBufferSlots];
+		std::uint32_t mBoundResources[ShaderStageCount][ResourceSlots];		// Textures, and structured buffers with the top bit set
+		std::uint32_t mBoundSamplers[ShaderStageCount][SamplerSlots];		// The sampler type plus one, zero when unbound
+	};
+}
\ No newline at end of file
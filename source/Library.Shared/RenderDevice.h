@@ -0,0 +1,175 @@
+#pragma once
+
+#include <cstdint>
+#include <cstddef>
+
+namespace Library
+{
+	/**
+	* The device the render path creates its resources on and issues its draws to, for Direct3D or for measurement.
+	* Resources are named by handles the device returns, each kind counted separately from 1, so the interface carries
+	* no types of a graphics API; RenderDevice::NullHandle unbinds a slot.
+	*
+	* The interface covers what the components drawing through the render queue need, and no more: buffers, textures
+	* of RGBA pixels, shader pairs with their vertex layout, fixed combinations of blend, depth and rasterizer state,
+	* and non-indexed and indexed instanced draws. Indices are always 32 bits.
+	*/
+	class RenderDevice
+	{
+	public:
+		static const std::uint32_t NullHandle = 0;
+		static const std::uint32_t ConstantBufferSlots = 14;
+		static const std::uint32_t ResourceSlots = 16;
+		static const std::uint32_t SamplerSlots = 16;
+
+		enum class BufferType : std::uint8_t
+		{
+			Vertex,
+			Index,
+			Constant,
+			Structured
+		};
+
+		enum class ShaderStage : std::uint8_t
+		{
+			Vertex,
+			Pixel
+		};
+
+		enum class VertexFormat : std::uint8_t
+		{
+			Float2,
+			Float3,
+			Float4
+		};
+
+		enum class PrimitiveTopology : std::uint8_t
+		{
+			PointList,
+			LineList,
+			TriangleList
+		};
+
+		enum class BlendMode : std::uint8_t
+		{
+			Opaque,
+			AlphaBlending,
+			MultiplicativeBlending
+		};
+
+		enum class DepthMode : std::uint8_t
+		{
+			ReadWrite,
+			ReadOnly,
+			Disabled
+		};
+
+		enum class CullMode : std::uint8_t
+		{
+			Back,
+			Front,
+			None
+		};
+
+		enum class SamplerType : std::uint8_t
+		{
+			TrilinearWrap,
+			TrilinearClamp,
+			PointClamp
+		};
+
+		struct BufferDescription
+		{
+			BufferType Type;
+			bool Dynamic;				// Written through Map() each frame rather than created filled
+			std::uint32_t Size;
+			std::uint32_t Stride;		// The size of an element of a structured buffer, otherwise unused
+		};
+
+		/**
+		* A texture, or an array of textures, of 8 bit RGBA pixels.
+		*/
+		struct TextureDescription
+		{
+			std::uint32_t Width;
+			std::uint32_t Height;
+			std::uint32_t MipLevels;
+			std::uint32_t ArraySize;
+		};
+
+		struct SubresourceData
+		{
+			const void* Data;
+			std::uint32_t RowPitch;
+		};
+
+		/**
+		* An element of a vertex, each following the previous one in the vertex buffer.
+		*/
+		struct VertexElement
+		{
+			const char* SemanticName;
+			std::uint32_t SemanticIndex;
+			VertexFormat Format;
+		};
+
+		struct StateDescription
+		{
+			BlendMode Blend;
+			DepthMode Depth;
+			CullMode Cull;
+		};
+
+		virtual ~RenderDevice() = default;
+
+		/**
+		* @param data The initial contents of the buffer, or null for a dynamic buffer.
+		*/
+		virtual std::uint32_t CreateBuffer(const BufferDescription& description, const void* data) = 0;
+		/**
+		* @param subresources The mip levels of each slice of the texture in turn, ArraySize * MipLevels of them.
+		*/
+		virtual std::uint32_t CreateTexture(const TextureDescription& description, const SubresourceData* subresources) = 0;
+		virtual std::uint32_t CreateShader(const void* vertexShader, std::size_t vertexShaderSize, const void* pixelShader, std::size_t pixelShaderSize,
+			const VertexElement* vertexElements, std::uint32_t vertexElementCount) = 0;
+		virtual std::uint32_t CreateState(const StateDescription& description) = 0;
+		/**
+		* Release a buffer created by the device, such as one outgrown. Its handle is not given out again.
+		*/
+		virtual void ReleaseBuffer(std::uint32_t buffer) = 0;
+		/**
+		* Get whether a constant buffer can be bound from an offset, and mapped without overwriting while in use.
+		*/
+		virtual bool SupportsConstantBufferOffsets() const = 0;
+
+		/**
+		* Map a dynamic buffer for writing.
+		* @param discard True to give up the previous contents, false to promise not to overwrite any range already in use.
+		*/
+		virtual void* Map(std::uint32_t buffer, bool discard) = 0;
+		/**
+		* @param writtenSize The number of bytes written while the buffer was mapped, for measurement.
+		*/
+		virtual void Unmap(std::uint32_t buffer, std::uint32_t writtenSize) = 0;
+		/**
+		* Replace the contents of a buffer that is not dynamic.
+		*/
+		virtual void UpdateBuffer(std::uint32_t buffer, const void* data, std::uint32_t size) = 0;
+
+		virtual void SetState(std::uint32_t state) = 0;
+		virtual void SetShader(std::uint32_t shader) = 0;
+		virtual void SetPrimitiveTopology(PrimitiveTopology topology) = 0;
+		virtual void SetVertexBuffer(std::uint32_t buffer, std::uint32_t stride) = 0;
+		virtual void SetIndexBuffer(std::uint32_t buffer) = 0;
+		/**
+		* Bind a window of a constant buffer, given in shader constants of 16 bytes.
+		*/
+		virtual void SetConstantBuffer(ShaderStage stage, std::uint32_t slot, std::uint32_t buffer, std::uint32_t firstConstant, std::uint32_t constantCount) = 0;
+		virtual void SetTexture(ShaderStage stage, std::uint32_t slot, std::uint32_t texture) = 0;
+		virtual void SetStructuredBuffer(ShaderStage stage, std::uint32_t slot, std::uint32_t buffer) = 0;
+		virtual void SetSampler(ShaderStage stage, std::uint32_t slot, SamplerType sampler) = 0;
+
+		virtual void Draw(std::uint32_t vertexCount, std::uint32_t startVertex) = 0;
+		virtual void DrawIndexedInstanced(std::uint32_t indexCount, std::uint32_t instanceCount, std::uint32_t startIndex, std::int32_t baseVertex, std::uint32_t startInstance) = 0;
+	};
+}
\ No newline at end of file
@@ -0,0 +1,174 @@
+#include "pch.h"
+
+using namespace std;
+
+namespace Library
+{
+	RTTI_DEFINITIONS(RenderQueue)
+
+	namespace
+	{
+		const uint32_t DigitBits = 8;
+		const uint32_t DigitCount = 64 / DigitBits;
+		const uint32_t Radix = 1 << DigitBits;
+
+		const uint32_t TextureShift = RenderQueue::DepthBits;
+		const uint32_t ShaderShift = TextureShift + RenderQueue::TextureBits;
+		const uint32_t PassShift = ShaderShift + RenderQueue::ShaderBits;
+
+		// No field holds this value, so the first packet executed binds every field
+		const uint32_t Unbound = UINT32_MAX;
+	}
+
+	RenderQueue::RenderQueue() :
+		mStatistics()
+	{
+	}
+
+	void RenderQueue::Clear()
+	{
+		mPackets.clear();
+	}
+
+	void RenderQueue::Submit(uint64_t key, RenderQueueClient& client, uint32_t command)
+	{
+		mPackets.push_back({ key, &client, command });
+	}
+
+	uint32_t RenderQueue::Count() const
+	{
+		return static_cast<uint32_t>(mPackets.size());
+	}
+
+	const DrawPacket* RenderQueue::Packets() const
+	{
+		return mPackets.data();
+	}
+
+	void RenderQueue::Sort()
+	{
+		size_t count = mPackets.size();
+		if (count < 2)
+		{
+			return;
+		}
+
+		// Count every digit of every key in a single pass over the packets
+		uint32_t histograms[DigitCount][Radix] = { };
+		for (const DrawPacket& packet : mPackets)
+		{
+			uint64_t key = packet.Key;
+			for (uint32_t digit = 0; digit < DigitCount; ++digit)
+			{
+				++histograms[digit][(key >> (digit * DigitBits)) & (Radix - 1)];
+			}
+		}
+
+		mSortBuffer.resize(count);
+		DrawPacket* source = mPackets.data();
+		DrawPacket* destination = mSortBuffer.data();
+		for (uint32_t digit = 0; digit < DigitCount; ++digit)
+		{
+			// Most keys of a frame share their pass and shader, and a digit they all share leaves the order as it is
+			uint32_t shift = digit * DigitBits;
+			uint32_t* histogram = histograms[digit];
+			if (histogram[(source[0].Key >> shift) & (Radix - 1)] == count)
+			{
+				continue;
+			}
+
+			uint32_t offset = 0;
+			for (uint32_t value = 0; value < Radix; ++value)
+			{
+				uint32_t valueCount = histogram[value];
+				histogram[value] = offset;
+				offset += valueCount;
+			}
+
+			for (size_t i = 0; i < count; ++i)
+			{
+				destination[histogram[(source[i].Key >> shift) & (Radix - 1)]++] = source[i];
+			}
+
+			swap(source, destination);
+		}
+
+		if (source != mPackets.data())
+		{
+			mPackets.swap(mSortBuffer);
+		}
+	}
+
+	void RenderQueue::Execute(RenderBackend& backend)
+	{
+		mStatistics = { Count(), 0, 0, 0 };
+
+		uint32_t pass = Unbound;
+		uint32_t shader = Unbound;
+		uint32_t texture = NoTexture;
+		for (const DrawPacket& packet : mPackets)
+		{
+			uint32_t packetPass = KeyPass(packet.Key);
+			if (packetPass != pass)
+			{
+				backend.BindPass(packetPass);
+				pass = packetPass;
+				++mStatistics.PassBinds;
+			}
+
+			uint32_t packetShader = KeyShader(packet.Key);
+			if (packetShader != shader)
+			{
+				backend.BindShader(packetShader);
+				shader = packetShader;
+				++mStatistics.ShaderBinds;
+			}
+
+			uint32_t packetTexture = KeyTexture(packet.Key);
+			if (packetTexture != NoTexture && packetTexture != texture)
+			{
+				backend.BindTexture(packetTexture);
+				texture = packetTexture;
+				++mStatistics.TextureBinds;
+			}
+
+			backend.Draw(packet);
+		}
+	}
+
+	const RenderQueue::Statistics& RenderQueue::LastStatistics() const
+	{
+		return mStatistics;
+	}
+
+	uint64_t RenderQueue::MakeKey(uint32_t pass, uint32_t shader, uint32_t texture, float depth, DepthOrder order)
+	{
+		assert(pass < (1U << PassBits) && shader < (1U << ShaderBits) && texture < (1U << TextureBits));
+
+		// The bits of a non-negative float ascend with its value
+		uint32_t depthBits;
+		depth = max(depth, 0.0f);
+		memcpy(&depthBits, &depth, sizeof(depthBits));
+		if (order == DepthOrder::BackToFront)
+		{
+			depthBits = ~depthBits;
+		}
+
+		return (static_cast<uint64_t>(pass) << PassShift) | (static_cast<uint64_t>(shader) << ShaderShift) | (static_cast<uint64_t>(texture) << TextureShift) | depthBits;
+	}
+
+	uint32_t RenderQueue::KeyPass(uint64_t key)
+	{
+		return static_cast<uint32_t>(key >> PassShift) & ((1U << PassBits) - 1);
+	}
+
+	uint32_t RenderQueue::KeyShader(uint64_t key)
+	{
+		return static_cast<uint32_t>(key >> ShaderShift) & ((1U << ShaderBits) - 1);
+	}
+
+	uint32_t RenderQueue::KeyTexture(uint64_t key)
+	{
+		return static_cast<uint32_t>(key >> TextureShift) & ((1U << TextureBits) - 1);
+	}
+}
\ No newline at end of file
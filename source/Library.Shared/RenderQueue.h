@@ -0,0 +1,129 @@
+#pragma once
+
+#include "RTTI.h"
+#include <vector>
+#include <cstdint>
+
+namespace Library
+{
+	/**
+	* Issues the draw of a packet once the render queue has bound the state named by its key.
+	*/
+	class RenderQueueClient
+	{
+	public:
+		/**
+		* @param command The value the client submitted the packet with, such as the index of a batch.
+		*/
+		virtual void ExecuteDraw(std::uint32_t command) = 0;
+
+	protected:
+		RenderQueueClient() = default;
+		~RenderQueueClient() = default;
+	};
+
+	/**
+	* One draw submitted to the render queue.
+	*/
+	struct DrawPacket
+	{
+		std::uint64_t Key;
+		RenderQueueClient* Client;
+		std::uint32_t Command;
+	};
+
+	/**
+	* Binds the state named by the fields of a key and issues draws, for a device or for measurement.
+	*/
+	class RenderBackend
+	{
+	public:
+		virtual ~RenderBackend() = default;
+
+		virtual void BindPass(std::uint32_t pass) = 0;
+		virtual void BindShader(std::uint32_t shader) = 0;
+		virtual void BindTexture(std::uint32_t texture) = 0;
+		virtual void Draw(const DrawPacket& packet) = 0;
+	};
+
+	/**
+	* Collects the draws of a frame as packets and issues them in the order of their keys rather than the order the
+	* components were added to the game. A key holds, from its most significant bits, the pass, the shader, the texture
+	* and the depth of the draw, so sorting groups the draws of a pass by shader and then by texture, nearest first
+	* within each group. The packets are sorted by a least significant digit radix sort, skipping the digits every key
+	* shares, and executed binding only the fields that differ from the previous packet.
+	*
+	* The queue has no device dependencies; the backend it executes against decides what binding and drawing mean.
+	*/
+	class RenderQueue final : public RTTI
+	{
+		RTTI_DECLARATIONS(RenderQueue, RTTI)
+
+	public:
+		enum class DepthOrder
+		{
+			FrontToBack,
+			BackToFront
+		};
+
+		/**
+		* The work done by the last call to Execute().
+		*/
+		struct Statistics
+		{
+			std::uint32_t Packets;
+			std::uint32_t PassBinds;
+			std::uint32_t ShaderBinds;
+			std::uint32_t TextureBinds;
+		};
+
+		static const std::uint32_t PassBits = 4;
+		static const std::uint32_t ShaderBits = 12;
+		static const std::uint32_t TextureBits = 16;
+		static const std::uint32_t DepthBits = 32;
+
+		/**
+		* The texture of a draw that samples none, which leaves the bound texture alone.
+		*/
+		static const std::uint32_t NoTexture = 0;
+
+		RenderQueue();
+		RenderQueue(const RenderQueue&) = delete;
+		RenderQueue& operator=(const RenderQueue&) = delete;
+		RenderQueue(RenderQueue&&) = delete;
+		RenderQueue& operator=(RenderQueue&&) = delete;
+		~RenderQueue() = default;
+
+		/**
+		* Drop the packets of the previous frame.
+		*/
+		void Clear();
+		void Submit(std::uint64_t key, RenderQueueClient& client, std::uint32_t command);
+		std::uint32_t Count() const;
+		const DrawPacket* Packets() const;
+
+		/**
+		* Order the packets by key, keeping the order of submission among equal keys.
+		*/
+		void Sort();
+		/**
+		* Issue the packets in their current order, binding each field of a key only when it changes.
+		*/
+		void Execute(RenderBackend& backend);
+		const Statistics& LastStatistics() const;
+
+		/**
+		* Compose a key. Each field must fit in its number of bits.
+		* @param depth The distance of the draw from the camera, of which only non-negative values are ordered.
+		*/
+		static std::uint64_t MakeKey(std::uint32_t pass, std::uint32_t shader, std::uint32_t texture, float depth, DepthOrder order = DepthOrder::FrontToBack);
+		static std::uint32_t KeyPass(std::uint64_t key);
+		static std::uint32_t KeyShader(std::uint64_t key);
+		static std::uint32_t KeyTexture(std::uint64_t key);
+
+	private:
+		std::vector<DrawPacket> mPackets;
+		std::vector<DrawPacket> mSortBuffer;
+		Statistics mStatistics;
+	};
+}
\ No newline at end of file
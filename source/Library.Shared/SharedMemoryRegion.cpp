@@ -0,0 +1,220 @@
+#include "pch.h"
+
+using namespace std;
+
+namespace Library
+{
+#if defined(_WIN32)
+	SharedMemoryRegion SharedMemoryRegion::Create(const wstring& name, size_t size)
+	{
+		uint64_t size64 = static_cast<uint64_t>(size);
+		HANDLE mapping = CreateFileMapping(INVALID_HANDLE_VALUE, nullptr, PAGE_READWRITE, static_cast<DWORD>(size64 >> 32), static_cast<DWORD>(size64 & 0xFFFFFFFF), name.c_str());
+		if (mapping == nullptr)
+		{
+			throw GameException("CreateFileMapping() failed.", HRESULT_FROM_WIN32(GetLastError()));
+		}
+
+		if (GetLastError() == ERROR_ALREADY_EXISTS)
+		{
+			CloseHandle(mapping);
+			throw GameException("Shared memory region already exists.", HRESULT_FROM_WIN32(ERROR_ALREADY_EXISTS));
+		}
+
+		void* data = MapViewOfFile(mapping, FILE_MAP_ALL_ACCESS, 0, 0, size);
+		if (data == nullptr)
+		{
+			HRESULT hr = HRESULT_FROM_WIN32(GetLastError());
+			CloseHandle(mapping);
+			throw GameException("MapViewOfFile() failed.", hr);
+		}
+
+		return SharedMemoryRegion(mapping, data, size, name);
+	}
+
+	SharedMemoryRegion SharedMemoryRegion::Open(const wstring& name)
+	{
+		HANDLE mapping = OpenFileMapping(FILE_MAP_ALL_ACCESS, FALSE, name.c_str());
+		if (mapping == nullptr)
+		{
+			throw GameException("OpenFileMapping() failed.", HRESULT_FROM_WIN32(GetLastError()));
+		}
+
+		void* data = MapViewOfFile(mapping, FILE_MAP_ALL_ACCESS, 0, 0, 0);
+		if (data == nullptr)
+		{
+			HRESULT hr = HRESULT_FROM_WIN32(GetLastError());
+			CloseHandle(mapping);
+			throw GameException("MapViewOfFile() failed.", hr);
+		}
+
+		MEMORY_BASIC_INFORMATION information;
+		VirtualQuery(data, &information, sizeof(information));
+
+		return SharedMemoryRegion(mapping, data, information.RegionSize, name);
+	}
+
+	SharedMemoryRegion::SharedMemoryRegion(HANDLE mapping, void* data, size_t size, const wstring& name) :
+		mMapping(mapping), mData(data), mSize(size), mName(name)
+	{
+	}
+
+#else
+	SharedMemoryRegion SharedMemoryRegion::Create(const wstring& name, size_t size)
+	{
+		string objectName = Utility::ToString(name);
+		int file = shm_open(objectName.c_str(), O_RDWR | O_CREAT | O_EXCL, S_IRUSR | S_IWUSR);
+		if (file == -1)
+		{
+			throw GameException(errno == EEXIST ? "Shared memory region already exists." : "shm_open() failed.");
+		}
+
+		// A new object grows zero-filled to its size
+		if (ftruncate(file, static_cast<off_t>(size)) == -1)
+		{
+			close(file);
+			shm_unlink(objectName.c_str());
+			throw GameException("ftruncate() failed.");
+		}
+
+		// The mapping outlives the descriptor
+		void* data = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, file, 0);
+		close(file);
+		if (data == MAP_FAILED)
+		{
+			shm_unlink(objectName.c_str());
+			throw GameException("mmap() failed.");
+		}
+
+		return SharedMemoryRegion(true, data, size, name);
+	}
+
+	SharedMemoryRegion SharedMemoryRegion::Open(const wstring& name)
+	{
+		int file = shm_open(Utility::ToString(name).c_str(), O_RDWR, 0);
+		if (file == -1)
+		{
+			throw GameException("shm_open() failed.");
+		}
+
+		struct stat status;
+		if (fstat(file, &status) == -1)
+		{
+			close(file);
+			throw GameException("fstat() failed.");
+		}
+
+		size_t size = static_cast<size_t>(status.st_size);
+		void* data = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, file, 0);
+		close(file);
+		if (data == MAP_FAILED)
+		{
+			throw GameException("mmap() failed.");
+		}
+
+		return SharedMemoryRegion(false, data, size, name);
+	}
+
+	SharedMemoryRegion::SharedMemoryRegion(bool owner, void* data, size_t size, const wstring& name) :
+		mOwner(owner), mData(data), mSize(size), mName(name)
+	{
+	}
+#endif
+
+	SharedMemoryRegion::SharedMemoryRegion(SharedMemoryRegion&& rhs) :
+#if defined(_WIN32)
+		mMapping(rhs.mMapping), mData(rhs.mData), mSize(rhs.mSize), mName(move(rhs.mName))
+	{
+		rhs.mMapping = nullptr;
+#else
+		mOwner(rhs.mOwner), mData(rhs.mData), mSize(rhs.mSize), mName(move(rhs.mName))
+	{
+		rhs.mOwner = false;
+#endif
+		rhs.mData = nullptr;
+		rhs.mSize = 0;
+	}
+
+	SharedMemoryRegion& SharedMemoryRegion::operator=(SharedMemoryRegion&& rhs)
+	{
+		if (this != &rhs)
+		{
+			Close();
+
+#if defined(_WIN32)
+			mMapping = rhs.mMapping;
+#else
+			mOwner = rhs.mOwner;
+#endif
+			mData = rhs.mData;
+			mSize = rhs.mSize;
+			mName = move(rhs.mName);
+
+#if defined(_WIN32)
+			rhs.mMapping = nullptr;
+#else
+			rhs.mOwner = false;
+#endif
+			rhs.mData = nullptr;
+			rhs.mSize = 0;
+		}
+
+		return *this;
+	}
+
+	SharedMemoryRegion::~SharedMemoryRegion()
+	{
+		Close();
+	}
+
+	void* SharedMemoryRegion::Data() const
+	{
+		return mData;
+	}
+
+	size_t SharedMemoryRegion::Size() const
+	{
+		return mSize;
+	}
+
+	const wstring& SharedMemoryRegion::Name() const
+	{
+		return mName;
+	}
+
+#if defined(_WIN32)
+	void SharedMemoryRegion::Close()
+	{
+		if (mData != nullptr)
+		{
+			UnmapViewOfFile(mData);
+			mData = nullptr;
+		}
+
+		if (mMapping != nullptr)
+		{
+			CloseHandle(mMapping);
+			mMapping = nullptr;
+		}
+
+		mSize = 0;
+	}
+#else
+	void SharedMemoryRegion::Close()
+	{
+		if (mData != nullptr)
+		{
+			munmap(mData, mSize);
+			mData = nullptr;
+		}
+
+		// The object lasts until the creator is done with it; processes still mapping it keep their views
+		if (mOwner)
+		{
+			shm_unlink(Utility::ToString(mName).c_str());
+			mOwner = false;
+		}
+
+		mSize = 0;
+	}
+#endif
+}
\ No newline at end of file
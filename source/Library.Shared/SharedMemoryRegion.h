@@ -0,0 +1,56 @@
+#pragma once
+
+#include "Platform.h"
+#include <string>
+#include <cstdint>
+
+namespace Library
+{
+	/**
+	* A named block of memory backed by the system paging file that can be mapped by several processes.
+	* On Windows the name is that of a file mapping object, such as Local\Name; elsewhere it is a POSIX shared memory
+	* object, named with a single leading slash, which the creating process unlinks when it closes the region.
+	*/
+	class SharedMemoryRegion final
+	{
+	public:
+		/**
+		* Create a new zero-initialized region.
+		* @param name The name other processes use to open the region.
+		* @param size The size of the region in bytes.
+		*/
+		static SharedMemoryRegion Create(const std::wstring& name, std::size_t size);
+		/**
+		* Open a region created by another process.
+		* @param name The name of the region.
+		*/
+		static SharedMemoryRegion Open(const std::wstring& name);
+
+		SharedMemoryRegion(const SharedMemoryRegion&) = delete;
+		SharedMemoryRegion& operator=(const SharedMemoryRegion&) = delete;
+		SharedMemoryRegion(SharedMemoryRegion&& rhs);
+		SharedMemoryRegion& operator=(SharedMemoryRegion&& rhs);
+		~SharedMemoryRegion();
+
+		void* Data() const;
+		std::size_t Size() const;
+		const std::wstring& Name() const;
+
+	private:
+#if defined(_WIN32)
+		SharedMemoryRegion(HANDLE mapping, void* data, std::size_t size, const std::wstring& name);
+#else
+		SharedMemoryRegion(bool owner, void* data, std::size_t size, const std::wstring& name);
+#endif
+		void Close();
+
+#if defined(_WIN32)
+		HANDLE mMapping;
+#else
+		bool mOwner;
+#endif
+		void* mData;
+		std::size_t mSize;
+		std::wstring mName;
+	};
+}
\ No newline at end of file
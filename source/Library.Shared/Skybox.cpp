@@ -9,7 +9,7 @@ namespace Library
 
 	Skybox::Skybox(Game& game, const shared_ptr<Camera>& camera, const wstring& cubeMapFileName, float scale) :
 		DrawableGameComponent(game, camera),
-		mCubeMapFileName(cubeMapFileName), mIndexCount(0),
+		mCubeMapFileName(cubeMapFileName),
 		mWorldMatrix(MatrixHelper::Identity), mScaleMatrix(MatrixHelper::Identity)
 	{
 		XMStoreFloat4x4(&mScaleMatrix, XMMatrixScaling(scale, scale, scale));
@@ -36,14 +36,11 @@ namespace Library
 
 		ThrowIfFailed(mGame->Direct3DDevice()->CreateInputLayout(inputElementDescriptions, ARRAYSIZE(inputElementDescriptions), &compiledVertexShader[0], compiledVertexShader.size(), mInputLayout.GetAddressOf()), "ID3D11Device::CreateInputLayout() failed.");
 
-		// Load the model
-		Library::Model model = Library::Model("Content\\Models\\Sphere.obj.bin");
-
-		// Create vertex and index buffers for the model
-		Mesh* mesh = model.Meshes().at(0).get();
-		CreateVertexBuffer(mGame->Direct3DDevice(), *mesh, mVertexBuffer.ReleaseAndGetAddressOf());
-		mesh->CreateIndexBuffer(*mGame->Direct3DDevice(), mIndexBuffer.ReleaseAndGetAddressOf());
-		mIndexCount = static_cast<UINT>(mesh->Indices().size());
+		// Get the vertex and index buffers of the model, shared with anything else drawing it
+		ModelCache* modelCache = (ModelCache*)mGame->Services().GetService(ModelCache::TypeIdClass());
+		assert(modelCache != nullptr);
+		auto createVertexBuffer = [this](ID3D11Device* device, const Mesh& mesh, ID3D11Buffer** vertexBuffer) { CreateVertexBuffer(device, mesh, vertexBuffer); };
+		mMeshBuffers = modelCache->LoadBuffers<VertexPositionTexture>(mGame->Direct3DDevice(), "Content\\Models\\Sphere.obj.bin", 0, createVertexBuffer);
 
 		ThrowIfFailed(DirectX::CreateDDSTextureFromFile(mGame->Direct3DDevice(), mCubeMapFileName.c_str(), nullptr, mSkyboxTexture.GetAddressOf()), "CreateDDSTextureFromFile() failed.");
 
@@ -72,8 +69,8 @@ namespace Library
 
 		UINT stride = sizeof(VertexPositionTexture);
 		UINT offset = 0;
-		direct3DDeviceContext->IASetVertexBuffers(0, 1, mVertexBuffer.GetAddressOf(), &stride, &offset);
-		direct3DDeviceContext->IASetIndexBuffer(mIndexBuffer.Get(), DXGI_FORMAT_R32_UINT, 0);
+		direct3DDeviceContext->IASetVertexBuffers(0, 1, mMeshBuffers->VertexBuffer.GetAddressOf(), &stride, &offset);
+		direct3DDeviceContext->IASetIndexBuffer(mMeshBuffers->IndexBuffer.Get(), DXGI_FORMAT_R32_UINT, 0);
 
 		direct3DDeviceContext->VSSetShader(mVertexShader.Get(), nullptr, 0);
 		direct3DDeviceContext->PSSetShader(mPixelShader.Get(), nullptr, 0);
@@ -89,7 +86,7 @@ namespace Library
 		direct3DDeviceContext->PSSetSamplers(0, 1, SamplerStates::TrilinearClamp.GetAddressOf());
 
 		direct3DDeviceContext->RSSetState(RasterizerStates::DisabledCulling.Get());
-		direct3DDeviceContext->DrawIndexed(mIndexCount, 0, 0);
+		direct3DDeviceContext->DrawIndexed(mMeshBuffers->IndexCount, 0, 0);
 		direct3DDeviceContext->RSSetState(nullptr);
 	}
 
@@ -8,6 +8,7 @@
 namespace Library
 {
 	class Mesh;
+	struct MeshBuffers;
 
 	class Skybox final : public DrawableGameComponent
 	{
@@ -44,10 +45,8 @@ namespace Library
 		Microsoft::WRL::ComPtr<ID3D11VertexShader> mVertexShader;
 		Microsoft::WRL::ComPtr<ID3D11PixelShader> mPixelShader;
 		Microsoft::WRL::ComPtr<ID3D11InputLayout> mInputLayout;
-		Microsoft::WRL::ComPtr<ID3D11Buffer> mVertexBuffer;
-		Microsoft::WRL::ComPtr<ID3D11Buffer> mIndexBuffer;
 		Microsoft::WRL::ComPtr<ID3D11Buffer> mVertexCBufferPerObject;		
 		Microsoft::WRL::ComPtr<ID3D11ShaderResourceView> mSkyboxTexture;
-		UINT mIndexCount;		
+		std::shared_ptr<const MeshBuffers> mMeshBuffers;
 	};
 }
\ No newline at end of file
@@ -0,0 +1,768 @@
+#include "pch.h"
+
+using namespace std;
+using namespace DirectX;
+
+namespace Library
+{
+	namespace
+	{
+		// Runs per thread of the pool, so a thread finishing its run early can take another
+		const uint32_t RunsPerThread = 4;
+		const uint32_t LaneCount = 4;
+		const uint32_t Unmapped = UINT32_MAX;
+		const uint32_t MaxClippedVertices = 5;
+
+		// The sides of the clip volume a vertex lies outside of
+		const uint32_t OutsideLeft = 0x01;
+		const uint32_t OutsideRight = 0x02;
+		const uint32_t OutsideBottom = 0x04;
+		const uint32_t OutsideTop = 0x08;
+		const uint32_t OutsideNear = 0x10;
+		const uint32_t OutsideFar = 0x20;
+
+		/**
+		* The lanes set in the result of a comparison, lane i in bit i. A single instruction where the lanes are SSE
+		* registers, and read back lane by lane where DirectXMath is built without intrinsics or on other processors.
+		*/
+		inline uint32_t LaneMask(FXMVECTOR comparison)
+		{
+#if defined(_XM_SSE_INTRINSICS_)
+			return static_cast<uint32_t>(_mm_movemask_ps(comparison));
+#else
+			uint32_t lanes[LaneCount];
+			XMStoreInt4(lanes, comparison);
+			return (lanes[0] >> 31) | ((lanes[1] >> 31) << 1) | ((lanes[2] >> 31) << 2) | ((lanes[3] >> 31) << 3);
+#endif
+		}
+	}
+
+	float SoftwareFragment::Ddx(uint32_t varying) const
+	{
+		return Derivative(varying, mWeightDdx);
+	}
+
+	float SoftwareFragment::Ddy(uint32_t varying) const
+	{
+		return Derivative(varying, mWeightDdy);
+	}
+
+	float SoftwareFragment::Derivative(uint32_t varying, const float* weightDerivatives) const
+	{
+		// The value is the quotient of two planes, the weighted sum of the vertex values and the sum of the weights
+		float weightSumDerivative = weightDerivatives[0] + weightDerivatives[1] + weightDerivatives[2];
+		float weightedDerivative = weightDerivatives[0] * mVertexVaryings[0][varying] + weightDerivatives[1] * mVertexVaryings[1][varying] + weightDerivatives[2] * mVertexVaryings[2][varying];
+
+		return (weightedDerivative - Varyings[varying] * weightSumDerivative) * mInverseWeightSum;
+	}
+
+	SoftwareRasterizer::SoftwareRasterizer(ThreadPool& threadPool, uint32_t width, uint32_t height) :
+		mThreadPool(&threadPool), mWidth(width), mHeight(height), mTilesX((width + TileSize - 1) / TileSize), mTilesY((height + TileSize - 1) / TileSize),
+		mState({ RenderDevice::BlendMode::Opaque, RenderDevice::DepthMode::ReadWrite, RenderDevice::CullMode::Back }), mRunCount(0), mStatistics()
+	{
+		if (mWidth == 0 || mHeight == 0)
+		{
+			throw GameException("The software rasterizer needs a target of at least one pixel.");
+		}
+
+		mColors.resize(mTilesX * mTilesY * TileSize * TileSize, 0);
+		mDepths.resize(mColors.size(), 1.0f);
+	}
+
+	uint32_t SoftwareRasterizer::Width() const
+	{
+		return mWidth;
+	}
+
+	uint32_t SoftwareRasterizer::Height() const
+	{
+		return mHeight;
+	}
+
+	void SoftwareRasterizer::Clear(const XMFLOAT4& color, float depth)
+	{
+		Draw draw = {};
+		draw.Clear = true;
+		draw.ClearColor = color;
+		draw.ClearDepth = depth;
+		mDraws.push_back(draw);
+	}
+
+	void SoftwareRasterizer::SetState(const RenderDevice::StateDescription& state)
+	{
+		mState = state;
+	}
+
+	void SoftwareRasterizer::DrawIndexedInstanced(const SoftwareShader& shader, const void* vertices, uint32_t vertexStride, uint32_t vertexCount,
+		const uint32_t* indices, uint32_t indexCount, uint32_t instanceCount, uint32_t startInstance)
+	{
+		if (shader.VaryingCount() > SoftwareVertex::MaxVaryings)
+		{
+			throw GameException("A software shader writes more values than a software vertex holds.");
+		}
+
+		if (indexCount < 3 || instanceCount == 0)
+		{
+			return;
+		}
+
+		Draw draw = {};
+		draw.Shader = &shader;
+		draw.Vertices = static_cast<const uint8_t*>(vertices);
+		draw.VertexStride = vertexStride;
+		draw.VertexCount = vertexCount;
+		draw.Indices = indices;
+		draw.IndexCount = indexCount - indexCount % 3;
+		draw.InstanceCount = instanceCount;
+		draw.StartInstance = startInstance;
+		draw.State = mState;
+		mDraws.push_back(draw);
+	}
+
+	void SoftwareRasterizer::Execute()
+	{
+		mStatistics = Statistics();
+		if (mDraws.empty())
+		{
+			return;
+		}
+
+		// Every instance of every draw in turn, each weighed by its triangles, and the clears weighing one
+		mItems.clear();
+		uint64_t totalWeight = 0;
+		for (uint32_t drawIndex = 0; drawIndex < mDraws.size(); ++drawIndex)
+		{
+			const Draw& draw = mDraws[drawIndex];
+			uint32_t instanceCount = (draw.Clear ? 1 : draw.InstanceCount);
+			for (uint32_t instance = 0; instance < instanceCount; ++instance)
+			{
+				mItems.push_back({ drawIndex, instance });
+			}
+
+			totalWeight += (draw.Clear ? 1 : static_cast<uint64_t>(draw.IndexCount / 3) * draw.InstanceCount);
+		}
+
+		mRunCount = static_cast<uint32_t>(min<size_t>(mThreadPool->ThreadCount() * RunsPerThread, mItems.size()));
+		if (mRuns.size() < mRunCount)
+		{
+			mRuns.resize(mRunCount);
+		}
+
+		// Runs take consecutive items, each ending where the weight so far passes its share
+		uint32_t item = 0;
+		uint64_t weight = 0;
+		for (uint32_t runIndex = 0; runIndex < mRunCount; ++runIndex)
+		{
+			Run& run = mRuns[runIndex];
+			run.FirstItem = item;
+			uint64_t endWeight = totalWeight * (runIndex + 1) / mRunCount;
+			while (item < mItems.size() && (weight < endWeight || runIndex + 1 == mRunCount))
+			{
+				const Draw& draw = mDraws[mItems[item].DrawIndex];
+				weight += (draw.Clear ? 1 : draw.IndexCount / 3);
+				++item;
+			}
+
+			run.EndItem = item;
+		}
+
+		mThreadPool->ParallelFor(mRunCount, 1, [this](uint32_t first, uint32_t last)
+		{
+			for (uint32_t runIndex = first; runIndex < last; ++runIndex)
+			{
+				SetUpRun(mRuns[runIndex]);
+			}
+		});
+
+		uint32_t tileCount = mTilesX * mTilesY;
+		vector<uint64_t> fragments(tileCount, 0);
+		mThreadPool->ParallelFor(tileCount, 1, [this, &fragments](uint32_t first, uint32_t last)
+		{
+			for (uint32_t tile = first; tile < last; ++tile)
+			{
+				fragments[tile] = RasterizeTile(tile);
+			}
+		});
+
+		for (uint32_t runIndex = 0; runIndex < mRunCount; ++runIndex)
+		{
+			const Run& run = mRuns[runIndex];
+			mStatistics.Triangles += run.SubmittedTriangles;
+			mStatistics.RasterizedTriangles += run.Triangles.size();
+			mStatistics.BinnedTriangles += run.BinnedTriangles;
+		}
+
+		for (uint64_t tileFragments : fragments)
+		{
+			mStatistics.Fragments += tileFragments;
+		}
+
+		mDraws.clear();
+	}
+
+	const SoftwareRasterizer::Statistics& SoftwareRasterizer::LastStatistics() const
+	{
+		return mStatistics;
+	}
+
+	void SoftwareRasterizer::ReadPixels(DecodedImage& image) const
+	{
+		image.Width = mWidth;
+		image.Height = mHeight;
+		image.Pixels.resize(mWidth * mHeight * sizeof(uint32_t));
+
+		for (uint32_t y = 0; y < mHeight; ++y)
+		{
+			uint8_t* row = &image.Pixels[y * mWidth * sizeof(uint32_t)];
+			for (uint32_t tileX = 0; tileX < mTilesX; ++tileX)
+			{
+				uint32_t tile = (y / TileSize) * mTilesX + tileX;
+				uint32_t x = tileX * TileSize;
+				uint32_t width = min(mWidth - x, static_cast<uint32_t>(TileSize));
+				memcpy(row + x * sizeof(uint32_t), &mColors[(tile * TileSize + y % TileSize) * TileSize], width * sizeof(uint32_t));
+			}
+		}
+	}
+
+	void SoftwareRasterizer::SetUpRun(Run& run)
+	{
+		uint32_t tileCount = mTilesX * mTilesY;
+		run.Bins.resize(tileCount);
+		for (vector<uint32_t>& bin : run.Bins)
+		{
+			bin.clear();
+		}
+
+		run.Vertices.clear();
+		run.Triangles.clear();
+		run.SubmittedTriangles = 0;
+		run.BinnedTriangles = 0;
+
+		for (uint32_t item = run.FirstItem; item < run.EndItem; ++item)
+		{
+			uint32_t drawIndex = mItems[item].DrawIndex;
+			if (mDraws[drawIndex].Clear)
+			{
+				for (vector<uint32_t>& bin : run.Bins)
+				{
+					bin.push_back(drawIndex | ClearFlag);
+				}
+			}
+			else
+			{
+				SetUpInstance(run, drawIndex, mItems[item].Instance);
+			}
+		}
+	}
+
+	void SoftwareRasterizer::SetUpInstance(Run& run, uint32_t drawIndex, uint32_t instance)
+	{
+		const Draw& draw = mDraws[drawIndex];
+		uint32_t shaderInstance = draw.StartInstance + instance;
+
+		run.ShadedVertices.resize(draw.VertexCount);
+		run.ScreenVertices.resize(draw.VertexCount);
+		run.OutCodes.resize(draw.VertexCount);
+		run.VertexMap.assign(draw.VertexCount, Unmapped);
+
+		for (uint32_t vertex = 0; vertex < draw.VertexCount; ++vertex)
+		{
+			SoftwareVertex& shaded = run.ShadedVertices[vertex];
+			draw.Shader->ShadeVertex(draw.Vertices + vertex * draw.VertexStride, shaderInstance, shaded);
+			run.OutCodes[vertex] = OutCode(shaded.Position);
+			if ((run.OutCodes[vertex] & (OutsideNear | OutsideFar)) == 0)
+			{
+				run.ScreenVertices[vertex] = Project(shaded.Position);
+			}
+		}
+
+		run.SubmittedTriangles += draw.IndexCount / 3;
+		for (uint32_t index = 0; index < draw.IndexCount; index += 3)
+		{
+			uint32_t indices[3] = { draw.Indices[index], draw.Indices[index + 1], draw.Indices[index + 2] };
+			assert(indices[0] < draw.VertexCount && indices[1] < draw.VertexCount && indices[2] < draw.VertexCount);
+
+			// Triangles wholly outside one side of the clip volume are dropped, and only those crossing the near or far plane are clipped
+			uint32_t outsideAll = run.OutCodes[indices[0]] & run.OutCodes[indices[1]] & run.OutCodes[indices[2]];
+			uint32_t outsideAny = run.OutCodes[indices[0]] | run.OutCodes[indices[1]] | run.OutCodes[indices[2]];
+			if (outsideAll != 0)
+			{
+				continue;
+			}
+
+			if ((outsideAny & (OutsideNear | OutsideFar)) != 0)
+			{
+				const SoftwareVertex* vertices[3] = { &run.ShadedVertices[indices[0]], &run.ShadedVertices[indices[1]], &run.ShadedVertices[indices[2]] };
+				ClipTriangle(run, draw, drawIndex, shaderInstance, vertices);
+				continue;
+			}
+
+			const ScreenVertex* screenVertices[3] = { &run.ScreenVertices[indices[0]], &run.ScreenVertices[indices[1]], &run.ScreenVertices[indices[2]] };
+			Triangle triangle;
+			bool swapped;
+			if (SetUpTriangle(screenVertices, draw.State.Cull, triangle, swapped) == false)
+			{
+				continue;
+			}
+
+			if (swapped)
+			{
+				swap(indices[1], indices[2]);
+			}
+
+			// Only the vertices of triangles left to draw are kept, each once per instance
+			for (uint32_t corner = 0; corner < 3; ++corner)
+			{
+				uint32_t& mapped = run.VertexMap[indices[corner]];
+				if (mapped == Unmapped)
+				{
+					mapped = static_cast<uint32_t>(run.Vertices.size());
+					run.Vertices.push_back(run.ShadedVertices[indices[corner]]);
+				}
+
+				triangle.Vertices[corner] = mapped;
+			}
+
+			triangle.DrawIndex = drawIndex;
+			triangle.Instance = shaderInstance;
+			run.Triangles.push_back(triangle);
+			BinTriangle(run, triangle);
+		}
+	}
+
+	void SoftwareRasterizer::ClipTriangle(Run& run, const Draw& draw, uint32_t drawIndex, uint32_t instance, const SoftwareVertex* (&vertices)[3])
+	{
+		// Each plane adds at most one vertex to the polygon, from a triangle to a pentagon
+		SoftwareVertex polygons[2][MaxClippedVertices];
+		uint32_t counts[2] = { 3, 0 };
+		for (uint32_t corner = 0; corner < 3; ++corner)
+		{
+			polygons[0][corner] = *vertices[corner];
+		}
+
+		uint32_t varyingCount = draw.Shader->VaryingCount();
+		uint32_t source = 0;
+		for (uint32_t plane = 0; plane < 2; ++plane)
+		{
+			const SoftwareVertex* input = polygons[source];
+			SoftwareVertex* output = polygons[1 - source];
+			uint32_t outputCount = 0;
+			for (uint32_t i = 0; i < counts[source]; ++i)
+			{
+				const SoftwareVertex& current = input[i];
+				const SoftwareVertex& next = input[(i + 1) % counts[source]];
+				float currentDistance = (plane == 0 ? current.Position.z : current.Position.w - current.Position.z);
+				float nextDistance = (plane == 0 ? next.Position.z : next.Position.w - next.Position.z);
+
+				if (currentDistance >= 0.0f)
+				{
+					output[outputCount++] = current;
+				}
+
+				if ((currentDistance >= 0.0f) != (nextDistance >= 0.0f))
+				{
+					// Interpolate from the inside vertex, so the triangles on both sides of an edge make the same vertex
+					const SoftwareVertex& inside = (currentDistance >= 0.0f ? current : next);
+					const SoftwareVertex& outside = (currentDistance >= 0.0f ? next : current);
+					float insideDistance = (currentDistance >= 0.0f ? currentDistance : nextDistance);
+					float outsideDistance = (currentDistance >= 0.0f ? nextDistance : currentDistance);
+					float amount = insideDistance / (insideDistance - outsideDistance);
+
+					SoftwareVertex& clipped = output[outputCount++];
+					clipped.Position.x = inside.Position.x + (outside.Position.x - inside.Position.x) * amount;
+					clipped.Position.y = inside.Position.y + (outside.Position.y - inside.Position.y) * amount;
+					clipped.Position.z = inside.Position.z + (outside.Position.z - inside.Position.z) * amount;
+					clipped.Position.w = inside.Position.w + (outside.Position.w - inside.Position.w) * amount;
+					for (uint32_t varying = 0; varying < varyingCount; ++varying)
+					{
+						clipped.Varyings[varying] = inside.Varyings[varying] + (outside.Varyings[varying] - inside.Varyings[varying]) * amount;
+					}
+				}
+			}
+
+			counts[1 - source] = outputCount;
+			source = 1 - source;
+		}
+
+		uint32_t count = counts[source];
+		if (count < 3)
+		{
+			return;
+		}
+
+		const SoftwareVertex* polygon = polygons[source];
+		ScreenVertex screenVertices[MaxClippedVertices];
+		uint32_t mapped[MaxClippedVertices];
+		for (uint32_t i = 0; i < count; ++i)
+		{
+			screenVertices[i] = Project(polygon[i].Position);
+			mapped[i] = Unmapped;
+		}
+
+		// The polygon is convex, so it is drawn as a fan around its first vertex
+		for (uint32_t i = 1; i + 1 < count; ++i)
+		{
+			uint32_t corners[3] = { 0, i, i + 1 };
+			const ScreenVertex* fanVertices[3] = { &screenVertices[0], &screenVertices[i], &screenVertices[i + 1] };
+			Triangle triangle;
+			bool swapped;
+			if (SetUpTriangle(fanVertices, draw.State.Cull, triangle, swapped) == false)
+			{
+				continue;
+			}
+
+			if (swapped)
+			{
+				swap(corners[1], corners[2]);
+			}
+
+			for (uint32_t corner = 0; corner < 3; ++corner)
+			{
+				if (mapped[corners[corner]] == Unmapped)
+				{
+					mapped[corners[corner]] = static_cast<uint32_t>(run.Vertices.size());
+					run.Vertices.push_back(polygon[corners[corner]]);
+				}
+
+				triangle.Vertices[corner] = mapped[corners[corner]];
+			}
+
+			triangle.DrawIndex = drawIndex;
+			triangle.Instance = instance;
+			run.Triangles.push_back(triangle);
+			BinTriangle(run, triangle);
+		}
+	}
+
+	bool SoftwareRasterizer::SetUpTriangle(const ScreenVertex* (&vertices)[3], RenderDevice::CullMode cull, Triangle& triangle, bool& swapped) const
+	{
+		// With y down the screen, clockwise triangles have a positive area
+		float area = (vertices[1]->X - vertices[0]->X) * (vertices[2]->Y - vertices[0]->Y) - (vertices[2]->X - vertices[0]->X) * (vertices[1]->Y - vertices[0]->Y);
+		if ((area > 0.0f || area < 0.0f) == false)
+		{
+			return false;
+		}
+
+		if ((cull == RenderDevice::CullMode::Back && area < 0.0f) || (cull == RenderDevice::CullMode::Front && area > 0.0f))
+		{
+			return false;
+		}
+
+		// Triangles facing away are turned around, so every triangle is inside where its edge functions are positive
+		swapped = (area < 0.0f);
+		const ScreenVertex* v[3] = { vertices[0], (swapped ? vertices[2] : vertices[1]), (swapped ? vertices[1] : vertices[2]) };
+		area = fabs(area);
+
+		// The pixels whose centres lie within the bounds of the triangle and the target
+		float minX = max(min(min(v[0]->X, v[1]->X), v[2]->X), 0.0f);
+		float minY = max(min(min(v[0]->Y, v[1]->Y), v[2]->Y), 0.0f);
+		float maxX = min(max(max(v[0]->X, v[1]->X), v[2]->X), static_cast<float>(mWidth));
+		float maxY = min(max(max(v[0]->Y, v[1]->Y), v[2]->Y), static_cast<float>(mHeight));
+		triangle.MinX = max(static_cast<int32_t>(ceil(minX - 0.5f)), 0);
+		triangle.MinY = max(static_cast<int32_t>(ceil(minY - 0.5f)), 0);
+		triangle.MaxX = min(static_cast<int32_t>(floor(maxX - 0.5f)), static_cast<int32_t>(mWidth) - 1);
+		triangle.MaxY = min(static_cast<int32_t>(floor(maxY - 0.5f)), static_cast<int32_t>(mHeight) - 1);
+		if (triangle.MinX > triangle.MaxX || triangle.MinY > triangle.MaxY)
+		{
+			return false;
+		}
+
+		triangle.TopLeftEdges = 0;
+		for (uint32_t edge = 0; edge < 3; ++edge)
+		{
+			// The edge from the next vertex to the one after, computed from its lower end so a neighbour sharing it gets exactly the negation
+			const ScreenVertex* from = v[(edge + 1) % 3];
+			const ScreenVertex* to = v[(edge + 2) % 3];
+			bool reversed = (to->X < from->X || (to->X == from->X && to->Y < from->Y));
+			const ScreenVertex* lower = (reversed ? to : from);
+			const ScreenVertex* upper = (reversed ? from : to);
+
+			float a = lower->Y - upper->Y;
+			float b = upper->X - lower->X;
+			float c = -(a * lower->X + b * lower->Y);
+			if (reversed)
+			{
+				a = -a;
+				b = -b;
+				c = -c;
+			}
+
+			triangle.EdgeA[edge] = a;
+			triangle.EdgeB[edge] = b;
+			triangle.EdgeC[edge] = c;
+
+			// A top edge runs right along the top of a clockwise triangle, and a left edge runs up its left side
+			if (a > 0.0f || (a == 0.0f && b > 0.0f))
+			{
+				triangle.TopLeftEdges |= (1 << edge);
+			}
+		}
+
+		triangle.InverseArea = 1.0f / area;
+		triangle.DepthA = (v[0]->Z * triangle.EdgeA[0] + v[1]->Z * triangle.EdgeA[1] + v[2]->Z * triangle.EdgeA[2]) * triangle.InverseArea;
+		triangle.DepthB = (v[0]->Z * triangle.EdgeB[0] + v[1]->Z * triangle.EdgeB[1] + v[2]->Z * triangle.EdgeB[2]) * triangle.InverseArea;
+		triangle.DepthC = (v[0]->Z * triangle.EdgeC[0] + v[1]->Z * triangle.EdgeC[1] + v[2]->Z * triangle.EdgeC[2]) * triangle.InverseArea;
+		for (uint32_t corner = 0; corner < 3; ++corner)
+		{
+			triangle.InverseW[corner] = v[corner]->InverseW;
+		}
+
+		return true;
+	}
+
+	void SoftwareRasterizer::BinTriangle(Run& run, const Triangle& triangle)
+	{
+		uint32_t index = static_cast<uint32_t>(run.Triangles.size() - 1);
+		uint32_t firstTileX = triangle.MinX / TileSize;
+		uint32_t firstTileY = triangle.MinY / TileSize;
+		uint32_t lastTileX = triangle.MaxX / TileSize;
+		uint32_t lastTileY = triangle.MaxY / TileSize;
+		bool singleTile = (firstTileX == lastTileX && firstTileY == lastTileY);
+
+		for (uint32_t tileY = firstTileY; tileY <= lastTileY; ++tileY)
+		{
+			for (uint32_t tileX = firstTileX; tileX <= lastTileX; ++tileX)
+			{
+				if (singleTile == false)
+				{
+					// Skip the tiles within the bounds wholly outside an edge, judged at the pixel centre of the tile furthest inside it
+					float left = static_cast<float>(tileX * TileSize) + 0.5f;
+					float top = static_cast<float>(tileY * TileSize) + 0.5f;
+					float right = left + static_cast<float>(TileSize - 1);
+					float bottom = top + static_cast<float>(TileSize - 1);
+
+					bool outside = false;
+					for (uint32_t edge = 0; edge < 3 && outside == false; ++edge)
+					{
+						float x = (triangle.EdgeA[edge] > 0.0f ? right : left);
+						float y = (triangle.EdgeB[edge] > 0.0f ? bottom : top);
+						outside = (triangle.EdgeA[edge] * x + triangle.EdgeB[edge] * y + triangle.EdgeC[edge] < 0.0f);
+					}
+
+					if (outside)
+					{
+						continue;
+					}
+				}
+
+				run.Bins[tileY * mTilesX + tileX].push_back(index);
+				++run.BinnedTriangles;
+			}
+		}
+	}
+
+	uint64_t SoftwareRasterizer::RasterizeTile(uint32_t tile)
+	{
+		uint32_t tileX = tile % mTilesX;
+		uint32_t tileY = tile / mTilesX;
+		uint32_t* colors = &mColors[tile * TileSize * TileSize];
+		float* depths = &mDepths[tile * TileSize * TileSize];
+
+		uint64_t fragments = 0;
+		for (uint32_t runIndex = 0; runIndex < mRunCount; ++runIndex)
+		{
+			const Run& run = mRuns[runIndex];
+			for (uint32_t entry : run.Bins[tile])
+			{
+				if ((entry & ClearFlag) != 0)
+				{
+					const Draw& draw = mDraws[entry & ~ClearFlag];
+					fill(colors, colors + TileSize * TileSize, PackColor(draw.ClearColor));
+					fill(depths, depths + TileSize * TileSize, draw.ClearDepth);
+				}
+				else
+				{
+					fragments += RasterizeTriangle(run, run.Triangles[entry], tileX, tileY, colors, depths);
+				}
+			}
+		}
+
+		return fragments;
+	}
+
+	uint64_t SoftwareRasterizer::RasterizeTriangle(const Run& run, const Triangle& triangle, uint32_t tileX, uint32_t tileY, uint32_t* colors, float* depths) const
+	{
+		const Draw& draw = mDraws[triangle.DrawIndex];
+		const SoftwareShader& shader = *draw.Shader;
+		uint32_t varyingCount = shader.VaryingCount();
+
+		int32_t originX = static_cast<int32_t>(tileX * TileSize);
+		int32_t originY = static_cast<int32_t>(tileY * TileSize);
+		int32_t minX = max(triangle.MinX, originX);
+		int32_t minY = max(triangle.MinY, originY);
+		int32_t maxX = min(triangle.MaxX, originX + static_cast<int32_t>(TileSize) - 1);
+		int32_t maxY = min(triangle.MaxY, originY + static_cast<int32_t>(TileSize) - 1);
+
+		bool depthTest = (draw.State.Depth != RenderDevice::DepthMode::Disabled);
+		bool depthWrite = (draw.State.Depth == RenderDevice::DepthMode::ReadWrite);
+
+		XMVECTOR edgeA[3];
+		XMVECTOR topLeft[3];
+		SoftwareFragment fragment;
+		fragment.Instance = triangle.Instance;
+		for (uint32_t corner = 0; corner < 3; ++corner)
+		{
+			edgeA[corner] = XMVectorReplicate(triangle.EdgeA[corner]);
+			topLeft[corner] = ((triangle.TopLeftEdges & (1 << corner)) != 0 ? XMVectorTrueInt() : XMVectorZero());
+			fragment.mVertexVaryings[corner] = run.Vertices[triangle.Vertices[corner]].Varyings;
+			fragment.mWeightDdx[corner] = triangle.EdgeA[corner] * triangle.InverseArea * triangle.InverseW[corner];
+			fragment.mWeightDdy[corner] = triangle.EdgeB[corner] * triangle.InverseArea * triangle.InverseW[corner];
+		}
+
+		const XMVECTOR laneOffsets = XMVectorSet(0.5f, 1.5f, 2.5f, 3.5f);
+		const XMVECTOR depthA = XMVectorReplicate(triangle.DepthA);
+		const XMVECTOR columnsBegin = XMVectorReplicate(static_cast<float>(minX));
+		const XMVECTOR columnsEnd = XMVectorReplicate(static_cast<float>(maxX + 1));
+		const XMVECTOR zero = XMVectorZero();
+
+		uint64_t fragments = 0;
+		int32_t firstGroup = minX & ~static_cast<int32_t>(LaneCount - 1);
+		for (int32_t y = minY; y <= maxY; ++y)
+		{
+			float centerY = static_cast<float>(y) + 0.5f;
+			XMVECTOR rowEdges[3];
+			for (uint32_t corner = 0; corner < 3; ++corner)
+			{
+				rowEdges[corner] = XMVectorReplicate(triangle.EdgeB[corner] * centerY + triangle.EdgeC[corner]);
+			}
+
+			XMVECTOR rowDepth = XMVectorReplicate(triangle.DepthB * centerY + triangle.DepthC);
+			uint32_t rowOffset = static_cast<uint32_t>(y - originY) * TileSize;
+
+			for (int32_t x = firstGroup; x <= maxX; x += LaneCount)
+			{
+				XMVECTOR centersX = XMVectorAdd(XMVectorReplicate(static_cast<float>(x)), laneOffsets);
+				XMVECTOR covered = XMVectorAndInt(XMVectorGreater(centersX, columnsBegin), XMVectorLess(centersX, columnsEnd));
+
+				// A pixel is inside when every edge function is positive, or zero on an edge the top-left rule includes
+				XMVECTOR edges[3];
+				for (uint32_t corner = 0; corner < 3; ++corner)
+				{
+					edges[corner] = XMVectorMultiplyAdd(centersX, edgeA[corner], rowEdges[corner]);
+					XMVECTOR inside = XMVectorOrInt(XMVectorGreater(edges[corner], zero), XMVectorAndInt(XMVectorGreaterOrEqual(edges[corner], zero), topLeft[corner]));
+					covered = XMVectorAndInt(covered, inside);
+				}
+
+				uint32_t record;
+				XMVectorEqualIntR(&record, covered, zero);
+				if (XMComparisonAllTrue(record))
+				{
+					continue;
+				}
+
+				uint32_t offset = rowOffset + static_cast<uint32_t>(x - originX);
+				if (depthTest)
+				{
+					XMVECTOR depth = XMVectorMultiplyAdd(centersX, depthA, rowDepth);
+					XMVECTOR stored = XMLoadFloat4(reinterpret_cast<const XMFLOAT4*>(depths + offset));
+					covered = XMVectorAndInt(covered, XMVectorLess(depth, stored));
+					if (depthWrite)
+					{
+						XMStoreFloat4(reinterpret_cast<XMFLOAT4*>(depths + offset), XMVectorSelect(stored, depth, covered));
+					}
+				}
+
+				uint32_t mask = LaneMask(covered);
+				if (mask == 0)
+				{
+					continue;
+				}
+
+				XMFLOAT4 edgeValues[3];
+				for (uint32_t corner = 0; corner < 3; ++corner)
+				{
+					XMStoreFloat4(&edgeValues[corner], edges[corner]);
+				}
+
+				for (uint32_t lane = 0; lane < LaneCount; ++lane)
+				{
+					if ((mask & (1U << lane)) == 0)
+					{
+						continue;
+					}
+
+					// Interpolate with perspective: the weights are the barycentric coordinates divided by w, normalized by their sum
+					const float* laneEdges[3] = { &edgeValues[0].x, &edgeValues[1].x, &edgeValues[2].x };
+					float weightSum = 0.0f;
+					for (uint32_t corner = 0; corner < 3; ++corner)
+					{
+						fragment.mWeights[corner] = laneEdges[corner][lane] * triangle.InverseArea * triangle.InverseW[corner];
+						weightSum += fragment.mWeights[corner];
+					}
+
+					fragment.mInverseWeightSum = 1.0f / weightSum;
+					float weights[3] = { fragment.mWeights[0] * fragment.mInverseWeightSum, fragment.mWeights[1] * fragment.mInverseWeightSum, fragment.mWeights[2] * fragment.mInverseWeightSum };
+					for (uint32_t varying = 0; varying < varyingCount; ++varying)
+					{
+						fragment.Varyings[varying] = weights[0] * fragment.mVertexVaryings[0][varying] + weights[1] * fragment.mVertexVaryings[1][varying] + weights[2] * fragment.mVertexVaryings[2][varying];
+					}
+
+					fragment.X = static_cast<uint32_t>(x) + lane;
+					fragment.Y = static_cast<uint32_t>(y);
+					XMFLOAT4 color = shader.ShadePixel(fragment);
+					uint32_t& target = colors[offset + lane];
+
+					// The blend states of Direct3D path, which leave zero in the alpha of the target when blending
+					switch (draw.State.Blend)
+					{
+					case RenderDevice::BlendMode::AlphaBlending:
+					{
+						float sourceAlpha = min(max(color.w, 0.0f), 1.0f);
+						float inverseAlpha = (1.0f - sourceAlpha) / 255.0f;
+						target = PackColor(XMFLOAT4(color.x * sourceAlpha + static_cast<float>(target & 0xFF) * inverseAlpha, color.y * sourceAlpha + static_cast<float>((target >> 8) & 0xFF) * inverseAlpha,
+							color.z * sourceAlpha + static_cast<float>((target >> 16) & 0xFF) * inverseAlpha, 0.0f));
+						break;
+					}
+
+					case RenderDevice::BlendMode::MultiplicativeBlending:
+						target = PackColor(XMFLOAT4(color.x * static_cast<float>(target & 0xFF) / 255.0f, color.y * static_cast<float>((target >> 8) & 0xFF) / 255.0f,
+							color.z * static_cast<float>((target >> 16) & 0xFF) / 255.0f, 0.0f));
+						break;
+
+					default:
+						target = PackColor(color);
+						break;
+					}
+
+					++fragments;
+				}
+			}
+		}
+
+		return fragments;
+	}
+
+	SoftwareRasterizer::ScreenVertex SoftwareRasterizer::Project(const XMFLOAT4& position) const
+	{
+		ScreenVertex vertex;
+		vertex.InverseW = 1.0f / position.w;
+		vertex.X = (position.x * vertex.InverseW * 0.5f + 0.5f) * static_cast<float>(mWidth);
+		vertex.Y = (0.5f - position.y * vertex.InverseW * 0.5f) * static_cast<float>(mHeight);
+		vertex.Z = position.z * vertex.InverseW;
+
+		return vertex;
+	}
+
+	uint32_t SoftwareRasterizer::OutCode(const XMFLOAT4& position)
+	{
+		uint32_t code = 0;
+		code |= (position.x < -position.w ? OutsideLeft : 0);
+		code |= (position.x > position.w ? OutsideRight : 0);
+		code |= (position.y < -position.w ? OutsideBottom : 0);
+		code |= (position.y > position.w ? OutsideTop : 0);
+		code |= (position.z < 0.0f ? OutsideNear : 0);
+		code |= (position.z > position.w ? OutsideFar : 0);
+
+		return code;
+	}
+
+	uint32_t SoftwareRasterizer::PackColor(const XMFLOAT4& color)
+	{
+		auto channel = [](float value)
+		{
+			return static_cast<uint32_t>(min(max(value, 0.0f), 1.0f) * 255.0f + 0.5f);
+		};
+
+		return channel(color.x) | (channel(color.y) << 8) | (channel(color.z) << 16) | (channel(color.w) << 24);
+	}
+}
\ No newline at end of file
@@ -0,0 +1,257 @@
+#pragma once
+
+#include "RenderDevice.h"
+#include <vector>
+#include <cstdint>
+#include <DirectXMath.h>
+
+namespace Library
+{
+	class ThreadPool;
+	struct DecodedImage;
+
+	/**
+	* A vertex as the vertex shader of the software rasterizer leaves it: its position in clip space, and the values
+	* interpolated across its triangles for the pixel shader.
+	*/
+	struct SoftwareVertex
+	{
+		static const std::uint32_t MaxVaryings = 12;
+
+		DirectX::XMFLOAT4 Position;
+		float Varyings[MaxVaryings];
+	};
+
+	/**
+	* A pixel covered by a triangle, with the values of the vertices interpolated to its centre with perspective.
+	*/
+	class SoftwareFragment final
+	{
+	public:
+		std::uint32_t X;
+		std::uint32_t Y;
+		std::uint32_t Instance;		// The instance of the draw the triangle belongs to
+		float Varyings[SoftwareVertex::MaxVaryings];
+
+		/**
+		* Get the change in an interpolated value from this pixel to the next to the right, as ddx() does in a pixel shader.
+		* The derivative is exact for the plane of the triangle rather than a difference across a block of pixels.
+		*/
+		float Ddx(std::uint32_t varying) const;
+		/**
+		* Get the change in an interpolated value from this pixel to the next below, as ddy() does in a pixel shader.
+		*/
+		float Ddy(std::uint32_t varying) const;
+
+	private:
+		friend class SoftwareRasterizer;
+
+		float Derivative(std::uint32_t varying, const float* weightDerivatives) const;
+
+		const float* mVertexVaryings[3];
+		float mWeights[3];				// The barycentric weights of the vertices divided by their w
+		float mInverseWeightSum;
+		float mWeightDdx[3];
+		float mWeightDdy[3];
+	};
+
+	/**
+	* The vertex and pixel shader of a software draw, written in C++ after the HLSL of the shaders the Direct3D path draws
+	* with. Both stages are called from the worker threads of the rasterizer at once and must only read shared state.
+	*/
+	class SoftwareShader
+	{
+	public:
+		virtual ~SoftwareShader() = default;
+
+		/**
+		* Get the number of values the vertex shader writes to SoftwareVertex::Varyings.
+		*/
+		virtual std::uint32_t VaryingCount() const = 0;
+		/**
+		* @param vertex The vertex in the vertex buffer of the draw.
+		* @param instance The instance being drawn, counted from the first instance of the draw.
+		*/
+		virtual void ShadeVertex(const void* vertex, std::uint32_t instance, SoftwareVertex& output) const = 0;
+		virtual DirectX::XMFLOAT4 ShadePixel(const SoftwareFragment& fragment) const = 0;
+	};
+
+	/**
+	* Draws triangles on the CPU, for rendering without a graphics device. The target is split into square tiles, each
+	* with its own color and depth, and a frame runs in two parallel passes over the thread pool:
+	*
+	* - The instances of the draws are divided into runs of about equal numbers of triangles. Each run shades the
+	*   vertices of its instances, clips their triangles to the near and far planes, culls those facing away or
+	*   covering no pixel centre, and lists the rest in a bin for every tile they touch.
+	* - Each tile then walks the bins of every run in order, so triangles are drawn in the order they were submitted
+	*   however the work was divided. Edge functions and the depth test are evaluated four pixels at a time, and the
+	*   pixel shader runs for each pixel passing the depth test, its color blended into the tile.
+	*
+	* Edges are set up the same way from either triangle sharing them and pixel centres on an edge follow the top-left
+	* rule of Direct3D, so meshes are drawn without gaps or overdraw along their edges, and the image does not depend
+	* on the number of threads. States follow the Direct3D states of the render device: clockwise triangles face the
+	* viewer, and depth passes when less than the depth already drawn.
+	*/
+	class SoftwareRasterizer final
+	{
+	public:
+		static const std::uint32_t TileSize = 64;
+
+		/**
+		* The work of the last frame drawn.
+		*/
+		struct Statistics
+		{
+			std::uint64_t Triangles;				// Every triangle of every instance submitted
+			std::uint64_t RasterizedTriangles;		// Those left after clipping and culling
+			std::uint64_t BinnedTriangles;			// Those counted once for every tile they were binned to
+			std::uint64_t Fragments;				// Pixels passing the depth test and shaded
+		};
+
+		SoftwareRasterizer(ThreadPool& threadPool, std::uint32_t width, std::uint32_t height);
+		SoftwareRasterizer(const SoftwareRasterizer&) = delete;
+		SoftwareRasterizer& operator=(const SoftwareRasterizer&) = delete;
+		SoftwareRasterizer(SoftwareRasterizer&&) = delete;
+		SoftwareRasterizer& operator=(SoftwareRasterizer&&) = delete;
+		~SoftwareRasterizer() = default;
+
+		std::uint32_t Width() const;
+		std::uint32_t Height() const;
+
+		/**
+		* Clear the color and depth before the draws queued after it.
+		*/
+		void Clear(const DirectX::XMFLOAT4& color, float depth = 1.0f);
+		/**
+		* Set the state the draws queued after it are drawn with. The default is opaque, with depth read and written and back faces culled.
+		*/
+		void SetState(const RenderDevice::StateDescription& state);
+		/**
+		* Queue instances of an indexed triangle list. The shader, vertices and indices must stay valid until Execute() returns.
+		* @param vertexStride The number of bytes from one vertex to the next.
+		* @param startInstance The instance the first is numbered from when given to the shader.
+		*/
+		void DrawIndexedInstanced(const SoftwareShader& shader, const void* vertices, std::uint32_t vertexStride, std::uint32_t vertexCount,
+			const std::uint32_t* indices, std::uint32_t indexCount, std::uint32_t instanceCount, std::uint32_t startInstance);
+
+		/**
+		* Draw everything queued since the last call, and wait for it.
+		*/
+		void Execute();
+		const Statistics& LastStatistics() const;
+
+		/**
+		* Copy the color of the target as an image of 8 bit RGBA pixels.
+		*/
+		void ReadPixels(DecodedImage& image) const;
+
+	private:
+		struct Draw
+		{
+			const SoftwareShader* Shader;
+			const std::uint8_t* Vertices;
+			std::uint32_t VertexStride;
+			std::uint32_t VertexCount;
+			const std::uint32_t* Indices;
+			std::uint32_t IndexCount;
+			std::uint32_t InstanceCount;
+			std::uint32_t StartInstance;
+			RenderDevice::StateDescription State;
+			bool Clear;						// A clear rather than a draw
+			DirectX::XMFLOAT4 ClearColor;
+			float ClearDepth;
+		};
+
+		/**
+		* A vertex after the perspective divide, in pixels with the origin at the top left of the target.
+		*/
+		struct ScreenVertex
+		{
+			float X;
+			float Y;
+			float Z;
+			float InverseW;
+		};
+
+		/**
+		* A triangle ready to rasterize. Each edge function is positive inside the triangle and its value at the opposite vertex is the area.
+		*/
+		struct Triangle
+		{
+			float EdgeA[3];
+			float EdgeB[3];
+			float EdgeC[3];
+			std::uint32_t TopLeftEdges;		// A bit for each edge on which pixel centres count as inside
+			float InverseArea;
+			float DepthA;					// The depth across the triangle, as a plane in x and y
+			float DepthB;
+			float DepthC;
+			float InverseW[3];
+			std::uint32_t Vertices[3];		// In the vertices of the run
+			std::int32_t MinX;
+			std::int32_t MinY;
+			std::int32_t MaxX;
+			std::int32_t MaxY;
+			std::uint32_t DrawIndex;
+			std::uint32_t Instance;
+		};
+
+		/**
+		* A run of instances set up by one task, and the triangles it binned to each tile.
+		*/
+		struct Run
+		{
+			std::uint32_t FirstItem;
+			std::uint32_t EndItem;
+			std::vector<SoftwareVertex> Vertices;
+			std::vector<Triangle> Triangles;
+			std::vector<std::vector<std::uint32_t>> Bins;		// Indices of triangles, or of clearing draws with ClearFlag set
+
+			// Scratch space for one instance at a time
+			std::vector<SoftwareVertex> ShadedVertices;
+			std::vector<ScreenVertex> ScreenVertices;
+			std::vector<std::uint32_t> OutCodes;
+			std::vector<std::uint32_t> VertexMap;
+
+			std::uint64_t SubmittedTriangles;
+			std::uint64_t BinnedTriangles;
+		};
+
+		static const std::uint32_t ClearFlag = 0x80000000;
+
+		/**
+		* An instance of a draw, or a clear, in the order submitted.
+		*/
+		struct Item
+		{
+			std::uint32_t DrawIndex;
+			std::uint32_t Instance;
+		};
+
+		void SetUpRun(Run& run);
+		void SetUpInstance(Run& run, std::uint32_t drawIndex, std::uint32_t instance);
+		void ClipTriangle(Run& run, const Draw& draw, std::uint32_t drawIndex, std::uint32_t instance, const SoftwareVertex* (&vertices)[3]);
+		bool SetUpTriangle(const ScreenVertex* (&vertices)[3], RenderDevice::CullMode cull, Triangle& triangle, bool& swapped) const;
+		void BinTriangle(Run& run, const Triangle& triangle);
+		std::uint64_t RasterizeTile(std::uint32_t tile);
+		std::uint64_t RasterizeTriangle(const Run& run, const Triangle& triangle, std::uint32_t tileX, std::uint32_t tileY, std::uint32_t* colors, float* depths) const;
+		ScreenVertex Project(const DirectX::XMFLOAT4& position) const;
+		static std::uint32_t OutCode(const DirectX::XMFLOAT4& position);
+		static std::uint32_t PackColor(const DirectX::XMFLOAT4& color);
+
+		ThreadPool* mThreadPool;
+		std::uint32_t mWidth;
+		std::uint32_t mHeight;
+		std::uint32_t mTilesX;
+		std::uint32_t mTilesY;
+		std::vector<std::uint32_t> mColors;		// Tile by tile, each TileSize pixels square row by row
+		std::vector<float> mDepths;
+
+		RenderDevice::StateDescription mState;
+		std::vector<Draw> mDraws;
+		std::vector<Item> mItems;
+		std::vector<Run> mRuns;
+		std::uint32_t mRunCount;
+		Statistics mStatistics;
+	};
+}
\ No newline at end of file
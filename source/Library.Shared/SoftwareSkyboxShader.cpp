@@ -0,0 +1,68 @@
+#include "pch.h"
+
+using namespace std;
+using namespace DirectX;
+
+namespace Library
+{
+	namespace
+	{
+		// The varyings written by the vertex shader
+		const uint32_t TextureCoordinateX = 0;
+		const uint32_t TextureCoordinateY = 1;
+		const uint32_t TextureCoordinateZ = 2;
+		const uint32_t ShaderVaryingCount = 3;
+	}
+
+	SoftwareSkyboxShader::SoftwareSkyboxShader() :
+		mWorldViewProjection(MatrixHelper::Identity), mSkyboxTexture(nullptr)
+	{
+	}
+
+	void SoftwareSkyboxShader::SetWorldViewProjection(const XMFLOAT4X4& worldViewProjection)
+	{
+		mWorldViewProjection = worldViewProjection;
+	}
+
+	void SoftwareSkyboxShader::SetSkyboxTexture(const SoftwareTexture& skyboxTexture)
+	{
+		if (skyboxTexture.ArraySize() != SoftwareTexture::CubeFaceCount)
+		{
+			throw GameException("The skybox texture must be a cube map.");
+		}
+
+		mSkyboxTexture = &skyboxTexture;
+	}
+
+	uint32_t SoftwareSkyboxShader::VaryingCount() const
+	{
+		return ShaderVaryingCount;
+	}
+
+	void SoftwareSkyboxShader::ShadeVertex(const void* vertex, uint32_t instance, SoftwareVertex& output) const
+	{
+		UNREFERENCED_PARAMETER(instance);
+
+		// The matrix is transposed, so each component of the product is a row dotted with the position
+		XMVECTOR position = XMLoadFloat4(static_cast<const XMFLOAT4*>(vertex));
+		XMMATRIX worldViewProjection = XMLoadFloat4x4(&mWorldViewProjection);
+		XMStoreFloat4(&output.Position, XMVectorSet(XMVectorGetX(XMVector4Dot(position, worldViewProjection.r[0])), XMVectorGetX(XMVector4Dot(position, worldViewProjection.r[1])),
+			XMVectorGetX(XMVector4Dot(position, worldViewProjection.r[2])), XMVectorGetX(XMVector4Dot(position, worldViewProjection.r[3]))));
+
+		const XMFLOAT4* objectPosition = static_cast<const XMFLOAT4*>(vertex);
+		output.Varyings[TextureCoordinateX] = objectPosition->x;
+		output.Varyings[TextureCoordinateY] = objectPosition->y;
+		output.Varyings[TextureCoordinateZ] = objectPosition->z;
+	}
+
+	XMFLOAT4 SoftwareSkyboxShader::ShadePixel(const SoftwareFragment& fragment) const
+	{
+		assert(mSkyboxTexture != nullptr);
+
+		XMFLOAT3 textureCoordinate(fragment.Varyings[TextureCoordinateX], fragment.Varyings[TextureCoordinateY], fragment.Varyings[TextureCoordinateZ]);
+		XMFLOAT3 ddx(fragment.Ddx(TextureCoordinateX), fragment.Ddx(TextureCoordinateY), fragment.Ddx(TextureCoordinateZ));
+		XMFLOAT3 ddy(fragment.Ddy(TextureCoordinateX), fragment.Ddy(TextureCoordinateY), fragment.Ddy(TextureCoordinateZ));
+
+		return mSkyboxTexture->SampleCubeGrad(RenderDevice::SamplerType::TrilinearClamp, textureCoordinate, ddx, ddy);
+	}
+}
\ No newline at end of file
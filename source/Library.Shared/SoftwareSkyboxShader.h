@@ -0,0 +1,42 @@
+#pragma once
+
+#include "SoftwareRasterizer.h"
+#include <DirectXMath.h>
+
+namespace Library
+{
+	class SoftwareTexture;
+
+	/**
+	* The skybox shaders for the software rasterizer, following SkyboxVS.hlsl and SkyboxPS.hlsl: the cube around the
+	* camera is sampled from the cube map in the direction of each pixel. Vertices begin with the position of the
+	* cube corner, as in the vertex buffer the skybox draws with.
+	*/
+	class SoftwareSkyboxShader final : public SoftwareShader
+	{
+	public:
+		SoftwareSkyboxShader();
+		SoftwareSkyboxShader(const SoftwareSkyboxShader&) = delete;
+		SoftwareSkyboxShader& operator=(const SoftwareSkyboxShader&) = delete;
+		SoftwareSkyboxShader(SoftwareSkyboxShader&&) = delete;
+		SoftwareSkyboxShader& operator=(SoftwareSkyboxShader&&) = delete;
+		~SoftwareSkyboxShader() = default;
+
+		/**
+		* @param worldViewProjection Transposed, as written to the constant buffer of the skybox.
+		*/
+		void SetWorldViewProjection(const DirectX::XMFLOAT4X4& worldViewProjection);
+		/**
+		* Set the cube map, a texture of six slices. It must stay valid while the rasterizer draws with the shader.
+		*/
+		void SetSkyboxTexture(const SoftwareTexture& skyboxTexture);
+
+		virtual std::uint32_t VaryingCount() const override;
+		virtual void ShadeVertex(const void* vertex, std::uint32_t instance, SoftwareVertex& output) const override;
+		virtual DirectX::XMFLOAT4 ShadePixel(const SoftwareFragment& fragment) const override;
+
+	private:
+		DirectX::XMFLOAT4X4 mWorldViewProjection;
+		const SoftwareTexture* mSkyboxTexture;
+	};
+}
\ No newline at end of file
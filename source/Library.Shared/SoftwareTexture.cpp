@@ -0,0 +1,229 @@
+#include "pch.h"
+
+using namespace std;
+using namespace DirectX;
+
+namespace Library
+{
+	namespace
+	{
+		const float InverseByteMax = 1.0f / 255.0f;
+
+		XMFLOAT4 UnpackTexel(uint32_t texel)
+		{
+			return XMFLOAT4(static_cast<float>(texel & 0xFF) * InverseByteMax, static_cast<float>((texel >> 8) & 0xFF) * InverseByteMax,
+				static_cast<float>((texel >> 16) & 0xFF) * InverseByteMax, static_cast<float>(texel >> 24) * InverseByteMax);
+		}
+
+		XMFLOAT4 Lerp(const XMFLOAT4& from, const XMFLOAT4& to, float amount)
+		{
+			return XMFLOAT4(from.x + (to.x - from.x) * amount, from.y + (to.y - from.y) * amount, from.z + (to.z - from.z) * amount, from.w + (to.w - from.w) * amount);
+		}
+
+		int32_t AddressTexel(int32_t texel, int32_t size, bool wrap)
+		{
+			if (wrap)
+			{
+				texel %= size;
+				return (texel < 0 ? texel + size : texel);
+			}
+
+			return min(max(texel, 0), size - 1);
+		}
+	}
+
+	SoftwareTexture::SoftwareTexture(const RenderDevice::TextureDescription& description, const RenderDevice::SubresourceData* subresources) :
+		mWidth(description.Width), mHeight(description.Height), mMipLevels(description.MipLevels), mArraySize(description.ArraySize)
+	{
+		if (mWidth == 0 || mHeight == 0 || mMipLevels == 0 || mArraySize == 0)
+		{
+			throw GameException("A software texture must have at least one texel, mip level and slice.");
+		}
+
+		assert(subresources != nullptr);
+
+		mLevels.resize(mArraySize * mMipLevels);
+		for (uint32_t slice = 0; slice < mArraySize; ++slice)
+		{
+			for (uint32_t mip = 0; mip < mMipLevels; ++mip)
+			{
+				const RenderDevice::SubresourceData& source = subresources[slice * mMipLevels + mip];
+				Level& level = mLevels[slice * mMipLevels + mip];
+				level.Width = max(mWidth >> mip, 1U);
+				level.Height = max(mHeight >> mip, 1U);
+				level.Texels.resize(level.Width * level.Height);
+
+				const uint8_t* row = static_cast<const uint8_t*>(source.Data);
+				for (uint32_t y = 0; y < level.Height; ++y, row += source.RowPitch)
+				{
+					memcpy(&level.Texels[y * level.Width], row, level.Width * sizeof(uint32_t));
+				}
+			}
+		}
+	}
+
+	uint32_t SoftwareTexture::Width() const
+	{
+		return mWidth;
+	}
+
+	uint32_t SoftwareTexture::Height() const
+	{
+		return mHeight;
+	}
+
+	uint32_t SoftwareTexture::MipLevels() const
+	{
+		return mMipLevels;
+	}
+
+	uint32_t SoftwareTexture::ArraySize() const
+	{
+		return mArraySize;
+	}
+
+	XMFLOAT4 SoftwareTexture::SampleGrad(RenderDevice::SamplerType sampler, const XMFLOAT2& textureCoordinate, uint32_t slice, const XMFLOAT2& ddx, const XMFLOAT2& ddy) const
+	{
+		// The level whose texels are about a pixel apart along the longer axis of the footprint of the pixel
+		float width = static_cast<float>(mWidth);
+		float height = static_cast<float>(mHeight);
+		float lengthX = (ddx.x * width) * (ddx.x * width) + (ddx.y * height) * (ddx.y * height);
+		float lengthY = (ddy.x * width) * (ddy.x * width) + (ddy.y * height) * (ddy.y * height);
+		float levelOfDetail = 0.5f * log2(max(max(lengthX, lengthY), 1e-12f));
+
+		return SampleLevel(sampler, textureCoordinate.x, textureCoordinate.y, min(slice, mArraySize - 1), levelOfDetail);
+	}
+
+	XMFLOAT4 SoftwareTexture::SampleCubeGrad(RenderDevice::SamplerType sampler, const XMFLOAT3& direction, const XMFLOAT3& ddx, const XMFLOAT3& ddy) const
+	{
+		assert(mArraySize == CubeFaceCount);
+
+		// The face is that of the axis the direction points along the most, with the other two axes across it
+		float absoluteX = fabs(direction.x);
+		float absoluteY = fabs(direction.y);
+		float absoluteZ = fabs(direction.z);
+
+		uint32_t face;
+		float major;
+		float s;
+		float t;
+		float majorDdx;
+		float majorDdy;
+		float sDdx;
+		float sDdy;
+		float tDdx;
+		float tDdy;
+		if (absoluteX >= absoluteY && absoluteX >= absoluteZ)
+		{
+			float sign = (direction.x >= 0.0f ? 1.0f : -1.0f);
+			face = (direction.x >= 0.0f ? 0 : 1);
+			major = absoluteX;
+			majorDdx = sign * ddx.x;
+			majorDdy = sign * ddy.x;
+			s = -sign * direction.z;
+			sDdx = -sign * ddx.z;
+			sDdy = -sign * ddy.z;
+			t = -direction.y;
+			tDdx = -ddx.y;
+			tDdy = -ddy.y;
+		}
+		else if (absoluteY >= absoluteZ)
+		{
+			float sign = (direction.y >= 0.0f ? 1.0f : -1.0f);
+			face = (direction.y >= 0.0f ? 2 : 3);
+			major = absoluteY;
+			majorDdx = sign * ddx.y;
+			majorDdy = sign * ddy.y;
+			s = direction.x;
+			sDdx = ddx.x;
+			sDdy = ddy.x;
+			t = sign * direction.z;
+			tDdx = sign * ddx.z;
+			tDdy = sign * ddy.z;
+		}
+		else
+		{
+			float sign = (direction.z >= 0.0f ? 1.0f : -1.0f);
+			face = (direction.z >= 0.0f ? 4 : 5);
+			major = absoluteZ;
+			majorDdx = sign * ddx.z;
+			majorDdy = sign * ddy.z;
+			s = sign * direction.x;
+			sDdx = sign * ddx.x;
+			sDdy = sign * ddy.x;
+			t = -direction.y;
+			tDdx = -ddx.y;
+			tDdy = -ddy.y;
+		}
+
+		if (major <= 0.0f)
+		{
+			return XMFLOAT4(0.0f, 0.0f, 0.0f, 0.0f);
+		}
+
+		// The coordinates on the face are the other two axes divided by the major one, from -1 to 1
+		float inverseMajor = 1.0f / major;
+		float u = s * inverseMajor;
+		float v = t * inverseMajor;
+		XMFLOAT2 faceDdx(0.5f * (sDdx - u * majorDdx) * inverseMajor, 0.5f * (tDdx - v * majorDdx) * inverseMajor);
+		XMFLOAT2 faceDdy(0.5f * (sDdy - u * majorDdy) * inverseMajor, 0.5f * (tDdy - v * majorDdy) * inverseMajor);
+
+		return SampleGrad(sampler, XMFLOAT2(0.5f * (u + 1.0f), 0.5f * (v + 1.0f)), face, faceDdx, faceDdy);
+	}
+
+	XMFLOAT4 SoftwareTexture::SampleLevel(RenderDevice::SamplerType sampler, float u, float v, uint32_t slice, float levelOfDetail) const
+	{
+		const Level* levels = &mLevels[slice * mMipLevels];
+		float largestLevel = static_cast<float>(mMipLevels - 1);
+		levelOfDetail = min(max(levelOfDetail, 0.0f), largestLevel);
+
+		if (sampler == RenderDevice::SamplerType::PointClamp)
+		{
+			return SamplePoint(levels[static_cast<uint32_t>(levelOfDetail + 0.5f)], false, u, v);
+		}
+
+		bool wrap = (sampler == RenderDevice::SamplerType::TrilinearWrap);
+		uint32_t finer = static_cast<uint32_t>(levelOfDetail);
+		float blend = levelOfDetail - static_cast<float>(finer);
+		XMFLOAT4 color = SampleBilinear(levels[finer], wrap, u, v);
+		if (blend > 0.0f && finer + 1 < mMipLevels)
+		{
+			color = Lerp(color, SampleBilinear(levels[finer + 1], wrap, u, v), blend);
+		}
+
+		return color;
+	}
+
+	XMFLOAT4 SoftwareTexture::SampleBilinear(const Level& level, bool wrap, float u, float v) const
+	{
+		// Texel centres lie at half-integer coordinates
+		float x = u * static_cast<float>(level.Width) - 0.5f;
+		float y = v * static_cast<float>(level.Height) - 0.5f;
+		float left = floor(x);
+		float top = floor(y);
+		float blendX = x - left;
+		float blendY = y - top;
+
+		int32_t width = static_cast<int32_t>(level.Width);
+		int32_t height = static_cast<int32_t>(level.Height);
+		int32_t x0 = AddressTexel(static_cast<int32_t>(left), width, wrap);
+		int32_t x1 = AddressTexel(static_cast<int32_t>(left) + 1, width, wrap);
+		const uint32_t* row0 = &level.Texels[AddressTexel(static_cast<int32_t>(top), height, wrap) * width];
+		const uint32_t* row1 = &level.Texels[AddressTexel(static_cast<int32_t>(top) + 1, height, wrap) * width];
+
+		XMFLOAT4 upper = Lerp(UnpackTexel(row0[x0]), UnpackTexel(row0[x1]), blendX);
+		XMFLOAT4 lower = Lerp(UnpackTexel(row1[x0]), UnpackTexel(row1[x1]), blendX);
+
+		return Lerp(upper, lower, blendY);
+	}
+
+	XMFLOAT4 SoftwareTexture::SamplePoint(const Level& level, bool wrap, float u, float v) const
+	{
+		int32_t width = static_cast<int32_t>(level.Width);
+		int32_t height = static_cast<int32_t>(level.Height);
+		int32_t x = AddressTexel(static_cast<int32_t>(floor(u * static_cast<float>(width))), width, wrap);
+		int32_t y = AddressTexel(static_cast<int32_t>(floor(v * static_cast<float>(height))), height, wrap);
+
+		return UnpackTexel(level.Texels[y * width + x]);
+	}
+}
\ No newline at end of file
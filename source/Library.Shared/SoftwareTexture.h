@@ -0,0 +1,68 @@
+#pragma once
+
+#include "RenderDevice.h"
+#include <vector>
+#include <cstdint>
+#include <DirectXMath.h>
+
+namespace Library
+{
+	/**
+	* A texture of 8 bit RGBA pixels in system memory, sampled by the shaders of the software rasterizer as the pixel
+	* shaders sample theirs: filtered between texels and mip levels, with the level chosen from the derivatives of the
+	* texture coordinates the rasterizer gives each fragment. An array of six slices is a cube map, its faces in the
+	* order of Direct3D: +X, -X, +Y, -Y, +Z and -Z.
+	*/
+	class SoftwareTexture final
+	{
+	public:
+		/**
+		* @param subresources The mip levels of each slice of the texture in turn, as for RenderDevice::CreateTexture().
+		*/
+		SoftwareTexture(const RenderDevice::TextureDescription& description, const RenderDevice::SubresourceData* subresources);
+		SoftwareTexture(const SoftwareTexture&) = delete;
+		SoftwareTexture& operator=(const SoftwareTexture&) = delete;
+		SoftwareTexture(SoftwareTexture&&) = delete;
+		SoftwareTexture& operator=(SoftwareTexture&&) = delete;
+		~SoftwareTexture() = default;
+
+		std::uint32_t Width() const;
+		std::uint32_t Height() const;
+		std::uint32_t MipLevels() const;
+		std::uint32_t ArraySize() const;
+
+		/**
+		* Sample a slice of the texture, as Texture2DArray.SampleGrad() does.
+		* @param textureCoordinate The texture coordinate, from 0 to 1 across the texture.
+		* @param ddx The change in the texture coordinate from one pixel to the next to the right.
+		* @param ddy The change in the texture coordinate from one pixel to the next below.
+		*/
+		DirectX::XMFLOAT4 SampleGrad(RenderDevice::SamplerType sampler, const DirectX::XMFLOAT2& textureCoordinate, std::uint32_t slice,
+			const DirectX::XMFLOAT2& ddx, const DirectX::XMFLOAT2& ddy) const;
+		/**
+		* Sample the texture as a cube map, as TextureCube.SampleGrad() does. Each face is filtered on its own, clamped at its edges.
+		* @param direction The direction from the center of the cube, of any length.
+		*/
+		DirectX::XMFLOAT4 SampleCubeGrad(RenderDevice::SamplerType sampler, const DirectX::XMFLOAT3& direction, const DirectX::XMFLOAT3& ddx, const DirectX::XMFLOAT3& ddy) const;
+
+		static const std::uint32_t CubeFaceCount = 6;
+
+	private:
+		struct Level
+		{
+			std::uint32_t Width;
+			std::uint32_t Height;
+			std::vector<std::uint32_t> Texels;		// Row by row with no padding, the red channel in the low byte
+		};
+
+		DirectX::XMFLOAT4 SampleLevel(RenderDevice::SamplerType sampler, float u, float v, std::uint32_t slice, float levelOfDetail) const;
+		DirectX::XMFLOAT4 SampleBilinear(const Level& level, bool wrap, float u, float v) const;
+		DirectX::XMFLOAT4 SamplePoint(const Level& level, bool wrap, float u, float v) const;
+
+		std::uint32_t mWidth;
+		std::uint32_t mHeight;
+		std::uint32_t mMipLevels;
+		std::uint32_t mArraySize;
+		std::vector<Level> mLevels;		// The mip levels of each slice in turn
+	};
+}
\ No newline at end of file
@@ -0,0 +1,137 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <new>
+#include <type_traits>
+
+namespace Library
+{
+	/**
+	* A lock-free single-producer, single-consumer ring of trivially copyable items laid out in caller-provided memory.
+	* Because the ring holds no pointers it can live in a shared memory region and be used from two processes.
+	* Items are published in batches: a push becomes visible to the consumer all at once, or not at all.
+	*/
+	template <typename T>
+	class SpscRingBuffer final
+	{
+		static_assert(std::is_trivially_copyable<T>::value, "SpscRingBuffer items must be trivially copyable.");
+
+	public:
+		/**
+		* Get the number of bytes needed for a ring.
+		* @param capacity The number of items the ring holds. Must be a power of two.
+		*/
+		static std::size_t RequiredSize(std::uint32_t capacity)
+		{
+			return sizeof(Header) + sizeof(T) * capacity;
+		}
+
+		/**
+		* Lay out an empty ring in memory. Only one process should initialize a ring.
+		*/
+		static void Initialize(void* memory, std::uint32_t capacity)
+		{
+			Header* header = new (memory) Header();
+			header->Head.store(0, std::memory_order_relaxed);
+			header->Tail.store(0, std::memory_order_relaxed);
+			header->Capacity = capacity;
+		}
+
+		/**
+		* Attach to a ring previously laid out with Initialize().
+		*/
+		explicit SpscRingBuffer(void* memory) :
+			mHeader(reinterpret_cast<Header*>(memory)), mItems(reinterpret_cast<T*>(reinterpret_cast<std::uint8_t*>(memory) + sizeof(Header))), mMask(mHeader->Capacity - 1)
+		{
+		}
+
+		/**
+		* Copy as many items as fit into the ring and publish them together. Producer only.
+		* @return The number of items pushed.
+		*/
+		std::uint32_t Push(const T* items, std::uint32_t count)
+		{
+			std::uint32_t head = mHeader->Head.load(std::memory_order_relaxed);
+			std::uint32_t tail = mHeader->Tail.load(std::memory_order_acquire);
+			std::uint32_t available = mHeader->Capacity - (head - tail);
+			if (count > available)
+			{
+				count = available;
+			}
+
+			for (std::uint32_t i = 0; i < count; ++i)
+			{
+				mItems[(head + i) & mMask] = items[i];
+			}
+
+			mHeader->Head.store(head + count, std::memory_order_release);
+
+			return count;
+		}
+
+		/**
+		* Copy published items out of the ring without consuming them. Consumer only.
+		* @return The number of items copied.
+		*/
+		std::uint32_t Peek(T* items, std::uint32_t maxCount) const
+		{
+			std::uint32_t tail = mHeader->Tail.load(std::memory_order_relaxed);
+			std::uint32_t head = mHeader->Head.load(std::memory_order_acquire);
+			std::uint32_t count = head - tail;
+			if (count > maxCount)
+			{
+				count = maxCount;
+			}
+
+			for (std::uint32_t i = 0; i < count; ++i)
+			{
+				items[i] = mItems[(tail + i) & mMask];
+			}
+
+			return count;
+		}
+
+		/**
+		* Release items previously returned by Peek() back to the producer. Consumer only.
+		*/
+		void Consume(std::uint32_t count)
+		{
+			std::uint32_t tail = mHeader->Tail.load(std::memory_order_relaxed);
+			mHeader->Tail.store(tail + count, std::memory_order_release);
+		}
+
+		std::uint32_t Count() const
+		{
+			return mHeader->Head.load(std::memory_order_acquire) - mHeader->Tail.load(std::memory_order_acquire);
+		}
+
+		std::uint32_t Capacity() const
+		{
+			return mHeader->Capacity;
+		}
+
+		/**
+		* Discard every item. Neither the producer nor the consumer may be using the ring.
+		*/
+		void Reset()
+		{
+			mHeader->Head.store(0, std::memory_order_relaxed);
+			mHeader->Tail.store(0, std::memory_order_release);
+		}
+
+	private:
+		struct Header
+		{
+			alignas(64) std::atomic<std::uint32_t> Head;
+			alignas(64) std::atomic<std::uint32_t> Tail;
+			alignas(64) std::uint32_t Capacity;
+		};
+
+		static_assert(sizeof(std::atomic<std::uint32_t>) == sizeof(std::uint32_t), "Ring indices must be address-free.");
+
+		Header* mHeader;
+		T* mItems;
+		std::uint32_t mMask;
+	};
+}
\ No newline at end of file
@@ -0,0 +1,125 @@
+#include "pch.h"
+
+using namespace std;
+using namespace DirectX;
+
+namespace Library
+{
+	RTTI_DEFINITIONS(TextOverlay)
+
+	const wstring TextOverlay::DefaultFontFileName = L"Content\\Fonts\\Arial_14_Regular.spritefont";
+
+	TextOverlay::TextOverlay(Game& game, const wstring& fontFileName) :
+		DrawableGameComponent(game), mFontFileName(fontFileName), mRenderStateHelper(game), mLayoutCount(0)
+	{
+	}
+
+	void TextOverlay::Initialize()
+	{
+		mSpriteBatch = make_unique<SpriteBatch>(mGame->Direct3DDeviceContext());
+		mSpriteFont = make_unique<SpriteFont>(mGame->Direct3DDevice(), mFontFileName.c_str());
+		mSpriteFont->GetSpriteSheet(mSpriteSheet.ReleaseAndGetAddressOf());
+	}
+
+	void TextOverlay::Draw(const GameTime& gameTime)
+	{
+		UNREFERENCED_PARAMETER(gameTime);
+
+		mRenderStateHelper.SaveAll();
+
+		// Every quad samples the one sprite sheet, so the batch submits them all with a single draw when it ends
+		mSpriteBatch->Begin();
+		for (TextRun& run : mTexts)
+		{
+			if (run.LaidOut == false)
+			{
+				Layout(run);
+			}
+
+			XMVECTOR color = XMLoadFloat4(&run.Color);
+			for (const GlyphQuad& quad : run.Quads)
+			{
+				XMFLOAT2 position(run.Position.x + quad.Offset.x, run.Position.y + quad.Offset.y);
+				mSpriteBatch->Draw(mSpriteSheet.Get(), position, &quad.Source, color);
+			}
+		}
+
+		mSpriteBatch->End();
+		mRenderStateHelper.RestoreAll();
+	}
+
+	uint32_t TextOverlay::AddText(const XMFLOAT2& position, const wstring& text, const XMFLOAT4& color)
+	{
+		TextRun run;
+		run.Text = text;
+		run.Position = position;
+		run.Color = color;
+		run.LaidOut = false;
+		mTexts.push_back(move(run));
+
+		return static_cast<uint32_t>(mTexts.size() - 1);
+	}
+
+	void TextOverlay::SetText(uint32_t text, const wstring& value)
+	{
+		TextRun& run = mTexts.at(text);
+		if (run.Text != value)
+		{
+			run.Text = value;
+			run.LaidOut = false;
+		}
+	}
+
+	void TextOverlay::SetPosition(uint32_t text, const XMFLOAT2& position)
+	{
+		// The quads are relative to the position, so moving a text needs no layout
+		mTexts.at(text).Position = position;
+	}
+
+	void TextOverlay::SetColor(uint32_t text, const XMFLOAT4& color)
+	{
+		mTexts.at(text).Color = color;
+	}
+
+	uint32_t TextOverlay::LayoutCount() const
+	{
+		return mLayoutCount;
+	}
+
+	void TextOverlay::Layout(TextRun& run)
+	{
+		// The same placement as SpriteFont::DrawString, kept instead of recomputed every frame
+		run.Quads.clear();
+		float x = 0.0f;
+		float y = 0.0f;
+		for (wchar_t character : run.Text)
+		{
+			if (character == L'\r')
+			{
+				continue;
+			}
+
+			if (character == L'\n')
+			{
+				x = 0.0f;
+				y += mSpriteFont->GetLineSpacing();
+				continue;
+			}
+
+			const SpriteFont::Glyph* glyph = mSpriteFont->FindGlyph(character);
+			x = max(x + glyph->XOffset, 0.0f);
+
+			LONG width = glyph->Subrect.right - glyph->Subrect.left;
+			LONG height = glyph->Subrect.bottom - glyph->Subrect.top;
+			if (iswspace(character) == 0 || width > 1 || height > 1)
+			{
+				run.Quads.push_back({ XMFLOAT2(x, y + glyph->YOffset), glyph->Subrect });
+			}
+
+			x += width + glyph->XAdvance;
+		}
+
+		run.LaidOut = true;
+		++mLayoutCount;
+	}
+}
\ No newline at end of file
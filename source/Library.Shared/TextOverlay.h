@@ -0,0 +1,89 @@
+#pragma once
+
+#include "DrawableGameComponent.h"
+#include "RenderStateHelper.h"
+#include <string>
+#include <vector>
+#include <memory>
+#include <cstdint>
+#include <wrl.h>
+#include <d3d11_2.h>
+#include <DirectXMath.h>
+
+namespace DirectX
+{
+	class SpriteBatch;
+	class SpriteFont;
+}
+
+namespace Library
+{
+	/**
+	* Draws every piece of text on the screen with one font and one sprite batch. Each text is laid out into glyph quads
+	* once and again only when its string changes, and the quads of all texts are drawn together, so the cost of the
+	* overlay depends on the glyphs shown rather than the number of components showing them.
+	*
+	* The overlay saves and restores the render states around its draw, and is drawn after every other component.
+	*/
+	class TextOverlay final : public DrawableGameComponent
+	{
+		RTTI_DECLARATIONS(TextOverlay, DrawableGameComponent)
+
+	public:
+		TextOverlay(Game& game, const std::wstring& fontFileName = DefaultFontFileName);
+		TextOverlay(const TextOverlay&) = delete;
+		TextOverlay& operator=(const TextOverlay&) = delete;
+		TextOverlay(TextOverlay&&) = delete;
+		TextOverlay& operator=(TextOverlay&&) = delete;
+		~TextOverlay() = default;
+
+		virtual void Initialize() override;
+		virtual void Draw(const GameTime& gameTime) override;
+
+		/**
+		* Add a text to the overlay. Texts may be added before or after Initialize().
+		* @param position The top left corner of the text, in pixels.
+		* @return The index identifying the text.
+		*/
+		std::uint32_t AddText(const DirectX::XMFLOAT2& position, const std::wstring& text = L"", const DirectX::XMFLOAT4& color = DirectX::XMFLOAT4(1.0f, 1.0f, 1.0f, 1.0f));
+		/**
+		* Replace a string, laying it out again on the next draw unless it is unchanged.
+		*/
+		void SetText(std::uint32_t text, const std::wstring& value);
+		void SetPosition(std::uint32_t text, const DirectX::XMFLOAT2& position);
+		void SetColor(std::uint32_t text, const DirectX::XMFLOAT4& color);
+
+		/**
+		* Get the number of times any text has been laid out, to confirm static text is laid out only once.
+		*/
+		std::uint32_t LayoutCount() const;
+
+		static const std::wstring DefaultFontFileName;
+
+	private:
+		struct GlyphQuad
+		{
+			DirectX::XMFLOAT2 Offset;		// From the position of the text
+			RECT Source;					// Within the sprite sheet of the font
+		};
+
+		struct TextRun
+		{
+			std::wstring Text;
+			DirectX::XMFLOAT2 Position;
+			DirectX::XMFLOAT4 Color;
+			std::vector<GlyphQuad> Quads;
+			bool LaidOut;
+		};
+
+		void Layout(TextRun& run);
+
+		std::wstring mFontFileName;
+		std::unique_ptr<DirectX::SpriteBatch> mSpriteBatch;
+		std::unique_ptr<DirectX::SpriteFont> mSpriteFont;
+		Microsoft::WRL::ComPtr<ID3D11ShaderResourceView> mSpriteSheet;
+		RenderStateHelper mRenderStateHelper;
+		std::vector<TextRun> mTexts;
+		std::uint32_t mLayoutCount;
+	};
+}
\ No newline at end of file
@@ -0,0 +1,315 @@
+#include "pch.h"
+
+using namespace std;
+
+namespace Library
+{
+	RTTI_DEFINITIONS(TextureCache)
+
+	namespace
+	{
+		const uint32_t BytesPerPixel = 4;
+
+		/**
+		* Average each two by two block of an image into one pixel, repeating the last row or column of an odd size.
+		*/
+		DecodedImage Halve(const DecodedImage& image)
+		{
+			DecodedImage halved;
+			halved.Width = max(image.Width / 2, 1U);
+			halved.Height = max(image.Height / 2, 1U);
+			halved.Pixels.resize(static_cast<size_t>(halved.Width) * halved.Height * BytesPerPixel);
+
+			for (uint32_t y = 0; y < halved.Height; ++y)
+			{
+				const uint8_t* row0 = &image.Pixels[static_cast<size_t>(min(2 * y, image.Height - 1)) * image.Width * BytesPerPixel];
+				const uint8_t* row1 = &image.Pixels[static_cast<size_t>(min(2 * y + 1, image.Height - 1)) * image.Width * BytesPerPixel];
+				uint8_t* destination = &halved.Pixels[static_cast<size_t>(y) * halved.Width * BytesPerPixel];
+
+				for (uint32_t x = 0; x < halved.Width; ++x)
+				{
+					uint32_t left = min(2 * x, image.Width - 1) * BytesPerPixel;
+					uint32_t right = min(2 * x + 1, image.Width - 1) * BytesPerPixel;
+					for (uint32_t channel = 0; channel < BytesPerPixel; ++channel)
+					{
+						uint32_t sum = row0[left + channel] + row0[right + channel] + row1[left + channel] + row1[right + channel];
+						destination[x * BytesPerPixel + channel] = static_cast<uint8_t>((sum + 2) / 4);
+					}
+				}
+			}
+
+			return halved;
+		}
+
+		/**
+		* Map the centre of a destination pixel to the two source pixels around it and the weight of the second.
+		*/
+		void SourceSpan(uint32_t destination, uint32_t destinationSize, uint32_t sourceSize, uint32_t& first, uint32_t& second, float& weight)
+		{
+			float position = (destination + 0.5f) * sourceSize / destinationSize - 0.5f;
+			position = min(max(position, 0.0f), static_cast<float>(sourceSize - 1));
+
+			first = static_cast<uint32_t>(position);
+			second = min(first + 1, sourceSize - 1);
+			weight = position - first;
+		}
+	}
+
+	size_t TextureData::MemorySize() const
+	{
+		size_t size = 0;
+		for (const DecodedImage& level : MipLevels)
+		{
+			size += level.Pixels.size();
+		}
+
+		return size;
+	}
+
+	TextureCache::TextureCache(ThreadPool& threadPool, const ImageDecoder& decoder) :
+		mThreadPool(&threadPool), mDecoder(decoder), mDecodesRunning(0)
+	{
+	}
+
+	TextureCache::~TextureCache()
+	{
+		// The decodes still queued on the pool refer to the cache
+		unique_lock<mutex> lock(mMutex);
+		mDecodesFinished.wait(lock, [this] { return mDecodesRunning == 0; });
+	}
+
+	TextureCache::TextureFuture TextureCache::Load(const wstring& filename, uint32_t width, uint32_t height)
+	{
+		assert(width > 0 && height > 0);
+
+		TextureKey key(NormalizePath(filename), width, height);
+		lock_guard<mutex> lock(mMutex);
+
+		auto found = mEntries.find(key);
+		if (found == mEntries.end())
+		{
+			found = mEntries.emplace(key, Entry()).first;
+			found->second.Order = static_cast<uint32_t>(mEntries.size() - 1);
+		}
+
+		Entry& entry = found->second;
+		if (entry.Pending.valid())
+		{
+			return entry.Pending;
+		}
+
+		auto loaded = make_shared<promise<shared_ptr<const TextureData>>>();
+		shared_ptr<const TextureData> held = entry.Data.lock();
+		if (held != nullptr)
+		{
+			loaded->set_value(held);
+			return loaded->get_future().share();
+		}
+
+		entry.Pending = loaded->get_future().share();
+		++mDecodesRunning;
+		// The task gives up its promise when it finishes, so a worker keeping the task does not keep the texture
+		mThreadPool->Enqueue([this, key, filename, loaded]() mutable
+		{
+			Decode(key, filename, move(loaded));
+		});
+
+		return entry.Pending;
+	}
+
+	vector<TextureMemory> TextureCache::MemoryReport() const
+	{
+		lock_guard<mutex> lock(mMutex);
+
+		vector<const Entry*> decoded;
+		for (const auto& entry : mEntries)
+		{
+			if (entry.second.Decoded)
+			{
+				decoded.push_back(&entry.second);
+			}
+		}
+
+		sort(decoded.begin(), decoded.end(), [](const Entry* lhs, const Entry* rhs) { return lhs->Order < rhs->Order; });
+
+		vector<TextureMemory> report;
+		report.reserve(decoded.size());
+		for (const Entry* entry : decoded)
+		{
+			report.push_back(entry->Memory);
+			report.back().Resident = (entry->Data.expired() == false);
+		}
+
+		return report;
+	}
+
+	DecodedImage TextureCache::Resample(const DecodedImage& image, uint32_t width, uint32_t height)
+	{
+		assert(image.Width > 0 && image.Height > 0 && width > 0 && height > 0);
+
+		// Bilinear filtering alone would skip source pixels when shrinking by more than half
+		DecodedImage halved;
+		const DecodedImage* source = &image;
+		while (source->Width >= 2 * width && source->Height >= 2 * height)
+		{
+			halved = Halve(*source);
+			source = &halved;
+		}
+
+		if (source->Width == width && source->Height == height)
+		{
+			return *source;
+		}
+
+		DecodedImage resampled;
+		resampled.Width = width;
+		resampled.Height = height;
+		resampled.Pixels.resize(static_cast<size_t>(width) * height * BytesPerPixel);
+
+		for (uint32_t y = 0; y < height; ++y)
+		{
+			uint32_t y0, y1;
+			float ty;
+			SourceSpan(y, height, source->Height, y0, y1, ty);
+			const uint8_t* row0 = &source->Pixels[static_cast<size_t>(y0) * source->Width * BytesPerPixel];
+			const uint8_t* row1 = &source->Pixels[static_cast<size_t>(y1) * source->Width * BytesPerPixel];
+			uint8_t* destination = &resampled.Pixels[static_cast<size_t>(y) * width * BytesPerPixel];
+
+			for (uint32_t x = 0; x < width; ++x)
+			{
+				uint32_t x0, x1;
+				float tx;
+				SourceSpan(x, width, source->Width, x0, x1, tx);
+				x0 *= BytesPerPixel;
+				x1 *= BytesPerPixel;
+
+				for (uint32_t channel = 0; channel < BytesPerPixel; ++channel)
+				{
+					float top = row0[x0 + channel] + (row0[x1 + channel] - row0[x0 + channel]) * tx;
+					float bottom = row1[x0 + channel] + (row1[x1 + channel] - row1[x0 + channel]) * tx;
+					destination[x * BytesPerPixel + channel] = static_cast<uint8_t>(top + (bottom - top) * ty + 0.5f);
+				}
+			}
+		}
+
+		return resampled;
+	}
+
+	vector<DecodedImage> TextureCache::BuildMipChain(DecodedImage&& image)
+	{
+		vector<DecodedImage> levels;
+		levels.push_back(move(image));
+		while (levels.back().Width > 1 || levels.back().Height > 1)
+		{
+			levels.push_back(Halve(levels.back()));
+		}
+
+		return levels;
+	}
+
+	void TextureCache::Decode(const TextureKey& key, const wstring& filename, shared_ptr<promise<shared_ptr<const TextureData>>> loaded)
+	{
+		uint32_t width = get<1>(key);
+		uint32_t height = get<2>(key);
+
+		try
+		{
+			vector<uint8_t> contents = ReadFile(filename);
+			shared_ptr<const TextureData> texture = DecodeContents(contents, width, height);
+			{
+				lock_guard<mutex> lock(mMutex);
+				Entry& entry = mEntries[key];
+				entry.Pending = TextureFuture();
+				entry.Data = texture;
+				entry.Decoded = true;
+				entry.Memory = { filename, width, height, static_cast<uint32_t>(texture->MipLevels.size()), texture->MemorySize(), true };
+			}
+
+			loaded->set_value(texture);
+		}
+		catch (...)
+		{
+			// Leave the texture to be tried again by the next request
+			{
+				lock_guard<mutex> lock(mMutex);
+				mEntries[key].Pending = TextureFuture();
+			}
+
+			loaded->set_exception(current_exception());
+		}
+
+		lock_guard<mutex> lock(mMutex);
+		--mDecodesRunning;
+		mDecodesFinished.notify_all();
+	}
+
+	shared_ptr<const TextureData> TextureCache::DecodeContents(const vector<uint8_t>& contents, uint32_t width, uint32_t height)
+	{
+		uint64_t hash = Utility::HashBytes(contents.data(), contents.size());
+		ContentKey contentKey(hash, width, height);
+		{
+			// A copy of an image already decoded under another name
+			lock_guard<mutex> lock(mMutex);
+			auto found = mContents.find(contentKey);
+			if (found != mContents.end())
+			{
+				shared_ptr<const TextureData> held = found->second.lock();
+				if (held != nullptr)
+				{
+					return held;
+				}
+			}
+		}
+
+		DecodedImage image = mDecoder(contents);
+		if (image.Width == 0 || image.Height == 0 || image.Pixels.size() != static_cast<size_t>(image.Width) * image.Height * BytesPerPixel)
+		{
+			throw GameException("The image decoder returned no pixels.");
+		}
+
+		auto texture = make_shared<TextureData>();
+		texture->MipLevels = BuildMipChain(image.Width == width && image.Height == height ? move(image) : Resample(image, width, height));
+		texture->ContentHash = hash;
+
+		// Another name for the same image may have finished decoding meanwhile; keep whichever texture came first
+		lock_guard<mutex> lock(mMutex);
+		weak_ptr<const TextureData>& cached = mContents[contentKey];
+		shared_ptr<const TextureData> held = cached.lock();
+		if (held != nullptr)
+		{
+			return held;
+		}
+
+		cached = texture;
+		return texture;
+	}
+
+	vector<uint8_t> TextureCache::ReadFile(const wstring& filename)
+	{
+#if defined(_WIN32)
+		ifstream file(filename.c_str(), ios::binary);
+#else
+		ifstream file(Utility::ToPortablePath(filename), ios::binary);
+#endif
+		if (!file.good())
+		{
+			throw GameException("Could not open file.");
+		}
+
+		file.seekg(0, ios::end);
+		vector<uint8_t> contents(static_cast<size_t>(file.tellg()));
+		file.seekg(0, ios::beg);
+		file.read(reinterpret_cast<char*>(contents.data()), contents.size());
+
+		return contents;
+	}
+
+	wstring TextureCache::NormalizePath(const wstring& filename)
+	{
+		// Only the separators are unified; other spellings of a file are caught by the hash of its contents
+		wstring path = filename;
+		replace(path.begin(), path.end(), L'\\', L'/');
+
+		return path;
+	}
+}
\ No newline at end of file
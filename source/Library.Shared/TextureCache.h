@@ -0,0 +1,138 @@
+#pragma once
+
+#include "RTTI.h"
+#include <string>
+#include <vector>
+#include <map>
+#include <tuple>
+#include <memory>
+#include <mutex>
+#include <condition_variable>
+#include <future>
+#include <functional>
+#include <cstdint>
+
+namespace Library
+{
+	class ThreadPool;
+
+	/**
+	* An image of 8-bit RGBA pixels, row by row with no padding.
+	*/
+	struct DecodedImage
+	{
+		std::uint32_t Width = 0;
+		std::uint32_t Height = 0;
+		std::vector<std::uint8_t> Pixels;
+	};
+
+	/**
+	* A texture ready to upload: every level of its mip chain, largest first and down to one pixel.
+	*/
+	struct TextureData
+	{
+		std::vector<DecodedImage> MipLevels;
+		std::uint64_t ContentHash;
+
+		/**
+		* Get the number of bytes the mip chain takes, in memory or on the device.
+		*/
+		std::size_t MemorySize() const;
+	};
+
+	/**
+	* The memory taken by a texture the cache has decoded.
+	*/
+	struct TextureMemory
+	{
+		std::wstring Filename;
+		std::uint32_t Width;
+		std::uint32_t Height;
+		std::uint32_t MipLevels;
+		std::size_t Bytes;
+		bool Resident;		// Whether anyone still holds the decoded pixels
+	};
+
+	/**
+	* Decodes textures on the worker threads of a pool and shares them between everyone asking for them. A request
+	* returns at once with a future of the texture, so a caller can queue all its textures, do other work, and upload
+	* each as it becomes ready. Textures are found by their path and size, then by a hash of the file contents, so two
+	* names for the same image share one texture; requests for a texture still being decoded share that decode.
+	*
+	* Images are scaled to the size asked for and given a full mip chain on the workers, leaving the caller only the
+	* upload. The file format is left to the decoder given to the cache, so everything but the decoding itself has no
+	* platform dependencies. The cache holds weak references: the pixels are released once the last holder lets go,
+	* typically right after the upload, while the memory report keeps the size of every texture decoded.
+	*/
+	class TextureCache final : public RTTI
+	{
+		RTTI_DECLARATIONS(TextureCache, RTTI)
+
+	public:
+		/**
+		* Turns the contents of an image file into pixels, or throws.
+		*/
+		typedef std::function<DecodedImage(const std::vector<std::uint8_t>& contents)> ImageDecoder;
+		typedef std::shared_future<std::shared_ptr<const TextureData>> TextureFuture;
+
+		TextureCache(ThreadPool& threadPool, const ImageDecoder& decoder);
+		TextureCache(const TextureCache&) = delete;
+		TextureCache& operator=(const TextureCache&) = delete;
+		TextureCache(TextureCache&&) = delete;
+		TextureCache& operator=(TextureCache&&) = delete;
+		/**
+		* Waits for the decodes still running.
+		*/
+		~TextureCache();
+
+		/**
+		* Get a texture, decoding it on the pool unless someone holds it or is already decoding it.
+		* @param width The width of the largest level of the texture.
+		* @param height The height of the largest level of the texture.
+		* @return A future of the texture that rethrows anything reading or decoding it threw.
+		*/
+		TextureFuture Load(const std::wstring& filename, std::uint32_t width, std::uint32_t height);
+
+		/**
+		* Get the size of every texture decoded so far, in the order they were first asked for.
+		*/
+		std::vector<TextureMemory> MemoryReport() const;
+
+		/**
+		* Scale an image, halving it with a box filter while it is at least twice the size asked for, then filtering
+		* bilinearly the rest of the way.
+		*/
+		static DecodedImage Resample(const DecodedImage& image, std::uint32_t width, std::uint32_t height);
+		/**
+		* Build the mip chain of an image by averaging each two by two block of a level into the next.
+		*/
+		static std::vector<DecodedImage> BuildMipChain(DecodedImage&& image);
+
+	private:
+		typedef std::tuple<std::wstring, std::uint32_t, std::uint32_t> TextureKey;
+		typedef std::tuple<std::uint64_t, std::uint32_t, std::uint32_t> ContentKey;
+
+		struct Entry
+		{
+			std::uint32_t Order;
+			TextureFuture Pending;		// Valid while a worker decodes the texture
+			std::weak_ptr<const TextureData> Data;
+			bool Decoded = false;
+			TextureMemory Memory;
+		};
+
+		void Decode(const TextureKey& key, const std::wstring& filename, std::shared_ptr<std::promise<std::shared_ptr<const TextureData>>> loaded);
+		std::shared_ptr<const TextureData> DecodeContents(const std::vector<std::uint8_t>& contents, std::uint32_t width, std::uint32_t height);
+		static std::vector<std::uint8_t> ReadFile(const std::wstring& filename);
+		static std::wstring NormalizePath(const std::wstring& filename);
+
+		ThreadPool* mThreadPool;
+		ImageDecoder mDecoder;
+
+		mutable std::mutex mMutex;
+		std::map<TextureKey, Entry> mEntries;
+		std::map<ContentKey, std::weak_ptr<const TextureData>> mContents;
+		std::uint32_t mDecodesRunning;
+		std::condition_variable mDecodesFinished;
+	};
+}
\ No newline at end of file
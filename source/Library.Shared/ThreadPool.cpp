@@ -0,0 +1,121 @@
+#include "pch.h"
+
+using namespace std;
+
+namespace Library
+{
+	ThreadPool::ThreadPool(uint32_t threadCount) :
+		mStopping(false)
+	{
+		if (threadCount == 0)
+		{
+			threadCount = max(thread::hardware_concurrency(), 1U);
+		}
+
+		mThreads.reserve(threadCount);
+		for (uint32_t i = 0; i < threadCount; ++i)
+		{
+			mThreads.emplace_back(&ThreadPool::WorkerLoop, this);
+		}
+	}
+
+	ThreadPool::~ThreadPool()
+	{
+		{
+			lock_guard<mutex> lock(mMutex);
+			mStopping = true;
+		}
+
+		mTaskAvailable.notify_all();
+		for (thread& worker : mThreads)
+		{
+			worker.join();
+		}
+	}
+
+	uint32_t ThreadPool::ThreadCount() const
+	{
+		return static_cast<uint32_t>(mThreads.size());
+	}
+
+	future<void> ThreadPool::Enqueue(function<void()> task)
+	{
+		packaged_task<void()> packagedTask(move(task));
+		future<void> result = packagedTask.get_future();
+
+		{
+			lock_guard<mutex> lock(mMutex);
+			mTasks.push(move(packagedTask));
+		}
+
+		mTaskAvailable.notify_one();
+
+		return result;
+	}
+
+	void ThreadPool::ParallelFor(uint32_t count, uint32_t grainSize, const function<void(uint32_t, uint32_t)>& body)
+	{
+		if (grainSize == 0)
+		{
+			grainSize = 1;
+		}
+
+		vector<future<void>> chunks;
+		chunks.reserve((count + grainSize - 1) / grainSize);
+		for (uint32_t begin = 0; begin < count; begin += grainSize)
+		{
+			uint32_t end = min(begin + grainSize, count);
+			chunks.push_back(Enqueue([&body, begin, end]()
+			{
+				body(begin, end);
+			}));
+		}
+
+		// Wait for every chunk before rethrowing, since they all reference the caller's body
+		exception_ptr firstException;
+		for (future<void>& chunk : chunks)
+		{
+			try
+			{
+				chunk.get();
+			}
+			catch (...)
+			{
+				if (firstException == nullptr)
+				{
+					firstException = current_exception();
+				}
+			}
+		}
+
+		if (firstException != nullptr)
+		{
+			rethrow_exception(firstException);
+		}
+	}
+
+	void ThreadPool::WorkerLoop()
+	{
+		for (;;)
+		{
+			packaged_task<void()> task;
+			{
+				unique_lock<mutex> lock(mMutex);
+				mTaskAvailable.wait(lock, [&]
+				{
+					return mStopping || mTasks.empty() == false;
+				});
+
+				if (mStopping && mTasks.empty())
+				{
+					return;
+				}
+
+				task = move(mTasks.front());
+				mTasks.pop();
+			}
+
+			task();
+		}
+	}
+}
\ No newline at end of file
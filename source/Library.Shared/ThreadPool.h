@@ -0,0 +1,56 @@
+#pragma once
+
+#include <vector>
+#include <queue>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <functional>
+#include <future>
+#include <cstdint>
+
+namespace Library
+{
+	/**
+	* A fixed set of worker threads that run queued tasks in submission order.
+	*/
+	class ThreadPool final
+	{
+	public:
+		/**
+		* @param threadCount The number of worker threads, or zero for one per hardware thread.
+		*/
+		explicit ThreadPool(std::uint32_t threadCount = 0);
+		ThreadPool(const ThreadPool&) = delete;
+		ThreadPool& operator=(const ThreadPool&) = delete;
+		ThreadPool(ThreadPool&&) = delete;
+		ThreadPool& operator=(ThreadPool&&) = delete;
+		~ThreadPool();
+
+		std::uint32_t ThreadCount() const;
+
+		/**
+		* Queue a task.
+		* @return A future that becomes ready when the task has run, and rethrows anything the task threw.
+		*/
+		std::future<void> Enqueue(std::function<void()> task);
+
+		/**
+		* Split the range [0, count) into chunks of at most grainSize items, run them on the pool and wait for all of them.
+		* The first exception thrown by a chunk is rethrown once every chunk has finished.
+		* @param count The number of items.
+		* @param grainSize The largest number of items handed to a single call.
+		* @param body Called with the first item and one past the last item of a chunk.
+		*/
+		void ParallelFor(std::uint32_t count, std::uint32_t grainSize, const std::function<void(std::uint32_t, std::uint32_t)>& body);
+
+	private:
+		void WorkerLoop();
+
+		std::vector<std::thread> mThreads;
+		std::queue<std::packaged_task<void()>> mTasks;
+		std::mutex mMutex;
+		std::condition_variable mTaskAvailable;
+		bool mStopping;
+	};
+}
\ No newline at end of file
@@ -57,14 +57,18 @@ namespace Library
 
 	void Utility::LoadBinaryFile(const std::wstring& filename, std::vector<char>& data)
 	{
+#if defined(_WIN32)
 		std::ifstream file(filename.c_str(), std::ios::binary);
+#else
+		std::ifstream file(ToPortablePath(filename), std::ios::binary);
+#endif
 		if (!file.good())
 		{
-			throw std::exception("Could not open file.");
+			throw GameException("Could not open file.");
 		}
 
 		file.seekg(0, std::ios::end);
-		UINT size = (UINT)file.tellg();
+		std::size_t size = static_cast<std::size_t>(file.tellg());
 
 		if (size > 0)
 		{
@@ -95,4 +99,30 @@ namespace Library
 	{
 		return std::wstring_convert<std::codecvt_utf8<wchar_t>>().to_bytes(source);
 	}
+
+	std::string Utility::ToPortablePath(const std::string& path)
+	{
+		// The content names its files with Windows separators, which other platforms need as forward slashes
+		std::string portablePath(path);
+		std::replace(portablePath.begin(), portablePath.end(), '\\', '/');
+
+		return portablePath;
+	}
+
+	std::string Utility::ToPortablePath(const std::wstring& path)
+	{
+		return ToPortablePath(ToString(path));
+	}
+
+	std::uint64_t Utility::HashBytes(const std::uint8_t* data, std::size_t size)
+	{
+		// 64-bit FNV-1a
+		std::uint64_t hash = 14695981039346656037ULL;
+		for (std::size_t i = 0; i < size; ++i)
+		{
+			hash = (hash ^ data[i]) * 1099511628211ULL;
+		}
+
+		return hash;
+	}
 }
\ No newline at end of file
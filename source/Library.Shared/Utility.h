@@ -2,6 +2,7 @@
 
 #include <string>
 #include <vector>
+#include <cstdint>
 
 #define DeleteObject(object) if((object) != nullptr) { delete object; object = nullptr; }
 #define DeleteObjects(objects) if((objects) != nullptr) { delete[] objects; objects = nullptr; }
@@ -19,6 +20,9 @@ namespace Library
 		static std::wstring ToWideString(const std::string& source);
 		static void Totring(const std::wstring& source, std::string& dest);
 		static std::string ToString(const std::wstring& source);
+		static std::string ToPortablePath(const std::string& path);
+		static std::string ToPortablePath(const std::wstring& path);
+		static std::uint64_t HashBytes(const std::uint8_t* data, std::size_t size);
 
 		Utility() = delete;
 		Utility(const Utility&) = delete;
@@ -0,0 +1,341 @@
+#include "pch.h"
+
+using namespace std;
+
+namespace Library
+{
+	namespace
+	{
+		const uint32_t Lanes = 4;
+		const uint32_t VariableCount = 3;
+		const uint32_t MaxPower = 5;
+		const uint32_t DatesPerTask = 64;
+
+		const double J2000 = 2451545.0;
+		const double DaysPerMillennium = 365250.0;
+		const double TwoPi = 6.28318530717958647693;
+
+		const char* const BodyNames[] = { "MERCURY", "VENUS", "EARTH", "MARS", "JUPITER", "SATURN", "URANUS", "NEPTUNE" };
+
+		uint32_t SeriesSlot(uint32_t body, uint32_t variable, uint32_t power)
+		{
+			return (body * VariableCount + variable) * (MaxPower + 1) + power;
+		}
+	}
+
+	const uint32_t Vsop87Theory::Magic = 0x504F5356; // "VSOP"
+	const uint32_t Vsop87Theory::Version = 1;
+	const uint32_t Vsop87Theory::BodyCount = ARRAYSIZE(BodyNames);
+
+	Vsop87Theory::Vsop87Theory(const wstring& filename) :
+		mFile(filename), mHeader(nullptr), mSeries(nullptr), mAmplitudes(nullptr), mPhases(nullptr), mFrequencies(nullptr),
+		mSeriesIndices(BodyCount * VariableCount * (MaxPower + 1), -1), mTruncation(0.0)
+	{
+		const uint8_t* data = mFile.Data();
+		size_t size = mFile.Size();
+		if (size < sizeof(Vsop87Header))
+		{
+			throw GameException("VSOP87 file is truncated.");
+		}
+
+		mHeader = reinterpret_cast<const Vsop87Header*>(data);
+		if (mHeader->Magic != Magic)
+		{
+			throw GameException("VSOP87 file has an invalid signature.");
+		}
+
+		if (mHeader->Version != Version)
+		{
+			throw GameException("VSOP87 file version is not supported.");
+		}
+
+		uint64_t seriesEnd = static_cast<uint64_t>(mHeader->SeriesOffset) + static_cast<uint64_t>(mHeader->SeriesCount) * sizeof(Vsop87Series);
+		uint64_t termsEnd = static_cast<uint64_t>(mHeader->TermsOffset) + static_cast<uint64_t>(mHeader->TermCount) * 3 * sizeof(double);
+		if (seriesEnd > size || termsEnd > size || (mHeader->SeriesOffset % alignof(Vsop87Series)) != 0 || (mHeader->TermsOffset % alignof(double)) != 0)
+		{
+			throw GameException("VSOP87 file is corrupt.");
+		}
+
+		mSeries = reinterpret_cast<const Vsop87Series*>(data + mHeader->SeriesOffset);
+		mAmplitudes = reinterpret_cast<const double*>(data + mHeader->TermsOffset);
+		mPhases = mAmplitudes + mHeader->TermCount;
+		mFrequencies = mPhases + mHeader->TermCount;
+
+		for (uint32_t i = 0; i < mHeader->SeriesCount; ++i)
+		{
+			const Vsop87Series& series = mSeries[i];
+			if (series.Body >= BodyCount || series.Variable >= VariableCount || series.Power > MaxPower ||
+				static_cast<uint64_t>(series.FirstTerm) + series.TermCount > mHeader->TermCount)
+			{
+				throw GameException("VSOP87 file is corrupt.");
+			}
+
+			mSeriesIndices[SeriesSlot(series.Body, series.Variable, series.Power)] = static_cast<int32_t>(i);
+		}
+
+		SetTruncation(0.0);
+	}
+
+	char Vsop87Theory::Theory() const
+	{
+		return static_cast<char>(mHeader->Theory);
+	}
+
+	uint32_t Vsop87Theory::TermCount() const
+	{
+		return mHeader->TermCount;
+	}
+
+	uint32_t Vsop87Theory::ActiveTermCount() const
+	{
+		uint32_t count = 0;
+		for (uint32_t activeTermCount : mActiveTermCounts)
+		{
+			count += activeTermCount;
+		}
+
+		return count;
+	}
+
+	double Vsop87Theory::Truncation() const
+	{
+		return mTruncation;
+	}
+
+	void Vsop87Theory::SetTruncation(double amplitude)
+	{
+		mTruncation = amplitude;
+		mActiveTermCounts.resize(mHeader->SeriesCount);
+		for (uint32_t i = 0; i < mHeader->SeriesCount; ++i)
+		{
+			// The amplitudes of a series decrease, so the terms kept are a prefix of it
+			const double* first = mAmplitudes + mSeries[i].FirstTerm;
+			const double* last = first + mSeries[i].TermCount;
+			const double* end = partition_point(first, last, [amplitude](double value) { return fabs(value) >= amplitude; });
+			mActiveTermCounts[i] = static_cast<uint32_t>(end - first);
+		}
+	}
+
+	Vsop87Coordinates Vsop87Theory::Evaluate(uint32_t body, double julianDate) const
+	{
+		assert(body < BodyCount);
+
+		double tau = (julianDate - J2000) / DaysPerMillennium;
+		double values[VariableCount];
+		for (uint32_t variable = 0; variable < VariableCount; ++variable)
+		{
+			// Horner's rule over the powers of time, from the highest
+			double value = 0.0;
+			for (uint32_t power = MaxPower + 1; power-- > 0;)
+			{
+				int32_t series = mSeriesIndices[SeriesSlot(body, variable, power)];
+				value = value * tau + (series >= 0 ? Sum(static_cast<uint32_t>(series), tau) : 0.0);
+			}
+
+			values[variable] = value;
+		}
+
+		Vsop87Coordinates coordinates;
+		coordinates.Longitude = fmod(values[0], TwoPi);
+		if (coordinates.Longitude < 0.0)
+		{
+			coordinates.Longitude += TwoPi;
+		}
+
+		coordinates.Latitude = values[1];
+		coordinates.Radius = values[2];
+		return coordinates;
+	}
+
+	void Vsop87Theory::EvaluateBatch(uint32_t body, const double* julianDates, uint32_t count, Vsop87Coordinates* results, ThreadPool& threadPool) const
+	{
+		threadPool.ParallelFor(count, DatesPerTask, [&](uint32_t begin, uint32_t end)
+		{
+			for (uint32_t i = begin; i < end; ++i)
+			{
+				results[i] = Evaluate(body, julianDates[i]);
+			}
+		});
+	}
+
+	int32_t Vsop87Theory::BodyIndex(const string& name)
+	{
+		string upperName(name);
+		transform(upperName.begin(), upperName.end(), upperName.begin(), [](char c) { return static_cast<char>(toupper(static_cast<unsigned char>(c))); });
+		for (uint32_t i = 0; i < BodyCount; ++i)
+		{
+			if (upperName == BodyNames[i])
+			{
+				return static_cast<int32_t>(i);
+			}
+		}
+
+		return -1;
+	}
+
+	double Vsop87Theory::Sum(uint32_t series, double tau) const
+	{
+		uint32_t first = mSeries[series].FirstTerm;
+		uint32_t count = mActiveTermCounts[series];
+		const double* amplitudes = mAmplitudes + first;
+		const double* phases = mPhases + first;
+		const double* frequencies = mFrequencies + first;
+
+		// Each lane keeps its own partial sum, so the lanes of a block are independent of each other
+		double partialSums[Lanes] = { 0.0 };
+		uint32_t blockedCount = count - count % Lanes;
+		for (uint32_t i = 0; i < blockedCount; i += Lanes)
+		{
+			for (uint32_t lane = 0; lane < Lanes; ++lane)
+			{
+				partialSums[lane] += amplitudes[i + lane] * LaneMath::Cos(phases[i + lane] + frequencies[i + lane] * tau);
+			}
+		}
+
+		double sum = 0.0;
+		for (uint32_t i = blockedCount; i < count; ++i)
+		{
+			sum += amplitudes[i] * LaneMath::Cos(phases[i] + frequencies[i] * tau);
+		}
+
+		for (uint32_t lane = 0; lane < Lanes; ++lane)
+		{
+			sum += partialSums[lane];
+		}
+
+		return sum;
+	}
+
+	void Vsop87Theory::Compile(istream& source, ostream& destination)
+	{
+		struct Term
+		{
+			double Amplitude;
+			double Phase;
+			double Frequency;
+		};
+
+		struct SourceSeries
+		{
+			Vsop87Series Series;
+			vector<Term> Terms;
+		};
+
+		vector<SourceSeries> sourceSeries;
+		vector<int32_t> slots(BodyCount * VariableCount * (MaxPower + 1), -1);
+		char theory = '\0';
+
+		string line;
+		while (getline(source, line))
+		{
+			stringstream lineStream(line);
+			vector<string> tokens;
+			string token;
+			while (lineStream >> token)
+			{
+				tokens.push_back(token);
+			}
+
+			if (tokens.empty())
+			{
+				continue;
+			}
+
+			// A header line such as: VSOP87 VERSION D4 EARTH VARIABLE 1 (LBR) *T**0 1018 TERMS ...
+			if (tokens[0] == "VSOP87")
+			{
+				if (tokens.size() < 8 || tokens[1] != "VERSION" || tokens[4] != "VARIABLE" || tokens[7].compare(0, 4, "*T**") != 0)
+				{
+					throw GameException("VSOP87 source has a malformed series header.");
+				}
+
+				char version = tokens[2][0];
+				if (version != 'B' && version != 'D')
+				{
+					throw GameException("VSOP87 source must be of the spherical version B or D.");
+				}
+
+				if (theory != '\0' && version != theory)
+				{
+					throw GameException("VSOP87 source mixes versions of the theory.");
+				}
+
+				theory = version;
+
+				int32_t body = BodyIndex(tokens[3]);
+				int variable = atoi(tokens[5].c_str()) - 1;
+				int power = atoi(tokens[7].c_str() + 4);
+				if (body < 0 || variable < 0 || variable >= static_cast<int>(VariableCount) || power < 0 || power > static_cast<int>(MaxPower))
+				{
+					throw GameException("VSOP87 source has a series outside the theory.");
+				}
+
+				int32_t& slot = slots[SeriesSlot(static_cast<uint32_t>(body), static_cast<uint32_t>(variable), static_cast<uint32_t>(power))];
+				if (slot >= 0)
+				{
+					throw GameException("VSOP87 source repeats a series.");
+				}
+
+				slot = static_cast<int32_t>(sourceSeries.size());
+				SourceSeries series;
+				series.Series = { static_cast<uint32_t>(body), static_cast<uint32_t>(variable), static_cast<uint32_t>(power), 0, 0, 0 };
+				sourceSeries.push_back(series);
+				continue;
+			}
+
+			// A term line ends with its amplitude, phase and frequency
+			if (sourceSeries.empty() || tokens.size() < 3)
+			{
+				throw GameException("VSOP87 source has a term outside a series.");
+			}
+
+			size_t count = tokens.size();
+			Term term;
+			term.Amplitude = stod(tokens[count - 3]);
+			term.Phase = stod(tokens[count - 2]);
+			term.Frequency = stod(tokens[count - 1]);
+			sourceSeries.back().Terms.push_back(term);
+		}
+
+		vector<Vsop87Series> series;
+		vector<double> amplitudes;
+		vector<double> phases;
+		vector<double> frequencies;
+		for (SourceSeries& entry : sourceSeries)
+		{
+			stable_sort(entry.Terms.begin(), entry.Terms.end(), [](const Term& lhs, const Term& rhs) { return fabs(lhs.Amplitude) > fabs(rhs.Amplitude); });
+
+			entry.Series.FirstTerm = static_cast<uint32_t>(amplitudes.size());
+			entry.Series.TermCount = static_cast<uint32_t>(entry.Terms.size());
+			series.push_back(entry.Series);
+			for (const Term& term : entry.Terms)
+			{
+				amplitudes.push_back(term.Amplitude);
+				phases.push_back(term.Phase);
+				frequencies.push_back(term.Frequency);
+			}
+		}
+
+		Vsop87Header header = { 0 };
+		header.Magic = Magic;
+		header.Version = Version;
+		header.Theory = static_cast<uint32_t>(theory);
+		header.SeriesCount = static_cast<uint32_t>(series.size());
+		header.SeriesOffset = sizeof(Vsop87Header);
+		header.TermCount = static_cast<uint32_t>(amplitudes.size());
+		header.TermsOffset = header.SeriesOffset + header.SeriesCount * sizeof(Vsop87Series);
+
+		destination.write(reinterpret_cast<const char*>(&header), sizeof(header));
+		if (series.size() > 0)
+		{
+			destination.write(reinterpret_cast<const char*>(&series[0]), series.size() * sizeof(Vsop87Series));
+		}
+
+		if (amplitudes.size() > 0)
+		{
+			destination.write(reinterpret_cast<const char*>(&amplitudes[0]), amplitudes.size() * sizeof(double));
+			destination.write(reinterpret_cast<const char*>(&phases[0]), phases.size() * sizeof(double));
+			destination.write(reinterpret_cast<const char*>(&frequencies[0]), frequencies.size() * sizeof(double));
+		}
+	}
+}
\ No newline at end of file
@@ -0,0 +1,135 @@
+#pragma once
+
+#include "MemoryMappedFile.h"
+#include <cstdint>
+#include <string>
+#include <vector>
+#include <iostream>
+
+namespace Library
+{
+	class ThreadPool;
+
+	/**
+	* The header at the start of a compiled VSOP87 file. The series records follow it, then the amplitudes, phases and
+	* frequencies of every term as three separate arrays of doubles.
+	*/
+	struct Vsop87Header
+	{
+		std::uint32_t Magic;
+		std::uint32_t Version;
+		std::uint32_t Theory;			// The version letter of the source files, 'B' or 'D'
+		std::uint32_t SeriesCount;
+		std::uint32_t SeriesOffset;
+		std::uint32_t TermCount;
+		std::uint32_t TermsOffset;
+		std::uint32_t Reserved;
+	};
+
+	/**
+	* One series of periodic terms: the terms multiplied by a single power of time in one coordinate of one body.
+	* The terms of a series are stored by decreasing amplitude.
+	*/
+	struct Vsop87Series
+	{
+		std::uint32_t Body;
+		std::uint32_t Variable;			// 0 for the longitude, 1 for the latitude, 2 for the radius
+		std::uint32_t Power;
+		std::uint32_t FirstTerm;
+		std::uint32_t TermCount;
+		std::uint32_t Reserved;
+	};
+
+	static_assert(sizeof(Vsop87Header) == 32, "Vsop87Header must match the file layout.");
+	static_assert(sizeof(Vsop87Series) == 24, "Vsop87Series must match the file layout.");
+
+	/**
+	* Heliocentric spherical coordinates of a planet.
+	*/
+	struct Vsop87Coordinates
+	{
+		double Longitude;				// Radians, in [0, 2pi)
+		double Latitude;				// Radians
+		double Radius;					// Astronomical units
+	};
+
+	/**
+	* Evaluates the VSOP87 theory of Bretagnon and Francou for the heliocentric positions of the eight planets.
+	* The coefficient tables are compiled offline from the published VSOP87B or VSOP87D files into a binary file that is
+	* memory-mapped and used in place. Each coordinate is the sum over powers of time of series of terms A cos(B + C t),
+	* summed here across lanes of terms with branchless cosines so the compiler can vectorize the sum.
+	*
+	* Terms with an amplitude below the truncation threshold are skipped. As the terms are sorted by amplitude, this
+	* only shortens each series, and the threshold can be changed at any time to trade accuracy against cost.
+	*/
+	class Vsop87Theory final
+	{
+	public:
+		Vsop87Theory(const std::wstring& filename);
+		Vsop87Theory(const Vsop87Theory&) = delete;
+		Vsop87Theory& operator=(const Vsop87Theory&) = delete;
+		Vsop87Theory(Vsop87Theory&&) = default;
+		Vsop87Theory& operator=(Vsop87Theory&&) = default;
+		~Vsop87Theory() = default;
+
+		/**
+		* The version letter of the theory: 'B' for coordinates referred to the ecliptic and equinox of J2000, or 'D' for
+		* the ecliptic and equinox of the date.
+		*/
+		char Theory() const;
+		std::uint32_t TermCount() const;
+		/**
+		* Get the number of terms summed at the current truncation threshold.
+		*/
+		std::uint32_t ActiveTermCount() const;
+
+		double Truncation() const;
+		/**
+		* Skip the terms whose amplitude is below a threshold.
+		* @param amplitude The threshold, in radians for the angles and astronomical units for the radius. Zero sums every term.
+		*/
+		void SetTruncation(double amplitude);
+
+		/**
+		* Evaluate the position of a planet.
+		* @param body The index of the planet, from Mercury at 0 to Neptune at 7.
+		* @param julianDate The time as a Julian date in dynamical time.
+		*/
+		Vsop87Coordinates Evaluate(std::uint32_t body, double julianDate) const;
+		/**
+		* Evaluate the positions of a planet at many times, split across the cores of a thread pool.
+		* @param results An array of count coordinates that receives one position per time.
+		*/
+		void EvaluateBatch(std::uint32_t body, const double* julianDates, std::uint32_t count, Vsop87Coordinates* results, ThreadPool& threadPool) const;
+
+		/**
+		* Find a planet by name, ignoring case.
+		* @return The index of the planet, or -1 if the theory does not cover it.
+		*/
+		static std::int32_t BodyIndex(const std::string& name);
+
+		/**
+		* Compile VSOP87 source files into the binary format. Files for several planets may be concatenated into the source.
+		* Only the spherical versions B and D are accepted, and all of the source must be of the same version.
+		*/
+		static void Compile(std::istream& source, std::ostream& destination);
+
+		static const std::uint32_t Magic;
+		static const std::uint32_t Version;
+		static const std::uint32_t BodyCount;
+
+	private:
+		double Sum(std::uint32_t series, double tau) const;
+
+		MemoryMappedFile mFile;
+		const Vsop87Header* mHeader;
+		const Vsop87Series* mSeries;
+		const double* mAmplitudes;
+		const double* mPhases;
+		const double* mFrequencies;
+
+		std::vector<std::int32_t> mSeriesIndices;		// By body, variable and power, or -1 where a series is absent
+		std::vector<std::uint32_t> mActiveTermCounts;	// By series
+		double mTruncation;
+	};
+}
\ No newline at end of file
@@ -0,0 +1,68 @@
+#include "pch.h"
+
+using namespace std;
+using namespace Microsoft::WRL;
+
+namespace Library
+{
+	namespace
+	{
+		/**
+		* Keeps COM initialized on the calling thread for as long as it lives, leaving alone a thread that already set it up.
+		*/
+		class ComScope final
+		{
+		public:
+			ComScope() :
+				mResult(CoInitializeEx(nullptr, COINIT_MULTITHREADED))
+			{
+			}
+
+			ComScope(const ComScope&) = delete;
+			ComScope& operator=(const ComScope&) = delete;
+
+			~ComScope()
+			{
+				if (SUCCEEDED(mResult))
+				{
+					CoUninitialize();
+				}
+			}
+
+		private:
+			HRESULT mResult;
+		};
+	}
+
+	DecodedImage WicImageDecoder::Decode(const vector<uint8_t>& contents)
+	{
+		// Declared first so every interface below is released before COM is
+		ComScope comScope;
+
+		ComPtr<IWICImagingFactory> imagingFactory;
+		ThrowIfFailed(CoCreateInstance(CLSID_WICImagingFactory, nullptr, CLSCTX_INPROC_SERVER, IID_PPV_ARGS(imagingFactory.GetAddressOf())), "CoCreateInstance() failed.");
+
+		ComPtr<IWICStream> stream;
+		ThrowIfFailed(imagingFactory->CreateStream(stream.GetAddressOf()), "IWICImagingFactory::CreateStream() failed.");
+		ThrowIfFailed(stream->InitializeFromMemory(const_cast<BYTE*>(contents.data()), static_cast<DWORD>(contents.size())), "IWICStream::InitializeFromMemory() failed.");
+
+		ComPtr<IWICBitmapDecoder> decoder;
+		ThrowIfFailed(imagingFactory->CreateDecoderFromStream(stream.Get(), nullptr, WICDecodeMetadataCacheOnDemand, decoder.GetAddressOf()), "IWICImagingFactory::CreateDecoderFromStream() failed.");
+
+		ComPtr<IWICBitmapFrameDecode> frame;
+		ThrowIfFailed(decoder->GetFrame(0, frame.GetAddressOf()), "IWICBitmapDecoder::GetFrame() failed.");
+
+		ComPtr<IWICFormatConverter> converter;
+		ThrowIfFailed(imagingFactory->CreateFormatConverter(converter.GetAddressOf()), "IWICImagingFactory::CreateFormatConverter() failed.");
+		ThrowIfFailed(converter->Initialize(frame.Get(), GUID_WICPixelFormat32bppRGBA, WICBitmapDitherTypeNone, nullptr, 0.0, WICBitmapPaletteTypeCustom), "IWICFormatConverter::Initialize() failed.");
+
+		DecodedImage image;
+		ThrowIfFailed(converter->GetSize(&image.Width, &image.Height), "IWICFormatConverter::GetSize() failed.");
+
+		const UINT rowPitch = image.Width * 4;
+		image.Pixels.resize(static_cast<size_t>(rowPitch) * image.Height);
+		ThrowIfFailed(converter->CopyPixels(nullptr, rowPitch, static_cast<UINT>(image.Pixels.size()), image.Pixels.data()), "IWICFormatConverter::CopyPixels() failed.");
+
+		return image;
+	}
+}
\ No newline at end of file
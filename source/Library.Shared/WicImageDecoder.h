@@ -0,0 +1,24 @@
+#pragma once
+
+#include "TextureCache.h"
+#include <vector>
+#include <cstdint>
+
+namespace Library
+{
+	/**
+	* Decodes any image format Windows Imaging Component reads, for the texture cache. Safe to call from any thread.
+	*/
+	class WicImageDecoder final
+	{
+	public:
+		static DecodedImage Decode(const std::vector<std::uint8_t>& contents);
+
+		WicImageDecoder() = delete;
+		WicImageDecoder(const WicImageDecoder&) = delete;
+		WicImageDecoder& operator=(const WicImageDecoder&) = delete;
+		WicImageDecoder(WicImageDecoder&&) = delete;
+		WicImageDecoder& operator=(WicImageDecoder&&) = delete;
+		~WicImageDecoder() = default;
+	};
+}
\ No newline at end of file
@@ -1,8 +1,85 @@
 #pragma once
 
+#if defined(LIBRARY_PORTABLE)
+
+// The parts of the library without a window or a graphics device, built on any platform by CMake
+
+// Standard
+#include <exception>
+#include <stdexcept>
+#include <cassert>
+#include <string>
+#include <iostream>
+#include <sstream>
+#include <fstream>
+#include <memory>
+#include <vector>
+#include <map>
+#include <cstdint>
+#include <iomanip>
+#include <codecvt>
+#include <locale>
+#include <algorithm>
+#include <functional>
+#include <atomic>
+#include <limits>
+#include <cstring>
+#include <cmath>
+#include <cfloat>
+
+// Local
+#include "Platform.h"
+
+#if defined(LIBRARY_HAS_DIRECTXMATH)
+#include <DirectXMath.h>
+#endif
+
+#include "RTTI.h"
+#include "GameException.h"
+#include "Utility.h"
+#include "TextureCache.h"
+#include "QoiImageEncoder.h"
+#include "RenderQueue.h"
+#include "RecordingRenderBackend.h"
+#include "RenderDevice.h"
+#include "RecordingRenderDevice.h"
+#include "DeviceRenderBackend.h"
+#include "FrameConstantAllocator.h"
+#include "MemoryConstantBufferStorage.h"
+#include "DeviceConstantBufferStorage.h"
+#include "ThreadPool.h"
+#include "MemoryMappedFile.h"
+#include "SharedMemoryRegion.h"
+#include "SpscRingBuffer.h"
+#include "BodyCatalog.h"
+#include "MinorPlanetCatalog.h"
+#include "Vsop87Theory.h"
+#include "LaneMath.h"
+#include "AngleAccumulator.h"
+
+#if defined(LIBRARY_HAS_IMAGE_DECODER)
+#include "PortableImageDecoder.h"
+#endif
+
+#if defined(LIBRARY_HAS_DIRECTXMATH)
+#include "MatrixHelper.h"
+#include "VectorHelper.h"
+#include "StreamHelper.h"
+#include "Model.h"
+#include "ModelMaterial.h"
+#include "Mesh.h"
+#include "VertexDeclarations.h"
+#include "SoftwareTexture.h"
+#include "SoftwareRasterizer.h"
+#include "SoftwareSkyboxShader.h"
+#endif
+
+#else
+
 // Windows
 #include <windows.h>
 #include <wrl.h>
+#include <wincodec.h>
 
 // Standard
 #include <exception>
@@ -20,6 +97,9 @@
 #include <codecvt>
 #include <algorithm>
 #include <functional>
+#include <atomic>
+#include <limits>
+#include <cstring>
 
 #if defined(DEBUG) || defined(_DEBUG)
 #define _CRTDBG_MAP_ALLOC
@@ -69,17 +149,45 @@
 #include "RasterizerStates.h"
 #include "SamplerStates.h"
 #include "RenderStateHelper.h"
+#include "TextOverlay.h"
 #include "FpsComponent.h"
 #include "StreamHelper.h"
 #include "Model.h"
 #include "Mesh.h"
 #include "ModelMaterial.h"
+#include "ModelCache.h"
+#include "TextureCache.h"
+#include "WicImageDecoder.h"
+#include "QoiImageEncoder.h"
+#include "RenderQueue.h"
+#include "RecordingRenderBackend.h"
+#include "RenderDevice.h"
+#include "D3D11RenderDevice.h"
+#include "RecordingRenderDevice.h"
+#include "DeviceRenderBackend.h"
+#include "FrameConstantAllocator.h"
+#include "MemoryConstantBufferStorage.h"
+#include "DeviceConstantBufferStorage.h"
+#include "SoftwareTexture.h"
+#include "SoftwareRasterizer.h"
+#include "SoftwareSkyboxShader.h"
 #include "ProxyModel.h"
 #include "Skybox.h"
 #include "MouseComponent.h"
 #include "KeyboardComponent.h"
 #include "GamePadComponent.h"
 #include "Grid.h"
+#include "MemoryMappedFile.h"
+#include "BodyCatalog.h"
+#include "SharedMemoryRegion.h"
+#include "SpscRingBuffer.h"
+#include "ThreadPool.h"
+#include "MinorPlanetCatalog.h"
+#include "LaneMath.h"
+#include "Vsop87Theory.h"
+#include "AngleAccumulator.h"
+
+#endif
 
 namespace Library
 {
@@ -2,75 +2,38 @@
 #pragma once
 
 #include "DrawableGameComponent.h"
-#include "RenderStateHelper.h"
 #include <DirectXMath.h>
 #include <DirectXColors.h>
-#include <unordered_map>
 
 namespace Library
 {
 	class Mesh;
-	class KeyboardComponent;
-}
-
-namespace DirectX
-{
-	class SpriteBatch;
-	class SpriteFont;
+	class BodyCatalog;
+	struct BodyCatalogRecord;
 }
 
 namespace Rendering
 {
-	/**
-	* An enum with all astronomical object names.
-	*/
-	enum class AstronomicalObjectName
-	{
-		Invalid,
-		Sun,
-		Mercury,
-		Venus,
-		Earth,
-		Moon,
-		Mars,
-		Jupiter,
-		Saturn,
-		Uranus,
-		Neptune,
-		Pluto
-	};
-
-	/**
-	* Data associated with each astronomical object.
-	*/
-	struct AstronomicalObjectData
-	{
-		float AmbientIntensity;
-		float AxialTilt; // ƫת
-		float RotationDays;
-		float RevolutionDays;
-		float OrbitalDistance;
-		float Scale;
-		std::wstring TextureName;
-	};
+	class ReferenceFrameGraph;
+	class ShadowOccluderPass;
+	class PlanetRenderer;
 
 	/**
 	* A class for drawing astronomical objects such as planets and their moons and the Sun.
+	* The object registers its texture and the sphere levels of detail with the planet renderer and submits itself as
+	* an instance every frame it is visible, with the level its size on the screen calls for; the renderer draws all
+	* objects sharing a level at once.
 	*/
 	class AstronomicalObject final : public Library::DrawableGameComponent
 	{
 		RTTI_DECLARATIONS(AstronomicalObject, Library::DrawableGameComponent)
 
 	public:
-		AstronomicalObject(Library::Game& game, const std::shared_ptr<Library::Camera>& camera, AstronomicalObjectName name);
-		~AstronomicalObject();
-
-		bool AnimationEnabled() const;
-		void SetAnimationEnabled(bool enabled);
+		AstronomicalObject(Library::Game& game, const std::shared_ptr<Library::Camera>& camera, const Library::BodyCatalog& catalog, std::uint32_t catalogIndex, const ReferenceFrameGraph& referenceFrames, PlanetRenderer& renderer);
+		~AstronomicalObject() = default;
 
 		virtual void Initialize() override;
 		virtual void Update(const Library::GameTime& gameTime) override;
-		virtual void Draw(const Library::GameTime& gameTime) override;
 
 		/**
 		* Get the point light which is illumiating this astronomical object.
@@ -92,97 +55,52 @@ namespace Rendering
 		* @param parent A reference to a parent object to set.
 		*/
 		void SetParentObject(const AstronomicalObject& parent);
-
-	private:
 		/**
-		* Update the degrees of the rotation and revolution of this astronomical object.
-		* @param gameTime A game time object with data about time elapsed.
+		* Get the radius of this astronomical object as drawn, in scene units. Valid after Initialize().
 		*/
-		void UpdateAstronomicalObjectRotation(const Library::GameTime& gameTime);
-		void CreateVertexBuffer(const Library::Mesh& mesh, ID3D11Buffer** vertexBuffer) const;
-		void ToggleAnimation();
-		struct VSCBufferPerFrame
-		{
-			DirectX::XMFLOAT3 LightPosition;
-			float LightRadius;
-
-			VSCBufferPerFrame() :
-				LightPosition(Library::Vector3Helper::Zero), LightRadius(50.0f) { }
-			VSCBufferPerFrame(const DirectX::XMFLOAT3 lightPosition, float lightRadius) :
-				LightPosition(lightPosition), LightRadius(lightRadius) { }
-		};
-
-		struct VSCBufferPerObject
-		{
-			DirectX::XMFLOAT4X4 WorldViewProjection;
-			DirectX::XMFLOAT4X4 World;
-
-			VSCBufferPerObject() = default;
-			VSCBufferPerObject(const DirectX::XMFLOAT4X4& wvp, const DirectX::XMFLOAT4X4& world) :
-				WorldViewProjection(wvp), World(world) { }
-		};
-
-		struct PSCBufferPerFrame
-		{
-			DirectX::XMFLOAT3 AmbientColor;
-			float Padding;
-			DirectX::XMFLOAT3 LightPosition;
-			float Padding2;
-			DirectX::XMFLOAT3 LightColor;
-			float Padding3;
-
-			PSCBufferPerFrame() :
-				AmbientColor(Library::Vector3Helper::Zero), LightPosition(Library::Vector3Helper::Zero), LightColor(Library::Vector3Helper::Zero)
-			{
-			}
-
-			PSCBufferPerFrame(const DirectX::XMFLOAT3& ambientColor, const DirectX::XMFLOAT3& lightPosition, const DirectX::XMFLOAT3& lightColor) :
-				AmbientColor(ambientColor), LightPosition(lightPosition), LightColor(lightColor)
-			{
-			}
-		};
+		float Radius() const;
+		/**
+		* Get the index of this astronomical object within the body catalog.
+		*/
+		std::uint32_t CatalogIndex() const;
+		/**
+		* Set the pass that finds the bodies casting shadows on this astronomical object each frame.
+		* @param shadowOccluderPass A reference to the shadow occluder pass.
+		*/
+		void SetShadowOccluders(const ShadowOccluderPass& shadowOccluderPass);
 
-		PSCBufferPerFrame mPSCBufferPerFrameData;
+	private:
 		DirectX::XMFLOAT4X4 mWorldMatrix;
-		VSCBufferPerFrame mVSCBufferPerFrameData;
-		VSCBufferPerObject mVSCBufferPerObjectData;
-		Library::RenderStateHelper mRenderStateHelper;
-		Microsoft::WRL::ComPtr<ID3D11VertexShader> mVertexShader;
-		Microsoft::WRL::ComPtr<ID3D11PixelShader> mPixelShader;
-		Microsoft::WRL::ComPtr<ID3D11InputLayout> mInputLayout;
-		Microsoft::WRL::ComPtr<ID3D11Buffer> mVertexBuffer;
-		Microsoft::WRL::ComPtr<ID3D11Buffer> mIndexBuffer;
-		Microsoft::WRL::ComPtr<ID3D11Buffer> mVSCBufferPerFrame;
-		Microsoft::WRL::ComPtr<ID3D11Buffer> mVSCBufferPerObject;
-		Microsoft::WRL::ComPtr<ID3D11Buffer> mPSCBufferPerFrame;
-		Microsoft::WRL::ComPtr<ID3D11ShaderResourceView> mColorTexture;
-		Library::KeyboardComponent* mKeyboard;
-		std::uint32_t mIndexCount;
-		std::unique_ptr<DirectX::SpriteBatch> mSpriteBatch;
-		std::unique_ptr<DirectX::SpriteFont> mSpriteFont;
-		DirectX::XMFLOAT2 mTextPosition;
-		bool mAnimationEnabled;
+		float mModelRadius;
 
 		/**
-		* The name of this astronomical object.
+		* The catalog describing this astronomical object.
 		*/
-		AstronomicalObjectName mAstronomicalObjectName;
+		const Library::BodyCatalog* mCatalog;
 		/**
-		* The current rotation of this astronomical object about its own Y-axis.
+		* The index of this astronomical object within the catalog.
 		*/
-		float mCurrentRotationDegrees;
+		std::uint32_t mCatalogIndex;
 		/**
-		* The rate at which this astronomical object rotates (degrees to rotate each second).
+		* The catalog record with the properties of this astronomical object.
 		*/
-		float mRotationRate;
+		const Library::BodyCatalogRecord* mData;
 		/**
-		* The current revolution of this astronomical object.
+		* The renderer drawing this astronomical object, the mesh of the coarsest sphere level and the texture slice it
+		* was registered with, and the level it was last drawn with.
 		*/
-		float mCurrentRevolutionDegrees;
+		PlanetRenderer* mRenderer;
+		std::uint32_t mMesh;
+		std::uint32_t mTextureSlice;
+		std::uint32_t mLodLevel;
 		/**
-		* The rate at wgucg tgus astronomical object rotates (degrees to revolve each second).
+		* The reference frames providing the body-fixed frame of this astronomical object, from its position, tilt and rotation.
 		*/
-		float mRevolutionRate;
+		const ReferenceFrameGraph* mReferenceFrames;
+		/**
+		* The point light emitted by this astronomical object, if it is a light source.
+		*/
+		std::unique_ptr<Library::PointLight> mEmittedLight;
 		/**
 		* A pointer to the point light illuminating this astronomical object.
 		*/
@@ -191,11 +109,11 @@ namespace Rendering
 		* A pointer to the parent astronomical obejct. This object revolves around the parent (for example, the moon).
 		*/
 		const AstronomicalObject* mParent;
-	public:
 		/**
-		* A map of astronomical object names as keys to access their corresponding properties data.
+		* A pointer to the pass providing the bodies that can cast a shadow on this astronomical object.
 		*/
-		static const std::unordered_map<AstronomicalObjectName, AstronomicalObjectData> sAstronomicalObjects;
+		const ShadowOccluderPass* mShadowOccluderPass;
+	public:
 		/**
 		* The default position at which the light is to be positioned on start.
 		*/
@@ -204,5 +122,14 @@ namespace Rendering
 		* The range of the light in atomic units in order to attenuate the light over distance.
 		*/
 		static const float sLightRangeAU;
+		/**
+		* The sphere model astronomical objects are drawn with by the software rasterizer.
+		*/
+		static const std::string sModelFileName;
+		/**
+		* The radius of the spheres every astronomical object is drawn with, in model units; that of the model, which the
+		* scales of the catalog were chosen for.
+		*/
+		static const float sSphereRadius;
 	};
 }
@@ -0,0 +1,565 @@
+#include "pch.h"
+
+using namespace std;
+using namespace Library;
+
+namespace Rendering
+{
+	namespace
+	{
+		const double DegreesToRadians = 3.14159265358979323846 / 180.0;
+		const double KilometresPerAstronomicalUnit = 149597870.7;
+		const uint32_t MaxRootIterations = 100;
+		const uint32_t MaxContactSteps = 1024;
+
+		// The smallest ratio of the disk of a body to that of the light source it crosses for the crossing to be an
+		// eclipse rather than a transit; the Moon covers 0.9 of the Sun in the most annular of solar eclipses
+		const double EclipseRadiusRatio = 0.9;
+
+		/**
+		* The rate of change of the cosine of the angle between two vectors from an observer. It falls through zero at
+		* every closest approach.
+		*/
+		inline double CosineRate(double ax, double ay, double az, double avx, double avy, double avz, double bx, double by, double bz, double bvx, double bvy, double bvz)
+		{
+			double aa = ax * ax + ay * ay + az * az;
+			double bb = bx * bx + by * by + bz * bz;
+			double ab = ax * bx + ay * by + az * bz;
+			double abRate = avx * bx + avy * by + avz * bz + ax * bvx + ay * bvy + az * bvz;
+			double aaRate = ax * avx + ay * avy + az * avz;
+			double bbRate = bx * bvx + by * bvy + bz * bvz;
+
+			return (abRate - ab * (aaRate / aa + bbRate / bb)) / sqrt(aa * bb);
+		}
+
+		/**
+		* Add the position and velocity of a body on a circular orbit about its parent, as SolarSystemSimulation places
+		* it. The revolution is measured from the ascending node in the orbital plane, and the node from the X axis in
+		* the ecliptic; the node turns about the Y axis at its own rate.
+		*/
+		inline void AddOrbit(double distance, double revolution, double angularVelocity, double inclination, double node, double nodalVelocity,
+			double& x, double& y, double& z, double& vx, double& vy, double& vz)
+		{
+			double alongNode = distance * cos(revolution - node);
+			double acrossNode = distance * sin(revolution - node);
+			double alongNodeRate = -acrossNode * (angularVelocity - nodalVelocity);
+			double acrossNodeRate = alongNode * (angularVelocity - nodalVelocity);
+			double nodeCos = cos(node);
+			double nodeSin = sin(node);
+			double inclinationCos = cos(inclination);
+			double inclinationSin = sin(inclination);
+
+			x += alongNode * nodeCos - acrossNode * inclinationCos * nodeSin;
+			y += acrossNode * inclinationSin;
+			z += -alongNode * nodeSin - acrossNode * inclinationCos * nodeCos;
+			vx += alongNodeRate * nodeCos - acrossNodeRate * inclinationCos * nodeSin - (alongNode * nodeSin + acrossNode * inclinationCos * nodeCos) * nodalVelocity;
+			vy += acrossNodeRate * inclinationSin;
+			vz += -alongNodeRate * nodeSin - acrossNodeRate * inclinationCos * nodeCos + (-alongNode * nodeCos + acrossNode * inclinationCos * nodeSin) * nodalVelocity;
+		}
+
+		/**
+		* Find a root of a function bracketed by a sign change with Brent's method, which combines inverse quadratic
+		* interpolation and the secant method with bisection as a fallback.
+		*/
+		template <typename Function>
+		double FindRoot(const Function& function, double a, double b, double fa, double fb, double tolerance)
+		{
+			double c = b;
+			double fc = fb;
+			double d = b - a;
+			double e = d;
+
+			for (uint32_t i = 0; i < MaxRootIterations; ++i)
+			{
+				if ((fb > 0.0 && fc > 0.0) || (fb < 0.0 && fc < 0.0))
+				{
+					c = a;
+					fc = fa;
+					d = b - a;
+					e = d;
+				}
+
+				if (fabs(fc) < fabs(fb))
+				{
+					a = b;
+					b = c;
+					c = a;
+					fa = fb;
+					fb = fc;
+					fc = fa;
+				}
+
+				double step = 2.0 * numeric_limits<double>::epsilon() * fabs(b) + 0.5 * tolerance;
+				double middle = 0.5 * (c - b);
+				if (fabs(middle) <= step || fb == 0.0)
+				{
+					return b;
+				}
+
+				if (fabs(e) >= step && fabs(fa) > fabs(fb))
+				{
+					double s = fb / fa;
+					double p;
+					double q;
+					if (a == c)
+					{
+						p = 2.0 * middle * s;
+						q = 1.0 - s;
+					}
+					else
+					{
+						double r = fb / fc;
+						q = fa / fc;
+						p = s * (2.0 * middle * q * (q - r) - (b - a) * (r - 1.0));
+						q = (q - 1.0) * (r - 1.0) * (s - 1.0);
+					}
+
+					if (p > 0.0)
+					{
+						q = -q;
+					}
+					p = fabs(p);
+
+					double interpolationLimit = 3.0 * middle * q - fabs(step * q);
+					double previousLimit = fabs(e * q);
+					if (2.0 * p < (interpolationLimit < previousLimit ? interpolationLimit : previousLimit))
+					{
+						e = d;
+						d = p / q;
+					}
+					else
+					{
+						d = middle;
+						e = d;
+					}
+				}
+				else
+				{
+					d = middle;
+					e = d;
+				}
+
+				a = b;
+				fa = fb;
+				b += (fabs(d) > step ? d : (middle >= 0.0 ? step : -step));
+				fb = function(b);
+			}
+
+			return b;
+		}
+
+		/**
+		* Walk away from a time inside an overlap until the overlap ends, then refine the contact.
+		* @param overlap Negative while the disks overlap.
+		* @param step The signed distance of each step.
+		*/
+		template <typename Function>
+		double FindContact(const Function& overlap, double inside, double insideValue, double step, double tolerance)
+		{
+			for (uint32_t i = 0; i < MaxContactSteps; ++i)
+			{
+				double outside = inside + step;
+				double outsideValue = overlap(outside);
+				if (outsideValue > 0.0)
+				{
+					return FindRoot(overlap, inside, outside, insideValue, outsideValue, tolerance);
+				}
+
+				inside = outside;
+				insideValue = outsideValue;
+			}
+
+			return inside;
+		}
+	}
+
+	const uint32_t EventFinder::ChunksPerThread = 4;
+
+	EventFinder::EventFinder(const BodyCatalog& catalog, ThreadPool& threadPool) :
+		mCatalog(&catalog), mThreadPool(&threadPool)
+	{
+		uint32_t count = catalog.Count();
+		mParentIndices.resize(count);
+		mOrbitalDistances.resize(count);
+		mRevolutionRates.resize(count);
+		mInclinations.resize(count);
+		mAscendingNodes.resize(count);
+		mNodalRates.resize(count);
+		mRadii.resize(count);
+		mLightSources.resize(count);
+
+		for (uint32_t i = 0; i < count; ++i)
+		{
+			const BodyCatalogRecord& record = catalog.Record(i);
+			mParentIndices[i] = record.ParentIndex;
+			mOrbitalDistances[i] = record.TrueDistance;
+			mRevolutionRates[i] = (record.RevolutionDays > 0.0f ? 360.0 / record.RevolutionDays : 0.0);
+			mInclinations[i] = record.Inclination * DegreesToRadians;
+			mAscendingNodes[i] = record.AscendingNode;
+			mNodalRates[i] = (record.NodalPeriodDays != 0.0f ? 360.0 / record.NodalPeriodDays : 0.0);
+			mRadii[i] = record.Radius / KilometresPerAstronomicalUnit;
+			mLightSources[i] = record.HasFlag(BodyFlags::LightSource);
+		}
+	}
+
+	vector<AstronomicalEvent> EventFinder::Find(const EventSearchSettings& settings) const
+	{
+		if (settings.EndDays <= settings.StartDays || settings.GridStepDays <= 0.0 || settings.ToleranceDays <= 0.0)
+		{
+			throw GameException("The event search span, grid step or tolerance is invalid.");
+		}
+
+		uint32_t bodyCount = mCatalog->Count();
+		vector<uint32_t> observers = settings.Observers;
+		if (observers.empty())
+		{
+			for (uint32_t i = 0; i < bodyCount; ++i)
+			{
+				if (mLightSources[i] == false)
+				{
+					observers.push_back(i);
+				}
+			}
+		}
+
+		vector<BodyTriple> triples;
+		for (uint32_t observer : observers)
+		{
+			if (observer >= bodyCount)
+			{
+				throw GameException("An event search observer is not in the catalog.");
+			}
+
+			for (uint32_t first = 0; first < bodyCount; ++first)
+			{
+				for (uint32_t second = first + 1; second < bodyCount; ++second)
+				{
+					if (first != observer && second != observer)
+					{
+						triples.push_back({ observer, first, second });
+					}
+				}
+			}
+		}
+
+		uint32_t intervalCount = static_cast<uint32_t>(ceil((settings.EndDays - settings.StartDays) / settings.GridStepDays));
+		uint32_t chunkCount = min(intervalCount, mThreadPool->ThreadCount() * ChunksPerThread);
+		uint32_t intervalsPerChunk = (intervalCount + chunkCount - 1) / chunkCount;
+
+		vector<vector<AstronomicalEvent>> chunkEvents(chunkCount);
+		mThreadPool->ParallelFor(chunkCount, 1, [&](uint32_t begin, uint32_t end)
+		{
+			for (uint32_t chunk = begin; chunk < end; ++chunk)
+			{
+				uint32_t firstInterval = chunk * intervalsPerChunk;
+				uint32_t endInterval = min(firstInterval + intervalsPerChunk, intervalCount);
+				if (firstInterval < endInterval)
+				{
+					SearchChunk(settings, triples, firstInterval, endInterval, chunkEvents[chunk]);
+				}
+			}
+		});
+
+		vector<AstronomicalEvent> events;
+		for (const vector<AstronomicalEvent>& chunk : chunkEvents)
+		{
+			events.insert(events.end(), chunk.begin(), chunk.end());
+		}
+
+		sort(events.begin(), events.end(), [](const AstronomicalEvent& lhs, const AstronomicalEvent& rhs)
+		{
+			if (lhs.PeakDays != rhs.PeakDays)
+			{
+				return lhs.PeakDays < rhs.PeakDays;
+			}
+
+			if (lhs.Observer != rhs.Observer)
+			{
+				return lhs.Observer < rhs.Observer;
+			}
+
+			return (lhs.Near != rhs.Near ? lhs.Near < rhs.Near : lhs.Far < rhs.Far);
+		});
+
+		return events;
+	}
+
+	void EventFinder::WriteEvents(const wstring& filename, const vector<AstronomicalEvent>& events) const
+	{
+#if defined(_WIN32)
+		ofstream stream(filename.c_str());
+#else
+		ofstream stream(Utility::ToPortablePath(filename));
+#endif
+		if (stream.is_open() == false)
+		{
+			throw GameException("Could not open the events file.");
+		}
+
+		stream << "Type,Observer,Near,Far,BeginDays,PeakDays,EndDays,SeparationDegrees" << endl;
+		stream << fixed << setprecision(6);
+		for (const AstronomicalEvent& event : events)
+		{
+			stream << TypeName(event.Type) << ',' << mCatalog->Name(event.Observer) << ',' << mCatalog->Name(event.Near) << ',' << mCatalog->Name(event.Far) << ','
+				<< event.BeginDays << ',' << event.PeakDays << ',' << event.EndDays << ',' << event.SeparationDegrees << endl;
+		}
+	}
+
+	const char* EventFinder::TypeName(AstronomicalEventType type)
+	{
+		switch (type)
+		{
+		case AstronomicalEventType::Conjunction:
+			return "Conjunction";
+
+		case AstronomicalEventType::Eclipse:
+			return "Eclipse";
+
+		case AstronomicalEventType::Transit:
+			return "Transit";
+
+		case AstronomicalEventType::Occultation:
+			return "Occultation";
+
+		default:
+			return "Unknown";
+		}
+	}
+
+	EventSearchSettings EventFinder::DefaultSettings(double startDays, double endDays)
+	{
+		EventSearchSettings settings;
+		settings.StartDays = startDays;
+		settings.EndDays = endDays;
+		settings.GridStepDays = 0.25;
+		settings.ToleranceDays = 1.0e-6;
+		settings.ConjunctionDegrees = 1.0;
+
+		return settings;
+	}
+
+	void EventFinder::EvaluateBody(uint32_t index, double days, BodyState& state) const
+	{
+		state.X = 0.0;
+		state.Y = 0.0;
+		state.Z = 0.0;
+		state.VelocityX = 0.0;
+		state.VelocityY = 0.0;
+		state.VelocityZ = 0.0;
+
+		for (int32_t body = static_cast<int32_t>(index); body >= 0; body = mParentIndices[body])
+		{
+			double revolution = fmod(mRevolutionRates[body] * days, 360.0) * DegreesToRadians;
+			double node = (mAscendingNodes[body] + fmod(mNodalRates[body] * days, 360.0)) * DegreesToRadians;
+			AddOrbit(mOrbitalDistances[body], revolution, mRevolutionRates[body] * DegreesToRadians, mInclinations[body], node, mNodalRates[body] * DegreesToRadians,
+				state.X, state.Y, state.Z, state.VelocityX, state.VelocityY, state.VelocityZ);
+		}
+	}
+
+	void EventFinder::EvaluateGrid(const vector<double>& times, StateGrid& grid) const
+	{
+		uint32_t bodyCount = static_cast<uint32_t>(mParentIndices.size());
+		uint32_t timeCount = static_cast<uint32_t>(times.size());
+		size_t size = static_cast<size_t>(bodyCount) * timeCount;
+
+		grid.TimeCount = timeCount;
+		grid.PositionsX.assign(size, 0.0);
+		grid.PositionsY.assign(size, 0.0);
+		grid.PositionsZ.assign(size, 0.0);
+		grid.VelocitiesX.assign(size, 0.0);
+		grid.VelocitiesY.assign(size, 0.0);
+		grid.VelocitiesZ.assign(size, 0.0);
+
+		// The catalog lists parents before their children, so a parent's states are complete before they are added
+		for (uint32_t i = 0; i < bodyCount; ++i)
+		{
+			double distance = mOrbitalDistances[i];
+			double rate = mRevolutionRates[i];
+			double angularVelocity = rate * DegreesToRadians;
+			double inclination = mInclinations[i];
+			double ascendingNode = mAscendingNodes[i];
+			double nodalRate = mNodalRates[i];
+			double nodalVelocity = nodalRate * DegreesToRadians;
+
+			double* x = &grid.PositionsX[static_cast<size_t>(i) * timeCount];
+			double* y = &grid.PositionsY[static_cast<size_t>(i) * timeCount];
+			double* z = &grid.PositionsZ[static_cast<size_t>(i) * timeCount];
+			double* vx = &grid.VelocitiesX[static_cast<size_t>(i) * timeCount];
+			double* vy = &grid.VelocitiesY[static_cast<size_t>(i) * timeCount];
+			double* vz = &grid.VelocitiesZ[static_cast<size_t>(i) * timeCount];
+			for (uint32_t k = 0; k < timeCount; ++k)
+			{
+				double revolution = fmod(rate * times[k], 360.0) * DegreesToRadians;
+				double node = (ascendingNode + fmod(nodalRate * times[k], 360.0)) * DegreesToRadians;
+				AddOrbit(distance, revolution, angularVelocity, inclination, node, nodalVelocity, x[k], y[k], z[k], vx[k], vy[k], vz[k]);
+			}
+
+			int32_t parent = mParentIndices[i];
+			if (parent >= 0)
+			{
+				const double* parentX = &grid.PositionsX[static_cast<size_t>(parent) * timeCount];
+				const double* parentY = &grid.PositionsY[static_cast<size_t>(parent) * timeCount];
+				const double* parentZ = &grid.PositionsZ[static_cast<size_t>(parent) * timeCount];
+				const double* parentVx = &grid.VelocitiesX[static_cast<size_t>(parent) * timeCount];
+				const double* parentVy = &grid.VelocitiesY[static_cast<size_t>(parent) * timeCount];
+				const double* parentVz = &grid.VelocitiesZ[static_cast<size_t>(parent) * timeCount];
+				for (uint32_t k = 0; k < timeCount; ++k)
+				{
+					x[k] += parentX[k];
+					y[k] += parentY[k];
+					z[k] += parentZ[k];
+					vx[k] += parentVx[k];
+					vy[k] += parentVy[k];
+					vz[k] += parentVz[k];
+				}
+			}
+		}
+	}
+
+	EventFinder::Geometry EventFinder::EvaluateGeometry(const BodyTriple& triple, double days) const
+	{
+		BodyState observer;
+		BodyState first;
+		BodyState second;
+		EvaluateBody(triple.Observer, days, observer);
+		EvaluateBody(triple.First, days, first);
+		EvaluateBody(triple.Second, days, second);
+
+		double ax = first.X - observer.X;
+		double ay = first.Y - observer.Y;
+		double az = first.Z - observer.Z;
+		double bx = second.X - observer.X;
+		double by = second.Y - observer.Y;
+		double bz = second.Z - observer.Z;
+
+		double crossX = ay * bz - az * by;
+		double crossY = az * bx - ax * bz;
+		double crossZ = ax * by - ay * bx;
+
+		Geometry geometry;
+		geometry.SeparationRadians = atan2(sqrt(crossX * crossX + crossY * crossY + crossZ * crossZ), ax * bx + ay * by + az * bz);
+		geometry.FirstDistance = sqrt(ax * ax + ay * ay + az * az);
+		geometry.SecondDistance = sqrt(bx * bx + by * by + bz * bz);
+		geometry.FirstRadius = asin(min(mRadii[triple.First] / geometry.FirstDistance, 1.0));
+		geometry.SecondRadius = asin(min(mRadii[triple.Second] / geometry.SecondDistance, 1.0));
+
+		return geometry;
+	}
+
+	double EventFinder::SeparationCosineRate(const BodyTriple& triple, double days) const
+	{
+		BodyState observer;
+		BodyState first;
+		BodyState second;
+		EvaluateBody(triple.Observer, days, observer);
+		EvaluateBody(triple.First, days, first);
+		EvaluateBody(triple.Second, days, second);
+
+		return CosineRate(first.X - observer.X, first.Y - observer.Y, first.Z - observer.Z, first.VelocityX - observer.VelocityX, first.VelocityY - observer.VelocityY, first.VelocityZ - observer.VelocityZ,
+			second.X - observer.X, second.Y - observer.Y, second.Z - observer.Z, second.VelocityX - observer.VelocityX, second.VelocityY - observer.VelocityY, second.VelocityZ - observer.VelocityZ);
+	}
+
+	void EventFinder::SearchChunk(const EventSearchSettings& settings, const vector<BodyTriple>& triples, uint32_t firstInterval, uint32_t endInterval, vector<AstronomicalEvent>& events) const
+	{
+		// Grid point k is the start of interval firstInterval + k; the last point closes the final interval
+		uint32_t timeCount = endInterval - firstInterval + 1;
+		vector<double> times(timeCount);
+		for (uint32_t k = 0; k < timeCount; ++k)
+		{
+			times[k] = min(settings.StartDays + (firstInterval + k) * settings.GridStepDays, settings.EndDays);
+		}
+
+		StateGrid grid;
+		EvaluateGrid(times, grid);
+
+		vector<double> rates(timeCount);
+		for (const BodyTriple& triple : triples)
+		{
+			size_t observerOffset = static_cast<size_t>(triple.Observer) * timeCount;
+			size_t firstOffset = static_cast<size_t>(triple.First) * timeCount;
+			size_t secondOffset = static_cast<size_t>(triple.Second) * timeCount;
+			const double* x = grid.PositionsX.data();
+			const double* y = grid.PositionsY.data();
+			const double* z = grid.PositionsZ.data();
+			const double* vx = grid.VelocitiesX.data();
+			const double* vy = grid.VelocitiesY.data();
+			const double* vz = grid.VelocitiesZ.data();
+
+			for (uint32_t k = 0; k < timeCount; ++k)
+			{
+				double ox = x[observerOffset + k];
+				double oy = y[observerOffset + k];
+				double oz = z[observerOffset + k];
+				double ovx = vx[observerOffset + k];
+				double ovy = vy[observerOffset + k];
+				double ovz = vz[observerOffset + k];
+				rates[k] = CosineRate(x[firstOffset + k] - ox, y[firstOffset + k] - oy, z[firstOffset + k] - oz, vx[firstOffset + k] - ovx, vy[firstOffset + k] - ovy, vz[firstOffset + k] - ovz,
+					x[secondOffset + k] - ox, y[secondOffset + k] - oy, z[secondOffset + k] - oz, vx[secondOffset + k] - ovx, vy[secondOffset + k] - ovy, vz[secondOffset + k] - ovz);
+			}
+
+			// An interval owns an approach that ends exactly on its last point, so neighbouring chunks never both report it
+			for (uint32_t k = 0; k + 1 < timeCount; ++k)
+			{
+				if (rates[k] > 0.0 && rates[k + 1] <= 0.0)
+				{
+					auto rate = [&](double days)
+					{
+						return SeparationCosineRate(triple, days);
+					};
+
+					double peakDays = FindRoot(rate, times[k], times[k + 1], rates[k], rates[k + 1], settings.ToleranceDays);
+					ClassifyApproach(settings, triple, peakDays, events);
+				}
+			}
+		}
+	}
+
+	void EventFinder::ClassifyApproach(const EventSearchSettings& settings, const BodyTriple& triple, double peakDays, vector<AstronomicalEvent>& events) const
+	{
+		Geometry peak = EvaluateGeometry(triple, peakDays);
+		bool firstIsNear = (peak.FirstDistance < peak.SecondDistance);
+
+		AstronomicalEvent event;
+		event.Observer = triple.Observer;
+		event.Near = (firstIsNear ? triple.First : triple.Second);
+		event.Far = (firstIsNear ? triple.Second : triple.First);
+		event.BeginDays = peakDays;
+		event.PeakDays = peakDays;
+		event.EndDays = peakDays;
+		event.SeparationDegrees = peak.SeparationRadians / DegreesToRadians;
+
+		double peakOverlap = peak.SeparationRadians - (peak.FirstRadius + peak.SecondRadius);
+		if (peakOverlap < 0.0)
+		{
+			auto overlap = [&](double days)
+			{
+				Geometry geometry = EvaluateGeometry(triple, days);
+				return geometry.SeparationRadians - (geometry.FirstRadius + geometry.SecondRadius);
+			};
+
+			event.BeginDays = FindContact(overlap, peakDays, peakOverlap, -settings.GridStepDays, settings.ToleranceDays);
+			event.EndDays = FindContact(overlap, peakDays, peakOverlap, settings.GridStepDays, settings.ToleranceDays);
+
+			double nearRadius = (firstIsNear ? peak.FirstRadius : peak.SecondRadius);
+			double farRadius = (firstIsNear ? peak.SecondRadius : peak.FirstRadius);
+			if (mLightSources[event.Far])
+			{
+				event.Type = (nearRadius >= EclipseRadiusRatio * farRadius ? AstronomicalEventType::Eclipse : AstronomicalEventType::Transit);
+			}
+			else
+			{
+				event.Type = (nearRadius < farRadius ? AstronomicalEventType::Transit : AstronomicalEventType::Occultation);
+			}
+		}
+		else if (event.SeparationDegrees <= settings.ConjunctionDegrees)
+		{
+			event.Type = AstronomicalEventType::Conjunction;
+		}
+		else
+		{
+			return;
+		}
+
+		events.push_back(event);
+	}
+}
\ No newline at end of file
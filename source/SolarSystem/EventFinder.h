@@ -0,0 +1,145 @@
+#pragma once
+
+#include <vector>
+#include <string>
+#include <cstdint>
+
+namespace Library
+{
+	class BodyCatalog;
+	class ThreadPool;
+}
+
+namespace Rendering
+{
+	enum class AstronomicalEventType : std::uint32_t
+	{
+		Conjunction,	// Two bodies pass close together without their disks touching
+		Eclipse,		// A body nearly as large as a light source or larger covers it; the observer is in its shadow
+		Transit,		// A body smaller than the one behind it, and well smaller than a light source, crosses its disk
+		Occultation		// A body at least as large as the one behind it hides it
+	};
+
+	/**
+	* An event seen from an observer body. Times are in days since the start of the simulation.
+	*/
+	struct AstronomicalEvent
+	{
+		AstronomicalEventType Type;
+		std::uint32_t Observer;
+		std::uint32_t Near;				// The body in front at the peak
+		std::uint32_t Far;
+		double BeginDays;				// First contact of the disks, or the peak for a conjunction
+		double PeakDays;				// Closest approach of the centres
+		double EndDays;					// Last contact of the disks, or the peak for a conjunction
+		double SeparationDegrees;		// Between the centres at the peak
+	};
+
+	struct EventSearchSettings
+	{
+		double StartDays;
+		double EndDays;
+		double GridStepDays;			// Must be shorter than the time between two closest approaches of any pair
+		double ToleranceDays;
+		double ConjunctionDegrees;		// The largest separation reported as a conjunction
+		std::vector<std::uint32_t> Observers;		// Empty for every body that is not a light source
+	};
+
+	/**
+	* Finds eclipses, transits, occultations and conjunctions among the bodies of a catalog. Bodies follow the same
+	* inclined circular orbits as SolarSystemSimulation, evaluated directly at any time, so a shadow only falls on
+	* another body near a node of its orbit rather than at every new or full moon. The orbits have the true distances
+	* of the catalog rather than those drawn, as a moon moved out to be seen would look far smaller than it is. For every observer and pair of other
+	* bodies, closest approaches are bracketed by sign changes of the rate of change of their angular separation on a
+	* coarse grid and refined with Brent's method, as are the contacts of any approach where the disks overlap.
+	* The span is split into chunks that are searched in parallel.
+	*
+	* An eclipse of the Moon is reported as seen from the Moon: the Earth eclipsing the Sun.
+	*/
+	class EventFinder final
+	{
+	public:
+		EventFinder(const Library::BodyCatalog& catalog, Library::ThreadPool& threadPool);
+		EventFinder(const EventFinder&) = delete;
+		EventFinder& operator=(const EventFinder&) = delete;
+		EventFinder(EventFinder&&) = delete;
+		EventFinder& operator=(EventFinder&&) = delete;
+		~EventFinder() = default;
+
+		/**
+		* Find every event whose peak falls within the span of the settings.
+		* @return The events sorted by peak time.
+		*/
+		std::vector<AstronomicalEvent> Find(const EventSearchSettings& settings) const;
+
+		/**
+		* Write events to a CSV file with the names of the bodies involved.
+		*/
+		void WriteEvents(const std::wstring& filename, const std::vector<AstronomicalEvent>& events) const;
+
+		static const char* TypeName(AstronomicalEventType type);
+		static EventSearchSettings DefaultSettings(double startDays, double endDays);
+
+		static const std::uint32_t ChunksPerThread;
+
+	private:
+		struct BodyTriple
+		{
+			std::uint32_t Observer;
+			std::uint32_t First;
+			std::uint32_t Second;
+		};
+
+		struct BodyState
+		{
+			double X;
+			double Y;
+			double Z;
+			double VelocityX;
+			double VelocityY;
+			double VelocityZ;
+		};
+
+		/**
+		* The states of every body at a run of times, indexed by body then time.
+		*/
+		struct StateGrid
+		{
+			std::uint32_t TimeCount;
+			std::vector<double> PositionsX;
+			std::vector<double> PositionsY;
+			std::vector<double> PositionsZ;
+			std::vector<double> VelocitiesX;
+			std::vector<double> VelocitiesY;
+			std::vector<double> VelocitiesZ;
+		};
+
+		struct Geometry
+		{
+			double SeparationRadians;
+			double FirstDistance;
+			double SecondDistance;
+			double FirstRadius;			// Angular radii
+			double SecondRadius;
+		};
+
+		void EvaluateBody(std::uint32_t index, double days, BodyState& state) const;
+		void EvaluateGrid(const std::vector<double>& times, StateGrid& grid) const;
+		Geometry EvaluateGeometry(const BodyTriple& triple, double days) const;
+		double SeparationCosineRate(const BodyTriple& triple, double days) const;
+		void SearchChunk(const EventSearchSettings& settings, const std::vector<BodyTriple>& triples, std::uint32_t firstInterval, std::uint32_t endInterval, std::vector<AstronomicalEvent>& events) const;
+		void ClassifyApproach(const EventSearchSettings& settings, const BodyTriple& triple, double peakDays, std::vector<AstronomicalEvent>& events) const;
+
+		const Library::BodyCatalog* mCatalog;
+		Library::ThreadPool* mThreadPool;
+
+		std::vector<std::int32_t> mParentIndices;
+		std::vector<double> mOrbitalDistances;		// Astronomical units, the true distances
+		std::vector<double> mRevolutionRates;		// Degrees per day on earth
+		std::vector<double> mInclinations;			// Radians
+		std::vector<double> mAscendingNodes;		// Degrees at the start of the simulation
+		std::vector<double> mNodalRates;			// Degrees per day on earth
+		std::vector<double> mRadii;					// Astronomical units
+		std::vector<bool> mLightSources;
+	};
+}
\ No newline at end of file
@@ -0,0 +1,293 @@
+#include "pch.h"
+
+using namespace std;
+using namespace Library;
+using namespace DirectX;
+
+namespace Rendering
+{
+	namespace
+	{
+		const uint32_t FrameNumberDigits = 6;
+		const XMFLOAT4 ClearColor(0.0f, 0.0f, 0.0f, 1.0f);
+
+		// The range of the light of AstronomicalObject, whose sources are left out of the portable build
+		const double LightRangeAU = 100.0;
+	}
+
+	FrameSequenceRenderer::FrameSequenceRenderer(const BodyCatalog& catalog, const Mesh& mesh, TextureCache& textureCache, ThreadPool& threadPool) :
+		mCatalog(&catalog), mThreadPool(&threadPool), mLightIndex(0), mMeshRadius(0.0f)
+	{
+		uint32_t count = catalog.Count();
+		while (mLightIndex < count && catalog.Record(mLightIndex).HasFlag(BodyFlags::LightSource) == false)
+		{
+			++mLightIndex;
+		}
+
+		if (mLightIndex == count)
+		{
+			throw GameException("The body catalog has no light source.");
+		}
+
+		// Start decoding the textures, one slice for each file however many bodies name it, while the mesh is copied
+		vector<wstring> textureFileNames;
+		vector<TextureCache::TextureFuture> textureLoads;
+		mTextureSlices.resize(count);
+		for (uint32_t i = 0; i < count; ++i)
+		{
+			wstring textureFileName = catalog.TextureName(i);
+			auto found = find(textureFileNames.begin(), textureFileNames.end(), textureFileName);
+			mTextureSlices[i] = static_cast<uint32_t>(found - textureFileNames.begin());
+			if (found == textureFileNames.end())
+			{
+				textureFileNames.push_back(textureFileName);
+				textureLoads.push_back(textureCache.Load(textureFileName, InstanceBatcher::TextureWidth, InstanceBatcher::TextureHeight));
+			}
+		}
+
+		const vector<XMFLOAT3>& sourceVertices = mesh.Vertices();
+		const vector<XMFLOAT3>& sourceNormals = mesh.Normals();
+		const auto& sourceUVs = mesh.TextureCoordinates().at(0);
+		mVertices.reserve(sourceVertices.size());
+		for (size_t i = 0; i < sourceVertices.size(); ++i)
+		{
+			const XMFLOAT3& position = sourceVertices[i];
+			const XMFLOAT3& uv = sourceUVs->at(i);
+			mVertices.push_back(VertexPositionTextureNormal(XMFLOAT4(position.x, position.y, position.z, 1.0f), XMFLOAT2(uv.x, uv.y), sourceNormals[i]));
+			mMeshRadius = max(mMeshRadius, XMVectorGetX(XMVector3Length(XMLoadFloat3(&position))));
+		}
+
+		mIndices = mesh.Indices();
+
+		vector<shared_ptr<const TextureData>> textures;
+		textures.reserve(textureLoads.size());
+		for (const TextureCache::TextureFuture& textureLoad : textureLoads)
+		{
+			textures.push_back(textureLoad.get());
+		}
+
+		const uint32_t mipLevels = static_cast<uint32_t>(textures.front()->MipLevels.size());
+		vector<RenderDevice::SubresourceData> subresources;
+		subresources.reserve(textures.size() * mipLevels);
+		for (const auto& texture : textures)
+		{
+			for (const DecodedImage& level : texture->MipLevels)
+			{
+				subresources.push_back({ level.Pixels.data(), level.Width * 4 });
+			}
+		}
+
+		mColorMaps = make_unique<SoftwareTexture>(RenderDevice::TextureDescription{ InstanceBatcher::TextureWidth, InstanceBatcher::TextureHeight, mipLevels, static_cast<uint32_t>(textures.size()) }, subresources.data());
+
+		mPositions.resize(count);
+		mRadii.resize(count);
+		mReceivers.resize(count);
+	}
+
+	FrameSequenceRenderer::~FrameSequenceRenderer() = default;
+
+	void FrameSequenceRenderer::Render(SolarSystemSimulation& simulation, const FrameSequenceSettings& settings)
+	{
+		if (settings.Width == 0 || settings.Height == 0 || settings.FramesInFlight == 0)
+		{
+			throw GameException("A frame sequence must have a size and at least one frame in flight.");
+		}
+
+		if (settings.FocusBody >= static_cast<int32_t>(mCatalog->Count()))
+		{
+			throw GameException("The focus body of the frame sequence is not in the catalog.");
+		}
+
+		vector<unique_ptr<FrameSlot>> slots;
+		for (uint32_t i = 0; i < min(settings.FramesInFlight, max(settings.FrameCount, 1U)); ++i)
+		{
+			slots.push_back(make_unique<FrameSlot>());
+			slots.back()->Rasterizer = make_unique<SoftwareRasterizer>(*mThreadPool, settings.Width, settings.Height);
+			slots.back()->Shader.SetColorMaps(*mColorMaps);
+		}
+
+		try
+		{
+			// The simulation only moves forward, so frames are simulated in order while earlier ones are still drawn
+			for (uint32_t frame = 0; frame < settings.FrameCount; ++frame)
+			{
+				FrameSlot& slot = *slots[frame % slots.size()];
+				Finish(slot);
+
+				slot.Frame = frame;
+				Simulate(simulation, settings, slot);
+				slot.Worker = thread(&FrameSequenceRenderer::DrawAndWrite, this, ref(slot), FrameFileName(settings.FileNamePrefix, frame));
+			}
+
+			for (unique_ptr<FrameSlot>& slot : slots)
+			{
+				Finish(*slot);
+			}
+		}
+		catch (...)
+		{
+			// The threads still running use the slots, so they must finish before the error leaves
+			for (unique_ptr<FrameSlot>& slot : slots)
+			{
+				if (slot->Worker.joinable())
+				{
+					slot->Worker.join();
+				}
+			}
+
+			throw;
+		}
+	}
+
+	FrameSequenceSettings FrameSequenceRenderer::DefaultSettings(double startDays, double endDays, uint32_t frameCount)
+	{
+		FrameSequenceSettings settings;
+		settings.StartDays = startDays;
+		settings.DaysPerFrame = (frameCount > 1 ? (endDays - startDays) / (frameCount - 1) : 0.0);
+		settings.FrameCount = frameCount;
+		settings.Width = 3840;
+		settings.Height = 2160;
+		settings.FocusBody = -1;
+		settings.CameraOffset = XMFLOAT3(0.0f, 6000.0f, 9000.0f);
+		settings.FieldOfView = XM_PIDIV4;
+		settings.NearPlaneDistance = 10.0f;
+		settings.FarPlaneDistance = 30000.0f;
+		settings.FramesInFlight = 4;
+		settings.FileNamePrefix = L"Frame";
+
+		return settings;
+	}
+
+	wstring FrameSequenceRenderer::FrameFileName(const wstring& prefix, uint32_t frame)
+	{
+		wostringstream fileName;
+		fileName << prefix << setw(FrameNumberDigits) << setfill(L'0') << frame << L".qoi";
+
+		return fileName.str();
+	}
+
+	void FrameSequenceRenderer::Simulate(SolarSystemSimulation& simulation, const FrameSequenceSettings& settings, FrameSlot& slot)
+	{
+		simulation.Advance(settings.StartDays + settings.DaysPerFrame * slot.Frame - simulation.ElapsedDays());
+
+		// The bodies are placed relative to the camera in double precision, as the game places them relative to its floating origin
+		uint32_t focus = (settings.FocusBody >= 0 ? static_cast<uint32_t>(settings.FocusBody) : mLightIndex);
+		DoubleVector3 focusPosition = simulation.Position(focus);
+		DoubleVector3 eye(focusPosition.x + settings.CameraOffset.x, focusPosition.y + settings.CameraOffset.y, focusPosition.z + settings.CameraOffset.z);
+
+		uint32_t count = mCatalog->Count();
+		for (uint32_t i = 0; i < count; ++i)
+		{
+			DoubleVector3 position = simulation.Position(i);
+			mPositions[i] = XMFLOAT3(static_cast<float>(position.x - eye.x), static_cast<float>(position.y - eye.y), static_cast<float>(position.z - eye.z));
+			mRadii[i] = mMeshRadius * mCatalog->Record(i).Scale;
+		}
+
+		// Looking straight along the pole, the -Z axis of the scene is up instead
+		const XMFLOAT3& offset = settings.CameraOffset;
+		XMVECTOR up = (offset.x != 0.0f || offset.z != 0.0f ? g_XMIdentityR1 : XMVectorNegate(g_XMIdentityR2));
+		float aspectRatio = static_cast<float>(settings.Width) / static_cast<float>(settings.Height);
+		XMMATRIX viewProjection = XMMatrixLookToRH(XMVectorZero(), XMVectorNegate(XMLoadFloat3(&offset)), up) *
+			XMMatrixPerspectiveFovRH(settings.FieldOfView, aspectRatio, settings.NearPlaneDistance, settings.FarPlaneDistance);
+
+		mCuller.SetView(viewProjection);
+		mCuller.Clear();
+		for (uint32_t i = 0; i < count; ++i)
+		{
+			mCuller.Add(mPositions[i], mRadii[i]);
+		}
+
+		uint32_t visibleCount = mCuller.Cull();
+		const uint32_t* visibleIndices = mCuller.VisibleIndices();
+		fill(mReceivers.begin(), mReceivers.end(), static_cast<uint8_t>(0));
+		for (uint32_t i = 0; i < visibleCount; ++i)
+		{
+			mReceivers[visibleIndices[i]] = 1;
+		}
+
+		mShadowOccluderPass.Update(mPositions.data(), mRadii.data(), mReceivers.data(), count, mLightIndex);
+
+		// The same transform as the body-fixed frame of each body: its rotation, its axial tilt and its position
+		mBatcher.Clear();
+		for (uint32_t i = 0; i < visibleCount; ++i)
+		{
+			uint32_t body = visibleIndices[i];
+			const BodyCatalogRecord& record = mCatalog->Record(body);
+			XMMATRIX world = XMMatrixScaling(record.Scale, record.Scale, record.Scale) * XMMatrixRotationY(XMConvertToRadians(simulation.RotationDegrees(body))) *
+				XMMatrixRotationZ(XMConvertToRadians(record.AxialTilt)) * XMMatrixTranslation(mPositions[body].x, mPositions[body].y, mPositions[body].z);
+			mBatcher.Add(0, InstanceBatcher::Pack(world, mShadowOccluderPass.Occluders(body), mTextureSlices[body], record.AmbientIntensity));
+		}
+
+		slot.Instances.resize(visibleCount);
+		slot.Batches = mBatcher.Build(slot.Instances.data());
+
+		SoftwarePlanetShader::FrameConstants frameConstants;
+		XMStoreFloat4x4(&frameConstants.ViewProjection, XMMatrixTranspose(viewProjection));
+		frameConstants.LightPosition = mPositions[mLightIndex];
+		frameConstants.LightRange = static_cast<float>(LightRangeAU * SCALE_ASTRONOMICAL_UNIT);
+		frameConstants.LightColor = XMFLOAT3(1.0f, 1.0f, 1.0f);
+		frameConstants.Padding = 0.0f;
+		slot.Shader.SetFrameConstants(frameConstants);
+		slot.Shader.SetInstances(slot.Instances.data());
+	}
+
+	void FrameSequenceRenderer::DrawAndWrite(FrameSlot& slot, wstring fileName)
+	{
+		try
+		{
+			SoftwareRasterizer& rasterizer = *slot.Rasterizer;
+			rasterizer.Clear(ClearColor);
+			rasterizer.SetState({ RenderDevice::BlendMode::Opaque, RenderDevice::DepthMode::ReadWrite, RenderDevice::CullMode::Back });
+			for (const InstanceBatch& batch : slot.Batches)
+			{
+				rasterizer.DrawIndexedInstanced(slot.Shader, mVertices.data(), sizeof(VertexPositionTextureNormal), static_cast<uint32_t>(mVertices.size()),
+					mIndices.data(), static_cast<uint32_t>(mIndices.size()), batch.InstanceCount, batch.FirstInstance);
+			}
+
+			rasterizer.Execute();
+			rasterizer.ReadPixels(slot.Image);
+
+			// Encoded on the pool between the tiles of the other frames, so no more threads run than the pool has
+			vector<uint8_t> encoded;
+			mThreadPool->Enqueue([&]()
+			{
+				encoded = QoiImageEncoder::Encode(slot.Image);
+			}).get();
+
+#if defined(_WIN32)
+			ofstream stream(fileName.c_str(), ios::binary);
+#else
+			ofstream stream(Utility::ToPortablePath(fileName), ios::binary);
+#endif
+			if (stream.is_open() == false)
+			{
+				throw GameException("Could not open a frame file.");
+			}
+
+			stream.write(reinterpret_cast<const char*>(encoded.data()), static_cast<streamsize>(encoded.size()));
+			if (stream.good() == false)
+			{
+				throw GameException("Could not write a frame file.");
+			}
+		}
+		catch (...)
+		{
+			slot.Error = current_exception();
+		}
+	}
+
+	void FrameSequenceRenderer::Finish(FrameSlot& slot)
+	{
+		if (slot.Worker.joinable())
+		{
+			slot.Worker.join();
+		}
+
+		if (slot.Error != nullptr)
+		{
+			exception_ptr error = slot.Error;
+			slot.Error = nullptr;
+			rethrow_exception(error);
+		}
+	}
+}
\ No newline at end of file
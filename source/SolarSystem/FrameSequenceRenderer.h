@@ -0,0 +1,128 @@
+#pragma once
+
+#include "SoftwarePlanetShader.h"
+#include "InstanceBatcher.h"
+#include "FrustumCuller.h"
+#include "ShadowOccluderPass.h"
+#include "TextureCache.h"
+#include "VertexDeclarations.h"
+#include <vector>
+#include <string>
+#include <memory>
+#include <thread>
+#include <exception>
+#include <cstdint>
+#include <DirectXMath.h>
+
+namespace Library
+{
+	class BodyCatalog;
+	class Mesh;
+	class ThreadPool;
+	class SoftwareTexture;
+	class SoftwareRasterizer;
+}
+
+namespace Rendering
+{
+	class SolarSystemSimulation;
+
+	struct FrameSequenceSettings
+	{
+		double StartDays;
+		double DaysPerFrame;
+		std::uint32_t FrameCount;
+		std::uint32_t Width;
+		std::uint32_t Height;
+		std::int32_t FocusBody;					// The body the camera follows and looks at, or -1 for the light source
+		DirectX::XMFLOAT3 CameraOffset;			// From the focus body to the camera, in scene units
+		float FieldOfView;						// Vertical, in radians
+		float NearPlaneDistance;
+		float FarPlaneDistance;
+		std::uint32_t FramesInFlight;			// Frames being drawn or encoded at once
+		std::wstring FileNamePrefix;			// Each frame is written to the prefix followed by its number in six digits and .qoi
+	};
+
+	/**
+	* Renders a sequence of frames at fixed steps of simulated time to numbered image files, without a window or a
+	* graphics device, for time-lapses longer and larger than the game can show in real time. Each frame goes through
+	* three stages:
+	*
+	* - The simulation is advanced to the time of the frame on the calling thread, and the bodies are culled,
+	*   shadowed and batched into instances as the planet renderer does, relative to a camera following the focus body.
+	* - The instances are drawn by a software rasterizer with the planet shaders.
+	* - The image is encoded as QOI and written to its file.
+	*
+	* The frames in flight each have a slot with their own rasterizer, instances and image, and are drawn and encoded
+	* on a thread of their slot while the calling thread simulates the next frame. The tiles of every frame and the
+	* encoding of the images all run on the one thread pool, so the stages overlap and keep every core busy. Frames
+	* are written in any order, but each is the same however many frames are in flight.
+	*/
+	class FrameSequenceRenderer final
+	{
+	public:
+		/**
+		* Load the textures of every body.
+		* @param mesh The mesh every body is drawn with.
+		* @param textureCache The cache decoding the color textures of the bodies, as the planet renderer loads them.
+		* @param threadPool The pool drawing and encoding the frames.
+		*/
+		FrameSequenceRenderer(const Library::BodyCatalog& catalog, const Library::Mesh& mesh, Library::TextureCache& textureCache, Library::ThreadPool& threadPool);
+		FrameSequenceRenderer(const FrameSequenceRenderer&) = delete;
+		FrameSequenceRenderer& operator=(const FrameSequenceRenderer&) = delete;
+		FrameSequenceRenderer(FrameSequenceRenderer&&) = delete;
+		FrameSequenceRenderer& operator=(FrameSequenceRenderer&&) = delete;
+		~FrameSequenceRenderer();
+
+		/**
+		* Render every frame of a sequence, advancing the simulation to the time of each in turn, and wait for the last
+		* to be written. The first error of any frame is rethrown once the frames in flight have finished.
+		* @param simulation The simulation of the catalog, at or before the start of the sequence.
+		*/
+		void Render(SolarSystemSimulation& simulation, const FrameSequenceSettings& settings);
+
+		/**
+		* Get settings for a 4K sequence spread evenly over a span, seen from above the ecliptic and looking at the light source.
+		*/
+		static FrameSequenceSettings DefaultSettings(double startDays, double endDays, std::uint32_t frameCount);
+		static std::wstring FrameFileName(const std::wstring& prefix, std::uint32_t frame);
+
+	private:
+		/**
+		* A frame in flight, with everything its thread reads and writes.
+		*/
+		struct FrameSlot
+		{
+			std::uint32_t Frame;
+			std::vector<PlanetInstance> Instances;
+			std::vector<InstanceBatch> Batches;
+			SoftwarePlanetShader Shader;
+			std::unique_ptr<Library::SoftwareRasterizer> Rasterizer;
+			Library::DecodedImage Image;
+			std::thread Worker;
+			std::exception_ptr Error;
+		};
+
+		void Simulate(SolarSystemSimulation& simulation, const FrameSequenceSettings& settings, FrameSlot& slot);
+		void DrawAndWrite(FrameSlot& slot, std::wstring fileName);
+		static void Finish(FrameSlot& slot);
+
+		const Library::BodyCatalog* mCatalog;
+		Library::ThreadPool* mThreadPool;
+		std::uint32_t mLightIndex;
+
+		std::vector<Library::VertexPositionTextureNormal> mVertices;
+		std::vector<std::uint32_t> mIndices;
+		float mMeshRadius;
+		std::vector<std::uint32_t> mTextureSlices;		// The slice of the color maps of each body
+		std::unique_ptr<Library::SoftwareTexture> mColorMaps;
+
+		// Used by the simulation stage only
+		FrustumCuller mCuller;
+		InstanceBatcher mBatcher;
+		ShadowOccluderPass mShadowOccluderPass;
+		std::vector<DirectX::XMFLOAT3> mPositions;		// Relative to the camera
+		std::vector<float> mRadii;
+		std::vector<std::uint8_t> mReceivers;
+	};
+}
\ No newline at end of file
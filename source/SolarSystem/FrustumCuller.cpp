@@ -0,0 +1,216 @@
+#include "pch.h"
+
+using namespace std;
+using namespace DirectX;
+
+namespace Rendering
+{
+	namespace
+	{
+		const uint32_t LaneCount = 4;
+
+		// Pads the last group with spheres that are behind every plane and never move
+		const float PaddingRadius = -FLT_MAX;
+	}
+
+	FrustumCuller::FrustumCuller() :
+		mPlanes(), mViewChanged(true), mTemporalCoherence(true), mVisibleCount(0), mTestedCount(0)
+	{
+	}
+
+	void FrustumCuller::SetView(CXMMATRIX viewProjection)
+	{
+		XMFLOAT4 planes[PlaneCount];
+		ExtractPlanes(viewProjection, planes);
+		if (memcmp(planes, mPlanes, sizeof(planes)) != 0)
+		{
+			memcpy(mPlanes, planes, sizeof(planes));
+			mViewChanged = true;
+		}
+	}
+
+	void FrustumCuller::SetTemporalCoherence(bool enabled)
+	{
+		mTemporalCoherence = enabled;
+	}
+
+	void FrustumCuller::Clear()
+	{
+		mCentersX.clear();
+		mCentersY.clear();
+		mCentersZ.clear();
+		mRadii.clear();
+	}
+
+	void FrustumCuller::Add(const XMFLOAT3& center, float radius)
+	{
+		mCentersX.push_back(center.x);
+		mCentersY.push_back(center.y);
+		mCentersZ.push_back(center.z);
+		mRadii.push_back(radius);
+	}
+
+	uint32_t FrustumCuller::Count() const
+	{
+		return static_cast<uint32_t>(mRadii.size());
+	}
+
+	uint32_t FrustumCuller::Cull()
+	{
+		uint32_t count = Count();
+		uint32_t padded = (count + LaneCount - 1) & ~(LaneCount - 1);
+		mCentersX.resize(padded, 0.0f);
+		mCentersY.resize(padded, 0.0f);
+		mCentersZ.resize(padded, 0.0f);
+		mRadii.resize(padded, PaddingRadius);
+
+		// Results can only be kept while the view and the spheres they belong to are the same, and a frame that does
+		// not record them leaves none to reuse
+		bool coherent = mTemporalCoherence && mViewChanged == false && mSlack.size() == padded;
+		if (mTemporalCoherence == false)
+		{
+			mSlack.clear();
+		}
+		else if (coherent == false)
+		{
+			mTestedX.resize(padded);
+			mTestedY.resize(padded);
+			mTestedZ.resize(padded);
+			mTestedRadii.resize(padded);
+			mSlack.resize(padded);
+			mWasVisible.resize(padded);
+		}
+
+		if (mVisible.size() < padded)
+		{
+			mVisible.resize(padded);
+		}
+
+		XMVECTOR planesX[PlaneCount];
+		XMVECTOR planesY[PlaneCount];
+		XMVECTOR planesZ[PlaneCount];
+		XMVECTOR planesW[PlaneCount];
+		for (uint32_t plane = 0; plane < PlaneCount; ++plane)
+		{
+			planesX[plane] = XMVectorReplicate(mPlanes[plane].x);
+			planesY[plane] = XMVectorReplicate(mPlanes[plane].y);
+			planesZ[plane] = XMVectorReplicate(mPlanes[plane].z);
+			planesW[plane] = XMVectorReplicate(mPlanes[plane].w);
+		}
+
+		uint32_t visibleCount = 0;
+		uint32_t testedCount = 0;
+		uint32_t* visible = mVisible.data();
+		for (uint32_t i = 0; i < padded; i += LaneCount)
+		{
+			XMVECTOR x = XMLoadFloat4(reinterpret_cast<const XMFLOAT4*>(&mCentersX[i]));
+			XMVECTOR y = XMLoadFloat4(reinterpret_cast<const XMFLOAT4*>(&mCentersY[i]));
+			XMVECTOR z = XMLoadFloat4(reinterpret_cast<const XMFLOAT4*>(&mCentersZ[i]));
+			XMVECTOR radius = XMLoadFloat4(reinterpret_cast<const XMFLOAT4*>(&mRadii[i]));
+
+			XMVECTOR visibleMask;
+			bool unchanged = false;
+			if (coherent)
+			{
+				// A sphere's distance from a plane changes by at most how far its centre moved plus how much its radius changed
+				XMVECTOR movedX = XMVectorSubtract(x, XMLoadFloat4(reinterpret_cast<const XMFLOAT4*>(&mTestedX[i])));
+				XMVECTOR movedY = XMVectorSubtract(y, XMLoadFloat4(reinterpret_cast<const XMFLOAT4*>(&mTestedY[i])));
+				XMVECTOR movedZ = XMVectorSubtract(z, XMLoadFloat4(reinterpret_cast<const XMFLOAT4*>(&mTestedZ[i])));
+				XMVECTOR movedSquared = XMVectorMultiplyAdd(movedZ, movedZ, XMVectorMultiplyAdd(movedY, movedY, XMVectorMultiply(movedX, movedX)));
+				XMVECTOR grown = XMVectorAbs(XMVectorSubtract(radius, XMLoadFloat4(reinterpret_cast<const XMFLOAT4*>(&mTestedRadii[i]))));
+				XMVECTOR margin = XMVectorSubtract(XMLoadFloat4(reinterpret_cast<const XMFLOAT4*>(&mSlack[i])), grown);
+
+				XMVECTOR kept = XMVectorAndInt(XMVectorGreater(margin, XMVectorZero()), XMVectorLess(movedSquared, XMVectorMultiply(margin, margin)));
+				if (XMVector4EqualInt(kept, XMVectorTrueInt()))
+				{
+					visibleMask = XMLoadInt4(&mWasVisible[i]);
+					unchanged = true;
+				}
+			}
+
+			if (unchanged == false)
+			{
+				// The sphere is visible unless it lies wholly behind some plane, so only the nearest plane matters
+				XMVECTOR nearest = XMVectorReplicate(FLT_MAX);
+				for (uint32_t plane = 0; plane < PlaneCount; ++plane)
+				{
+					XMVECTOR distance = XMVectorMultiplyAdd(z, planesZ[plane], XMVectorMultiplyAdd(y, planesY[plane], XMVectorMultiplyAdd(x, planesX[plane], planesW[plane])));
+					nearest = XMVectorMin(nearest, XMVectorAdd(distance, radius));
+				}
+
+				visibleMask = XMVectorGreaterOrEqual(nearest, XMVectorZero());
+				testedCount += LaneCount;
+
+				if (mTemporalCoherence)
+				{
+					XMStoreFloat4(reinterpret_cast<XMFLOAT4*>(&mTestedX[i]), x);
+					XMStoreFloat4(reinterpret_cast<XMFLOAT4*>(&mTestedY[i]), y);
+					XMStoreFloat4(reinterpret_cast<XMFLOAT4*>(&mTestedZ[i]), z);
+					XMStoreFloat4(reinterpret_cast<XMFLOAT4*>(&mTestedRadii[i]), radius);
+					XMStoreFloat4(reinterpret_cast<XMFLOAT4*>(&mSlack[i]), XMVectorAbs(nearest));
+					XMStoreInt4(&mWasVisible[i], visibleMask);
+				}
+			}
+
+			// Every lane writes its index, but the count only advances past the visible ones. The mask is stored as it
+			// is; XMStoreUInt4 would convert it as floats, turning every set lane into zero
+			XMUINT4 lanes;
+			XMStoreInt4(&lanes.x, visibleMask);
+			visible[visibleCount] = i;
+			visibleCount += lanes.x & 1;
+			visible[visibleCount] = i + 1;
+			visibleCount += lanes.y & 1;
+			visible[visibleCount] = i + 2;
+			visibleCount += lanes.z & 1;
+			visible[visibleCount] = i + 3;
+			visibleCount += lanes.w & 1;
+		}
+
+		mCentersX.resize(count);
+		mCentersY.resize(count);
+		mCentersZ.resize(count);
+		mRadii.resize(count);
+
+		mViewChanged = false;
+		mVisibleCount = visibleCount;
+		mTestedCount = testedCount;
+
+		return visibleCount;
+	}
+
+	const uint32_t* FrustumCuller::VisibleIndices() const
+	{
+		return mVisible.data();
+	}
+
+	uint32_t FrustumCuller::VisibleCount() const
+	{
+		return mVisibleCount;
+	}
+
+	uint32_t FrustumCuller::TestedCount() const
+	{
+		return mTestedCount;
+	}
+
+	void FrustumCuller::ExtractPlanes(CXMMATRIX viewProjection, XMFLOAT4 (&planes)[PlaneCount])
+	{
+		// A point is inside when -w <= x <= w, -w <= y <= w and 0 <= z <= w in clip space, and each clip coordinate
+		// is the point dotted with a column of the matrix
+		XMMATRIX columns = XMMatrixTranspose(viewProjection);
+		const XMVECTOR unnormalized[PlaneCount] =
+		{
+			XMVectorAdd(columns.r[3], columns.r[0]),
+			XMVectorSubtract(columns.r[3], columns.r[0]),
+			XMVectorAdd(columns.r[3], columns.r[1]),
+			XMVectorSubtract(columns.r[3], columns.r[1]),
+			columns.r[2],
+			XMVectorSubtract(columns.r[3], columns.r[2])
+		};
+
+		for (uint32_t plane = 0; plane < PlaneCount; ++plane)
+		{
+			XMStoreFloat4(&planes[plane], XMPlaneNormalize(unnormalized[plane]));
+		}
+	}
+}
\ No newline at end of file
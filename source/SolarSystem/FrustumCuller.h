@@ -0,0 +1,94 @@
+#pragma once
+
+#include <vector>
+#include <cstdint>
+#include <DirectXMath.h>
+
+namespace Rendering
+{
+	/**
+	* Tests bounding spheres against the view frustum and lists the visible ones. The planes are extracted once per
+	* view, and the spheres are kept as separate arrays of coordinates and radii so they are tested four at a time,
+	* with the visible indices written out without branching on the result of each lane.
+	*
+	* With temporal coherence, each sphere keeps how far it was from changing its result when last tested: its distance
+	* inside the nearest plane when visible, or outside the most violated plane when culled. While the view is unchanged,
+	* a group of four spheres that has each moved less than that distance keeps its previous result without a test. This
+	* relies on a sphere keeping its index from frame to frame, as the bodies of the scene do when submitted in the same
+	* order; a change in the number of spheres tests them all again.
+	*
+	* The culler has no device dependencies and can run headless.
+	*/
+	class FrustumCuller final
+	{
+	public:
+		static const std::uint32_t PlaneCount = 6;
+
+		FrustumCuller();
+		FrustumCuller(const FrustumCuller&) = delete;
+		FrustumCuller& operator=(const FrustumCuller&) = delete;
+		FrustumCuller(FrustumCuller&&) = delete;
+		FrustumCuller& operator=(FrustumCuller&&) = delete;
+		~FrustumCuller() = default;
+
+		/**
+		* Set the view the spheres are culled against.
+		* @param viewProjection The combined view and projection matrix, in the row vector convention of DirectXMath.
+		*/
+		void SetView(DirectX::CXMMATRIX viewProjection);
+		/**
+		* Enable or disable skipping the spheres whose result cannot have changed since they were last tested. Enabled by default.
+		*/
+		void SetTemporalCoherence(bool enabled);
+
+		/**
+		* Drop the spheres of the previous frame, keeping the results they were tested with.
+		*/
+		void Clear();
+		void Add(const DirectX::XMFLOAT3& center, float radius);
+		std::uint32_t Count() const;
+
+		/**
+		* Test the spheres added since Clear() against the view.
+		* @return The number of visible spheres.
+		*/
+		std::uint32_t Cull();
+		/**
+		* Get the indices of the spheres found visible by the last call to Cull(), ascending.
+		*/
+		const std::uint32_t* VisibleIndices() const;
+		std::uint32_t VisibleCount() const;
+		/**
+		* Get the number of spheres the last call to Cull() tested against the planes, including those padding the last group.
+		*/
+		std::uint32_t TestedCount() const;
+
+		/**
+		* Extract the normalized planes bounding a view, each facing into the frustum, for a projection with depths from 0 to 1.
+		* @param planes Receives the left, right, bottom, top, near and far planes.
+		*/
+		static void ExtractPlanes(DirectX::CXMMATRIX viewProjection, DirectX::XMFLOAT4 (&planes)[PlaneCount]);
+
+	private:
+		DirectX::XMFLOAT4 mPlanes[PlaneCount];
+		bool mViewChanged;
+		bool mTemporalCoherence;
+
+		std::vector<float> mCentersX;
+		std::vector<float> mCentersY;
+		std::vector<float> mCentersZ;
+		std::vector<float> mRadii;
+
+		// The spheres as last tested, with the distance each can move before its result may change
+		std::vector<float> mTestedX;
+		std::vector<float> mTestedY;
+		std::vector<float> mTestedZ;
+		std::vector<float> mTestedRadii;
+		std::vector<float> mSlack;
+		std::vector<std::uint32_t> mWasVisible;
+
+		std::vector<std::uint32_t> mVisible;
+		std::uint32_t mVisibleCount;
+		std::uint32_t mTestedCount;
+	};
+}
\ No newline at end of file
@@ -0,0 +1,230 @@
+#include "pch.h"
+
+using namespace std;
+using namespace Library;
+using namespace DirectX;
+
+namespace Rendering
+{
+	namespace
+	{
+		const uint32_t TilesPerChunk = 4;
+
+		/**
+		* The distance from a point to the rectangle of a tile in the plane of the grid, softened.
+		*/
+		float SoftenedDistance(const XMFLOAT3& point, float minX, float maxX, float minZ, float maxZ, float softeningSquared)
+		{
+			float dx = (point.x < minX ? minX - point.x : (point.x > maxX ? point.x - maxX : 0.0f));
+			float dz = (point.z < minZ ? minZ - point.z : (point.z > maxZ ? point.z - maxZ : 0.0f));
+			return sqrt(dx * dx + dz * dz + point.y * point.y + softeningSquared);
+		}
+	}
+
+	const uint32_t GravityFieldSampler::TileSize = 32;
+
+	GravityFieldSampler::GravityFieldSampler(const BodyCatalog& catalog, const SolarSystemSimulation& simulation, ThreadPool& threadPool, const GravityFieldSettings& settings) :
+		mSimulation(&simulation), mThreadPool(&threadPool), mSettings(settings), mTilesPerSide(0), mOrigin(), mSpacing(0.0f)
+	{
+		if (settings.Resolution == 0 || settings.Resolution % TileSize != 0)
+		{
+			throw GameException("The gravity field resolution must be a positive multiple of the tile size.");
+		}
+
+		uint32_t count = catalog.Count();
+		uint32_t lightIndex = 0;
+		while (lightIndex < count && catalog.Record(lightIndex).HasFlag(BodyFlags::LightSource) == false)
+		{
+			++lightIndex;
+		}
+
+		if (lightIndex == count)
+		{
+			throw GameException("The body catalog has no light source.");
+		}
+
+		for (uint32_t i = 0; i < count; ++i)
+		{
+			float mass = catalog.Record(i).Mass;
+			if (mass > 0.0f)
+			{
+				mBodies.push_back(i);
+				mMasses.push_back(mass * static_cast<float>(SCALE_ASTRONOMICAL_UNIT));
+			}
+		}
+
+		// Grid points sit at the centres of the cells of the square
+		mTilesPerSide = settings.Resolution / TileSize;
+		mSpacing = settings.Extent / settings.Resolution;
+		DoubleVector3 centre = simulation.Position(lightIndex);
+		double corner = 0.5 * (mSpacing - settings.Extent);
+		mOrigin = XMFLOAT3(static_cast<float>(centre.x + corner), static_cast<float>(centre.y), static_cast<float>(centre.z + corner));
+
+		mPotentials.assign(static_cast<size_t>(settings.Resolution) * settings.Resolution, 0.0f);
+		mSampledPositions.resize(static_cast<size_t>(mTilesPerSide) * mTilesPerSide * mBodies.size());
+		mPositions.resize(mBodies.size());
+
+		GatherBodies();
+		mDirtyTiles.resize(mTilesPerSide * mTilesPerSide);
+		for (uint32_t tile = 0; tile < mDirtyTiles.size(); ++tile)
+		{
+			mDirtyTiles[tile] = tile;
+		}
+
+		mThreadPool->ParallelFor(static_cast<uint32_t>(mDirtyTiles.size()), TilesPerChunk, [&](uint32_t begin, uint32_t end)
+		{
+			for (uint32_t i = begin; i < end; ++i)
+			{
+				SampleTile(mDirtyTiles[i]);
+			}
+		});
+	}
+
+	uint32_t GravityFieldSampler::Update()
+	{
+		GatherBodies();
+
+		mDirtyTiles.clear();
+		uint32_t tileCount = mTilesPerSide * mTilesPerSide;
+		for (uint32_t tile = 0; tile < tileCount; ++tile)
+		{
+			if (DisturbanceBound(tile) > mSettings.Tolerance)
+			{
+				mDirtyTiles.push_back(tile);
+			}
+		}
+
+		if (mDirtyTiles.empty() == false)
+		{
+			mThreadPool->ParallelFor(static_cast<uint32_t>(mDirtyTiles.size()), TilesPerChunk, [&](uint32_t begin, uint32_t end)
+			{
+				for (uint32_t i = begin; i < end; ++i)
+				{
+					SampleTile(mDirtyTiles[i]);
+				}
+			});
+		}
+
+		return static_cast<uint32_t>(mDirtyTiles.size());
+	}
+
+	uint32_t GravityFieldSampler::Resolution() const
+	{
+		return mSettings.Resolution;
+	}
+
+	uint32_t GravityFieldSampler::TilesPerSide() const
+	{
+		return mTilesPerSide;
+	}
+
+	const XMFLOAT3& GravityFieldSampler::Origin() const
+	{
+		return mOrigin;
+	}
+
+	float GravityFieldSampler::Spacing() const
+	{
+		return mSpacing;
+	}
+
+	const float* GravityFieldSampler::Potentials() const
+	{
+		return mPotentials.data();
+	}
+
+	const vector<uint32_t>& GravityFieldSampler::DirtyTiles() const
+	{
+		return mDirtyTiles;
+	}
+
+	GravityFieldSettings GravityFieldSampler::DefaultSettings()
+	{
+		// Out to beyond the orbit of Neptune, with a grid spacing of a sixteenth of an astronomical unit
+		GravityFieldSettings settings;
+		settings.Resolution = 1024;
+		settings.Extent = static_cast<float>(64.0 * SCALE_ASTRONOMICAL_UNIT);
+		settings.Softening = settings.Extent / settings.Resolution;
+		settings.Tolerance = 0.1f;
+
+		return settings;
+	}
+
+	void GravityFieldSampler::GatherBodies()
+	{
+		size_t count = mBodies.size();
+		for (size_t i = 0; i < count; ++i)
+		{
+			DoubleVector3 position = mSimulation->Position(mBodies[i]);
+			mPositions[i] = XMFLOAT3(static_cast<float>(position.x - mOrigin.x), static_cast<float>(position.y - mOrigin.y), static_cast<float>(position.z - mOrigin.z));
+		}
+	}
+
+	float GravityFieldSampler::DisturbanceBound(uint32_t tile) const
+	{
+		const float tileLength = (TileSize - 1) * mSpacing;
+		float minX = (tile % mTilesPerSide) * TileSize * mSpacing;
+		float minZ = (tile / mTilesPerSide) * TileSize * mSpacing;
+		float softeningSquared = mSettings.Softening * mSettings.Softening;
+
+		size_t count = mBodies.size();
+		const XMFLOAT3* sampledPositions = &mSampledPositions[tile * count];
+		float bound = 0.0f;
+		for (size_t i = 0; i < count; ++i)
+		{
+			const XMFLOAT3& now = mPositions[i];
+			const XMFLOAT3& then = sampledPositions[i];
+			float dx = now.x - then.x;
+			float dy = now.y - then.y;
+			float dz = now.z - then.z;
+			float moved = sqrt(dx * dx + dy * dy + dz * dz);
+			if (moved > 0.0f)
+			{
+				bound += mMasses[i] * moved / (SoftenedDistance(now, minX, minX + tileLength, minZ, minZ + tileLength, softeningSquared)
+					* SoftenedDistance(then, minX, minX + tileLength, minZ, minZ + tileLength, softeningSquared));
+			}
+		}
+
+		return bound;
+	}
+
+	void GravityFieldSampler::SampleTile(uint32_t tile)
+	{
+		const uint32_t resolution = mSettings.Resolution;
+		const float spacing = mSpacing;
+		const float softeningSquared = mSettings.Softening * mSettings.Softening;
+		uint32_t firstColumn = (tile % mTilesPerSide) * TileSize;
+		uint32_t firstRow = (tile / mTilesPerSide) * TileSize;
+
+		size_t count = mBodies.size();
+		const float* masses = mMasses.data();
+		const XMFLOAT3* positions = mPositions.data();
+		for (uint32_t row = firstRow; row < firstRow + TileSize; ++row)
+		{
+			float* potentials = &mPotentials[static_cast<size_t>(row) * resolution + firstColumn];
+			for (uint32_t column = 0; column < TileSize; ++column)
+			{
+				potentials[column] = 0.0f;
+			}
+
+			float z = row * spacing;
+			for (size_t i = 0; i < count; ++i)
+			{
+				const XMFLOAT3& position = positions[i];
+				float mass = masses[i];
+				float firstX = firstColumn * spacing - position.x;
+				float dz = z - position.z;
+				float offPlaneSquared = dz * dz + position.y * position.y + softeningSquared;
+
+				// The points of the row are independent, so this loop vectorizes across them
+				for (uint32_t column = 0; column < TileSize; ++column)
+				{
+					float dx = firstX + column * spacing;
+					potentials[column] -= mass / sqrt(dx * dx + offPlaneSquared);
+				}
+			}
+		}
+
+		copy(mPositions.begin(), mPositions.end(), mSampledPositions.begin() + tile * count);
+	}
+}
\ No newline at end of file
@@ -0,0 +1,99 @@
+#pragma once
+
+#include <vector>
+#include <cstdint>
+#include <DirectXMath.h>
+
+namespace Library
+{
+	class BodyCatalog;
+	class ThreadPool;
+}
+
+namespace Rendering
+{
+	class SolarSystemSimulation;
+
+	struct GravityFieldSettings
+	{
+		std::uint32_t Resolution;		// Grid points along each side, a multiple of GravityFieldSampler::TileSize
+		float Extent;					// Length of each side of the grid, in scene units
+		float Softening;				// Added in quadrature to every distance, in scene units, to keep the wells finite
+		float Tolerance;				// The largest error in the potential of any point left by skipping a tile
+	};
+
+	/**
+	* Samples the gravitational potential of every massive body of the simulation on a square grid in the plane of the
+	* ecliptic, centred on the light source, for drawing gravity wells and contours. The potential is in Earth masses per
+	* astronomical unit and is negative; multiplied by G times the mass of the Earth over an astronomical unit it is in
+	* joules per kilogram.
+	*
+	* The grid is split into square tiles. Each tile remembers where the bodies were when it was last sampled, and an
+	* update resamples only the tiles whose potential may since have changed by more than the tolerance. A body of
+	* mass m that moved from a to b changes the potential anywhere in a tile by at most m |a - b| / (s(a) s(b)), where s
+	* is the softened distance from the tile to that position, so tiles far from the moving bodies are left alone.
+	* Dirty tiles are sampled in parallel, each one row at a time with the points of the row in the inner loop.
+	*/
+	class GravityFieldSampler final
+	{
+	public:
+		GravityFieldSampler(const Library::BodyCatalog& catalog, const SolarSystemSimulation& simulation, Library::ThreadPool& threadPool, const GravityFieldSettings& settings);
+		GravityFieldSampler(const GravityFieldSampler&) = delete;
+		GravityFieldSampler& operator=(const GravityFieldSampler&) = delete;
+		GravityFieldSampler(GravityFieldSampler&&) = delete;
+		GravityFieldSampler& operator=(GravityFieldSampler&&) = delete;
+		~GravityFieldSampler() = default;
+
+		/**
+		* Resample the tiles the bodies have disturbed since they were last sampled.
+		* @return The number of tiles resampled.
+		*/
+		std::uint32_t Update();
+
+		std::uint32_t Resolution() const;
+		std::uint32_t TilesPerSide() const;
+		/**
+		* Get the world position of the grid point in the first row and column. Rows run along +Z and columns along +X.
+		*/
+		const DirectX::XMFLOAT3& Origin() const;
+		float Spacing() const;
+
+		/**
+		* Get the potential at every grid point, row by row.
+		*/
+		const float* Potentials() const;
+		/**
+		* Get the tiles resampled by the last update, for uploading only the parts of the grid that changed.
+		* A tile index is its row of tiles times TilesPerSide() plus its column.
+		*/
+		const std::vector<std::uint32_t>& DirtyTiles() const;
+
+		static GravityFieldSettings DefaultSettings();
+
+		/**
+		* The number of grid points along each side of a tile.
+		*/
+		static const std::uint32_t TileSize;
+
+	private:
+		void GatherBodies();
+		float DisturbanceBound(std::uint32_t tile) const;
+		void SampleTile(std::uint32_t tile);
+
+		const SolarSystemSimulation* mSimulation;
+		Library::ThreadPool* mThreadPool;
+		GravityFieldSettings mSettings;
+		std::uint32_t mTilesPerSide;
+		DirectX::XMFLOAT3 mOrigin;
+		float mSpacing;
+
+		// The massive bodies, with their masses scaled for distances in scene units
+		std::vector<std::uint32_t> mBodies;
+		std::vector<float> mMasses;
+		std::vector<DirectX::XMFLOAT3> mPositions;		// Relative to the origin, as of the current update
+
+		std::vector<float> mPotentials;
+		std::vector<DirectX::XMFLOAT3> mSampledPositions;		// By tile then body, as of the last sample of the tile
+		std::vector<std::uint32_t> mDirtyTiles;
+	};
+}
\ No newline at end of file
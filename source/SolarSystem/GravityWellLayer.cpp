@@ -0,0 +1,177 @@
+#include "pch.h"
+
+using namespace std;
+using namespace Library;
+using namespace DirectX;
+
+namespace Rendering
+{
+	RTTI_DEFINITIONS(GravityWellLayer)
+
+	GravityWellLayer::GravityWellLayer(Game& game, const shared_ptr<Camera>& camera, const GravityFieldSampler& sampler, const SolarSystemSimulation& simulation) :
+		DrawableGameComponent(game, camera), mSampler(&sampler), mSimulation(&simulation), mStaleTiles(), mStaleCount(0), mTileVertices(), mWorldMatrix(MatrixHelper::Identity),
+		mDevice(nullptr), mConstantStorage(nullptr), mShader(0), mVertexBuffers(), mIndexBuffer(RenderDevice::NullHandle), mIndexCount(0), mPerObjectConstants()
+	{
+	}
+
+	void GravityWellLayer::Initialize()
+	{
+		DeviceRenderBackend* renderBackend = (DeviceRenderBackend*)mGame->Services().GetService(DeviceRenderBackend::TypeIdClass());
+		assert(renderBackend != nullptr);
+		mDevice = &renderBackend->Device();
+
+		mConstantStorage = (DeviceConstantBufferStorage*)mGame->Services().GetService(DeviceConstantBufferStorage::TypeIdClass());
+		assert(mConstantStorage != nullptr);
+
+		// Load the compiled shaders
+		vector<char> compiledVertexShader;
+		Utility::LoadBinaryFile(L"Content\\Shaders\\GravityWellVS.cso", compiledVertexShader);
+		vector<char> compiledPixelShader;
+		Utility::LoadBinaryFile(L"Content\\Shaders\\GravityWellPS.cso", compiledPixelShader);
+
+		const RenderDevice::VertexElement vertexElements[] =
+		{
+			{ "POSITION", 0, RenderDevice::VertexFormat::Float3 }
+		};
+
+		mShader = renderBackend->AddShader(mDevice->CreateShader(&compiledVertexShader[0], compiledVertexShader.size(), &compiledPixelShader[0], compiledPixelShader.size(), vertexElements, ARRAYSIZE(vertexElements)));
+
+		// Every tile draws the lines leaving its own grid points towards +X and +Z; the last row and column belong to the tiles after it
+		const uint32_t tileSize = GravityFieldSampler::TileSize;
+		const uint32_t side = tileSize + 1;
+		vector<uint32_t> indices;
+		indices.reserve(4 * tileSize * tileSize);
+		for (uint32_t row = 0; row < tileSize; ++row)
+		{
+			for (uint32_t column = 0; column < tileSize; ++column)
+			{
+				uint32_t vertex = row * side + column;
+				indices.insert(indices.end(), { vertex, vertex + 1, vertex, vertex + side });
+			}
+		}
+		mIndexCount = static_cast<uint32_t>(indices.size());
+		mIndexBuffer = mDevice->CreateBuffer({ RenderDevice::BufferType::Index, false, static_cast<uint32_t>(sizeof(uint32_t) * indices.size()), 0 }, indices.data());
+
+		uint32_t tileCount = mSampler->TilesPerSide() * mSampler->TilesPerSide();
+		uint32_t vertexBufferSize = static_cast<uint32_t>(sizeof(XMFLOAT3)) * side * side;
+		mVertexBuffers.resize(tileCount);
+		for (uint32_t tile = 0; tile < tileCount; ++tile)
+		{
+			BuildTileVertices(tile);
+			mVertexBuffers[tile] = mDevice->CreateBuffer({ RenderDevice::BufferType::Vertex, false, vertexBufferSize, 0 }, mTileVertices.data());
+		}
+		mStaleTiles.assign(tileCount, 0);
+		mStaleCount = 0;
+	}
+
+	void GravityWellLayer::Update(const GameTime& gameTime)
+	{
+		UNREFERENCED_PARAMETER(gameTime);
+
+		// A resampled tile also changes the last row or column of the tiles before it
+		uint32_t tilesPerSide = mSampler->TilesPerSide();
+		auto markStale = [this, tilesPerSide](uint32_t tileRow, uint32_t tileColumn)
+		{
+			uint8_t& stale = mStaleTiles[tileRow * tilesPerSide + tileColumn];
+			if (stale == 0)
+			{
+				stale = 1;
+				++mStaleCount;
+			}
+		};
+
+		for (uint32_t tile : mSampler->DirtyTiles())
+		{
+			uint32_t tileRow = tile / tilesPerSide;
+			uint32_t tileColumn = tile % tilesPerSide;
+			markStale(tileRow, tileColumn);
+			if (tileColumn > 0)
+			{
+				markStale(tileRow, tileColumn - 1);
+			}
+			if (tileRow > 0)
+			{
+				markStale(tileRow - 1, tileColumn);
+				if (tileColumn > 0)
+				{
+					markStale(tileRow - 1, tileColumn - 1);
+				}
+			}
+		}
+
+		// The grid stays where it was sampled in world space, so it moves with the floating origin
+		const XMFLOAT3& gridOrigin = mSampler->Origin();
+		const DoubleVector3& origin = mSimulation->Origin();
+		XMStoreFloat4x4(&mWorldMatrix, XMMatrixTranslation(static_cast<float>(gridOrigin.x - origin.x), static_cast<float>(gridOrigin.y - origin.y), static_cast<float>(gridOrigin.z - origin.z)));
+	}
+
+	void GravityWellLayer::Draw(const GameTime& gameTime)
+	{
+		UNREFERENCED_PARAMETER(gameTime);
+		assert(mCamera != nullptr);
+
+		if (mStaleCount > 0)
+		{
+			uint32_t tileCount = static_cast<uint32_t>(mStaleTiles.size());
+			for (uint32_t tile = 0; tile < tileCount; ++tile)
+			{
+				if (mStaleTiles[tile] != 0)
+				{
+					BuildTileVertices(tile);
+					mDevice->UpdateBuffer(mVertexBuffers[tile], mTileVertices.data(), static_cast<uint32_t>(sizeof(XMFLOAT3) * mTileVertices.size()));
+					mStaleTiles[tile] = 0;
+				}
+			}
+			mStaleCount = 0;
+		}
+
+		FrameConstantAllocator* frameConstants = (FrameConstantAllocator*)mGame->Services().GetService(FrameConstantAllocator::TypeIdClass());
+		assert(frameConstants != nullptr);
+
+		VSCBufferPerObject perObject;
+		XMMATRIX wvp = XMLoadFloat4x4(&mWorldMatrix) * mCamera->ViewProjectionMatrix();
+		XMStoreFloat4x4(&perObject.WorldViewProjection, XMMatrixTranspose(wvp));
+		mPerObjectConstants = frameConstants->Upload(perObject);
+
+		RenderQueue* renderQueue = (RenderQueue*)mGame->Services().GetService(RenderQueue::TypeIdClass());
+		assert(renderQueue != nullptr);
+		uint64_t key = RenderQueue::MakeKey(DeviceRenderBackend::DefaultPass, mShader, RenderQueue::NoTexture, 0.0f);
+		uint32_t tileCount = static_cast<uint32_t>(mVertexBuffers.size());
+		for (uint32_t tile = 0; tile < tileCount; ++tile)
+		{
+			renderQueue->Submit(key, *this, tile);
+		}
+	}
+
+	void GravityWellLayer::ExecuteDraw(uint32_t command)
+	{
+		mDevice->SetPrimitiveTopology(RenderDevice::PrimitiveTopology::LineList);
+		mDevice->SetVertexBuffer(mVertexBuffers[command], sizeof(XMFLOAT3));
+		mDevice->SetIndexBuffer(mIndexBuffer);
+		mConstantStorage->SetConstantBuffer(RenderDevice::ShaderStage::Vertex, 0, mPerObjectConstants);
+
+		mDevice->DrawIndexedInstanced(mIndexCount, 1, 0, 0, 0);
+	}
+
+	void GravityWellLayer::BuildTileVertices(uint32_t tile)
+	{
+		// The grid points of the tile and the first row and column after it, clamped to the edge of the grid, relative to its first point
+		const uint32_t tileSize = GravityFieldSampler::TileSize;
+		uint32_t resolution = mSampler->Resolution();
+		uint32_t firstRow = (tile / mSampler->TilesPerSide()) * tileSize;
+		uint32_t firstColumn = (tile % mSampler->TilesPerSide()) * tileSize;
+		float spacing = mSampler->Spacing();
+		const float* potentials = mSampler->Potentials();
+
+		mTileVertices.clear();
+		for (uint32_t row = firstRow; row <= firstRow + tileSize; ++row)
+		{
+			uint32_t sampleRow = min(row, resolution - 1);
+			for (uint32_t column = firstColumn; column <= firstColumn + tileSize; ++column)
+			{
+				uint32_t sampleColumn = min(column, resolution - 1);
+				mTileVertices.push_back(XMFLOAT3(static_cast<float>(sampleColumn) * spacing, potentials[static_cast<size_t>(sampleRow) * resolution + sampleColumn], static_cast<float>(sampleRow) * spacing));
+			}
+		}
+	}
+}
\ No newline at end of file
@@ -0,0 +1,70 @@
+#pragma once
+
+#include "DrawableGameComponent.h"
+#include "RenderQueue.h"
+#include "FrameConstantAllocator.h"
+#include <DirectXMath.h>
+
+namespace Library
+{
+	class RenderDevice;
+	class DeviceConstantBufferStorage;
+}
+
+namespace Rendering
+{
+	class SolarSystemSimulation;
+	class GravityFieldSampler;
+
+	/**
+	* Draws the potential sampled by a GravityFieldSampler as a sheet of grid lines sunk into wells under the massive
+	* bodies, with contours at even steps of the logarithm of the potential. Each tile of the sampler has a vertex
+	* buffer of its own, holding its grid points and the first row and column of the tiles after it so neighbouring
+	* tiles meet; only the tiles whose grid points were resampled are uploaded again. The sampler must be updated
+	* before this layer each frame.
+	*/
+	class GravityWellLayer final : public Library::DrawableGameComponent, public Library::RenderQueueClient
+	{
+		RTTI_DECLARATIONS(GravityWellLayer, Library::DrawableGameComponent)
+
+	public:
+		GravityWellLayer(Library::Game& game, const std::shared_ptr<Library::Camera>& camera, const GravityFieldSampler& sampler, const SolarSystemSimulation& simulation);
+		GravityWellLayer(const GravityWellLayer&) = delete;
+		GravityWellLayer& operator=(const GravityWellLayer&) = delete;
+		GravityWellLayer(GravityWellLayer&&) = delete;
+		GravityWellLayer& operator=(GravityWellLayer&&) = delete;
+		~GravityWellLayer() = default;
+
+		virtual void Initialize() override;
+		virtual void Update(const Library::GameTime& gameTime) override;
+		virtual void Draw(const Library::GameTime& gameTime) override;
+		virtual void ExecuteDraw(std::uint32_t command) override;
+
+	private:
+		struct VSCBufferPerObject
+		{
+			DirectX::XMFLOAT4X4 WorldViewProjection;
+		};
+
+		void BuildTileVertices(std::uint32_t tile);
+
+		const GravityFieldSampler* mSampler;
+		const SolarSystemSimulation* mSimulation;
+
+		/**
+		* One flag per tile whose vertex buffer no longer matches the sampler, and the number set.
+		*/
+		std::vector<std::uint8_t> mStaleTiles;
+		std::uint32_t mStaleCount;
+		std::vector<DirectX::XMFLOAT3> mTileVertices;
+		DirectX::XMFLOAT4X4 mWorldMatrix;
+
+		Library::RenderDevice* mDevice;
+		Library::DeviceConstantBufferStorage* mConstantStorage;
+		std::uint32_t mShader;
+		std::vector<std::uint32_t> mVertexBuffers;
+		std::uint32_t mIndexBuffer;
+		std::uint32_t mIndexCount;
+		Library::FrameConstantAllocator::Allocation mPerObjectConstants;
+	};
+}
\ No newline at end of file
@@ -0,0 +1,18 @@
+static const float4 GridColor = float4(0.15f, 0.25f, 0.45f, 1.0f);
+static const float4 ContourColor = float4(0.6f, 0.8f, 1.0f, 1.0f);
+static const float ContoursPerDecade = 4.0f;
+static const float ContourWidth = 0.08f;
+
+struct VS_OUTPUT
+{
+	float4 Position: SV_Position;
+	float LogPotential: TEXCOORD;
+};
+
+float4 main(VS_OUTPUT IN) : SV_Target
+{
+	// Lines of the grid within a band around each contour are brightened
+	float phase = frac(IN.LogPotential * ContoursPerDecade);
+	float distance = min(phase, 1.0f - phase);
+	return lerp(GridColor, ContourColor, step(distance, ContourWidth));
+}
\ No newline at end of file
@@ -0,0 +1,31 @@
+// The depth of a well per decade of the potential, in scene units, below the potential at the edge of the grid
+static const float WellScale = 40.0f;
+static const float LogReference = 4.0f;
+
+cbuffer CBufferPerObject
+{
+	float4x4 WorldViewProjection;
+}
+
+struct VS_INPUT
+{
+	float3 ObjectPosition: POSITION;	// The potential in y
+};
+
+struct VS_OUTPUT
+{
+	float4 Position: SV_Position;
+	float LogPotential: TEXCOORD;
+};
+
+VS_OUTPUT main(VS_INPUT IN)
+{
+	VS_OUTPUT OUT = (VS_OUTPUT)0;
+
+	float logPotential = log10(max(-IN.ObjectPosition.y, 1.0f));
+	float height = -WellScale * max(logPotential - LogReference, 0.0f);
+	OUT.Position = mul(float4(IN.ObjectPosition.x, height, IN.ObjectPosition.z, 1.0f), WorldViewProjection);
+	OUT.LogPotential = logPotential;
+
+	return OUT;
+}
\ No newline at end of file
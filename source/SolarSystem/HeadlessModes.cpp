@@ -0,0 +1,963 @@
+#include "pch.h"
+
+using namespace std;
+using namespace Library;
+#if defined(LIBRARY_HAS_DIRECTXMATH)
+using namespace DirectX;
+#endif
+
+namespace Rendering
+{
+	namespace
+	{
+		/**
+		* Open a file to write by its wide name, which only the streams of Windows take as it is.
+		*/
+		void OpenForWriting(ofstream& stream, const wstring& fileName, ios::openmode mode = ios::out)
+		{
+#if defined(_WIN32)
+			stream.open(fileName.c_str(), mode);
+#else
+			stream.open(Utility::ToPortablePath(fileName), mode);
+#endif
+		}
+
+		// The content the game loads, named here too as the portable build is without the classes of the game
+		const wstring BodyCatalogFileName = L"Content\\Catalogs\\SolarSystem.csv.bin";
+
+#if defined(LIBRARY_HAS_DIRECTXMATH) && defined(LIBRARY_HAS_IMAGE_DECODER)
+		const wstring PlanetaryTheoryFileName = L"Content\\Catalogs\\Vsop87.bin";
+		const string ModelFileName = "Content\\Models\\Sphere.obj.bin";
+
+		bool FileExists(const wstring& fileName)
+		{
+#if defined(_WIN32)
+			return (GetFileAttributes(fileName.c_str()) != INVALID_FILE_ATTRIBUTES);
+#else
+			return (access(Utility::ToPortablePath(fileName).c_str(), F_OK) == 0);
+#endif
+		}
+#endif
+	}
+
+	const wstring HeadlessModes::RenderQueueBenchmarkSwitch = L"--benchmark-render-queue";
+	const wstring HeadlessModes::RenderDeviceBenchmarkSwitch = L"--benchmark-render-device";
+	const wstring HeadlessModes::SoftwareRasterBenchmarkSwitch = L"--benchmark-software-raster";
+	const wstring HeadlessModes::CullingBenchmarkSwitch = L"--benchmark-culling";
+	const wstring HeadlessModes::FrameSequenceSwitch = L"--render-frames";
+	const wstring HeadlessModes::EventSearchSwitch = L"--find-events";
+	const wstring HeadlessModes::ShardedSimulationSwitch = L"--simulate-sharded";
+	const wstring HeadlessModes::ParameterSweepSwitch = L"--sweep";
+	const wstring HeadlessModes::AngleBenchmarkSwitch = L"--benchmark-angles";
+
+	int HeadlessModes::RunRenderQueueBenchmark(const vector<wstring>& arguments)
+	{
+		uint32_t packetCount = (arguments.size() > 2 ? wcstoul(arguments[2].c_str(), nullptr, 10) : 100000);
+		wstring resultsFileName = (arguments.size() > 3 ? arguments[3] : L"RenderQueueBenchmark.csv");
+
+		const uint32_t frameCount = 20;
+		const uint32_t passCount = 3;
+		const uint32_t shaderCount = 64;
+		const uint32_t textureCount = 1024;
+
+		// The packets touch no device, so only the queue itself is measured
+		struct NullClient final : public RenderQueueClient
+		{
+			virtual void ExecuteDraw(uint32_t command) override
+			{
+				UNREFERENCED_PARAMETER(command);
+			}
+		};
+
+		// A fixed seed submits the same packets on every run, in an order unrelated to their state as the order components join the game is
+		mt19937 generator(20261018);
+		uniform_int_distribution<uint32_t> pass(0, passCount - 1);
+		uniform_int_distribution<uint32_t> shader(0, shaderCount - 1);
+		uniform_int_distribution<uint32_t> texture(1, textureCount);
+		uniform_real_distribution<float> depth(0.0f, 1000.0f);
+		vector<uint64_t> keys(packetCount);
+		for (uint64_t& key : keys)
+		{
+			key = RenderQueue::MakeKey(pass(generator), shader(generator), texture(generator), depth(generator));
+		}
+
+		ofstream stream;
+		OpenForWriting(stream, resultsFileName);
+		if (stream.is_open() == false)
+		{
+			throw GameException("Could not open the benchmark results file.");
+		}
+
+		stream << "Method,NanosecondsPerPacketSubmit,NanosecondsPerPacketSort,NanosecondsPerPacketExecute,PassBinds,ShaderBinds,TextureBinds" << endl;
+		stream << fixed << setprecision(3);
+
+		NullClient client;
+		RenderQueue queue;
+		RecordingRenderBackend backend;
+		vector<DrawPacket> comparisonSorted;
+
+		const char* methodNames[] = { "Unsorted", "StdStableSort", "RadixSort" };
+		for (uint32_t method = 0; method < _countof(methodNames); ++method)
+		{
+			chrono::duration<double, nano> submitTime(0);
+			chrono::duration<double, nano> sortTime(0);
+			chrono::duration<double, nano> executeTime(0);
+			for (uint32_t frame = 0; frame < frameCount; ++frame)
+			{
+				auto start = chrono::steady_clock::now();
+				queue.Clear();
+				for (uint32_t i = 0; i < packetCount; ++i)
+				{
+					queue.Submit(keys[i], client, i);
+				}
+
+				auto submitted = chrono::steady_clock::now();
+				submitTime += submitted - start;
+
+				// The comparison sort works on a copy, resubmitted in its sorted order without timing the resubmission
+				if (method == 1)
+				{
+					comparisonSorted.assign(queue.Packets(), queue.Packets() + queue.Count());
+					stable_sort(comparisonSorted.begin(), comparisonSorted.end(), [](const DrawPacket& left, const DrawPacket& right) { return left.Key < right.Key; });
+					sortTime += chrono::steady_clock::now() - submitted;
+
+					queue.Clear();
+					for (const DrawPacket& packet : comparisonSorted)
+					{
+						queue.Submit(packet.Key, client, packet.Command);
+					}
+				}
+				else if (method == 2)
+				{
+					queue.Sort();
+					sortTime += chrono::steady_clock::now() - submitted;
+				}
+
+				backend.Clear();
+				auto executeStart = chrono::steady_clock::now();
+				queue.Execute(backend);
+				executeTime += chrono::steady_clock::now() - executeStart;
+			}
+
+			// The radix sort is stable, so it gives the same order as the stable comparison sort
+			if (method == 2)
+			{
+				for (uint32_t i = 0; i < packetCount; ++i)
+				{
+					if (queue.Packets()[i].Command != comparisonSorted[i].Command)
+					{
+						throw GameException("The radix sort disagrees with the comparison sort.");
+					}
+				}
+			}
+
+			const RenderQueue::Statistics& statistics = queue.LastStatistics();
+			double packetFrames = static_cast<double>(frameCount) * packetCount;
+			stream << methodNames[method] << ',' << submitTime.count() / packetFrames << ',' << sortTime.count() / packetFrames << ',' << executeTime.count() / packetFrames << ','
+				<< statistics.PassBinds << ',' << statistics.ShaderBinds << ',' << statistics.TextureBinds << endl;
+		}
+
+		return 0;
+	}
+
+	int HeadlessModes::RunEventSearch(const vector<wstring>& arguments)
+	{
+		double years = (arguments.size() > 2 ? wcstod(arguments[2].c_str(), nullptr) : 100.0);
+		wstring eventsFileName = (arguments.size() > 3 ? arguments[3] : L"Events.csv");
+
+		BodyCatalog catalog(BodyCatalogFileName);
+		ThreadPool threadPool;
+		EventFinder finder(catalog, threadPool);
+		finder.WriteEvents(eventsFileName, finder.Find(EventFinder::DefaultSettings(0.0, years * 365.25)));
+
+		return 0;
+	}
+
+	int HeadlessModes::RunShardedSimulation(const vector<wstring>& arguments)
+	{
+		uint32_t shardCount = (arguments.size() > 2 ? wcstoul(arguments[2].c_str(), nullptr, 10) : max(thread::hardware_concurrency(), 1U));
+		uint32_t beltCount = (arguments.size() > 3 ? wcstoul(arguments[3].c_str(), nullptr, 10) : 20000);
+		double years = (arguments.size() > 4 ? wcstod(arguments[4].c_str(), nullptr) : 1.0);
+		wstring snapshotFileName = (arguments.size() > 5 ? arguments[5] : L"ShardedSnapshot.csv");
+
+		BodyCatalog catalog(BodyCatalogFileName);
+		vector<ShardParticle> particles = ShardedSimulation::FromCatalog(catalog, beltCount, 1);
+
+		// Every shard has room for twice its share, and each ring for a whole shard, so neither migration nor ghosts are lost
+		uint32_t particlesPerShard = static_cast<uint32_t>((particles.size() + max(shardCount, 1U) - 1) / max(shardCount, 1U));
+		uint32_t ringCapacity = 1;
+		while (ringCapacity < 2 * particlesPerShard)
+		{
+			ringCapacity *= 2;
+		}
+
+		ShardedSimulationSettings settings;
+		settings.ShardCount = shardCount;
+		settings.MaxParticlesPerShard = 2 * particlesPerShard;
+		settings.RingCapacity = ringCapacity;
+		settings.TimeStepDays = 0.5;
+		settings.GhostMargin = 0.05;
+		settings.Softening = 1.0e-4;
+
+		ShardedSimulation simulation(settings, move(particles));
+		uint64_t stepCount = static_cast<uint64_t>(years * 365.25 / settings.TimeStepDays);
+		while (simulation.CommittedStep() < stepCount)
+		{
+			simulation.Step();
+		}
+
+		simulation.WriteSnapshot(snapshotFileName);
+
+		return 0;
+	}
+
+	int HeadlessModes::RunShardWorker(const vector<wstring>& arguments)
+	{
+		if (arguments.size() != 5)
+		{
+			throw GameException("A shard worker takes a region, a shard and a coordinator process.");
+		}
+
+		uint32_t shard = wcstoul(arguments[3].c_str(), nullptr, 10);
+		uint32_t coordinatorProcessId = wcstoul(arguments[4].c_str(), nullptr, 10);
+
+		return ShardWorker::Run(arguments[2], shard, coordinatorProcessId);
+	}
+
+	int HeadlessModes::RunParameterSweep(const vector<wstring>& arguments)
+	{
+		wstring gridFileName = (arguments.size() > 2 ? arguments[2] : L"Sweep.txt");
+		wstring resultsFileName = (arguments.size() > 3 ? arguments[3] : L"SweepResults.bin");
+		uint32_t jobTimeoutSeconds = (arguments.size() > 4 ? wcstoul(arguments[4].c_str(), nullptr, 10) : ParameterSweep::DefaultJobTimeoutSeconds);
+
+		ParameterSweep sweep(ParameterSweep::LoadGrid(gridFileName), resultsFileName);
+		return (sweep.Run(0, jobTimeoutSeconds) == 0 ? 0 : 1);
+	}
+
+	int HeadlessModes::RunSweepWorker(const vector<wstring>& arguments)
+	{
+		UNREFERENCED_PARAMETER(arguments);
+
+		return SweepWorker::Run(BodyCatalogFileName);
+	}
+
+	int HeadlessModes::RunAngleBenchmark(const vector<wstring>& arguments)
+	{
+		uint32_t stepCount = (arguments.size() > 2 ? wcstoul(arguments[2].c_str(), nullptr, 10) : 10000000);
+		wstring resultsFileName = (arguments.size() > 3 ? arguments[3] : L"AngleBenchmark.csv");
+
+		// A quarter of a day per step, about a frame at the default time scale. It is exact in binary, so the total is too
+		const double daysPerStep = 0.25;
+		const uint32_t throughputAngleCount = 4096;
+		const uint32_t throughputStepCount = 100000;
+
+		BodyCatalog catalog(BodyCatalogFileName);
+		vector<double> rates;
+		for (uint32_t i = 0; i < catalog.Count(); ++i)
+		{
+			const BodyCatalogRecord& record = catalog.Record(i);
+			if (record.RotationDays > 0.0f)
+			{
+				rates.push_back(360.0 / record.RotationDays);
+			}
+
+			if (record.RevolutionDays > 0.0f)
+			{
+				rates.push_back(360.0 / record.RevolutionDays);
+			}
+		}
+
+		if (rates.empty())
+		{
+			throw GameException("The body catalog has no rotating or revolving bodies.");
+		}
+
+		// The throughput is measured with the rates of the bodies repeated over enough angles to hide the loop overhead
+		vector<double> throughputRates(throughputAngleCount);
+		for (uint32_t i = 0; i < throughputAngleCount; ++i)
+		{
+			throughputRates[i] = rates[i % rates.size()];
+		}
+
+		// The reference splits off the high 26 bits of the rate, whose product with the total days is exact, so there is
+		// no rounding of a large angle before the modulo
+		auto exactAngle = [](double rate, double days)
+		{
+			double scaled = 134217729.0 * rate;
+			double rateHigh = scaled - (scaled - rate);
+			double angle = fmod(rateHigh * days, 360.0) + (rate - rateHigh) * days;
+			return angle - 360.0 * floor(angle / 360.0);
+		};
+
+		ofstream stream;
+		OpenForWriting(stream, resultsFileName);
+		if (stream.is_open() == false)
+		{
+			throw GameException("Could not open the benchmark results file.");
+		}
+
+		stream << "Precision,NanosecondsPerAngleStep,MaxDriftDegrees,RmsDriftDegrees" << endl;
+		stream << scientific << setprecision(3);
+
+		const AnglePrecision precisions[] = { AnglePrecision::Single, AnglePrecision::CompensatedSingle, AnglePrecision::Double };
+		const char* precisionNames[] = { "Single", "CompensatedSingle", "Double" };
+		for (uint32_t p = 0; p < _countof(precisions); ++p)
+		{
+			AngleAccumulator throughputAngles(precisions[p], throughputAngleCount);
+			throughputAngles.SetRates(throughputRates.data());
+
+			auto start = chrono::steady_clock::now();
+			for (uint32_t step = 0; step < throughputStepCount; ++step)
+			{
+				throughputAngles.Advance(daysPerStep);
+			}
+
+			chrono::duration<double, nano> elapsed = chrono::steady_clock::now() - start;
+			double nanosecondsPerAngleStep = elapsed.count() / (static_cast<double>(throughputAngleCount) * throughputStepCount);
+
+			AngleAccumulator angles(precisions[p], static_cast<uint32_t>(rates.size()));
+			angles.SetRates(rates.data());
+			for (uint32_t step = 0; step < stepCount; ++step)
+			{
+				angles.Advance(daysPerStep);
+			}
+
+			double totalDays = stepCount * daysPerStep;
+			double maxDrift = 0.0;
+			double sumOfSquares = 0.0;
+			for (uint32_t i = 0; i < angles.Count(); ++i)
+			{
+				double drift = angles.Angle(i) - exactAngle(rates[i], totalDays);
+				drift -= 360.0 * floor(drift / 360.0 + 0.5);
+				maxDrift = max(maxDrift, fabs(drift));
+				sumOfSquares += drift * drift;
+			}
+
+			stream << precisionNames[p] << ',' << nanosecondsPerAngleStep << ',' << maxDrift << ',' << sqrt(sumOfSquares / angles.Count()) << endl;
+		}
+
+		return 0;
+	}
+
+	// The modes drawing bodies need DirectXMath, which a portable build may be without
+#if defined(LIBRARY_HAS_DIRECTXMATH)
+	int HeadlessModes::RunRenderDeviceBenchmark(const vector<wstring>& arguments)
+	{
+		uint32_t bodyCount = (arguments.size() > 2 ? wcstoul(arguments[2].c_str(), nullptr, 10) : 10000);
+		wstring resultsFileName = (arguments.size() > 3 ? arguments[3] : L"RenderDeviceBenchmark.csv");
+		wstring streamFileName = (arguments.size() > 4 ? arguments[4] : L"RenderDeviceStream.txt");
+
+		const uint32_t frameCount = 100;
+		const uint32_t meshCount = 8;
+		const uint32_t meshVertexCount = 2401;
+		const uint32_t meshIndexCount = 13824;
+		const uint32_t frameConstantBufferSize = 1024 * 1024;
+
+		struct CBufferPerFrame
+		{
+			XMFLOAT4X4 ViewProjection;
+			XMFLOAT4 LightPositionAndRange;
+			XMFLOAT4 LightColor;
+		};
+
+		struct CBufferPerBatch
+		{
+			uint32_t FirstInstance;
+			uint32_t Padding[3];
+		};
+
+		// The work of the planet renderer each frame: write the instance buffer and the constants, submit a packet for each mesh, and bind the rest of the state and draw as the queue executes it
+		struct PlanetClient final : public RenderQueueClient
+		{
+			RenderDevice* Device;
+			DeviceConstantBufferStorage* ConstantStorage;
+			uint32_t VertexBuffers[meshCount];
+			uint32_t IndexBuffers[meshCount];
+			uint32_t InstanceBuffer;
+			const vector<InstanceBatch>* Batches;
+			FrameConstantAllocator::Allocation PerFrameConstants;
+			vector<FrameConstantAllocator::Allocation> PerBatchConstants;
+
+			virtual void ExecuteDraw(uint32_t command) override
+			{
+				const InstanceBatch& batch = Batches->at(command);
+				Device->SetPrimitiveTopology(RenderDevice::PrimitiveTopology::TriangleList);
+				Device->SetVertexBuffer(VertexBuffers[batch.Mesh], sizeof(VertexPositionTextureNormal));
+				Device->SetIndexBuffer(IndexBuffers[batch.Mesh]);
+				ConstantStorage->SetConstantBuffer(RenderDevice::ShaderStage::Vertex, 0, PerFrameConstants);
+				ConstantStorage->SetConstantBuffer(RenderDevice::ShaderStage::Vertex, 1, PerBatchConstants[command]);
+				ConstantStorage->SetConstantBuffer(RenderDevice::ShaderStage::Pixel, 0, PerFrameConstants);
+				Device->SetStructuredBuffer(RenderDevice::ShaderStage::Vertex, 0, InstanceBuffer);
+				Device->SetStructuredBuffer(RenderDevice::ShaderStage::Pixel, 0, InstanceBuffer);
+				Device->SetSampler(RenderDevice::ShaderStage::Pixel, 0, RenderDevice::SamplerType::TrilinearWrap);
+				Device->DrawIndexedInstanced(meshIndexCount, batch.InstanceCount, 0, 0, 0);
+			}
+		};
+
+		// A fixed seed draws the same bodies on every run
+		mt19937 generator(20261018);
+		uniform_real_distribution<float> coordinate(-1000.0f, 1000.0f);
+		uniform_int_distribution<uint32_t> mesh(0, meshCount - 1);
+		vector<pair<uint32_t, PlanetInstance>> bodies(bodyCount);
+		for (uint32_t i = 0; i < bodyCount; ++i)
+		{
+			PlanetInstance& instance = bodies[i].second;
+			ZeroMemory(&instance, sizeof(instance));
+			XMStoreFloat4x4(&instance.World, XMMatrixTranspose(XMMatrixTranslation(coordinate(generator), coordinate(generator), coordinate(generator))));
+			instance.TextureSlice = i % meshCount;
+			bodies[i].first = mesh(generator);
+		}
+
+		ofstream stream;
+		OpenForWriting(stream, resultsFileName);
+		if (stream.is_open() == false)
+		{
+			throw GameException("Could not open the benchmark results file.");
+		}
+
+		stream << "Device,NanosecondsPerFrame,CallsPerFrame,DrawsPerFrame,StateChangesPerFrame,RedundantStateChangesPerFrame,BytesUploadedPerFrame" << endl;
+		stream << fixed << setprecision(3);
+
+		const char* deviceNames[] = { "Counting", "Recording" };
+		for (uint32_t recording = 0; recording < _countof(deviceNames); ++recording)
+		{
+			RecordingRenderDevice device(recording != 0);
+			DeviceRenderBackend backend(device);
+			auto constantStorage = make_unique<DeviceConstantBufferStorage>(device, frameConstantBufferSize);
+			DeviceConstantBufferStorage* constantStoragePointer = constantStorage.get();
+			FrameConstantAllocator frameConstants(move(constantStorage));
+			RenderQueue queue;
+			InstanceBatcher batcher;
+
+			// The resources are created once at the start and left out of the results per frame
+			vector<char> shaderBytecode(4096);
+			const RenderDevice::VertexElement vertexElements[] =
+			{
+				{ "POSITION", 0, RenderDevice::VertexFormat::Float4 },
+				{ "TEXCOORD", 0, RenderDevice::VertexFormat::Float2 },
+				{ "NORMAL", 0, RenderDevice::VertexFormat::Float3 }
+			};
+
+			uint32_t shader = backend.AddShader(device.CreateShader(shaderBytecode.data(), shaderBytecode.size(), shaderBytecode.data(), shaderBytecode.size(), vertexElements, _countof(vertexElements)));
+			uint32_t colorTextures = backend.AddTexture(device.CreateTexture({ InstanceBatcher::TextureWidth, InstanceBatcher::TextureHeight, 11, meshCount }, nullptr), 1);
+
+			PlanetClient client;
+			client.Device = &device;
+			client.ConstantStorage = constantStoragePointer;
+			vector<VertexPositionTextureNormal> vertices(meshVertexCount);
+			vector<uint32_t> indices(meshIndexCount);
+			for (uint32_t i = 0; i < meshCount; ++i)
+			{
+				client.VertexBuffers[i] = device.CreateBuffer({ RenderDevice::BufferType::Vertex, false, static_cast<uint32_t>(sizeof(VertexPositionTextureNormal)) * meshVertexCount, 0 }, vertices.data());
+				client.IndexBuffers[i] = device.CreateBuffer({ RenderDevice::BufferType::Index, false, static_cast<uint32_t>(sizeof(uint32_t)) * meshIndexCount, 0 }, indices.data());
+			}
+
+			client.InstanceBuffer = device.CreateBuffer({ RenderDevice::BufferType::Structured, true, static_cast<uint32_t>(sizeof(PlanetInstance)) * max(bodyCount, 1U), sizeof(PlanetInstance) }, nullptr);
+			client.Batches = nullptr;
+
+			uint64_t key = RenderQueue::MakeKey(DeviceRenderBackend::DefaultPass, shader, colorTextures, 0.0f);
+			CBufferPerFrame perFrame;
+			ZeroMemory(&perFrame, sizeof(perFrame));
+
+			RecordingRenderDevice::Statistics totals = {};
+			chrono::duration<double, nano> frameTime(0);
+			for (uint32_t frame = 0; frame < frameCount; ++frame)
+			{
+				device.Clear();
+				auto start = chrono::steady_clock::now();
+
+				frameConstants.BeginFrame();
+				queue.Clear();
+				batcher.Clear();
+				for (const auto& body : bodies)
+				{
+					batcher.Add(body.first, body.second);
+				}
+
+				device.SetStructuredBuffer(RenderDevice::ShaderStage::Vertex, 0, RenderDevice::NullHandle);
+				device.SetStructuredBuffer(RenderDevice::ShaderStage::Pixel, 0, RenderDevice::NullHandle);
+				client.Batches = &batcher.Build(static_cast<PlanetInstance*>(device.Map(client.InstanceBuffer, true)));
+				device.Unmap(client.InstanceBuffer, static_cast<uint32_t>(sizeof(PlanetInstance)) * bodyCount);
+
+				client.PerFrameConstants = frameConstants.Upload(perFrame);
+				client.PerBatchConstants.clear();
+				for (uint32_t batch = 0; batch < client.Batches->size(); ++batch)
+				{
+					CBufferPerBatch perBatch = { (*client.Batches)[batch].FirstInstance, { 0, 0, 0 } };
+					client.PerBatchConstants.push_back(frameConstants.Upload(perBatch));
+					queue.Submit(key, client, batch);
+				}
+
+				frameConstants.Flush();
+				queue.Sort();
+				queue.Execute(backend);
+				frameTime += chrono::steady_clock::now() - start;
+
+				const RecordingRenderDevice::Statistics& statistics = device.RecordedStatistics();
+				totals.Calls += statistics.Calls;
+				totals.Draws += statistics.Draws;
+				totals.StateChanges += statistics.StateChanges;
+				totals.RedundantStateChanges += statistics.RedundantStateChanges;
+				totals.BytesUploaded += statistics.BytesUploaded;
+			}
+
+			stream << deviceNames[recording] << ',' << frameTime.count() / frameCount << ',' << static_cast<double>(totals.Calls) / frameCount << ',' << static_cast<double>(totals.Draws) / frameCount << ','
+				<< static_cast<double>(totals.StateChanges) / frameCount << ',' << static_cast<double>(totals.RedundantStateChanges) / frameCount << ',' << static_cast<double>(totals.BytesUploaded) / frameCount << endl;
+
+			if (recording != 0)
+			{
+				// The recorded draws must cover every body exactly once
+				uint32_t drawnInstances = 0;
+				for (const RecordingRenderDevice::Command& command : device.Commands())
+				{
+					if (command.Type == RecordingRenderDevice::CommandType::DrawIndexedInstanced)
+					{
+						drawnInstances += command.Arguments[1];
+					}
+				}
+
+				if (drawnInstances != bodyCount)
+				{
+					throw GameException("The recorded draws do not cover every body.");
+				}
+
+				ofstream commandStream;
+				OpenForWriting(commandStream, streamFileName);
+				if (commandStream.is_open() == false)
+				{
+					throw GameException("Could not open the benchmark command stream file.");
+				}
+
+				device.Serialize(commandStream);
+			}
+		}
+
+		return 0;
+	}
+
+	int HeadlessModes::RunSoftwareRasterBenchmark(const vector<wstring>& arguments)
+	{
+		uint32_t bodyCount = (arguments.size() > 2 ? wcstoul(arguments[2].c_str(), nullptr, 10) : 1000);
+		wstring resultsFileName = (arguments.size() > 3 ? arguments[3] : L"SoftwareRasterBenchmark.csv");
+		wstring imageFileName = (arguments.size() > 4 ? arguments[4] : L"SoftwareRaster.ppm");
+
+		const uint32_t frameCount = 20;
+		const uint32_t imageWidth = 1440;			// The size of the window of the game
+		const uint32_t imageHeight = 1080;
+		const uint32_t sliceCount = 8;
+		const uint32_t textureWidth = 256;
+		const uint32_t textureHeight = 128;
+		const uint32_t skyboxSize = 256;
+		const uint32_t sphereSlices = 48;
+		const uint32_t sphereStacks = 24;
+		const float sceneExtent = 1000.0f;
+		const float sunRadius = 60.0f;
+		const float skyboxScale = 5000.0f;
+
+		// A unit sphere divided by latitude and longitude, with the vertex format of Sphere.obj
+		vector<VertexPositionTextureNormal> sphereVertices;
+		for (uint32_t stack = 0; stack <= sphereStacks; ++stack)
+		{
+			float polar = XM_PI * stack / sphereStacks;
+			for (uint32_t slice = 0; slice <= sphereSlices; ++slice)
+			{
+				float azimuth = XM_2PI * slice / sphereSlices;
+				XMFLOAT3 normal(sinf(polar) * cosf(azimuth), cosf(polar), sinf(polar) * sinf(azimuth));
+				sphereVertices.push_back(VertexPositionTextureNormal(XMFLOAT4(normal.x, normal.y, normal.z, 1.0f), XMFLOAT2(static_cast<float>(slice) / sphereSlices, static_cast<float>(stack) / sphereStacks), normal));
+			}
+		}
+
+		vector<uint32_t> sphereIndices;
+		for (uint32_t stack = 0; stack < sphereStacks; ++stack)
+		{
+			for (uint32_t slice = 0; slice < sphereSlices; ++slice)
+			{
+				uint32_t upperLeft = stack * (sphereSlices + 1) + slice;
+				uint32_t lowerLeft = upperLeft + sphereSlices + 1;
+				sphereIndices.insert(sphereIndices.end(), { upperLeft, lowerLeft, upperLeft + 1, upperLeft + 1, lowerLeft, lowerLeft + 1 });
+			}
+		}
+
+		// A fixed seed draws the same image on every run
+		mt19937 generator(20261018);
+		uniform_real_distribution<float> unit(0.0f, 1.0f);
+
+		// Each slice of the texture is bands of latitude in a color of its own
+		vector<vector<DecodedImage>> colorMipChains;
+		for (uint32_t slice = 0; slice < sliceCount; ++slice)
+		{
+			DecodedImage image;
+			image.Width = textureWidth;
+			image.Height = textureHeight;
+			image.Pixels.resize(textureWidth * textureHeight * 4);
+			for (uint32_t y = 0; y < textureHeight; ++y)
+			{
+				float band = 0.6f + 0.4f * sinf(y * 0.3f + slice);
+				for (uint32_t x = 0; x < textureWidth; ++x)
+				{
+					uint8_t* pixel = &image.Pixels[(y * textureWidth + x) * 4];
+					float grain = 0.85f + 0.15f * unit(generator);
+					pixel[0] = static_cast<uint8_t>(255.0f * band * grain * (0.5f + 0.5f * ((slice & 1) != 0)));
+					pixel[1] = static_cast<uint8_t>(255.0f * band * grain * (0.5f + 0.5f * ((slice & 2) != 0)));
+					pixel[2] = static_cast<uint8_t>(255.0f * band * grain * (0.5f + 0.5f * ((slice & 4) != 0)));
+					pixel[3] = 255;
+				}
+			}
+
+			colorMipChains.push_back(TextureCache::BuildMipChain(move(image)));
+		}
+
+		// The six faces of the skybox are random stars on black
+		vector<vector<DecodedImage>> skyboxMipChains;
+		for (uint32_t face = 0; face < SoftwareTexture::CubeFaceCount; ++face)
+		{
+			DecodedImage image;
+			image.Width = skyboxSize;
+			image.Height = skyboxSize;
+			image.Pixels.resize(skyboxSize * skyboxSize * 4, 0);
+			for (uint32_t i = 0; i < skyboxSize * skyboxSize; ++i)
+			{
+				if (unit(generator) < 0.01f)
+				{
+					uint8_t brightness = static_cast<uint8_t>(128.0f + 127.0f * unit(generator));
+					fill_n(&image.Pixels[i * 4], 3, brightness);
+				}
+
+				image.Pixels[i * 4 + 3] = 255;
+			}
+
+			skyboxMipChains.push_back(TextureCache::BuildMipChain(move(image)));
+		}
+
+		auto createTexture = [](const vector<vector<DecodedImage>>& mipChains)
+		{
+			vector<RenderDevice::SubresourceData> subresources;
+			for (const vector<DecodedImage>& mipChain : mipChains)
+			{
+				for (const DecodedImage& level : mipChain)
+				{
+					subresources.push_back({ level.Pixels.data(), level.Width * 4 });
+				}
+			}
+
+			const DecodedImage& largest = mipChains.front().front();
+			RenderDevice::TextureDescription description = { largest.Width, largest.Height, static_cast<uint32_t>(mipChains.front().size()), static_cast<uint32_t>(mipChains.size()) };
+			return make_unique<SoftwareTexture>(description, subresources.data());
+		};
+
+		unique_ptr<SoftwareTexture> colorMaps = createTexture(colorMipChains);
+		unique_ptr<SoftwareTexture> skyboxTexture = createTexture(skyboxMipChains);
+
+		const VertexPosition cubeVertices[] =
+		{
+			XMFLOAT4(-1.0f, -1.0f, -1.0f, 1.0f), XMFLOAT4(1.0f, -1.0f, -1.0f, 1.0f), XMFLOAT4(-1.0f, 1.0f, -1.0f, 1.0f), XMFLOAT4(1.0f, 1.0f, -1.0f, 1.0f),
+			XMFLOAT4(-1.0f, -1.0f, 1.0f, 1.0f), XMFLOAT4(1.0f, -1.0f, 1.0f, 1.0f), XMFLOAT4(-1.0f, 1.0f, 1.0f, 1.0f), XMFLOAT4(1.0f, 1.0f, 1.0f, 1.0f)
+		};
+
+		const uint32_t cubeIndices[] =
+		{
+			0, 2, 1, 1, 2, 3, 4, 5, 6, 5, 7, 6, 0, 1, 4, 1, 5, 4, 2, 6, 3, 3, 6, 7, 0, 4, 2, 2, 4, 6, 1, 3, 5, 3, 7, 5
+		};
+
+		// The light source is at the origin, and the other bodies are scattered in a thin disc around it
+		uniform_real_distribution<float> orbitRadius(2.5f * sunRadius, sceneExtent);
+		uniform_real_distribution<float> angle(0.0f, XM_2PI);
+		uniform_real_distribution<float> height(-20.0f, 20.0f);
+		uniform_real_distribution<float> bodyRadius(2.0f, 20.0f);
+		ShadowOccluders occluders;
+		ZeroMemory(&occluders, sizeof(occluders));
+		occluders.LightRadius = sunRadius;
+
+		vector<XMFLOAT4> spheres(bodyCount);
+		vector<PlanetInstance> bodies(bodyCount);
+		for (uint32_t i = 0; i < bodyCount; ++i)
+		{
+			float radius = (i == 0 ? sunRadius : bodyRadius(generator));
+			float distance = (i == 0 ? 0.0f : orbitRadius(generator));
+			float direction = angle(generator);
+			spheres[i] = XMFLOAT4(distance * cosf(direction), (i == 0 ? 0.0f : height(generator)), distance * sinf(direction), radius);
+
+			XMMATRIX world = XMMatrixScaling(radius, radius, radius) * XMMatrixTranslation(spheres[i].x, spheres[i].y, spheres[i].z);
+			bodies[i] = InstanceBatcher::Pack(world, occluders, i % sliceCount, (i == 0 ? 1.0f : 0.05f));
+		}
+
+		XMVECTOR eyePosition = XMVectorSet(0.0f, 0.35f * sceneExtent, 1.6f * sceneExtent, 1.0f);
+		float aspectRatio = static_cast<float>(imageWidth) / static_cast<float>(imageHeight);
+		XMMATRIX viewProjection = XMMatrixLookAtRH(eyePosition, XMVectorZero(), g_XMIdentityR1) * XMMatrixPerspectiveFovRH(XM_PIDIV4, aspectRatio, 1.0f, 2.0f * skyboxScale);
+
+		SoftwarePlanetShader planetShader;
+		SoftwarePlanetShader::FrameConstants frameConstants;
+		ZeroMemory(&frameConstants, sizeof(frameConstants));
+		XMStoreFloat4x4(&frameConstants.ViewProjection, XMMatrixTranspose(viewProjection));
+		frameConstants.LightRange = 4.0f * sceneExtent;
+		frameConstants.LightColor = XMFLOAT3(1.0f, 1.0f, 1.0f);
+		planetShader.SetFrameConstants(frameConstants);
+		planetShader.SetColorMaps(*colorMaps);
+
+		SoftwareSkyboxShader skyboxShader;
+		XMFLOAT3 eye;
+		XMStoreFloat3(&eye, eyePosition);
+		XMFLOAT4X4 skyboxWorldViewProjection;
+		XMStoreFloat4x4(&skyboxWorldViewProjection, XMMatrixTranspose(XMMatrixScaling(skyboxScale, skyboxScale, skyboxScale) * XMMatrixTranslation(eye.x, eye.y, eye.z) * viewProjection));
+		skyboxShader.SetWorldViewProjection(skyboxWorldViewProjection);
+		skyboxShader.SetSkyboxTexture(*skyboxTexture);
+
+		ofstream stream;
+		OpenForWriting(stream, resultsFileName);
+		if (stream.is_open() == false)
+		{
+			throw GameException("Could not open the benchmark results file.");
+		}
+
+		stream << "Threads,MillisecondsPerFrame,Triangles,RasterizedTriangles,BinnedTriangles,Fragments" << endl;
+		stream << fixed << setprecision(3);
+
+		uint32_t hardwareThreads = max(thread::hardware_concurrency(), 1U);
+		DecodedImage reference;
+		DecodedImage image;
+		for (uint32_t threadCount = 1; ; threadCount = min(threadCount * 2, hardwareThreads))
+		{
+			ThreadPool threadPool(threadCount);
+			SoftwareRasterizer rasterizer(threadPool, imageWidth, imageHeight);
+			FrustumCuller culler;
+			InstanceBatcher batcher;
+			vector<PlanetInstance> instances(bodyCount);
+			planetShader.SetInstances(instances.data());
+
+			chrono::duration<double, milli> frameTime(0);
+			for (uint32_t frame = 0; frame < frameCount; ++frame)
+			{
+				auto start = chrono::steady_clock::now();
+
+				// As the planet renderer does: cull the bodies out of view and batch the rest by mesh
+				culler.SetView(viewProjection);
+				culler.Clear();
+				batcher.Clear();
+				for (uint32_t i = 0; i < bodyCount; ++i)
+				{
+					culler.Add(XMFLOAT3(spheres[i].x, spheres[i].y, spheres[i].z), spheres[i].w);
+					batcher.Add(0, bodies[i]);
+				}
+
+				culler.Cull();
+				const vector<InstanceBatch>& batches = batcher.Build(instances.data(), culler.VisibleIndices(), culler.VisibleCount());
+
+				// The skybox is drawn first, as in the game, without culling back faces
+				rasterizer.Clear(XMFLOAT4(0.0f, 0.0f, 0.0f, 1.0f));
+				rasterizer.SetState({ RenderDevice::BlendMode::Opaque, RenderDevice::DepthMode::ReadWrite, RenderDevice::CullMode::None });
+				rasterizer.DrawIndexedInstanced(skyboxShader, cubeVertices, sizeof(VertexPosition), _countof(cubeVertices), cubeIndices, _countof(cubeIndices), 1, 0);
+
+				rasterizer.SetState({ RenderDevice::BlendMode::Opaque, RenderDevice::DepthMode::ReadWrite, RenderDevice::CullMode::Back });
+				for (const InstanceBatch& batch : batches)
+				{
+					rasterizer.DrawIndexedInstanced(planetShader, sphereVertices.data(), sizeof(VertexPositionTextureNormal), static_cast<uint32_t>(sphereVertices.size()),
+						sphereIndices.data(), static_cast<uint32_t>(sphereIndices.size()), batch.InstanceCount, batch.FirstInstance);
+				}
+
+				rasterizer.Execute();
+				frameTime += chrono::steady_clock::now() - start;
+			}
+
+			const SoftwareRasterizer::Statistics& statistics = rasterizer.LastStatistics();
+			stream << threadCount << ',' << frameTime.count() / frameCount << ',' << statistics.Triangles << ',' << statistics.RasterizedTriangles << ','
+				<< statistics.BinnedTriangles << ',' << statistics.Fragments << endl;
+
+			// Triangles are drawn in the order submitted however the work is split, so every thread count must draw the same pixels
+			rasterizer.ReadPixels(image);
+			if (reference.Pixels.empty())
+			{
+				reference = image;
+			}
+			else if (image.Pixels != reference.Pixels)
+			{
+				throw GameException("The image drawn depends on the number of threads.");
+			}
+
+			if (threadCount == hardwareThreads)
+			{
+				break;
+			}
+		}
+
+		ofstream imageStream;
+		OpenForWriting(imageStream, imageFileName, ios::binary);
+		if (imageStream.is_open() == false)
+		{
+			throw GameException("Could not open the benchmark image file.");
+		}
+
+		imageStream << "P6\n" << reference.Width << ' ' << reference.Height << "\n255\n";
+		for (uint32_t i = 0; i < reference.Width * reference.Height; ++i)
+		{
+			imageStream.write(reinterpret_cast<const char*>(&reference.Pixels[i * 4]), 3);
+		}
+
+		return 0;
+	}
+	int HeadlessModes::RunCullingBenchmark(const vector<wstring>& arguments)
+	{
+		uint32_t sphereCount = (arguments.size() > 2 ? wcstoul(arguments[2].c_str(), nullptr, 10) : 1000000);
+		wstring resultsFileName = (arguments.size() > 3 ? arguments[3] : L"CullingBenchmark.csv");
+
+		const uint32_t frameCount = 20;
+		const uint32_t movingFraction = 100;
+		const float sceneExtent = 1000.0f;
+
+		// A fixed seed culls the same scene on every run
+		mt19937 generator(20261018);
+		uniform_real_distribution<float> coordinate(-sceneExtent, sceneExtent);
+		uniform_real_distribution<float> radius(0.1f, 5.0f);
+		vector<XMFLOAT4> spheres(sphereCount);
+		for (XMFLOAT4& sphere : spheres)
+		{
+			sphere.x = coordinate(generator);
+			sphere.y = coordinate(generator);
+			sphere.z = coordinate(generator);
+			sphere.w = radius(generator);
+		}
+
+		// The camera is at the center of the scene with its far plane past the edge, so a few spheres in a hundred are visible
+		XMMATRIX viewProjection = XMMatrixLookToLH(XMVectorZero(), g_XMIdentityR2, g_XMIdentityR1) * XMMatrixPerspectiveFovLH(XM_PIDIV4, 4.0f / 3.0f, 0.1f, 2.0f * sceneExtent);
+		XMFLOAT4 planes[FrustumCuller::PlaneCount];
+		FrustumCuller::ExtractPlanes(viewProjection, planes);
+
+		ofstream stream;
+		OpenForWriting(stream, resultsFileName);
+		if (stream.is_open() == false)
+		{
+			throw GameException("Could not open the benchmark results file.");
+		}
+
+		stream << "Method,NanosecondsPerSphere,VisibleSpheres,TestedSpheresPerFrame" << endl;
+		stream << fixed << setprecision(3);
+
+		// The scalar reference tests one sphere at a time, stopping at the first plane it is behind. It sums in the
+		// order of the SIMD code, so the two agree to the bit
+		vector<uint32_t> scalarVisible;
+		scalarVisible.reserve(sphereCount);
+		auto start = chrono::steady_clock::now();
+		for (uint32_t frame = 0; frame < frameCount; ++frame)
+		{
+			scalarVisible.clear();
+			for (uint32_t i = 0; i < sphereCount; ++i)
+			{
+				const XMFLOAT4& sphere = spheres[i];
+				bool inside = true;
+				for (const XMFLOAT4& plane : planes)
+				{
+					if (sphere.z * plane.z + (sphere.y * plane.y + (sphere.x * plane.x + plane.w)) + sphere.w < 0.0f)
+					{
+						inside = false;
+						break;
+					}
+				}
+
+				if (inside)
+				{
+					scalarVisible.push_back(i);
+				}
+			}
+		}
+
+		chrono::duration<double, nano> elapsed = chrono::steady_clock::now() - start;
+		stream << "Scalar," << elapsed.count() / (static_cast<double>(frameCount) * sphereCount) << ',' << scalarVisible.size() << ',' << sphereCount << endl;
+
+		// Only the culling is timed, not adding the spheres. A run without a name only checks, and writes no results
+		auto runSimd = [&](const char* name, bool temporalCoherence, bool moveSpheres)
+		{
+			FrustumCuller culler;
+			culler.SetTemporalCoherence(temporalCoherence);
+			culler.SetView(viewProjection);
+
+			chrono::duration<double, nano> cullTime(0);
+			uint64_t testedCount = 0;
+			for (uint32_t frame = 0; frame < frameCount; ++frame)
+			{
+				if (moveSpheres && frame > 0)
+				{
+					for (uint32_t i = frame % movingFraction; i < sphereCount; i += movingFraction)
+					{
+						spheres[i].x += 0.01f;
+					}
+				}
+
+				culler.Clear();
+				for (const XMFLOAT4& sphere : spheres)
+				{
+					culler.Add(XMFLOAT3(sphere.x, sphere.y, sphere.z), sphere.w);
+				}
+
+				auto cullStart = chrono::steady_clock::now();
+				culler.Cull();
+				cullTime += chrono::steady_clock::now() - cullStart;
+				testedCount += culler.TestedCount();
+			}
+
+			if (name != nullptr)
+			{
+				stream << name << ',' << cullTime.count() / (static_cast<double>(frameCount) * sphereCount) << ',' << culler.VisibleCount() << ',' << testedCount / frameCount << endl;
+			}
+
+			return vector<uint32_t>(culler.VisibleIndices(), culler.VisibleIndices() + culler.VisibleCount());
+		};
+
+		if (runSimd("Simd", false, false) != scalarVisible)
+		{
+			throw GameException("The SIMD culling disagrees with the scalar reference.");
+		}
+
+		// What temporal coherence keeps must match testing every sphere again after they moved
+		vector<uint32_t> coherentVisible = runSimd("SimdTemporalCoherence", true, true);
+		if (runSimd(nullptr, false, false) != coherentVisible)
+		{
+			throw GameException("The culling results kept by temporal coherence are out of date.");
+		}
+
+		return 0;
+	}
+#endif
+
+	// Rendering frames also needs a decoder for the textures of the bodies
+#if defined(LIBRARY_HAS_DIRECTXMATH) && defined(LIBRARY_HAS_IMAGE_DECODER)
+	int HeadlessModes::RunFrameSequence(const vector<wstring>& arguments)
+	{
+		uint32_t frameCount = (arguments.size() > 2 ? wcstoul(arguments[2].c_str(), nullptr, 10) : 3600);
+		double days = (arguments.size() > 3 ? wcstod(arguments[3].c_str(), nullptr) : 59757.8);
+		wstring fileNamePrefix = (arguments.size() > 4 ? arguments[4] : L"Frame");
+		string focusBodyName = (arguments.size() > 5 ? Utility::ToString(arguments[5]) : string());
+
+		BodyCatalog catalog(BodyCatalogFileName);
+		SolarSystemSimulation simulation(catalog);
+		unique_ptr<Vsop87Theory> planetaryTheory;
+		if (FileExists(PlanetaryTheoryFileName))
+		{
+			planetaryTheory = make_unique<Vsop87Theory>(PlanetaryTheoryFileName);
+			planetaryTheory->SetTruncation(1.0e-7);
+			simulation.SetPlanetaryTheory(*planetaryTheory);
+		}
+
+		FrameSequenceSettings settings = FrameSequenceRenderer::DefaultSettings(0.0, days, frameCount);
+		settings.FileNamePrefix = fileNamePrefix;
+		if (focusBodyName.empty() == false)
+		{
+			settings.FocusBody = catalog.IndexOf(focusBodyName);
+			if (settings.FocusBody < 0)
+			{
+				throw GameException("The body to follow is not in the catalog.");
+			}
+		}
+
+		ThreadPool threadPool;
+#if defined(LIBRARY_PORTABLE)
+		TextureCache textureCache(threadPool, PortableImageDecoder::Decode);
+#else
+		TextureCache textureCache(threadPool, WicImageDecoder::Decode);
+#endif
+		Model model(ModelFileName);
+		FrameSequenceRenderer renderer(catalog, *model.Meshes().at(0), textureCache, threadPool);
+		renderer.Render(simulation, settings);
+
+		return 0;
+	}
+#endif
+}
\ No newline at end of file
@@ -0,0 +1,107 @@
+#pragma once
+
+#include <vector>
+#include <string>
+
+namespace Rendering
+{
+	/**
+	* The command line modes exercising the render path without a window or a graphics device. They are run by the
+	* game under their switches and, on any platform, by the HeadlessRenderer console tool under the same switches.
+	* Each takes the whole command line, with its switch second and its own arguments after, and returns the exit code
+	* of the process.
+	*/
+	class HeadlessModes final
+	{
+	public:
+		/**
+		* Benchmark the render queue: random draw packets are executed on a backend that only records them, unsorted,
+		* sorted by a comparison sort and sorted by the radix sort of the queue. Writes the time to submit, sort and
+		* execute each packet with each method, and the binds left once redundant state is filtered out.
+		* Arguments: the number of packets per frame and the results file.
+		*/
+		static int RunRenderQueueBenchmark(const std::vector<std::wstring>& arguments);
+		/**
+		* Benchmark the render device: the bodies are written to an instance buffer and constants every frame as the
+		* planet renderer does, and submitted through a render queue to a device that only counts its calls or also
+		* records them. Writes the time, calls, draws, state changes and bytes uploaded per frame of each device, and
+		* the command stream of the last recorded frame as text, to compare the commands a change to the render path
+		* issues.
+		* Arguments: the number of bodies, the results file and the command stream file.
+		*/
+		static int RunRenderDeviceBenchmark(const std::vector<std::wstring>& arguments);
+		/**
+		* Benchmark the software rasterizer: the skybox and every body are drawn on the CPU at the size of the window,
+		* with the threads doubling from one to every hardware thread. Writes the time, triangles and fragments per
+		* frame at each thread count, checks every count draws the same image, and writes that image as a PPM, a
+		* preview without a graphics device and a reference for regressions.
+		* Arguments: the number of bodies, the results file and the image file.
+		*/
+		static int RunSoftwareRasterBenchmark(const std::vector<std::wstring>& arguments);
+		/**
+		* Benchmark the frustum culler: random bounding spheres are culled by a scalar reference testing one at a time,
+		* by the culler four at a time, and by the culler with temporal coherence while the camera stays still and one
+		* sphere in a hundred moves every frame. Writes the time per sphere, the spheres visible and the spheres tested
+		* per frame of each method, and checks every method keeps the same spheres.
+		* Arguments: the number of spheres and the results file.
+		*/
+		static int RunCullingBenchmark(const std::vector<std::wstring>& arguments);
+		/**
+		* Render a sequence of frames offline: the simulation is evaluated at the time of each frame and the frame
+		* drawn on the CPU and written as a numbered QOI image, with simulating, drawing and encoding pipelined across
+		* threads. By default a 4K sequence of one revolution of Neptune in 3600 frames, seen from above the ecliptic
+		* and looking at the light source.
+		* Arguments: the number of frames, the days simulated, the prefix of the frame files and the name of the body
+		* the camera follows.
+		*/
+		static int RunFrameSequence(const std::vector<std::wstring>& arguments);
+		/**
+		* Find the eclipses, transits, occultations and conjunctions seen from every body that is not a light source,
+		* from the start of the simulation on, and write them by time with the names of the bodies involved.
+		* Arguments: the number of years searched and the events file.
+		*/
+		static int RunEventSearch(const std::vector<std::wstring>& arguments);
+		/**
+		* Simulate the light source, the bodies circling it and a belt of particles across worker processes, each
+		* shard a slab of space along the x axis, and write the snapshot the coordinator gathers at the end.
+		* Arguments: the number of shards, the number of belt particles, the years simulated and the snapshot file.
+		*/
+		static int RunShardedSimulation(const std::vector<std::wstring>& arguments);
+		/**
+		* Serve one shard of a sharded simulation; the simulation starts its workers under this switch itself.
+		* Arguments: the name of the shared memory region, the shard and the process of the coordinator.
+		*/
+		static int RunShardWorker(const std::vector<std::wstring>& arguments);
+		/**
+		* Run every combination of a grid of integration parameters on the solar system, one worker process per
+		* hardware thread. A worker running a job past its deadline is terminated and relaunched, and the combinations
+		* already in the results file are skipped when the sweep is run again.
+		* Arguments: the grid file, the results file and the seconds each combination may run.
+		*/
+		static int RunParameterSweep(const std::vector<std::wstring>& arguments);
+		/**
+		* Serve the jobs of a parameter sweep over standard input and output; the sweep starts its workers under this
+		* switch itself.
+		*/
+		static int RunSweepWorker(const std::vector<std::wstring>& arguments);
+		/**
+		* Benchmark the accumulation of angles: the rotation and revolution angles of the bodies in the catalog are
+		* advanced in single, compensated single and double precision. Writes the time per angle and step of each
+		* precision, and the largest and root mean square drift from the exact angle after the given steps.
+		* Arguments: the number of steps and the results file.
+		*/
+		static int RunAngleBenchmark(const std::vector<std::wstring>& arguments);
+
+		static const std::wstring RenderQueueBenchmarkSwitch;
+		static const std::wstring RenderDeviceBenchmarkSwitch;
+		static const std::wstring SoftwareRasterBenchmarkSwitch;
+		static const std::wstring CullingBenchmarkSwitch;
+		static const std::wstring FrameSequenceSwitch;
+		static const std::wstring EventSearchSwitch;
+		static const std::wstring ShardedSimulationSwitch;
+		static const std::wstring ParameterSweepSwitch;
+		static const std::wstring AngleBenchmarkSwitch;
+
+		HeadlessModes() = delete;
+	};
+}
\ No newline at end of file
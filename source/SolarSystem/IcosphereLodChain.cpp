@@ -0,0 +1,244 @@
+#include "pch.h"
+
+using namespace std;
+using namespace Library;
+using namespace DirectX;
+
+namespace Rendering
+{
+	namespace
+	{
+		// The longitude at which u is 0 on the sphere model the bodies were textured for
+		const float SeamLongitude = -XM_PI / 10.0f;
+
+		uint64_t EdgeKey(uint32_t a, uint32_t b)
+		{
+			return (static_cast<uint64_t>(min(a, b)) << 32) | max(a, b);
+		}
+
+		float TextureU(const XMFLOAT3& position)
+		{
+			float u = -(atan2(position.z, position.x) - SeamLongitude) / XM_2PI;
+			return u - floor(u);
+		}
+
+		bool IsPole(const XMFLOAT3& position)
+		{
+			return position.x == 0.0f && position.z == 0.0f;
+		}
+	}
+
+	const float IcosphereLodChain::PixelErrorThreshold = 0.5f;
+	const float IcosphereLodChain::CoarseningFraction = 0.75f;
+
+	IcosphereLodChain::IcosphereLodChain(float radius) :
+		mRadius(radius), mLevels()
+	{
+		// An icosahedron with a vertex at each pole and two rings of five between them, a fifth of a turn apart
+		vector<XMFLOAT3> positions;
+		positions.reserve(12);
+		positions.push_back(XMFLOAT3(0.0f, 1.0f, 0.0f));
+		const float ringHeight = 1.0f / sqrt(5.0f);
+		const float ringRadius = 2.0f / sqrt(5.0f);
+		for (uint32_t ring = 0; ring < 2; ++ring)
+		{
+			for (uint32_t i = 0; i < 5; ++i)
+			{
+				float longitude = (static_cast<float>(i) + 0.5f * static_cast<float>(ring)) * XM_2PI / 5.0f;
+				positions.push_back(XMFLOAT3(ringRadius * cos(longitude), (ring == 0 ? ringHeight : -ringHeight), ringRadius * sin(longitude)));
+			}
+		}
+		positions.push_back(XMFLOAT3(0.0f, -1.0f, 0.0f));
+
+		vector<uint32_t> triangles;
+		triangles.reserve(60);
+		for (uint32_t i = 0; i < 5; ++i)
+		{
+			uint32_t upper = 1 + i;
+			uint32_t nextUpper = 1 + (i + 1) % 5;
+			uint32_t lower = 6 + i;
+			uint32_t nextLower = 6 + (i + 1) % 5;
+			triangles.insert(triangles.end(), { 0, upper, nextUpper });
+			triangles.insert(triangles.end(), { upper, lower, nextUpper });
+			triangles.insert(triangles.end(), { nextUpper, lower, nextLower });
+			triangles.insert(triangles.end(), { 11, nextLower, lower });
+		}
+
+		// Wind every triangle clockwise seen from outside, as the front faces of the sphere model are
+		for (size_t i = 0; i < triangles.size(); i += 3)
+		{
+			XMVECTOR a = XMLoadFloat3(&positions[triangles[i]]);
+			XMVECTOR b = XMLoadFloat3(&positions[triangles[i + 1]]);
+			XMVECTOR c = XMLoadFloat3(&positions[triangles[i + 2]]);
+			if (XMVectorGetX(XMVector3Dot(XMVector3Cross(b - a, c - a), a + b + c)) > 0.0f)
+			{
+				swap(triangles[i + 1], triangles[i + 2]);
+			}
+		}
+
+		BuildLevel(positions, triangles, mLevels[0]);
+
+		vector<uint64_t> edges;
+		vector<uint32_t> finerTriangles;
+		for (uint32_t level = 1; level < LevelCount; ++level)
+		{
+			// Every edge gets one vertex at its middle, numbered after the existing vertices in the order of the edges
+			edges.clear();
+			edges.reserve(triangles.size());
+			for (size_t i = 0; i < triangles.size(); i += 3)
+			{
+				edges.push_back(EdgeKey(triangles[i], triangles[i + 1]));
+				edges.push_back(EdgeKey(triangles[i + 1], triangles[i + 2]));
+				edges.push_back(EdgeKey(triangles[i + 2], triangles[i]));
+			}
+			sort(edges.begin(), edges.end());
+			edges.erase(unique(edges.begin(), edges.end()), edges.end());
+
+			const uint32_t firstMidpoint = static_cast<uint32_t>(positions.size());
+			positions.reserve(positions.size() + edges.size());
+			for (uint64_t edge : edges)
+			{
+				XMVECTOR a = XMLoadFloat3(&positions[static_cast<uint32_t>(edge >> 32)]);
+				XMVECTOR b = XMLoadFloat3(&positions[static_cast<uint32_t>(edge)]);
+				XMFLOAT3 midpoint;
+				XMStoreFloat3(&midpoint, XMVector3Normalize(a + b));
+				positions.push_back(midpoint);
+			}
+
+			auto midpointOf = [&edges, firstMidpoint](uint32_t a, uint32_t b)
+			{
+				return firstMidpoint + static_cast<uint32_t>(lower_bound(edges.begin(), edges.end(), EdgeKey(a, b)) - edges.begin());
+			};
+
+			// Four triangles in place of each, wound as it was
+			finerTriangles.clear();
+			finerTriangles.reserve(triangles.size() * 4);
+			for (size_t i = 0; i < triangles.size(); i += 3)
+			{
+				uint32_t a = triangles[i];
+				uint32_t b = triangles[i + 1];
+				uint32_t c = triangles[i + 2];
+				uint32_t ab = midpointOf(a, b);
+				uint32_t bc = midpointOf(b, c);
+				uint32_t ca = midpointOf(c, a);
+				finerTriangles.insert(finerTriangles.end(), { a, ab, ca, ab, b, bc, ca, bc, c, ab, bc, ca });
+			}
+			triangles.swap(finerTriangles);
+
+			BuildLevel(positions, triangles, mLevels[level]);
+		}
+	}
+
+	float IcosphereLodChain::Radius() const
+	{
+		return mRadius;
+	}
+
+	const vector<VertexPositionTextureNormal>& IcosphereLodChain::Vertices(uint32_t level) const
+	{
+		assert(level < LevelCount);
+		return mLevels[level].Vertices;
+	}
+
+	const vector<uint32_t>& IcosphereLodChain::Indices(uint32_t level) const
+	{
+		assert(level < LevelCount);
+		return mLevels[level].Indices;
+	}
+
+	float IcosphereLodChain::Error(uint32_t level) const
+	{
+		assert(level < LevelCount);
+		return mLevels[level].Error;
+	}
+
+	uint32_t IcosphereLodChain::SelectLevel(float projectedRadius, uint32_t level) const
+	{
+		level = min(level, static_cast<uint32_t>(LevelCount) - 1);
+
+		while (level + 1 < LevelCount && mLevels[level].Error * projectedRadius > PixelErrorThreshold)
+		{
+			++level;
+		}
+
+		while (level > 0 && mLevels[level - 1].Error * projectedRadius < PixelErrorThreshold * CoarseningFraction)
+		{
+			--level;
+		}
+
+		return level;
+	}
+
+	void IcosphereLodChain::BuildLevel(const vector<XMFLOAT3>& positions, const vector<uint32_t>& triangles, Level& level) const
+	{
+		// Every vertex but the poles keeps its index; the copies across the seam and at the poles follow them
+		level.Vertices.clear();
+		level.Vertices.reserve(positions.size() + positions.size() / 16);
+		for (const XMFLOAT3& position : positions)
+		{
+			float u = (IsPole(position) ? 0.0f : TextureU(position));
+			float v = acos(max(-1.0f, min(position.y, 1.0f))) / XM_PI;
+			level.Vertices.push_back(VertexPositionTextureNormal(XMFLOAT4(position.x * mRadius, position.y * mRadius, position.z * mRadius, 1.0f), XMFLOAT2(u, v), position));
+		}
+
+		vector<uint32_t> seamCopies(positions.size(), UINT32_MAX);
+		level.Indices.assign(triangles.begin(), triangles.end());
+		level.Error = 0.0f;
+		for (size_t i = 0; i < level.Indices.size(); i += 3)
+		{
+			uint32_t* triangle = &level.Indices[i];
+
+			// A triangle crossing the seam has u near 1 on one side and near 0 on the other; it takes the latter beyond 1
+			float lowest = 1.0f;
+			float highest = 0.0f;
+			for (uint32_t corner = 0; corner < 3; ++corner)
+			{
+				if (!IsPole(positions[triangle[corner]]))
+				{
+					float u = level.Vertices[triangle[corner]].TextureCoordinates.x;
+					lowest = min(lowest, u);
+					highest = max(highest, u);
+				}
+			}
+
+			if (highest - lowest > 0.5f)
+			{
+				for (uint32_t corner = 0; corner < 3; ++corner)
+				{
+					uint32_t index = triangle[corner];
+					if (!IsPole(positions[index]) && level.Vertices[index].TextureCoordinates.x < 0.5f)
+					{
+						if (seamCopies[index] == UINT32_MAX)
+						{
+							seamCopies[index] = static_cast<uint32_t>(level.Vertices.size());
+							VertexPositionTextureNormal copy = level.Vertices[index];
+							copy.TextureCoordinates.x += 1.0f;
+							level.Vertices.push_back(copy);
+						}
+
+						triangle[corner] = seamCopies[index];
+					}
+				}
+			}
+
+			// A pole has no longitude of its own; each triangle touching one gets a copy halfway between its other corners
+			for (uint32_t corner = 0; corner < 3; ++corner)
+			{
+				if (IsPole(positions[triangles[i + corner]]))
+				{
+					VertexPositionTextureNormal copy = level.Vertices[triangle[corner]];
+					copy.TextureCoordinates.x = 0.5f * (level.Vertices[triangle[(corner + 1) % 3]].TextureCoordinates.x + level.Vertices[triangle[(corner + 2) % 3]].TextureCoordinates.x);
+					triangle[corner] = static_cast<uint32_t>(level.Vertices.size());
+					level.Vertices.push_back(copy);
+				}
+			}
+
+			// The plane of the triangle is nearer the center than any other point on it
+			XMVECTOR a = XMLoadFloat3(&positions[triangles[i]]);
+			XMVECTOR b = XMLoadFloat3(&positions[triangles[i + 1]]);
+			XMVECTOR c = XMLoadFloat3(&positions[triangles[i + 2]]);
+			float planeDistance = fabs(XMVectorGetX(XMVector3Dot(XMVector3Normalize(XMVector3Cross(b - a, c - a)), a)));
+			level.Error = max(level.Error, 1.0f - planeDistance);
+		}
+	}
+}
\ No newline at end of file
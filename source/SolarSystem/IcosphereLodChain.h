@@ -0,0 +1,84 @@
+#pragma once
+
+#include "VertexDeclarations.h"
+#include <vector>
+#include <cstdint>
+
+namespace Rendering
+{
+	/**
+	* A chain of spheres of increasing detail, each made by splitting every triangle of the one before it into four,
+	* starting from an icosahedron. Unlike a sphere of latitude and longitude bands, the triangles of every level are
+	* close to the same size all over the sphere, so no level wastes vertices crowded at the poles.
+	*
+	* The texture coordinates follow the sphere model the bodies were drawn with before, with v running from the north
+	* pole at 0 to the south pole at 1, so the textures and rotations of the bodies are unchanged. Vertices on the seam
+	* of the texture are duplicated with u beyond 1 for the triangles crossing it, and the poles once for each triangle
+	* touching them, so every triangle samples the texture without wrapping across it.
+	*
+	* Each level knows how far its flat triangles fall inside the sphere, relative to its radius. A level is chosen
+	* for a sphere by scaling this error to the radius of the sphere in pixels, so it moves the silhouette by less than
+	* a threshold. The chain has no device dependencies and can run headless.
+	*/
+	class IcosphereLodChain final
+	{
+	public:
+		static const std::uint32_t LevelCount = 8;
+
+		/**
+		* Build every level.
+		* @param radius The radius of the spheres, in model units.
+		*/
+		explicit IcosphereLodChain(float radius);
+		IcosphereLodChain(const IcosphereLodChain&) = delete;
+		IcosphereLodChain& operator=(const IcosphereLodChain&) = delete;
+		IcosphereLodChain(IcosphereLodChain&&) = delete;
+		IcosphereLodChain& operator=(IcosphereLodChain&&) = delete;
+		~IcosphereLodChain() = default;
+
+		float Radius() const;
+		/**
+		* Get the vertices of a level, on the sphere and with the normals of the sphere.
+		*/
+		const std::vector<Library::VertexPositionTextureNormal>& Vertices(std::uint32_t level) const;
+		/**
+		* Get the triangles of a level, clockwise when seen from outside the sphere.
+		*/
+		const std::vector<std::uint32_t>& Indices(std::uint32_t level) const;
+		/**
+		* Get the greatest depth of a triangle of a level below the sphere, as a fraction of its radius.
+		*/
+		float Error(std::uint32_t level) const;
+
+		/**
+		* Select the level to draw a sphere with. The level is refined as soon as its error exceeds the threshold, but
+		* only coarsened once the coarser level would be well within it, so a sphere hovering at the boundary between
+		* two levels does not switch between them every frame.
+		* @param projectedRadius The radius of the sphere on the screen, in pixels.
+		* @param level The level the sphere was drawn with last frame.
+		*/
+		std::uint32_t SelectLevel(float projectedRadius, std::uint32_t level) const;
+
+		/**
+		* The error, in pixels, a level may move the silhouette of a sphere by.
+		*/
+		static const float PixelErrorThreshold;
+		/**
+		* The fraction of the threshold the error of a coarser level must fall under before it is selected.
+		*/
+		static const float CoarseningFraction;
+
+	private:
+		struct Level
+		{
+			std::vector<Library::VertexPositionTextureNormal> Vertices;
+			std::vector<std::uint32_t> Indices;
+			float Error;
+		};
+
+		void BuildLevel(const std::vector<DirectX::XMFLOAT3>& positions, const std::vector<std::uint32_t>& triangles, Level& level) const;
+
+		float mRadius;
+		Level mLevels[LevelCount];
+	};
+}
\ No newline at end of file
@@ -0,0 +1,93 @@
+#include "pch.h"
+
+using namespace std;
+using namespace DirectX;
+
+namespace Rendering
+{
+	const uint32_t InstanceBatcher::TextureWidth = 1024;
+	const uint32_t InstanceBatcher::TextureHeight = 512;
+
+	void InstanceBatcher::Clear()
+	{
+		mInstances.clear();
+		mMeshes.clear();
+	}
+
+	void InstanceBatcher::Add(uint32_t mesh, const PlanetInstance& instance)
+	{
+		mInstances.push_back(instance);
+		mMeshes.push_back(mesh);
+	}
+
+	uint32_t InstanceBatcher::InstanceCount() const
+	{
+		return static_cast<uint32_t>(mInstances.size());
+	}
+
+	const vector<InstanceBatch>& InstanceBatcher::Build(PlanetInstance* destination)
+	{
+		return BuildBatches(destination, static_cast<uint32_t>(mInstances.size()), [](uint32_t i) { return i; });
+	}
+
+	const vector<InstanceBatch>& InstanceBatcher::Build(PlanetInstance* destination, const uint32_t* indices, uint32_t count)
+	{
+		return BuildBatches(destination, count, [indices](uint32_t i) { return indices[i]; });
+	}
+
+	template <typename TIndex>
+	const vector<InstanceBatch>& InstanceBatcher::BuildBatches(PlanetInstance* destination, uint32_t count, TIndex index)
+	{
+		mBatches.clear();
+		if (count == 0)
+		{
+			return mBatches;
+		}
+
+		// Count the instances of each mesh, then turn the counts into the first slot of each batch
+		uint32_t meshCount = *max_element(mMeshes.begin(), mMeshes.end()) + 1;
+		mMeshOffsets.assign(meshCount, 0);
+		for (uint32_t i = 0; i < count; ++i)
+		{
+			++mMeshOffsets[mMeshes[index(i)]];
+		}
+
+		uint32_t firstInstance = 0;
+		for (uint32_t mesh = 0; mesh < meshCount; ++mesh)
+		{
+			uint32_t instanceCount = mMeshOffsets[mesh];
+			if (instanceCount > 0)
+			{
+				mBatches.push_back({ mesh, firstInstance, instanceCount });
+			}
+
+			mMeshOffsets[mesh] = firstInstance;
+			firstInstance += instanceCount;
+		}
+
+		for (uint32_t i = 0; i < count; ++i)
+		{
+			uint32_t instance = index(i);
+			destination[mMeshOffsets[mMeshes[instance]]++] = mInstances[instance];
+		}
+
+		return mBatches;
+	}
+
+	PlanetInstance InstanceBatcher::Pack(CXMMATRIX world, const ShadowOccluders& occluders, uint32_t textureSlice, float ambientIntensity)
+	{
+		PlanetInstance instance;
+		XMStoreFloat4x4(&instance.World, XMMatrixTranspose(world));
+		for (uint32_t i = 0; i < ShadowOccluders::MaxOccluders; ++i)
+		{
+			instance.Occluders[i] = occluders.Spheres[i];
+		}
+
+		instance.OccluderCount = occluders.Count;
+		instance.LightRadius = occluders.LightRadius;
+		instance.TextureSlice = textureSlice;
+		instance.AmbientIntensity = ambientIntensity;
+
+		return instance;
+	}
+}
\ No newline at end of file
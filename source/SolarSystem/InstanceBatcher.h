@@ -0,0 +1,95 @@
+#pragma once
+
+#include "ShadowOccluderPass.h"
+#include <vector>
+#include <cstdint>
+#include <DirectXMath.h>
+
+namespace Rendering
+{
+	/**
+	* The per-instance data of a body, laid out to match PlanetInstance in PlanetVS.hlsl and PlanetPS.hlsl.
+	*/
+	struct PlanetInstance
+	{
+		DirectX::XMFLOAT4X4 World;		// Transposed for the shaders
+		DirectX::XMFLOAT4 Occluders[ShadowOccluders::MaxOccluders];
+		std::uint32_t OccluderCount;
+		float LightRadius;
+		std::uint32_t TextureSlice;
+		float AmbientIntensity;
+	};
+
+	static_assert(sizeof(PlanetInstance) == 144, "PlanetInstance must match the structured buffer of the planet shaders.");
+
+	/**
+	* A run of instances drawn with one call, all sharing a mesh.
+	*/
+	struct InstanceBatch
+	{
+		std::uint32_t Mesh;
+		std::uint32_t FirstInstance;
+		std::uint32_t InstanceCount;
+	};
+
+	/**
+	* Collects the instances submitted over a frame and groups them by mesh, so each mesh is drawn once however many
+	* bodies share it. Instances are staged as they are submitted and scattered into their batches in a single pass by
+	* a counting sort on the mesh, keeping the order of submission within a mesh. Batching has no device dependencies
+	* and can run headless.
+	*/
+	class InstanceBatcher final
+	{
+	public:
+		InstanceBatcher() = default;
+		InstanceBatcher(const InstanceBatcher&) = delete;
+		InstanceBatcher& operator=(const InstanceBatcher&) = delete;
+		InstanceBatcher(InstanceBatcher&&) = delete;
+		InstanceBatcher& operator=(InstanceBatcher&&) = delete;
+		~InstanceBatcher() = default;
+
+		/**
+		* Drop the instances of the previous frame.
+		*/
+		void Clear();
+		void Add(std::uint32_t mesh, const PlanetInstance& instance);
+		std::uint32_t InstanceCount() const;
+
+		/**
+		* Write the staged instances grouped by mesh, ascending.
+		* @param destination Receives InstanceCount() instances, such as a mapped structured buffer.
+		* @return One batch for each mesh with instances.
+		*/
+		const std::vector<InstanceBatch>& Build(PlanetInstance* destination);
+		/**
+		* Write only the listed staged instances grouped by mesh, such as those that survived culling.
+		* @param indices The indices of the instances in the order they were added, ascending.
+		* @param destination Receives count instances.
+		*/
+		const std::vector<InstanceBatch>& Build(PlanetInstance* destination, const std::uint32_t* indices, std::uint32_t count);
+
+		/**
+		* Fill the instance data of a body.
+		* @param world The transform from the mesh into the scene.
+		* @param occluders The bodies shadowing the body.
+		* @param textureSlice The slice of the color texture array holding the surface of the body.
+		* @param ambientIntensity The fraction of its color the body shows unlit.
+		*/
+		static PlanetInstance Pack(DirectX::CXMMATRIX world, const ShadowOccluders& occluders, std::uint32_t textureSlice, float ambientIntensity);
+
+		/**
+		* The size every texture is resampled to in the texture array the instances select their slice of.
+		*/
+		static const std::uint32_t TextureWidth;
+		static const std::uint32_t TextureHeight;
+
+	private:
+		template <typename TIndex>
+		const std::vector<InstanceBatch>& BuildBatches(PlanetInstance* destination, std::uint32_t count, TIndex index);
+
+		std::vector<PlanetInstance> mInstances;
+		std::vector<std::uint32_t> mMeshes;
+		std::vector<std::uint32_t> mMeshOffsets;
+		std::vector<InstanceBatch> mBatches;
+	};
+}
\ No newline at end of file
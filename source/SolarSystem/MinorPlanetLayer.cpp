@@ -0,0 +1,186 @@
+#include "pch.h"
+
+using namespace std;
+using namespace Library;
+using namespace DirectX;
+
+namespace Rendering
+{
+	namespace
+	{
+		const uint32_t RecordsPerTask = 4096;
+		const uint32_t MaxKeplerIterations = 20;
+		const double J2000 = 2451545.0;
+		const double Pi = 3.14159265358979323846;
+		const double DegreesToRadians = Pi / 180.0;
+	}
+
+	RTTI_DEFINITIONS(MinorPlanetLayer)
+
+	MinorPlanetLayer::MinorPlanetLayer(Game& game, const shared_ptr<Camera>& camera, const BodyCatalog& catalog, const SolarSystemSimulation& simulation,
+		const MinorPlanetCatalog& minorPlanets, ThreadPool& threadPool) :
+		DrawableGameComponent(game, camera), mSimulation(&simulation), mMinorPlanets(&minorPlanets), mThreadPool(&threadPool), mLightIndex(0),
+		mRecords(), mVertices(), mVertexBufferDirty(false), mPropagatedDays(numeric_limits<double>::quiet_NaN()), mWorldMatrix(MatrixHelper::Identity),
+		mDevice(nullptr), mConstantStorage(nullptr), mShader(0), mVertexBuffer(RenderDevice::NullHandle), mPerObjectConstants()
+	{
+		uint32_t bodyCount = catalog.Count();
+		while (mLightIndex < bodyCount && catalog.Record(mLightIndex).HasFlag(BodyFlags::LightSource) == false)
+		{
+			++mLightIndex;
+		}
+
+		if (mLightIndex == bodyCount)
+		{
+			throw GameException("The body catalog has no light source.");
+		}
+
+		const MinorPlanetElements& elements = mMinorPlanets->Elements();
+		mRecords.reserve(elements.Count);
+		for (uint32_t i = 0; i < elements.Count; ++i)
+		{
+			if (elements.Eccentricities[i] < 1.0 && elements.SemiMajorAxes[i] > 0.0)
+			{
+				mRecords.push_back(i);
+			}
+		}
+		mVertices.resize(mRecords.size());
+	}
+
+	void MinorPlanetLayer::Initialize()
+	{
+		DeviceRenderBackend* renderBackend = (DeviceRenderBackend*)mGame->Services().GetService(DeviceRenderBackend::TypeIdClass());
+		assert(renderBackend != nullptr);
+		mDevice = &renderBackend->Device();
+
+		mConstantStorage = (DeviceConstantBufferStorage*)mGame->Services().GetService(DeviceConstantBufferStorage::TypeIdClass());
+		assert(mConstantStorage != nullptr);
+
+		// The points are transformed as the satellites are, and only coloured differently
+		vector<char> compiledVertexShader;
+		Utility::LoadBinaryFile(L"Content\\Shaders\\SatelliteVS.cso", compiledVertexShader);
+		vector<char> compiledPixelShader;
+		Utility::LoadBinaryFile(L"Content\\Shaders\\MinorPlanetPS.cso", compiledPixelShader);
+
+		const RenderDevice::VertexElement vertexElements[] =
+		{
+			{ "POSITION", 0, RenderDevice::VertexFormat::Float3 }
+		};
+
+		mShader = renderBackend->AddShader(mDevice->CreateShader(&compiledVertexShader[0], compiledVertexShader.size(), &compiledPixelShader[0], compiledPixelShader.size(), vertexElements, ARRAYSIZE(vertexElements)));
+
+		// The vertex buffer holds every minor planet and is rewritten whenever they are propagated
+		mVertexBuffer = mDevice->CreateBuffer({ RenderDevice::BufferType::Vertex, true, static_cast<uint32_t>(sizeof(XMFLOAT3)) * max(static_cast<uint32_t>(mVertices.size()), 1U), 0 }, nullptr);
+	}
+
+	void MinorPlanetLayer::Update(const GameTime& gameTime)
+	{
+		UNREFERENCED_PARAMETER(gameTime);
+
+		// Propagate only when the simulation has advanced, such as not while it is paused
+		double days = mSimulation->ElapsedDays();
+		if (days != mPropagatedDays && mVertices.empty() == false)
+		{
+			double julianDate = J2000 + days;
+			mThreadPool->ParallelFor(static_cast<uint32_t>(mRecords.size()), RecordsPerTask, [this, julianDate](uint32_t begin, uint32_t end)
+			{
+				Propagate(begin, end, julianDate);
+			});
+			mPropagatedDays = days;
+			mVertexBufferDirty = true;
+		}
+
+		// The light source moves with the floating origin every frame, propagated or not
+		const XMFLOAT3& lightPosition = mSimulation->RelativePosition(mLightIndex);
+		XMStoreFloat4x4(&mWorldMatrix, XMMatrixTranslation(lightPosition.x, lightPosition.y, lightPosition.z));
+	}
+
+	void MinorPlanetLayer::Draw(const GameTime& gameTime)
+	{
+		UNREFERENCED_PARAMETER(gameTime);
+		assert(mCamera != nullptr);
+
+		if (mVertices.empty())
+		{
+			return;
+		}
+
+		if (mVertexBufferDirty)
+		{
+			uint32_t size = static_cast<uint32_t>(sizeof(XMFLOAT3) * mVertices.size());
+			memcpy(mDevice->Map(mVertexBuffer, true), mVertices.data(), size);
+			mDevice->Unmap(mVertexBuffer, size);
+			mVertexBufferDirty = false;
+		}
+
+		FrameConstantAllocator* frameConstants = (FrameConstantAllocator*)mGame->Services().GetService(FrameConstantAllocator::TypeIdClass());
+		assert(frameConstants != nullptr);
+
+		VSCBufferPerObject perObject;
+		XMMATRIX wvp = XMLoadFloat4x4(&mWorldMatrix) * mCamera->ViewProjectionMatrix();
+		XMStoreFloat4x4(&perObject.WorldViewProjection, XMMatrixTranspose(wvp));
+		mPerObjectConstants = frameConstants->Upload(perObject);
+
+		RenderQueue* renderQueue = (RenderQueue*)mGame->Services().GetService(RenderQueue::TypeIdClass());
+		assert(renderQueue != nullptr);
+		renderQueue->Submit(RenderQueue::MakeKey(DeviceRenderBackend::DefaultPass, mShader, RenderQueue::NoTexture, 0.0f), *this, 0);
+	}
+
+	void MinorPlanetLayer::ExecuteDraw(uint32_t command)
+	{
+		UNREFERENCED_PARAMETER(command);
+
+		mDevice->SetPrimitiveTopology(RenderDevice::PrimitiveTopology::PointList);
+		mDevice->SetVertexBuffer(mVertexBuffer, sizeof(XMFLOAT3));
+		mConstantStorage->SetConstantBuffer(RenderDevice::ShaderStage::Vertex, 0, mPerObjectConstants);
+
+		mDevice->Draw(static_cast<uint32_t>(mVertices.size()), 0);
+	}
+
+	uint32_t MinorPlanetLayer::VisibleCount() const
+	{
+		return static_cast<uint32_t>(mVertices.size());
+	}
+
+	void MinorPlanetLayer::Propagate(uint32_t begin, uint32_t end, double julianDate)
+	{
+		const MinorPlanetElements& elements = mMinorPlanets->Elements();
+		for (uint32_t i = begin; i < end; ++i)
+		{
+			uint32_t record = mRecords[i];
+			double e = elements.Eccentricities[record];
+			double a = elements.SemiMajorAxes[record];
+			double meanAnomaly = fmod((elements.MeanAnomalies[record] + elements.MeanMotions[record] * (julianDate - elements.Epochs[record])) * DegreesToRadians, 2.0 * Pi);
+
+			// Kepler's equation by Newton's method, from a start that converges for any elliptic orbit
+			double eccentricAnomaly = meanAnomaly + e * sin(meanAnomaly);
+			for (uint32_t iteration = 0; iteration < MaxKeplerIterations; ++iteration)
+			{
+				double step = (eccentricAnomaly - e * sin(eccentricAnomaly) - meanAnomaly) / (1.0 - e * cos(eccentricAnomaly));
+				eccentricAnomaly -= step;
+				if (fabs(step) < 1.0e-12)
+				{
+					break;
+				}
+			}
+
+			// The position in the plane of the orbit, with x towards the perihelion, turned into the ecliptic
+			double planeX = a * (cos(eccentricAnomaly) - e);
+			double planeY = a * sqrt(1.0 - e * e) * sin(eccentricAnomaly);
+			double argument = elements.ArgumentsOfPerihelion[record] * DegreesToRadians;
+			double node = elements.AscendingNodes[record] * DegreesToRadians;
+			double inclination = elements.Inclinations[record] * DegreesToRadians;
+			double cosArgument = cos(argument);
+			double sinArgument = sin(argument);
+			double cosNode = cos(node);
+			double sinNode = sin(node);
+			double cosInclination = cos(inclination);
+			double sinInclination = sin(inclination);
+			double x = (cosNode * cosArgument - sinNode * sinArgument * cosInclination) * planeX - (cosNode * sinArgument + sinNode * cosArgument * cosInclination) * planeY;
+			double y = (sinNode * cosArgument + cosNode * sinArgument * cosInclination) * planeX - (sinNode * sinArgument - cosNode * cosArgument * cosInclination) * planeY;
+			double z = sinInclination * (sinArgument * planeX + cosArgument * planeY);
+
+			// The ecliptic is the XZ plane of the scene, with its y axis along -Z
+			mVertices[i] = XMFLOAT3(static_cast<float>(x * SCALE_ASTRONOMICAL_UNIT), static_cast<float>(z * SCALE_ASTRONOMICAL_UNIT), static_cast<float>(-y * SCALE_ASTRONOMICAL_UNIT));
+		}
+	}
+}
\ No newline at end of file
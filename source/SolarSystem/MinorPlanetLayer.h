@@ -0,0 +1,82 @@
+#pragma once
+
+#include "DrawableGameComponent.h"
+#include "RenderQueue.h"
+#include "FrameConstantAllocator.h"
+#include <DirectXMath.h>
+
+namespace Library
+{
+	class BodyCatalog;
+	class MinorPlanetCatalog;
+	class ThreadPool;
+	class RenderDevice;
+	class DeviceConstantBufferStorage;
+}
+
+namespace Rendering
+{
+	class SolarSystemSimulation;
+
+	/**
+	* Draws the minor planets of an imported catalog as points, moved each frame along the Keplerian orbits of their
+	* osculating elements to the time of the simulation. The elapsed days of the simulation are taken from J2000, as
+	* with a planetary theory. The positions are kept relative to the light source, in scene units, and carried into
+	* the scene by its position relative to the floating origin. Elements that do not describe an ellipse are left out.
+	*/
+	class MinorPlanetLayer final : public Library::DrawableGameComponent, public Library::RenderQueueClient
+	{
+		RTTI_DECLARATIONS(MinorPlanetLayer, Library::DrawableGameComponent)
+
+	public:
+		/**
+		* @param minorPlanets The catalog of elements, which must outlive the layer.
+		* @param threadPool The pool the propagation is split across.
+		*/
+		MinorPlanetLayer(Library::Game& game, const std::shared_ptr<Library::Camera>& camera, const Library::BodyCatalog& catalog, const SolarSystemSimulation& simulation,
+			const Library::MinorPlanetCatalog& minorPlanets, Library::ThreadPool& threadPool);
+		MinorPlanetLayer(const MinorPlanetLayer&) = delete;
+		MinorPlanetLayer& operator=(const MinorPlanetLayer&) = delete;
+		MinorPlanetLayer(MinorPlanetLayer&&) = delete;
+		MinorPlanetLayer& operator=(MinorPlanetLayer&&) = delete;
+		~MinorPlanetLayer() = default;
+
+		virtual void Initialize() override;
+		virtual void Update(const Library::GameTime& gameTime) override;
+		virtual void Draw(const Library::GameTime& gameTime) override;
+		virtual void ExecuteDraw(std::uint32_t command) override;
+
+		/**
+		* Get the number of minor planets drawn.
+		*/
+		std::uint32_t VisibleCount() const;
+
+	private:
+		struct VSCBufferPerObject
+		{
+			DirectX::XMFLOAT4X4 WorldViewProjection;
+		};
+
+		void Propagate(std::uint32_t begin, std::uint32_t end, double julianDate);
+
+		const SolarSystemSimulation* mSimulation;
+		const Library::MinorPlanetCatalog* mMinorPlanets;
+		Library::ThreadPool* mThreadPool;
+		std::uint32_t mLightIndex;
+
+		/**
+		* The records of the catalog on elliptic orbits, and their positions relative to the light source.
+		*/
+		std::vector<std::uint32_t> mRecords;
+		std::vector<DirectX::XMFLOAT3> mVertices;
+		bool mVertexBufferDirty;
+		double mPropagatedDays;
+		DirectX::XMFLOAT4X4 mWorldMatrix;
+
+		Library::RenderDevice* mDevice;
+		Library::DeviceConstantBufferStorage* mConstantStorage;
+		std::uint32_t mShader;
+		std::uint32_t mVertexBuffer;
+		Library::FrameConstantAllocator::Allocation mPerObjectConstants;
+	};
+}
\ No newline at end of file
@@ -0,0 +1,11 @@
+static const float4 MinorPlanetColor = float4(0.55f, 0.5f, 0.45f, 1.0f);
+
+struct VS_OUTPUT
+{
+	float4 Position: SV_Position;
+};
+
+float4 main(VS_OUTPUT IN) : SV_Target
+{
+	return MinorPlanetColor;
+}
\ No newline at end of file
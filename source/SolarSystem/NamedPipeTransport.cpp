@@ -0,0 +1,220 @@
+#include "pch.h"
+
+using namespace std;
+using namespace Library;
+
+namespace Rendering
+{
+	namespace
+	{
+		/**
+		* Wait for the overlapped operation on a pipe to complete, cancelling it if the cancel event is set first.
+		* @return Whether the operation succeeded.
+		*/
+		bool WaitForOverlapped(HANDLE pipe, OVERLAPPED& overlapped, HANDLE cancelEvent)
+		{
+			DWORD bytesTransferred;
+			HANDLE events[] = { overlapped.hEvent, cancelEvent };
+			if (WaitForMultipleObjects(ARRAYSIZE(events), events, FALSE, INFINITE) != WAIT_OBJECT_0)
+			{
+				CancelIoEx(pipe, &overlapped);
+				GetOverlappedResult(pipe, &overlapped, &bytesTransferred, TRUE);
+				return false;
+			}
+
+			return (GetOverlappedResult(pipe, &overlapped, &bytesTransferred, FALSE) != FALSE);
+		}
+
+		/**
+		* Create the manual-reset events of an overlapped operation and of its cancellation.
+		*/
+		void CreateEvents(OVERLAPPED& overlapped, HANDLE& cancelEvent)
+		{
+			overlapped.hEvent = CreateEvent(nullptr, TRUE, FALSE, nullptr);
+			cancelEvent = CreateEvent(nullptr, TRUE, FALSE, nullptr);
+			if (overlapped.hEvent == nullptr || cancelEvent == nullptr)
+			{
+				HRESULT hr = HRESULT_FROM_WIN32(GetLastError());
+				if (overlapped.hEvent != nullptr)
+				{
+					CloseHandle(overlapped.hEvent);
+				}
+
+				if (cancelEvent != nullptr)
+				{
+					CloseHandle(cancelEvent);
+				}
+
+				throw GameException("CreateEvent() failed.", hr);
+			}
+		}
+	}
+
+	const DWORD NamedPipeConnection::ConnectTimeoutMilliseconds = 5000;
+	const DWORD NamedPipeListener::PipeBufferSize = 64 * 1024;
+
+	NamedPipeConnection::NamedPipeConnection(HANDLE pipe, bool serverEnd) :
+		mPipe(pipe), mCancelEvent(nullptr), mOverlapped(), mServerEnd(serverEnd)
+	{
+		try
+		{
+			CreateEvents(mOverlapped, mCancelEvent);
+		}
+		catch (...)
+		{
+			CloseHandle(mPipe);
+			throw;
+		}
+	}
+
+	NamedPipeConnection::~NamedPipeConnection()
+	{
+		if (mServerEnd)
+		{
+			DisconnectNamedPipe(mPipe);
+		}
+
+		CloseHandle(mPipe);
+		CloseHandle(mOverlapped.hEvent);
+		CloseHandle(mCancelEvent);
+	}
+
+	bool NamedPipeConnection::Send(const void* data, size_t size)
+	{
+		ResetEvent(mOverlapped.hEvent);
+		if (WriteFile(mPipe, data, static_cast<DWORD>(size), nullptr, &mOverlapped) == FALSE && GetLastError() != ERROR_IO_PENDING)
+		{
+			return false;
+		}
+
+		return WaitForIo();
+	}
+
+	bool NamedPipeConnection::TryReceive(vector<uint8_t>& message, bool& received)
+	{
+		received = false;
+
+		DWORD available = 0;
+		DWORD messageSize = 0;
+		if (PeekNamedPipe(mPipe, nullptr, 0, nullptr, &available, &messageSize) == FALSE)
+		{
+			return false;
+		}
+
+		if (available == 0)
+		{
+			return true;
+		}
+
+		message.resize(messageSize);
+		ResetEvent(mOverlapped.hEvent);
+		if (ReadFile(mPipe, message.data(), messageSize, nullptr, &mOverlapped) == FALSE && GetLastError() != ERROR_IO_PENDING)
+		{
+			return false;
+		}
+
+		received = WaitForIo();
+		return received;
+	}
+
+	void NamedPipeConnection::Cancel()
+	{
+		SetEvent(mCancelEvent);
+	}
+
+	unique_ptr<NamedPipeConnection> NamedPipeConnection::Connect(const wstring& pipeName)
+	{
+		HANDLE pipe;
+		for (;;)
+		{
+			pipe = CreateFile(pipeName.c_str(), GENERIC_READ | GENERIC_WRITE, 0, nullptr, OPEN_EXISTING, FILE_FLAG_OVERLAPPED, nullptr);
+			if (pipe != INVALID_HANDLE_VALUE)
+			{
+				break;
+			}
+
+			if (GetLastError() != ERROR_PIPE_BUSY || WaitNamedPipe(pipeName.c_str(), ConnectTimeoutMilliseconds) == FALSE)
+			{
+				throw GameException("Could not connect to the snapshot server.", HRESULT_FROM_WIN32(GetLastError()));
+			}
+		}
+
+		DWORD mode = PIPE_READMODE_MESSAGE;
+		if (SetNamedPipeHandleState(pipe, &mode, nullptr, nullptr) == FALSE)
+		{
+			HRESULT hr = HRESULT_FROM_WIN32(GetLastError());
+			CloseHandle(pipe);
+			throw GameException("SetNamedPipeHandleState() failed.", hr);
+		}
+
+		return make_unique<NamedPipeConnection>(pipe, false);
+	}
+
+	bool NamedPipeConnection::WaitForIo()
+	{
+		return WaitForOverlapped(mPipe, mOverlapped, mCancelEvent);
+	}
+
+	NamedPipeListener::NamedPipeListener(const wstring& pipeName) :
+		mPipeName(pipeName), mPipe(INVALID_HANDLE_VALUE), mCancelEvent(nullptr), mOverlapped()
+	{
+		CreateEvents(mOverlapped, mCancelEvent);
+
+		mPipe = CreateInstance(true);
+		if (mPipe == INVALID_HANDLE_VALUE)
+		{
+			HRESULT hr = HRESULT_FROM_WIN32(GetLastError());
+			CloseHandle(mOverlapped.hEvent);
+			CloseHandle(mCancelEvent);
+			throw GameException("CreateNamedPipe() failed.", hr);
+		}
+	}
+
+	NamedPipeListener::~NamedPipeListener()
+	{
+		if (mPipe != INVALID_HANDLE_VALUE)
+		{
+			CloseHandle(mPipe);
+		}
+
+		CloseHandle(mOverlapped.hEvent);
+		CloseHandle(mCancelEvent);
+	}
+
+	unique_ptr<SnapshotConnection> NamedPipeListener::Accept()
+	{
+		while (mPipe != INVALID_HANDLE_VALUE && WaitForSingleObject(mCancelEvent, 0) != WAIT_OBJECT_0)
+		{
+			ResetEvent(mOverlapped.hEvent);
+			bool connected = (ConnectNamedPipe(mPipe, &mOverlapped) != FALSE);
+			if (connected == false)
+			{
+				DWORD error = GetLastError();
+				connected = (error == ERROR_PIPE_CONNECTED || (error == ERROR_IO_PENDING && WaitForOverlapped(mPipe, mOverlapped, mCancelEvent)));
+			}
+
+			// Keep an instance waiting for the next viewer while this one is served
+			HANDLE pipe = mPipe;
+			mPipe = CreateInstance(false);
+			if (connected)
+			{
+				return make_unique<NamedPipeConnection>(pipe, true);
+			}
+
+			CloseHandle(pipe);
+		}
+
+		return nullptr;
+	}
+
+	void NamedPipeListener::Cancel()
+	{
+		SetEvent(mCancelEvent);
+	}
+
+	HANDLE NamedPipeListener::CreateInstance(bool firstInstance) const
+	{
+		DWORD openMode = PIPE_ACCESS_DUPLEX | FILE_FLAG_OVERLAPPED | (firstInstance ? FILE_FLAG_FIRST_PIPE_INSTANCE : 0);
+		return CreateNamedPipe(mPipeName.c_str(), openMode, PIPE_TYPE_MESSAGE | PIPE_READMODE_MESSAGE | PIPE_WAIT | PIPE_REJECT_REMOTE_CLIENTS, PIPE_UNLIMITED_INSTANCES, PipeBufferSize, PipeBufferSize, 0, nullptr);
+	}
+}
\ No newline at end of file
@@ -0,0 +1,74 @@
+#pragma once
+
+#include "SnapshotTransport.h"
+#include <windows.h>
+
+namespace Rendering
+{
+	/**
+	* A snapshot connection over a named pipe in message mode, with overlapped I/O so a cancel event can end a wait.
+	*/
+	class NamedPipeConnection final : public SnapshotConnection
+	{
+	public:
+		/**
+		* Take a connected pipe opened for overlapped I/O and read in message mode.
+		* @param serverEnd Whether the pipe is the server end, which is disconnected before it is closed.
+		*/
+		NamedPipeConnection(HANDLE pipe, bool serverEnd);
+		NamedPipeConnection(const NamedPipeConnection&) = delete;
+		NamedPipeConnection& operator=(const NamedPipeConnection&) = delete;
+		NamedPipeConnection(NamedPipeConnection&&) = delete;
+		NamedPipeConnection& operator=(NamedPipeConnection&&) = delete;
+		~NamedPipeConnection();
+
+		virtual bool Send(const void* data, std::size_t size) override;
+		virtual bool TryReceive(std::vector<std::uint8_t>& message, bool& received) override;
+		virtual void Cancel() override;
+
+		/**
+		* Connect to the server end of a pipe, waiting a while for an instance if every one is busy.
+		*/
+		static std::unique_ptr<NamedPipeConnection> Connect(const std::wstring& pipeName);
+
+	private:
+		bool WaitForIo();
+
+		static const DWORD ConnectTimeoutMilliseconds;
+
+		HANDLE mPipe;
+		HANDLE mCancelEvent;
+		OVERLAPPED mOverlapped;
+		bool mServerEnd;
+	};
+
+	/**
+	* Listens for viewers on a named pipe, creating an instance of the pipe for each one.
+	*/
+	class NamedPipeListener final : public SnapshotListener
+	{
+	public:
+		/**
+		* Create the first instance of a pipe, failing if another server already has one.
+		*/
+		NamedPipeListener(const std::wstring& pipeName);
+		NamedPipeListener(const NamedPipeListener&) = delete;
+		NamedPipeListener& operator=(const NamedPipeListener&) = delete;
+		NamedPipeListener(NamedPipeListener&&) = delete;
+		NamedPipeListener& operator=(NamedPipeListener&&) = delete;
+		~NamedPipeListener();
+
+		virtual std::unique_ptr<SnapshotConnection> Accept() override;
+		virtual void Cancel() override;
+
+	private:
+		HANDLE CreateInstance(bool firstInstance) const;
+
+		static const DWORD PipeBufferSize;
+
+		std::wstring mPipeName;
+		HANDLE mPipe;					// The instance the next viewer connects to
+		HANDLE mCancelEvent;
+		OVERLAPPED mOverlapped;
+	};
+}
\ No newline at end of file
@@ -0,0 +1,770 @@
+#include "pch.h"
+
+using namespace std;
+using namespace Library;
+
+namespace Rendering
+{
+	namespace
+	{
+		const uint32_t WorkerShutdownMilliseconds = 5000;
+		const uint32_t MaxFailedLaunches = 3;
+
+		uint64_t HashValues(uint64_t hash, const vector<double>& values)
+		{
+			// FNV-1a over the count and the bits of each value
+			const uint64_t prime = 1099511628211ULL;
+			hash = (hash ^ values.size()) * prime;
+			for (double value : values)
+			{
+				uint64_t bits;
+				memcpy(&bits, &value, sizeof(bits));
+				hash = (hash ^ bits) * prime;
+			}
+
+			return hash;
+		}
+
+#if defined(_WIN32)
+		bool ReadExactly(HANDLE pipe, void* buffer, DWORD size)
+		{
+			uint8_t* bytes = reinterpret_cast<uint8_t*>(buffer);
+			while (size > 0)
+			{
+				DWORD read = 0;
+				if (ReadFile(pipe, bytes, size, &read, nullptr) == FALSE || read == 0)
+				{
+					return false;
+				}
+
+				bytes += read;
+				size -= read;
+			}
+
+			return true;
+		}
+
+		bool WriteExactly(HANDLE pipe, const void* buffer, DWORD size)
+		{
+			const uint8_t* bytes = reinterpret_cast<const uint8_t*>(buffer);
+			while (size > 0)
+			{
+				DWORD written = 0;
+				if (WriteFile(pipe, bytes, size, &written, nullptr) == FALSE || written == 0)
+				{
+					return false;
+				}
+
+				bytes += written;
+				size -= written;
+			}
+
+			return true;
+		}
+
+		/**
+		* The deadline of the job a worker is running. Terminating the worker when it passes breaks the result pipe,
+		* which ends the read waiting on it.
+		*/
+		struct JobDeadline
+		{
+			HANDLE Process;
+			atomic<bool> Expired;
+		};
+
+		void CALLBACK ExpireJob(PVOID parameter, BOOLEAN timerFired)
+		{
+			UNREFERENCED_PARAMETER(timerFired);
+
+			JobDeadline* deadline = static_cast<JobDeadline*>(parameter);
+			deadline->Expired = true;
+			TerminateProcess(deadline->Process, 1);
+		}
+#else
+		bool ReadExactly(int pipe, void* buffer, size_t size)
+		{
+			uint8_t* bytes = reinterpret_cast<uint8_t*>(buffer);
+			while (size > 0)
+			{
+				ssize_t count = read(pipe, bytes, size);
+				if (count < 0 && errno == EINTR)
+				{
+					continue;
+				}
+
+				if (count <= 0)
+				{
+					return false;
+				}
+
+				bytes += count;
+				size -= static_cast<size_t>(count);
+			}
+
+			return true;
+		}
+
+		bool WriteExactly(int pipe, const void* buffer, size_t size)
+		{
+			const uint8_t* bytes = reinterpret_cast<const uint8_t*>(buffer);
+			while (size > 0)
+			{
+				ssize_t count = write(pipe, bytes, size);
+				if (count < 0 && errno == EINTR)
+				{
+					continue;
+				}
+
+				if (count <= 0)
+				{
+					return false;
+				}
+
+				bytes += count;
+				size -= static_cast<size_t>(count);
+			}
+
+			return true;
+		}
+
+		/**
+		* Keep a descriptor from being inherited by the workers launched later.
+		*/
+		void CloseOnExec(int descriptor)
+		{
+			fcntl(descriptor, F_SETFD, fcntl(descriptor, F_GETFD) | FD_CLOEXEC);
+		}
+#endif
+	}
+
+	const wstring ParameterSweep::WorkerSwitch = L"--sweep-worker";
+	const uint32_t ParameterSweep::ResultsMagic = 0x50455753;	// "SWEP"
+	const uint32_t ParameterSweep::ResultsVersion = 1;
+	const uint32_t ParameterSweep::DefaultJobTimeoutSeconds = 600;
+
+	ParameterSweep::ParameterSweep(const SweepGrid& grid, const wstring& resultsFileName) :
+		mGridHash(14695981039346656037ULL), mFailureCount(0), mJobTimeoutMilliseconds(0)
+	{
+		if (grid.TimeStepDays.empty() || grid.DurationDays.empty() || grid.MassScales.empty())
+		{
+			throw GameException("Every parameter of a sweep needs at least one value.");
+		}
+
+		for (double timeStep : grid.TimeStepDays)
+		{
+			for (double duration : grid.DurationDays)
+			{
+				for (double massScale : grid.MassScales)
+				{
+					SweepJob job = { static_cast<uint32_t>(mJobs.size()), 0, timeStep, duration, massScale };
+					mJobs.push_back(job);
+				}
+			}
+		}
+
+		mGridHash = HashValues(mGridHash, grid.TimeStepDays);
+		mGridHash = HashValues(mGridHash, grid.DurationDays);
+		mGridHash = HashValues(mGridHash, grid.MassScales);
+
+		// Resume a results file written for the same grid, otherwise start a new one with every job pending
+		uint32_t jobCount = static_cast<uint32_t>(mJobs.size());
+#if defined(_WIN32)
+		mResultsFile.open(resultsFileName.c_str(), ios::in | ios::out | ios::binary);
+#else
+		mResultsFile.open(Utility::ToPortablePath(resultsFileName), ios::in | ios::out | ios::binary);
+#endif
+		SweepResultsHeader header = { 0 };
+		if (mResultsFile.is_open())
+		{
+			mResultsFile.read(reinterpret_cast<char*>(&header), sizeof(header));
+		}
+
+		bool resumed = (mResultsFile.good() && header.Magic == ResultsMagic && header.Version == ResultsVersion && header.RecordCount == jobCount &&
+			header.RecordSize == sizeof(SweepRecord) && header.GridHash == mGridHash);
+		if (resumed)
+		{
+			vector<SweepRecord> records(jobCount);
+			mResultsFile.read(reinterpret_cast<char*>(records.data()), records.size() * sizeof(SweepRecord));
+			resumed = mResultsFile.good();
+			for (uint32_t i = 0; resumed && i < jobCount; ++i)
+			{
+				if (records[i].Status == SweepStatus::Pending)
+				{
+					mPendingJobs.push_back(i);
+				}
+			}
+		}
+
+		if (resumed == false)
+		{
+			mResultsFile.close();
+			mResultsFile.clear();
+#if defined(_WIN32)
+			mResultsFile.open(resultsFileName.c_str(), ios::in | ios::out | ios::binary | ios::trunc);
+#else
+			mResultsFile.open(Utility::ToPortablePath(resultsFileName), ios::in | ios::out | ios::binary | ios::trunc);
+#endif
+			if (mResultsFile.is_open() == false)
+			{
+				throw GameException("Could not open the sweep results file.");
+			}
+
+			header.Magic = ResultsMagic;
+			header.Version = ResultsVersion;
+			header.RecordCount = jobCount;
+			header.RecordSize = sizeof(SweepRecord);
+			header.GridHash = mGridHash;
+			header.Reserved = 0;
+			mResultsFile.write(reinterpret_cast<const char*>(&header), sizeof(header));
+
+			mPendingJobs.clear();
+			for (const SweepJob& job : mJobs)
+			{
+				SweepRecord record = { 0 };
+				record.JobIndex = job.Index;
+				record.Status = SweepStatus::Pending;
+				record.TimeStepDays = job.TimeStepDays;
+				record.DurationDays = job.DurationDays;
+				record.MassScale = job.MassScale;
+				mResultsFile.write(reinterpret_cast<const char*>(&record), sizeof(record));
+				mPendingJobs.push_back(job.Index);
+			}
+
+			mResultsFile.flush();
+			if (mResultsFile.good() == false)
+			{
+				throw GameException("Could not write the sweep results file.");
+			}
+		}
+	}
+
+	uint32_t ParameterSweep::JobCount() const
+	{
+		return static_cast<uint32_t>(mJobs.size());
+	}
+
+	uint32_t ParameterSweep::PendingCount() const
+	{
+		return static_cast<uint32_t>(mPendingJobs.size());
+	}
+
+	uint32_t ParameterSweep::Run(uint32_t workerCount, uint32_t jobTimeoutSeconds)
+	{
+		if (workerCount == 0)
+		{
+			workerCount = max(thread::hardware_concurrency(), 1U);
+		}
+
+		if (jobTimeoutSeconds == 0)
+		{
+			jobTimeoutSeconds = DefaultJobTimeoutSeconds;
+		}
+
+		uint32_t pendingCount = static_cast<uint32_t>(mPendingJobs.size());
+		workerCount = min(workerCount, pendingCount);
+		mFailureCount = 0;
+		mJobTimeoutMilliseconds = static_cast<uint32_t>(min(static_cast<uint64_t>(jobTimeoutSeconds) * 1000, static_cast<uint64_t>(numeric_limits<uint32_t>::max() - 1)));
+
+#if !defined(_WIN32)
+		// A worker that dies breaks its job pipe; writing to it then fails instead of ending this process
+		signal(SIGPIPE, SIG_IGN);
+#endif
+
+		// Deal the pending jobs out in contiguous runs, one per worker
+		mQueues.assign(workerCount, deque<uint32_t>());
+		for (uint32_t worker = 0; worker < workerCount; ++worker)
+		{
+			uint32_t first = static_cast<uint32_t>(static_cast<uint64_t>(pendingCount) * worker / workerCount);
+			uint32_t last = static_cast<uint32_t>(static_cast<uint64_t>(pendingCount) * (worker + 1) / workerCount);
+			mQueues[worker].assign(mPendingJobs.begin() + first, mPendingJobs.begin() + last);
+		}
+
+		// Each worker process is driven by its own thread, which blocks on the pipes of that process alone
+		vector<thread> threads;
+		vector<exception_ptr> failures(workerCount);
+		for (uint32_t worker = 0; worker < workerCount; ++worker)
+		{
+			threads.emplace_back([this, worker, &failures]()
+			{
+				try
+				{
+					ServeWorker(worker);
+				}
+				catch (...)
+				{
+					failures[worker] = current_exception();
+				}
+			});
+		}
+
+		for (thread& workerThread : threads)
+		{
+			workerThread.join();
+		}
+
+		for (const exception_ptr& failure : failures)
+		{
+			if (failure != nullptr)
+			{
+				rethrow_exception(failure);
+			}
+		}
+
+		mPendingJobs.clear();
+		return mFailureCount;
+	}
+
+	SweepGrid ParameterSweep::LoadGrid(const wstring& filename)
+	{
+#if defined(_WIN32)
+		ifstream file(filename.c_str());
+#else
+		ifstream file(Utility::ToPortablePath(filename));
+#endif
+		if (file.is_open() == false)
+		{
+			throw GameException("Could not open the sweep grid file.");
+		}
+
+		SweepGrid grid;
+		string line;
+		while (getline(file, line))
+		{
+			stringstream lineStream(line);
+			string name;
+			if (!(lineStream >> name) || name[0] == '#')
+			{
+				continue;
+			}
+
+			vector<double>* values = (name == "TimeStepDays" ? &grid.TimeStepDays : (name == "DurationDays" ? &grid.DurationDays : (name == "MassScale" ? &grid.MassScales : nullptr)));
+			if (values == nullptr)
+			{
+				throw GameException("The sweep grid file has an unknown parameter.");
+			}
+
+			double value;
+			while (lineStream >> value)
+			{
+				values->push_back(value);
+			}
+		}
+
+		if (grid.TimeStepDays.empty())
+		{
+			grid.TimeStepDays.push_back(0.1);
+		}
+
+		if (grid.DurationDays.empty())
+		{
+			grid.DurationDays.push_back(3652.5);
+		}
+
+		if (grid.MassScales.empty())
+		{
+			grid.MassScales.push_back(1.0);
+		}
+
+		return grid;
+	}
+
+	void ParameterSweep::ServeWorker(uint32_t worker)
+	{
+		WorkerProcess process = LaunchWorker();
+		uint32_t failedLaunches = 0;
+
+		uint32_t jobIndex;
+		while (NextJob(worker, jobIndex))
+		{
+			const SweepJob& job = mJobs[jobIndex];
+			if (WriteExactly(process.JobPipe, &job, sizeof(job)) == false)
+			{
+				// The process died before taking the job, so the job goes back to the queue; a worker that cannot even
+				// start would otherwise be relaunched forever
+				{
+					lock_guard<mutex> lock(mQueueMutex);
+					mQueues[worker].push_front(jobIndex);
+				}
+
+				CloseWorker(process);
+				if (++failedLaunches == MaxFailedLaunches)
+				{
+					throw GameException("Sweep workers exit before taking a job.");
+				}
+
+				process = LaunchWorker();
+				continue;
+			}
+
+			failedLaunches = 0;
+
+			SweepRecord record;
+			bool expired = false;
+			bool received = (ReceiveRecord(process, record, expired) && record.JobIndex == jobIndex);
+
+			// The deadline may pass just after a result arrives, so the worker is relaunched whenever it expired
+			if (received == false || expired)
+			{
+				CloseWorker(process);
+				process = LaunchWorker();
+			}
+
+			if (received == false)
+			{
+				record = { 0 };
+				record.JobIndex = jobIndex;
+				record.Status = (expired ? SweepStatus::TimedOut : SweepStatus::Crashed);
+				record.TimeStepDays = job.TimeStepDays;
+				record.DurationDays = job.DurationDays;
+				record.MassScale = job.MassScale;
+			}
+
+			WriteRecord(record);
+		}
+
+		CloseWorker(process);
+	}
+
+	bool ParameterSweep::NextJob(uint32_t worker, uint32_t& job)
+	{
+		lock_guard<mutex> lock(mQueueMutex);
+		deque<uint32_t>& queue = mQueues[worker];
+		if (queue.empty())
+		{
+			// Steal the back half of the longest queue; its owner keeps working from the front
+			auto victim = max_element(mQueues.begin(), mQueues.end(), [](const deque<uint32_t>& lhs, const deque<uint32_t>& rhs)
+			{
+				return lhs.size() < rhs.size();
+			});
+
+			size_t stolen = (victim->size() + 1) / 2;
+			if (stolen == 0)
+			{
+				return false;
+			}
+
+			queue.assign(victim->end() - stolen, victim->end());
+			victim->erase(victim->end() - stolen, victim->end());
+		}
+
+		job = queue.front();
+		queue.pop_front();
+		return true;
+	}
+
+#if defined(_WIN32)
+	bool ParameterSweep::ReceiveRecord(WorkerProcess& process, SweepRecord& record, bool& expired)
+	{
+		JobDeadline deadline;
+		deadline.Process = process.Process;
+		deadline.Expired = false;
+		HANDLE timer = nullptr;
+		if (CreateTimerQueueTimer(&timer, nullptr, ExpireJob, &deadline, mJobTimeoutMilliseconds, 0, WT_EXECUTEONLYONCE) == FALSE)
+		{
+			DWORD error = GetLastError();
+			CloseWorker(process);
+			throw GameException("CreateTimerQueueTimer() failed.", HRESULT_FROM_WIN32(error));
+		}
+
+		bool received = ReadExactly(process.ResultPipe, &record, sizeof(record));
+
+		// Waits for a callback already running, so the deadline outlives every use of it
+		DeleteTimerQueueTimer(nullptr, timer, INVALID_HANDLE_VALUE);
+
+		expired = deadline.Expired;
+		return received;
+	}
+
+	ParameterSweep::WorkerProcess ParameterSweep::LaunchWorker()
+	{
+		// Launches are serialized so that no other worker's inheritable pipe ends exist while a process is created
+		lock_guard<mutex> lock(mLaunchMutex);
+
+		SECURITY_ATTRIBUTES securityAttributes = { 0 };
+		securityAttributes.nLength = sizeof(securityAttributes);
+		securityAttributes.bInheritHandle = TRUE;
+
+		HANDLE childInput = nullptr;
+		HANDLE jobPipe = nullptr;
+		HANDLE resultPipe = nullptr;
+		HANDLE childOutput = nullptr;
+		if (CreatePipe(&childInput, &jobPipe, &securityAttributes, 0) == FALSE)
+		{
+			throw GameException("CreatePipe() failed.", HRESULT_FROM_WIN32(GetLastError()));
+		}
+
+		if (CreatePipe(&resultPipe, &childOutput, &securityAttributes, 0) == FALSE)
+		{
+			DWORD error = GetLastError();
+			CloseHandle(childInput);
+			CloseHandle(jobPipe);
+			throw GameException("CreatePipe() failed.", HRESULT_FROM_WIN32(error));
+		}
+
+		// Only the ends given to the worker are inherited
+		SetHandleInformation(jobPipe, HANDLE_FLAG_INHERIT, 0);
+		SetHandleInformation(resultPipe, HANDLE_FLAG_INHERIT, 0);
+
+		wchar_t executablePath[MAX_PATH];
+		GetModuleFileName(nullptr, executablePath, MAX_PATH);
+
+		wstring commandLine = L"\"" + wstring(executablePath) + L"\" " + WorkerSwitch;
+		vector<wchar_t> commandLineBuffer(commandLine.begin(), commandLine.end());
+		commandLineBuffer.push_back(L'\0');
+
+		STARTUPINFO startupInfo = { 0 };
+		startupInfo.cb = sizeof(startupInfo);
+		startupInfo.dwFlags = STARTF_USESTDHANDLES;
+		startupInfo.hStdInput = childInput;
+		startupInfo.hStdOutput = childOutput;
+		startupInfo.hStdError = nullptr;
+		PROCESS_INFORMATION processInformation = { 0 };
+		BOOL created = CreateProcess(executablePath, commandLineBuffer.data(), nullptr, nullptr, TRUE, CREATE_NO_WINDOW, nullptr, nullptr, &startupInfo, &processInformation);
+		DWORD error = GetLastError();
+
+		// Once the worker holds its ends, closing ours lets a read or write fail as soon as the worker exits
+		CloseHandle(childInput);
+		CloseHandle(childOutput);
+		if (created == FALSE)
+		{
+			CloseHandle(jobPipe);
+			CloseHandle(resultPipe);
+			throw GameException("CreateProcess() failed.", HRESULT_FROM_WIN32(error));
+		}
+
+		CloseHandle(processInformation.hThread);
+
+		WorkerProcess process;
+		process.Process = processInformation.hProcess;
+		process.JobPipe = jobPipe;
+		process.ResultPipe = resultPipe;
+		return process;
+	}
+
+	void ParameterSweep::CloseWorker(WorkerProcess& process)
+	{
+		// Closing the job pipe is the signal to exit
+		CloseHandle(process.JobPipe);
+		if (WaitForSingleObject(process.Process, WorkerShutdownMilliseconds) != WAIT_OBJECT_0)
+		{
+			TerminateProcess(process.Process, 1);
+		}
+
+		CloseHandle(process.ResultPipe);
+		CloseHandle(process.Process);
+		process = { nullptr, nullptr, nullptr };
+	}
+
+#else
+	bool ParameterSweep::ReceiveRecord(WorkerProcess& process, SweepRecord& record, bool& expired)
+	{
+		// Poll the result pipe until the record is whole or the deadline passes. A worker that exits hangs up its end,
+		// which ends the wait with a failed read.
+		auto deadline = chrono::steady_clock::now() + chrono::milliseconds(mJobTimeoutMilliseconds);
+		uint8_t* bytes = reinterpret_cast<uint8_t*>(&record);
+		size_t remaining = sizeof(record);
+		expired = false;
+
+		while (remaining > 0)
+		{
+			int64_t timeLeft = chrono::duration_cast<chrono::milliseconds>(deadline - chrono::steady_clock::now()).count();
+			if (timeLeft <= 0)
+			{
+				// The worker is reaped when it is closed
+				expired = true;
+				kill(process.Process, SIGKILL);
+				return false;
+			}
+
+			pollfd resultPipe = { process.ResultPipe, POLLIN, 0 };
+			int ready = poll(&resultPipe, 1, static_cast<int>(min(timeLeft, static_cast<int64_t>(numeric_limits<int>::max()))));
+			if (ready < 0 && errno != EINTR)
+			{
+				return false;
+			}
+
+			if (ready <= 0)
+			{
+				continue;
+			}
+
+			ssize_t count = read(process.ResultPipe, bytes, remaining);
+			if (count < 0 && errno == EINTR)
+			{
+				continue;
+			}
+
+			if (count <= 0)
+			{
+				return false;
+			}
+
+			bytes += count;
+			remaining -= static_cast<size_t>(count);
+		}
+
+		return true;
+	}
+
+	ParameterSweep::WorkerProcess ParameterSweep::LaunchWorker()
+	{
+		// Launches are serialized so that no other worker's pipe ends are open without FD_CLOEXEC while a process forks
+		lock_guard<mutex> lock(mLaunchMutex);
+
+		int jobPipe[2];
+		int resultPipe[2];
+		if (pipe(jobPipe) == -1)
+		{
+			throw GameException("pipe() failed.");
+		}
+
+		if (pipe(resultPipe) == -1)
+		{
+			close(jobPipe[0]);
+			close(jobPipe[1]);
+			throw GameException("pipe() failed.");
+		}
+
+		for (int descriptor : { jobPipe[0], jobPipe[1], resultPipe[0], resultPipe[1] })
+		{
+			CloseOnExec(descriptor);
+		}
+
+		// The worker is this executable again, which Linux names under /proc. The arguments are built before forking,
+		// as the child only moves its pipe ends to its standard input and output and calls execv().
+		const char executablePath[] = "/proc/self/exe";
+		vector<string> arguments = { executablePath, Utility::ToString(WorkerSwitch) };
+		vector<char*> argumentList;
+		for (string& argument : arguments)
+		{
+			argumentList.push_back(&argument[0]);
+		}
+
+		argumentList.push_back(nullptr);
+
+		pid_t worker = fork();
+		if (worker == 0)
+		{
+			// dup2() clears FD_CLOEXEC on the copies, so only these ends are inherited
+			if (dup2(jobPipe[0], STDIN_FILENO) == -1 || dup2(resultPipe[1], STDOUT_FILENO) == -1)
+			{
+				_exit(127);
+			}
+
+			execv(executablePath, argumentList.data());
+			_exit(127);
+		}
+
+		// Once the worker holds its ends, closing ours lets a read or write fail as soon as the worker exits
+		close(jobPipe[0]);
+		close(resultPipe[1]);
+		if (worker == -1)
+		{
+			close(jobPipe[1]);
+			close(resultPipe[0]);
+			throw GameException("fork() failed.");
+		}
+
+		WorkerProcess process;
+		process.Process = worker;
+		process.JobPipe = jobPipe[1];
+		process.ResultPipe = resultPipe[0];
+		return process;
+	}
+
+	void ParameterSweep::CloseWorker(WorkerProcess& process)
+	{
+		// Closing the job pipe is the signal to exit
+		close(process.JobPipe);
+		auto deadline = chrono::steady_clock::now() + chrono::milliseconds(WorkerShutdownMilliseconds);
+		while (waitpid(process.Process, nullptr, WNOHANG) == 0)
+		{
+			if (chrono::steady_clock::now() >= deadline)
+			{
+				kill(process.Process, SIGKILL);
+				waitpid(process.Process, nullptr, 0);
+				break;
+			}
+
+			this_thread::sleep_for(chrono::milliseconds(1));
+		}
+
+		close(process.ResultPipe);
+		process = { -1, -1, -1 };
+	}
+
+#endif
+
+	void ParameterSweep::WriteRecord(const SweepRecord& record)
+	{
+		lock_guard<mutex> lock(mFileMutex);
+		if (record.Status == SweepStatus::Crashed || record.Status == SweepStatus::TimedOut)
+		{
+			++mFailureCount;
+		}
+
+		mResultsFile.seekp(sizeof(SweepResultsHeader) + static_cast<streamoff>(record.JobIndex) * sizeof(SweepRecord));
+		mResultsFile.write(reinterpret_cast<const char*>(&record), sizeof(record));
+		mResultsFile.flush();
+		if (mResultsFile.good() == false)
+		{
+			throw GameException("Could not write the sweep results file.");
+		}
+	}
+
+	int SweepWorker::Run(const wstring& catalogFileName)
+	{
+#if defined(_WIN32)
+		HANDLE input = GetStdHandle(STD_INPUT_HANDLE);
+		HANDLE output = GetStdHandle(STD_OUTPUT_HANDLE);
+		if (input == nullptr || input == INVALID_HANDLE_VALUE || output == nullptr || output == INVALID_HANDLE_VALUE)
+		{
+			return 1;
+		}
+#else
+		const int input = STDIN_FILENO;
+		const int output = STDOUT_FILENO;
+#endif
+
+		BodyCatalog catalog(catalogFileName);
+		const PlanetarySystem solarSystem = SystemBatchRunner::FromCatalog(catalog);
+
+		// One process per core already fills the machine, so each worker integrates on a single thread
+		ThreadPool threadPool(1);
+
+		SweepJob job;
+		while (ReadExactly(input, &job, sizeof(job)))
+		{
+			SystemBatchSettings settings;
+			settings.TimeStepDays = job.TimeStepDays;
+			settings.DurationDays = job.DurationDays;
+			settings.SampleInterval = 100;
+			settings.EscapeDistance = 1000.0;
+			settings.CloseEncounterDistance = 0.01;
+
+			PlanetarySystem system = solarSystem;
+			for (uint32_t i = 0; i < system.PlanetCount; ++i)
+			{
+				system.Planets[i].Mass *= job.MassScale;
+			}
+
+			SystemBatchRunner runner(threadPool, settings);
+			vector<SystemResult> results = runner.Run(vector<PlanetarySystem>(1, system));
+
+			SweepRecord record = { 0 };
+			record.JobIndex = job.Index;
+			record.Status = SweepStatus::Completed;
+			record.TimeStepDays = job.TimeStepDays;
+			record.DurationDays = job.DurationDays;
+			record.MassScale = job.MassScale;
+			record.Result = results[0];
+			record.Result.SystemIndex = job.Index;
+			if (WriteExactly(output, &record, sizeof(record)) == false)
+			{
+				return 1;
+			}
+		}
+
+		return 0;
+	}
+}
\ No newline at end of file
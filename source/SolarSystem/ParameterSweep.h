@@ -0,0 +1,180 @@
+#pragma once
+
+#include "Platform.h"
+#include "SystemBatchRunner.h"
+#include <vector>
+#include <deque>
+#include <string>
+#include <mutex>
+#include <fstream>
+#include <cstdint>
+
+namespace Rendering
+{
+	/**
+	* The values each parameter takes in a sweep. Every combination is run once.
+	*/
+	struct SweepGrid
+	{
+		std::vector<double> TimeStepDays;
+		std::vector<double> DurationDays;
+		std::vector<double> MassScales;			// Factors applied to the mass of every planet
+	};
+
+	/**
+	* One combination of the grid, as sent to a worker.
+	*/
+	struct SweepJob
+	{
+		std::uint32_t Index;
+		std::uint32_t Reserved;
+		double TimeStepDays;
+		double DurationDays;
+		double MassScale;
+	};
+
+	enum class SweepStatus : std::uint32_t
+	{
+		Pending,
+		Completed,
+		Crashed,		// The worker process died while running the job
+		TimedOut		// The job ran past its deadline and the worker process was terminated
+	};
+
+	/**
+	* The record of one job in the results file, at the offset given by its index.
+	*/
+	struct SweepRecord
+	{
+		std::uint32_t JobIndex;
+		SweepStatus Status;
+		double TimeStepDays;
+		double DurationDays;
+		double MassScale;
+		SystemResult Result;
+		std::uint32_t Reserved;
+	};
+
+	struct SweepResultsHeader
+	{
+		std::uint32_t Magic;
+		std::uint32_t Version;
+		std::uint32_t RecordCount;
+		std::uint32_t RecordSize;
+		std::uint64_t GridHash;
+		std::uint64_t Reserved;
+	};
+
+	static_assert(sizeof(SweepJob) == 32, "SweepJob must match the pipe protocol.");
+	static_assert(sizeof(SweepRecord) == 56, "SweepRecord must match the file layout.");
+	static_assert(sizeof(SweepResultsHeader) == 32, "SweepResultsHeader must match the file layout.");
+
+	/**
+	* Runs every combination of a grid of integration parameters on the solar system of the body catalog, one worker
+	* process per hardware thread. Each worker is this executable started without a window; jobs and results travel
+	* over its standard input and output pipes, one job at a time. Windows runs the workers with CreateProcess() and
+	* a timer per job; elsewhere they are forked and executed, and the results polled for until the deadline.
+	*
+	* Jobs are dealt out in contiguous runs, one queue per worker. A worker whose queue runs dry steals the last half of
+	* the longest remaining queue, so uneven job lengths do not leave cores idle at the end of a sweep.
+	*
+	* Results are written into a file that holds one fixed-size record per job, flushed after each result, so a sweep
+	* interrupted at any point resumes by running only the jobs still pending. A worker that crashes marks its current
+	* job as crashed and is relaunched; the other jobs are not affected. A worker still running a job when its deadline
+	* passes is terminated, the job is marked as timed out and the worker is relaunched the same way.
+	*/
+	class ParameterSweep final
+	{
+	public:
+		/**
+		* @param grid The parameter values to combine.
+		* @param resultsFileName The results file. An existing file written for the same grid is resumed.
+		*/
+		ParameterSweep(const SweepGrid& grid, const std::wstring& resultsFileName);
+		ParameterSweep(const ParameterSweep&) = delete;
+		ParameterSweep& operator=(const ParameterSweep&) = delete;
+		ParameterSweep(ParameterSweep&&) = delete;
+		ParameterSweep& operator=(ParameterSweep&&) = delete;
+		~ParameterSweep() = default;
+
+		std::uint32_t JobCount() const;
+		/**
+		* Get the number of jobs left from an earlier run of the sweep, or all of them for a new results file.
+		*/
+		std::uint32_t PendingCount() const;
+
+		/**
+		* Run the pending jobs and wait for all of them.
+		* @param workerCount The number of worker processes, or zero for one per hardware thread.
+		* @param jobTimeoutSeconds The time each job may run before its worker is terminated, or zero for DefaultJobTimeoutSeconds.
+		* @return The number of jobs whose worker crashed or ran past the deadline.
+		*/
+		std::uint32_t Run(std::uint32_t workerCount = 0, std::uint32_t jobTimeoutSeconds = 0);
+
+		/**
+		* Read a grid from a text file with one parameter per line: its name, TimeStepDays, DurationDays or MassScale,
+		* followed by its values. Lines starting with '#' are ignored, and a parameter left out takes a single default value.
+		*/
+		static SweepGrid LoadGrid(const std::wstring& filename);
+
+		/**
+		* The command line switch that starts a process as a sweep worker.
+		*/
+		static const std::wstring WorkerSwitch;
+		static const std::uint32_t ResultsMagic;
+		static const std::uint32_t ResultsVersion;
+		static const std::uint32_t DefaultJobTimeoutSeconds;
+
+	private:
+		struct WorkerProcess
+		{
+#if defined(_WIN32)
+			HANDLE Process;
+			HANDLE JobPipe;
+			HANDLE ResultPipe;
+#else
+			pid_t Process;
+			int JobPipe;
+			int ResultPipe;
+#endif
+		};
+
+		void ServeWorker(std::uint32_t worker);
+		bool NextJob(std::uint32_t worker, std::uint32_t& job);
+		/**
+		* Wait for the result of the job a worker is running, terminating the worker if the deadline passes first.
+		*/
+		bool ReceiveRecord(WorkerProcess& process, SweepRecord& record, bool& expired);
+		WorkerProcess LaunchWorker();
+		static void CloseWorker(WorkerProcess& process);
+		void WriteRecord(const SweepRecord& record);
+
+		std::vector<SweepJob> mJobs;
+		std::vector<std::uint32_t> mPendingJobs;
+		std::uint64_t mGridHash;
+
+		std::mutex mQueueMutex;
+		std::vector<std::deque<std::uint32_t>> mQueues;
+		std::mutex mLaunchMutex;
+		std::mutex mFileMutex;
+		std::fstream mResultsFile;
+		std::uint32_t mFailureCount;
+		std::uint32_t mJobTimeoutMilliseconds;
+	};
+
+	/**
+	* The body of a sweep worker process.
+	*/
+	class SweepWorker final
+	{
+	public:
+		/**
+		* Run the jobs read from standard input and write one SweepRecord per job to standard output, until the input closes.
+		* @param catalogFileName The body catalog whose solar system every job integrates.
+		* @return The process exit code.
+		*/
+		static int Run(const std::wstring& catalogFileName);
+
+		SweepWorker() = delete;
+	};
+}
\ No newline at end of file
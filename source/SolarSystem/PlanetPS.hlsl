@@ -1,11 +1,25 @@
+static const uint MaxOccluders = 4;
+
 cbuffer CBufferPerFrame
 {
-	float3 AmbientColor;
+	float4x4 ViewProjection;
 	float3 LightPosition;
+	float LightRange;
 	float3 LightColor;
 };
 
-Texture2D ColorMap;
+struct PlanetInstance
+{
+	float4x4 World;
+	float4 Occluders[MaxOccluders];	// Position in xyz and radius in w
+	uint OccluderCount;
+	float LightRadius;
+	uint TextureSlice;
+	float AmbientIntensity;
+};
+
+StructuredBuffer<PlanetInstance> Instances;
+Texture2DArray ColorMaps;
 SamplerState TextureSampler;
 
 struct VS_OUTPUT
@@ -15,20 +29,53 @@ struct VS_OUTPUT
 	float Attenuation : ATTENUATION;
 	float2 TextureCoordinate : TEXCOORD;
 	float3 Normal : NORMAL;
+	nointerpolation uint Instance : INSTANCE;
 };
 
+// The fraction of the light's disk left uncovered by an occluder, treating both as disks in the sky of the fragment
+float LightVisibility(float3 worldPosition, float3 lightDirection, float lightDistance, float lightRadius, float4 occluder)
+{
+	float3 toOccluder = occluder.xyz - worldPosition;
+	float occluderDistance = length(toOccluder);
+	if (occluderDistance >= lightDistance || dot(toOccluder, lightDirection) <= 0)
+	{
+		return 1;
+	}
+
+	float lightAngle = asin(saturate(lightRadius / lightDistance));
+	float occluderAngle = asin(saturate(occluder.w / occluderDistance));
+	float separation = acos(saturate(dot(toOccluder / occluderDistance, lightDirection)));
+
+	// Coverage grows from first contact until the smaller disk lies inside the larger, and is capped by their area ratio
+	float overlap = saturate((lightAngle + occluderAngle - separation) / max(2 * min(lightAngle, occluderAngle), 1e-6));
+	float coverage = min((occluderAngle * occluderAngle) / max(lightAngle * lightAngle, 1e-12), 1);
+
+	return 1 - overlap * coverage;
+}
+
 float4 main(VS_OUTPUT IN) : SV_TARGET
 {
-	float3 lightDirection = normalize(LightPosition - IN.WorldPosition);
+	PlanetInstance instance = Instances[IN.Instance];
+
+	float3 toLight = LightPosition - IN.WorldPosition;
+	float lightDistance = length(toLight);
+	float3 lightDirection = toLight / lightDistance;
 
 	float3 normal = normalize(IN.Normal);
 	float n_dot_l = dot(normal, lightDirection);
 
-	float4 color = ColorMap.Sample(TextureSampler, IN.TextureCoordinate);
+	float4 color = ColorMaps.Sample(TextureSampler, float3(IN.TextureCoordinate, instance.TextureSlice));
 
-	float3 ambient = color.rgb * AmbientColor;
+	float3 ambient = color.rgb * instance.AmbientIntensity;
 	float3 diffuse = (n_dot_l > 0 ? color.rgb * n_dot_l * LightColor : (float3)0);
 	diffuse = diffuse * IN.Attenuation;
 
+	float visibility = 1;
+	for (uint i = 0; i < instance.OccluderCount; i++)
+	{
+		visibility *= LightVisibility(IN.WorldPosition, lightDirection, lightDistance, instance.LightRadius, instance.Occluders[i]);
+	}
+	diffuse = diffuse * visibility;
+
 	return float4(saturate(ambient + diffuse), color.a);
 }
\ No newline at end of file
@@ -0,0 +1,279 @@
+#include "pch.h"
+
+using namespace std;
+using namespace Library;
+using namespace DirectX;
+
+namespace Rendering
+{
+	RTTI_DEFINITIONS(PlanetRenderer)
+
+	namespace
+	{
+		const uint32_t InitialInstanceCapacity = 64;
+	}
+
+	PlanetRenderer::PlanetRenderer(Game& game, const shared_ptr<Camera>& camera) :
+		DrawableGameComponent(game, camera), mPointLight(nullptr), mSphereRadius(0.0f), mDevice(nullptr), mConstantStorage(nullptr), mInstanceBuffer(RenderDevice::NullHandle), mInstanceCapacity(0),
+		mBatches(nullptr), mShader(0), mColorTexture(RenderQueue::NoTexture), mPerFrameConstants()
+	{
+	}
+
+	void PlanetRenderer::Initialize()
+	{
+		if (mSphereRadius <= 0.0f || mTextureFileNames.empty())
+		{
+			throw GameException("No bodies were registered with the planet renderer.");
+		}
+
+		// Start decoding the textures on the pool of the cache while the shaders and meshes load
+		TextureCache* textureCache = (TextureCache*)mGame->Services().GetService(TextureCache::TypeIdClass());
+		assert(textureCache != nullptr);
+
+		vector<TextureCache::TextureFuture> textureLoads;
+		textureLoads.reserve(mTextureFileNames.size());
+		for (const wstring& textureFileName : mTextureFileNames)
+		{
+			textureLoads.push_back(textureCache->Load(textureFileName, InstanceBatcher::TextureWidth, InstanceBatcher::TextureHeight));
+		}
+
+		DeviceRenderBackend* renderBackend = (DeviceRenderBackend*)mGame->Services().GetService(DeviceRenderBackend::TypeIdClass());
+		assert(renderBackend != nullptr);
+		mDevice = &renderBackend->Device();
+
+		mConstantStorage = (DeviceConstantBufferStorage*)mGame->Services().GetService(DeviceConstantBufferStorage::TypeIdClass());
+		assert(mConstantStorage != nullptr);
+
+		// Load the compiled shaders; the instance data is read from the structured buffer, not the input assembler
+		vector<char> compiledVertexShader;
+		Utility::LoadBinaryFile(L"Content\\Shaders\\PlanetVS.cso", compiledVertexShader);
+		vector<char> compiledPixelShader;
+		Utility::LoadBinaryFile(L"Content\\Shaders\\PlanetPS.cso", compiledPixelShader);
+
+		const RenderDevice::VertexElement vertexElements[] =
+		{
+			{ "POSITION", 0, RenderDevice::VertexFormat::Float4 },
+			{ "TEXCOORD", 0, RenderDevice::VertexFormat::Float2 },
+			{ "NORMAL", 0, RenderDevice::VertexFormat::Float3 }
+		};
+
+		uint32_t shader = mDevice->CreateShader(&compiledVertexShader[0], compiledVertexShader.size(), &compiledPixelShader[0], compiledPixelShader.size(), vertexElements, ARRAYSIZE(vertexElements));
+
+		// Build the sphere chain once for every body drawn with it
+		mSphereLods = make_unique<IcosphereLodChain>(mSphereRadius);
+		mMeshes.resize(IcosphereLodChain::LevelCount);
+		for (uint32_t level = 0; level < IcosphereLodChain::LevelCount; ++level)
+		{
+			CreateSphereMesh(level, mMeshes[level]);
+		}
+
+		uint32_t colorTextures = CreateTextureArray(textureLoads);
+		CreateInstanceBuffer(InitialInstanceCapacity);
+
+		// The render queue binds the shaders and the texture array between the batches of other components
+		mShader = renderBackend->AddShader(shader);
+		mColorTexture = renderBackend->AddTexture(colorTextures, 1);
+	}
+
+	void PlanetRenderer::Update(const GameTime& gameTime)
+	{
+		UNREFERENCED_PARAMETER(gameTime);
+
+		mBatcher.Clear();
+		mCuller.Clear();
+	}
+
+	void PlanetRenderer::Draw(const GameTime& gameTime)
+	{
+		UNREFERENCED_PARAMETER(gameTime);
+		assert(mCamera != nullptr);
+
+		if (mBatcher.InstanceCount() == 0 || mPointLight == nullptr)
+		{
+			return;
+		}
+
+		mCuller.SetView(mCamera->ViewProjectionMatrix());
+		uint32_t instanceCount = mCuller.Cull();
+		if (instanceCount == 0)
+		{
+			return;
+		}
+
+		if (instanceCount > mInstanceCapacity)
+		{
+			CreateInstanceBuffer(max(instanceCount, mInstanceCapacity * 2));
+		}
+
+		// Unbind the instances of the previous frame so the buffer can be rewritten without a hazard warning
+		mDevice->SetStructuredBuffer(RenderDevice::ShaderStage::Vertex, 0, RenderDevice::NullHandle);
+		mDevice->SetStructuredBuffer(RenderDevice::ShaderStage::Pixel, 0, RenderDevice::NullHandle);
+
+		// Group the visible instances by mesh straight into the structured buffer
+		void* instances = mDevice->Map(mInstanceBuffer, true);
+		mBatches = &mBatcher.Build(static_cast<PlanetInstance*>(instances), mCuller.VisibleIndices(), instanceCount);
+		mDevice->Unmap(mInstanceBuffer, static_cast<uint32_t>(sizeof(PlanetInstance)) * instanceCount);
+
+		FrameConstantAllocator* frameConstants = (FrameConstantAllocator*)mGame->Services().GetService(FrameConstantAllocator::TypeIdClass());
+		assert(frameConstants != nullptr);
+
+		// The light moves with the floating origin
+		CBufferPerFrame perFrame;
+		XMStoreFloat4x4(&perFrame.ViewProjection, XMMatrixTranspose(mCamera->ViewProjectionMatrix()));
+		perFrame.LightPosition = mPointLight->Position();
+		perFrame.LightRange = mPointLight->Radius();
+		perFrame.LightColor = ColorHelper::ToFloat3(mPointLight->Color(), true);
+		perFrame.Padding = 0.0f;
+		mPerFrameConstants = frameConstants->Upload(perFrame);
+
+		RenderQueue* renderQueue = (RenderQueue*)mGame->Services().GetService(RenderQueue::TypeIdClass());
+		assert(renderQueue != nullptr);
+
+		// SV_InstanceID restarts at zero for every draw, so the first instance of each batch is passed alongside
+		uint64_t key = RenderQueue::MakeKey(DeviceRenderBackend::DefaultPass, mShader, mColorTexture, 0.0f);
+		mPerBatchConstants.clear();
+		for (uint32_t batch = 0; batch < mBatches->size(); ++batch)
+		{
+			CBufferPerBatch perBatch = { (*mBatches)[batch].FirstInstance, { 0, 0, 0 } };
+			mPerBatchConstants.push_back(frameConstants->Upload(perBatch));
+			renderQueue->Submit(key, *this, batch);
+		}
+	}
+
+	void PlanetRenderer::ExecuteDraw(uint32_t command)
+	{
+		const InstanceBatch& batch = mBatches->at(command);
+		const MeshEntry& mesh = mMeshes[batch.Mesh];
+
+		// The queue has bound the shaders and the texture array; the rest of the state may belong to another component
+		mDevice->SetPrimitiveTopology(RenderDevice::PrimitiveTopology::TriangleList);
+		mDevice->SetVertexBuffer(mesh.VertexBuffer, sizeof(VertexPositionTextureNormal));
+		mDevice->SetIndexBuffer(mesh.IndexBuffer);
+
+		mConstantStorage->SetConstantBuffer(RenderDevice::ShaderStage::Vertex, 0, mPerFrameConstants);
+		mConstantStorage->SetConstantBuffer(RenderDevice::ShaderStage::Vertex, 1, mPerBatchConstants[command]);
+		mConstantStorage->SetConstantBuffer(RenderDevice::ShaderStage::Pixel, 0, mPerFrameConstants);
+		mDevice->SetStructuredBuffer(RenderDevice::ShaderStage::Vertex, 0, mInstanceBuffer);
+		mDevice->SetStructuredBuffer(RenderDevice::ShaderStage::Pixel, 0, mInstanceBuffer);
+		mDevice->SetSampler(RenderDevice::ShaderStage::Pixel, 0, RenderDevice::SamplerType::TrilinearWrap);
+
+		mDevice->DrawIndexedInstanced(mesh.IndexCount, batch.InstanceCount, 0, 0, 0);
+	}
+
+	uint32_t PlanetRenderer::AddSphereLods(float radius)
+	{
+		if (mSphereRadius > 0.0f)
+		{
+			if (radius != mSphereRadius)
+			{
+				throw GameException("Every body drawn with the sphere levels of detail must have the same radius.");
+			}
+
+			return 0;
+		}
+
+		if (radius <= 0.0f)
+		{
+			throw GameException("The radius of the sphere levels of detail must be positive.");
+		}
+
+		mSphereRadius = radius;
+		return 0;
+	}
+
+	uint32_t PlanetRenderer::AddTexture(const wstring& textureFileName)
+	{
+		auto found = find(mTextureFileNames.begin(), mTextureFileNames.end(), textureFileName);
+		if (found != mTextureFileNames.end())
+		{
+			return static_cast<uint32_t>(found - mTextureFileNames.begin());
+		}
+
+		mTextureFileNames.push_back(textureFileName);
+		return static_cast<uint32_t>(mTextureFileNames.size() - 1);
+	}
+
+	float PlanetRenderer::MeshRadius(uint32_t mesh) const
+	{
+		return mMeshes.at(mesh).Radius;
+	}
+
+	void PlanetRenderer::SetLight(const PointLight& pointLight)
+	{
+		mPointLight = &pointLight;
+	}
+
+	void PlanetRenderer::Submit(uint32_t mesh, const PlanetInstance& instance)
+	{
+		assert(mesh < mMeshes.size());
+		mBatcher.Add(mesh, instance);
+
+		// The world matrix is stored transposed, so its columns hold the scaled axes and the translation
+		const XMFLOAT4X4& world = instance.World;
+		float scaleSquared = max(max(world._11 * world._11 + world._21 * world._21 + world._31 * world._31, world._12 * world._12 + world._22 * world._22 + world._32 * world._32), world._13 * world._13 + world._23 * world._23 + world._33 * world._33);
+		mCuller.Add(XMFLOAT3(world._14, world._24, world._34), sqrt(scaleSquared) * mMeshes[mesh].Radius);
+	}
+
+	uint32_t PlanetRenderer::SelectSphereLod(const XMFLOAT3& center, float radius, uint32_t level) const
+	{
+		assert(mSphereLods != nullptr);
+		assert(mCamera != nullptr);
+
+		// The finest level from within the sphere, where its radius on the screen is unbounded
+		float distance = XMVectorGetX(XMVector3Length(XMLoadFloat3(&center) - mCamera->PositionVector()));
+		if (distance <= radius)
+		{
+			return IcosphereLodChain::LevelCount - 1;
+		}
+
+		// The projection scales a length at unit distance to half the height of the viewport
+		float focalLength = XMVectorGetY(mCamera->ProjectionMatrix().r[1]) * 0.5f * mGame->Viewport().Height;
+		return mSphereLods->SelectLevel(radius * focalLength / distance, level);
+	}
+
+	void PlanetRenderer::CreateSphereMesh(uint32_t level, MeshEntry& meshEntry) const
+	{
+		// The levels are generated, not read from a model, so they are created on the render device directly
+		const vector<VertexPositionTextureNormal>& vertices = mSphereLods->Vertices(level);
+		const vector<uint32_t>& indices = mSphereLods->Indices(level);
+		meshEntry.VertexBuffer = mDevice->CreateBuffer({ RenderDevice::BufferType::Vertex, false, static_cast<uint32_t>(sizeof(VertexPositionTextureNormal) * vertices.size()), 0 }, vertices.data());
+		meshEntry.IndexBuffer = mDevice->CreateBuffer({ RenderDevice::BufferType::Index, false, static_cast<uint32_t>(sizeof(uint32_t) * indices.size()), 0 }, indices.data());
+		meshEntry.IndexCount = static_cast<uint32_t>(indices.size());
+		meshEntry.Radius = mSphereLods->Radius();
+	}
+
+	uint32_t PlanetRenderer::CreateTextureArray(const vector<TextureCache::TextureFuture>& textureLoads)
+	{
+		vector<shared_ptr<const TextureData>> textures;
+		textures.reserve(textureLoads.size());
+		for (const TextureCache::TextureFuture& textureLoad : textureLoads)
+		{
+			textures.push_back(textureLoad.get());
+		}
+
+		// Every texture arrives scaled to the size of a slice with its mip chain, so the array is created filled
+		const uint32_t mipLevels = static_cast<uint32_t>(textures.front()->MipLevels.size());
+		vector<RenderDevice::SubresourceData> subresources;
+		subresources.reserve(textures.size() * mipLevels);
+		for (const auto& texture : textures)
+		{
+			for (const DecodedImage& level : texture->MipLevels)
+			{
+				subresources.push_back({ level.Pixels.data(), level.Width * 4 });
+			}
+		}
+
+		return mDevice->CreateTexture({ InstanceBatcher::TextureWidth, InstanceBatcher::TextureHeight, mipLevels, static_cast<uint32_t>(textures.size()) }, subresources.data());
+	}
+
+	void PlanetRenderer::CreateInstanceBuffer(uint32_t capacity)
+	{
+		if (mInstanceBuffer != RenderDevice::NullHandle)
+		{
+			mDevice->ReleaseBuffer(mInstanceBuffer);
+		}
+
+		mInstanceBuffer = mDevice->CreateBuffer({ RenderDevice::BufferType::Structured, true, static_cast<uint32_t>(sizeof(PlanetInstance)) * capacity, sizeof(PlanetInstance) }, nullptr);
+		mInstanceCapacity = capacity;
+	}
+}
\ No newline at end of file
@@ -0,0 +1,143 @@
+#pragma once
+
+#include "DrawableGameComponent.h"
+#include "RenderQueue.h"
+#include "InstanceBatcher.h"
+#include "FrustumCuller.h"
+#include "FrameConstantAllocator.h"
+#include "TextureCache.h"
+#include "IcosphereLodChain.h"
+#include <vector>
+#include <string>
+#include <map>
+#include <DirectXMath.h>
+
+namespace Library
+{
+	class PointLight;
+	class RenderDevice;
+	class DeviceConstantBufferStorage;
+}
+
+namespace Rendering
+{
+	/**
+	* Draws every body with one instanced draw per mesh. Bodies register the sphere and their texture before initialization
+	* and submit an instance each frame they are visible; the instances are grouped by mesh into a structured buffer
+	* filled with a single map per frame. The textures of all bodies are decoded in parallel by the texture cache and
+	* resampled into the slices of one texture array, so bodies sharing a mesh differ only in their instance data.
+	* Before drawing, the bounding sphere of every instance is culled against the view of the camera, and only the
+	* visible instances are written to the buffer. Each batch is then submitted to the render queue of the game and
+	* drawn when the queue reaches it. The constants of the frame and of each batch are written once, as the batches
+	* are submitted, through the frame constant allocator of the game. Every buffer is created, and every draw issued,
+	* through the render device of the render queue.
+	*
+	* The bodies are spheres drawn from a chain of icosphere levels of detail, one mesh per level. The chain is built
+	* once for every body, and each body selects its level every frame from its radius on the screen, so a body
+	* covering one pixel is drawn with twenty triangles and one filling the screen with as many as its silhouette needs.
+	*
+	* The renderer clears the instances in its update, so it must come before the bodies among the components of the
+	* game, and it draws after every update of the frame, once all bodies have submitted.
+	*/
+	class PlanetRenderer final : public Library::DrawableGameComponent, public Library::RenderQueueClient
+	{
+		RTTI_DECLARATIONS(PlanetRenderer, Library::DrawableGameComponent)
+
+	public:
+		PlanetRenderer(Library::Game& game, const std::shared_ptr<Library::Camera>& camera);
+		PlanetRenderer(const PlanetRenderer&) = delete;
+		PlanetRenderer& operator=(const PlanetRenderer&) = delete;
+		PlanetRenderer(PlanetRenderer&&) = delete;
+		PlanetRenderer& operator=(PlanetRenderer&&) = delete;
+		~PlanetRenderer() = default;
+
+		virtual void Initialize() override;
+		virtual void Update(const Library::GameTime& gameTime) override;
+		virtual void Draw(const Library::GameTime& gameTime) override;
+		/**
+		* Draw one batch of the instances written by Draw().
+		*/
+		virtual void ExecuteDraw(std::uint32_t command) override;
+
+		/**
+		* Register the chain of icosphere levels of detail, built once for every body drawn with it. Call before Initialize().
+		* @param radius The radius of the spheres, in model units.
+		* @return The index of the mesh of the coarsest level; the mesh of each finer level follows the one before it.
+		*/
+		std::uint32_t AddSphereLods(float radius);
+		/**
+		* Register the color texture of a body. Call before Initialize().
+		* @return The slice of the texture array holding it, the same for every body naming the same file.
+		*/
+		std::uint32_t AddTexture(const std::wstring& textureFileName);
+		/**
+		* Get the largest distance of a vertex of a mesh from its origin. Valid after Initialize().
+		*/
+		float MeshRadius(std::uint32_t mesh) const;
+		/**
+		* Set the point light illuminating every body.
+		*/
+		void SetLight(const Library::PointLight& pointLight);
+
+		/**
+		* Queue a body to be drawn this frame, if its bounding sphere is within the view.
+		*/
+		void Submit(std::uint32_t mesh, const PlanetInstance& instance);
+		/**
+		* Select the level of detail a sphere is drawn with this frame, from its radius on the screen. Valid after Initialize().
+		* @param center The center of the sphere, in scene units.
+		* @param radius The radius of the sphere, in scene units.
+		* @param level The level the sphere was drawn with last frame.
+		* @return The level to draw it with, to be added to the mesh of the coarsest level.
+		*/
+		std::uint32_t SelectSphereLod(const DirectX::XMFLOAT3& center, float radius, std::uint32_t level) const;
+
+	private:
+		struct MeshEntry
+		{
+			std::uint32_t VertexBuffer;		// The buffers of the mesh on the render device
+			std::uint32_t IndexBuffer;
+			std::uint32_t IndexCount;
+			float Radius;
+		};
+
+		struct CBufferPerFrame
+		{
+			DirectX::XMFLOAT4X4 ViewProjection;
+			DirectX::XMFLOAT3 LightPosition;
+			float LightRange;
+			DirectX::XMFLOAT3 LightColor;
+			float Padding;
+		};
+
+		struct CBufferPerBatch
+		{
+			std::uint32_t FirstInstance;
+			std::uint32_t Padding[3];
+		};
+
+		void CreateSphereMesh(std::uint32_t level, MeshEntry& meshEntry) const;
+		std::uint32_t CreateTextureArray(const std::vector<Library::TextureCache::TextureFuture>& textureLoads);
+		void CreateInstanceBuffer(std::uint32_t capacity);
+
+		std::vector<std::wstring> mTextureFileNames;
+		std::vector<MeshEntry> mMeshes;
+		const Library::PointLight* mPointLight;
+
+		std::unique_ptr<IcosphereLodChain> mSphereLods;
+		float mSphereRadius;
+
+		Library::RenderDevice* mDevice;
+		Library::DeviceConstantBufferStorage* mConstantStorage;
+		InstanceBatcher mBatcher;
+		FrustumCuller mCuller;
+		std::uint32_t mInstanceBuffer;
+		std::uint32_t mInstanceCapacity;
+		const std::vector<InstanceBatch>* mBatches;
+		std::uint32_t mShader;
+		std::uint32_t mColorTexture;
+
+		Library::FrameConstantAllocator::Allocation mPerFrameConstants;
+		std::vector<Library::FrameConstantAllocator::Allocation> mPerBatchConstants;
+	};
+}
\ No newline at end of file
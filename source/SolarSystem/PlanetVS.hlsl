@@ -1,20 +1,36 @@
+static const uint MaxOccluders = 4;
+
 cbuffer CBufferPerFrame
 {
+	float4x4 ViewProjection;
 	float3 LightPosition;
-	float LightRadius;
+	float LightRange;
+	float3 LightColor;
 }
 
-cbuffer CBufferPerObject
+cbuffer CBufferPerBatch
 {
-	float4x4 WorldViewProjection;
-	float4x4 World;
+	uint FirstInstance;
 }
 
+struct PlanetInstance
+{
+	float4x4 World;
+	float4 Occluders[MaxOccluders];	// Position in xyz and radius in w
+	uint OccluderCount;
+	float LightRadius;
+	uint TextureSlice;
+	float AmbientIntensity;
+};
+
+StructuredBuffer<PlanetInstance> Instances;
+
 struct VS_INPUT
 {
 	float4 ObjectPosition: POSITION;
 	float2 TextureCoordinate : TEXCOORD;
 	float3 Normal : NORMAL;
+	uint InstanceID : SV_InstanceID;
 };
 
 struct VS_OUTPUT
@@ -24,19 +40,25 @@ struct VS_OUTPUT
 	float Attenuation : ATTENUATION;
 	float2 TextureCoordinate : TEXCOORD;
 	float3 Normal : NORMAL;
+	nointerpolation uint Instance : INSTANCE;
 };
 
 VS_OUTPUT main(VS_INPUT IN)
 {
 	VS_OUTPUT OUT = (VS_OUTPUT)0;
 
-	OUT.Position = mul(IN.ObjectPosition, WorldViewProjection);
-	OUT.WorldPosition = mul(IN.ObjectPosition, World).xyz;
+	uint instance = FirstInstance + IN.InstanceID;
+	float4x4 world = Instances[instance].World;
+
+	float4 worldPosition = mul(IN.ObjectPosition, world);
+	OUT.Position = mul(worldPosition, ViewProjection);
+	OUT.WorldPosition = worldPosition.xyz;
 	OUT.TextureCoordinate = IN.TextureCoordinate;
-	OUT.Normal = normalize(mul(float4(IN.Normal, 0), World).xyz);
+	OUT.Normal = normalize(mul(float4(IN.Normal, 0), world).xyz);
+	OUT.Instance = instance;
 
 	float3 lightDirection = LightPosition - OUT.WorldPosition;
-	OUT.Attenuation = saturate(1.0f - (length(lightDirection) / LightRadius));
+	OUT.Attenuation = saturate(1.0f - (length(lightDirection) / LightRange));
 
 	return OUT;
 }
@@ -4,8 +4,43 @@
 using namespace Library;
 using namespace Rendering;
 using namespace std;
+using namespace DirectX;
 
 void Shutdown(const wstring& className);
+vector<wstring> CommandLineArguments();
+bool TryRunShardWorker(const vector<wstring>& arguments, int& exitCode);
+int RunSnapshotServer(const vector<wstring>& arguments);
+int RunSystemBatch(const vector<wstring>& arguments);
+int RunMinorPlanetImport(const vector<wstring>& arguments);
+
+// в: ޴ڵķģʽ, ֻȾ״̬Ĺ۲ģʽ, ģϵͳģʽ, ģʽ, Сǹģʽ, ɨģʽ, ̷Ƭģģʽ, ǶۼӵĻ׼ģʽ, ׶޳Ļ׼ģʽ, ȾеĻ׼ģʽ, Ⱦ豸Ļ׼ģʽ, դĻ׼ģʽ, ԼȾ֡еģʽ
+const wstring ServerSwitch = L"--server";
+const wstring ViewerSwitch = L"--viewer";
+const wstring BatchSwitch = L"--batch-systems";
+const wstring MinorPlanetsSwitch = L"--import-minor-planets";
+
+// ÿ޴ģʽпؼ, ڵķ̵ֵ˳
+struct CommandLineMode
+{
+	const wstring* Switch;
+	int (*Run)(const vector<wstring>& arguments);
+};
+
+const CommandLineMode CommandLineModes[] =
+{
+	{ &ServerSwitch, RunSnapshotServer },
+	{ &BatchSwitch, RunSystemBatch },
+	{ &HeadlessModes::EventSearchSwitch, HeadlessModes::RunEventSearch },
+	{ &MinorPlanetsSwitch, RunMinorPlanetImport },
+	{ &HeadlessModes::ParameterSweepSwitch, HeadlessModes::RunParameterSweep },
+	{ &HeadlessModes::ShardedSimulationSwitch, HeadlessModes::RunShardedSimulation },
+	{ &HeadlessModes::AngleBenchmarkSwitch, HeadlessModes::RunAngleBenchmark },
+	{ &HeadlessModes::CullingBenchmarkSwitch, HeadlessModes::RunCullingBenchmark },
+	{ &HeadlessModes::RenderQueueBenchmarkSwitch, HeadlessModes::RunRenderQueueBenchmark },
+	{ &HeadlessModes::RenderDeviceBenchmarkSwitch, HeadlessModes::RunRenderDeviceBenchmark },
+	{ &HeadlessModes::SoftwareRasterBenchmarkSwitch, HeadlessModes::RunSoftwareRasterBenchmark },
+	{ &HeadlessModes::FrameSequenceSwitch, HeadlessModes::RunFrameSequence }
+};
 
 // ĻС
 const SIZE RenderTargetSize = { 1440, 1080 };
@@ -22,8 +57,53 @@ int WINAPI WinMain(HINSTANCE instance, HINSTANCE previousInstance, LPSTR command
 	UNREFERENCED_PARAMETER(previousInstance);
 	UNREFERENCED_PARAMETER(commandLine);
 
+	vector<wstring> arguments = CommandLineArguments();
+
+	int workerExitCode;
+	if (TryRunShardWorker(arguments, workerExitCode))
+	{
+		return workerExitCode;
+	}
+
 	SetCurrentDirectory(UtilityWin32::ExecutableDirectory().c_str());
 
+	// ɨĹûд, ʱֻ˳
+	if (arguments.size() == 2 && arguments[1] == ParameterSweep::WorkerSwitch)
+	{
+		try
+		{
+			return HeadlessModes::RunSweepWorker(arguments);
+		}
+		catch (const GameException&)
+		{
+			return 1;
+		}
+	}
+
+	// ޴ڵģʽʱϢ򱨸, Ϊп
+	const CommandLineMode* mode = nullptr;
+	if (arguments.size() > 1)
+	{
+		auto found = find_if(begin(CommandLineModes), end(CommandLineModes), [&arguments](const CommandLineMode& candidate) { return arguments[1] == *candidate.Switch; });
+		if (found != end(CommandLineModes))
+		{
+			mode = &*found;
+		}
+	}
+
+	if (mode != nullptr)
+	{
+		try
+		{
+			return mode->Run(arguments);
+		}
+		catch (const GameException& ex)
+		{
+			MessageBox(nullptr, ex.whatw().c_str(), mode->Switch->c_str(), MB_OK);
+			return 1;
+		}
+	}
+
 	ThrowIfFailed(CoInitializeEx(nullptr, COINITBASE_MULTITHREADED), "Error initializing COM.");
 
 	static const wstring windowClassName = L"RenderingClass";
@@ -42,6 +122,13 @@ int WINAPI WinMain(HINSTANCE instance, HINSTANCE previousInstance, LPSTR command
 	};
 
 	mGame = make_unique<RenderingGame>(getWindow, getRenderTargetSize);
+	if (arguments.size() > 1 && arguments[1] == ViewerSwitch)
+	{
+		// ѡĵڶΪע뾶, ֻ
+		double interestRadius = (arguments.size() > 2 ? _wtof(arguments[2].c_str()) : 0.0);
+		mGame->ConnectToServer(SnapshotTransport::DefaultAddress, interestRadius);
+	}
+
 	mGame->UpdateRenderTargetSize();
 	mGame->Initialize();
 	
@@ -62,7 +149,7 @@ int WINAPI WinMain(HINSTANCE instance, HINSTANCE previousInstance, LPSTR command
 			}
 		}
 	}
-	catch (GameException ex)
+	catch (const GameException& ex)
 	{
 		MessageBox(mWindowHandle, ex.whatw().c_str(), windowTitle.c_str(), MB_ABORTRETRYIGNORE);
 	}
@@ -78,4 +165,99 @@ void Shutdown(const wstring& className)
 {
 	//mGame->Shutdown();
 	UnregisterClass(className.c_str(), mWindow.hInstance);
+}
+
+vector<wstring> CommandLineArguments()
+{
+	vector<wstring> arguments;
+
+	int argumentCount = 0;
+	LPWSTR* argumentList = CommandLineToArgvW(GetCommandLineW(), &argumentCount);
+	if (argumentList != nullptr)
+	{
+		arguments.assign(argumentList, argumentList + argumentCount);
+		LocalFree(argumentList);
+	}
+
+	return arguments;
+}
+
+// ԷƬ̵Ĳʱ, , ֻһƬģ
+bool TryRunShardWorker(const vector<wstring>& arguments, int& exitCode)
+{
+	if (arguments.size() != 5 || arguments[1] != ShardedSimulation::WorkerSwitch)
+	{
+		return false;
+	}
+
+	try
+	{
+		exitCode = HeadlessModes::RunShardWorker(arguments);
+	}
+	catch (const GameException&)
+	{
+		exitCode = 1;
+	}
+
+	return true;
+}
+
+// ģʽ: Թ̶Ƶƽģ, ÿһ֡״̬ӵĹ۲, ֱ̱
+int RunSnapshotServer(const vector<wstring>& arguments)
+{
+	UNREFERENCED_PARAMETER(arguments);
+
+	BodyCatalog catalog(RenderingGame::BodyCatalogFileName);
+	SolarSystemSimulation simulation(catalog);
+	SnapshotServer server(catalog);
+
+	const double daysPerTick = 1.0 / (SnapshotServer::TickRate * SCALE_TIME_FOR_DAY);
+	const chrono::nanoseconds tickDuration(1000000000 / SnapshotServer::TickRate);
+	auto nextTick = chrono::steady_clock::now();
+
+	for (;;)
+	{
+		simulation.Advance(daysPerTick);
+		server.Publish(simulation);
+
+		nextTick += tickDuration;
+		this_thread::sleep_until(nextTick);
+	}
+}
+
+// ģģʽ: Ϊϵͳ, ģͽļ. һϵͳΪǱе̫ϵ, 
+int RunSystemBatch(const vector<wstring>& arguments)
+{
+	uint32_t systemCount = (arguments.size() > 2 ? wcstoul(arguments[2].c_str(), nullptr, 10) : 1024);
+	double years = (arguments.size() > 3 ? _wtof(arguments[3].c_str()) : 10.0);
+	wstring resultsFileName = (arguments.size() > 4 ? arguments[4] : L"SystemResults.bin");
+
+	BodyCatalog catalog(RenderingGame::BodyCatalogFileName);
+	vector<PlanetarySystem> systems = SystemBatchRunner::GeneratePopulation(systemCount > 0 ? systemCount - 1 : 0, 1);
+	systems.insert(systems.begin(), SystemBatchRunner::FromCatalog(catalog));
+
+	SystemBatchSettings settings;
+	settings.TimeStepDays = 0.1;
+	settings.DurationDays = years * 365.25;
+	settings.SampleInterval = 100;
+	settings.EscapeDistance = 1000.0;
+	settings.CloseEncounterDistance = 0.01;
+
+	ThreadPool threadPool;
+	SystemBatchRunner runner(threadPool, settings);
+	runner.WriteResults(resultsFileName, runner.Run(systems));
+
+	return 0;
+}
+
+// Сǵģʽ: ΪMPCORBıļͻļ. д뻺, ֮ͬıĵֱӶȡ
+int RunMinorPlanetImport(const vector<wstring>& arguments)
+{
+	wstring textFileName = (arguments.size() > 2 ? arguments[2] : RenderingGame::MinorPlanetCatalogFileName);
+	wstring cacheFileName = (arguments.size() > 3 ? arguments[3] : textFileName + L".cache");
+
+	ThreadPool threadPool;
+	MinorPlanetCatalog catalog(textFileName, cacheFileName, threadPool);
+
+	return (catalog.Count() > 0 ? 0 : 1);
 }
\ No newline at end of file
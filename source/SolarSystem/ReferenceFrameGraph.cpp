@@ -0,0 +1,122 @@
+#include "pch.h"
+
+using namespace std;
+using namespace Library;
+using namespace DirectX;
+
+namespace Rendering
+{
+	namespace
+	{
+		const uint32_t FixedFrameCount = 4;
+		const uint32_t FramesPerBody = 2;
+	}
+
+	const uint32_t ReferenceFrameGraph::SceneFrame = 0;
+	const uint32_t ReferenceFrameGraph::EclipticFrame = 1;
+	const uint32_t ReferenceFrameGraph::EquatorialFrame = 2;
+	const uint32_t ReferenceFrameGraph::CameraFrame = 3;
+	const float ReferenceFrameGraph::ObliquityJ2000 = 23.4392911f;
+
+	ReferenceFrameGraph::ReferenceFrameGraph(const BodyCatalog& catalog, const SolarSystemSimulation& simulation) :
+		mCatalog(&catalog), mSimulation(&simulation), mLightIndex(0)
+	{
+		uint32_t count = catalog.Count();
+		while (mLightIndex < count && catalog.Record(mLightIndex).HasFlag(BodyFlags::LightSource) == false)
+		{
+			++mLightIndex;
+		}
+
+		if (mLightIndex == count)
+		{
+			throw GameException("The body catalog has no light source.");
+		}
+
+		uint32_t frameCount = FixedFrameCount + count * FramesPerBody;
+		mToScene.assign(frameCount, MatrixHelper::Identity);
+		mFromScene.assign(frameCount, MatrixHelper::Identity);
+	}
+
+	void ReferenceFrameGraph::Update(const Camera& camera)
+	{
+		const float scale = static_cast<float>(SCALE_ASTRONOMICAL_UNIT);
+		const XMFLOAT3& light = mSimulation->RelativePosition(mLightIndex);
+
+		// The ecliptic pole becomes +Y and its y axis -Z, which keeps the longitudes turning the same way as the
+		// revolutions of the simulation
+		XMMATRIX eclipticToScene(scale, 0, 0, 0, 0, 0, -scale, 0, 0, scale, 0, 0, light.x, light.y, light.z, 1);
+		XMStoreFloat4x4(&mToScene[EclipticFrame], eclipticToScene);
+		XMStoreFloat4x4(&mToScene[EquatorialFrame], XMMatrixRotationX(-XMConvertToRadians(ObliquityJ2000)) * eclipticToScene);
+
+		// The camera basis is orthonormal, so its rows are the axes of the camera in the scene
+		const XMFLOAT3& right = camera.Right();
+		const XMFLOAT3& up = camera.Up();
+		const XMFLOAT3& direction = camera.Direction();
+		const XMFLOAT3& position = camera.Position();
+		mToScene[CameraFrame] = XMFLOAT4X4(right.x, right.y, right.z, 0, up.x, up.y, up.z, 0, direction.x, direction.y, direction.z, 0, position.x, position.y, position.z, 1);
+
+		uint32_t count = mCatalog->Count();
+		for (uint32_t i = 0; i < count; ++i)
+		{
+			const XMFLOAT3& bodyPosition = mSimulation->RelativePosition(i);
+			XMMATRIX inertialToScene = XMMatrixRotationZ(XMConvertToRadians(mCatalog->Record(i).AxialTilt)) * XMMatrixTranslation(bodyPosition.x, bodyPosition.y, bodyPosition.z);
+			XMStoreFloat4x4(&mToScene[BodyInertialFrame(i)], inertialToScene);
+			XMStoreFloat4x4(&mToScene[BodyFixedFrame(i)], XMMatrixRotationY(XMConvertToRadians(mSimulation->RotationDegrees(i))) * inertialToScene);
+		}
+
+		size_t frameCount = mToScene.size();
+		for (size_t i = 0; i < frameCount; ++i)
+		{
+			XMStoreFloat4x4(&mFromScene[i], XMMatrixInverse(nullptr, XMLoadFloat4x4(&mToScene[i])));
+		}
+	}
+
+	uint32_t ReferenceFrameGraph::FrameCount() const
+	{
+		return static_cast<uint32_t>(mToScene.size());
+	}
+
+	uint32_t ReferenceFrameGraph::BodyInertialFrame(uint32_t bodyIndex) const
+	{
+		assert(bodyIndex < mCatalog->Count());
+		return FixedFrameCount + bodyIndex * FramesPerBody;
+	}
+
+	uint32_t ReferenceFrameGraph::BodyFixedFrame(uint32_t bodyIndex) const
+	{
+		assert(bodyIndex < mCatalog->Count());
+		return FixedFrameCount + bodyIndex * FramesPerBody + 1;
+	}
+
+	const XMFLOAT4X4& ReferenceFrameGraph::ToScene(uint32_t frame) const
+	{
+		return mToScene[frame];
+	}
+
+	XMMATRIX ReferenceFrameGraph::Transform(uint32_t from, uint32_t to) const
+	{
+		assert(from < mToScene.size() && to < mToScene.size());
+
+		if (to == SceneFrame)
+		{
+			return XMLoadFloat4x4(&mToScene[from]);
+		}
+
+		if (from == SceneFrame)
+		{
+			return XMLoadFloat4x4(&mFromScene[to]);
+		}
+
+		return XMLoadFloat4x4(&mToScene[from]) * XMLoadFloat4x4(&mFromScene[to]);
+	}
+
+	void ReferenceFrameGraph::TransformPoints(uint32_t from, uint32_t to, const XMFLOAT3* source, XMFLOAT3* destination, uint32_t count) const
+	{
+		XMVector3TransformCoordStream(destination, sizeof(XMFLOAT3), source, sizeof(XMFLOAT3), count, Transform(from, to));
+	}
+
+	void ReferenceFrameGraph::TransformDirections(uint32_t from, uint32_t to, const XMFLOAT3* source, XMFLOAT3* destination, uint32_t count) const
+	{
+		XMVector3TransformNormalStream(destination, sizeof(XMFLOAT3), source, sizeof(XMFLOAT3), count, Transform(from, to));
+	}
+}
\ No newline at end of file
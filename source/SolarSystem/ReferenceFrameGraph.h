@@ -0,0 +1,88 @@
+#pragma once
+
+#include <vector>
+#include <cstdint>
+#include <DirectXMath.h>
+
+namespace Library
+{
+	class BodyCatalog;
+	class Camera;
+}
+
+namespace Rendering
+{
+	class SolarSystemSimulation;
+
+	/**
+	* The reference frames of the scene and the transforms between them, refreshed once per simulation tick.
+	* Each frame is held as its transform into the scene frame, the single-precision space the bodies are drawn in, and
+	* its inverse. The transform between any other two frames is composed from those on demand with a single product,
+	* so the graph holds two matrices per frame however many pairs of frames are used.
+	*
+	* Frames:
+	* - Scene: scene units relative to the floating origin, with the ecliptic in the XZ plane and its north pole on +Y.
+	* - Ecliptic: the ecliptic and equinox of J2000, in astronomical units from the light source, with the pole on +Z.
+	* - Equatorial: the mean equator and equinox of J2000, in astronomical units from the light source, with the pole on +Z.
+	* - Camera: scene units from the camera, looking down +Z with +Y up, as in its view matrix.
+	* - The inertial frame of each body: scene units from its centre, tilted by its axial tilt, with its pole on +Y.
+	* - The body-fixed frame of each body: its inertial frame turned by the rotation of the body about its pole.
+	*/
+	class ReferenceFrameGraph final
+	{
+	public:
+		ReferenceFrameGraph(const Library::BodyCatalog& catalog, const SolarSystemSimulation& simulation);
+		ReferenceFrameGraph(const ReferenceFrameGraph&) = delete;
+		ReferenceFrameGraph& operator=(const ReferenceFrameGraph&) = delete;
+		ReferenceFrameGraph(ReferenceFrameGraph&&) = delete;
+		ReferenceFrameGraph& operator=(ReferenceFrameGraph&&) = delete;
+		~ReferenceFrameGraph() = default;
+
+		/**
+		* Recompute every frame from the current state of the simulation and the camera.
+		* Call once per tick, after the simulation has been rebased to the floating origin.
+		*/
+		void Update(const Library::Camera& camera);
+
+		std::uint32_t FrameCount() const;
+		std::uint32_t BodyInertialFrame(std::uint32_t bodyIndex) const;
+		std::uint32_t BodyFixedFrame(std::uint32_t bodyIndex) const;
+
+		/**
+		* Get the transform from a frame into the scene frame, for row vectors as used by DirectXMath.
+		*/
+		const DirectX::XMFLOAT4X4& ToScene(std::uint32_t frame) const;
+		/**
+		* Get the transform between two frames, composed through the scene frame.
+		*/
+		DirectX::XMMATRIX Transform(std::uint32_t from, std::uint32_t to) const;
+
+		/**
+		* Convert an array of points between two frames.
+		* @param source The points in the frame they are converted from.
+		* @param destination Receives the points in the frame they are converted to.
+		*/
+		void TransformPoints(std::uint32_t from, std::uint32_t to, const DirectX::XMFLOAT3* source, DirectX::XMFLOAT3* destination, std::uint32_t count) const;
+		/**
+		* Convert an array of directions between two frames. Directions are turned and scaled but not moved.
+		*/
+		void TransformDirections(std::uint32_t from, std::uint32_t to, const DirectX::XMFLOAT3* source, DirectX::XMFLOAT3* destination, std::uint32_t count) const;
+
+		static const std::uint32_t SceneFrame;
+		static const std::uint32_t EclipticFrame;
+		static const std::uint32_t EquatorialFrame;
+		static const std::uint32_t CameraFrame;
+		/**
+		* The obliquity of the ecliptic at J2000, in degrees.
+		*/
+		static const float ObliquityJ2000;
+
+	private:
+		const Library::BodyCatalog* mCatalog;
+		const SolarSystemSimulation* mSimulation;
+		std::uint32_t mLightIndex;
+
+		std::vector<DirectX::XMFLOAT4X4> mToScene;
+		std::vector<DirectX::XMFLOAT4X4> mFromScene;
+	};
+}
\ No newline at end of file
@@ -8,10 +8,66 @@ using namespace Library;
 namespace Rendering
 {
 	const XMVECTORF32 RenderingGame::BackgroundColor = Colors::Black;
+	const uint32_t RenderingGame::FrameConstantBufferSize = 1024 * 1024;
+	const wstring RenderingGame::BodyCatalogFileName = L"Content\\Catalogs\\SolarSystem.csv.bin";
+	const wstring RenderingGame::SatelliteCatalogFileName = L"Content\\Catalogs\\Satellites.tle";
+	const wstring RenderingGame::MinorPlanetCatalogFileName = L"Content\\Catalogs\\MPCORB.DAT";
+	const wstring RenderingGame::PlanetaryTheoryFileName = L"Content\\Catalogs\\Vsop87.bin";
+
+	namespace
+	{
+		/**
+		* The astronomical objects of the catalog, constructed one after another in a single allocation. The components
+		* hold aliasing pointers sharing ownership of the block, which destroys the objects once the last is released.
+		*/
+		class AstronomicalObjectBlock final
+		{
+		public:
+			explicit AstronomicalObjectBlock(uint32_t capacity) :
+				mObjects(allocator<AstronomicalObject>().allocate(capacity)), mCapacity(capacity), mCount(0)
+			{
+			}
+
+			AstronomicalObjectBlock(const AstronomicalObjectBlock&) = delete;
+			AstronomicalObjectBlock& operator=(const AstronomicalObjectBlock&) = delete;
+			AstronomicalObjectBlock(AstronomicalObjectBlock&&) = delete;
+			AstronomicalObjectBlock& operator=(AstronomicalObjectBlock&&) = delete;
+
+			~AstronomicalObjectBlock()
+			{
+				while (mCount > 0)
+				{
+					mObjects[--mCount].~AstronomicalObject();
+				}
+
+				allocator<AstronomicalObject>().deallocate(mObjects, mCapacity);
+			}
+
+			template <typename... Arguments>
+			AstronomicalObject& Emplace(Arguments&&... arguments)
+			{
+				assert(mCount < mCapacity);
+				AstronomicalObject* object = new (mObjects + mCount) AstronomicalObject(forward<Arguments>(arguments)...);
+				++mCount;
+				return *object;
+			}
+
+		private:
+			AstronomicalObject* mObjects;
+			uint32_t mCapacity;
+			uint32_t mCount;
+		};
+	}
 	
 	RenderingGame::RenderingGame(std::function<void*()> getWindowCallback, std::function<void(SIZE&)> getRenderTargetSizeCallback) :
-		Game(getWindowCallback, getRenderTargetSizeCallback), mRenderStateHelper(*this)
+		Game(getWindowCallback, getRenderTargetSizeCallback), mInterestRadius(0.0), mLightIndex(0)
+	{
+	}
+
+	void RenderingGame::ConnectToServer(const wstring& pipeName, double interestRadius)
 	{
+		mServerPipeName = pipeName;
+		mInterestRadius = interestRadius;
 	}
 
 	// гʼ
@@ -46,55 +102,128 @@ namespace Rendering
 		mComponents.push_back(mCamera);
 		mServices.AddService(Camera::TypeIdClass(), mCamera.get());
 
-		mSun = make_shared<AstronomicalObject>(*this, mCamera, Rendering::AstronomicalObjectName::Sun);
-		const Library::PointLight& pointLight = mSun->GetLight();
-		mComponents.push_back(mSun);
+		mModelCache = make_unique<ModelCache>();
+		mServices.AddService(ModelCache::TypeIdClass(), mModelCache.get());
+
+		mRenderQueue = make_unique<RenderQueue>();
+		mServices.AddService(RenderQueue::TypeIdClass(), mRenderQueue.get());
 
-		mMercury = make_shared<AstronomicalObject>(*this, mCamera, Rendering::AstronomicalObjectName::Mercury);
-		mMercury->SetLight(pointLight);
-		mComponents.push_back(mMercury);
+		mRenderDevice = make_unique<D3D11RenderDevice>(*this);
+		mServices.AddService(D3D11RenderDevice::TypeIdClass(), mRenderDevice.get());
 
-		mVenus = make_shared<AstronomicalObject>(*this, mCamera, Rendering::AstronomicalObjectName::Venus);
-		mVenus->SetLight(pointLight);
-		mComponents.push_back(mVenus);
+		mRenderBackend = make_unique<DeviceRenderBackend>(*mRenderDevice);
+		mServices.AddService(DeviceRenderBackend::TypeIdClass(), mRenderBackend.get());
 
-		mEarth = make_shared<AstronomicalObject>(*this, mCamera, Rendering::AstronomicalObjectName::Earth);
-		mEarth->SetLight(pointLight);
-		mComponents.push_back(mEarth);
+		auto constantStorage = make_unique<DeviceConstantBufferStorage>(*mRenderDevice, FrameConstantBufferSize);
+		mServices.AddService(DeviceConstantBufferStorage::TypeIdClass(), constantStorage.get());
+		mFrameConstants = make_unique<FrameConstantAllocator>(move(constantStorage));
+		mServices.AddService(FrameConstantAllocator::TypeIdClass(), mFrameConstants.get());
 
-		mMoon = make_shared<AstronomicalObject>(*this, mCamera, Rendering::AstronomicalObjectName::Moon);
-		mMoon->SetLight(pointLight);
-		mMoon->SetParentObject(*mEarth);
-		mComponents.push_back(mMoon);
+		mThreadPool = make_unique<ThreadPool>();
+		mTextureCache = make_unique<TextureCache>(*mThreadPool, WicImageDecoder::Decode);
+		mServices.AddService(TextureCache::TypeIdClass(), mTextureCache.get());
 
-		mMars = make_shared<AstronomicalObject>(*this, mCamera, Rendering::AstronomicalObjectName::Mars);
-		mMars->SetLight(pointLight);
-		mComponents.push_back(mMars);
+		// Create the astronomical objects from the body catalog
+		mBodyCatalog = make_unique<BodyCatalog>(BodyCatalogFileName);
+		mSimulation = make_unique<SolarSystemSimulation>(*mBodyCatalog);
+		if (GetFileAttributes(PlanetaryTheoryFileName.c_str()) != INVALID_FILE_ATTRIBUTES)
+		{
+			// Each term below a tenth of a microradian moves even Neptune by less than a thousandth of a scene unit
+			mPlanetaryTheory = make_unique<Vsop87Theory>(PlanetaryTheoryFileName);
+			mPlanetaryTheory->SetTruncation(1.0e-7);
+			mSimulation->SetPlanetaryTheory(*mPlanetaryTheory);
+		}
 
-		mJupiter = make_shared<AstronomicalObject>(*this, mCamera, Rendering::AstronomicalObjectName::Jupiter);
-		mJupiter->SetLight(pointLight);
-		mComponents.push_back(mJupiter);
+		mReferenceFrames = make_unique<ReferenceFrameGraph>(*mBodyCatalog, *mSimulation);
+		mGravityField = make_unique<GravityFieldSampler>(*mBodyCatalog, *mSimulation, *mThreadPool, GravityFieldSampler::DefaultSettings());
 
-		mSaturn = make_shared<AstronomicalObject>(*this, mCamera, Rendering::AstronomicalObjectName::Saturn);
-		mSaturn->SetLight(pointLight);
-		mComponents.push_back(mSaturn);
+		uint32_t bodyCount = mBodyCatalog->Count();
+		if (mServerPipeName.empty() == false)
+		{
+			mSnapshotClient = make_unique<SnapshotClient>(bodyCount, mServerPipeName);
+		}
 
-		mUranus = make_shared<AstronomicalObject>(*this, mCamera, Rendering::AstronomicalObjectName::Uranus);
-		mUranus->SetLight(pointLight);
-		mComponents.push_back(mUranus);
+		// The renderer precedes the objects among the components, so it is initialized before they ask for their mesh radii
+		mPlanetRenderer = make_shared<PlanetRenderer>(*this, mCamera);
+		mComponents.push_back(mPlanetRenderer);
 
-		mNeptune = make_shared<AstronomicalObject>(*this, mCamera, Rendering::AstronomicalObjectName::Neptune);
-		mNeptune->SetLight(pointLight);
-		mComponents.push_back(mNeptune);
+		const BodyCatalogRecord* records = mBodyCatalog->Records();
+		auto astronomicalObjectBlock = make_shared<AstronomicalObjectBlock>(bodyCount);
+		mAstronomicalObjects.reserve(bodyCount);
+		mComponents.reserve(mComponents.size() + bodyCount);
 
-		mPluto = make_shared<AstronomicalObject>(*this, mCamera, Rendering::AstronomicalObjectName::Pluto);
-		mPluto->SetLight(pointLight);
-		mComponents.push_back(mPluto);
+		const PointLight* pointLight = nullptr;
+		for (uint32_t i = 0; i < bodyCount; ++i)
+		{
+			shared_ptr<AstronomicalObject> astronomicalObject(astronomicalObjectBlock, &astronomicalObjectBlock->Emplace(*this, mCamera, *mBodyCatalog, i, *mReferenceFrames, *mPlanetRenderer));
+			if (records[i].HasFlag(BodyFlags::LightSource))
+			{
+				pointLight = &astronomicalObject->GetLight();
+				mLightIndex = i;
+			}
+
+			if (records[i].ParentIndex >= 0)
+			{
+				astronomicalObject->SetParentObject(*mAstronomicalObjects[records[i].ParentIndex]);
+			}
+
+			mAstronomicalObjects.push_back(astronomicalObject);
+			mComponents.push_back(astronomicalObject);
+		}
+
+		if (pointLight == nullptr)
+		{
+			throw GameException("The body catalog has no light source.");
+		}
+
+		for (uint32_t i = 0; i < bodyCount; ++i)
+		{
+			if (!records[i].HasFlag(BodyFlags::LightSource))
+			{
+				mAstronomicalObjects[i]->SetLight(*pointLight);
+			}
+		}
+		mPlanetRenderer->SetLight(*pointLight);
+
+		// Attach the satellites to the Earth when their element sets are present; the layer follows the Earth among the components so the Earth is initialized first
+		int32_t earthIndex = mBodyCatalog->IndexOf("Earth");
+		if (earthIndex >= 0 && GetFileAttributes(SatelliteCatalogFileName.c_str()) != INVALID_FILE_ATTRIBUTES)
+		{
+			mSatelliteLayer = make_shared<SatelliteLayer>(*this, mCamera, *mBodyCatalog, *mSimulation, *mReferenceFrames, SatelliteCatalogFileName, *mThreadPool);
+			mSatelliteLayer->SetParentObject(*mAstronomicalObjects[earthIndex]);
+			mComponents.push_back(mSatelliteLayer);
+		}
+
+		// Draw the minor planets when their catalog is present, reading the cache written beside it by an import when the text is unchanged
+		if (GetFileAttributes(MinorPlanetCatalogFileName.c_str()) != INVALID_FILE_ATTRIBUTES)
+		{
+			mMinorPlanets = make_unique<MinorPlanetCatalog>(MinorPlanetCatalogFileName, MinorPlanetCatalogFileName + L".cache", *mThreadPool);
+			mMinorPlanetLayer = make_shared<MinorPlanetLayer>(*this, mCamera, *mBodyCatalog, *mSimulation, *mMinorPlanets, *mThreadPool);
+			mComponents.push_back(mMinorPlanetLayer);
+		}
+
+		mGravityWellLayer = make_shared<GravityWellLayer>(*this, mCamera, *mGravityField, *mSimulation);
+		mComponents.push_back(mGravityWellLayer);
 
 		Game::Initialize();
 
-		mFpsComponent = make_shared<FpsComponent>(*this);
-		mFpsComponent->Initialize();
+		// The radii of the objects are known once their models are loaded
+		mShadowOccluderPass = make_unique<ShadowOccluderPass>();
+		mShadowPositions.resize(bodyCount);
+		mShadowRadii.resize(bodyCount);
+		mShadowReceivers.resize(bodyCount);
+		for (uint32_t i = 0; i < bodyCount; ++i)
+		{
+			mShadowRadii[i] = mAstronomicalObjects[i]->Radius();
+			mAstronomicalObjects[i]->SetShadowOccluders(*mShadowOccluderPass);
+		}
+
+		// All text is drawn by one overlay after the components; the help never changes, so it is laid out once
+		mTextOverlay = make_shared<TextOverlay>(*this);
+		mTextOverlay->AddText(XMFLOAT2(0.0f, 40.0f), L"WASD for camera displacement\nMouse for camera direction\nPress Esc to quit\n");
+		mTextOverlay->Initialize();
+
+		mFpsComponent = make_shared<FpsComponent>(*this, *mTextOverlay);
 
 		// ͼ
 		if (directionMode == 1)
@@ -109,6 +238,8 @@ namespace Rendering
 			mCamera->ApplyRotation(matrix);
 		}
 		mCamera->SetPosition(sCameraPosition.x, sCameraPosition.y, sCameraPosition.z);
+		mSimulation->UpdateOrigin(*mCamera);
+		mReferenceFrames->Update(*mCamera);
 	}
 
 	void RenderingGame::Update(const GameTime &gameTime)
@@ -121,6 +252,48 @@ namespace Rendering
 			Exit();
 		}
 
+		if (mKeyboard->WasKeyPressedThisFrame(Keys::Space))
+		{
+			mSimulation->SetPaused(!mSimulation->Paused());
+		}
+
+		// Advance the simulation, or take the state published by the server, then rebase it to the camera before any component consumes the positions
+		if (mSnapshotClient != nullptr)
+		{
+			const DoubleVector3& origin = mSimulation->Origin();
+			const XMFLOAT3& cameraPosition = mCamera->Position();
+			DoubleVector3 worldCameraPosition(origin.x + cameraPosition.x, origin.y + cameraPosition.y, origin.z + cameraPosition.z);
+			if (mSnapshotClient->Update(*mSimulation, worldCameraPosition, mInterestRadius) == false)
+			{
+				throw GameException("Lost the connection to the snapshot server.");
+			}
+
+			uint32_t bodyCount = static_cast<uint32_t>(mAstronomicalObjects.size());
+			for (uint32_t i = 0; i < bodyCount; ++i)
+			{
+				mAstronomicalObjects[i]->SetVisible(mSnapshotClient->Visible(i));
+			}
+		}
+		else
+		{
+			mSimulation->Update(gameTime);
+		}
+
+		mSimulation->UpdateOrigin(*mCamera);
+		mReferenceFrames->Update(*mCamera);
+
+		// Find the shadow casters of every visible body from the rebased positions
+		uint32_t bodyCount = static_cast<uint32_t>(mAstronomicalObjects.size());
+		for (uint32_t i = 0; i < bodyCount; ++i)
+		{
+			mShadowPositions[i] = mSimulation->RelativePosition(i);
+			mShadowReceivers[i] = (mAstronomicalObjects[i]->Visible() ? 1 : 0);
+		}
+		mShadowOccluderPass->Update(mShadowPositions.data(), mShadowRadii.data(), mShadowReceivers.data(), bodyCount, mLightIndex);
+
+		// The wells layer reads the tiles resampled here when the components update
+		mGravityField->Update();
+
 		Game::Update(gameTime);
 	}
 
@@ -129,11 +302,15 @@ namespace Rendering
 		mDirect3DDeviceContext->ClearRenderTargetView(mRenderTargetView.Get(), reinterpret_cast<const float*>(&BackgroundColor));
 		mDirect3DDeviceContext->ClearDepthStencilView(mDepthStencilView.Get(), D3D11_CLEAR_DEPTH | D3D11_CLEAR_STENCIL, 1.0f, 0);
 
+		// The components write their constants and submit their draws, which are then issued grouped by pass, shader and texture
+		mFrameConstants->BeginFrame();
+		mRenderQueue->Clear();
 		Game::Draw(gameTime);
+		mFrameConstants->Flush();
+		mRenderQueue->Sort();
+		mRenderQueue->Execute(*mRenderBackend);
 
-		mRenderStateHelper.SaveAll();
-		mFpsComponent->Draw(gameTime);
-		mRenderStateHelper.RestoreAll();
+		mTextOverlay->Draw(gameTime);
 
 		HRESULT hr = mSwapChain->Present(1, 0);
 
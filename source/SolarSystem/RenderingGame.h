@@ -2,7 +2,6 @@
 #pragma once
 
 #include "Game.h"
-#include "RenderStateHelper.h"
 #include <windows.h>
 #include <functional>
 
@@ -11,12 +10,32 @@ namespace Library
 	class KeyboardComponent;
 	class MouseComponent;
 	class FpsComponent;
+	class TextOverlay;
 	class Camera;
+	class BodyCatalog;
+	class ThreadPool;
+	class Vsop87Theory;
+	class ModelCache;
+	class TextureCache;
+	class MinorPlanetCatalog;
+	class RenderQueue;
+	class D3D11RenderDevice;
+	class DeviceRenderBackend;
+	class FrameConstantAllocator;
 }
 
 namespace Rendering
 {
 	class AstronomicalObject;
+	class SolarSystemSimulation;
+	class ReferenceFrameGraph;
+	class SnapshotClient;
+	class ShadowOccluderPass;
+	class SatelliteLayer;
+	class GravityFieldSampler;
+	class GravityWellLayer;
+	class MinorPlanetLayer;
+	class PlanetRenderer;
 
 	class RenderingGame final : public Library::Game
 	{
@@ -29,30 +48,105 @@ namespace Rendering
 		virtual void Shutdown() override;
 
 		void Exit();
+		/**
+		* Render the state published by a snapshot server instead of running the simulation. Call before Initialize().
+		* @param pipeName The pipe the server listens on.
+		* @param interestRadius The distance from the camera, in scene units, within which bodies are wanted. Zero for every body.
+		*/
+		void ConnectToServer(const std::wstring& pipeName, double interestRadius);
+
+		static const std::wstring BodyCatalogFileName;
+		static const std::wstring SatelliteCatalogFileName;
+		static const std::wstring MinorPlanetCatalogFileName;
+		static const std::wstring PlanetaryTheoryFileName;
 
 	private:
 		static const DirectX::XMVECTORF32 BackgroundColor;
+		static const std::uint32_t FrameConstantBufferSize;
 
-		Library::RenderStateHelper mRenderStateHelper;
 		std::shared_ptr<Library::KeyboardComponent> mKeyboard;
 		std::shared_ptr<Library::MouseComponent> mMouse;
 		std::shared_ptr<Library::FpsComponent> mFpsComponent;
+		std::shared_ptr<Library::TextOverlay> mTextOverlay;
 		std::shared_ptr<Library::Camera> mCamera;
+		/**
+		* The models shared by every component drawing them, offered to the components as a service.
+		*/
+		std::unique_ptr<Library::ModelCache> mModelCache;
+		/**
+		* The queue the components submit their draws to, executed in the order of their state once every component has drawn.
+		*/
+		std::unique_ptr<Library::RenderQueue> mRenderQueue;
+		/**
+		* The device the render queue and its components create their resources on and draw through.
+		*/
+		std::unique_ptr<Library::D3D11RenderDevice> mRenderDevice;
+		std::unique_ptr<Library::DeviceRenderBackend> mRenderBackend;
+		/**
+		* The allocator every component writes its constants of the frame through, into one buffer mapped once per frame.
+		*/
+		std::unique_ptr<Library::FrameConstantAllocator> mFrameConstants;
 		
 		/**
-		* Astronomical objects cooresponding to those in the solar system.
-		*/
-		std::shared_ptr<AstronomicalObject> mSun; //̫
-		std::shared_ptr<AstronomicalObject> mMercury; //ˮ
-		std::shared_ptr<AstronomicalObject> mVenus; //
-		std::shared_ptr<AstronomicalObject> mEarth; //
-		std::shared_ptr<AstronomicalObject> mMoon; //
-		std::shared_ptr<AstronomicalObject> mMars; //
-		std::shared_ptr<AstronomicalObject> mJupiter; //ľ
-		std::shared_ptr<AstronomicalObject> mSaturn; //
-		std::shared_ptr<AstronomicalObject> mUranus; //
-		std::shared_ptr<AstronomicalObject> mNeptune; //
-		std::shared_ptr<AstronomicalObject> mPluto; //ڤ
+		* The catalog of bodies in the solar system.
+		*/
+		std::unique_ptr<Library::BodyCatalog> mBodyCatalog;
+		/**
+		* The VSOP87 theory placing the planets, present when its compiled tables are.
+		*/
+		std::unique_ptr<Library::Vsop87Theory> mPlanetaryTheory;
+		/**
+		* The double-precision simulation of the bodies in the catalog.
+		*/
+		std::unique_ptr<SolarSystemSimulation> mSimulation;
+		/**
+		* The reference frames of the scene, refreshed once the simulation is rebased each frame.
+		*/
+		std::unique_ptr<ReferenceFrameGraph> mReferenceFrames;
+		/**
+		* The renderer drawing every astronomical object with one instanced draw per mesh.
+		*/
+		std::shared_ptr<PlanetRenderer> mPlanetRenderer;
+		/**
+		* Astronomical objects cooresponding to those in the body catalog, in catalog order, all constructed in one block.
+		*/
+		std::vector<std::shared_ptr<AstronomicalObject>> mAstronomicalObjects;
+		/**
+		* The connection to a snapshot server when running as a viewer.
+		*/
+		std::unique_ptr<SnapshotClient> mSnapshotClient;
+		std::wstring mServerPipeName;
+		double mInterestRadius;
+		/**
+		* The pass finding the bodies that shadow each visible body, and the per-frame inputs it reads.
+		*/
+		std::unique_ptr<ShadowOccluderPass> mShadowOccluderPass;
+		std::vector<DirectX::XMFLOAT3> mShadowPositions;
+		std::vector<float> mShadowRadii;
+		std::vector<std::uint8_t> mShadowReceivers;
+		std::uint32_t mLightIndex;
+		/**
+		* The pool shared by the work split across cores each frame.
+		*/
+		std::unique_ptr<Library::ThreadPool> mThreadPool;
+		/**
+		* The textures shared by every component drawing them, decoded on the pool and offered as a service.
+		*/
+		std::unique_ptr<Library::TextureCache> mTextureCache;
+		/**
+		* The satellites of the Earth, present when their element sets are.
+		*/
+		std::shared_ptr<SatelliteLayer> mSatelliteLayer;
+		/**
+		* The potential of the bodies sampled on the plane of the ecliptic, resampled each frame where they have moved, and the layer drawing its wells.
+		*/
+		std::unique_ptr<GravityFieldSampler> mGravityField;
+		std::shared_ptr<GravityWellLayer> mGravityWellLayer;
+		/**
+		* The minor planets around the light source, present when their catalog is.
+		*/
+		std::unique_ptr<Library::MinorPlanetCatalog> mMinorPlanets;
+		std::shared_ptr<MinorPlanetLayer> mMinorPlanetLayer;
 
 	public:
 		/**
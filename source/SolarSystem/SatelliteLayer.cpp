@@ -0,0 +1,138 @@
+#include "pch.h"
+
+using namespace std;
+using namespace Library;
+using namespace DirectX;
+
+namespace Rendering
+{
+	RTTI_DEFINITIONS(SatelliteLayer)
+
+	SatelliteLayer::SatelliteLayer(Game& game, const shared_ptr<Camera>& camera, const BodyCatalog& catalog, const SolarSystemSimulation& simulation,
+		const ReferenceFrameGraph& referenceFrames, const wstring& filename, ThreadPool& threadPool) :
+		DrawableGameComponent(game, camera), mCatalog(&catalog), mSimulation(&simulation), mReferenceFrames(&referenceFrames), mThreadPool(&threadPool), mParent(nullptr),
+		mPropagator(make_unique<SatellitePropagator>(filename)), mVertexBufferDirty(false),
+		mPropagatedDays(numeric_limits<double>::quiet_NaN()), mWorldMatrix(MatrixHelper::Identity),
+		mDevice(nullptr), mConstantStorage(nullptr), mShader(0), mVertexBuffer(RenderDevice::NullHandle), mPerObjectConstants()
+	{
+	}
+
+	void SatelliteLayer::Initialize()
+	{
+		if (mParent == nullptr || mCatalog->Record(mParent->CatalogIndex()).Radius <= 0.0f)
+		{
+			throw GameException("The satellites have no parent body with a radius.");
+		}
+
+		DeviceRenderBackend* renderBackend = (DeviceRenderBackend*)mGame->Services().GetService(DeviceRenderBackend::TypeIdClass());
+		assert(renderBackend != nullptr);
+		mDevice = &renderBackend->Device();
+
+		mConstantStorage = (DeviceConstantBufferStorage*)mGame->Services().GetService(DeviceConstantBufferStorage::TypeIdClass());
+		assert(mConstantStorage != nullptr);
+
+		// Load the compiled shaders
+		vector<char> compiledVertexShader;
+		Utility::LoadBinaryFile(L"Content\\Shaders\\SatelliteVS.cso", compiledVertexShader);
+		vector<char> compiledPixelShader;
+		Utility::LoadBinaryFile(L"Content\\Shaders\\SatellitePS.cso", compiledPixelShader);
+
+		const RenderDevice::VertexElement vertexElements[] =
+		{
+			{ "POSITION", 0, RenderDevice::VertexFormat::Float3 }
+		};
+
+		mShader = renderBackend->AddShader(mDevice->CreateShader(&compiledVertexShader[0], compiledVertexShader.size(), &compiledPixelShader[0], compiledPixelShader.size(), vertexElements, ARRAYSIZE(vertexElements)));
+
+		// The vertex buffer holds every satellite and is rewritten whenever they are propagated
+		mVertexBuffer = mDevice->CreateBuffer({ RenderDevice::BufferType::Vertex, true, static_cast<uint32_t>(sizeof(XMFLOAT3)) * max(mPropagator->Count(), 1U), 0 }, nullptr);
+		mVertices.reserve(mPropagator->Count());
+	}
+
+	void SatelliteLayer::Update(const GameTime& gameTime)
+	{
+		UNREFERENCED_PARAMETER(gameTime);
+
+		// Propagate only when the simulation has advanced, such as not while it is paused
+		double days = mSimulation->ElapsedDays();
+		if (days != mPropagatedDays)
+		{
+			mPropagator->Propagate(days, *mThreadPool);
+			mPropagatedDays = days;
+
+			uint32_t count = mPropagator->Count();
+			const XMFLOAT3* positions = mPropagator->Positions();
+			const uint8_t* validFlags = mPropagator->ValidFlags();
+			mVertices.clear();
+			for (uint32_t i = 0; i < count; ++i)
+			{
+				if (validFlags[i] != 0)
+				{
+					mVertices.push_back(positions[i]);
+				}
+			}
+			mVertexBufferDirty = true;
+		}
+
+		// The frame of the parent moves with the floating origin every frame, propagated or not
+		uint32_t parentIndex = mParent->CatalogIndex();
+		float scale = mParent->Radius() / mCatalog->Record(parentIndex).Radius;
+		XMMATRIX transformation = XMMatrixScaling(scale, scale, scale);
+		// The element sets put the north pole on z; the inertial frame of the parent has it on y
+		transformation *= XMMATRIX(1, 0, 0, 0, 0, 0, 1, 0, 0, 1, 0, 0, 0, 0, 0, 1);
+		transformation *= XMLoadFloat4x4(&mReferenceFrames->ToScene(mReferenceFrames->BodyInertialFrame(parentIndex)));
+		XMStoreFloat4x4(&mWorldMatrix, transformation);
+	}
+
+	void SatelliteLayer::Draw(const GameTime& gameTime)
+	{
+		UNREFERENCED_PARAMETER(gameTime);
+		assert(mCamera != nullptr);
+
+		if (mVertices.empty())
+		{
+			return;
+		}
+
+		if (mVertexBufferDirty)
+		{
+			uint32_t size = static_cast<uint32_t>(sizeof(XMFLOAT3) * mVertices.size());
+			memcpy(mDevice->Map(mVertexBuffer, true), mVertices.data(), size);
+			mDevice->Unmap(mVertexBuffer, size);
+			mVertexBufferDirty = false;
+		}
+
+		FrameConstantAllocator* frameConstants = (FrameConstantAllocator*)mGame->Services().GetService(FrameConstantAllocator::TypeIdClass());
+		assert(frameConstants != nullptr);
+
+		VSCBufferPerObject perObject;
+		XMMATRIX wvp = XMLoadFloat4x4(&mWorldMatrix) * mCamera->ViewProjectionMatrix();
+		XMStoreFloat4x4(&perObject.WorldViewProjection, XMMatrixTranspose(wvp));
+		mPerObjectConstants = frameConstants->Upload(perObject);
+
+		RenderQueue* renderQueue = (RenderQueue*)mGame->Services().GetService(RenderQueue::TypeIdClass());
+		assert(renderQueue != nullptr);
+		renderQueue->Submit(RenderQueue::MakeKey(DeviceRenderBackend::DefaultPass, mShader, RenderQueue::NoTexture, 0.0f), *this, 0);
+	}
+
+	void SatelliteLayer::ExecuteDraw(uint32_t command)
+	{
+		UNREFERENCED_PARAMETER(command);
+
+		mDevice->SetPrimitiveTopology(RenderDevice::PrimitiveTopology::PointList);
+		mDevice->SetVertexBuffer(mVertexBuffer, sizeof(XMFLOAT3));
+		mConstantStorage->SetConstantBuffer(RenderDevice::ShaderStage::Vertex, 0, mPerObjectConstants);
+
+		mDevice->Draw(static_cast<uint32_t>(mVertices.size()), 0);
+	}
+
+	void SatelliteLayer::SetParentObject(const AstronomicalObject& parent)
+	{
+		mParent = &parent;
+	}
+
+	uint32_t SatelliteLayer::VisibleCount() const
+	{
+		return static_cast<uint32_t>(mVertices.size());
+	}
+}
\ No newline at end of file
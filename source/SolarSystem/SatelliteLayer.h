@@ -0,0 +1,88 @@
+#pragma once
+
+#include "DrawableGameComponent.h"
+#include "RenderQueue.h"
+#include "FrameConstantAllocator.h"
+#include <DirectXMath.h>
+
+namespace Library
+{
+	class BodyCatalog;
+	class ThreadPool;
+	class RenderDevice;
+	class DeviceConstantBufferStorage;
+}
+
+namespace Rendering
+{
+	class AstronomicalObject;
+	class SolarSystemSimulation;
+	class ReferenceFrameGraph;
+	class SatellitePropagator;
+
+	/**
+	* Draws the satellites of a body as points, propagated each frame from their element sets to the time of the simulation.
+	* The satellites are children of their parent body: their positions are kept relative to it, in kilometres, and
+	* carried into the scene by the drawn radius and the inertial frame of the parent.
+	*/
+	class SatelliteLayer final : public Library::DrawableGameComponent, public Library::RenderQueueClient
+	{
+		RTTI_DECLARATIONS(SatelliteLayer, Library::DrawableGameComponent)
+
+	public:
+		/**
+		* @param referenceFrames The frames holding the inertial frame of the parent body.
+		* @param filename The file of two-line element sets of the satellites.
+		* @param threadPool The pool the propagation is split across.
+		*/
+		SatelliteLayer(Library::Game& game, const std::shared_ptr<Library::Camera>& camera, const Library::BodyCatalog& catalog, const SolarSystemSimulation& simulation,
+			const ReferenceFrameGraph& referenceFrames, const std::wstring& filename, Library::ThreadPool& threadPool);
+		SatelliteLayer(const SatelliteLayer&) = delete;
+		SatelliteLayer& operator=(const SatelliteLayer&) = delete;
+		SatelliteLayer(SatelliteLayer&&) = delete;
+		SatelliteLayer& operator=(SatelliteLayer&&) = delete;
+		~SatelliteLayer() = default;
+
+		virtual void Initialize() override;
+		virtual void Update(const Library::GameTime& gameTime) override;
+		virtual void Draw(const Library::GameTime& gameTime) override;
+		virtual void ExecuteDraw(std::uint32_t command) override;
+
+		/**
+		* Set the body the satellites orbit. Call before Initialize().
+		* @param parent A reference to the parent astronomical object, which must be initialized before this layer.
+		*/
+		void SetParentObject(const AstronomicalObject& parent);
+		/**
+		* Get the number of satellites drawn in the current frame.
+		*/
+		std::uint32_t VisibleCount() const;
+
+	private:
+		struct VSCBufferPerObject
+		{
+			DirectX::XMFLOAT4X4 WorldViewProjection;
+		};
+
+		const Library::BodyCatalog* mCatalog;
+		const SolarSystemSimulation* mSimulation;
+		const ReferenceFrameGraph* mReferenceFrames;
+		Library::ThreadPool* mThreadPool;
+		const AstronomicalObject* mParent;
+		std::unique_ptr<SatellitePropagator> mPropagator;
+
+		/**
+		* The positions of the valid satellites relative to the parent, compacted for the vertex buffer.
+		*/
+		std::vector<DirectX::XMFLOAT3> mVertices;
+		bool mVertexBufferDirty;
+		double mPropagatedDays;
+		DirectX::XMFLOAT4X4 mWorldMatrix;
+
+		Library::RenderDevice* mDevice;
+		Library::DeviceConstantBufferStorage* mConstantStorage;
+		std::uint32_t mShader;
+		std::uint32_t mVertexBuffer;
+		Library::FrameConstantAllocator::Allocation mPerObjectConstants;
+	};
+}
\ No newline at end of file
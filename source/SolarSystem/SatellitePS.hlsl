@@ -0,0 +1,11 @@
+static const float4 SatelliteColor = float4(0.9f, 0.85f, 0.6f, 1.0f);
+
+struct VS_OUTPUT
+{
+	float4 Position: SV_Position;
+};
+
+float4 main(VS_OUTPUT IN) : SV_Target
+{
+	return SatelliteColor;
+}
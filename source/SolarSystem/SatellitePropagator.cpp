@@ -0,0 +1,527 @@
+#include "pch.h"
+
+using namespace std;
+using namespace Library;
+using namespace DirectX;
+
+namespace Rendering
+{
+	namespace
+	{
+		const uint32_t Lanes = 8;
+		const uint32_t BlocksPerTask = 128;
+		const uint32_t MaxKeplerIterations = 10;
+
+		const double Pi = 3.14159265358979323846;
+		const double TwoPi = 2.0 * Pi;
+		const double DegreesToRadians = Pi / 180.0;
+		const double MinutesPerDay = 1440.0;
+
+		// WGS-72, as used to fit the element sets
+		const double EarthRadius = 6378.135;							// Kilometres
+		const double EarthGravitationalParameter = 398600.8;			// Cubic kilometres per second squared
+		const double J2 = 0.001082616;
+		const double J3 = -0.00000253881;
+		const double J4 = -0.00000165597;
+		const double J3OverJ2 = J3 / J2;
+		const double TwoThirds = 2.0 / 3.0;
+		const double DeepSpacePeriodMinutes = 225.0;
+		const double Xke = 60.0 / sqrt(EarthRadius * EarthRadius * EarthRadius / EarthGravitationalParameter);
+
+		/**
+		* Recover the Brouwer mean motion, in radians per minute, from the Kozai mean motion of an element set.
+		*/
+		double BrouwerMeanMotion(double kozaiMeanMotion, double eccentricity, double cosInclination)
+		{
+			double omeosq = 1.0 - eccentricity * eccentricity;
+			double rteosq = sqrt(omeosq);
+			double ak = pow(Xke / kozaiMeanMotion, TwoThirds);
+			double d1 = 0.75 * J2 * (3.0 * cosInclination * cosInclination - 1.0) / (rteosq * omeosq);
+			double del = d1 / (ak * ak);
+			double adel = ak * (1.0 - del * del - del * (1.0 / 3.0 + 134.0 * del * del / 81.0));
+			del = d1 / (adel * adel);
+			return kozaiMeanMotion / (1.0 + del);
+		}
+
+		double Field(const string& line, size_t column, size_t length)
+		{
+			// Columns are numbered from one, as in the format definition
+			return strtod(line.substr(column - 1, length).c_str(), nullptr);
+		}
+
+		bool IsElementLine(const string& line, char number)
+		{
+			return line.size() >= 63 && line[0] == number && line[1] == ' ';
+		}
+	}
+
+	const uint32_t SatellitePropagator::LaneCount = Lanes;
+
+	SatellitePropagator::SatellitePropagator(const wstring& filename) :
+		mCount(0), mDeepSpaceCount(0), mReferenceJulianDate(0.0)
+	{
+#if defined(_WIN32)
+		ifstream file(filename);
+#else
+		ifstream file(Utility::ToPortablePath(filename));
+#endif
+		if (file.bad() || file.is_open() == false)
+		{
+			throw GameException("Could not open the satellite element set file.");
+		}
+
+		vector<ElementSet> elementSets;
+		string line;
+		string line1;
+		while (getline(file, line))
+		{
+			if (line.empty() == false && line.back() == '\r')
+			{
+				line.pop_back();
+			}
+
+			if (line1.empty() == false)
+			{
+				ElementSet elements;
+				if (IsElementLine(line, '2') == false || ParseElementSet(line1, line, elements) == false)
+				{
+					throw GameException("Malformed two-line element set.");
+				}
+
+				double brouwerMeanMotion = BrouwerMeanMotion(elements.MeanMotion * TwoPi / MinutesPerDay, elements.Eccentricity, cos(elements.Inclination * DegreesToRadians));
+				if (TwoPi / brouwerMeanMotion >= DeepSpacePeriodMinutes)
+				{
+					++mDeepSpaceCount;
+				}
+				else
+				{
+					elementSets.push_back(elements);
+				}
+				line1.clear();
+			}
+			else if (IsElementLine(line, '1'))
+			{
+				line1 = line;
+			}
+		}
+
+		if (line1.empty() == false)
+		{
+			throw GameException("Incomplete two-line element set.");
+		}
+
+		// Satellites missing from the sky should be explained, so the skipped sets are reported once per file
+		if (mDeepSpaceCount > 0)
+		{
+			ostringstream message;
+			message << "Skipped " << mDeepSpaceCount << " deep-space element sets of " << (elementSets.size() + mDeepSpaceCount) << ", which SGP4 cannot propagate." << endl;
+#if defined(_WIN32)
+			OutputDebugStringA(message.str().c_str());
+#else
+			cerr << message.str();
+#endif
+		}
+
+		mCount = static_cast<uint32_t>(elementSets.size());
+		for (const ElementSet& elements : elementSets)
+		{
+			mReferenceJulianDate = max(mReferenceJulianDate, elements.EpochJulianDate);
+		}
+
+		// Pad to whole blocks with copies of the last satellite, whose results are never read
+		uint32_t paddedCount = (mCount + Lanes - 1) / Lanes * Lanes;
+		vector<double>* coefficients[] =
+		{
+			&mEpochMinutes, &mMeanMotions, &mSemiMajorAxes, &mEccentricities, &mInclinations, &mSinInclinations, &mCosInclinations,
+			&mMeanAnomalies, &mArgumentsOfPerigee, &mAscendingNodes, &mMeanAnomalyRates, &mArgumentOfPerigeeRates, &mAscendingNodeRates,
+			&mNodeDragRates, &mCc1, &mBstarCc4, &mBstarCc5, &mOmgcof, &mXmcof, &mEta, &mDelmo, &mSinmao, &mD2, &mD3, &mD4,
+			&mT2cof, &mT3cof, &mT4cof, &mT5cof, &mCon41, &mX1mth2, &mX7thm1, &mAycof, &mXlcof
+		};
+		for (vector<double>* coefficient : coefficients)
+		{
+			coefficient->resize(paddedCount);
+		}
+
+		for (uint32_t i = 0; i < paddedCount; ++i)
+		{
+			Initialize(i, elementSets[min(i, mCount - 1)], mReferenceJulianDate);
+		}
+
+		mPositions.assign(paddedCount, Vector3Helper::Zero);
+		mValidFlags.assign(paddedCount, 0);
+	}
+
+	uint32_t SatellitePropagator::Count() const
+	{
+		return mCount;
+	}
+
+	uint32_t SatellitePropagator::DeepSpaceCount() const
+	{
+		return mDeepSpaceCount;
+	}
+
+	double SatellitePropagator::ReferenceJulianDate() const
+	{
+		return mReferenceJulianDate;
+	}
+
+	void SatellitePropagator::Propagate(double daysSinceReference, ThreadPool& threadPool)
+	{
+		double minutesSinceReference = daysSinceReference * MinutesPerDay;
+		uint32_t blockCount = static_cast<uint32_t>(mPositions.size() / Lanes);
+		threadPool.ParallelFor(blockCount, BlocksPerTask, [&](uint32_t begin, uint32_t end)
+		{
+			for (uint32_t block = begin; block < end; ++block)
+			{
+				PropagateBlock(block * Lanes, minutesSinceReference);
+			}
+		});
+	}
+
+	const XMFLOAT3* SatellitePropagator::Positions() const
+	{
+		return mPositions.data();
+	}
+
+	const uint8_t* SatellitePropagator::ValidFlags() const
+	{
+		return mValidFlags.data();
+	}
+
+	bool SatellitePropagator::ParseElementSet(const string& line1, const string& line2, ElementSet& elements)
+	{
+		if (line1.compare(2, 5, line2, 2, 5) != 0)
+		{
+			return false;
+		}
+
+		// The epoch is a two-digit year from 1957 and a fractional day of the year
+		int year = static_cast<int>(Field(line1, 19, 2));
+		year += (year < 57 ? 2000 : 1900);
+		double dayOfYear = Field(line1, 21, 12);
+		double januaryFirst = 367.0 * year - floor(7.0 * year / 4.0) + 30.0 + 1.0 + 1721013.5;
+		elements.EpochJulianDate = januaryFirst + dayOfYear - 1.0;
+
+		// B* is written as a signed mantissa with an assumed leading decimal point and a signed exponent
+		double dragMantissa = strtod(("0." + line1.substr(54, 5)).c_str(), nullptr);
+		int dragExponent = static_cast<int>(Field(line1, 60, 2));
+		elements.Drag = (line1[53] == '-' ? -dragMantissa : dragMantissa) * pow(10.0, dragExponent);
+
+		elements.Inclination = Field(line2, 9, 8);
+		elements.AscendingNode = Field(line2, 18, 8);
+		elements.Eccentricity = strtod(("0." + line2.substr(26, 7)).c_str(), nullptr);
+		elements.ArgumentOfPerigee = Field(line2, 35, 8);
+		elements.MeanAnomaly = Field(line2, 44, 8);
+		elements.MeanMotion = Field(line2, 53, 11);
+
+		return elements.MeanMotion > 0.0 && dayOfYear >= 1.0;
+	}
+
+	void SatellitePropagator::Initialize(uint32_t index, const ElementSet& elements, double referenceJulianDate)
+	{
+		double ecco = elements.Eccentricity;
+		double inclo = elements.Inclination * DegreesToRadians;
+		double argpo = elements.ArgumentOfPerigee * DegreesToRadians;
+		double mo = elements.MeanAnomaly * DegreesToRadians;
+		double bstar = elements.Drag;
+		double noKozai = elements.MeanMotion * TwoPi / MinutesPerDay;
+
+		// Recover the Brouwer mean motion and semi-major axis from the Kozai mean motion of the element set
+		double omeosq = 1.0 - ecco * ecco;
+		double rteosq = sqrt(omeosq);
+		double cosio = cos(inclo);
+		double cosio2 = cosio * cosio;
+		double no = BrouwerMeanMotion(noKozai, ecco, cosio);
+		double ao = pow(Xke / no, TwoThirds);
+
+		double sinio = sin(inclo);
+		double po = ao * omeosq;
+		double con42 = 1.0 - 5.0 * cosio2;
+		double con41 = -con42 - cosio2 - cosio2;
+		double posq = po * po;
+		double rp = ao * (1.0 - ecco);
+
+		// Orbits with a perigee below 220 km use the simplified drag model
+		bool simplified = rp < (220.0 / EarthRadius + 1.0);
+
+		// The atmospheric density function depends on the height of the perigee
+		double ss = 78.0 / EarthRadius + 1.0;
+		double qzms2t = pow((120.0 - 78.0) / EarthRadius, 4.0);
+		double sfour = ss;
+		double qzms24 = qzms2t;
+		double perigee = (rp - 1.0) * EarthRadius;
+		if (perigee < 156.0)
+		{
+			sfour = (perigee < 98.0 ? 20.0 : perigee - 78.0);
+			qzms24 = pow((120.0 - sfour) / EarthRadius, 4.0);
+			sfour = sfour / EarthRadius + 1.0;
+		}
+
+		double pinvsq = 1.0 / posq;
+		double tsi = 1.0 / (ao - sfour);
+		double eta = ao * ecco * tsi;
+		double etasq = eta * eta;
+		double eeta = ecco * eta;
+		double psisq = fabs(1.0 - etasq);
+		double coef = qzms24 * pow(tsi, 4.0);
+		double coef1 = coef / pow(psisq, 3.5);
+		double cc2 = coef1 * no * (ao * (1.0 + 1.5 * etasq + eeta * (4.0 + etasq)) + 0.375 * J2 * tsi / psisq * con41 * (8.0 + 3.0 * etasq * (8.0 + etasq)));
+		double cc1 = bstar * cc2;
+		double cc3 = (ecco > 1.0e-4 ? -2.0 * coef * tsi * J3OverJ2 * no * sinio / ecco : 0.0);
+		double x1mth2 = 1.0 - cosio2;
+		double cc4 = 2.0 * no * coef1 * ao * omeosq * (eta * (2.0 + 0.5 * etasq) + ecco * (0.5 + 2.0 * etasq) - J2 * tsi / (ao * psisq) *
+			(-3.0 * con41 * (1.0 - 2.0 * eeta + etasq * (1.5 - 0.5 * eeta)) + 0.75 * x1mth2 * (2.0 * etasq - eeta * (1.0 + etasq)) * cos(2.0 * argpo)));
+		double cc5 = 2.0 * coef1 * ao * omeosq * (1.0 + 2.75 * (etasq + eeta) + eeta * etasq);
+
+		// Secular rates from the zonal harmonics
+		double cosio4 = cosio2 * cosio2;
+		double temp1 = 1.5 * J2 * pinvsq * no;
+		double temp2 = 0.5 * temp1 * J2 * pinvsq;
+		double temp3 = -0.46875 * J4 * pinvsq * pinvsq * no;
+		double xhdot1 = -temp1 * cosio;
+
+		mEpochMinutes[index] = (elements.EpochJulianDate - referenceJulianDate) * MinutesPerDay;
+		mMeanMotions[index] = no;
+		mSemiMajorAxes[index] = ao;
+		mEccentricities[index] = ecco;
+		mInclinations[index] = inclo;
+		mSinInclinations[index] = sinio;
+		mCosInclinations[index] = cosio;
+		mMeanAnomalies[index] = mo;
+		mArgumentsOfPerigee[index] = argpo;
+		mAscendingNodes[index] = elements.AscendingNode * DegreesToRadians;
+		mMeanAnomalyRates[index] = no + 0.5 * temp1 * rteosq * con41 + 0.0625 * temp2 * rteosq * (13.0 - 78.0 * cosio2 + 137.0 * cosio4);
+		mArgumentOfPerigeeRates[index] = -0.5 * temp1 * con42 + 0.0625 * temp2 * (7.0 - 114.0 * cosio2 + 395.0 * cosio4) + temp3 * (3.0 - 36.0 * cosio2 + 49.0 * cosio4);
+		mAscendingNodeRates[index] = xhdot1 + (0.5 * temp2 * (4.0 - 19.0 * cosio2) + 2.0 * temp3 * (3.0 - 7.0 * cosio2)) * cosio;
+		mNodeDragRates[index] = 3.5 * omeosq * xhdot1 * cc1;
+		mCc1[index] = cc1;
+		mBstarCc4[index] = bstar * cc4;
+		mEta[index] = eta;
+		mDelmo[index] = pow(1.0 + eta * cos(mo), 3.0);
+		mSinmao[index] = sin(mo);
+		mT2cof[index] = 1.5 * cc1;
+		mCon41[index] = con41;
+		mX1mth2[index] = x1mth2;
+		mX7thm1[index] = 7.0 * cosio2 - 1.0;
+		mAycof[index] = -0.5 * J3OverJ2 * sinio;
+		double cosioPlusOne = (fabs(cosio + 1.0) > 1.5e-12 ? 1.0 + cosio : 1.5e-12);
+		mXlcof[index] = -0.25 * J3OverJ2 * sinio * (3.0 + 5.0 * cosio) / cosioPlusOne;
+
+		// The simplified model is the full one with its higher order drag terms set to zero, so every lane can run the same code
+		double omgcof = bstar * cc3 * cos(argpo);
+		double xmcof = (ecco > 1.0e-4 ? -TwoThirds * coef * bstar / eeta : 0.0);
+		double cc1sq = cc1 * cc1;
+		double d2 = 4.0 * ao * tsi * cc1sq;
+		double temp = d2 * tsi * cc1 / 3.0;
+		double d3 = (17.0 * ao + sfour) * temp;
+		double d4 = 0.5 * temp * ao * tsi * (221.0 * ao + 31.0 * sfour) * cc1;
+		double fullModel = (simplified ? 0.0 : 1.0);
+		mOmgcof[index] = fullModel * omgcof;
+		mXmcof[index] = fullModel * xmcof;
+		mBstarCc5[index] = fullModel * bstar * cc5;
+		mD2[index] = fullModel * d2;
+		mD3[index] = fullModel * d3;
+		mD4[index] = fullModel * d4;
+		mT3cof[index] = fullModel * (d2 + 2.0 * cc1sq);
+		mT4cof[index] = fullModel * 0.25 * (3.0 * d3 + cc1 * (12.0 * d2 + 10.0 * cc1sq));
+		mT5cof[index] = fullModel * 0.2 * (3.0 * d4 + 12.0 * cc1 * d3 + 6.0 * d2 * d2 + 15.0 * cc1sq * (2.0 * d2 + cc1sq));
+	}
+
+	void SatellitePropagator::PropagateBlock(uint32_t first, double minutesSinceReference)
+	{
+		const double* epochMinutes = mEpochMinutes.data() + first;
+		const double* meanMotions = mMeanMotions.data() + first;
+		const double* semiMajorAxes = mSemiMajorAxes.data() + first;
+		const double* eccentricities = mEccentricities.data() + first;
+		const double* inclinations = mInclinations.data() + first;
+		const double* sinInclinations = mSinInclinations.data() + first;
+		const double* cosInclinations = mCosInclinations.data() + first;
+		const double* meanAnomalies = mMeanAnomalies.data() + first;
+		const double* argumentsOfPerigee = mArgumentsOfPerigee.data() + first;
+		const double* ascendingNodes = mAscendingNodes.data() + first;
+		const double* meanAnomalyRates = mMeanAnomalyRates.data() + first;
+		const double* argumentOfPerigeeRates = mArgumentOfPerigeeRates.data() + first;
+		const double* ascendingNodeRates = mAscendingNodeRates.data() + first;
+		const double* nodeDragRates = mNodeDragRates.data() + first;
+		const double* cc1 = mCc1.data() + first;
+		const double* bstarCc4 = mBstarCc4.data() + first;
+		const double* bstarCc5 = mBstarCc5.data() + first;
+		const double* omgcof = mOmgcof.data() + first;
+		const double* xmcof = mXmcof.data() + first;
+		const double* eta = mEta.data() + first;
+		const double* delmo = mDelmo.data() + first;
+		const double* sinmao = mSinmao.data() + first;
+		const double* d2 = mD2.data() + first;
+		const double* d3 = mD3.data() + first;
+		const double* d4 = mD4.data() + first;
+		const double* t2cof = mT2cof.data() + first;
+		const double* t3cof = mT3cof.data() + first;
+		const double* t4cof = mT4cof.data() + first;
+		const double* t5cof = mT5cof.data() + first;
+		const double* con41 = mCon41.data() + first;
+		const double* x1mth2 = mX1mth2.data() + first;
+		const double* x7thm1 = mX7thm1.data() + first;
+		const double* aycof = mAycof.data() + first;
+		const double* xlcof = mXlcof.data() + first;
+
+		// Secular effects of gravity and drag
+		double am[Lanes];
+		double em[Lanes];
+		double mm[Lanes];
+		double argpm[Lanes];
+		double nodem[Lanes];
+		double valid[Lanes];
+		for (uint32_t lane = 0; lane < Lanes; ++lane)
+		{
+			double t = minutesSinceReference - epochMinutes[lane];
+			double t2 = t * t;
+			double t3 = t2 * t;
+			double t4 = t3 * t;
+			double xmdf = LaneMath::WrapTwoPi(meanAnomalies[lane] + meanAnomalyRates[lane] * t);
+			double argpdf = argumentsOfPerigee[lane] + argumentOfPerigeeRates[lane] * t;
+			double nodedf = ascendingNodes[lane] + ascendingNodeRates[lane] * t;
+			double sinxmdf;
+			double cosxmdf;
+			LaneMath::SinCos(xmdf, sinxmdf, cosxmdf);
+			double delmtemp = 1.0 + eta[lane] * cosxmdf;
+			double delm = xmcof[lane] * (delmtemp * delmtemp * delmtemp - delmo[lane]);
+			double delomg = omgcof[lane] * t + delm;
+			double mean = xmdf + delomg;
+			double tempa = 1.0 - cc1[lane] * t - d2[lane] * t2 - d3[lane] * t3 - d4[lane] * t4;
+			double sinmean;
+			double cosmean;
+			LaneMath::SinCos(mean, sinmean, cosmean);
+			double tempe = bstarCc4[lane] * t + bstarCc5[lane] * (sinmean - sinmao[lane]);
+			double templ = t2cof[lane] * t2 + t3cof[lane] * t3 + t4 * (t4cof[lane] + t * t5cof[lane]);
+
+			double a = semiMajorAxes[lane] * tempa * tempa;
+			double e = eccentricities[lane] - tempe;
+			valid[lane] = (e < 1.0 ? 1.0 : 0.0) * (e >= -0.001 ? 1.0 : 0.0);
+			e = max(e, 1.0e-6);
+
+			double node = LaneMath::WrapTwoPi(nodedf + nodeDragRates[lane] * t2);
+			double argp = LaneMath::WrapTwoPi(argpdf - delomg);
+			double xlm = LaneMath::WrapTwoPi(mean + meanMotions[lane] * templ + argp + node);
+			am[lane] = a;
+			em[lane] = e;
+			nodem[lane] = node;
+			argpm[lane] = argp;
+			mm[lane] = LaneMath::WrapTwoPi(xlm - argp - node);
+		}
+
+		// Long-period periodics
+		double axnl[Lanes];
+		double aynl[Lanes];
+		double u[Lanes];
+		for (uint32_t lane = 0; lane < Lanes; ++lane)
+		{
+			double e = em[lane];
+			double temp = 1.0 / (am[lane] * (1.0 - e * e));
+			double sinargp;
+			double cosargp;
+			LaneMath::SinCos(argpm[lane], sinargp, cosargp);
+			double ax = e * cosargp;
+			axnl[lane] = ax;
+			aynl[lane] = e * sinargp + temp * aycof[lane];
+			u[lane] = LaneMath::WrapTwoPi(mm[lane] + argpm[lane] + temp * xlcof[lane] * ax);
+		}
+
+		// Kepler's equation, until every lane has converged
+		double eo1[Lanes];
+		double sineo1[Lanes];
+		double coseo1[Lanes];
+		double steps[Lanes];
+		for (uint32_t lane = 0; lane < Lanes; ++lane)
+		{
+			eo1[lane] = u[lane];
+		}
+
+		for (uint32_t iteration = 0; iteration < MaxKeplerIterations; ++iteration)
+		{
+			for (uint32_t lane = 0; lane < Lanes; ++lane)
+			{
+				double s;
+				double c;
+				LaneMath::SinCos(eo1[lane], s, c);
+				double step = (u[lane] - aynl[lane] * c + axnl[lane] * s - eo1[lane]) / (1.0 - c * axnl[lane] - s * aynl[lane]);
+				step = max(-0.95, min(step, 0.95));
+				eo1[lane] += step;
+				sineo1[lane] = s;
+				coseo1[lane] = c;
+				steps[lane] = fabs(step);
+			}
+
+			// A lane whose elements have broken down steps by NaN, which counts as converged
+			uint32_t unconverged = 0;
+			for (uint32_t lane = 0; lane < Lanes; ++lane)
+			{
+				unconverged += (steps[lane] >= 1.0e-12 ? 1 : 0);
+			}
+
+			if (unconverged == 0)
+			{
+				break;
+			}
+		}
+
+		// Short-period periodics and the orientation of the orbit
+		double x[Lanes];
+		double y[Lanes];
+		double z[Lanes];
+		for (uint32_t lane = 0; lane < Lanes; ++lane)
+		{
+			double ax = axnl[lane];
+			double ay = aynl[lane];
+			double a = am[lane];
+			double ecose = ax * coseo1[lane] + ay * sineo1[lane];
+			double esine = ax * sineo1[lane] - ay * coseo1[lane];
+			double el2 = ax * ax + ay * ay;
+			double pl = a * (1.0 - el2);
+			double rl = a * (1.0 - ecose);
+			double betal = sqrt(1.0 - el2);
+			double temp = esine / (1.0 + betal);
+			double sinu = a / rl * (sineo1[lane] - ay - ax * temp);
+			double cosu = a / rl * (coseo1[lane] - ax + ay * temp);
+			double sin2u = (cosu + cosu) * sinu;
+			double cos2u = 1.0 - 2.0 * sinu * sinu;
+
+			double temp1 = 0.5 * J2 / pl;
+			double temp2 = temp1 / pl;
+			double mrt = rl * (1.0 - 1.5 * temp2 * betal * con41[lane]) + 0.5 * temp1 * x1mth2[lane] * cos2u;
+			double xnode = nodem[lane] + 1.5 * temp2 * cosInclinations[lane] * sin2u;
+			double xinc = inclinations[lane] + 1.5 * temp2 * cosInclinations[lane] * sinInclinations[lane] * cos2u;
+
+			// The argument of latitude less its short-period correction, by the difference of angles rather than atan2
+			double correction = 0.25 * temp2 * x7thm1[lane] * sin2u;
+			double sincorrection;
+			double coscorrection;
+			LaneMath::SinCos(correction, sincorrection, coscorrection);
+			double scale = 1.0 / sqrt(sinu * sinu + cosu * cosu);
+			double sinsu = scale * (sinu * coscorrection - cosu * sincorrection);
+			double cossu = scale * (cosu * coscorrection + sinu * sincorrection);
+
+			double snod;
+			double cnod;
+			double sini;
+			double cosi;
+			LaneMath::SinCos(xnode, snod, cnod);
+			LaneMath::SinCos(xinc, sini, cosi);
+			double distance = mrt * EarthRadius;
+			x[lane] = distance * (cnod * cossu - snod * cosi * sinsu);
+			y[lane] = distance * (snod * cossu + cnod * cosi * sinsu);
+			z[lane] = distance * sini * sinsu;
+
+			// An orbit that has decayed into the Earth, or whose elements no longer describe an ellipse, is dropped
+			valid[lane] *= (pl >= 0.0 ? 1.0 : 0.0) * (mrt >= 1.0 ? 1.0 : 0.0);
+		}
+
+		XMFLOAT3* positions = mPositions.data() + first;
+		uint8_t* validFlags = mValidFlags.data() + first;
+		for (uint32_t lane = 0; lane < Lanes; ++lane)
+		{
+			positions[lane] = XMFLOAT3(static_cast<float>(x[lane]), static_cast<float>(y[lane]), static_cast<float>(z[lane]));
+			validFlags[lane] = static_cast<uint8_t>(valid[lane] != 0.0 ? 1 : 0);
+		}
+	}
+}
\ No newline at end of file
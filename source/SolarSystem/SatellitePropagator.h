@@ -0,0 +1,135 @@
+#pragma once
+
+#include <vector>
+#include <string>
+#include <cstdint>
+#include <DirectXMath.h>
+
+namespace Library
+{
+	class ThreadPool;
+}
+
+namespace Rendering
+{
+	/**
+	* Propagates Earth satellites from two-line element sets with the SGP4 model, as published by Vallado et al. in
+	* "Revisiting Spacetrack Report #3" with the WGS-72 constants.
+	* The coefficients of every satellite are computed once on load and kept in structure-of-arrays form. Propagation
+	* then runs over blocks of LaneCount satellites with every step written as a loop across the lanes of the block, so
+	* the compiler can vectorize it across satellites; Kepler's equation is iterated until every lane of a block has
+	* converged. Blocks are split across the cores of a thread pool.
+	*
+	* Deep-space satellites, with periods of 225 minutes or more, need the lunar-solar and resonance terms of SDP4,
+	* without which geosynchronous and Molniya orbits drift by hundreds of kilometres a day. Their element sets are
+	* skipped on load, counted and reported to the debugger output, or the standard error of a portable build, rather
+	* than drawn in the wrong place.
+	*/
+	class SatellitePropagator final
+	{
+	public:
+		/**
+		* Load a file of two-line element sets. Each set may be preceded by a line with the name of the satellite.
+		* @param filename The element set file.
+		*/
+		SatellitePropagator(const std::wstring& filename);
+		SatellitePropagator(const SatellitePropagator&) = delete;
+		SatellitePropagator& operator=(const SatellitePropagator&) = delete;
+		SatellitePropagator(SatellitePropagator&&) = delete;
+		SatellitePropagator& operator=(SatellitePropagator&&) = delete;
+		~SatellitePropagator() = default;
+
+		/**
+		* Get the number of satellites propagated, which excludes the deep-space ones.
+		*/
+		std::uint32_t Count() const;
+		/**
+		* Get the number of deep-space element sets skipped on load.
+		*/
+		std::uint32_t DeepSpaceCount() const;
+		/**
+		* The latest epoch among the element sets, as a Julian date (UTC). Propagation times are relative to it.
+		*/
+		double ReferenceJulianDate() const;
+
+		/**
+		* Propagate every satellite to a time relative to the reference epoch.
+		* @param daysSinceReference The time in days since ReferenceJulianDate().
+		* @param threadPool The pool the blocks of satellites are split across.
+		*/
+		void Propagate(double daysSinceReference, Library::ThreadPool& threadPool);
+
+		/**
+		* Get the positions found by the last call to Propagate(), in kilometres in the true equator, mean equinox frame
+		* of the element sets. The z axis points to the north pole.
+		*/
+		const DirectX::XMFLOAT3* Positions() const;
+		/**
+		* Get whether each position is valid. A satellite is invalid once its orbit has decayed or the model breaks down.
+		*/
+		const std::uint8_t* ValidFlags() const;
+
+		static const std::uint32_t LaneCount;
+
+	private:
+		struct ElementSet
+		{
+			double EpochJulianDate;
+			double MeanMotion;			// Revolutions per day
+			double Eccentricity;
+			double Inclination;			// Degrees
+			double AscendingNode;		// Degrees
+			double ArgumentOfPerigee;	// Degrees
+			double MeanAnomaly;			// Degrees
+			double Drag;				// B*, per Earth radius
+		};
+
+		static bool ParseElementSet(const std::string& line1, const std::string& line2, ElementSet& elements);
+		void Initialize(std::uint32_t index, const ElementSet& elements, double referenceJulianDate);
+		void PropagateBlock(std::uint32_t first, double minutesSinceReference);
+
+		std::uint32_t mCount;
+		std::uint32_t mDeepSpaceCount;
+		double mReferenceJulianDate;
+
+		// Coefficients of each satellite, padded to a multiple of LaneCount. Rates are per minute, angles in radians
+		// and distances in Earth radii.
+		std::vector<double> mEpochMinutes;			// The epoch relative to the reference
+		std::vector<double> mMeanMotions;			// Brouwer mean motion
+		std::vector<double> mSemiMajorAxes;
+		std::vector<double> mEccentricities;
+		std::vector<double> mInclinations;
+		std::vector<double> mSinInclinations;
+		std::vector<double> mCosInclinations;
+		std::vector<double> mMeanAnomalies;
+		std::vector<double> mArgumentsOfPerigee;
+		std::vector<double> mAscendingNodes;
+		std::vector<double> mMeanAnomalyRates;
+		std::vector<double> mArgumentOfPerigeeRates;
+		std::vector<double> mAscendingNodeRates;
+		std::vector<double> mNodeDragRates;
+		std::vector<double> mCc1;
+		std::vector<double> mBstarCc4;
+		std::vector<double> mBstarCc5;
+		std::vector<double> mOmgcof;
+		std::vector<double> mXmcof;
+		std::vector<double> mEta;
+		std::vector<double> mDelmo;
+		std::vector<double> mSinmao;
+		std::vector<double> mD2;
+		std::vector<double> mD3;
+		std::vector<double> mD4;
+		std::vector<double> mT2cof;
+		std::vector<double> mT3cof;
+		std::vector<double> mT4cof;
+		std::vector<double> mT5cof;
+		std::vector<double> mCon41;
+		std::vector<double> mX1mth2;
+		std::vector<double> mX7thm1;
+		std::vector<double> mAycof;
+		std::vector<double> mXlcof;
+
+		std::vector<DirectX::XMFLOAT3> mPositions;
+		std::vector<std::uint8_t> mValidFlags;
+	};
+}
\ No newline at end of file
@@ -0,0 +1,286 @@
+#include "pch.h"
+
+using namespace std;
+using namespace DirectX;
+
+namespace Rendering
+{
+	namespace
+	{
+		const uint32_t MaxOccluders = ShadowOccluders::MaxOccluders;
+	}
+
+	ShadowOccluderPass::ShadowOccluderPass(uint32_t azimuthCells, uint32_t elevationCells) :
+		mAzimuthCells(max(azimuthCells, 1U)), mElevationCells(max(elevationCells, 1U))
+	{
+	}
+
+	void ShadowOccluderPass::Update(const XMFLOAT3* positions, const float* radii, const uint8_t* receivers, uint32_t count, uint32_t lightIndex)
+	{
+		assert(lightIndex < count);
+
+		const ShadowOccluders noOccluders = { };
+		mOccluders.assign(count, noOccluders);
+		mGatherStamps.assign(count, 0);
+
+		BuildGrid(positions, radii, count, lightIndex);
+
+		for (uint32_t i = 0; i < count; ++i)
+		{
+			if (receivers[i] != 0 && i != lightIndex)
+			{
+				GatherCandidates(i, positions, radii);
+				TestCandidates(i, positions, radii, lightIndex);
+			}
+		}
+	}
+
+	const ShadowOccluders& ShadowOccluderPass::Occluders(uint32_t index) const
+	{
+		return mOccluders[index];
+	}
+
+	ShadowOccluderPass::CellRange ShadowOccluderPass::CellsInCone(const XMFLOAT3& direction, float halfAngle) const
+	{
+		CellRange range = { 0, mAzimuthCells, 0, mElevationCells - 1 };
+		if (halfAngle >= XM_PIDIV2)
+		{
+			return range;
+		}
+
+		auto elevationCell = [&](float elevation)
+		{
+			return min(static_cast<uint32_t>((elevation + XM_PIDIV2) / XM_PI * mElevationCells), mElevationCells - 1);
+		};
+
+		float elevation = asin(max(-1.0f, min(direction.y, 1.0f)));
+		float low = elevation - halfAngle;
+		float high = elevation + halfAngle;
+		range.FirstElevation = elevationCell(max(low, -XM_PIDIV2));
+		range.LastElevation = elevationCell(min(high, XM_PIDIV2));
+
+		// A cone over a pole covers every azimuth; otherwise its azimuthal half-width widens away from the equator
+		if (low > -XM_PIDIV2 && high < XM_PIDIV2)
+		{
+			float azimuth = atan2(direction.z, direction.x);
+			float spread = asin(min(sin(halfAngle) / cos(elevation), 1.0f));
+			int32_t first = static_cast<int32_t>(floor((azimuth - spread + XM_PI) / XM_2PI * mAzimuthCells));
+			int32_t last = static_cast<int32_t>(floor((azimuth + spread + XM_PI) / XM_2PI * mAzimuthCells));
+			int32_t cells = static_cast<int32_t>(mAzimuthCells);
+
+			range.FirstAzimuth = static_cast<uint32_t>(((first % cells) + cells) % cells);
+			range.AzimuthCount = static_cast<uint32_t>(min(last - first + 1, cells));
+		}
+
+		return range;
+	}
+
+	void ShadowOccluderPass::BuildGrid(const XMFLOAT3* positions, const float* radii, uint32_t count, uint32_t lightIndex)
+	{
+		const XMFLOAT3& light = positions[lightIndex];
+		float lightRadius = radii[lightIndex];
+
+		mDirections.resize(count);
+		mDistances.resize(count);
+		mCasterCells.resize(count);
+		mCellStarts.assign(mAzimuthCells * mElevationCells + 1, 0);
+
+		auto forEachCell = [&](const CellRange& range, const function<void(uint32_t)>& visit)
+		{
+			for (uint32_t elevation = range.FirstElevation; elevation <= range.LastElevation; ++elevation)
+			{
+				for (uint32_t i = 0; i < range.AzimuthCount; ++i)
+				{
+					visit(elevation * mAzimuthCells + (range.FirstAzimuth + i) % mAzimuthCells);
+				}
+			}
+		};
+
+		// A caster's shadow can only fall within the cone of lines that touch both it and the light, widened by the
+		// apparent size of the light from the caster, so it is binned into every cell that cone crosses
+		for (uint32_t i = 0; i < count; ++i)
+		{
+			XMFLOAT3 offset(positions[i].x - light.x, positions[i].y - light.y, positions[i].z - light.z);
+			float distance = sqrt(offset.x * offset.x + offset.y * offset.y + offset.z * offset.z);
+			mDistances[i] = distance;
+			mDirections[i] = (distance > 0.0f ? XMFLOAT3(offset.x / distance, offset.y / distance, offset.z / distance) : XMFLOAT3(1.0f, 0.0f, 0.0f));
+			mCasterCells[i].AzimuthCount = 0;
+
+			if (i == lightIndex || radii[i] <= 0.0f)
+			{
+				continue;
+			}
+
+			float radius = radii[i];
+			float halfAngle = (distance > radius + lightRadius ? asin((radius + lightRadius) / distance) + asin(lightRadius / (distance - radius)) : XM_PI);
+			mCasterCells[i] = CellsInCone(mDirections[i], halfAngle);
+			forEachCell(mCasterCells[i], [&](uint32_t cell)
+			{
+				++mCellStarts[cell + 1];
+			});
+		}
+
+		uint32_t cellCount = mAzimuthCells * mElevationCells;
+		for (uint32_t cell = 1; cell <= cellCount; ++cell)
+		{
+			mCellStarts[cell] += mCellStarts[cell - 1];
+		}
+
+		// Fill each cell by advancing its start, then shift the starts back into place
+		mCellCasters.resize(mCellStarts[cellCount]);
+		for (uint32_t i = 0; i < count; ++i)
+		{
+			forEachCell(mCasterCells[i], [&](uint32_t cell)
+			{
+				mCellCasters[mCellStarts[cell]++] = i;
+			});
+		}
+
+		for (uint32_t cell = cellCount; cell > 0; --cell)
+		{
+			mCellStarts[cell] = mCellStarts[cell - 1];
+		}
+		mCellStarts[0] = 0;
+	}
+
+	void ShadowOccluderPass::GatherCandidates(uint32_t receiver, const XMFLOAT3* positions, const float* radii)
+	{
+		mCandidates.clear();
+		mCandidatesX.clear();
+		mCandidatesY.clear();
+		mCandidatesZ.clear();
+		mCandidatesRadius.clear();
+
+		float distance = mDistances[receiver];
+		float radius = radii[receiver];
+		float halfAngle = (distance > radius ? asin(radius / distance) : XM_PI);
+		CellRange range = CellsInCone(mDirections[receiver], halfAngle);
+
+		uint32_t stamp = receiver + 1;
+		for (uint32_t elevation = range.FirstElevation; elevation <= range.LastElevation; ++elevation)
+		{
+			for (uint32_t i = 0; i < range.AzimuthCount; ++i)
+			{
+				uint32_t cell = elevation * mAzimuthCells + (range.FirstAzimuth + i) % mAzimuthCells;
+				for (uint32_t j = mCellStarts[cell]; j < mCellStarts[cell + 1]; ++j)
+				{
+					uint32_t caster = mCellCasters[j];
+					if (caster != receiver && mGatherStamps[caster] != stamp)
+					{
+						mGatherStamps[caster] = stamp;
+						mCandidates.push_back(caster);
+						mCandidatesX.push_back(positions[caster].x);
+						mCandidatesY.push_back(positions[caster].y);
+						mCandidatesZ.push_back(positions[caster].z);
+						mCandidatesRadius.push_back(radii[caster]);
+					}
+				}
+			}
+		}
+
+		size_t padded = (mCandidates.size() + 3) & ~static_cast<size_t>(3);
+		mCandidatesX.resize(padded, 0.0f);
+		mCandidatesY.resize(padded, 0.0f);
+		mCandidatesZ.resize(padded, 0.0f);
+		mCandidatesRadius.resize(padded, 0.0f);
+	}
+
+	void ShadowOccluderPass::TestCandidates(uint32_t receiver, const XMFLOAT3* positions, const float* radii, uint32_t lightIndex)
+	{
+		const XMFLOAT3& light = positions[lightIndex];
+		float lightRadius = radii[lightIndex];
+		float receiverRadius = radii[receiver];
+		float length = mDistances[receiver];
+		float radiusDifference = lightRadius - receiverRadius;
+		if (mCandidates.empty() || length <= fabs(radiusDifference))
+		{
+			return;
+		}
+
+		// The convex hull of the light and the receiver is a truncated cone; at a distance t along its axis its radius
+		// is the interpolated radius of the two spheres, widened by the slope of the tangent lines
+		float widening = length / sqrt(length * length - radiusDifference * radiusDifference);
+		XMVECTOR hullBase = XMVectorReplicate(lightRadius * widening);
+		XMVECTOR hullSlope = XMVectorReplicate((receiverRadius - lightRadius) * widening / length);
+		XMVECTOR axisLength = XMVectorReplicate(length);
+
+		const XMFLOAT3& axis = mDirections[receiver];
+		XMVECTOR axisX = XMVectorReplicate(axis.x);
+		XMVECTOR axisY = XMVectorReplicate(axis.y);
+		XMVECTOR axisZ = XMVectorReplicate(axis.z);
+		XMVECTOR lightX = XMVectorReplicate(light.x);
+		XMVECTOR lightY = XMVectorReplicate(light.y);
+		XMVECTOR lightZ = XMVectorReplicate(light.z);
+
+		float depths[MaxOccluders];
+		uint32_t occluders[MaxOccluders];
+		uint32_t occluderCount = 0;
+
+		uint32_t candidateCount = static_cast<uint32_t>(mCandidates.size());
+		for (uint32_t i = 0; i < candidateCount; i += 4)
+		{
+			XMVECTOR x = XMVectorSubtract(XMLoadFloat4(reinterpret_cast<const XMFLOAT4*>(&mCandidatesX[i])), lightX);
+			XMVECTOR y = XMVectorSubtract(XMLoadFloat4(reinterpret_cast<const XMFLOAT4*>(&mCandidatesY[i])), lightY);
+			XMVECTOR z = XMVectorSubtract(XMLoadFloat4(reinterpret_cast<const XMFLOAT4*>(&mCandidatesZ[i])), lightZ);
+			XMVECTOR radius = XMLoadFloat4(reinterpret_cast<const XMFLOAT4*>(&mCandidatesRadius[i]));
+
+			// The distance from the axis is taken from the cross product with it; the difference of the squared length and
+			// t squared would cancel away the precision of bodies far from the light
+			XMVECTOR t = XMVectorMultiplyAdd(z, axisZ, XMVectorMultiplyAdd(y, axisY, XMVectorMultiply(x, axisX)));
+			XMVECTOR crossX = XMVectorNegativeMultiplySubtract(z, axisY, XMVectorMultiply(y, axisZ));
+			XMVECTOR crossY = XMVectorNegativeMultiplySubtract(x, axisZ, XMVectorMultiply(z, axisX));
+			XMVECTOR crossZ = XMVectorNegativeMultiplySubtract(y, axisX, XMVectorMultiply(x, axisY));
+			XMVECTOR perpendicularSquared = XMVectorMultiplyAdd(crossZ, crossZ, XMVectorMultiplyAdd(crossY, crossY, XMVectorMultiply(crossX, crossX)));
+			XMVECTOR reach = XMVectorAdd(XMVectorMultiplyAdd(hullSlope, t, hullBase), radius);
+
+			// Hit when the sphere reaches into the hull somewhere between the light and the centre of the receiver
+			XMVECTOR hit = XMVectorLess(perpendicularSquared, XMVectorMultiply(reach, reach));
+			hit = XMVectorAndInt(hit, XMVectorGreater(XMVectorAdd(t, radius), XMVectorZero()));
+			hit = XMVectorAndInt(hit, XMVectorLess(t, axisLength));
+
+			// The mask is stored as it is; XMStoreUInt4 would convert it as floats, turning every hit into zero
+			XMUINT4 hits;
+			XMFLOAT4 laneDepths;
+			XMStoreInt4(&hits.x, hit);
+			XMStoreFloat4(&laneDepths, XMVectorSubtract(g_XMOne, XMVectorDivide(XMVectorSqrt(perpendicularSquared), reach)));
+
+			const uint32_t laneHits[] = { hits.x, hits.y, hits.z, hits.w };
+			const float laneDepth[] = { laneDepths.x, laneDepths.y, laneDepths.z, laneDepths.w };
+			for (uint32_t lane = 0; lane < 4 && i + lane < candidateCount; ++lane)
+			{
+				if (laneHits[lane] == 0)
+				{
+					continue;
+				}
+
+				// Keep the casters nearest the centre of the shadow, deepest first
+				uint32_t slot = occluderCount;
+				while (slot > 0 && depths[slot - 1] < laneDepth[lane])
+				{
+					if (slot < MaxOccluders)
+					{
+						depths[slot] = depths[slot - 1];
+						occluders[slot] = occluders[slot - 1];
+					}
+					--slot;
+				}
+
+				if (slot < MaxOccluders)
+				{
+					depths[slot] = laneDepth[lane];
+					occluders[slot] = mCandidates[i + lane];
+					occluderCount = min(occluderCount + 1, MaxOccluders);
+				}
+			}
+		}
+
+		ShadowOccluders& result = mOccluders[receiver];
+		result.Count = occluderCount;
+		result.LightRadius = lightRadius;
+		for (uint32_t i = 0; i < occluderCount; ++i)
+		{
+			const XMFLOAT3& position = positions[occluders[i]];
+			result.Spheres[i] = XMFLOAT4(position.x, position.y, position.z, radii[occluders[i]]);
+		}
+	}
+}
\ No newline at end of file
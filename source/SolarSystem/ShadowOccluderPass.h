@@ -0,0 +1,92 @@
+#pragma once
+
+#include <vector>
+#include <cstdint>
+#include <DirectXMath.h>
+
+namespace Rendering
+{
+	/**
+	* The bodies that can shadow one receiver, laid out to match CBufferPerObject in PlanetPS.hlsl.
+	*/
+	struct ShadowOccluders
+	{
+		static const std::uint32_t MaxOccluders = 4;
+
+		DirectX::XMFLOAT4 Spheres[MaxOccluders];	// Position relative to the floating origin, and radius
+		std::uint32_t Count;
+		float LightRadius;
+		float Padding[2];
+	};
+
+	static_assert(sizeof(ShadowOccluders) % 16 == 0, "ShadowOccluders must fill whole constant buffer registers.");
+
+	/**
+	* Finds, once per frame, the bodies that can cast a shadow on each receiving body from a spherical light.
+	* Casters are binned into a grid of directions around the light by the cone in which their shadow can fall, so a
+	* receiver only gathers the casters binned near its own direction and the pass stays linear in the number of bodies.
+	* Candidates are then tested exactly, four at a time, against the convex hull of the light and the receiver.
+	* The pass has no device dependencies and can run headless.
+	*/
+	class ShadowOccluderPass final
+	{
+	public:
+		/**
+		* @param azimuthCells The number of grid cells around the light.
+		* @param elevationCells The number of grid cells from pole to pole.
+		*/
+		ShadowOccluderPass(std::uint32_t azimuthCells = 64, std::uint32_t elevationCells = 32);
+		ShadowOccluderPass(const ShadowOccluderPass&) = delete;
+		ShadowOccluderPass& operator=(const ShadowOccluderPass&) = delete;
+		ShadowOccluderPass(ShadowOccluderPass&&) = delete;
+		ShadowOccluderPass& operator=(ShadowOccluderPass&&) = delete;
+		~ShadowOccluderPass() = default;
+
+		/**
+		* Rebuild the occluder lists of every body.
+		* @param positions The positions of the bodies relative to the floating origin.
+		* @param radii The radii of the bodies in scene units.
+		* @param receivers Nonzero for the bodies that need occluders, such as those being drawn. Every body can cast a shadow.
+		* @param count The number of bodies.
+		* @param lightIndex The body emitting the light. It never receives or casts a shadow.
+		*/
+		void Update(const DirectX::XMFLOAT3* positions, const float* radii, const std::uint8_t* receivers, std::uint32_t count, std::uint32_t lightIndex);
+
+		/**
+		* Get the occluders found for a body by the last call to Update(), nearest the centre of its shadow first.
+		*/
+		const ShadowOccluders& Occluders(std::uint32_t index) const;
+
+	private:
+		struct CellRange
+		{
+			std::uint32_t FirstAzimuth;
+			std::uint32_t AzimuthCount;
+			std::uint32_t FirstElevation;
+			std::uint32_t LastElevation;
+		};
+
+		CellRange CellsInCone(const DirectX::XMFLOAT3& direction, float halfAngle) const;
+		void BuildGrid(const DirectX::XMFLOAT3* positions, const float* radii, std::uint32_t count, std::uint32_t lightIndex);
+		void GatherCandidates(std::uint32_t receiver, const DirectX::XMFLOAT3* positions, const float* radii);
+		void TestCandidates(std::uint32_t receiver, const DirectX::XMFLOAT3* positions, const float* radii, std::uint32_t lightIndex);
+
+		std::uint32_t mAzimuthCells;
+		std::uint32_t mElevationCells;
+
+		std::vector<DirectX::XMFLOAT3> mDirections;		// Unit vectors from the light
+		std::vector<float> mDistances;					// From the light
+		std::vector<CellRange> mCasterCells;
+		std::vector<std::uint32_t> mCellStarts;			// Casters of cell i are mCellCasters[mCellStarts[i], mCellStarts[i + 1])
+		std::vector<std::uint32_t> mCellCasters;
+
+		std::vector<std::uint32_t> mGatherStamps;		// The receiver that last gathered each body, plus one
+		std::vector<std::uint32_t> mCandidates;
+		std::vector<float> mCandidatesX;				// Padded to a multiple of four
+		std::vector<float> mCandidatesY;
+		std::vector<float> mCandidatesZ;
+		std::vector<float> mCandidatesRadius;
+
+		std::vector<ShadowOccluders> mOccluders;
+	};
+}
\ No newline at end of file
@@ -0,0 +1,987 @@
+#include "pch.h"
+
+using namespace std;
+using namespace Library;
+
+namespace Rendering
+{
+	namespace
+	{
+		// Gravitational constant in astronomical units cubed per earth mass per day squared
+		const double GravitationalConstant = 8.88769e-10;
+		const uint32_t SpinsBeforeYield = 1024;
+		const uint32_t SpinsBeforeSleep = 16384;
+		const uint32_t MaxStepAttempts = 8;
+		const uint32_t WorkerShutdownMilliseconds = 5000;
+		const double DegreesToRadians = 3.14159265358979323846 / 180.0;
+		const double BeltInnerDistance = 2.1;
+		const double BeltOuterDistance = 3.3;
+		const double BeltMaxInclinationDegrees = 10.0;
+
+		size_t AlignTo(size_t value, size_t alignment)
+		{
+			return (value + alignment - 1) & ~(alignment - 1);
+		}
+
+		void Backoff(uint32_t& spins)
+		{
+			++spins;
+#if defined(_WIN32)
+			if (spins < SpinsBeforeYield)
+			{
+				YieldProcessor();
+			}
+			else if (spins < SpinsBeforeSleep)
+			{
+				SwitchToThread();
+			}
+			else
+			{
+				Sleep(1);
+			}
+#else
+			if (spins < SpinsBeforeYield)
+			{
+				atomic_signal_fence(memory_order_seq_cst);
+			}
+			else if (spins < SpinsBeforeSleep)
+			{
+				sched_yield();
+			}
+			else
+			{
+				usleep(1000);
+			}
+#endif
+		}
+
+		uint32_t CurrentProcessId()
+		{
+#if defined(_WIN32)
+			return GetCurrentProcessId();
+#else
+			return static_cast<uint32_t>(getpid());
+#endif
+		}
+
+		/**
+		* Name the region of a coordinator after its process, as a file mapping object on Windows and a POSIX shared
+		* memory object elsewhere.
+		*/
+		wstring RegionName()
+		{
+#if defined(_WIN32)
+			return L"Local\\MySolarSystem.Shards." + to_wstring(CurrentProcessId());
+#else
+			return L"/MySolarSystem.Shards." + to_wstring(CurrentProcessId());
+#endif
+		}
+
+		/**
+		* Watches a process for its exit. Elsewhere than Windows only the parent of the watching process can be watched,
+		* which is all a worker needs: once its coordinator exits, the worker is handed to another parent.
+		*/
+		class ProcessWatch final
+		{
+		public:
+			explicit ProcessWatch(uint32_t processId) :
+#if defined(_WIN32)
+				mProcess(OpenProcess(SYNCHRONIZE, FALSE, processId))
+#else
+				mProcessId(static_cast<pid_t>(processId))
+#endif
+			{
+			}
+
+			ProcessWatch(const ProcessWatch&) = delete;
+			ProcessWatch& operator=(const ProcessWatch&) = delete;
+
+			~ProcessWatch()
+			{
+#if defined(_WIN32)
+				if (mProcess != nullptr)
+				{
+					CloseHandle(mProcess);
+				}
+#endif
+			}
+
+			bool IsValid() const
+			{
+#if defined(_WIN32)
+				return (mProcess != nullptr);
+#else
+				return (getppid() == mProcessId);
+#endif
+			}
+
+			bool HasExited() const
+			{
+#if defined(_WIN32)
+				return (WaitForSingleObject(mProcess, 0) == WAIT_OBJECT_0);
+#else
+				return (getppid() != mProcessId);
+#endif
+			}
+
+		private:
+#if defined(_WIN32)
+			HANDLE mProcess;
+#else
+			pid_t mProcessId;
+#endif
+		};
+
+		void AddAcceleration(const double* position, const double* source, double mass, double softeningSquared, double* acceleration)
+		{
+			double dx = source[0] - position[0];
+			double dy = source[1] - position[1];
+			double dz = source[2] - position[2];
+			double distanceSquared = dx * dx + dy * dy + dz * dz + softeningSquared;
+			double scale = GravitationalConstant * mass / (distanceSquared * sqrt(distanceSquared));
+
+			acceleration[0] += dx * scale;
+			acceleration[1] += dy * scale;
+			acceleration[2] += dz * scale;
+		}
+
+		/**
+		* Place a particle on a circular orbit about a mass at rest at the origin. The argument is measured from the
+		* ascending node in the orbital plane, and the node from the x axis in the ecliptic, the XZ plane.
+		*/
+		ShardParticle CircularOrbit(uint32_t id, double mass, double centralMass, double distance, double argument, double inclination, double node)
+		{
+			double speed = sqrt(GravitationalConstant * (centralMass + mass) / distance);
+			double alongNode[3] = { cos(node), 0.0, -sin(node) };
+			double acrossNode[3] = { -cos(inclination) * sin(node), sin(inclination), -cos(inclination) * cos(node) };
+
+			ShardParticle particle = { 0 };
+			for (uint32_t axis = 0; axis < 3; ++axis)
+			{
+				particle.Position[axis] = distance * (cos(argument) * alongNode[axis] + sin(argument) * acrossNode[axis]);
+				particle.Velocity[axis] = speed * (-sin(argument) * alongNode[axis] + cos(argument) * acrossNode[axis]);
+			}
+
+			particle.Mass = mass;
+			particle.Id = id;
+			return particle;
+		}
+
+		ShardDirection Opposite(ShardDirection direction)
+		{
+			return (direction == ShardDirection::Left ? ShardDirection::Right : ShardDirection::Left);
+		}
+	}
+
+#pragma region ShardedSimulationLayout
+
+	const uint32_t ShardedSimulationLayout::Magic = 0x44524853;	// "SHRD"
+	const uint32_t ShardedSimulationLayout::Version = 1;
+
+	ShardedSimulationLayout::ShardedSimulationLayout(void* memory, const ShardedSimulationSettings& settings) :
+		mMemory(reinterpret_cast<uint8_t*>(memory)), mSettings(settings)
+	{
+		mStatesOffset = AlignTo(sizeof(ShardedSimulationHeader), 64);
+		mParticlesOffset = mStatesOffset + sizeof(ShardState) * settings.ShardCount;
+		mRingsOffset = mParticlesOffset + sizeof(ShardParticle) * settings.MaxParticlesPerShard * 2 * settings.ShardCount;
+		mRingSize = AlignTo(SpscRingBuffer<ShardParticle>::RequiredSize(settings.RingCapacity), 64);
+	}
+
+	size_t ShardedSimulationLayout::RequiredSize(const ShardedSimulationSettings& settings)
+	{
+		ShardedSimulationLayout layout(nullptr, settings);
+		return layout.mRingsOffset + layout.mRingSize * 4 * settings.ShardCount;
+	}
+
+	ShardedSimulationHeader& ShardedSimulationLayout::Header() const
+	{
+		return *reinterpret_cast<ShardedSimulationHeader*>(mMemory);
+	}
+
+	ShardState& ShardedSimulationLayout::State(uint32_t shard) const
+	{
+		return reinterpret_cast<ShardState*>(mMemory + mStatesOffset)[shard];
+	}
+
+	ShardParticle* ShardedSimulationLayout::Particles(uint32_t shard, uint32_t buffer) const
+	{
+		return reinterpret_cast<ShardParticle*>(mMemory + mParticlesOffset) + (shard * 2 + buffer) * mSettings.MaxParticlesPerShard;
+	}
+
+	void* ShardedSimulationLayout::Ring(ShardRing ring, uint32_t shard, ShardDirection direction) const
+	{
+		size_t index = (shard * 2 + static_cast<uint32_t>(ring)) * 2 + static_cast<uint32_t>(direction);
+		return mMemory + mRingsOffset + mRingSize * index;
+	}
+
+#pragma endregion
+
+#pragma region ShardedSimulation
+
+	const wstring ShardedSimulation::WorkerSwitch = L"--shard-worker";
+
+	ShardedSimulation::ShardedSimulation(const ShardedSimulationSettings& settings, vector<ShardParticle> particles) :
+		mSettings(settings), mRegion(SharedMemoryRegion::Create(RegionName(), ShardedSimulationLayout::RequiredSize(settings))),
+#if defined(_WIN32)
+		mWorkers(settings.ShardCount, nullptr), mRestartCount(0)
+#else
+		mWorkers(settings.ShardCount, -1), mRestartCount(0)
+#endif
+	{
+		if (settings.ShardCount == 0 || settings.RingCapacity == 0 || (settings.RingCapacity & (settings.RingCapacity - 1)) != 0)
+		{
+			throw GameException("Invalid sharded simulation settings.");
+		}
+
+		uint32_t particleCount = static_cast<uint32_t>(particles.size());
+		uint32_t particlesPerShard = (particleCount + settings.ShardCount - 1) / settings.ShardCount;
+		if (particlesPerShard > settings.MaxParticlesPerShard)
+		{
+			throw GameException("Too many particles for the shard capacity.");
+		}
+
+		mLayout = make_unique<ShardedSimulationLayout>(mRegion.Data(), settings);
+
+		ShardedSimulationHeader* header = new (mRegion.Data()) ShardedSimulationHeader();
+		header->Magic = ShardedSimulationLayout::Magic;
+		header->Version = ShardedSimulationLayout::Version;
+		header->Settings = settings;
+		header->Phase = ShardPhase::Exchange;
+		header->Step = 0;
+
+		// Cut space into slabs holding equal numbers of particles
+		sort(particles.begin(), particles.end(), [](const ShardParticle& lhs, const ShardParticle& rhs)
+		{
+			return lhs.Position[0] < rhs.Position[0];
+		});
+
+		for (uint32_t shard = 0; shard < settings.ShardCount; ++shard)
+		{
+			uint32_t first = min(shard * particlesPerShard, particleCount);
+			uint32_t last = min(first + particlesPerShard, particleCount);
+
+			ShardState* state = new (&mLayout->State(shard)) ShardState();
+			state->ParticleCounts[0] = last - first;
+			state->ParticleCounts[1] = 0;
+			state->MinX = (shard == 0 || first == particleCount ? -numeric_limits<double>::infinity() : (particles[first - 1].Position[0] + particles[first].Position[0]) * 0.5);
+			state->MaxX = (shard == settings.ShardCount - 1 || last == particleCount ? numeric_limits<double>::infinity() : (particles[last - 1].Position[0] + particles[last].Position[0]) * 0.5);
+			copy(particles.begin() + first, particles.begin() + last, mLayout->Particles(shard, 0));
+
+			for (uint32_t ring = 0; ring < 2; ++ring)
+			{
+				for (uint32_t direction = 0; direction < 2; ++direction)
+				{
+					SpscRingBuffer<ShardParticle>::Initialize(mLayout->Ring(static_cast<ShardRing>(ring), shard, static_cast<ShardDirection>(direction)), settings.RingCapacity);
+				}
+			}
+		}
+
+		mSnapshot = move(particles);
+
+		for (uint32_t shard = 0; shard < settings.ShardCount; ++shard)
+		{
+			LaunchWorker(shard);
+		}
+	}
+
+	ShardedSimulation::~ShardedSimulation()
+	{
+		StopWorkers();
+	}
+
+	void ShardedSimulation::Step()
+	{
+		ShardedSimulationHeader& header = mLayout->Header();
+		uint64_t step = header.CommittedStep.load(memory_order_acquire);
+
+		uint32_t attempts = 0;
+		while ((RunPhase(ShardPhase::Exchange, step) && RunPhase(ShardPhase::Integrate, step) && RunPhase(ShardPhase::Migrate, step)) == false)
+		{
+			// A worker was relaunched; discard the ring traffic of the attempt and replay the step from the committed
+			// buffers. The rings were empty when the last step committed, so nothing else is in them.
+			if (++attempts == MaxStepAttempts)
+			{
+				throw GameException("Shard workers failed repeatedly.");
+			}
+
+			ResetRings();
+		}
+
+		DrainMigrations(step);
+		header.CommittedStep.store(step + 1, memory_order_release);
+		GatherSnapshot();
+	}
+
+	uint64_t ShardedSimulation::CommittedStep() const
+	{
+		return mLayout->Header().CommittedStep.load(memory_order_acquire);
+	}
+
+	uint32_t ShardedSimulation::RestartCount() const
+	{
+		return mRestartCount;
+	}
+
+	uint32_t ShardedSimulation::WorkerProcessId(uint32_t shard) const
+	{
+#if defined(_WIN32)
+		return GetProcessId(mWorkers.at(shard));
+#else
+		return static_cast<uint32_t>(mWorkers.at(shard));
+#endif
+	}
+
+	const vector<ShardParticle>& ShardedSimulation::Snapshot() const
+	{
+		return mSnapshot;
+	}
+
+	void ShardedSimulation::WriteSnapshot(const wstring& filename) const
+	{
+#if defined(_WIN32)
+		ofstream stream(filename.c_str());
+#else
+		ofstream stream(Utility::ToPortablePath(filename));
+#endif
+		if (stream.is_open() == false)
+		{
+			throw GameException("Could not open the snapshot file.");
+		}
+
+		stream << "Id,X,Y,Z,VelocityX,VelocityY,VelocityZ,Mass" << endl;
+		stream << setprecision(17);
+		for (const ShardParticle& particle : mSnapshot)
+		{
+			stream << particle.Id << ',' << particle.Position[0] << ',' << particle.Position[1] << ',' << particle.Position[2] << ','
+				<< particle.Velocity[0] << ',' << particle.Velocity[1] << ',' << particle.Velocity[2] << ',' << particle.Mass << endl;
+		}
+	}
+
+	vector<ShardParticle> ShardedSimulation::FromCatalog(const BodyCatalog& catalog, uint32_t beltCount, uint32_t seed)
+	{
+		uint32_t count = catalog.Count();
+		int32_t starIndex = -1;
+		for (uint32_t i = 0; i < count; ++i)
+		{
+			if (catalog.Record(i).HasFlag(BodyFlags::LightSource))
+			{
+				starIndex = static_cast<int32_t>(i);
+				break;
+			}
+		}
+
+		if (starIndex < 0)
+		{
+			throw GameException("The body catalog has no light source.");
+		}
+
+		const double starMass = catalog.Record(starIndex).Mass;
+		vector<ShardParticle> particles;
+		particles.reserve(count + beltCount);
+
+		ShardParticle star = { 0 };
+		star.Mass = starMass;
+		star.Id = static_cast<uint32_t>(starIndex);
+		particles.push_back(star);
+
+		// A body with no parent that is not a light source circles the origin, where the light source sits.
+		// The simulation starts every revolution at zero, which puts a body at the negated node along its orbit.
+		for (uint32_t i = 0; i < count; ++i)
+		{
+			const BodyCatalogRecord& record = catalog.Record(i);
+			bool orbitsStar = (record.ParentIndex >= 0 ? record.ParentIndex == starIndex : record.HasFlag(BodyFlags::LightSource) == false);
+			if (orbitsStar && record.OrbitalDistance > 0.0f)
+			{
+				double node = record.AscendingNode * DegreesToRadians;
+				particles.push_back(CircularOrbit(i, record.Mass, starMass, record.OrbitalDistance, -node, record.Inclination * DegreesToRadians, node));
+			}
+		}
+
+		mt19937 generator(seed);
+		uniform_real_distribution<double> distances(BeltInnerDistance, BeltOuterDistance);
+		uniform_real_distribution<double> angles(0.0, 360.0 * DegreesToRadians);
+		uniform_real_distribution<double> inclinations(0.0, BeltMaxInclinationDegrees * DegreesToRadians);
+		for (uint32_t i = 0; i < beltCount; ++i)
+		{
+			double distance = distances(generator);
+			double argument = angles(generator);
+			double inclination = inclinations(generator);
+			double node = angles(generator);
+			particles.push_back(CircularOrbit(count + i, 0.0, starMass, distance, argument, inclination, node));
+		}
+
+		return particles;
+	}
+
+#if defined(_WIN32)
+	void ShardedSimulation::LaunchWorker(uint32_t shard)
+	{
+		wchar_t executablePath[MAX_PATH];
+		GetModuleFileName(nullptr, executablePath, MAX_PATH);
+
+		wostringstream commandLineStream;
+		commandLineStream << L"\"" << executablePath << L"\" " << WorkerSwitch << L" " << mRegion.Name() << L" " << shard << L" " << GetCurrentProcessId();
+		wstring commandLine = commandLineStream.str();
+		vector<wchar_t> commandLineBuffer(commandLine.begin(), commandLine.end());
+		commandLineBuffer.push_back(L'\0');
+
+		STARTUPINFO startupInfo = { 0 };
+		startupInfo.cb = sizeof(startupInfo);
+		PROCESS_INFORMATION processInformation = { 0 };
+		if (CreateProcess(executablePath, commandLineBuffer.data(), nullptr, nullptr, FALSE, CREATE_NO_WINDOW, nullptr, nullptr, &startupInfo, &processInformation) == FALSE)
+		{
+			throw GameException("CreateProcess() failed.", HRESULT_FROM_WIN32(GetLastError()));
+		}
+
+		CloseHandle(processInformation.hThread);
+
+		if (mWorkers[shard] != nullptr)
+		{
+			CloseHandle(mWorkers[shard]);
+		}
+
+		mWorkers[shard] = processInformation.hProcess;
+	}
+
+	bool ShardedSimulation::HasWorkerExited(uint32_t shard)
+	{
+		return (WaitForSingleObject(mWorkers[shard], 0) == WAIT_OBJECT_0);
+	}
+
+#else
+	void ShardedSimulation::LaunchWorker(uint32_t shard)
+	{
+		// The worker is this executable again, which Linux names under /proc. The arguments are built before forking,
+		// as the child only calls execv().
+		const char executablePath[] = "/proc/self/exe";
+		vector<string> arguments = { executablePath, Utility::ToString(WorkerSwitch), Utility::ToString(mRegion.Name()), to_string(shard), to_string(CurrentProcessId()) };
+		vector<char*> argumentList;
+		for (string& argument : arguments)
+		{
+			argumentList.push_back(&argument[0]);
+		}
+
+		argumentList.push_back(nullptr);
+
+		pid_t worker = fork();
+		if (worker == -1)
+		{
+			throw GameException("fork() failed.");
+		}
+
+		if (worker == 0)
+		{
+			execv(executablePath, argumentList.data());
+			_exit(127);
+		}
+
+		mWorkers[shard] = worker;
+	}
+
+	bool ShardedSimulation::HasWorkerExited(uint32_t shard)
+	{
+		// Reaps the worker, which is replaced before it is waited on again; a worker that is no longer a child is gone too
+		return (waitpid(mWorkers[shard], nullptr, WNOHANG) != 0);
+	}
+
+#endif
+
+	bool ShardedSimulation::RunPhase(ShardPhase phase, uint64_t step)
+	{
+		ShardedSimulationHeader& header = mLayout->Header();
+		header.Phase = phase;
+		header.Step = step;
+		uint64_t ticket = header.Ticket.load(memory_order_relaxed) + 1;
+		header.Ticket.store(ticket, memory_order_release);
+
+		// Barrier: every shard echoes the ticket once its phase is done. A relaunched worker picks up the
+		// current ticket on startup, so the wait always completes and the caller decides whether to replay.
+		bool succeeded = true;
+		for (uint32_t shard = 0; shard < mSettings.ShardCount; ++shard)
+		{
+			ShardState& state = mLayout->State(shard);
+			uint32_t spins = 0;
+			while (state.CompletedTicket.load(memory_order_acquire) != ticket)
+			{
+				if (spins >= SpinsBeforeYield && HasWorkerExited(shard))
+				{
+					LaunchWorker(shard);
+					++mRestartCount;
+					succeeded = false;
+					spins = 0;
+				}
+
+				Backoff(spins);
+			}
+		}
+
+		return succeeded;
+	}
+
+	void ShardedSimulation::DrainMigrations(uint64_t step)
+	{
+		// Arrivals a full shard could not take are still in their rings. Every worker is idle between phases, so the
+		// coordinator places them: with the shard they were sent to if it has room now, or else back with the shard
+		// that sent them, outside its slab, to migrate again the next step.
+		uint32_t nextBuffer = 1 - static_cast<uint32_t>(step % 2);
+		for (uint32_t shard = 0; shard < mSettings.ShardCount; ++shard)
+		{
+			for (uint32_t direction = 0; direction < 2; ++direction)
+			{
+				ShardDirection to = static_cast<ShardDirection>(direction);
+				bool hasNeighbour = (to == ShardDirection::Left ? shard > 0 : shard + 1 < mSettings.ShardCount);
+				uint32_t neighbour = (to == ShardDirection::Left ? shard - 1 : shard + 1);
+
+				SpscRingBuffer<ShardParticle> ring(mLayout->Ring(ShardRing::Migration, shard, to));
+				ShardParticle particle;
+				while (ring.Peek(&particle, 1) == 1)
+				{
+					uint32_t owner = (hasNeighbour && mLayout->State(neighbour).ParticleCounts[nextBuffer] < mSettings.MaxParticlesPerShard ? neighbour : shard);
+					ShardState& state = mLayout->State(owner);
+					if (state.ParticleCounts[nextBuffer] == mSettings.MaxParticlesPerShard)
+					{
+						throw GameException("Too many particles for the shard capacity.");
+					}
+
+					mLayout->Particles(owner, nextBuffer)[state.ParticleCounts[nextBuffer]++] = particle;
+					ring.Consume(1);
+				}
+			}
+		}
+	}
+
+	void ShardedSimulation::ResetRings()
+	{
+		for (uint32_t shard = 0; shard < mSettings.ShardCount; ++shard)
+		{
+			for (uint32_t ring = 0; ring < 2; ++ring)
+			{
+				for (uint32_t direction = 0; direction < 2; ++direction)
+				{
+					SpscRingBuffer<ShardParticle>(mLayout->Ring(static_cast<ShardRing>(ring), shard, static_cast<ShardDirection>(direction))).Reset();
+				}
+			}
+		}
+	}
+
+	void ShardedSimulation::GatherSnapshot()
+	{
+		uint32_t buffer = static_cast<uint32_t>(CommittedStep() % 2);
+
+		mSnapshot.clear();
+		for (uint32_t shard = 0; shard < mSettings.ShardCount; ++shard)
+		{
+			const ShardParticle* particles = mLayout->Particles(shard, buffer);
+			mSnapshot.insert(mSnapshot.end(), particles, particles + mLayout->State(shard).ParticleCounts[buffer]);
+		}
+	}
+
+	void ShardedSimulation::StopWorkers()
+	{
+		ShardedSimulationHeader& header = mLayout->Header();
+		header.Phase = ShardPhase::Stop;
+		header.Ticket.fetch_add(1, memory_order_release);
+
+#if defined(_WIN32)
+		for (HANDLE& worker : mWorkers)
+		{
+			if (worker != nullptr)
+			{
+				if (WaitForSingleObject(worker, WorkerShutdownMilliseconds) != WAIT_OBJECT_0)
+				{
+					TerminateProcess(worker, 1);
+				}
+
+				CloseHandle(worker);
+				worker = nullptr;
+			}
+		}
+#else
+		for (pid_t& worker : mWorkers)
+		{
+			if (worker > 0)
+			{
+				auto deadline = chrono::steady_clock::now() + chrono::milliseconds(WorkerShutdownMilliseconds);
+				while (waitpid(worker, nullptr, WNOHANG) == 0)
+				{
+					if (chrono::steady_clock::now() >= deadline)
+					{
+						kill(worker, SIGKILL);
+						waitpid(worker, nullptr, 0);
+						break;
+					}
+
+					this_thread::sleep_for(chrono::milliseconds(1));
+				}
+
+				worker = -1;
+			}
+		}
+#endif
+	}
+
+#pragma endregion
+
+#pragma region ShardWorker
+
+	int ShardWorker::Run(const wstring& regionName, uint32_t shard, uint32_t coordinatorProcessId)
+	{
+		ProcessWatch coordinator(coordinatorProcessId);
+		if (coordinator.IsValid() == false)
+		{
+			return 1;
+		}
+
+		PinToNumaNode(shard);
+
+		SharedMemoryRegion region = SharedMemoryRegion::Open(regionName);
+		const ShardedSimulationHeader* header = reinterpret_cast<const ShardedSimulationHeader*>(region.Data());
+		if (header->Magic != ShardedSimulationLayout::Magic || header->Version != ShardedSimulationLayout::Version || shard >= header->Settings.ShardCount)
+		{
+			throw GameException("Invalid sharded simulation region.");
+		}
+
+		ShardedSimulationLayout layout(region.Data(), header->Settings);
+		ShardWorker worker(layout, shard);
+		ShardState& state = layout.State(shard);
+		uint64_t lastTicket = state.CompletedTicket.load(memory_order_acquire);
+
+		for (;;)
+		{
+			uint32_t spins = 0;
+			uint64_t ticket;
+			while ((ticket = layout.Header().Ticket.load(memory_order_acquire)) == lastTicket)
+			{
+				if (spins >= SpinsBeforeYield && coordinator.HasExited())
+				{
+					return 0;
+				}
+
+				Backoff(spins);
+			}
+
+			lastTicket = ticket;
+			ShardPhase phase = layout.Header().Phase;
+			uint32_t buffer = static_cast<uint32_t>(layout.Header().Step % 2);
+
+			switch (phase)
+			{
+			case ShardPhase::Exchange:
+				worker.Exchange(buffer);
+				break;
+
+			case ShardPhase::Integrate:
+				worker.Integrate(buffer);
+				break;
+
+			case ShardPhase::Migrate:
+				worker.Migrate(buffer);
+				break;
+
+			case ShardPhase::Stop:
+				return 0;
+			}
+
+			state.CompletedTicket.store(ticket, memory_order_release);
+		}
+	}
+
+	ShardWorker::ShardWorker(const ShardedSimulationLayout& layout, uint32_t shard) :
+		mLayout(&layout), mSettings(layout.Header().Settings), mShard(shard)
+	{
+		mLocal.reserve(mSettings.MaxParticlesPerShard);
+		mAccelerations.reserve(mSettings.MaxParticlesPerShard * 3);
+	}
+
+	void ShardWorker::Exchange(uint32_t buffer)
+	{
+		LoadLocal(buffer);
+
+		ShardState& state = mLayout->State(mShard);
+		double mass = 0.0;
+		double moment[3] = { 0.0, 0.0, 0.0 };
+		for (const ShardParticle& particle : mLocal)
+		{
+			mass += particle.Mass;
+			for (uint32_t axis = 0; axis < 3; ++axis)
+			{
+				moment[axis] += particle.Mass * particle.Position[axis];
+			}
+		}
+
+		state.Mass = mass;
+		for (uint32_t axis = 0; axis < 3; ++axis)
+		{
+			state.CenterOfMass[axis] = (mass > 0.0 ? moment[axis] / mass : 0.0);
+		}
+
+		// Particles within the ghost margin of a slab boundary are sent to the neighbour across it
+		for (uint32_t direction = 0; direction < 2; ++direction)
+		{
+			ShardDirection to = static_cast<ShardDirection>(direction);
+			if (HasNeighbour(to) == false)
+			{
+				continue;
+			}
+
+			vector<ShardParticle>& outgoing = mOutgoing[direction];
+			outgoing.clear();
+			for (const ShardParticle& particle : mLocal)
+			{
+				bool nearBoundary = (to == ShardDirection::Left ? particle.Position[0] < state.MinX + mSettings.GhostMargin : particle.Position[0] > state.MaxX - mSettings.GhostMargin);
+				if (nearBoundary)
+				{
+					outgoing.push_back(particle);
+				}
+			}
+
+			OutgoingRing(ShardRing::Ghost, to).Push(outgoing.data(), static_cast<uint32_t>(outgoing.size()));
+		}
+	}
+
+	void ShardWorker::Integrate(uint32_t buffer)
+	{
+		LoadLocal(buffer);
+
+		const double softeningSquared = mSettings.Softening * mSettings.Softening;
+		const double timeStep = mSettings.TimeStepDays;
+		ShardState& state = mLayout->State(mShard);
+
+		uint32_t ghostCounts[2] = { 0, 0 };
+		for (uint32_t direction = 0; direction < 2; ++direction)
+		{
+			ShardDirection from = static_cast<ShardDirection>(direction);
+			mGhosts[direction].clear();
+			if (HasNeighbour(from))
+			{
+				SpscRingBuffer<ShardParticle> ring = IncomingRing(ShardRing::Ghost, from);
+				mGhosts[direction].resize(ring.Capacity());
+				ghostCounts[direction] = ring.Peek(mGhosts[direction].data(), ring.Capacity());
+				mGhosts[direction].resize(ghostCounts[direction]);
+			}
+		}
+
+		// Direct sums over local particles and ghosts; every other shard acts through its centre of mass.
+		// A neighbour's ghosts are subtracted from its monopole so their mass is not counted twice.
+		size_t count = mLocal.size();
+		mAccelerations.assign(count * 3, 0.0);
+		for (uint32_t shard = 0; shard < mSettings.ShardCount; ++shard)
+		{
+			if (shard == mShard)
+			{
+				continue;
+			}
+
+			const ShardState& other = mLayout->State(shard);
+			double mass = other.Mass;
+			double moment[3] = { other.CenterOfMass[0] * mass, other.CenterOfMass[1] * mass, other.CenterOfMass[2] * mass };
+
+			const vector<ShardParticle>* ghosts = (shard + 1 == mShard ? &mGhosts[static_cast<uint32_t>(ShardDirection::Left)] : (shard == mShard + 1 ? &mGhosts[static_cast<uint32_t>(ShardDirection::Right)] : nullptr));
+			if (ghosts != nullptr)
+			{
+				for (const ShardParticle& ghost : *ghosts)
+				{
+					mass -= ghost.Mass;
+					for (uint32_t axis = 0; axis < 3; ++axis)
+					{
+						moment[axis] -= ghost.Mass * ghost.Position[axis];
+					}
+				}
+			}
+
+			if (mass <= 0.0)
+			{
+				continue;
+			}
+
+			double centerOfMass[3] = { moment[0] / mass, moment[1] / mass, moment[2] / mass };
+			for (size_t i = 0; i < count; ++i)
+			{
+				AddAcceleration(mLocal[i].Position, centerOfMass, mass, softeningSquared, &mAccelerations[i * 3]);
+			}
+		}
+
+		for (size_t i = 0; i < count; ++i)
+		{
+			double* acceleration = &mAccelerations[i * 3];
+			for (size_t j = 0; j < count; ++j)
+			{
+				if (i != j)
+				{
+					AddAcceleration(mLocal[i].Position, mLocal[j].Position, mLocal[j].Mass, softeningSquared, acceleration);
+				}
+			}
+
+			for (const vector<ShardParticle>& ghosts : mGhosts)
+			{
+				for (const ShardParticle& ghost : ghosts)
+				{
+					AddAcceleration(mLocal[i].Position, ghost.Position, ghost.Mass, softeningSquared, acceleration);
+				}
+			}
+		}
+
+		// Kick then drift, writing the next buffer; particles that crossed a boundary migrate to the neighbour
+		uint32_t nextBuffer = 1 - buffer;
+		ShardParticle* next = mLayout->Particles(mShard, nextBuffer);
+		uint32_t kept = 0;
+		mOutgoing[0].clear();
+		mOutgoing[1].clear();
+
+		for (size_t i = 0; i < count; ++i)
+		{
+			ShardParticle particle = mLocal[i];
+			for (uint32_t axis = 0; axis < 3; ++axis)
+			{
+				particle.Velocity[axis] += mAccelerations[i * 3 + axis] * timeStep;
+				particle.Position[axis] += particle.Velocity[axis] * timeStep;
+			}
+
+			if (particle.Position[0] < state.MinX)
+			{
+				mOutgoing[static_cast<uint32_t>(ShardDirection::Left)].push_back(particle);
+			}
+			else if (particle.Position[0] >= state.MaxX)
+			{
+				mOutgoing[static_cast<uint32_t>(ShardDirection::Right)].push_back(particle);
+			}
+			else
+			{
+				next[kept++] = particle;
+			}
+		}
+
+		for (uint32_t direction = 0; direction < 2; ++direction)
+		{
+			vector<ShardParticle>& outgoing = mOutgoing[direction];
+			uint32_t outgoingCount = static_cast<uint32_t>(outgoing.size());
+			uint32_t pushed = (outgoingCount > 0 ? OutgoingRing(ShardRing::Migration, static_cast<ShardDirection>(direction)).Push(outgoing.data(), outgoingCount) : 0);
+
+			// A full ring leaves the remainder here for a step; they are still simulated, just outside their slab
+			for (uint32_t i = pushed; i < outgoingCount; ++i)
+			{
+				next[kept++] = outgoing[i];
+			}
+		}
+
+		state.ParticleCounts[nextBuffer] = kept;
+
+		for (uint32_t direction = 0; direction < 2; ++direction)
+		{
+			if (ghostCounts[direction] > 0)
+			{
+				IncomingRing(ShardRing::Ghost, static_cast<ShardDirection>(direction)).Consume(ghostCounts[direction]);
+			}
+		}
+	}
+
+	void ShardWorker::Migrate(uint32_t buffer)
+	{
+		uint32_t nextBuffer = 1 - buffer;
+		ShardState& state = mLayout->State(mShard);
+		ShardParticle* next = mLayout->Particles(mShard, nextBuffer);
+		uint32_t count = state.ParticleCounts[nextBuffer];
+
+		for (uint32_t direction = 0; direction < 2; ++direction)
+		{
+			ShardDirection from = static_cast<ShardDirection>(direction);
+			if (HasNeighbour(from))
+			{
+				// Arrivals that do not fit are left for the coordinator to place once the step is done
+				SpscRingBuffer<ShardParticle> ring = IncomingRing(ShardRing::Migration, from);
+				uint32_t arrived = ring.Peek(next + count, mSettings.MaxParticlesPerShard - count);
+				ring.Consume(arrived);
+				count += arrived;
+			}
+		}
+
+		state.ParticleCounts[nextBuffer] = count;
+	}
+
+	void ShardWorker::LoadLocal(uint32_t buffer)
+	{
+		const ShardParticle* particles = mLayout->Particles(mShard, buffer);
+		mLocal.assign(particles, particles + mLayout->State(mShard).ParticleCounts[buffer]);
+	}
+
+	SpscRingBuffer<ShardParticle> ShardWorker::IncomingRing(ShardRing ring, ShardDirection from) const
+	{
+		uint32_t neighbour = (from == ShardDirection::Left ? mShard - 1 : mShard + 1);
+		return SpscRingBuffer<ShardParticle>(mLayout->Ring(ring, neighbour, Opposite(from)));
+	}
+
+	SpscRingBuffer<ShardParticle> ShardWorker::OutgoingRing(ShardRing ring, ShardDirection to) const
+	{
+		return SpscRingBuffer<ShardParticle>(mLayout->Ring(ring, mShard, to));
+	}
+
+	bool ShardWorker::HasNeighbour(ShardDirection direction) const
+	{
+		return (direction == ShardDirection::Left ? mShard > 0 : mShard + 1 < mSettings.ShardCount);
+	}
+
+#if defined(_WIN32)
+	void ShardWorker::PinToNumaNode(uint32_t shard)
+	{
+		ULONG highestNode = 0;
+		if (GetNumaHighestNodeNumber(&highestNode) && highestNode > 0)
+		{
+			USHORT node = static_cast<USHORT>(shard % (highestNode + 1));
+			GROUP_AFFINITY affinity = { 0 };
+			if (GetNumaNodeProcessorMaskEx(node, &affinity) && affinity.Mask != 0)
+			{
+				SetThreadGroupAffinity(GetCurrentThread(), &affinity, nullptr);
+			}
+		}
+	}
+
+#elif defined(__linux__)
+	void ShardWorker::PinToNumaNode(uint32_t shard)
+	{
+		// Linux lists the nodes, and the processors of each as ranges such as 0-15,32-47, under sysfs
+		const string nodeDirectory = "/sys/devices/system/node/node";
+		uint32_t nodeCount = 0;
+		while (access((nodeDirectory + to_string(nodeCount)).c_str(), F_OK) == 0)
+		{
+			++nodeCount;
+		}
+
+		if (nodeCount < 2)
+		{
+			return;
+		}
+
+		ifstream processorList(nodeDirectory + to_string(shard % nodeCount) + "/cpulist");
+		cpu_set_t affinity;
+		CPU_ZERO(&affinity);
+		string range;
+		while (getline(processorList, range, ','))
+		{
+			if (range.find_first_of("0123456789") == string::npos)
+			{
+				continue;
+			}
+
+			size_t separator = range.find('-');
+			unsigned long first = stoul(range);
+			unsigned long last = (separator == string::npos ? first : stoul(range.substr(separator + 1)));
+			for (unsigned long processor = first; processor <= last && processor < CPU_SETSIZE; ++processor)
+			{
+				CPU_SET(processor, &affinity);
+			}
+		}
+
+		if (CPU_COUNT(&affinity) > 0)
+		{
+			sched_setaffinity(0, sizeof(affinity), &affinity);
+		}
+	}
+#else
+	void ShardWorker::PinToNumaNode(uint32_t shard)
+	{
+		UNREFERENCED_PARAMETER(shard);
+	}
+#endif
+
+#pragma endregion
+}
\ No newline at end of file
@@ -0,0 +1,227 @@
+#pragma once
+
+#include "SharedMemoryRegion.h"
+#include "SpscRingBuffer.h"
+#include <atomic>
+#include <vector>
+#include <memory>
+#include <string>
+#include <cstdint>
+
+namespace Library
+{
+	class BodyCatalog;
+}
+
+namespace Rendering
+{
+	/**
+	* A particle owned by one shard. Positions are in astronomical units, velocities in astronomical units per day.
+	*/
+	struct ShardParticle
+	{
+		double Position[3];
+		double Velocity[3];
+		double Mass;				// Earth masses
+		std::uint32_t Id;
+		std::uint32_t Reserved;
+	};
+
+	static_assert(sizeof(ShardParticle) == 64, "ShardParticle must fill a cache line.");
+
+	struct ShardedSimulationSettings
+	{
+		std::uint32_t ShardCount;
+		std::uint32_t MaxParticlesPerShard;
+		std::uint32_t RingCapacity;		// Power of two
+		double TimeStepDays;
+		double GhostMargin;				// Astronomical units
+		double Softening;				// Astronomical units
+	};
+
+	enum class ShardPhase : std::uint32_t
+	{
+		Exchange,
+		Integrate,
+		Migrate,
+		Stop
+	};
+
+	enum class ShardRing : std::uint32_t
+	{
+		Ghost,
+		Migration
+	};
+
+	enum class ShardDirection : std::uint32_t
+	{
+		Left,
+		Right
+	};
+
+	/**
+	* The coordinator's dispatch state. A worker runs a phase whenever Ticket changes, then echoes the ticket back in its ShardState.
+	*/
+	struct alignas(64) ShardedSimulationHeader
+	{
+		std::uint32_t Magic;
+		std::uint32_t Version;
+		ShardedSimulationSettings Settings;
+		ShardPhase Phase;
+		std::uint64_t Step;
+		std::atomic<std::uint64_t> Ticket;
+		std::atomic<std::uint64_t> CommittedStep;
+	};
+
+	/**
+	* The per-shard state. Particles are double-buffered by step so an interrupted step can be replayed from the committed buffer.
+	*/
+	struct alignas(64) ShardState
+	{
+		std::atomic<std::uint64_t> CompletedTicket;
+		std::uint32_t ParticleCounts[2];
+		double MinX;
+		double MaxX;
+		double Mass;
+		double CenterOfMass[3];
+	};
+
+	/**
+	* Locates the header, shard states, particle buffers and rings inside a shared memory region.
+	* The coordinator and the workers compute identical offsets from the settings in the header.
+	*/
+	class ShardedSimulationLayout final
+	{
+	public:
+		ShardedSimulationLayout(void* memory, const ShardedSimulationSettings& settings);
+
+		static std::size_t RequiredSize(const ShardedSimulationSettings& settings);
+
+		ShardedSimulationHeader& Header() const;
+		ShardState& State(std::uint32_t shard) const;
+		ShardParticle* Particles(std::uint32_t shard, std::uint32_t buffer) const;
+		/**
+		* Get the ring a shard produces into for its neighbour in the given direction.
+		*/
+		void* Ring(ShardRing ring, std::uint32_t shard, ShardDirection direction) const;
+
+		static const std::uint32_t Magic;
+		static const std::uint32_t Version;
+
+	private:
+		std::uint8_t* mMemory;
+		ShardedSimulationSettings mSettings;
+		std::size_t mStatesOffset;
+		std::size_t mParticlesOffset;
+		std::size_t mRingsOffset;
+		std::size_t mRingSize;
+	};
+
+	/**
+	* Runs a particle simulation across worker processes, one per slab of space along the x axis.
+	* Particle state lives in a named shared memory region; neighbouring shards exchange ghost particles and
+	* migrating particles through lock-free rings, and every step advances through a coordinator-driven barrier.
+	* A worker that dies mid-step is relaunched and the step is replayed from the last committed state. No migrant is
+	* left in a ring when a step commits, so the particle buffers alone hold that state.
+	*/
+	class ShardedSimulation final
+	{
+	public:
+		ShardedSimulation(const ShardedSimulationSettings& settings, std::vector<ShardParticle> particles);
+		ShardedSimulation(const ShardedSimulation&) = delete;
+		ShardedSimulation& operator=(const ShardedSimulation&) = delete;
+		ShardedSimulation(ShardedSimulation&&) = delete;
+		ShardedSimulation& operator=(ShardedSimulation&&) = delete;
+		~ShardedSimulation();
+
+		/**
+		* Advance every shard by one time step and gather a consistent snapshot.
+		*/
+		void Step();
+
+		std::uint64_t CommittedStep() const;
+		std::uint32_t RestartCount() const;
+		/**
+		* Get the process running a shard, to watch or stop it from outside.
+		*/
+		std::uint32_t WorkerProcessId(std::uint32_t shard) const;
+		/**
+		* Get every particle as of the last committed step, ordered by shard.
+		*/
+		const std::vector<ShardParticle>& Snapshot() const;
+		/**
+		* Write the last snapshot to a CSV file, one particle per line.
+		*/
+		void WriteSnapshot(const std::wstring& filename) const;
+
+		/**
+		* Build the particles of a catalog: the light source at rest at the origin and the bodies that circle it directly
+		* on circular orbits, where SolarSystemSimulation starts them, followed by a belt of massless particles on random
+		* circular orbits between 2.1 and 3.3 astronomical units.
+		*/
+		static std::vector<ShardParticle> FromCatalog(const Library::BodyCatalog& catalog, std::uint32_t beltCount, std::uint32_t seed);
+
+		/**
+		* The command line switch that starts a process as a shard worker.
+		*/
+		static const std::wstring WorkerSwitch;
+
+	private:
+		void LaunchWorker(std::uint32_t shard);
+		bool HasWorkerExited(std::uint32_t shard);
+		bool RunPhase(ShardPhase phase, std::uint64_t step);
+		void DrainMigrations(std::uint64_t step);
+		void ResetRings();
+		void GatherSnapshot();
+		void StopWorkers();
+
+		ShardedSimulationSettings mSettings;
+		Library::SharedMemoryRegion mRegion;
+		std::unique_ptr<ShardedSimulationLayout> mLayout;
+#if defined(_WIN32)
+		std::vector<HANDLE> mWorkers;
+#else
+		std::vector<pid_t> mWorkers;
+#endif
+		std::vector<ShardParticle> mSnapshot;
+		std::uint32_t mRestartCount;
+	};
+
+	/**
+	* The body of a shard worker process.
+	*/
+	class ShardWorker final
+	{
+	public:
+		/**
+		* Attach to a simulation region and serve phases until the coordinator stops or exits.
+		* @param regionName The name of the shared memory region.
+		* @param shard The index of the shard to simulate.
+		* @param coordinatorProcessId The process to watch; the worker exits when it does.
+		* @return The process exit code.
+		*/
+		static int Run(const std::wstring& regionName, std::uint32_t shard, std::uint32_t coordinatorProcessId);
+
+	private:
+		ShardWorker(const ShardedSimulationLayout& layout, std::uint32_t shard);
+
+		void Exchange(std::uint32_t buffer);
+		void Integrate(std::uint32_t buffer);
+		void Migrate(std::uint32_t buffer);
+		void LoadLocal(std::uint32_t buffer);
+		Library::SpscRingBuffer<ShardParticle> IncomingRing(ShardRing ring, ShardDirection from) const;
+		Library::SpscRingBuffer<ShardParticle> OutgoingRing(ShardRing ring, ShardDirection to) const;
+		bool HasNeighbour(ShardDirection direction) const;
+		static void PinToNumaNode(std::uint32_t shard);
+
+		const ShardedSimulationLayout* mLayout;
+		ShardedSimulationSettings mSettings;
+		std::uint32_t mShard;
+
+		// Private working copies, first touched after the worker is pinned so they are local to its node
+		std::vector<ShardParticle> mLocal;
+		std::vector<ShardParticle> mGhosts[2];
+		std::vector<ShardParticle> mOutgoing[2];
+		std::vector<double> mAccelerations;
+	};
+}
\ No newline at end of file
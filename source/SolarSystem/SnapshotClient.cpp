@@ -0,0 +1,106 @@
+#include "pch.h"
+
+using namespace std;
+using namespace Library;
+
+namespace Rendering
+{
+	const uint32_t SnapshotClient::MaxHistory = 64;
+
+	SnapshotClient::SnapshotClient(uint32_t bodyCount, const wstring& address) :
+		mConnection(SnapshotTransport::Connect(address)), mVisible(bodyCount, false), mTick(0)
+	{
+	}
+
+	SnapshotClient::~SnapshotClient()
+	{
+	}
+
+	bool SnapshotClient::Update(SolarSystemSimulation& simulation, const DoubleVector3& cameraPosition, double interestRadius)
+	{
+		bool received = false;
+		for (;;)
+		{
+			bool messageReceived = false;
+			if (mConnection->TryReceive(mBuffer, messageReceived) == false)
+			{
+				return false;
+			}
+
+			if (messageReceived == false)
+			{
+				break;
+			}
+
+			uint32_t tick;
+			uint32_t baselineTick;
+			SnapshotCodec::ReadHeader(mBuffer.data(), mBuffer.size(), tick, baselineTick);
+
+			// The server only encodes against ticks this client acknowledged, so older frames are no longer needed
+			while (mHistory.empty() == false && mHistory.front().Tick < baselineTick)
+			{
+				mHistory.pop_front();
+			}
+
+			const SnapshotFrame* baseline = nullptr;
+			if (baselineTick != 0)
+			{
+				if (mHistory.empty() || mHistory.front().Tick != baselineTick)
+				{
+					continue;
+				}
+
+				baseline = &mHistory.front();
+			}
+
+			SnapshotFrame frame;
+			SnapshotCodec::Decode(mBuffer.data(), mBuffer.size(), baseline, frame);
+			mHistory.push_back(move(frame));
+			if (mHistory.size() > MaxHistory)
+			{
+				mHistory.pop_front();
+			}
+
+			received = true;
+		}
+
+		if (received == false)
+		{
+			return true;
+		}
+
+		const SnapshotFrame& latest = mHistory.back();
+		fill(mVisible.begin(), mVisible.end(), false);
+		size_t count = latest.Indices.size();
+		for (size_t i = 0; i < count; ++i)
+		{
+			uint32_t index = latest.Indices[i];
+			if (index < mVisible.size())
+			{
+				simulation.SetBodyState(index, SnapshotCodec::DequantizePosition(latest.States[i]), SnapshotCodec::DequantizeRotation(latest.States[i]));
+				mVisible[index] = true;
+			}
+		}
+
+		mTick = latest.Tick;
+
+		ViewerMessage message = { 0 };
+		message.AckTick = mTick;
+		message.CameraPosition[0] = cameraPosition.x;
+		message.CameraPosition[1] = cameraPosition.y;
+		message.CameraPosition[2] = cameraPosition.z;
+		message.InterestRadius = interestRadius;
+
+		return mConnection->Send(&message, sizeof(message));
+	}
+
+	bool SnapshotClient::Visible(uint32_t index) const
+	{
+		return mVisible[index];
+	}
+
+	uint32_t SnapshotClient::Tick() const
+	{
+		return mTick;
+	}
+}
\ No newline at end of file
@@ -0,0 +1,51 @@
+#pragma once
+
+#include "SnapshotCodec.h"
+#include "SnapshotTransport.h"
+#include <string>
+#include <vector>
+#include <deque>
+
+namespace Rendering
+{
+	class SolarSystemSimulation;
+	struct DoubleVector3;
+
+	/**
+	* Receives snapshots from a SnapshotServer and applies them to a local simulation in place of running it.
+	*/
+	class SnapshotClient final
+	{
+	public:
+		SnapshotClient(std::uint32_t bodyCount, const std::wstring& address);
+		SnapshotClient(const SnapshotClient&) = delete;
+		SnapshotClient& operator=(const SnapshotClient&) = delete;
+		SnapshotClient(SnapshotClient&&) = delete;
+		SnapshotClient& operator=(SnapshotClient&&) = delete;
+		~SnapshotClient();
+
+		/**
+		* Decode every pending snapshot, apply the newest to the simulation and acknowledge it along with the camera position.
+		* @param simulation The simulation to overwrite.
+		* @param cameraPosition The camera position in world scene units.
+		* @param interestRadius The distance from the camera, in scene units, within which bodies are wanted. Zero for every body.
+		* @return False if the connection to the server was lost.
+		*/
+		bool Update(SolarSystemSimulation& simulation, const DoubleVector3& cameraPosition, double interestRadius);
+
+		/**
+		* Get whether a body was part of the last applied snapshot.
+		*/
+		bool Visible(std::uint32_t index) const;
+		std::uint32_t Tick() const;
+
+	private:
+		static const std::uint32_t MaxHistory;
+
+		std::unique_ptr<SnapshotConnection> mConnection;
+		std::deque<SnapshotFrame> mHistory;
+		std::vector<std::uint8_t> mBuffer;
+		std::vector<bool> mVisible;
+		std::uint32_t mTick;
+	};
+}
\ No newline at end of file
@@ -0,0 +1,319 @@
+#include "pch.h"
+
+using namespace std;
+using namespace Library;
+
+namespace Rendering
+{
+	namespace
+	{
+		enum FieldMask : uint8_t
+		{
+			PositionX = 0x01,
+			PositionY = 0x02,
+			PositionZ = 0x04,
+			Rotation = 0x08,
+			Added = 0x10
+		};
+
+		const QuantizedBodyState ZeroState = { { 0, 0, 0 }, 0 };
+
+		void WriteUInt32(vector<uint8_t>& message, uint32_t value)
+		{
+			for (uint32_t i = 0; i < 4; ++i)
+			{
+				message.push_back(static_cast<uint8_t>(value >> (i * 8)));
+			}
+		}
+
+		void WriteVarint(vector<uint8_t>& message, uint64_t value)
+		{
+			while (value >= 0x80)
+			{
+				message.push_back(static_cast<uint8_t>(value | 0x80));
+				value >>= 7;
+			}
+
+			message.push_back(static_cast<uint8_t>(value));
+		}
+
+		void WriteSignedVarint(vector<uint8_t>& message, int64_t value)
+		{
+			WriteVarint(message, (static_cast<uint64_t>(value) << 1) ^ static_cast<uint64_t>(value >> 63));
+		}
+
+		class MessageReader final
+		{
+		public:
+			MessageReader(const uint8_t* data, size_t size) :
+				mData(data), mSize(size), mOffset(0)
+			{
+			}
+
+			uint8_t ReadByte()
+			{
+				if (mOffset >= mSize)
+				{
+					throw GameException("Snapshot message is truncated.");
+				}
+
+				return mData[mOffset++];
+			}
+
+			uint32_t ReadUInt32()
+			{
+				uint32_t value = 0;
+				for (uint32_t i = 0; i < 4; ++i)
+				{
+					value |= static_cast<uint32_t>(ReadByte()) << (i * 8);
+				}
+
+				return value;
+			}
+
+			uint64_t ReadVarint()
+			{
+				uint64_t value = 0;
+				for (uint32_t shift = 0; shift < 64; shift += 7)
+				{
+					uint8_t byte = ReadByte();
+					value |= static_cast<uint64_t>(byte & 0x7F) << shift;
+					if ((byte & 0x80) == 0)
+					{
+						return value;
+					}
+				}
+
+				throw GameException("Snapshot message has an invalid varint.");
+			}
+
+			int64_t ReadSignedVarint()
+			{
+				uint64_t value = ReadVarint();
+				return static_cast<int64_t>(value >> 1) ^ -static_cast<int64_t>(value & 1);
+			}
+
+		private:
+			const uint8_t* mData;
+			size_t mSize;
+			size_t mOffset;
+		};
+
+		// Rotation wraps, so its delta is the shortest way around the circle
+		int32_t RotationDelta(int32_t from, int32_t to)
+		{
+			int32_t delta = (to - from) % SnapshotCodec::RotationSteps;
+			if (delta > SnapshotCodec::RotationSteps / 2)
+			{
+				delta -= SnapshotCodec::RotationSteps;
+			}
+			else if (delta < -SnapshotCodec::RotationSteps / 2)
+			{
+				delta += SnapshotCodec::RotationSteps;
+			}
+
+			return delta;
+		}
+
+		void WriteEntry(vector<uint8_t>& entries, uint32_t& previousIndex, uint32_t index, const QuantizedBodyState& from, const QuantizedBodyState& to, uint8_t mask, uint32_t& entryCount)
+		{
+			for (uint32_t axis = 0; axis < 3; ++axis)
+			{
+				if (to.Position[axis] != from.Position[axis])
+				{
+					mask |= static_cast<uint8_t>(PositionX << axis);
+				}
+			}
+
+			if (to.Rotation != from.Rotation)
+			{
+				mask |= Rotation;
+			}
+
+			if (mask == 0)
+			{
+				return;
+			}
+
+			WriteVarint(entries, index - previousIndex);
+			entries.push_back(mask);
+			for (uint32_t axis = 0; axis < 3; ++axis)
+			{
+				if (mask & (PositionX << axis))
+				{
+					WriteSignedVarint(entries, static_cast<int64_t>(to.Position[axis]) - from.Position[axis]);
+				}
+			}
+
+			if (mask & Rotation)
+			{
+				WriteSignedVarint(entries, RotationDelta(from.Rotation, to.Rotation));
+			}
+
+			previousIndex = index;
+			++entryCount;
+		}
+	}
+
+	const double SnapshotCodec::PositionQuantum = 1.0 / 1024.0;
+	const int32_t SnapshotCodec::RotationSteps = 65536;
+
+	QuantizedBodyState SnapshotCodec::Quantize(const DoubleVector3& position, double rotationDegrees)
+	{
+		QuantizedBodyState state;
+		state.Position[0] = static_cast<int32_t>(llround(position.x / PositionQuantum));
+		state.Position[1] = static_cast<int32_t>(llround(position.y / PositionQuantum));
+		state.Position[2] = static_cast<int32_t>(llround(position.z / PositionQuantum));
+		state.Rotation = static_cast<int32_t>(llround(rotationDegrees / 360.0 * RotationSteps)) & (RotationSteps - 1);
+
+		return state;
+	}
+
+	DoubleVector3 SnapshotCodec::DequantizePosition(const QuantizedBodyState& state)
+	{
+		return DoubleVector3(state.Position[0] * PositionQuantum, state.Position[1] * PositionQuantum, state.Position[2] * PositionQuantum);
+	}
+
+	double SnapshotCodec::DequantizeRotation(const QuantizedBodyState& state)
+	{
+		return state.Rotation * 360.0 / RotationSteps;
+	}
+
+	void SnapshotCodec::Encode(const SnapshotFrame& frame, const SnapshotFrame* baseline, vector<uint8_t>& message)
+	{
+		static const SnapshotFrame EmptyFrame;
+		const SnapshotFrame& from = (baseline != nullptr ? *baseline : EmptyFrame);
+
+		// Merge the sorted index lists of the baseline and the frame
+		vector<uint8_t> removals;
+		vector<uint8_t> entries;
+		uint32_t removalCount = 0;
+		uint32_t entryCount = 0;
+		uint32_t previousRemoval = 0;
+		uint32_t previousEntry = 0;
+
+		size_t i = 0;
+		size_t j = 0;
+		while (i < from.Indices.size() || j < frame.Indices.size())
+		{
+			if (j == frame.Indices.size() || (i < from.Indices.size() && from.Indices[i] < frame.Indices[j]))
+			{
+				WriteVarint(removals, from.Indices[i] - previousRemoval);
+				previousRemoval = from.Indices[i];
+				++removalCount;
+				++i;
+			}
+			else if (i == from.Indices.size() || frame.Indices[j] < from.Indices[i])
+			{
+				WriteEntry(entries, previousEntry, frame.Indices[j], ZeroState, frame.States[j], Added, entryCount);
+				++j;
+			}
+			else
+			{
+				WriteEntry(entries, previousEntry, frame.Indices[j], from.States[i], frame.States[j], 0, entryCount);
+				++i;
+				++j;
+			}
+		}
+
+		message.clear();
+		WriteUInt32(message, frame.Tick);
+		WriteUInt32(message, (baseline != nullptr ? baseline->Tick : 0));
+		WriteVarint(message, removalCount);
+		message.insert(message.end(), removals.begin(), removals.end());
+		WriteVarint(message, entryCount);
+		message.insert(message.end(), entries.begin(), entries.end());
+	}
+
+	void SnapshotCodec::ReadHeader(const uint8_t* data, size_t size, uint32_t& tick, uint32_t& baselineTick)
+	{
+		MessageReader reader(data, size);
+		tick = reader.ReadUInt32();
+		baselineTick = reader.ReadUInt32();
+	}
+
+	void SnapshotCodec::Decode(const uint8_t* data, size_t size, const SnapshotFrame* baseline, SnapshotFrame& frame)
+	{
+		static const SnapshotFrame EmptyFrame;
+		const SnapshotFrame& from = (baseline != nullptr ? *baseline : EmptyFrame);
+
+		MessageReader reader(data, size);
+		frame.Tick = reader.ReadUInt32();
+		if (reader.ReadUInt32() != from.Tick)
+		{
+			throw GameException("Snapshot message does not match its baseline.");
+		}
+
+		uint64_t removalCount = reader.ReadVarint();
+		vector<uint32_t> removals;
+		removals.reserve(static_cast<size_t>(min<uint64_t>(removalCount, from.Indices.size())));
+		uint32_t index = 0;
+		for (uint64_t r = 0; r < removalCount; ++r)
+		{
+			index += static_cast<uint32_t>(reader.ReadVarint());
+			removals.push_back(index);
+		}
+
+		// Walk the baseline and the changed entries together, both sorted by index
+		frame.Indices.clear();
+		frame.States.clear();
+		size_t i = 0;
+		size_t removal = 0;
+		uint64_t entryCount = reader.ReadVarint();
+		index = 0;
+
+		auto copyBaselineUpTo = [&](uint64_t limit)
+		{
+			while (i < from.Indices.size() && from.Indices[i] < limit)
+			{
+				if (removal < removals.size() && removals[removal] == from.Indices[i])
+				{
+					++removal;
+				}
+				else
+				{
+					frame.Indices.push_back(from.Indices[i]);
+					frame.States.push_back(from.States[i]);
+				}
+
+				++i;
+			}
+		};
+
+		for (uint64_t e = 0; e < entryCount; ++e)
+		{
+			index += static_cast<uint32_t>(reader.ReadVarint());
+			uint8_t mask = reader.ReadByte();
+			copyBaselineUpTo(index);
+
+			QuantizedBodyState state = ZeroState;
+			if ((mask & Added) == 0)
+			{
+				if (i == from.Indices.size() || from.Indices[i] != index)
+				{
+					throw GameException("Snapshot message changes a body missing from its baseline.");
+				}
+
+				state = from.States[i++];
+			}
+
+			for (uint32_t axis = 0; axis < 3; ++axis)
+			{
+				if (mask & (PositionX << axis))
+				{
+					state.Position[axis] = static_cast<int32_t>(state.Position[axis] + reader.ReadSignedVarint());
+				}
+			}
+
+			if (mask & Rotation)
+			{
+				state.Rotation = static_cast<int32_t>(state.Rotation + reader.ReadSignedVarint()) & (RotationSteps - 1);
+			}
+
+			frame.Indices.push_back(index);
+			frame.States.push_back(state);
+		}
+
+		copyBaselineUpTo(numeric_limits<uint64_t>::max());
+	}
+}
\ No newline at end of file
@@ -0,0 +1,67 @@
+#pragma once
+
+#include <vector>
+#include <cstdint>
+
+namespace Rendering
+{
+	struct DoubleVector3;
+
+	/**
+	* The state of a body quantized to integer steps for transmission.
+	*/
+	struct QuantizedBodyState
+	{
+		std::int32_t Position[3];
+		std::int32_t Rotation;		// Steps of a full turn, 0 to RotationSteps - 1
+	};
+
+	/**
+	* The quantized state of the bodies a viewer is interested in at one tick, sorted by body index.
+	*/
+	struct SnapshotFrame
+	{
+		std::uint32_t Tick;
+		std::vector<std::uint32_t> Indices;
+		std::vector<QuantizedBodyState> States;
+
+		SnapshotFrame() : Tick(0) { }
+	};
+
+	/**
+	* Encodes snapshot frames as changes against a baseline frame the receiver already holds.
+	* A message lists the bodies that left the frame, then each body that entered or changed with a mask of its changed
+	* fields followed by zigzag varint deltas. Unchanged bodies cost nothing.
+	*/
+	class SnapshotCodec final
+	{
+	public:
+		static QuantizedBodyState Quantize(const DoubleVector3& position, double rotationDegrees);
+		static DoubleVector3 DequantizePosition(const QuantizedBodyState& state);
+		static double DequantizeRotation(const QuantizedBodyState& state);
+
+		/**
+		* Encode a frame.
+		* @param frame The frame to send.
+		* @param baseline The last frame the receiver acknowledged, or nullptr to send every body in full.
+		* @param message Receives the encoded bytes.
+		*/
+		static void Encode(const SnapshotFrame& frame, const SnapshotFrame* baseline, std::vector<std::uint8_t>& message);
+		/**
+		* Read the tick of a message and the tick of the baseline it was encoded against. A baseline tick of zero means none.
+		*/
+		static void ReadHeader(const std::uint8_t* data, std::size_t size, std::uint32_t& tick, std::uint32_t& baselineTick);
+		/**
+		* Decode a message.
+		* @param baseline The frame whose tick matches the baseline tick of the message, or nullptr if it has none.
+		* @param frame Receives the decoded frame.
+		*/
+		static void Decode(const std::uint8_t* data, std::size_t size, const SnapshotFrame* baseline, SnapshotFrame& frame);
+
+		/**
+		* The size of a position step in scene units.
+		*/
+		static const double PositionQuantum;
+		static const std::int32_t RotationSteps;
+	};
+}
\ No newline at end of file
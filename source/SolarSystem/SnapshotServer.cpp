@@ -0,0 +1,235 @@
+#include "pch.h"
+
+using namespace std;
+using namespace Library;
+
+namespace Rendering
+{
+	const uint32_t SnapshotServer::TickRate = 60;
+	const uint32_t SnapshotServer::MaxHistory = 64;
+
+	SnapshotServer::SnapshotServer(const BodyCatalog& catalog, const wstring& address) :
+		mTick(0), mStopping(false)
+	{
+		// Light sources are always sent so a viewer can light whatever it does receive
+		uint32_t count = catalog.Count();
+		mAlwaysRelevant.resize(count);
+		for (uint32_t i = 0; i < count; ++i)
+		{
+			mAlwaysRelevant[i] = catalog.Record(i).HasFlag(BodyFlags::LightSource);
+		}
+
+		mListener = SnapshotTransport::Listen(address);
+		mListenThread = thread(&SnapshotServer::Listen, this);
+	}
+
+	SnapshotServer::~SnapshotServer()
+	{
+		{
+			lock_guard<mutex> lock(mMutex);
+			mStopping = true;
+
+			// Fail the sends still waiting on viewers that have stopped reading
+			for (auto& viewer : mViewers)
+			{
+				if (viewer->Connection != nullptr)
+				{
+					viewer->Connection->Cancel();
+				}
+			}
+		}
+
+		mListener->Cancel();
+		mFrameAvailable.notify_all();
+
+		mListenThread.join();
+		for (auto& viewer : mViewers)
+		{
+			viewer->Thread.join();
+		}
+	}
+
+	void SnapshotServer::Publish(const SolarSystemSimulation& simulation)
+	{
+		auto frame = make_shared<WorldFrame>();
+		frame->Tick = ++mTick;
+
+		uint32_t count = simulation.Count();
+		frame->Positions.reserve(count);
+		frame->States.reserve(count);
+		for (uint32_t i = 0; i < count; ++i)
+		{
+			DoubleVector3 position = simulation.Position(i);
+			frame->Positions.push_back(position);
+			frame->States.push_back(SnapshotCodec::Quantize(position, simulation.RotationDegrees(i)));
+		}
+
+		{
+			lock_guard<mutex> lock(mMutex);
+			mLatestFrame = frame;
+		}
+
+		mFrameAvailable.notify_all();
+	}
+
+	uint32_t SnapshotServer::Tick() const
+	{
+		return mTick;
+	}
+
+	uint32_t SnapshotServer::ViewerCount()
+	{
+		lock_guard<mutex> lock(mMutex);
+		ReapViewers();
+
+		return static_cast<uint32_t>(mViewers.size());
+	}
+
+	void SnapshotServer::Listen()
+	{
+		for (;;)
+		{
+			unique_ptr<SnapshotConnection> connection = mListener->Accept();
+			if (connection == nullptr)
+			{
+				break;
+			}
+
+			lock_guard<mutex> lock(mMutex);
+			if (mStopping)
+			{
+				break;
+			}
+
+			ReapViewers();
+
+			mViewers.push_back(make_unique<Viewer>());
+			Viewer& viewer = *mViewers.back();
+			viewer.Connection = move(connection);
+			viewer.Finished = false;
+			viewer.Thread = thread(&SnapshotServer::Serve, this, ref(viewer));
+		}
+	}
+
+	void SnapshotServer::Serve(Viewer& viewer)
+	{
+		ViewerMessage interest = { 0 };
+		deque<SnapshotFrame> history;
+		vector<uint8_t> message;
+		uint32_t lastSentTick = 0;
+
+		for (;;)
+		{
+			shared_ptr<const WorldFrame> world;
+			{
+				unique_lock<mutex> lock(mMutex);
+				mFrameAvailable.wait(lock, [&]
+				{
+					return mStopping || (mLatestFrame != nullptr && mLatestFrame->Tick != lastSentTick);
+				});
+
+				if (mStopping)
+				{
+					break;
+				}
+
+				world = mLatestFrame;
+			}
+
+			if (ReadViewerMessages(*viewer.Connection, interest) == false)
+			{
+				break;
+			}
+
+			// Frames older than the acknowledgement can never be a baseline again
+			while (history.empty() == false && history.front().Tick < interest.AckTick)
+			{
+				history.pop_front();
+			}
+
+			const SnapshotFrame* baseline = (history.empty() == false && history.front().Tick == interest.AckTick ? &history.front() : nullptr);
+
+			SnapshotFrame frame;
+			frame.Tick = world->Tick;
+			SelectInterest(*world, interest, frame);
+			SnapshotCodec::Encode(frame, baseline, message);
+
+			if (viewer.Connection->Send(message.data(), message.size()) == false)
+			{
+				break;
+			}
+
+			history.push_back(move(frame));
+			if (history.size() > MaxHistory)
+			{
+				history.pop_front();
+			}
+
+			lastSentTick = world->Tick;
+		}
+
+		{
+			lock_guard<mutex> lock(mMutex);
+			viewer.Connection.reset();
+		}
+
+		viewer.Finished = true;
+	}
+
+	bool SnapshotServer::ReadViewerMessages(SnapshotConnection& connection, ViewerMessage& interest) const
+	{
+		vector<uint8_t> message;
+		for (;;)
+		{
+			bool received = false;
+			if (connection.TryReceive(message, received) == false || (received && message.size() != sizeof(ViewerMessage)))
+			{
+				return false;
+			}
+
+			if (received == false)
+			{
+				return true;
+			}
+
+			memcpy(&interest, message.data(), sizeof(interest));
+		}
+	}
+
+	void SnapshotServer::SelectInterest(const WorldFrame& world, const ViewerMessage& interest, SnapshotFrame& frame) const
+	{
+		bool everyBody = (interest.InterestRadius <= 0.0);
+		double radiusSquared = interest.InterestRadius * interest.InterestRadius;
+
+		uint32_t count = static_cast<uint32_t>(world.Positions.size());
+		for (uint32_t i = 0; i < count; ++i)
+		{
+			const DoubleVector3& position = world.Positions[i];
+			double dx = position.x - interest.CameraPosition[0];
+			double dy = position.y - interest.CameraPosition[1];
+			double dz = position.z - interest.CameraPosition[2];
+
+			if (everyBody || mAlwaysRelevant[i] || dx * dx + dy * dy + dz * dz <= radiusSquared)
+			{
+				frame.Indices.push_back(i);
+				frame.States.push_back(world.States[i]);
+			}
+		}
+	}
+
+	void SnapshotServer::ReapViewers()
+	{
+		auto finished = remove_if(mViewers.begin(), mViewers.end(), [](const unique_ptr<Viewer>& viewer)
+		{
+			if (viewer->Finished)
+			{
+				viewer->Thread.join();
+				return true;
+			}
+
+			return false;
+		});
+
+		mViewers.erase(finished, mViewers.end());
+	}
+}
\ No newline at end of file
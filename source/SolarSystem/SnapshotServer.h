@@ -0,0 +1,92 @@
+#pragma once
+
+#include "SnapshotCodec.h"
+#include "SnapshotTransport.h"
+#include <string>
+#include <vector>
+#include <memory>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+
+namespace Library
+{
+	class BodyCatalog;
+}
+
+namespace Rendering
+{
+	class SolarSystemSimulation;
+
+	/**
+	* The message a viewer sends after each snapshot it applies.
+	*/
+	struct ViewerMessage
+	{
+		std::uint32_t AckTick;
+		std::uint32_t Reserved;
+		double CameraPosition[3];		// World scene units
+		double InterestRadius;			// Scene units; zero or less for every body
+	};
+
+	/**
+	* Publishes the state of a simulation to any number of local viewers over the SnapshotTransport of the platform.
+	* Each viewer is served by its own thread, which always encodes the newest tick against the last tick that viewer
+	* acknowledged and only includes the bodies near its camera. A slow viewer skips ticks rather than stalling the others.
+	*/
+	class SnapshotServer final
+	{
+	public:
+		SnapshotServer(const Library::BodyCatalog& catalog, const std::wstring& address = SnapshotTransport::DefaultAddress);
+		SnapshotServer(const SnapshotServer&) = delete;
+		SnapshotServer& operator=(const SnapshotServer&) = delete;
+		SnapshotServer(SnapshotServer&&) = delete;
+		SnapshotServer& operator=(SnapshotServer&&) = delete;
+		~SnapshotServer();
+
+		/**
+		* Quantize the current state of the simulation as the next tick and wake the viewer threads.
+		*/
+		void Publish(const SolarSystemSimulation& simulation);
+
+		std::uint32_t Tick() const;
+		std::uint32_t ViewerCount();
+
+		static const std::uint32_t TickRate;
+
+	private:
+		struct WorldFrame
+		{
+			std::uint32_t Tick;
+			std::vector<DoubleVector3> Positions;
+			std::vector<QuantizedBodyState> States;
+		};
+
+		struct Viewer
+		{
+			std::unique_ptr<SnapshotConnection> Connection;
+			std::thread Thread;
+			std::atomic<bool> Finished;
+		};
+
+		void Listen();
+		void Serve(Viewer& viewer);
+		bool ReadViewerMessages(SnapshotConnection& connection, ViewerMessage& interest) const;
+		void SelectInterest(const WorldFrame& world, const ViewerMessage& interest, SnapshotFrame& frame) const;
+		void ReapViewers();
+
+		static const std::uint32_t MaxHistory;
+
+		std::unique_ptr<SnapshotListener> mListener;
+		std::vector<bool> mAlwaysRelevant;
+		std::uint32_t mTick;
+		std::atomic<bool> mStopping;
+
+		std::mutex mMutex;
+		std::condition_variable mFrameAvailable;
+		std::shared_ptr<const WorldFrame> mLatestFrame;
+		std::vector<std::unique_ptr<Viewer>> mViewers;
+		std::thread mListenThread;
+	};
+}
\ No newline at end of file
@@ -0,0 +1,32 @@
+#include "pch.h"
+
+using namespace std;
+
+namespace Rendering
+{
+#if defined(_WIN32)
+	const wstring SnapshotTransport::DefaultAddress = L"\\\\.\\pipe\\MySolarSystem.Snapshots";
+
+	unique_ptr<SnapshotListener> SnapshotTransport::Listen(const wstring& address)
+	{
+		return make_unique<NamedPipeListener>(address);
+	}
+
+	unique_ptr<SnapshotConnection> SnapshotTransport::Connect(const wstring& address)
+	{
+		return NamedPipeConnection::Connect(address);
+	}
+#else
+	const wstring SnapshotTransport::DefaultAddress = L"/tmp/MySolarSystem.Snapshots";
+
+	unique_ptr<SnapshotListener> SnapshotTransport::Listen(const wstring& address)
+	{
+		return make_unique<UnixSocketListener>(address);
+	}
+
+	unique_ptr<SnapshotConnection> SnapshotTransport::Connect(const wstring& address)
+	{
+		return UnixSocketConnection::Connect(address);
+	}
+#endif
+}
\ No newline at end of file
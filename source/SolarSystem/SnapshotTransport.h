@@ -0,0 +1,78 @@
+#pragma once
+
+#include <vector>
+#include <string>
+#include <memory>
+#include <cstdint>
+#include <cstddef>
+
+namespace Rendering
+{
+	/**
+	* A connection between a snapshot server and one viewer, carrying whole messages in the order they were sent.
+	*/
+	class SnapshotConnection
+	{
+	public:
+		virtual ~SnapshotConnection() = default;
+
+		/**
+		* Send a message whole, waiting while the other end is behind.
+		* @return False if the connection was lost or cancelled.
+		*/
+		virtual bool Send(const void* data, std::size_t size) = 0;
+		/**
+		* Receive the next message if one has arrived, without waiting for one.
+		* @param message Receives the message.
+		* @param received Set to whether a message had arrived.
+		* @return False if the connection was lost or cancelled.
+		*/
+		virtual bool TryReceive(std::vector<std::uint8_t>& message, bool& received) = 0;
+		/**
+		* Fail a Send() waiting on another thread, and every call after. Safe to call from any thread.
+		*/
+		virtual void Cancel() = 0;
+	};
+
+	/**
+	* The end of a snapshot server that viewers connect to.
+	*/
+	class SnapshotListener
+	{
+	public:
+		virtual ~SnapshotListener() = default;
+
+		/**
+		* Wait for the next viewer to connect.
+		* @return The connection to the viewer, or null once the listener is cancelled.
+		*/
+		virtual std::unique_ptr<SnapshotConnection> Accept() = 0;
+		/**
+		* Return from an Accept() waiting on another thread, and from every call after. Safe to call from any thread.
+		*/
+		virtual void Cancel() = 0;
+	};
+
+	/**
+	* Opens the local transport of the platform: named pipes on Windows and Unix domain sockets elsewhere.
+	*/
+	class SnapshotTransport final
+	{
+	public:
+		/**
+		* Listen for viewers at an address no other server is listening at.
+		*/
+		static std::unique_ptr<SnapshotListener> Listen(const std::wstring& address);
+		/**
+		* Connect to the server listening at an address, waiting a while for it to accept.
+		*/
+		static std::unique_ptr<SnapshotConnection> Connect(const std::wstring& address);
+
+		/**
+		* The address of a server started without one: a pipe name on Windows and a socket path elsewhere.
+		*/
+		static const std::wstring DefaultAddress;
+
+		SnapshotTransport() = delete;
+	};
+}
\ No newline at end of file
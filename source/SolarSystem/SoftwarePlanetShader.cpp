@@ -0,0 +1,138 @@
+#include "pch.h"
+
+using namespace std;
+using namespace DirectX;
+using namespace Library;
+
+namespace Rendering
+{
+	namespace
+	{
+		// The varyings written by the vertex shader, as VS_OUTPUT in the planet shaders
+		const uint32_t WorldPositionX = 0;
+		const uint32_t WorldPositionY = 1;
+		const uint32_t WorldPositionZ = 2;
+		const uint32_t Attenuation = 3;
+		const uint32_t TextureCoordinateU = 4;
+		const uint32_t TextureCoordinateV = 5;
+		const uint32_t NormalX = 6;
+		const uint32_t NormalY = 7;
+		const uint32_t NormalZ = 8;
+		const uint32_t ShaderVaryingCount = 9;
+
+		float Saturate(float value)
+		{
+			return min(max(value, 0.0f), 1.0f);
+		}
+
+		// The product of a row vector and a matrix stored transposed, as mul() computes it on the constant buffer
+		XMVECTOR MultiplyTransposed(FXMVECTOR vector, CXMMATRIX transposed)
+		{
+			return XMVectorSet(XMVectorGetX(XMVector4Dot(vector, transposed.r[0])), XMVectorGetX(XMVector4Dot(vector, transposed.r[1])),
+				XMVectorGetX(XMVector4Dot(vector, transposed.r[2])), XMVectorGetX(XMVector4Dot(vector, transposed.r[3])));
+		}
+	}
+
+	SoftwarePlanetShader::SoftwarePlanetShader() :
+		mFrameConstants(), mInstances(nullptr), mColorMaps(nullptr)
+	{
+	}
+
+	void SoftwarePlanetShader::SetFrameConstants(const FrameConstants& frameConstants)
+	{
+		mFrameConstants = frameConstants;
+	}
+
+	void SoftwarePlanetShader::SetInstances(const PlanetInstance* instances)
+	{
+		mInstances = instances;
+	}
+
+	void SoftwarePlanetShader::SetColorMaps(const SoftwareTexture& colorMaps)
+	{
+		mColorMaps = &colorMaps;
+	}
+
+	uint32_t SoftwarePlanetShader::VaryingCount() const
+	{
+		return ShaderVaryingCount;
+	}
+
+	void SoftwarePlanetShader::ShadeVertex(const void* vertex, uint32_t instance, SoftwareVertex& output) const
+	{
+		assert(mInstances != nullptr);
+
+		const VertexPositionTextureNormal& input = *static_cast<const VertexPositionTextureNormal*>(vertex);
+		XMMATRIX world = XMLoadFloat4x4(&mInstances[instance].World);
+
+		XMVECTOR worldPosition = MultiplyTransposed(XMLoadFloat4(&input.Position), world);
+		XMStoreFloat4(&output.Position, MultiplyTransposed(worldPosition, XMLoadFloat4x4(&mFrameConstants.ViewProjection)));
+		XMStoreFloat3(reinterpret_cast<XMFLOAT3*>(&output.Varyings[WorldPositionX]), worldPosition);
+		output.Varyings[TextureCoordinateU] = input.TextureCoordinates.x;
+		output.Varyings[TextureCoordinateV] = input.TextureCoordinates.y;
+
+		XMVECTOR normal = XMVector3Normalize(MultiplyTransposed(XMVectorSetW(XMLoadFloat3(&input.Normal), 0.0f), world));
+		XMStoreFloat3(reinterpret_cast<XMFLOAT3*>(&output.Varyings[NormalX]), normal);
+
+		XMVECTOR lightDirection = XMVectorSubtract(XMLoadFloat3(&mFrameConstants.LightPosition), worldPosition);
+		output.Varyings[Attenuation] = Saturate(1.0f - (XMVectorGetX(XMVector3Length(lightDirection)) / mFrameConstants.LightRange));
+	}
+
+	XMFLOAT4 SoftwarePlanetShader::ShadePixel(const SoftwareFragment& fragment) const
+	{
+		assert(mInstances != nullptr && mColorMaps != nullptr);
+
+		const PlanetInstance& instance = mInstances[fragment.Instance];
+		XMVECTOR worldPosition = XMLoadFloat3(reinterpret_cast<const XMFLOAT3*>(&fragment.Varyings[WorldPositionX]));
+
+		XMVECTOR toLight = XMVectorSubtract(XMLoadFloat3(&mFrameConstants.LightPosition), worldPosition);
+		float lightDistance = XMVectorGetX(XMVector3Length(toLight));
+		XMVECTOR lightDirection = XMVectorScale(toLight, 1.0f / lightDistance);
+
+		XMVECTOR normal = XMVector3Normalize(XMLoadFloat3(reinterpret_cast<const XMFLOAT3*>(&fragment.Varyings[NormalX])));
+		float n_dot_l = XMVectorGetX(XMVector3Dot(normal, lightDirection));
+
+		XMFLOAT2 textureCoordinate(fragment.Varyings[TextureCoordinateU], fragment.Varyings[TextureCoordinateV]);
+		XMFLOAT2 ddx(fragment.Ddx(TextureCoordinateU), fragment.Ddx(TextureCoordinateV));
+		XMFLOAT2 ddy(fragment.Ddy(TextureCoordinateU), fragment.Ddy(TextureCoordinateV));
+		XMFLOAT4 sampledColor = mColorMaps->SampleGrad(RenderDevice::SamplerType::TrilinearWrap, textureCoordinate, instance.TextureSlice, ddx, ddy);
+		XMVECTOR color = XMLoadFloat4(&sampledColor);
+
+		XMVECTOR ambient = XMVectorScale(color, instance.AmbientIntensity);
+		XMVECTOR diffuse = (n_dot_l > 0.0f ? XMVectorMultiply(XMVectorScale(color, n_dot_l), XMLoadFloat3(&mFrameConstants.LightColor)) : XMVectorZero());
+		diffuse = XMVectorScale(diffuse, fragment.Varyings[Attenuation]);
+
+		float visibility = 1.0f;
+		for (uint32_t i = 0; i < instance.OccluderCount; i++)
+		{
+			visibility *= LightVisibility(worldPosition, lightDirection, lightDistance, instance.LightRadius, instance.Occluders[i]);
+		}
+		diffuse = XMVectorScale(diffuse, visibility);
+
+		XMFLOAT4 result;
+		XMStoreFloat4(&result, XMVectorSaturate(XMVectorAdd(ambient, diffuse)));
+		result.w = sampledColor.w;
+
+		return result;
+	}
+
+	float SoftwarePlanetShader::LightVisibility(FXMVECTOR worldPosition, FXMVECTOR lightDirection, float lightDistance, float lightRadius, const XMFLOAT4& occluder)
+	{
+		XMVECTOR toOccluder = XMVectorSubtract(XMLoadFloat4(&occluder), worldPosition);
+		float occluderDistance = XMVectorGetX(XMVector3Length(toOccluder));
+		if (occluderDistance >= lightDistance || XMVectorGetX(XMVector3Dot(toOccluder, lightDirection)) <= 0.0f)
+		{
+			return 1.0f;
+		}
+
+		float lightAngle = asin(Saturate(lightRadius / lightDistance));
+		float occluderAngle = asin(Saturate(occluder.w / occluderDistance));
+		float separation = acos(Saturate(XMVectorGetX(XMVector3Dot(XMVectorScale(toOccluder, 1.0f / occluderDistance), lightDirection))));
+
+		// Coverage grows from first contact until the smaller disk lies inside the larger, and is capped by their area ratio
+		float overlap = Saturate((lightAngle + occluderAngle - separation) / max(2.0f * min(lightAngle, occluderAngle), 1e-6f));
+		float coverage = min((occluderAngle * occluderAngle) / max(lightAngle * lightAngle, 1e-12f), 1.0f);
+
+		return 1.0f - overlap * coverage;
+	}
+}
\ No newline at end of file
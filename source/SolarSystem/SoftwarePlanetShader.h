@@ -0,0 +1,64 @@
+#pragma once
+
+#include "SoftwareRasterizer.h"
+#include "InstanceBatcher.h"
+#include <DirectXMath.h>
+
+namespace Library
+{
+	class SoftwareTexture;
+}
+
+namespace Rendering
+{
+	/**
+	* The planet shaders for the software rasterizer, following PlanetVS.hlsl and PlanetPS.hlsl line for line: each
+	* body is lit by the point light with linear attenuation over its range, n dot l diffuse and a constant ambient
+	* term, shadowed by the disks of its occluders, and colored from its slice of the color texture array sampled
+	* trilinearly. Vertices are in the layout of VertexPositionTextureNormal, and the instance given by the rasterizer
+	* indexes the instances set on the shader, as the first instance of a batch does in the structured buffer.
+	*/
+	class SoftwarePlanetShader final : public Library::SoftwareShader
+	{
+	public:
+		/**
+		* The constants of the frame, laid out as CBufferPerFrame in the planet shaders.
+		*/
+		struct FrameConstants
+		{
+			DirectX::XMFLOAT4X4 ViewProjection;		// Transposed for the shaders
+			DirectX::XMFLOAT3 LightPosition;
+			float LightRange;
+			DirectX::XMFLOAT3 LightColor;
+			float Padding;
+		};
+
+		SoftwarePlanetShader();
+		SoftwarePlanetShader(const SoftwarePlanetShader&) = delete;
+		SoftwarePlanetShader& operator=(const SoftwarePlanetShader&) = delete;
+		SoftwarePlanetShader(SoftwarePlanetShader&&) = delete;
+		SoftwarePlanetShader& operator=(SoftwarePlanetShader&&) = delete;
+		~SoftwarePlanetShader() = default;
+
+		void SetFrameConstants(const FrameConstants& frameConstants);
+		/**
+		* Set the instances drawn, such as those written by the instance batcher. They must stay valid while the rasterizer draws with the shader.
+		*/
+		void SetInstances(const PlanetInstance* instances);
+		/**
+		* Set the color texture array holding the surface of every body. It must stay valid while the rasterizer draws with the shader.
+		*/
+		void SetColorMaps(const Library::SoftwareTexture& colorMaps);
+
+		virtual std::uint32_t VaryingCount() const override;
+		virtual void ShadeVertex(const void* vertex, std::uint32_t instance, Library::SoftwareVertex& output) const override;
+		virtual DirectX::XMFLOAT4 ShadePixel(const Library::SoftwareFragment& fragment) const override;
+
+	private:
+		static float LightVisibility(DirectX::FXMVECTOR worldPosition, DirectX::FXMVECTOR lightDirection, float lightDistance, float lightRadius, const DirectX::XMFLOAT4& occluder);
+
+		FrameConstants mFrameConstants;
+		const PlanetInstance* mInstances;
+		const Library::SoftwareTexture* mColorMaps;
+	};
+}
\ No newline at end of file
@@ -0,0 +1,225 @@
+#include "pch.h"
+
+using namespace std;
+using namespace Library;
+using namespace DirectX;
+
+namespace Rendering
+{
+	namespace
+	{
+		const double DegreesToRadians = 3.14159265358979323846 / 180.0;
+		const double J2000 = 2451545.0;
+	}
+
+	const float SolarSystemSimulation::OriginRecenterDistance = 1000.0f;
+
+	SolarSystemSimulation::SolarSystemSimulation(const BodyCatalog& catalog, AnglePrecision anglePrecision) :
+		mCatalog(&catalog), mPlanetaryTheory(nullptr), mPaused(false), mElapsedDays(0.0),
+		mRotations(anglePrecision, catalog.Count()), mRevolutions(anglePrecision, catalog.Count())
+	{
+		uint32_t count = catalog.Count();
+		const BodyCatalogRecord* records = catalog.Records();
+
+		mParentIndices.resize(count);
+		mTheoryBodies.assign(count, -1);
+		mOrbitalDistances.resize(count);
+		mInclinations.resize(count);
+		mAscendingNodes.resize(count);
+		mNodalRates.resize(count);
+		mPositionsX.assign(count, 0.0);
+		mPositionsY.assign(count, 0.0);
+		mPositionsZ.assign(count, 0.0);
+		mRelativePositions.assign(count, Vector3Helper::Zero);
+
+		// Degrees per day on earth
+		vector<double> rotationRates(count);
+		vector<double> revolutionRates(count);
+		for (uint32_t i = 0; i < count; ++i)
+		{
+			const BodyCatalogRecord& record = records[i];
+			mParentIndices[i] = record.ParentIndex;
+			mOrbitalDistances[i] = record.OrbitalDistance * SCALE_ASTRONOMICAL_UNIT;
+			mInclinations[i] = record.Inclination * DegreesToRadians;
+			mAscendingNodes[i] = record.AscendingNode * DegreesToRadians;
+			mNodalRates[i] = (record.NodalPeriodDays != 0.0f ? 360.0 / record.NodalPeriodDays * DegreesToRadians : 0.0);
+			rotationRates[i] = (record.RotationDays > 0.0f ? 360.0 / record.RotationDays : 0.0);
+			revolutionRates[i] = (record.RevolutionDays > 0.0f ? 360.0 / record.RevolutionDays : 0.0);
+		}
+
+		mRotations.SetRates(rotationRates.data());
+		mRevolutions.SetRates(revolutionRates.data());
+
+		UpdatePositions();
+		RebasePositions();
+	}
+
+	bool SolarSystemSimulation::Paused() const
+	{
+		return mPaused;
+	}
+
+	void SolarSystemSimulation::SetPaused(bool paused)
+	{
+		mPaused = paused;
+	}
+
+#if !defined(LIBRARY_PORTABLE)
+	void SolarSystemSimulation::Update(const GameTime& gameTime)
+	{
+		if (mPaused == false)
+		{
+			double seconds = gameTime.ElapsedGameTime().count() / 1000.0;
+			Advance(seconds / SCALE_TIME_FOR_DAY);
+		}
+	}
+#endif
+
+	void SolarSystemSimulation::Advance(double days)
+	{
+		mElapsedDays += days;
+		mRotations.Advance(days);
+		mRevolutions.Advance(days);
+
+		UpdatePositions();
+	}
+
+#if !defined(LIBRARY_PORTABLE)
+	void SolarSystemSimulation::UpdateOrigin(Camera& camera)
+	{
+		const XMFLOAT3& cameraPosition = camera.Position();
+		if (XMVectorGetX(XMVector3LengthSq(camera.PositionVector())) > OriginRecenterDistance * OriginRecenterDistance)
+		{
+			mOrigin.x += cameraPosition.x;
+			mOrigin.y += cameraPosition.y;
+			mOrigin.z += cameraPosition.z;
+			camera.SetPosition(Vector3Helper::Zero);
+		}
+
+		RebasePositions();
+	}
+#endif
+
+	void SolarSystemSimulation::SetBodyState(uint32_t index, const DoubleVector3& position, double rotationDegrees)
+	{
+		mPositionsX[index] = position.x;
+		mPositionsY[index] = position.y;
+		mPositionsZ[index] = position.z;
+		mRotations.SetAngle(index, rotationDegrees);
+	}
+
+	void SolarSystemSimulation::SetPlanetaryTheory(const Vsop87Theory& theory)
+	{
+		// The theory gives heliocentric positions, so only bodies orbiting the light source follow it. A body with no parent
+		// that is not a light source circles the origin, where the light source sits, so it orbits the light source too.
+		mPlanetaryTheory = &theory;
+		uint32_t count = mCatalog->Count();
+		for (uint32_t i = 0; i < count; ++i)
+		{
+			int32_t parent = mParentIndices[i];
+			bool orbitsLight = (parent >= 0 ? mCatalog->Record(static_cast<uint32_t>(parent)).HasFlag(BodyFlags::LightSource) : mCatalog->Record(i).HasFlag(BodyFlags::LightSource) == false);
+			mTheoryBodies[i] = (orbitsLight ? Vsop87Theory::BodyIndex(mCatalog->Name(i)) : -1);
+		}
+
+		UpdatePositions();
+		RebasePositions();
+	}
+
+	uint32_t SolarSystemSimulation::Count() const
+	{
+		return static_cast<uint32_t>(mRelativePositions.size());
+	}
+
+	double SolarSystemSimulation::ElapsedDays() const
+	{
+		return mElapsedDays;
+	}
+
+	const DoubleVector3& SolarSystemSimulation::Origin() const
+	{
+		return mOrigin;
+	}
+
+	DoubleVector3 SolarSystemSimulation::Position(uint32_t index) const
+	{
+		return DoubleVector3(mPositionsX[index], mPositionsY[index], mPositionsZ[index]);
+	}
+
+	const XMFLOAT3& SolarSystemSimulation::RelativePosition(uint32_t index) const
+	{
+		return mRelativePositions[index];
+	}
+
+	float SolarSystemSimulation::RotationDegrees(uint32_t index) const
+	{
+		return static_cast<float>(mRotations.Angle(index));
+	}
+
+	float SolarSystemSimulation::RevolutionDegrees(uint32_t index) const
+	{
+		return static_cast<float>(mRevolutions.Angle(index));
+	}
+
+	void SolarSystemSimulation::UpdatePositions()
+	{
+		// Bodies orbit around their parent in a plane inclined to the XZ plane; the catalog lists parents before their children
+		size_t count = mPositionsX.size();
+		for (size_t i = 0; i < count; ++i)
+		{
+			double x;
+			double y = 0.0;
+			double z;
+			if (mTheoryBodies[i] >= 0)
+			{
+				// The ecliptic is the XZ plane, and the longitude is measured the same way as the revolution on a circular orbit
+				Vsop87Coordinates coordinates = mPlanetaryTheory->Evaluate(static_cast<uint32_t>(mTheoryBodies[i]), J2000 + mElapsedDays);
+				double distance = coordinates.Radius * SCALE_ASTRONOMICAL_UNIT;
+				double planarDistance = distance * cos(coordinates.Latitude);
+				x = planarDistance * cos(coordinates.Longitude);
+				y = distance * sin(coordinates.Latitude);
+				z = -planarDistance * sin(coordinates.Longitude);
+				mRevolutions.SetAngle(static_cast<uint32_t>(i), coordinates.Longitude / DegreesToRadians);
+			}
+			else
+			{
+				// The revolution is measured from the ascending node in the orbital plane, and the node from the X axis in the ecliptic
+				double revolution = mRevolutions.Angle(static_cast<uint32_t>(i)) * DegreesToRadians;
+				double node = mAscendingNodes[i] + mNodalRates[i] * mElapsedDays;
+				double alongNode = mOrbitalDistances[i] * cos(revolution - node);
+				double acrossNode = mOrbitalDistances[i] * sin(revolution - node);
+				double inclination = mInclinations[i];
+				x = alongNode * cos(node) - acrossNode * cos(inclination) * sin(node);
+				y = acrossNode * sin(inclination);
+				z = -alongNode * sin(node) - acrossNode * cos(inclination) * cos(node);
+			}
+
+			int32_t parent = mParentIndices[i];
+			if (parent >= 0)
+			{
+				x += mPositionsX[parent];
+				y += mPositionsY[parent];
+				z += mPositionsZ[parent];
+			}
+
+			mPositionsX[i] = x;
+			mPositionsY[i] = y;
+			mPositionsZ[i] = z;
+		}
+	}
+
+	void SolarSystemSimulation::RebasePositions()
+	{
+		const double originX = mOrigin.x;
+		const double originY = mOrigin.y;
+		const double originZ = mOrigin.z;
+
+		size_t count = mRelativePositions.size();
+		XMFLOAT3* relativePositions = mRelativePositions.data();
+		for (size_t i = 0; i < count; ++i)
+		{
+			relativePositions[i].x = static_cast<float>(mPositionsX[i] - originX);
+			relativePositions[i].y = static_cast<float>(mPositionsY[i] - originY);
+			relativePositions[i].z = static_cast<float>(mPositionsZ[i] - originZ);
+		}
+	}
+}
\ No newline at end of file
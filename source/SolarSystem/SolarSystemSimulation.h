@@ -0,0 +1,132 @@
+#pragma once
+
+#include <vector>
+#include <cstdint>
+#include <DirectXMath.h>
+#include "AngleAccumulator.h"
+
+/**
+* ģһʱҪ, Ĭ0.5, Ƽ0.05
+*/
+#define SCALE_TIME_FOR_DAY 0.05
+/**
+* , Ĭ300.0f, Ƽ150.0f
+*/
+#define SCALE_ASTRONOMICAL_UNIT 150.0
+
+namespace Library
+{
+	class GameTime;
+	class Camera;
+	class BodyCatalog;
+	class Vsop87Theory;
+}
+
+namespace Rendering
+{
+	/**
+	* A double-precision position in scene units.
+	*/
+	struct DoubleVector3
+	{
+		double x;
+		double y;
+		double z;
+
+		DoubleVector3() : x(0.0), y(0.0), z(0.0) { }
+		DoubleVector3(double x, double y, double z) : x(x), y(y), z(z) { }
+	};
+
+	/**
+	* Simulates the bodies of a catalog in double precision. Positions are kept in world space and rebased
+	* to a floating origin near the camera once per frame so rendering can stay in single precision.
+	* The rotation and revolution angles, from which the positions follow, are accumulated in the precision chosen
+	* at construction.
+	*/
+	class SolarSystemSimulation final
+	{
+	public:
+		SolarSystemSimulation(const Library::BodyCatalog& catalog, Library::AnglePrecision anglePrecision = Library::AnglePrecision::Double);
+		SolarSystemSimulation(const SolarSystemSimulation&) = delete;
+		SolarSystemSimulation& operator=(const SolarSystemSimulation&) = delete;
+		SolarSystemSimulation(SolarSystemSimulation&&) = delete;
+		SolarSystemSimulation& operator=(SolarSystemSimulation&&) = delete;
+		~SolarSystemSimulation() = default;
+
+		bool Paused() const;
+		void SetPaused(bool paused);
+
+#if !defined(LIBRARY_PORTABLE)
+		/**
+		* Advance the simulation by the game time elapsed since the last frame.
+		* @param gameTime A game time object with data about time elapsed.
+		*/
+		void Update(const Library::GameTime& gameTime);
+#endif
+		/**
+		* Advance the simulation by a number of days on earth.
+		* @param days The number of days to advance.
+		*/
+		void Advance(double days);
+#if !defined(LIBRARY_PORTABLE)
+		/**
+		* Move the floating origin to the camera when it strays too far, then rebase all body positions
+		* to the origin in a single double to float pass.
+		* @param camera The camera to keep near the origin. Its position is reset when the origin moves.
+		*/
+		void UpdateOrigin(Library::Camera& camera);
+#endif
+		/**
+		* Overwrite the state of a body with one computed elsewhere, such as a snapshot received from a server.
+		* @param index The index of the body in the catalog.
+		* @param position The world position of the body in scene units.
+		* @param rotationDegrees The rotation of the body about its axis.
+		*/
+		void SetBodyState(std::uint32_t index, const DoubleVector3& position, double rotationDegrees);
+		/**
+		* Place the planets orbiting the light source at the positions of a planetary theory rather than on circular
+		* orbits. The elapsed days are then counted from the epoch J2000.
+		* @param theory The theory, which must outlive the simulation.
+		*/
+		void SetPlanetaryTheory(const Library::Vsop87Theory& theory);
+
+		std::uint32_t Count() const;
+		double ElapsedDays() const;
+		const DoubleVector3& Origin() const;
+		DoubleVector3 Position(std::uint32_t index) const;
+		/**
+		* Get the position of a body relative to the floating origin, as computed by the last call to UpdateOrigin().
+		*/
+		const DirectX::XMFLOAT3& RelativePosition(std::uint32_t index) const;
+		float RotationDegrees(std::uint32_t index) const;
+		float RevolutionDegrees(std::uint32_t index) const;
+
+		/**
+		* The distance from the origin, in scene units, at which the camera is recentred.
+		*/
+		static const float OriginRecenterDistance;
+
+	private:
+		void UpdatePositions();
+		void RebasePositions();
+
+		const Library::BodyCatalog* mCatalog;
+		const Library::Vsop87Theory* mPlanetaryTheory;
+		bool mPaused;
+		double mElapsedDays;
+		DoubleVector3 mOrigin;
+
+		std::vector<std::int32_t> mParentIndices;
+		std::vector<std::int32_t> mTheoryBodies;		// The index of each body in the planetary theory, or -1
+		std::vector<double> mOrbitalDistances;
+		std::vector<double> mInclinations;			// Radians
+		std::vector<double> mAscendingNodes;		// Radians at the start of the simulation
+		std::vector<double> mNodalRates;			// Radians per day
+		Library::AngleAccumulator mRotations;
+		Library::AngleAccumulator mRevolutions;
+		std::vector<double> mPositionsX;
+		std::vector<double> mPositionsY;
+		std::vector<double> mPositionsZ;
+		std::vector<DirectX::XMFLOAT3> mRelativePositions;
+	};
+}
\ No newline at end of file
@@ -0,0 +1,430 @@
+#include "pch.h"
+
+using namespace std;
+using namespace Library;
+
+namespace Rendering
+{
+	namespace
+	{
+		// Gravitational constant in astronomical units cubed per earth mass per day squared
+		const double GravitationalConstant = 8.88769e-10;
+		const double EarthMassesPerSolarMass = 332946.0487;
+		const double DegreesToRadians = 3.14159265358979323846 / 180.0;
+		const uint32_t MaxBodies = PlanetarySystem::MaxPlanets + 1;
+		const uint32_t Width = SystemBatchRunner::BatchWidth;
+		// Unused bodies are massless and parked far apart so they never produce a zero separation
+		const double ParkingDistance = 1.0e6;
+
+		/**
+		* Body state for BatchWidth systems, indexed [body * BatchWidth + system]. Body 0 is the star.
+		*/
+		struct SystemBatch
+		{
+			double X[MaxBodies * Width];
+			double Y[MaxBodies * Width];
+			double Z[MaxBodies * Width];
+			double VX[MaxBodies * Width];
+			double VY[MaxBodies * Width];
+			double VZ[MaxBodies * Width];
+			double AX[MaxBodies * Width];
+			double AY[MaxBodies * Width];
+			double AZ[MaxBodies * Width];
+			double GM[MaxBodies * Width];		// Gravitational constant times mass
+			uint32_t PlanetCounts[Width];
+		};
+
+		void ComputeAccelerations(SystemBatch& batch)
+		{
+			fill(begin(batch.AX), end(batch.AX), 0.0);
+			fill(begin(batch.AY), end(batch.AY), 0.0);
+			fill(begin(batch.AZ), end(batch.AZ), 0.0);
+
+			for (uint32_t i = 0; i < MaxBodies; ++i)
+			{
+				const double* xi = &batch.X[i * Width];
+				const double* yi = &batch.Y[i * Width];
+				const double* zi = &batch.Z[i * Width];
+				const double* gmi = &batch.GM[i * Width];
+				double* axi = &batch.AX[i * Width];
+				double* ayi = &batch.AY[i * Width];
+				double* azi = &batch.AZ[i * Width];
+
+				for (uint32_t j = i + 1; j < MaxBodies; ++j)
+				{
+					const double* xj = &batch.X[j * Width];
+					const double* yj = &batch.Y[j * Width];
+					const double* zj = &batch.Z[j * Width];
+					const double* gmj = &batch.GM[j * Width];
+					double* axj = &batch.AX[j * Width];
+					double* ayj = &batch.AY[j * Width];
+					double* azj = &batch.AZ[j * Width];
+
+					// One lane per system
+					for (uint32_t s = 0; s < Width; ++s)
+					{
+						double dx = xj[s] - xi[s];
+						double dy = yj[s] - yi[s];
+						double dz = zj[s] - zi[s];
+						double distanceSquared = dx * dx + dy * dy + dz * dz;
+						double inverseCube = 1.0 / (distanceSquared * sqrt(distanceSquared));
+
+						double si = gmj[s] * inverseCube;
+						double sj = gmi[s] * inverseCube;
+						axi[s] += dx * si;
+						ayi[s] += dy * si;
+						azi[s] += dz * si;
+						axj[s] -= dx * sj;
+						ayj[s] -= dy * sj;
+						azj[s] -= dz * sj;
+					}
+				}
+			}
+		}
+
+		void Kick(SystemBatch& batch, double time)
+		{
+			for (uint32_t k = 0; k < MaxBodies * Width; ++k)
+			{
+				batch.VX[k] += batch.AX[k] * time;
+				batch.VY[k] += batch.AY[k] * time;
+				batch.VZ[k] += batch.AZ[k] * time;
+			}
+		}
+
+		void Drift(SystemBatch& batch, double time)
+		{
+			for (uint32_t k = 0; k < MaxBodies * Width; ++k)
+			{
+				batch.X[k] += batch.VX[k] * time;
+				batch.Y[k] += batch.VY[k] * time;
+				batch.Z[k] += batch.VZ[k] * time;
+			}
+		}
+
+		// Total energy scaled by the gravitational constant, which leaves relative errors unchanged
+		void ComputeEnergies(const SystemBatch& batch, double* energies)
+		{
+			fill(energies, energies + Width, 0.0);
+
+			for (uint32_t i = 0; i < MaxBodies; ++i)
+			{
+				for (uint32_t s = 0; s < Width; ++s)
+				{
+					uint32_t k = i * Width + s;
+					double speedSquared = batch.VX[k] * batch.VX[k] + batch.VY[k] * batch.VY[k] + batch.VZ[k] * batch.VZ[k];
+					energies[s] += 0.5 * batch.GM[k] * speedSquared;
+				}
+
+				for (uint32_t j = i + 1; j < MaxBodies; ++j)
+				{
+					for (uint32_t s = 0; s < Width; ++s)
+					{
+						uint32_t ki = i * Width + s;
+						uint32_t kj = j * Width + s;
+						double dx = batch.X[kj] - batch.X[ki];
+						double dy = batch.Y[kj] - batch.Y[ki];
+						double dz = batch.Z[kj] - batch.Z[ki];
+						energies[s] -= batch.GM[ki] * batch.GM[kj] / sqrt(dx * dx + dy * dy + dz * dz);
+					}
+				}
+			}
+		}
+
+		void LoadSystem(SystemBatch& batch, uint32_t s, const PlanetarySystem& system)
+		{
+			double starGM = GravitationalConstant * system.StarMass;
+			batch.GM[s] = starGM;
+			batch.X[s] = batch.Y[s] = batch.Z[s] = 0.0;
+			batch.VX[s] = batch.VY[s] = batch.VZ[s] = 0.0;
+			batch.PlanetCounts[s] = min(system.PlanetCount, MaxBodies - 1);
+
+			for (uint32_t p = 0; p < PlanetarySystem::MaxPlanets; ++p)
+			{
+				uint32_t k = (p + 1) * Width + s;
+				if (p >= batch.PlanetCounts[s])
+				{
+					batch.GM[k] = 0.0;
+					batch.X[k] = ParkingDistance * (p + 1);
+					batch.Y[k] = batch.Z[k] = 0.0;
+					batch.VX[k] = batch.VY[k] = batch.VZ[k] = 0.0;
+					continue;
+				}
+
+				// Circular orbits in the XZ plane, tilted about the x axis by the inclination
+				const PlanetDescription& planet = system.Planets[p];
+				double planetGM = GravitationalConstant * planet.Mass;
+				double phase = planet.PhaseDegrees * DegreesToRadians;
+				double inclination = planet.InclinationDegrees * DegreesToRadians;
+				double speed = sqrt((starGM + planetGM) / planet.OrbitalDistance);
+
+				batch.GM[k] = planetGM;
+				batch.X[k] = planet.OrbitalDistance * cos(phase);
+				batch.Y[k] = planet.OrbitalDistance * sin(phase) * sin(inclination);
+				batch.Z[k] = -planet.OrbitalDistance * sin(phase) * cos(inclination);
+				batch.VX[k] = -speed * sin(phase);
+				batch.VY[k] = speed * cos(phase) * sin(inclination);
+				batch.VZ[k] = -speed * cos(phase) * cos(inclination);
+			}
+
+			// Move to the barycentric frame so the system does not drift
+			double totalGM = 0.0;
+			double moment[3] = { 0.0, 0.0, 0.0 };
+			double momentum[3] = { 0.0, 0.0, 0.0 };
+			for (uint32_t b = 0; b <= batch.PlanetCounts[s]; ++b)
+			{
+				uint32_t k = b * Width + s;
+				totalGM += batch.GM[k];
+				moment[0] += batch.GM[k] * batch.X[k];
+				moment[1] += batch.GM[k] * batch.Y[k];
+				moment[2] += batch.GM[k] * batch.Z[k];
+				momentum[0] += batch.GM[k] * batch.VX[k];
+				momentum[1] += batch.GM[k] * batch.VY[k];
+				momentum[2] += batch.GM[k] * batch.VZ[k];
+			}
+
+			for (uint32_t b = 0; b <= batch.PlanetCounts[s]; ++b)
+			{
+				uint32_t k = b * Width + s;
+				batch.X[k] -= moment[0] / totalGM;
+				batch.Y[k] -= moment[1] / totalGM;
+				batch.Z[k] -= moment[2] / totalGM;
+				batch.VX[k] -= momentum[0] / totalGM;
+				batch.VY[k] -= momentum[1] / totalGM;
+				batch.VZ[k] -= momentum[2] / totalGM;
+			}
+		}
+
+		void CheckStability(const SystemBatch& batch, uint32_t count, const SystemBatchSettings& settings, SystemResult* results)
+		{
+			double escapeDistanceSquared = settings.EscapeDistance * settings.EscapeDistance;
+
+			for (uint32_t s = 0; s < count; ++s)
+			{
+				SystemResult& result = results[s];
+				uint32_t planetCount = batch.PlanetCounts[s];
+
+				for (uint32_t p = 1; p <= planetCount; ++p)
+				{
+					// Osculating orbit of the planet about the star
+					uint32_t k = p * Width + s;
+					double rx = batch.X[k] - batch.X[s];
+					double ry = batch.Y[k] - batch.Y[s];
+					double rz = batch.Z[k] - batch.Z[s];
+					double vx = batch.VX[k] - batch.VX[s];
+					double vy = batch.VY[k] - batch.VY[s];
+					double vz = batch.VZ[k] - batch.VZ[s];
+					double mu = batch.GM[s] + batch.GM[k];
+
+					double distanceSquared = rx * rx + ry * ry + rz * rz;
+					double distance = sqrt(distanceSquared);
+					double speedSquared = vx * vx + vy * vy + vz * vz;
+					double radialSpeed = rx * vx + ry * vy + rz * vz;
+					double scale = speedSquared - mu / distance;
+					double ex = (scale * rx - radialSpeed * vx) / mu;
+					double ey = (scale * ry - radialSpeed * vy) / mu;
+					double ez = (scale * rz - radialSpeed * vz) / mu;
+					double eccentricity = sqrt(ex * ex + ey * ey + ez * ez);
+
+					result.MaxEccentricity = max(result.MaxEccentricity, static_cast<float>(eccentricity));
+					if (eccentricity >= 1.0 || distanceSquared > escapeDistanceSquared)
+					{
+						result.Flags |= static_cast<uint32_t>(SystemResultFlags::Ejection);
+					}
+
+					for (uint32_t q = p + 1; q <= planetCount; ++q)
+					{
+						uint32_t kq = q * Width + s;
+						double dx = batch.X[kq] - batch.X[k];
+						double dy = batch.Y[kq] - batch.Y[k];
+						double dz = batch.Z[kq] - batch.Z[k];
+						float separation = static_cast<float>(sqrt(dx * dx + dy * dy + dz * dz));
+
+						result.MinSeparation = min(result.MinSeparation, separation);
+						if (separation < settings.CloseEncounterDistance)
+						{
+							result.Flags |= static_cast<uint32_t>(SystemResultFlags::CloseEncounter);
+						}
+					}
+				}
+			}
+		}
+	}
+
+	const uint32_t SystemBatchRunner::ResultsMagic = 0x52535953;	// "SYSR"
+	const uint32_t SystemBatchRunner::ResultsVersion = 1;
+
+	SystemBatchRunner::SystemBatchRunner(ThreadPool& threadPool, const SystemBatchSettings& settings) :
+		mThreadPool(&threadPool), mSettings(settings)
+	{
+		if (settings.TimeStepDays <= 0.0 || settings.SampleInterval == 0)
+		{
+			throw GameException("Invalid system batch settings.");
+		}
+	}
+
+	vector<SystemResult> SystemBatchRunner::Run(const vector<PlanetarySystem>& systems) const
+	{
+		uint32_t systemCount = static_cast<uint32_t>(systems.size());
+		vector<SystemResult> results(systemCount);
+		uint32_t batchCount = (systemCount + BatchWidth - 1) / BatchWidth;
+
+		mThreadPool->ParallelFor(batchCount, 1, [&](uint32_t first, uint32_t last)
+		{
+			for (uint32_t batch = first; batch < last; ++batch)
+			{
+				uint32_t firstIndex = batch * BatchWidth;
+				RunBatch(&systems[firstIndex], min(Width, systemCount - firstIndex), firstIndex, &results[firstIndex]);
+			}
+		});
+
+		return results;
+	}
+
+	void SystemBatchRunner::WriteResults(const wstring& filename, const vector<SystemResult>& results) const
+	{
+#if defined(_WIN32)
+		ofstream stream(filename.c_str(), ios::binary);
+#else
+		ofstream stream(Utility::ToPortablePath(filename), ios::binary);
+#endif
+		if (stream.is_open() == false)
+		{
+			throw GameException("Could not open the results file.");
+		}
+
+		SystemResultsHeader header;
+		header.Magic = ResultsMagic;
+		header.Version = ResultsVersion;
+		header.RecordCount = static_cast<uint32_t>(results.size());
+		header.RecordSize = sizeof(SystemResult);
+		header.TimeStepDays = mSettings.TimeStepDays;
+		header.DurationDays = mSettings.DurationDays;
+
+		stream.write(reinterpret_cast<const char*>(&header), sizeof(header));
+		if (results.empty() == false)
+		{
+			stream.write(reinterpret_cast<const char*>(&results[0]), results.size() * sizeof(SystemResult));
+		}
+	}
+
+	PlanetarySystem SystemBatchRunner::FromCatalog(const BodyCatalog& catalog)
+	{
+		uint32_t count = catalog.Count();
+		int32_t starIndex = -1;
+		for (uint32_t i = 0; i < count; ++i)
+		{
+			if (catalog.Record(i).HasFlag(BodyFlags::LightSource))
+			{
+				starIndex = static_cast<int32_t>(i);
+				break;
+			}
+		}
+
+		if (starIndex < 0)
+		{
+			throw GameException("The body catalog has no light source.");
+		}
+
+		PlanetarySystem system = { 0 };
+		system.StarMass = catalog.Record(starIndex).Mass;
+		for (uint32_t i = 0; i < count && system.PlanetCount < PlanetarySystem::MaxPlanets; ++i)
+		{
+			// A body with no parent that is not a light source circles the origin, where the light source sits
+			const BodyCatalogRecord& record = catalog.Record(i);
+			bool orbitsStar = (record.ParentIndex >= 0 ? record.ParentIndex == starIndex : record.HasFlag(BodyFlags::LightSource) == false);
+			if (orbitsStar && record.OrbitalDistance > 0.0f)
+			{
+				PlanetDescription& planet = system.Planets[system.PlanetCount++];
+				planet.Mass = record.Mass;
+				planet.OrbitalDistance = record.OrbitalDistance;
+				planet.PhaseDegrees = 0.0;
+				planet.InclinationDegrees = record.Inclination;
+			}
+		}
+
+		if (system.PlanetCount == 0)
+		{
+			throw GameException("The body catalog has no planets orbiting its light source.");
+		}
+
+		return system;
+	}
+
+	vector<PlanetarySystem> SystemBatchRunner::GeneratePopulation(uint32_t count, uint32_t seed)
+	{
+		mt19937 generator(seed);
+		uniform_real_distribution<double> unit(0.0, 1.0);
+		uniform_int_distribution<uint32_t> planetCounts(1, PlanetarySystem::MaxPlanets);
+
+		vector<PlanetarySystem> systems(count);
+		for (PlanetarySystem& system : systems)
+		{
+			system.StarMass = EarthMassesPerSolarMass * (0.5 + unit(generator));
+			system.PlanetCount = planetCounts(generator);
+
+			// Log-uniform masses and a geometric progression of orbits starting between 0.1 and 0.5 astronomical units
+			double distance = 0.1 * pow(5.0, unit(generator));
+			for (uint32_t p = 0; p < system.PlanetCount; ++p)
+			{
+				PlanetDescription& planet = system.Planets[p];
+				planet.Mass = 0.1 * pow(3.0e4, unit(generator));
+				planet.OrbitalDistance = distance;
+				planet.PhaseDegrees = 360.0 * unit(generator);
+				planet.InclinationDegrees = 3.0 * unit(generator);
+
+				distance *= 1.3 + 1.2 * unit(generator);
+			}
+		}
+
+		return systems;
+	}
+
+	void SystemBatchRunner::RunBatch(const PlanetarySystem* systems, uint32_t count, uint32_t firstIndex, SystemResult* results) const
+	{
+		auto batch = make_unique<SystemBatch>();
+
+		// Lanes past the end of the input carry a copy of the first system and are never reported
+		for (uint32_t s = 0; s < Width; ++s)
+		{
+			LoadSystem(*batch, s, systems[s < count ? s : 0]);
+		}
+
+		for (uint32_t s = 0; s < count; ++s)
+		{
+			results[s].SystemIndex = firstIndex + s;
+			results[s].Flags = static_cast<uint32_t>(SystemResultFlags::None);
+			results[s].RelativeEnergyError = 0.0f;
+			results[s].MaxEccentricity = 0.0f;
+			results[s].MinSeparation = numeric_limits<float>::max();
+		}
+
+		double initialEnergies[Width];
+		double finalEnergies[Width];
+		ComputeEnergies(*batch, initialEnergies);
+		ComputeAccelerations(*batch);
+
+		// Kick-drift-kick leapfrog
+		const double timeStep = mSettings.TimeStepDays;
+		const double halfStep = timeStep * 0.5;
+		uint64_t stepCount = static_cast<uint64_t>(ceil(mSettings.DurationDays / timeStep));
+		for (uint64_t step = 1; step <= stepCount; ++step)
+		{
+			Kick(*batch, halfStep);
+			Drift(*batch, timeStep);
+			ComputeAccelerations(*batch);
+			Kick(*batch, halfStep);
+
+			if (step % mSettings.SampleInterval == 0 || step == stepCount)
+			{
+				CheckStability(*batch, count, mSettings, results);
+			}
+		}
+
+		ComputeEnergies(*batch, finalEnergies);
+		for (uint32_t s = 0; s < count; ++s)
+		{
+			results[s].RelativeEnergyError = static_cast<float>(fabs((finalEnergies[s] - initialEnergies[s]) / initialEnergies[s]));
+		}
+	}
+}
\ No newline at end of file
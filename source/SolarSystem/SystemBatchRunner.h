@@ -0,0 +1,122 @@
+#pragma once
+
+#include <vector>
+#include <string>
+#include <cstdint>
+
+namespace Library
+{
+	class BodyCatalog;
+	class ThreadPool;
+}
+
+namespace Rendering
+{
+	struct PlanetDescription
+	{
+		double Mass;				// Earth masses
+		double OrbitalDistance;		// Astronomical units
+		double PhaseDegrees;		// Starting angle along the orbit
+		double InclinationDegrees;
+	};
+
+	/**
+	* An independent system of one star and up to MaxPlanets planets on initially circular orbits.
+	*/
+	struct PlanetarySystem
+	{
+		static const std::uint32_t MaxPlanets = 8;
+
+		double StarMass;			// Earth masses
+		std::uint32_t PlanetCount;
+		PlanetDescription Planets[MaxPlanets];
+	};
+
+	struct SystemBatchSettings
+	{
+		double TimeStepDays;
+		double DurationDays;
+		std::uint32_t SampleInterval;		// Steps between stability checks
+		double EscapeDistance;				// Astronomical units
+		double CloseEncounterDistance;		// Astronomical units
+	};
+
+	enum class SystemResultFlags : std::uint32_t
+	{
+		None = 0x0,
+		Ejection = 0x1,			// A planet became unbound or left the escape distance
+		CloseEncounter = 0x2	// Two planets came within the close encounter distance
+	};
+
+	/**
+	* The outcome of integrating one system, as stored in the results file.
+	*/
+	struct SystemResult
+	{
+		std::uint32_t SystemIndex;
+		std::uint32_t Flags;
+		float RelativeEnergyError;
+		float MaxEccentricity;
+		float MinSeparation;		// Astronomical units, between any two planets
+	};
+
+	struct SystemResultsHeader
+	{
+		std::uint32_t Magic;
+		std::uint32_t Version;
+		std::uint32_t RecordCount;
+		std::uint32_t RecordSize;
+		double TimeStepDays;
+		double DurationDays;
+	};
+
+	static_assert(sizeof(SystemResult) == 20, "SystemResult must match the file layout.");
+	static_assert(sizeof(SystemResultsHeader) == 32, "SystemResultsHeader must match the file layout.");
+
+	/**
+	* Integrates many small planetary systems for population studies. Systems are packed BatchWidth at a time into a
+	* structure-of-arrays batch indexed by body then system, so the innermost loops run across systems and fill the
+	* vector lanes that a single system of a few bodies would leave idle. Batches are spread over a thread pool.
+	*/
+	class SystemBatchRunner final
+	{
+	public:
+		SystemBatchRunner(Library::ThreadPool& threadPool, const SystemBatchSettings& settings);
+		SystemBatchRunner(const SystemBatchRunner&) = delete;
+		SystemBatchRunner& operator=(const SystemBatchRunner&) = delete;
+		SystemBatchRunner(SystemBatchRunner&&) = delete;
+		SystemBatchRunner& operator=(SystemBatchRunner&&) = delete;
+		~SystemBatchRunner() = default;
+
+		/**
+		* Integrate every system with a leapfrog scheme.
+		* @return One result per system, in the order of the input.
+		*/
+		std::vector<SystemResult> Run(const std::vector<PlanetarySystem>& systems) const;
+
+		/**
+		* Write results to a compact binary file: a SystemResultsHeader followed by the records.
+		*/
+		void WriteResults(const std::wstring& filename, const std::vector<SystemResult>& results) const;
+
+		/**
+		* Build a system from the light source of a catalog and the bodies that orbit it directly, either as their parent
+		* or, having no parent, around the origin where it sits. Throws a GameException when no body orbits it.
+		*/
+		static PlanetarySystem FromCatalog(const Library::BodyCatalog& catalog);
+		/**
+		* Generate a reproducible population of random systems.
+		*/
+		static std::vector<PlanetarySystem> GeneratePopulation(std::uint32_t count, std::uint32_t seed);
+
+		static const std::uint32_t BatchWidth = 64;
+		static const std::uint32_t ResultsMagic;
+		static const std::uint32_t ResultsVersion;
+
+	private:
+		void RunBatch(const PlanetarySystem* systems, std::uint32_t count, std::uint32_t firstIndex, SystemResult* results) const;
+
+		Library::ThreadPool* mThreadPool;
+		SystemBatchSettings mSettings;
+	};
+}
\ No newline at end of file
@@ -0,0 +1,321 @@
+#include "pch.h"
+
+using namespace std;
+using namespace Library;
+
+namespace Rendering
+{
+	namespace
+	{
+		const size_t ReceiveChunkSize = 16 * 1024;
+		const size_t MaxMessageSize = 64 * 1024 * 1024;
+
+		// Writing to a viewer that has gone must fail the write rather than raise SIGPIPE in the whole process
+#if defined(MSG_NOSIGNAL)
+		const int SendFlags = MSG_NOSIGNAL;
+#else
+		const int SendFlags = 0;
+#endif
+
+		/**
+		* Make a descriptor non-blocking and keep it from the processes this one starts.
+		*/
+		bool Configure(int descriptor)
+		{
+			int flags = fcntl(descriptor, F_GETFL);
+			return (flags != -1 && fcntl(descriptor, F_SETFL, flags | O_NONBLOCK) != -1 && fcntl(descriptor, F_SETFD, FD_CLOEXEC) != -1);
+		}
+
+		void CreateCancelPipe(int (&cancelPipe)[2])
+		{
+			if (pipe(cancelPipe) != 0)
+			{
+				throw GameException("pipe() failed.");
+			}
+
+			if (Configure(cancelPipe[0]) == false || Configure(cancelPipe[1]) == false)
+			{
+				close(cancelPipe[0]);
+				close(cancelPipe[1]);
+				throw GameException("Could not configure the cancel pipe of a snapshot socket.");
+			}
+		}
+
+		/**
+		* Wake every thread polling the read end of a cancel pipe, now and on every later poll.
+		*/
+		void SignalCancelPipe(int (&cancelPipe)[2])
+		{
+			const char signal = 1;
+			ssize_t written = write(cancelPipe[1], &signal, sizeof(signal));
+			UNREFERENCED_PARAMETER(written);
+		}
+
+		/**
+		* Wait for events on a socket, or for its cancel pipe to be written.
+		* @return False if the wait was cancelled or failed.
+		*/
+		bool WaitForSocket(int socket, short events, int cancelPipe)
+		{
+			pollfd descriptors[] = { { socket, events, 0 }, { cancelPipe, POLLIN, 0 } };
+			for (;;)
+			{
+				int result = poll(descriptors, ARRAYSIZE(descriptors), -1);
+				if (result > 0)
+				{
+					return (descriptors[1].revents == 0);
+				}
+
+				if (result < 0 && errno != EINTR)
+				{
+					return false;
+				}
+			}
+		}
+
+		sockaddr_un SocketAddress(const string& path)
+		{
+			sockaddr_un address = {};
+			if (path.empty() || path.size() >= sizeof(address.sun_path))
+			{
+				throw GameException("The snapshot socket path is empty or too long.");
+			}
+
+			address.sun_family = AF_UNIX;
+			memcpy(address.sun_path, path.c_str(), path.size() + 1);
+
+			return address;
+		}
+	}
+
+	UnixSocketConnection::UnixSocketConnection(int socket) :
+		mSocket(socket), mCancelPipe(), mCancelled(false), mClosed(false)
+	{
+		try
+		{
+			if (Configure(mSocket) == false)
+			{
+				throw GameException("Could not configure a snapshot socket.");
+			}
+
+#if defined(SO_NOSIGPIPE)
+			int noSignal = 1;
+			setsockopt(mSocket, SOL_SOCKET, SO_NOSIGPIPE, &noSignal, sizeof(noSignal));
+#endif
+
+			CreateCancelPipe(mCancelPipe);
+		}
+		catch (...)
+		{
+			close(mSocket);
+			throw;
+		}
+	}
+
+	UnixSocketConnection::~UnixSocketConnection()
+	{
+		close(mSocket);
+		close(mCancelPipe[0]);
+		close(mCancelPipe[1]);
+	}
+
+	bool UnixSocketConnection::Send(const void* data, size_t size)
+	{
+		if (mCancelled || size > MaxMessageSize)
+		{
+			return false;
+		}
+
+		uint32_t messageSize = static_cast<uint32_t>(size);
+		return (SendAll(reinterpret_cast<const uint8_t*>(&messageSize), sizeof(messageSize)) && SendAll(static_cast<const uint8_t*>(data), size));
+	}
+
+	bool UnixSocketConnection::TryReceive(vector<uint8_t>& message, bool& received)
+	{
+		received = false;
+		if (mCancelled)
+		{
+			return false;
+		}
+
+		// Read whatever has arrived, which may end partway through a message
+		uint8_t chunk[ReceiveChunkSize];
+		while (mClosed == false)
+		{
+			ssize_t count = recv(mSocket, chunk, sizeof(chunk), 0);
+			if (count > 0)
+			{
+				mReceived.insert(mReceived.end(), chunk, chunk + count);
+			}
+			else if (count == 0)
+			{
+				mClosed = true;
+			}
+			else if (errno == EAGAIN || errno == EWOULDBLOCK)
+			{
+				break;
+			}
+			else if (errno != EINTR)
+			{
+				return false;
+			}
+		}
+
+		uint32_t messageSize = 0;
+		if (mReceived.size() >= sizeof(messageSize))
+		{
+			memcpy(&messageSize, mReceived.data(), sizeof(messageSize));
+			if (messageSize > MaxMessageSize)
+			{
+				return false;
+			}
+
+			if (mReceived.size() >= sizeof(messageSize) + messageSize)
+			{
+				auto first = mReceived.begin() + sizeof(messageSize);
+				message.assign(first, first + messageSize);
+				mReceived.erase(mReceived.begin(), first + messageSize);
+				received = true;
+				return true;
+			}
+		}
+
+		// The messages that arrived before the other end closed are still delivered
+		return (mClosed == false);
+	}
+
+	void UnixSocketConnection::Cancel()
+	{
+		mCancelled = true;
+		SignalCancelPipe(mCancelPipe);
+	}
+
+	unique_ptr<UnixSocketConnection> UnixSocketConnection::Connect(const wstring& path)
+	{
+		sockaddr_un address = SocketAddress(Utility::ToString(path));
+		int connection = socket(AF_UNIX, SOCK_STREAM, 0);
+		if (connection == -1)
+		{
+			throw GameException("socket() failed.");
+		}
+
+		if (connect(connection, reinterpret_cast<const sockaddr*>(&address), sizeof(address)) != 0)
+		{
+			close(connection);
+			throw GameException("Could not connect to the snapshot server.");
+		}
+
+		return make_unique<UnixSocketConnection>(connection);
+	}
+
+	bool UnixSocketConnection::SendAll(const uint8_t* data, size_t size)
+	{
+		while (size > 0)
+		{
+			ssize_t written = send(mSocket, data, size, SendFlags);
+			if (written > 0)
+			{
+				data += written;
+				size -= static_cast<size_t>(written);
+			}
+			else if (written < 0 && (errno == EAGAIN || errno == EWOULDBLOCK))
+			{
+				if (WaitForSocket(mSocket, POLLOUT, mCancelPipe[0]) == false)
+				{
+					return false;
+				}
+			}
+			else if (written == 0 || errno != EINTR)
+			{
+				return false;
+			}
+		}
+
+		return true;
+	}
+
+	UnixSocketListener::UnixSocketListener(const wstring& path) :
+		mPath(Utility::ToString(path)), mSocket(-1), mCancelPipe()
+	{
+		sockaddr_un address = SocketAddress(mPath);
+		mSocket = socket(AF_UNIX, SOCK_STREAM, 0);
+		if (mSocket == -1)
+		{
+			throw GameException("socket() failed.");
+		}
+
+		bool bound = (bind(mSocket, reinterpret_cast<const sockaddr*>(&address), sizeof(address)) == 0);
+		if (bound == false && errno == EADDRINUSE)
+		{
+			// A path nothing accepts on is left from a server that exited without removing it
+			int probe = socket(AF_UNIX, SOCK_STREAM, 0);
+			bool serverRunning = (probe != -1 && connect(probe, reinterpret_cast<const sockaddr*>(&address), sizeof(address)) == 0);
+			if (probe != -1)
+			{
+				close(probe);
+			}
+
+			if (serverRunning == false && unlink(mPath.c_str()) == 0)
+			{
+				bound = (bind(mSocket, reinterpret_cast<const sockaddr*>(&address), sizeof(address)) == 0);
+			}
+		}
+
+		if (bound == false)
+		{
+			close(mSocket);
+			throw GameException("Could not bind the snapshot socket; another server may be listening at its path.");
+		}
+
+		if (listen(mSocket, SOMAXCONN) != 0 || Configure(mSocket) == false)
+		{
+			close(mSocket);
+			unlink(mPath.c_str());
+			throw GameException("Could not listen on the snapshot socket.");
+		}
+
+		try
+		{
+			CreateCancelPipe(mCancelPipe);
+		}
+		catch (...)
+		{
+			close(mSocket);
+			unlink(mPath.c_str());
+			throw;
+		}
+	}
+
+	UnixSocketListener::~UnixSocketListener()
+	{
+		close(mSocket);
+		unlink(mPath.c_str());
+		close(mCancelPipe[0]);
+		close(mCancelPipe[1]);
+	}
+
+	unique_ptr<SnapshotConnection> UnixSocketListener::Accept()
+	{
+		while (WaitForSocket(mSocket, POLLIN, mCancelPipe[0]))
+		{
+			int connection = accept(mSocket, nullptr, nullptr);
+			if (connection != -1)
+			{
+				return make_unique<UnixSocketConnection>(connection);
+			}
+
+			// A viewer that gave up before it was accepted leaves nothing to accept
+			if (errno != EINTR && errno != EAGAIN && errno != EWOULDBLOCK && errno != ECONNABORTED)
+			{
+				break;
+			}
+		}
+
+		return nullptr;
+	}
+
+	void UnixSocketListener::Cancel()
+	{
+		SignalCancelPipe(mCancelPipe);
+	}
+}
\ No newline at end of file
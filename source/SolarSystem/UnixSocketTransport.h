@@ -0,0 +1,69 @@
+#pragma once
+
+#include "SnapshotTransport.h"
+#include <atomic>
+
+namespace Rendering
+{
+	/**
+	* A snapshot connection over a Unix domain stream socket. Each message is sent after its size as a 32-bit count,
+	* and a pipe written by Cancel() wakes a thread waiting to send.
+	*/
+	class UnixSocketConnection final : public SnapshotConnection
+	{
+	public:
+		/**
+		* Take a connected stream socket.
+		*/
+		UnixSocketConnection(int socket);
+		UnixSocketConnection(const UnixSocketConnection&) = delete;
+		UnixSocketConnection& operator=(const UnixSocketConnection&) = delete;
+		UnixSocketConnection(UnixSocketConnection&&) = delete;
+		UnixSocketConnection& operator=(UnixSocketConnection&&) = delete;
+		~UnixSocketConnection();
+
+		virtual bool Send(const void* data, std::size_t size) override;
+		virtual bool TryReceive(std::vector<std::uint8_t>& message, bool& received) override;
+		virtual void Cancel() override;
+
+		/**
+		* Connect to the server listening at a socket path.
+		*/
+		static std::unique_ptr<UnixSocketConnection> Connect(const std::wstring& path);
+
+	private:
+		bool SendAll(const std::uint8_t* data, std::size_t size);
+
+		int mSocket;
+		int mCancelPipe[2];
+		std::atomic<bool> mCancelled;
+		bool mClosed;
+		std::vector<std::uint8_t> mReceived;		// Bytes read past the last whole message
+	};
+
+	/**
+	* Listens for viewers on a Unix domain socket, bound to a path in the file system.
+	*/
+	class UnixSocketListener final : public SnapshotListener
+	{
+	public:
+		/**
+		* Bind a socket path, replacing one left behind by a server that has exited and failing if a server still
+		* listens there.
+		*/
+		UnixSocketListener(const std::wstring& path);
+		UnixSocketListener(const UnixSocketListener&) = delete;
+		UnixSocketListener& operator=(const UnixSocketListener&) = delete;
+		UnixSocketListener(UnixSocketListener&&) = delete;
+		UnixSocketListener& operator=(UnixSocketListener&&) = delete;
+		~UnixSocketListener();
+
+		virtual std::unique_ptr<SnapshotConnection> Accept() override;
+		virtual void Cancel() override;
+
+	private:
+		std::string mPath;
+		int mSocket;
+		int mCancelPipe[2];
+	};
+}
\ No newline at end of file
@@ -3,11 +3,141 @@
 // 2. Program.cpp
 // 3. RenderingGame.cpp
 // 4. AstronomicalObject.cpp
+// 5. SolarSystemSimulation.cpp
+// 6. ShardedSimulation.cpp
+// 7. SnapshotCodec.cpp
+// 8. SnapshotTransport.cpp
+// 9. NamedPipeTransport.cpp
+// 10. SnapshotServer.cpp
+// 11. SnapshotClient.cpp
+// 12. SystemBatchRunner.cpp
+// 13. EventFinder.cpp
+// 14. ShadowOccluderPass.cpp
+// 15. SatellitePropagator.cpp
+// 16. SatelliteLayer.cpp
+// 17. ReferenceFrameGraph.cpp
+// 18. ParameterSweep.cpp
+// 19. GravityFieldSampler.cpp
+// 20. InstanceBatcher.cpp
+// 21. PlanetRenderer.cpp
+// 22. FrustumCuller.cpp
+// 23. SoftwarePlanetShader.cpp
+// 24. FrameSequenceRenderer.cpp
+// 25. IcosphereLodChain.cpp
+// 26. GravityWellLayer.cpp
+// 27. MinorPlanetLayer.cpp
+// 28. HeadlessModes.cpp
 #pragma once
 
+#if defined(LIBRARY_PORTABLE)
+
+// Ҫͼ豸Ĳ,  CMake κƽ̨
+
+// Standard
+#include <exception>
+#include <stdexcept>
+#include <cassert>
+#include <string>
+#include <iostream>
+#include <sstream>
+#include <fstream>
+#include <memory>
+#include <vector>
+#include <map>
+#include <cstdint>
+#include <iomanip>
+#include <algorithm>
+#include <functional>
+#include <atomic>
+#include <limits>
+#include <chrono>
+#include <thread>
+#include <mutex>
+#include <random>
+#include <cmath>
+#include <cfloat>
+#include <cwchar>
+
+// Library
+#include "Platform.h"
+
+#if defined(LIBRARY_HAS_DIRECTXMATH)
+#include <DirectXMath.h>
+#endif
+
+#include "RTTI.h"
+#include "GameException.h"
+#include "Utility.h"
+#include "TextureCache.h"
+#include "QoiImageEncoder.h"
+#include "RenderQueue.h"
+#include "RecordingRenderBackend.h"
+#include "RenderDevice.h"
+#include "RecordingRenderDevice.h"
+#include "DeviceRenderBackend.h"
+#include "FrameConstantAllocator.h"
+#include "MemoryConstantBufferStorage.h"
+#include "DeviceConstantBufferStorage.h"
+#include "ThreadPool.h"
+#include "MemoryMappedFile.h"
+#include "SharedMemoryRegion.h"
+#include "SpscRingBuffer.h"
+#include "BodyCatalog.h"
+#include "MinorPlanetCatalog.h"
+#include "Vsop87Theory.h"
+#include "LaneMath.h"
+#include "AngleAccumulator.h"
+
+#if defined(LIBRARY_HAS_IMAGE_DECODER)
+#include "PortableImageDecoder.h"
+#endif
+
+#if defined(LIBRARY_HAS_DIRECTXMATH)
+#include "MatrixHelper.h"
+#include "VectorHelper.h"
+#include "StreamHelper.h"
+#include "Model.h"
+#include "ModelMaterial.h"
+#include "Mesh.h"
+#include "VertexDeclarations.h"
+#include "SoftwareTexture.h"
+#include "SoftwareRasterizer.h"
+#include "SoftwareSkyboxShader.h"
+#endif
+
+// Local
+#include "ShardedSimulation.h"
+#include "SystemBatchRunner.h"
+#include "ParameterSweep.h"
+#include "EventFinder.h"
+
+#if defined(LIBRARY_HAS_DIRECTXMATH)
+#include "ShadowOccluderPass.h"
+#include "InstanceBatcher.h"
+#include "FrustumCuller.h"
+#include "SoftwarePlanetShader.h"
+#include "SolarSystemSimulation.h"
+#include "SnapshotTransport.h"
+#if defined(_WIN32)
+#include "NamedPipeTransport.h"
+#else
+#include "UnixSocketTransport.h"
+#endif
+#include "SnapshotCodec.h"
+#include "SnapshotServer.h"
+#include "SnapshotClient.h"
+#include "SatellitePropagator.h"
+#include "FrameSequenceRenderer.h"
+#endif
+
+#include "HeadlessModes.h"
+
+#else
+
 // Windows
 #include <windows.h>
 #include <wrl.h>
+#include <wincodec.h>
 
 // Standard
 #include <exception>
@@ -25,6 +155,16 @@
 #include <codecvt>
 #include <algorithm>
 #include <functional>
+#include <atomic>
+#include <limits>
+#include <deque>
+#include <chrono>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <future>
+#include <queue>
+#include <random>
 
 #if defined(DEBUG) || defined(_DEBUG)
 #define _CRTDBG_MAP_ALLOC
@@ -74,21 +214,73 @@
 #include "RasterizerStates.h"
 #include "SamplerStates.h"
 #include "RenderStateHelper.h"
+#include "TextOverlay.h"
 #include "FpsComponent.h"
 #include "StreamHelper.h"
 #include "..\Library.Shared\Model.h"
 #include "..\Library.Shared\Mesh.h"
 #include "..\Library.Shared\ModelMaterial.h"
+#include "ModelCache.h"
+#include "TextureCache.h"
+#include "WicImageDecoder.h"
+#include "QoiImageEncoder.h"
+#include "RenderQueue.h"
+#include "RecordingRenderBackend.h"
+#include "RenderDevice.h"
+#include "D3D11RenderDevice.h"
+#include "RecordingRenderDevice.h"
+#include "DeviceRenderBackend.h"
+#include "FrameConstantAllocator.h"
+#include "MemoryConstantBufferStorage.h"
+#include "DeviceConstantBufferStorage.h"
+#include "SoftwareTexture.h"
+#include "SoftwareRasterizer.h"
+#include "SoftwareSkyboxShader.h"
 #include "ProxyModel.h"
 #include "Skybox.h"
 #include "MouseComponent.h"
 #include "KeyboardComponent.h"
 #include "GamePadComponent.h"
 #include "Grid.h"
+#include "MemoryMappedFile.h"
+#include "BodyCatalog.h"
+#include "SharedMemoryRegion.h"
+#include "SpscRingBuffer.h"
+#include "ThreadPool.h"
+#include "MinorPlanetCatalog.h"
+#include "LaneMath.h"
+#include "Vsop87Theory.h"
+#include "AngleAccumulator.h"
 
 // Library.Desktop
 #include "UtilityWin32.h"
 
 // Local
 #include "RenderingGame.h"
+#include "SolarSystemSimulation.h"
+#include "ShardedSimulation.h"
+#include "SnapshotTransport.h"
+#include "NamedPipeTransport.h"
+#include "SnapshotCodec.h"
+#include "SnapshotServer.h"
+#include "SnapshotClient.h"
+#include "SystemBatchRunner.h"
+#include "ParameterSweep.h"
+#include "EventFinder.h"
+#include "ShadowOccluderPass.h"
+#include "InstanceBatcher.h"
+#include "FrustumCuller.h"
+#include "IcosphereLodChain.h"
+#include "SoftwarePlanetShader.h"
+#include "PlanetRenderer.h"
+#include "SatellitePropagator.h"
+#include "ReferenceFrameGraph.h"
+#include "GravityFieldSampler.h"
 #include "AstronomicalObject.h"
+#include "SatelliteLayer.h"
+#include "GravityWellLayer.h"
+#include "MinorPlanetLayer.h"
+#include "FrameSequenceRenderer.h"
+#include "HeadlessModes.h"
+
+#endif
@@ -0,0 +1,93 @@
+#include "pch.h"
+
+using namespace std;
+using namespace Library;
+
+namespace
+{
+	const char* const FileName = "BodyCatalogTest.bin";
+	const wchar_t* const WideFileName = L"BodyCatalogTest.bin";
+
+	const char* const Source =
+		"Name,Parent,Flags,AmbientIntensity,AxialTilt,RotationDays,RevolutionDays,OrbitalDistance,TrueDistance,Inclination,AscendingNode,NodalPeriodDays,Scale,Mass,Radius,Texture\n"
+		"Sun,,LightSource,1.0,0.0,25.0,0.0,0.0,0.0,0.0,0.0,0.0,10.0,332946.0,695700.0,Sun.jpg\n"
+		"Earth,Sun,,0.1,23.4,1.0,365.25,1.0,1.0,0.0,0.0,0.0,1.0,1.0,6371.0,Earth.jpg\n"
+		"Moon,Earth,,0.1,6.7,27.3,27.3,0.05,0.00257,5.1,125.0,-6798.4,0.3,0.0123,1737.0,Moon.jpg\n";
+
+	uint32_t Failures = 0;
+
+	void Check(bool condition, const char* description)
+	{
+		if (condition == false)
+		{
+			cerr << "Failed: " << description << endl;
+			++Failures;
+		}
+	}
+
+	/**
+	* Write a catalog compiled from the source, with one record changed by the given edit, and report whether it loads.
+	*/
+	template <typename Edit>
+	bool Loads(uint32_t recordIndex, Edit edit)
+	{
+		stringstream source(Source);
+		stringstream compiled;
+		BodyCatalog::Compile(source, compiled);
+
+		string contents = compiled.str();
+		BodyCatalogRecord* records = reinterpret_cast<BodyCatalogRecord*>(&contents[sizeof(BodyCatalogHeader)]);
+		edit(records[recordIndex]);
+
+		{
+			ofstream file(FileName, ios::binary);
+			file.write(contents.data(), static_cast<streamsize>(contents.size()));
+			if (file.good() == false)
+			{
+				throw GameException("Could not write a test catalog.");
+			}
+		}
+
+		try
+		{
+			BodyCatalog catalog(WideFileName);
+		}
+		catch (const GameException&)
+		{
+			return false;
+		}
+
+		return true;
+	}
+}
+
+int main()
+{
+	try
+	{
+		Check(Loads(2, [](BodyCatalogRecord&) { }), "a valid catalog loads");
+
+		Check(Loads(1, [](BodyCatalogRecord& record) { record.NameOffset = 0xFFFF; }) == false, "a name past the string table is rejected");
+		Check(Loads(2, [](BodyCatalogRecord& record) { record.TextureNameOffset = 0x80000000; }) == false, "a texture name past the string table is rejected");
+
+		Check(Loads(1, [](BodyCatalogRecord& record) { record.ParentIndex = 2; }) == false, "a parent listed after its child is rejected");
+		Check(Loads(1, [](BodyCatalogRecord& record) { record.ParentIndex = 1; }) == false, "a body that is its own parent is rejected");
+		Check(Loads(0, [](BodyCatalogRecord& record) { record.ParentIndex = 100; }) == false, "a parent past the records is rejected");
+		Check(Loads(2, [](BodyCatalogRecord& record) { record.ParentIndex = -2; }) == false, "a negative parent other than none is rejected");
+		Check(Loads(2, [](BodyCatalogRecord& record) { record.ParentIndex = 0; }), "a parent listed earlier than the previous body loads");
+
+		// The catalog the game ships with
+		BodyCatalog catalog(L"Content\\Catalogs\\SolarSystem.csv.bin");
+		Check(catalog.Count() > 0 && catalog.IndexOf("Earth") >= 0, "the content catalog loads");
+	}
+	catch (const exception& ex)
+	{
+		cerr << ex.what() << endl;
+		++Failures;
+	}
+
+	remove(FileName);
+
+	cout << Failures << " checks failed." << endl;
+	return (Failures == 0 ? 0 : 1);
+}
\ No newline at end of file
@@ -0,0 +1,153 @@
+#include "pch.h"
+
+using namespace std;
+using namespace Library;
+using namespace Rendering;
+
+namespace
+{
+	const char* const FileName = "EventFinderTest.bin";
+	const wchar_t* const WideFileName = L"EventFinderTest.bin";
+
+	const double EarthRevolutionDays = 365.25;
+	const double MoonRevolutionDays = 27.32;
+	const double SynodicMonthDays = 1.0 / (1.0 / MoonRevolutionDays - 1.0 / EarthRevolutionDays);
+	const double SearchYears = 10.0;
+	const double PeakToleranceDays = 1.0e-3;
+
+	// The Moon is drawn twenty times further out than it is, as in the catalog of the game, and its orbit lies in the
+	// ecliptic, so every new moon eclipses the Sun from the Earth and every full moon eclipses it from the Moon
+	const char* const Source =
+		"Name,Parent,Flags,AmbientIntensity,AxialTilt,RotationDays,RevolutionDays,OrbitalDistance,TrueDistance,Inclination,AscendingNode,NodalPeriodDays,Scale,Mass,Radius,Texture\n"
+		"Sun,,LightSource,1.0,0.0,25.0,0.0,0.0,0.0,0.0,0.0,0.0,10.0,332946.0,695700.0,Sun.jpg\n"
+		"Earth,,,0.1,23.4,1.0,365.25,1.0,1.0,0.0,0.0,0.0,1.0,1.0,6371.0,Earth.jpg\n"
+		"Moon,Earth,,0.1,6.7,27.32,27.32,0.05,0.00256955,0.0,0.0,0.0,0.3,0.0123,1737.4,Moon.jpg\n";
+
+	uint32_t Failures = 0;
+
+	void Check(bool condition, const char* description)
+	{
+		if (condition == false)
+		{
+			cerr << "Failed: " << description << endl;
+			++Failures;
+		}
+	}
+
+	vector<AstronomicalEvent> Select(const vector<AstronomicalEvent>& events, AstronomicalEventType type, uint32_t observer, uint32_t nearBody, uint32_t farBody)
+	{
+		vector<AstronomicalEvent> selected;
+		copy_if(events.begin(), events.end(), back_inserter(selected), [&](const AstronomicalEvent& event)
+		{
+			return (event.Type == type && event.Observer == observer && event.Near == nearBody && event.Far == farBody);
+		});
+
+		return selected;
+	}
+
+	/**
+	* Whether the events peak, in order, at the given phase of every synodic month of the span and at no other time.
+	*/
+	bool PeakEveryMonth(const vector<AstronomicalEvent>& events, double startDays, double endDays, double phase)
+	{
+		vector<double> expected;
+		for (double peak = phase * SynodicMonthDays; peak < endDays; peak += SynodicMonthDays)
+		{
+			if (peak >= startDays)
+			{
+				expected.push_back(peak);
+			}
+		}
+
+		if (events.size() != expected.size())
+		{
+			return false;
+		}
+
+		for (size_t i = 0; i < events.size(); ++i)
+		{
+			if (fabs(events[i].PeakDays - expected[i]) > PeakToleranceDays || events[i].BeginDays >= events[i].PeakDays || events[i].EndDays <= events[i].PeakDays)
+			{
+				return false;
+			}
+		}
+
+		return true;
+	}
+}
+
+int main()
+{
+	try
+	{
+		ThreadPool threadPool;
+
+		// A Moon in the ecliptic: the dates of every eclipse are known
+		{
+			stringstream source(Source);
+			{
+				ofstream file(FileName, ios::binary);
+				BodyCatalog::Compile(source, file);
+				if (file.good() == false)
+				{
+					throw GameException("Could not write a test catalog.");
+				}
+			}
+
+			BodyCatalog catalog(WideFileName);
+			uint32_t sun = catalog.IndexOf("Sun");
+			uint32_t earth = catalog.IndexOf("Earth");
+			uint32_t moon = catalog.IndexOf("Moon");
+
+			EventSearchSettings settings = EventFinder::DefaultSettings(1.0, 1.0 + SearchYears * EarthRevolutionDays);
+			settings.Observers = { earth, moon };
+
+			EventFinder finder(catalog, threadPool);
+			vector<AstronomicalEvent> events = finder.Find(settings);
+
+			Check(PeakEveryMonth(Select(events, AstronomicalEventType::Eclipse, earth, moon, sun), settings.StartDays, settings.EndDays, 0.5), "the Moon eclipses the Sun from the Earth at every new moon");
+			Check(PeakEveryMonth(Select(events, AstronomicalEventType::Eclipse, moon, earth, sun), settings.StartDays, settings.EndDays, 0.0), "the Earth eclipses the Sun from the Moon at every full moon");
+			Check(Select(events, AstronomicalEventType::Transit, earth, moon, sun).empty() && Select(events, AstronomicalEventType::Transit, moon, earth, sun).empty(), "no eclipse is taken for a transit");
+		}
+
+		// The catalog the game ships with, whose Moon is drawn further out than it is and inclined to the ecliptic
+		{
+			BodyCatalog catalog(L"Content\\Catalogs\\SolarSystem.csv.bin");
+			uint32_t sun = catalog.IndexOf("Sun");
+			uint32_t earth = catalog.IndexOf("Earth");
+			uint32_t moon = catalog.IndexOf("Moon");
+
+			const double centuryDays = 100.0 * 365.25;
+			EventSearchSettings settings = EventFinder::DefaultSettings(0.0, centuryDays);
+			settings.Observers = { earth, moon };
+
+			EventFinder finder(catalog, threadPool);
+			vector<AstronomicalEvent> events = finder.Find(settings);
+			vector<AstronomicalEvent> solarEclipses = Select(events, AstronomicalEventType::Eclipse, earth, moon, sun);
+			vector<AstronomicalEvent> lunarEclipses = Select(events, AstronomicalEventType::Eclipse, moon, earth, sun);
+			Check(solarEclipses.empty() == false && lunarEclipses.empty() == false, "a century has solar and lunar eclipses");
+			Check(Select(events, AstronomicalEventType::Transit, earth, moon, sun).empty(), "the Moon never transits the Sun from the Earth");
+
+			// The Sun passes a node of the Moon twice an eclipse year, and its disk meets the Moon's at no more than one new
+			// moon of each pass
+			const double eclipseSeasonDays = 0.5 / (1.0 / 365.256 + 1.0 / 6798.38);
+			bool oneEachSeason = (solarEclipses.size() <= static_cast<size_t>(centuryDays / eclipseSeasonDays) + 1);
+			for (size_t i = 1; i < solarEclipses.size(); ++i)
+			{
+				oneEachSeason = oneEachSeason && (solarEclipses[i].PeakDays - solarEclipses[i - 1].PeakDays > eclipseSeasonDays - SynodicMonthDays);
+			}
+
+			Check(oneEachSeason, "solar eclipses fall no more than once each eclipse season");
+		}
+	}
+	catch (const exception& ex)
+	{
+		cerr << ex.what() << endl;
+		++Failures;
+	}
+
+	remove(FileName);
+
+	cout << Failures << " checks failed." << endl;
+	return (Failures == 0 ? 0 : 1);
+}
\ No newline at end of file
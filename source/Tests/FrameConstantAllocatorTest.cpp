@@ -0,0 +1,112 @@
+#include "pch.h"
+
+using namespace std;
+using namespace Library;
+
+namespace
+{
+	const uint32_t BufferSize = 4096;
+
+	uint32_t Failures = 0;
+
+	void Check(bool condition, const char* description)
+	{
+		if (condition == false)
+		{
+			cerr << "Failed: " << description << endl;
+			++Failures;
+		}
+	}
+
+	/**
+	* Constant buffer structures of the sizes the components upload, filled so each tells which it is.
+	*/
+	template <uint32_t Size>
+	struct Constants
+	{
+		uint8_t Bytes[Size];
+
+		explicit Constants(uint8_t value)
+		{
+			memset(Bytes, value, Size);
+		}
+	};
+
+	template <uint32_t Size>
+	bool Holds(const MemoryConstantBufferStorage& storage, const FrameConstantAllocator::Allocation& allocation, const Constants<Size>& constants)
+	{
+		return (memcmp(storage.Data() + allocation.Offset, constants.Bytes, Size) == 0);
+	}
+}
+
+int main()
+{
+	try
+	{
+		auto storage = make_unique<MemoryConstantBufferStorage>(BufferSize);
+		const MemoryConstantBufferStorage& memory = *storage;
+		FrameConstantAllocator allocator(move(storage));
+
+		// A frame writing all its constants before drawing maps the buffer once, discarding it
+		allocator.BeginFrame();
+		Check(memory.DiscardCount() == 0 && memory.Mapped() == false, "the buffer is not mapped before the first block");
+
+		Constants<64> camera(1);
+		Constants<300> object(2);
+		Constants<16> light(3);
+		FrameConstantAllocator::Allocation cameraBlock = allocator.Upload(camera);
+		FrameConstantAllocator::Allocation objectBlock = allocator.Upload(object);
+		FrameConstantAllocator::Allocation lightBlock = allocator.Upload(light);
+
+		Check(memory.DiscardCount() == 1 && memory.NoOverwriteCount() == 0 && memory.Mapped(), "the first block of a frame maps the buffer, discarding it");
+		Check(cameraBlock.Offset == 0 && objectBlock.Offset == 256 && lightBlock.Offset == 768, "blocks are aligned to 256 bytes");
+		Check(objectBlock.FirstConstant == 16 && objectBlock.ConstantCount == 32 && lightBlock.ConstantCount == 16, "blocks are given as whole runs of sixteen constants");
+		Check(allocator.UsedSize() == 1024, "the used size includes the alignment");
+
+		allocator.Flush();
+		Check(memory.Mapped() == false && memory.WrittenSize() == 1024, "flushing unmaps the bytes written");
+		Check(Holds(memory, cameraBlock, camera) && Holds(memory, objectBlock, object) && Holds(memory, lightBlock, light), "every block holds its constants");
+
+		// A block after the flush maps again without overwriting the blocks already drawn from
+		Constants<32> late(4);
+		FrameConstantAllocator::Allocation lateBlock = allocator.Upload(late);
+		allocator.Flush();
+		Check(memory.DiscardCount() == 1 && memory.NoOverwriteCount() == 1, "a later map of the frame does not discard");
+		Check(lateBlock.Offset == 1024 && memory.WrittenSize() == 1024 + 256, "a later map continues after the blocks already written");
+		Check(Holds(memory, cameraBlock, camera) && Holds(memory, lateBlock, late), "a later map keeps the blocks already written");
+
+		// The next frame starts over at the front of a discarded buffer
+		allocator.BeginFrame();
+		Check(allocator.UsedSize() == 0, "a new frame releases every block");
+
+		Constants<16> next(5);
+		FrameConstantAllocator::Allocation nextBlock = allocator.Upload(next);
+		Check(nextBlock.Offset == 0 && memory.DiscardCount() == 2 && Holds(memory, nextBlock, next), "a new frame discards the buffer again");
+
+		// A frame whose constants do not fit throws rather than wrapping onto blocks not yet drawn
+		bool threw = false;
+		try
+		{
+			allocator.Allocate(BufferSize);
+		}
+		catch (const GameException&)
+		{
+			threw = true;
+		}
+
+		Check(threw && allocator.UsedSize() == 256, "a block too large for the rest of the buffer throws and allocates nothing");
+
+		// Starting a frame unmaps the buffer, and a frame without blocks leaves it unmapped
+		allocator.BeginFrame();
+		allocator.BeginFrame();
+		Check(memory.Mapped() == false && memory.DiscardCount() == 2, "frames without blocks do not map the buffer");
+	}
+	catch (const exception& ex)
+	{
+		cerr << ex.what() << endl;
+		++Failures;
+	}
+
+	cout << Failures << " checks failed." << endl;
+	return (Failures == 0 ? 0 : 1);
+}
\ No newline at end of file
@@ -0,0 +1,131 @@
+#include "pch.h"
+
+using namespace std;
+using namespace DirectX;
+using namespace Rendering;
+
+namespace
+{
+	const uint32_t MeshCount = 5;
+
+	uint32_t Failures = 0;
+
+	void Check(bool condition, const char* description)
+	{
+		if (condition == false)
+		{
+			cerr << "Failed: " << description << endl;
+			++Failures;
+		}
+	}
+
+	/**
+	* Check the batches and instances built from the submitted ones, the instances being told apart by their texture slice.
+	* @param submitted The mesh and texture slice of each instance built, in the order they were added.
+	*/
+	void CheckBuild(const vector<InstanceBatch>& batches, const vector<PlanetInstance>& built, vector<pair<uint32_t, uint32_t>> submitted, const char* description)
+	{
+		// The batcher keeps the order of submission within a mesh, as a stable sort does
+		stable_sort(submitted.begin(), submitted.end(), [](const pair<uint32_t, uint32_t>& lhs, const pair<uint32_t, uint32_t>& rhs) { return lhs.first < rhs.first; });
+
+		bool instancesMatch = (built.size() == submitted.size());
+		for (size_t i = 0; instancesMatch && i < built.size(); ++i)
+		{
+			instancesMatch = (built[i].TextureSlice == submitted[i].second);
+		}
+
+		bool batchesMatch = true;
+		uint32_t nextInstance = 0;
+		for (size_t i = 0; batchesMatch && i < batches.size(); ++i)
+		{
+			const InstanceBatch& batch = batches[i];
+			batchesMatch = (batch.FirstInstance == nextInstance && batch.InstanceCount > 0 && (i == 0 || batch.Mesh > batches[i - 1].Mesh));
+			for (uint32_t j = batch.FirstInstance; batchesMatch && j < batch.FirstInstance + batch.InstanceCount; ++j)
+			{
+				batchesMatch = (j < submitted.size() && submitted[j].first == batch.Mesh);
+			}
+
+			nextInstance += batch.InstanceCount;
+		}
+
+		batchesMatch = batchesMatch && nextInstance == submitted.size();
+
+		string prefix(description);
+		Check(instancesMatch, (prefix + ": instances grouped by mesh in the order added").c_str());
+		Check(batchesMatch, (prefix + ": one batch for each mesh, ascending and covering every instance").c_str());
+	}
+}
+
+int main()
+{
+	try
+	{
+		mt19937 generator(12345);
+		uniform_int_distribution<uint32_t> meshDistribution(0, MeshCount - 1);
+		const ShadowOccluders noOccluders = { };
+
+		InstanceBatcher batcher;
+		vector<PlanetInstance> built;
+		Check(batcher.Build(built.data()).empty(), "no batches without instances");
+
+		vector<pair<uint32_t, uint32_t>> submitted;
+		for (uint32_t i = 0; i < 1000; ++i)
+		{
+			uint32_t mesh = meshDistribution(generator);
+			batcher.Add(mesh, InstanceBatcher::Pack(XMMatrixIdentity(), noOccluders, i, 0.0f));
+			submitted.push_back(make_pair(mesh, i));
+		}
+
+		Check(batcher.InstanceCount() == submitted.size(), "every instance added is staged");
+
+		built.resize(batcher.InstanceCount());
+		CheckBuild(batcher.Build(built.data()), built, submitted, "Whole build");
+
+		// Culling leaves an ascending subset of the instances
+		vector<uint32_t> indices;
+		vector<pair<uint32_t, uint32_t>> survivors;
+		for (uint32_t i = 0; i < submitted.size(); ++i)
+		{
+			if (generator() % 3 == 0)
+			{
+				indices.push_back(i);
+				survivors.push_back(submitted[i]);
+			}
+		}
+
+		built.assign(indices.size(), PlanetInstance());
+		CheckBuild(batcher.Build(built.data(), indices.data(), static_cast<uint32_t>(indices.size())), built, survivors, "Subset build");
+
+		// A frame with fewer meshes leaves no batches of the previous one behind
+		batcher.Clear();
+		Check(batcher.InstanceCount() == 0, "clearing drops every instance");
+
+		submitted.clear();
+		for (uint32_t i = 0; i < 10; ++i)
+		{
+			batcher.Add(1, InstanceBatcher::Pack(XMMatrixIdentity(), noOccluders, i, 0.0f));
+			submitted.push_back(make_pair(1U, i));
+		}
+
+		built.assign(batcher.InstanceCount(), PlanetInstance());
+		CheckBuild(batcher.Build(built.data()), built, submitted, "Build after clearing");
+
+		// Packing transposes the world matrix for the shaders and copies the occluders
+		ShadowOccluders occluders = { };
+		occluders.Spheres[0] = XMFLOAT4(1.0f, 2.0f, 3.0f, 4.0f);
+		occluders.Count = 1;
+		occluders.LightRadius = 5.0f;
+		PlanetInstance instance = InstanceBatcher::Pack(XMMatrixTranslation(6.0f, 7.0f, 8.0f), occluders, 9, 0.25f);
+		Check(instance.World._14 == 6.0f && instance.World._24 == 7.0f && instance.World._34 == 8.0f && instance.World._41 == 0.0f, "the world matrix is transposed");
+		Check(instance.Occluders[0].w == 4.0f && instance.OccluderCount == 1 && instance.LightRadius == 5.0f, "the occluders are copied");
+		Check(instance.TextureSlice == 9 && instance.AmbientIntensity == 0.25f, "the texture slice and ambient intensity are copied");
+
+		cout << Failures << " checks failed." << endl;
+		return (Failures == 0 ? 0 : 1);
+	}
+	catch (const exception& ex)
+	{
+		cerr << ex.what() << endl;
+		return 1;
+	}
+}
\ No newline at end of file
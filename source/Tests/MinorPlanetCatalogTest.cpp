@@ -0,0 +1,104 @@
+#include "pch.h"
+
+using namespace std;
+using namespace Library;
+
+namespace
+{
+	uint32_t Failures = 0;
+
+	void Check(bool condition, const char* description)
+	{
+		if (condition == false)
+		{
+			cerr << "Failed: " << description << endl;
+			++Failures;
+		}
+	}
+
+	// Ceres in the fixed-width MPCORB format, and a record with neither a magnitude nor a slope parameter
+	const string Ceres = "00001    3.34  0.15 K2555 188.70269   73.27343   80.25221   10.58780  0.0794013  0.21424651   2.7660512";
+	const string Unmeasured = "K24A00X             K24AH   5.00000   10.00000   20.00000    1.50000  0.2500000  0.30000000   2.0000000";
+
+	const wstring TextFileName = L"MinorPlanetCatalogTest.txt";
+	const wstring CacheFileName = L"MinorPlanetCatalogTest.cache";
+
+	void WriteText(const vector<string>& records)
+	{
+		ofstream file(Utility::ToString(TextFileName), ios::binary);
+		file << "Header of the catalog" << endl << "-----" << endl;
+		for (const string& record : records)
+		{
+			file << record << endl;
+		}
+	}
+
+	/**
+	* Replace the characters of a record from a zero-based column on.
+	*/
+	string Corrupt(string record, size_t column, const string& characters)
+	{
+		return record.replace(column, characters.size(), characters);
+	}
+
+	bool Throws(const string& record)
+	{
+		WriteText({ Ceres, record });
+		try
+		{
+			ThreadPool threadPool(2);
+			MinorPlanetCatalog catalog(TextFileName, CacheFileName, threadPool);
+		}
+		catch (const exception&)
+		{
+			return true;
+		}
+
+		return false;
+	}
+}
+
+int main()
+{
+	try
+	{
+		// Fields with leading blanks, and blank optional fields, parse
+		{
+			WriteText({ Ceres, Unmeasured });
+			ThreadPool threadPool(2);
+			MinorPlanetCatalog catalog(TextFileName, CacheFileName, threadPool);
+			const MinorPlanetElements& elements = catalog.Elements();
+
+			Check(catalog.Count() == 2 && catalog.LoadedFromCache() == false, "the records after the header are parsed");
+			Check(catalog.Count() == 2 && catalog.Designation(0) == "00001" && catalog.Designation(1) == "K24A00X", "the designations are kept");
+			Check(catalog.Count() == 2 && elements.AbsoluteMagnitudes[0] == 3.34f && elements.SlopeParameters[0] == 0.15f, "the magnitude and slope parameter are read");
+			Check(catalog.Count() == 2 && elements.MeanAnomalies[0] == 188.70269 && elements.ArgumentsOfPerihelion[0] == 73.27343 && elements.Inclinations[0] == 10.5878, "the angles are read");
+			Check(catalog.Count() == 2 && elements.Eccentricities[0] == 0.0794013 && elements.MeanMotions[0] == 0.21424651 && elements.SemiMajorAxes[0] == 2.7660512, "the orbit is read");
+			Check(catalog.Count() == 2 && elements.AbsoluteMagnitudes[1] != elements.AbsoluteMagnitudes[1] && elements.SlopeParameters[1] != elements.SlopeParameters[1], "blank optional fields give NaN");
+			Check(catalog.Count() == 2 && elements.Epochs[1] == 2460600.5 && elements.MeanAnomalies[1] == 5.0, "a second record is read");
+		}
+
+		{
+			ThreadPool threadPool(2);
+			MinorPlanetCatalog catalog(TextFileName, CacheFileName, threadPool);
+			Check(catalog.LoadedFromCache() && catalog.Count() == 2 && catalog.Elements().SemiMajorAxes[0] == 2.7660512, "the same text is loaded from the cache");
+		}
+
+		// A corrupted field is rejected rather than read as other digits
+		Check(Throws(Corrupt(Ceres, 27, ")")), "punctuation among the digits is rejected");
+		Check(Throws(Corrupt(Ceres, 27, " ")), "a space between the integer digits is rejected");
+		Check(Throws(Corrupt(Ceres, 32, " ")), "a space between the decimals is rejected");
+		Check(Throws(Corrupt(Ceres, 93, "!")), "punctuation after a leading blank is rejected");
+	}
+	catch (const exception& ex)
+	{
+		cerr << ex.what() << endl;
+		++Failures;
+	}
+
+	remove(Utility::ToString(TextFileName).c_str());
+	remove(Utility::ToString(CacheFileName).c_str());
+
+	cout << Failures << " checks failed." << endl;
+	return (Failures == 0 ? 0 : 1);
+}
\ No newline at end of file
@@ -0,0 +1,130 @@
+#include "pch.h"
+
+using namespace std;
+using namespace Library;
+using namespace Rendering;
+
+namespace
+{
+	uint32_t Failures = 0;
+
+	void Check(bool condition, const char* description)
+	{
+		if (condition == false)
+		{
+			cerr << "Failed: " << description << endl;
+			++Failures;
+		}
+	}
+
+	vector<SweepRecord> ReadRecords(const string& fileName)
+	{
+		ifstream file(fileName, ios::binary);
+		SweepResultsHeader header = { 0 };
+		file.read(reinterpret_cast<char*>(&header), sizeof(header));
+		if (file.good() == false || header.Magic != ParameterSweep::ResultsMagic || header.RecordSize != sizeof(SweepRecord))
+		{
+			throw GameException("The sweep results file has no valid header.");
+		}
+
+		vector<SweepRecord> records(header.RecordCount);
+		file.read(reinterpret_cast<char*>(records.data()), records.size() * sizeof(SweepRecord));
+		if (file.good() == false)
+		{
+			throw GameException("The sweep results file is truncated.");
+		}
+
+		return records;
+	}
+}
+
+int main(int argc, char* argv[])
+{
+	vector<wstring> arguments;
+	for (int i = 0; i < argc; ++i)
+	{
+		arguments.push_back(Utility::ToWideString(argv[i]));
+	}
+
+	// The sweep starts its workers as this executable again, under the worker switch
+	if (arguments.size() > 1 && arguments[1] == ParameterSweep::WorkerSwitch)
+	{
+		try
+		{
+			return HeadlessModes::RunSweepWorker(arguments);
+		}
+		catch (const exception&)
+		{
+			return 1;
+		}
+	}
+
+	const vector<string> fileNames = { "ParameterSweepTest.txt", "ParameterSweepTest.bin", "ParameterSweepTest.Slow.bin" };
+
+	try
+	{
+		// A grid file names its parameters, and one left out takes its default
+		{
+			ofstream gridFile(fileNames[0]);
+			gridFile << "# Two time steps and two mass scales" << endl << "TimeStepDays 1.0 2.0" << endl << "MassScale 1.0 2.0" << endl;
+		}
+
+		SweepGrid grid = ParameterSweep::LoadGrid(L"ParameterSweepTest.txt");
+		Check(grid.TimeStepDays == vector<double>({ 1.0, 2.0 }) && grid.MassScales == vector<double>({ 1.0, 2.0 }) && grid.DurationDays.size() == 1, "a grid file is read");
+		grid.DurationDays.assign(1, 365.25);
+
+		// Every combination runs in a worker process and is recorded at its index
+		{
+			ParameterSweep sweep(grid, L"ParameterSweepTest.bin");
+			Check(sweep.JobCount() == 4 && sweep.PendingCount() == 4, "a new sweep has every combination pending");
+			Check(sweep.Run(2, 60) == 0, "a sweep runs without failures");
+		}
+
+		vector<SweepRecord> records = ReadRecords(fileNames[1]);
+		bool completed = (records.size() == 4);
+		for (uint32_t i = 0; completed && i < records.size(); ++i)
+		{
+			const SweepRecord& record = records[i];
+			completed = (record.JobIndex == i && record.Status == SweepStatus::Completed && record.Result.SystemIndex == i && record.DurationDays == 365.25);
+		}
+
+		Check(completed, "every combination is completed in order");
+		Check(records.size() == 4 && records[3].TimeStepDays == 2.0 && records[3].MassScale == 2.0, "the records keep the parameters of their combination");
+
+		// Running the sweep again resumes it, with nothing left to run
+		{
+			ParameterSweep sweep(grid, L"ParameterSweepTest.bin");
+			Check(sweep.PendingCount() == 0 && sweep.Run(2, 60) == 0, "a finished sweep resumes with nothing pending");
+		}
+
+		// A job past its deadline is timed out, and the relaunched worker runs the next one
+		{
+			SweepGrid slowGrid;
+			slowGrid.TimeStepDays.assign(1, 0.001);
+			slowGrid.DurationDays = { 1.0e7, 10.0 };
+			slowGrid.MassScales.assign(1, 1.0);
+
+			ParameterSweep sweep(slowGrid, L"ParameterSweepTest.Slow.bin");
+			auto start = chrono::steady_clock::now();
+			Check(sweep.Run(1, 1) == 1, "a job past its deadline is counted as a failure");
+			Check(chrono::steady_clock::now() - start < chrono::seconds(10), "a job is stopped at its deadline");
+
+			vector<SweepRecord> slowRecords = ReadRecords(fileNames[2]);
+			Check(slowRecords.size() == 2 && slowRecords[0].Status == SweepStatus::TimedOut, "a job past its deadline is marked timed out");
+			Check(slowRecords.size() == 2 && slowRecords[1].Status == SweepStatus::Completed, "the relaunched worker completes the next job");
+		}
+	}
+	catch (const exception& ex)
+	{
+		cerr << ex.what() << endl;
+		++Failures;
+	}
+
+	for (const string& fileName : fileNames)
+	{
+		remove(fileName.c_str());
+	}
+
+	cout << Failures << " checks failed." << endl;
+	return (Failures == 0 ? 0 : 1);
+}
\ No newline at end of file
@@ -0,0 +1,88 @@
+#include "pch.h"
+
+using namespace std;
+using namespace Library;
+using namespace DirectX;
+using namespace Rendering;
+
+namespace
+{
+	uint32_t Failures = 0;
+
+	void Check(bool condition, const char* description)
+	{
+		if (condition == false)
+		{
+			cerr << "Failed: " << description << endl;
+			++Failures;
+		}
+	}
+
+	// The International Space Station, with a period of 92 minutes, and a geostationary satellite, with one of a day
+	const char* const NearEarth[] =
+	{
+		"ISS (ZARYA)",
+		"1 25544U 98067A   08264.51782528 -.00002182  00000-0 -11606-4 0  2927",
+		"2 25544  51.6416 247.4627 0006703 130.5360 325.0288 15.72125391563537"
+	};
+
+	const char* const DeepSpace[] =
+	{
+		"1 28626U 05008A   06176.46683397 -.00000205  00000-0  10000-3 0  2190",
+		"2 28626   0.0019 286.9433 0000335  13.7918  55.6504  1.00270176  4891"
+	};
+
+	const string FileName = "SatellitePropagatorTest.txt";
+
+	void WriteElementSets(const vector<const char*>& lines)
+	{
+		ofstream file(FileName);
+		for (const char* line : lines)
+		{
+			file << line << endl;
+		}
+	}
+
+	float Distance(const XMFLOAT3& position)
+	{
+		return sqrt(position.x * position.x + position.y * position.y + position.z * position.z);
+	}
+}
+
+int main()
+{
+	try
+	{
+		ThreadPool threadPool(2);
+
+		// A near-Earth satellite is propagated, and the deep-space one beside it skipped rather than propagated
+		{
+			WriteElementSets({ NearEarth[0], NearEarth[1], NearEarth[2], DeepSpace[0], DeepSpace[1] });
+			SatellitePropagator propagator(Utility::ToWideString(FileName));
+			Check(propagator.Count() == 1 && propagator.DeepSpaceCount() == 1, "a deep-space element set is skipped and counted");
+
+			propagator.Propagate(0.0, threadPool);
+			Check(propagator.Count() == 1 && propagator.ValidFlags()[0] != 0, "the near-Earth satellite is propagated");
+			Check(propagator.Count() == 1 && Distance(propagator.Positions()[0]) > 6600.0f && Distance(propagator.Positions()[0]) < 6800.0f, "the satellite propagated is in low orbit");
+			Check(propagator.ReferenceJulianDate() > 2454730.0 && propagator.ReferenceJulianDate() < 2454731.0, "the skipped epoch is not the reference");
+		}
+
+		// A file of deep-space sets only loads with nothing to propagate
+		{
+			WriteElementSets({ DeepSpace[0], DeepSpace[1] });
+			SatellitePropagator propagator(Utility::ToWideString(FileName));
+			propagator.Propagate(1.0, threadPool);
+			Check(propagator.Count() == 0 && propagator.DeepSpaceCount() == 1, "a file of deep-space sets propagates nothing");
+		}
+	}
+	catch (const exception& ex)
+	{
+		cerr << ex.what() << endl;
+		++Failures;
+	}
+
+	remove(FileName.c_str());
+
+	cout << Failures << " checks failed." << endl;
+	return (Failures == 0 ? 0 : 1);
+}
\ No newline at end of file
@@ -0,0 +1,172 @@
+#include "pch.h"
+
+using namespace std;
+using namespace DirectX;
+using namespace Rendering;
+
+namespace
+{
+	const uint32_t BodyCount = 2000;
+	const uint32_t LightIndex = 0;
+	const float LightRadius = 10.0f;
+
+	// Within this fraction of the edge of the hull, or of the depth of another hit, the float test of the pass and the
+	// double test here may disagree, so receivers with such a candidate are not compared
+	const double Tolerance = 1.0e-4;
+
+	struct Hit
+	{
+		uint32_t Body;
+		double Depth;
+	};
+
+	/**
+	* Find every caster of a shadow on a receiver by testing every body against the hull of the light and the receiver,
+	* as the pass tests the candidates it gathers.
+	* @return Whether the hits are clear of the tolerance; otherwise the receiver cannot be compared.
+	*/
+	bool FindOccluders(const vector<XMFLOAT3>& positions, const vector<float>& radii, uint32_t receiver, vector<Hit>& hits)
+	{
+		hits.clear();
+
+		const XMFLOAT3& light = positions[LightIndex];
+		double axisX = positions[receiver].x - light.x;
+		double axisY = positions[receiver].y - light.y;
+		double axisZ = positions[receiver].z - light.z;
+		double length = sqrt(axisX * axisX + axisY * axisY + axisZ * axisZ);
+		axisX /= length;
+		axisY /= length;
+		axisZ /= length;
+
+		double radiusDifference = LightRadius - radii[receiver];
+		double widening = length / sqrt(length * length - radiusDifference * radiusDifference);
+		double hullBase = LightRadius * widening;
+		double hullSlope = (radii[receiver] - LightRadius) * widening / length;
+
+		for (uint32_t i = 0; i < positions.size(); ++i)
+		{
+			if (i == LightIndex || i == receiver)
+			{
+				continue;
+			}
+
+			double x = positions[i].x - light.x;
+			double y = positions[i].y - light.y;
+			double z = positions[i].z - light.z;
+			double radius = radii[i];
+
+			double t = x * axisX + y * axisY + z * axisZ;
+			double perpendicular = sqrt(max(x * x + y * y + z * z - t * t, 0.0));
+			double reach = hullSlope * t + hullBase + radius;
+
+			// A body clearly outside any bound is missed whatever the precision; one near a bound and inside the rest is not clear
+			double margins[] = { (reach - perpendicular) / reach, (t + radius) / length, (length - t) / length };
+			bool missed = false;
+			bool unclear = false;
+			for (double margin : margins)
+			{
+				missed = missed || margin <= -Tolerance;
+				unclear = unclear || fabs(margin) < Tolerance;
+			}
+
+			if (missed)
+			{
+				continue;
+			}
+
+			if (unclear)
+			{
+				return false;
+			}
+
+			hits.push_back({ i, 1.0 - perpendicular / reach });
+		}
+
+		sort(hits.begin(), hits.end(), [](const Hit& lhs, const Hit& rhs) { return lhs.Depth > rhs.Depth; });
+		for (size_t i = 1; i < hits.size() && i <= ShadowOccluders::MaxOccluders; ++i)
+		{
+			if (hits[i - 1].Depth - hits[i].Depth < Tolerance)
+			{
+				return false;
+			}
+		}
+
+		return true;
+	}
+}
+
+int main()
+{
+	try
+	{
+		// A light with bodies in a thick disk around it, as in a planetary system, so that many shadow one another
+		mt19937 generator(12345);
+		uniform_real_distribution<float> angleDistribution(0.0f, XM_2PI);
+		uniform_real_distribution<float> distanceDistribution(40.0f, 1000.0f);
+		uniform_real_distribution<float> heightDistribution(-200.0f, 200.0f);
+		uniform_real_distribution<float> radiusDistribution(0.5f, 5.0f);
+
+		vector<XMFLOAT3> positions(BodyCount);
+		vector<float> radii(BodyCount);
+		positions[LightIndex] = XMFLOAT3(0.0f, 0.0f, 0.0f);
+		radii[LightIndex] = LightRadius;
+		for (uint32_t i = 1; i < BodyCount; ++i)
+		{
+			float angle = angleDistribution(generator);
+			float distance = distanceDistribution(generator);
+			positions[i] = XMFLOAT3(distance * cos(angle), heightDistribution(generator), distance * sin(angle));
+			radii[i] = radiusDistribution(generator);
+		}
+
+		vector<uint8_t> receivers(BodyCount, 1);
+		ShadowOccluderPass pass;
+		pass.Update(positions.data(), radii.data(), receivers.data(), BodyCount, LightIndex);
+
+		uint32_t compared = 0;
+		uint32_t shadowed = 0;
+		uint32_t failures = 0;
+		vector<Hit> hits;
+		for (uint32_t receiver = 0; receiver < BodyCount; ++receiver)
+		{
+			if (receiver == LightIndex || FindOccluders(positions, radii, receiver, hits) == false)
+			{
+				continue;
+			}
+
+			++compared;
+			shadowed += (hits.empty() ? 0 : 1);
+
+			const ShadowOccluders& occluders = pass.Occluders(receiver);
+			uint32_t expectedCount = min(static_cast<uint32_t>(hits.size()), ShadowOccluders::MaxOccluders);
+			bool matches = (occluders.Count == expectedCount && (expectedCount == 0 || occluders.LightRadius == LightRadius));
+			for (uint32_t i = 0; matches && i < expectedCount; ++i)
+			{
+				const XMFLOAT3& position = positions[hits[i].Body];
+				const XMFLOAT4& sphere = occluders.Spheres[i];
+				matches = (sphere.x == position.x && sphere.y == position.y && sphere.z == position.z && sphere.w == radii[hits[i].Body]);
+			}
+
+			if (matches == false)
+			{
+				cerr << "Receiver " << receiver << ": " << occluders.Count << " occluders found, " << hits.size() << " by brute force." << endl;
+				++failures;
+			}
+		}
+
+		cout << compared << " receivers compared, " << shadowed << " of them shadowed, " << failures << " mismatched." << endl;
+
+		// Too few comparisons would leave the pass untested
+		if (compared < BodyCount * 9 / 10 || shadowed < compared / 10)
+		{
+			cerr << "The scene does not exercise the pass." << endl;
+			return 1;
+		}
+
+		return (failures == 0 ? 0 : 1);
+	}
+	catch (const exception& ex)
+	{
+		cerr << ex.what() << endl;
+		return 1;
+	}
+}
\ No newline at end of file
@@ -0,0 +1,180 @@
+#include "pch.h"
+
+using namespace std;
+using namespace Library;
+using namespace Rendering;
+
+namespace
+{
+	uint32_t Failures = 0;
+
+	void Check(bool condition, const char* description)
+	{
+		if (condition == false)
+		{
+			cerr << "Failed: " << description << endl;
+			++Failures;
+		}
+	}
+
+	ShardedSimulationSettings Settings(uint32_t shardCount, uint32_t maxParticlesPerShard)
+	{
+		ShardedSimulationSettings settings;
+		settings.ShardCount = shardCount;
+		settings.MaxParticlesPerShard = maxParticlesPerShard;
+		settings.RingCapacity = 16;
+		settings.TimeStepDays = 1.0;
+		settings.GhostMargin = 0.05;
+		settings.Softening = 1.0e-4;
+
+		return settings;
+	}
+
+	/**
+	* A massless particle on the x axis. With no mass anywhere nothing pulls on it, so it drifts in a straight line.
+	*/
+	ShardParticle Drifting(uint32_t id, double x, double velocityX)
+	{
+		ShardParticle particle = { 0 };
+		particle.Position[0] = x;
+		particle.Velocity[0] = velocityX;
+		particle.Id = id;
+
+		return particle;
+	}
+
+	/**
+	* Check a snapshot holds every particle once, each where it has drifted to by the given day.
+	*/
+	bool HasDriftedTo(const vector<ShardParticle>& snapshot, const vector<ShardParticle>& particles, double days)
+	{
+		if (snapshot.size() != particles.size())
+		{
+			return false;
+		}
+
+		for (const ShardParticle& particle : particles)
+		{
+			auto found = find_if(snapshot.begin(), snapshot.end(), [&particle](const ShardParticle& candidate) { return candidate.Id == particle.Id; });
+			if (found == snapshot.end() || abs(found->Position[0] - (particle.Position[0] + particle.Velocity[0] * days)) > 1.0e-9)
+			{
+				return false;
+			}
+		}
+
+		return true;
+	}
+
+	void KillWorker(uint32_t processId)
+	{
+#if defined(_WIN32)
+		HANDLE process = OpenProcess(PROCESS_TERMINATE | SYNCHRONIZE, FALSE, processId);
+		if (process != nullptr)
+		{
+			TerminateProcess(process, 1);
+			WaitForSingleObject(process, INFINITE);
+			CloseHandle(process);
+		}
+#else
+		// The simulation reaps its own workers
+		kill(static_cast<pid_t>(processId), SIGKILL);
+#endif
+	}
+}
+
+int main(int argc, char* argv[])
+{
+	vector<wstring> arguments;
+	for (int i = 0; i < argc; ++i)
+	{
+		arguments.push_back(Utility::ToWideString(argv[i]));
+	}
+
+	// The simulation starts its workers as this executable again, under the worker switch
+	if (arguments.size() > 1 && arguments[1] == ShardedSimulation::WorkerSwitch)
+	{
+		try
+		{
+			return HeadlessModes::RunShardWorker(arguments);
+		}
+		catch (const exception&)
+		{
+			return 1;
+		}
+	}
+
+	try
+	{
+		// Particles crossing every slab boundary migrate between four shards, in both directions
+		{
+			vector<ShardParticle> particles;
+			for (uint32_t i = 0; i < 32; ++i)
+			{
+				particles.push_back(Drifting(i, i * 0.5, (i % 2 == 0 ? 0.25 : -0.25)));
+			}
+
+			ShardedSimulation simulation(Settings(4, 16), particles);
+			for (uint32_t step = 0; step < 20; ++step)
+			{
+				simulation.Step();
+			}
+
+			Check(simulation.CommittedStep() == 20 && simulation.RestartCount() == 0, "every step commits without a restart");
+			Check(HasDriftedTo(simulation.Snapshot(), particles, 20.0), "particles keep drifting across the shards");
+		}
+
+		// A worker killed between steps is relaunched, and the step replayed, with a body crossing into the other shard
+		{
+			vector<ShardParticle> particles;
+			for (uint32_t i = 0; i < 8; ++i)
+			{
+				particles.push_back(Drifting(i, i, (i == 3 ? 1.0 : 0.0)));
+			}
+
+			ShardedSimulation simulation(Settings(2, 8), particles);
+			KillWorker(simulation.WorkerProcessId(1));
+			simulation.Step();
+
+			Check(simulation.RestartCount() == 1 && simulation.CommittedStep() == 1, "a killed worker is relaunched and its step replayed");
+			Check(HasDriftedTo(simulation.Snapshot(), particles, 1.0), "a body crossing a boundary during a replayed step survives");
+		}
+
+		// A body crossing into a full shard waits with the shard it left, and survives a replay of the next step
+		{
+			vector<ShardParticle> particles;
+			for (uint32_t i = 0; i < 8; ++i)
+			{
+				particles.push_back(Drifting(i, i, (i == 3 ? 1.0 : 0.0)));
+			}
+
+			ShardedSimulation simulation(Settings(2, 4), particles);
+			simulation.Step();
+			Check(HasDriftedTo(simulation.Snapshot(), particles, 1.0), "a body crossing into a full shard is kept");
+
+			KillWorker(simulation.WorkerProcessId(0));
+			simulation.Step();
+			KillWorker(simulation.WorkerProcessId(1));
+			simulation.Step();
+
+			Check(simulation.RestartCount() == 2 && simulation.CommittedStep() == 3, "both shards are relaunched");
+			Check(HasDriftedTo(simulation.Snapshot(), particles, 3.0), "a body waiting to migrate survives replayed steps");
+		}
+
+		// The mode writes the snapshot of the solar system and its belt
+		{
+			Check(HeadlessModes::RunShardedSimulation({ L"ShardedSimulationTest", HeadlessModes::ShardedSimulationSwitch, L"3", L"300", L"0.05", L"ShardedSimulationTest.csv" }) == 0, "the sharded simulation mode runs");
+			ifstream snapshot("ShardedSimulationTest.csv");
+			Check(count(istreambuf_iterator<char>(snapshot), istreambuf_iterator<char>(), '\n') > 300, "the mode writes a line per particle");
+		}
+	}
+	catch (const exception& ex)
+	{
+		cerr << ex.what() << endl;
+		++Failures;
+	}
+
+	remove("ShardedSimulationTest.csv");
+
+	cout << Failures << " checks failed." << endl;
+	return (Failures == 0 ? 0 : 1);
+}
\ No newline at end of file
@@ -0,0 +1,152 @@
+#include "pch.h"
+
+using namespace std;
+using namespace Library;
+using namespace Rendering;
+
+namespace
+{
+	uint32_t Failures = 0;
+
+	void Check(bool condition, const char* description)
+	{
+		if (condition == false)
+		{
+			cerr << "Failed: " << description << endl;
+			++Failures;
+		}
+	}
+
+#if defined(_WIN32)
+	const wstring Address = L"\\\\.\\pipe\\SnapshotServerTest";
+#else
+	const wstring Address = L"SnapshotServerTest.socket";
+#endif
+
+	const uint32_t WaitMilliseconds = 5000;
+	const uint32_t PollMilliseconds = 5;
+
+	/**
+	* Update a client until it has applied a tick, which arrives on the threads of the server.
+	* @return False if the connection was lost or the tick did not arrive in time.
+	*/
+	bool WaitForTick(SnapshotClient& client, SolarSystemSimulation& simulation, const DoubleVector3& cameraPosition, double interestRadius, uint32_t tick)
+	{
+		for (uint32_t waited = 0; waited < WaitMilliseconds; waited += PollMilliseconds)
+		{
+			if (client.Update(simulation, cameraPosition, interestRadius) == false)
+			{
+				return false;
+			}
+
+			if (client.Tick() >= tick)
+			{
+				return true;
+			}
+
+			this_thread::sleep_for(chrono::milliseconds(PollMilliseconds));
+		}
+
+		return false;
+	}
+
+	bool MatchesServer(const SolarSystemSimulation& server, const SolarSystemSimulation& client, uint32_t index)
+	{
+		DoubleVector3 expected = server.Position(index);
+		DoubleVector3 actual = client.Position(index);
+
+		return (abs(actual.x - expected.x) <= SnapshotCodec::PositionQuantum && abs(actual.y - expected.y) <= SnapshotCodec::PositionQuantum && abs(actual.z - expected.z) <= SnapshotCodec::PositionQuantum);
+	}
+}
+
+int main()
+{
+	try
+	{
+		BodyCatalog catalog(L"Content\\Catalogs\\SolarSystem.csv.bin");
+		uint32_t count = catalog.Count();
+		SolarSystemSimulation serverSimulation(catalog);
+		SolarSystemSimulation clientSimulation(catalog);
+		DoubleVector3 origin;
+
+		auto server = make_unique<SnapshotServer>(catalog, Address);
+
+		bool secondServerFailed = false;
+		try
+		{
+			SnapshotServer secondServer(catalog, Address);
+		}
+		catch (const GameException&)
+		{
+			secondServerFailed = true;
+		}
+
+		Check(secondServerFailed, "a second server cannot listen at the address of a running one");
+
+		SnapshotClient client(count, Address);
+
+		// The first tick has no baseline and carries every body
+		serverSimulation.Advance(30.0);
+		server->Publish(serverSimulation);
+		Check(WaitForTick(client, clientSimulation, origin, 0.0, 1), "the first tick arrives");
+
+		bool matches = true;
+		bool visible = true;
+		for (uint32_t i = 0; i < count; ++i)
+		{
+			matches = matches && MatchesServer(serverSimulation, clientSimulation, i);
+			visible = visible && client.Visible(i);
+		}
+
+		Check(matches, "every body is placed within a quantum of the server");
+		Check(visible, "every body is sent to a viewer wanting all of them");
+
+		// The second tick is decoded against the first, which the client acknowledged along with a far camera
+		DoubleVector3 farCamera(1.0e9, 1.0e9, 1.0e9);
+		serverSimulation.Advance(30.0);
+		server->Publish(serverSimulation);
+		Check(WaitForTick(client, clientSimulation, farCamera, 1.0, 2), "the second tick arrives");
+
+		matches = true;
+		for (uint32_t i = 0; i < count; ++i)
+		{
+			matches = matches && MatchesServer(serverSimulation, clientSimulation, i);
+		}
+
+		Check(matches, "a tick decoded against the acknowledged one places every body");
+
+		// Nothing is near the camera, so only the light source is sent
+		serverSimulation.Advance(30.0);
+		server->Publish(serverSimulation);
+		Check(WaitForTick(client, clientSimulation, farCamera, 1.0, 3), "the third tick arrives");
+
+		bool onlyLightSources = true;
+		for (uint32_t i = 0; i < count; ++i)
+		{
+			onlyLightSources = onlyLightSources && (client.Visible(i) == catalog.Record(i).HasFlag(BodyFlags::LightSource));
+		}
+
+		Check(onlyLightSources, "only the light sources are sent to a camera near no body");
+		Check(server->Tick() == 3, "the server counts the ticks it published");
+
+		// The client sees the connection close once the server is gone
+		server.reset();
+
+		bool lost = false;
+		for (uint32_t waited = 0; waited < WaitMilliseconds && lost == false; waited += PollMilliseconds)
+		{
+			lost = (client.Update(clientSimulation, origin, 0.0) == false);
+			this_thread::sleep_for(chrono::milliseconds(PollMilliseconds));
+		}
+
+		Check(lost, "a client loses its connection when the server stops");
+	}
+	catch (const exception& ex)
+	{
+		cerr << ex.what() << endl;
+		++Failures;
+	}
+
+	cout << Failures << " checks failed." << endl;
+	return (Failures == 0 ? 0 : 1);
+}
\ No newline at end of file
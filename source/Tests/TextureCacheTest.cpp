@@ -0,0 +1,218 @@
+#include "pch.h"
+
+using namespace std;
+using namespace Library;
+
+namespace
+{
+	uint32_t Failures = 0;
+
+	void Check(bool condition, const char* description)
+	{
+		if (condition == false)
+		{
+			cerr << "Failed: " << description << endl;
+			++Failures;
+		}
+	}
+
+	/**
+	* Images in a minimal format the test decodes itself: the width and height in a byte each, then the pixels.
+	*/
+	vector<uint8_t> Encode(const DecodedImage& image)
+	{
+		vector<uint8_t> contents(image.Pixels.size() + 2);
+		contents[0] = static_cast<uint8_t>(image.Width);
+		contents[1] = static_cast<uint8_t>(image.Height);
+		copy(image.Pixels.begin(), image.Pixels.end(), contents.begin() + 2);
+
+		return contents;
+	}
+
+	atomic<uint32_t> DecodeCount(0);
+
+	DecodedImage Decode(const vector<uint8_t>& contents)
+	{
+		++DecodeCount;
+		if (contents.size() < 2)
+		{
+			throw GameException("The image is truncated.");
+		}
+
+		DecodedImage image;
+		image.Width = contents[0];
+		image.Height = contents[1];
+		image.Pixels.assign(contents.begin() + 2, contents.end());
+
+		return image;
+	}
+
+	DecodedImage SolidImage(uint32_t width, uint32_t height, uint8_t red, uint8_t green, uint8_t blue)
+	{
+		DecodedImage image;
+		image.Width = width;
+		image.Height = height;
+		for (uint32_t i = 0; i < width * height; ++i)
+		{
+			image.Pixels.insert(image.Pixels.end(), { red, green, blue, 255 });
+		}
+
+		return image;
+	}
+
+	/**
+	* A checkerboard of black and white pixels, whose every two by two block averages to mid grey.
+	*/
+	DecodedImage CheckerImage(uint32_t width, uint32_t height)
+	{
+		DecodedImage image;
+		image.Width = width;
+		image.Height = height;
+		for (uint32_t y = 0; y < height; ++y)
+		{
+			for (uint32_t x = 0; x < width; ++x)
+			{
+				uint8_t value = ((x + y) % 2 == 0 ? 0 : 255);
+				image.Pixels.insert(image.Pixels.end(), { value, value, value, 255 });
+			}
+		}
+
+		return image;
+	}
+
+	void WriteFile(const string& fileName, const vector<uint8_t>& contents)
+	{
+		ofstream file(fileName, ios::binary);
+		file.write(reinterpret_cast<const char*>(contents.data()), static_cast<streamsize>(contents.size()));
+		if (file.good() == false)
+		{
+			throw GameException("Could not write a test image.");
+		}
+	}
+
+	bool IsSolid(const DecodedImage& image, uint8_t red, uint8_t green, uint8_t blue)
+	{
+		for (size_t i = 0; i < image.Pixels.size(); i += 4)
+		{
+			if (image.Pixels[i] != red || image.Pixels[i + 1] != green || image.Pixels[i + 2] != blue || image.Pixels[i + 3] != 255)
+			{
+				return false;
+			}
+		}
+
+		return image.Pixels.empty() == false;
+	}
+
+	/**
+	* Check a mip chain halves down to one pixel, the size of each level matching its pixels.
+	*/
+	bool IsFullMipChain(const TextureData& texture, uint32_t width, uint32_t height)
+	{
+		for (const DecodedImage& level : texture.MipLevels)
+		{
+			if (level.Width != width || level.Height != height || level.Pixels.size() != static_cast<size_t>(width) * height * 4)
+			{
+				return false;
+			}
+
+			width = max(width / 2, 1U);
+			height = max(height / 2, 1U);
+		}
+
+		return (texture.MipLevels.empty() == false && texture.MipLevels.back().Width == 1 && texture.MipLevels.back().Height == 1);
+	}
+}
+
+int main()
+{
+	const vector<string> fileNames = { "TextureCacheTest.Red.img", "TextureCacheTest.RedCopy.img", "TextureCacheTest.Checker.img", "TextureCacheTest.Truncated.img" };
+
+	try
+	{
+		WriteFile(fileNames[0], Encode(SolidImage(16, 8, 255, 0, 0)));
+		WriteFile(fileNames[1], Encode(SolidImage(16, 8, 255, 0, 0)));
+		WriteFile(fileNames[2], Encode(CheckerImage(8, 8)));
+		WriteFile(fileNames[3], vector<uint8_t>(1, 0));
+
+		ThreadPool threadPool(4);
+		{
+			TextureCache cache(threadPool, Decode);
+
+			// Decoded at its own size, with a full mip chain
+			shared_ptr<const TextureData> red = cache.Load(L"TextureCacheTest.Red.img", 16, 8).get();
+			Check(IsFullMipChain(*red, 16, 8) && red->MipLevels.size() == 5, "an image gets a mip chain down to one pixel");
+			Check(all_of(red->MipLevels.begin(), red->MipLevels.end(), [](const DecodedImage& level) { return IsSolid(level, 255, 0, 0); }), "every level of a solid image keeps its color");
+			Check(red->MemorySize() == (16 * 8 + 8 * 4 + 4 * 2 + 2 * 1 + 1) * 4, "the memory size counts every level");
+
+			// Held textures are shared, by name, by either separator and by contents, without decoding again
+			uint32_t decodes = DecodeCount;
+			Check(cache.Load(L"TextureCacheTest.Red.img", 16, 8).get() == red, "a held texture is shared by name");
+			Check(cache.Load(L".\\TextureCacheTest.Red.img", 16, 8).get() == cache.Load(L"./TextureCacheTest.Red.img", 16, 8).get(), "both separators name the same texture");
+			Check(cache.Load(L"TextureCacheTest.RedCopy.img", 16, 8).get() == red, "a copy of a held image under another name is shared");
+			Check(DecodeCount == decodes, "copies under other names are found by their contents without decoding");
+
+			// Scaled to the size asked for, halving and then filtering
+			shared_ptr<const TextureData> scaled = cache.Load(L"TextureCacheTest.Red.img", 6, 3).get();
+			Check(scaled != red && IsFullMipChain(*scaled, 6, 3) && IsSolid(scaled->MipLevels[0], 255, 0, 0), "an image is scaled to the size asked for");
+
+			// Every two by two block of the checkerboard averages to grey, rounding half up
+			shared_ptr<const TextureData> checker = cache.Load(L"TextureCacheTest.Checker.img", 8, 8).get();
+			Check(IsFullMipChain(*checker, 8, 8) && IsSolid(checker->MipLevels[1], 128, 128, 128) && IsSolid(checker->MipLevels[3], 128, 128, 128), "the mip levels average the level above");
+
+			// Requests for a texture still being decoded share the decode
+			decodes = DecodeCount;
+			TextureCache::TextureFuture first = cache.Load(L"TextureCacheTest.Checker.img", 4, 4);
+			TextureCache::TextureFuture second = cache.Load(L"TextureCacheTest.Checker.img", 4, 4);
+			Check(first.get() == second.get() && DecodeCount == decodes + 1, "concurrent requests share one decode");
+
+			// Errors reach the caller through the future, and the texture can be asked for again
+			auto throws = [&cache](const wchar_t* fileName)
+			{
+				try
+				{
+					cache.Load(fileName, 4, 4).get();
+				}
+				catch (const exception&)
+				{
+					return true;
+				}
+
+				return false;
+			};
+
+			Check(throws(L"TextureCacheTest.Missing.img"), "a missing file throws from the future");
+			Check(throws(L"TextureCacheTest.Truncated.img") && throws(L"TextureCacheTest.Truncated.img"), "a failed decode throws from the future every time");
+
+			// The report keeps every texture decoded, in the order first asked for, resident while held
+			scaled.reset();
+			vector<TextureMemory> report = cache.MemoryReport();
+			Check(report.size() == 6, "the report lists every texture decoded");
+			Check(report.size() == 6 && report[0].Filename == L"TextureCacheTest.Red.img" && report[0].Resident && report[0].Bytes == red->MemorySize(), "the report gives the size of a held texture");
+			Check(report.size() == 6 && report[3].Width == 6 && report[3].Height == 3 && report[3].Resident == false, "the report keeps a released texture");
+		}
+
+#if defined(LIBRARY_PORTABLE) && defined(LIBRARY_HAS_IMAGE_DECODER)
+		// The content decoded headless as the frame sequence renderer loads it
+		{
+			TextureCache cache(threadPool, PortableImageDecoder::Decode);
+			TextureCache::TextureFuture jpeg = cache.Load(L"Content\\Textures\\EarthColorMap.jpg", 1024, 512);
+			TextureCache::TextureFuture png = cache.Load(L"Content\\Textures\\EarthSpecularMap.png", 1024, 512);
+			Check(IsFullMipChain(*jpeg.get(), 1024, 512), "a JPEG decodes headless");
+			Check(IsFullMipChain(*png.get(), 1024, 512), "a PNG decodes headless");
+		}
+#endif
+	}
+	catch (const exception& ex)
+	{
+		cerr << ex.what() << endl;
+		++Failures;
+	}
+
+	for (const string& fileName : fileNames)
+	{
+		remove(fileName.c_str());
+	}
+
+	cout << Failures << " checks failed." << endl;
+	return (Failures == 0 ? 0 : 1);
+}
\ No newline at end of file
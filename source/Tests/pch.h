@@ -0,0 +1,57 @@
+#pragma once
+
+// Standard
+#include <exception>
+#include <iostream>
+#include <string>
+#include <vector>
+#include <algorithm>
+#include <random>
+#include <cstdint>
+#include <cmath>
+#include <cstring>
+#include <cstdio>
+#include <fstream>
+#include <memory>
+#include <atomic>
+#include <sstream>
+#include <iterator>
+#include <limits>
+#include <chrono>
+#include <thread>
+
+// Library
+#include "Platform.h"
+
+#if defined(LIBRARY_HAS_DIRECTXMATH)
+#include <DirectXMath.h>
+#endif
+
+#include "GameException.h"
+#include "Utility.h"
+#include "ThreadPool.h"
+#include "BodyCatalog.h"
+#include "MinorPlanetCatalog.h"
+#include "TextureCache.h"
+#include "FrameConstantAllocator.h"
+#include "MemoryConstantBufferStorage.h"
+
+#if defined(LIBRARY_HAS_IMAGE_DECODER)
+#include "PortableImageDecoder.h"
+#endif
+
+// SolarSystem
+#include "EventFinder.h"
+#include "ShardedSimulation.h"
+#include "ParameterSweep.h"
+#include "HeadlessModes.h"
+
+#if defined(LIBRARY_HAS_DIRECTXMATH)
+#include "ShadowOccluderPass.h"
+#include "InstanceBatcher.h"
+#include "SatellitePropagator.h"
+#include "SolarSystemSimulation.h"
+#include "SnapshotCodec.h"
+#include "SnapshotServer.h"
+#include "SnapshotClient.h"
+#endif
\ No newline at end of file
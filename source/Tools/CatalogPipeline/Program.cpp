@@ -0,0 +1,72 @@
+#include "pch.h"
+
+using namespace std;
+using namespace Library;
+
+int main(int argc, char* argv[])
+{
+#if defined(DEBUG) | defined(_DEBUG)
+	_CrtSetDbgFlag(_CRTDBG_ALLOC_MEM_DF | _CRTDBG_LEAK_CHECK_DF);
+#endif
+
+	try
+	{
+		if (argc < 2)
+		{
+			throw exception("Usage: CatalogPipeline <catalog.csv> | CatalogPipeline --vsop87 <output.bin> <VSOP87 files...>");
+		}
+
+		if (string(argv[1]) == "--vsop87")
+		{
+			if (argc < 4)
+			{
+				throw exception("Usage: CatalogPipeline --vsop87 <output.bin> <VSOP87 files...>");
+			}
+
+			// The source files hold one planet each and are compiled together
+			stringstream source;
+			for (int i = 3; i < argc; ++i)
+			{
+				ifstream file(argv[i]);
+				if (!file.good())
+				{
+					throw exception("Could not open file.");
+				}
+
+				source << file.rdbuf() << '\n';
+			}
+
+			ofstream destination(argv[2], ios::binary);
+			if (!destination.good())
+			{
+				throw exception("Could not create file.");
+			}
+
+			Vsop87Theory::Compile(source, destination);
+			return 0;
+		}
+
+		string inputFile = argv[1];
+		ifstream source(inputFile.c_str());
+		if (!source.good())
+		{
+			throw exception("Could not open file.");
+		}
+
+		string outputFile = inputFile + ".bin";
+		ofstream destination(outputFile.c_str(), ios::binary);
+		if (!destination.good())
+		{
+			throw exception("Could not create file.");
+		}
+
+		BodyCatalog::Compile(source, destination);
+	}
+	catch (exception ex)
+	{
+		cout << ex.what();
+		return 1;
+	}
+
+	return 0;
+}
\ No newline at end of file
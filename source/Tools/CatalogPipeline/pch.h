@@ -0,0 +1,29 @@
+#pragma once
+
+// Windows
+#include <SDKDDKVer.h>
+#include <windows.h>
+
+// Standard
+#include <memory>
+#include <vector>
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <cstdint>
+#include <string>
+
+#if defined(DEBUG) || defined(_DEBUG)
+#define _CRTDBG_MAP_ALLOC
+#include <stdlib.h>
+#include <crtdbg.h>
+#endif
+
+// Library
+#include "GameException.h"
+#include "Utility.h"
+#include "BodyCatalog.h"
+#include "Vsop87Theory.h"
+
+// Library.Desktop
+#include "UtilityWin32.h"
\ No newline at end of file
@@ -0,0 +1,73 @@
+#include "pch.h"
+
+using namespace std;
+using namespace Library;
+using namespace Rendering;
+
+namespace
+{
+	/**
+	* A mode of the game that runs without a window, under the switch the game takes for it.
+	*/
+	struct CommandLineMode
+	{
+		const wstring* Switch;
+		int (*Run)(const vector<wstring>& arguments);
+	};
+
+	const CommandLineMode CommandLineModes[] =
+	{
+		{ &HeadlessModes::RenderQueueBenchmarkSwitch, HeadlessModes::RunRenderQueueBenchmark },
+		{ &HeadlessModes::EventSearchSwitch, HeadlessModes::RunEventSearch },
+		{ &HeadlessModes::ShardedSimulationSwitch, HeadlessModes::RunShardedSimulation },
+		{ &ShardedSimulation::WorkerSwitch, HeadlessModes::RunShardWorker },
+		{ &HeadlessModes::ParameterSweepSwitch, HeadlessModes::RunParameterSweep },
+		{ &ParameterSweep::WorkerSwitch, HeadlessModes::RunSweepWorker },
+		{ &HeadlessModes::AngleBenchmarkSwitch, HeadlessModes::RunAngleBenchmark },
+#if defined(LIBRARY_HAS_DIRECTXMATH)
+		{ &HeadlessModes::RenderDeviceBenchmarkSwitch, HeadlessModes::RunRenderDeviceBenchmark },
+		{ &HeadlessModes::SoftwareRasterBenchmarkSwitch, HeadlessModes::RunSoftwareRasterBenchmark },
+		{ &HeadlessModes::CullingBenchmarkSwitch, HeadlessModes::RunCullingBenchmark },
+#endif
+#if defined(LIBRARY_HAS_DIRECTXMATH) && defined(LIBRARY_HAS_IMAGE_DECODER)
+		{ &HeadlessModes::FrameSequenceSwitch, HeadlessModes::RunFrameSequence },
+#endif
+	};
+}
+
+int main(int argc, char* argv[])
+{
+	vector<wstring> arguments;
+	for (int i = 0; i < argc; ++i)
+	{
+		arguments.push_back(Utility::ToWideString(argv[i]));
+	}
+
+	auto found = end(CommandLineModes);
+	if (arguments.size() > 1)
+	{
+		found = find_if(begin(CommandLineModes), end(CommandLineModes), [&arguments](const CommandLineMode& candidate) { return arguments[1] == *candidate.Switch; });
+	}
+
+	if (found == end(CommandLineModes))
+	{
+		cerr << "Usage: HeadlessRenderer <mode> [arguments...]" << endl << "Modes:";
+		for (const CommandLineMode& mode : CommandLineModes)
+		{
+			cerr << ' ' << Utility::ToString(*mode.Switch);
+		}
+
+		cerr << endl;
+		return 1;
+	}
+
+	try
+	{
+		return found->Run(arguments);
+	}
+	catch (const exception& ex)
+	{
+		cerr << ex.what() << endl;
+		return 1;
+	}
+}
\ No newline at end of file
@@ -0,0 +1,19 @@
+#pragma once
+
+// Standard
+#include <exception>
+#include <iostream>
+#include <string>
+#include <vector>
+#include <iterator>
+#include <algorithm>
+
+// Library
+#include "Platform.h"
+#include "GameException.h"
+#include "Utility.h"
+
+// SolarSystem
+#include "ShardedSimulation.h"
+#include "ParameterSweep.h"
+#include "HeadlessModes.h"
\ No newline at end of file